@@ -13,6 +13,8 @@ LOCAL_SHARED_LIBRARIES := libc libdl libcutils libutils liblog
 
 LOCAL_SRC_FILES := \
 	src/common.c \
+	src/registry_cache.c \
+	src/library_scan.c \
 	src/omxregister.c \
 	src/omxregister.h 
 
@@ -31,6 +33,8 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := \
 	src/common.c \
+	src/registry_cache.c \
+	src/library_scan.c \
 	src/content_pipe_file.c \
 	src/content_pipe_inet.c \
 	src/omx_create_loaders_linux.c \
@@ -38,6 +42,8 @@ LOCAL_SRC_FILES := \
  	src/omx_reference_resource_manager.c \
 	src/omxregister.c \
 	src/queue.c \
+	src/name_index.c \
+	src/component_pool.c \
 	src/st_static_component_loader.c \
 	src/tsemaphore.c \
 	src/utils.c \
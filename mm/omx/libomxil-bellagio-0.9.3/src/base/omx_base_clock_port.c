@@ -134,15 +134,11 @@ OMX_ERRORTYPE base_clock_port_SendBufferFunction(
   omx_base_PortType *openmaxStandPort,
   OMX_BUFFERHEADERTYPE* pBuffer) {
 
-  OMX_ERRORTYPE err;
   int           errQue;
   OMX_U32 portIndex;
   OMX_COMPONENTTYPE* omxComponent = openmaxStandPort->standCompContainer;
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)omxComponent->pComponentPrivate;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s of component %p\n", __func__, omxComponent);
-#if NO_GST_OMX_PATCH
-  unsigned int i;
-#endif
   portIndex = (openmaxStandPort->sPortParam.eDir == OMX_DirInput)?pBuffer->nInputPortIndex:pBuffer->nOutputPortIndex;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s portIndex %lu\n", __func__, portIndex);
 
@@ -170,28 +166,11 @@ OMX_ERRORTYPE base_clock_port_SendBufferFunction(
     return OMX_ErrorIncorrectStateOperation;
   }
 
-  /* Temporarily disable this check for gst-openmax */
-#if NO_GST_OMX_PATCH
-  {
-  OMX_BOOL foundBuffer = OMX_FALSE;
-  if(pBuffer!=NULL && pBuffer->pBuffer!=NULL) {
-    for(i=0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++){
-    if (pBuffer->pBuffer == openmaxStandPort->pInternalBufferStorage[i]->pBuffer) {
-      foundBuffer = OMX_TRUE;
-      break;
-    }
-    }
-  }
-  if (!foundBuffer) {
+  /* The header must be one of the headers handed out by this port */
+  if (base_port_GetBufferSlot(openmaxStandPort, pBuffer) < 0) {
+    DEBUG(DEB_LEV_ERR, "In %s: received unknown buffer header %p on port %d\n", __func__, pBuffer, (int)portIndex);
     return OMX_ErrorBadParameter;
   }
-  }
-#endif
-
-  if ((err = checkHeader(pBuffer, sizeof(OMX_BUFFERHEADERTYPE))) != OMX_ErrorNone) {
-    DEBUG(DEB_LEV_ERR, "In %s: received wrong buffer header on input port\n", __func__);
-    return err;
-  }
   /*If port is not tunneled then simply return the buffer except paused state*/
   if (!PORT_IS_TUNNELED(openmaxStandPort) && (omx_base_component_Private->state != OMX_StatePause)) {
     openmaxStandPort->ReturnBufferFunction(openmaxStandPort,pBuffer);
@@ -37,6 +37,90 @@ extern "C" {
 #include "tsemaphore.h"
 #include "queue.h"
 
+/** The synchronization objects of the component and the other storage
+ * of the base constructor, allocated in a single block. The buffer
+ * management semaphore, signalled for every buffer, comes first on its
+ * own cache lines, followed by the message queue and its semaphore. The
+ * objects used only at the state changes and the name come last.
+ */
+typedef struct omx_base_component_SyncStorage {
+	union {
+		tsem_t sem;
+		char line[BASE_CACHE_ALIGN(sizeof(tsem_t))];
+	} bMgmtSem;
+	union {
+		tsem_t sem;
+		char line[BASE_CACHE_ALIGN(sizeof(tsem_t))];
+	} messageSem;
+	union {
+		queue_t queue;
+		char line[BASE_CACHE_ALIGN(sizeof(queue_t))];
+	} messageQueue;
+	tsem_t bStateSem;
+	tsem_t flush_all_condition;
+	tsem_t flush_condition;
+	OMX_PARAM_BELLAGIOTHREADS_ID bellagioThreads;
+	char name[OMX_MAX_STRINGNAME_SIZE];
+} omx_base_component_SyncStorage;
+
+/** Whether an object lies in the block allocated by omx_base_component_AllocPrivate */
+static OMX_BOOL base_component_InStorage(omx_base_component_PrivateType* omx_base_component_Private, void* pObject) {
+	char* pStorage = (char*)omx_base_component_Private;
+
+	return ((char*)pObject >= pStorage && (char*)pObject < pStorage + omx_base_component_Private->nStorageSize) ? OMX_TRUE : OMX_FALSE;
+}
+
+OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_AllocPrivate(OMX_COMPONENTTYPE *openmaxStandComp, size_t nPrivateSize, OMX_U32 nPorts, size_t nPortSize) {
+	omx_base_component_PrivateType* omx_base_component_Private;
+	omx_base_PortType** ports;
+	size_t nPortsOffset = BASE_CACHE_ALIGN(nPrivateSize) + BASE_CACHE_ALIGN(sizeof(omx_base_component_SyncStorage));
+	size_t nPortOffset = nPortsOffset + BASE_CACHE_ALIGN(nPorts * sizeof(omx_base_PortType*));
+	size_t nPortStride = BASE_CACHE_ALIGN(nPortSize) + BASE_CACHE_ALIGN(sizeof(base_port_SyncStorage));
+	size_t nSize = nPortOffset + nPorts * nPortStride;
+	void* pBlock;
+	char* pPort;
+	OMX_U32 i;
+
+	if (posix_memalign(&pBlock, BASE_CACHE_LINE_SIZE, nSize)) {
+		return OMX_ErrorInsufficientResources;
+	}
+	memset(pBlock, 0, nSize);
+	omx_base_component_Private = pBlock;
+	omx_base_component_Private->nStorageSize = nSize;
+	omx_base_component_Private->pSyncStorage = (char*)pBlock + BASE_CACHE_ALIGN(nPrivateSize);
+	if (nPorts) {
+		ports = (omx_base_PortType**)((char*)pBlock + nPortsOffset);
+		for (i = 0; i < nPorts; i++) {
+			pPort = (char*)pBlock + nPortOffset + i * nPortStride;
+			ports[i] = (omx_base_PortType*)pPort;
+			ports[i]->pSyncStorage = pPort + BASE_CACHE_ALIGN(nPortSize);
+		}
+		omx_base_component_Private->ports = ports;
+	}
+	openmaxStandComp->pComponentPrivate = omx_base_component_Private;
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s allocated %i bytes for %i ports of component %p\n", __func__, (int)nSize, (int)nPorts, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+OSCL_EXPORT_REF void omx_base_component_FreeStorage(OMX_COMPONENTTYPE *openmaxStandComp, void* pObject) {
+	if (openmaxStandComp == NULL || openmaxStandComp->pComponentPrivate == NULL ||
+			!base_component_InStorage(openmaxStandComp->pComponentPrivate, pObject)) {
+		free(pObject);
+	}
+}
+
+/**
+ * Frees an object of the component, unless it belongs to the block
+ * allocated by the base constructor
+ */
+static void base_component_FreeSyncObject(omx_base_component_PrivateType* omx_base_component_Private, void* pObject) {
+	char* pStorage = omx_base_component_Private->pSyncStorage;
+
+	if (pStorage == NULL || (char*)pObject < pStorage || (char*)pObject >= pStorage + sizeof(omx_base_component_SyncStorage)) {
+		free(pObject);
+	}
+}
+
 /**
  * This function releases all the resources allocated by the base constructor if something fails.
  * It checks if any item has been already allocated/configured
@@ -44,33 +128,36 @@ extern "C" {
 void base_constructor_remove_garbage_collected(omx_base_component_PrivateType* omx_base_component_Private) {
 	if (omx_base_component_Private->flush_condition) {
 		tsem_deinit(omx_base_component_Private->flush_condition);
-		free(omx_base_component_Private->flush_condition);
+		base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->flush_condition);
 	}
 	if (omx_base_component_Private->flush_all_condition) {
 		tsem_deinit(omx_base_component_Private->flush_all_condition);
-		free(omx_base_component_Private->flush_all_condition);
+		base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->flush_all_condition);
 	}
 	if (omx_base_component_Private->bellagioThreads) {
-		free(omx_base_component_Private->bellagioThreads);
+		base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->bellagioThreads);
 	}
 	if (omx_base_component_Private->name) {
-		free(omx_base_component_Private->name);
+		base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->name);
 	}
 	if (omx_base_component_Private->bStateSem) {
 		tsem_deinit(omx_base_component_Private->bStateSem);
-		free(omx_base_component_Private->bStateSem);
+		base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->bStateSem);
 	}
 	if (omx_base_component_Private->bMgmtSem) {
 		tsem_deinit(omx_base_component_Private->bMgmtSem);
-		free(omx_base_component_Private->bMgmtSem);
+		base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->bMgmtSem);
 	}
 	if (omx_base_component_Private->messageSem) {
 		tsem_deinit(omx_base_component_Private->messageSem);
-		free(omx_base_component_Private->messageSem);
+		base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->messageSem);
 	}
 	if (omx_base_component_Private->messageQueue) {
 		queue_deinit(omx_base_component_Private->messageQueue);
-		free(omx_base_component_Private->messageQueue);
+		base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->messageQueue);
+	}
+	if (!base_component_InStorage(omx_base_component_Private, omx_base_component_Private->pSyncStorage)) {
+		free(omx_base_component_Private->pSyncStorage);
 	}
 	if (omx_base_component_Private) {
 		free(omx_base_component_Private);
@@ -94,6 +181,7 @@ void base_constructor_remove_garbage_collected(omx_base_component_PrivateType* o
  */
 OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName) {
 	omx_base_component_PrivateType* omx_base_component_Private;
+	omx_base_component_SyncStorage* pSyncStorage;
 	OMX_U32 i;
 	int err;
 
@@ -108,12 +196,18 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 		}
 	}
 
-	if(!omx_base_component_Private->messageQueue) {
-		omx_base_component_Private->messageQueue = calloc(1,sizeof(queue_t));
-		if (!omx_base_component_Private->messageQueue) {
+	if(!omx_base_component_Private->pSyncStorage) {
+		if (posix_memalign(&omx_base_component_Private->pSyncStorage, BASE_CACHE_LINE_SIZE, sizeof(omx_base_component_SyncStorage))) {
+			omx_base_component_Private->pSyncStorage = NULL;
 			base_constructor_remove_garbage_collected(omx_base_component_Private);
 			return OMX_ErrorInsufficientResources;
 		}
+		memset(omx_base_component_Private->pSyncStorage, 0, sizeof(omx_base_component_SyncStorage));
+	}
+	pSyncStorage = omx_base_component_Private->pSyncStorage;
+
+	if(!omx_base_component_Private->messageQueue) {
+		omx_base_component_Private->messageQueue = &pSyncStorage->messageQueue.queue;
 		err = queue_init(omx_base_component_Private->messageQueue);
 		if (err != 0) {
 			base_constructor_remove_garbage_collected(omx_base_component_Private);
@@ -122,11 +216,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 	}
 
 	if(!omx_base_component_Private->messageSem) {
-		omx_base_component_Private->messageSem = calloc(1,sizeof(tsem_t));
-		if (!omx_base_component_Private->messageSem) {
-			base_constructor_remove_garbage_collected(omx_base_component_Private);
-			return OMX_ErrorInsufficientResources;
-		}
+		omx_base_component_Private->messageSem = &pSyncStorage->messageSem.sem;
 		err = tsem_init(omx_base_component_Private->messageSem, 0);
 		if (err != 0) {
 			base_constructor_remove_garbage_collected(omx_base_component_Private);
@@ -134,11 +224,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 		}
 	}
 	if(!omx_base_component_Private->bMgmtSem) {
-		omx_base_component_Private->bMgmtSem = calloc(1,sizeof(tsem_t));
-		if (!omx_base_component_Private->bMgmtSem) {
-			base_constructor_remove_garbage_collected(omx_base_component_Private);
-			return OMX_ErrorInsufficientResources;
-		}
+		omx_base_component_Private->bMgmtSem = &pSyncStorage->bMgmtSem.sem;
 		err = tsem_init(omx_base_component_Private->bMgmtSem, 0);
 		if (err != 0) {
 			base_constructor_remove_garbage_collected(omx_base_component_Private);
@@ -147,11 +233,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 	}
 
 	if(!omx_base_component_Private->bStateSem) {
-		omx_base_component_Private->bStateSem = calloc(1,sizeof(tsem_t));
-		if (!omx_base_component_Private->bStateSem) {
-			base_constructor_remove_garbage_collected(omx_base_component_Private);
-			return OMX_ErrorInsufficientResources;
-		}
+		omx_base_component_Private->bStateSem = &pSyncStorage->bStateSem;
 		err = tsem_init(omx_base_component_Private->bStateSem, 0);
 		if (err != 0) {
 			base_constructor_remove_garbage_collected(omx_base_component_Private);
@@ -187,11 +269,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 	openmaxStandComp->nVersion.s.nRevision = SPECREVISION;
 	openmaxStandComp->nVersion.s.nStep = SPECSTEP;
 
-	omx_base_component_Private->name = calloc(1,OMX_MAX_STRINGNAME_SIZE);
-	if (!omx_base_component_Private->name) {
-		base_constructor_remove_garbage_collected(omx_base_component_Private);
-		return OMX_ErrorInsufficientResources;
-	}
+	omx_base_component_Private->name = pSyncStorage->name;
 	strcpy(omx_base_component_Private->name,cComponentName);
 	omx_base_component_Private->state = OMX_StateLoaded;
 	omx_base_component_Private->transientState = OMX_TransStateMax;
@@ -199,6 +277,9 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 	omx_base_component_Private->callbackData = NULL;
 	omx_base_component_Private->nGroupPriority = 100;
 	omx_base_component_Private->nGroupID = 0;
+	omx_base_component_Private->nResourceId = RM_RESOURCE_UNKNOWN;
+	omx_base_component_Private->pResourceEntry = NULL;
+	omx_base_component_Private->sKernelName = NULL;
 	omx_base_component_Private->pMark.hMarkTargetComponent = NULL;
 	omx_base_component_Private->pMark.pMarkData            = NULL;
 	omx_base_component_Private->openmaxStandComp = openmaxStandComp;
@@ -210,11 +291,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 	omx_base_component_Private->currentQualityLevel = 0;
 	omx_base_component_Private->nqualitylevels = 0;
 	omx_base_component_Private->bufferMgmtThreadID = -1;
-	omx_base_component_Private->bellagioThreads = calloc(1, sizeof(OMX_PARAM_BELLAGIOTHREADS_ID));
-	if (omx_base_component_Private->bellagioThreads == NULL) {
-		base_constructor_remove_garbage_collected(omx_base_component_Private);
-		return OMX_ErrorInsufficientResources;
-	}
+	omx_base_component_Private->bellagioThreads = &pSyncStorage->bellagioThreads;
 	omx_base_component_Private->bellagioThreads->nThreadBufferMngtID = 0;
 	omx_base_component_Private->bellagioThreads->nThreadMessageID = 0;
 	omx_base_component_Private->bIsEOSReached = OMX_FALSE;
@@ -222,11 +299,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 	pthread_mutex_init(&omx_base_component_Private->flush_mutex, NULL);
 
 	if(!omx_base_component_Private->flush_all_condition) {
-		omx_base_component_Private->flush_all_condition = calloc(1,sizeof(tsem_t));
-		if(!omx_base_component_Private->flush_all_condition) {
-			base_constructor_remove_garbage_collected(omx_base_component_Private);
-			return OMX_ErrorInsufficientResources;
-		}
+		omx_base_component_Private->flush_all_condition = &pSyncStorage->flush_all_condition;
 		err = tsem_init(omx_base_component_Private->flush_all_condition, 0);
 		if (err != 0) {
 			base_constructor_remove_garbage_collected(omx_base_component_Private);
@@ -235,11 +308,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 	}
 
 	if(!omx_base_component_Private->flush_condition) {
-		omx_base_component_Private->flush_condition = calloc(1,sizeof(tsem_t));
-		if(!omx_base_component_Private->flush_condition) {
-			base_constructor_remove_garbage_collected(omx_base_component_Private);
-			return OMX_ErrorInsufficientResources;
-		}
+		omx_base_component_Private->flush_condition = &pSyncStorage->flush_condition;
 		err = tsem_init(omx_base_component_Private->flush_condition, 0);
 		if (err != 0) {
 			base_constructor_remove_garbage_collected(omx_base_component_Private);
@@ -278,16 +347,23 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Destructor(OMX_COMPONENTTYPE *o
   /*Send Dummy signal to Component Message handler to exit*/
   tsem_up(omx_base_component_Private->messageSem);
 
-  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s before pthread_detach\n", __func__);
-  err = pthread_detach(omx_base_component_Private->messageHandlerThread);
+  /* Wait for the message handler to exit: the private data is released
+   * below, and the loader may unload the component library afterwards */
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s before pthread_join\n", __func__);
+  err = pthread_join(omx_base_component_Private->messageHandlerThread, NULL);
   if(err!=0) {
-    DEBUG(DEB_LEV_FUNCTION_NAME,"In %s pthread_detach returned err=%d\n", __func__, err);
+    DEBUG(DEB_LEV_FUNCTION_NAME,"In %s pthread_join returned err=%d\n", __func__, err);
+  }
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s after pthread_join\n", __func__);
+  /* Give back the resource held, or waited for, by a component freed out of the Loaded state */
+  if(omx_base_component_Private->pResourceEntry) {
+    RM_removeFromWaitForResource(openmaxStandComp);
+    RM_releaseResource(openmaxStandComp);
   }
-  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s after pthread_detach\n", __func__);
   /*Deinitialize and free message queue*/
   if(omx_base_component_Private->messageQueue) {
     queue_deinit(omx_base_component_Private->messageQueue);
-    free(omx_base_component_Private->messageQueue);
+    base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->messageQueue);
     omx_base_component_Private->messageQueue=NULL;
   }
 
@@ -295,25 +371,25 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Destructor(OMX_COMPONENTTYPE *o
   /*Deinitialize and free buffer management semaphore*/
   if(omx_base_component_Private->bMgmtSem){
     tsem_deinit(omx_base_component_Private->bMgmtSem);
-    free(omx_base_component_Private->bMgmtSem);
+    base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->bMgmtSem);
     omx_base_component_Private->bMgmtSem=NULL;
   }
 
   /*Deinitialize and free message semaphore*/
   if(omx_base_component_Private->messageSem) {
     tsem_deinit(omx_base_component_Private->messageSem);
-    free(omx_base_component_Private->messageSem);
+    base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->messageSem);
     omx_base_component_Private->messageSem=NULL;
   }
 
   if(omx_base_component_Private->bStateSem){
     tsem_deinit(omx_base_component_Private->bStateSem);
-    free(omx_base_component_Private->bStateSem);
+    base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->bStateSem);
     omx_base_component_Private->bStateSem=NULL;
   }
 
   if(omx_base_component_Private->name){
-    free(omx_base_component_Private->name);
+    base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->name);
     omx_base_component_Private->name=NULL;
   }
 
@@ -321,16 +397,24 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Destructor(OMX_COMPONENTTYPE *o
 
   if(omx_base_component_Private->flush_all_condition){
     tsem_deinit(omx_base_component_Private->flush_all_condition);
-    free(omx_base_component_Private->flush_all_condition);
+    base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->flush_all_condition);
     omx_base_component_Private->flush_all_condition=NULL;
   }
 
   if(omx_base_component_Private->flush_condition){
     tsem_deinit(omx_base_component_Private->flush_condition);
-    free(omx_base_component_Private->flush_condition);
+    base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->flush_condition);
     omx_base_component_Private->flush_condition=NULL;
   }
 
+  if(omx_base_component_Private->bellagioThreads){
+    base_component_FreeSyncObject(omx_base_component_Private, omx_base_component_Private->bellagioThreads);
+    omx_base_component_Private->bellagioThreads=NULL;
+  }
+
+  omx_base_component_FreeStorage(openmaxStandComp, omx_base_component_Private->pSyncStorage);
+  omx_base_component_Private->pSyncStorage=NULL;
+
   DEBUG(DEB_LEV_FUNCTION_NAME,"Out of %s for component %p\n", __func__, openmaxStandComp);
   return OMX_ErrorNone;
 }
@@ -377,7 +461,10 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
   DEBUG(DEB_LEV_PARAMS, "Changing state from %i to %i\n", omx_base_component_Private->state, (int)destinationState);
 
-  if (omx_base_component_Private->state == OMX_StateLoaded && destinationState == OMX_StateIdle) {
+  /* A waiting component already granted the resource gets it at once,
+   * one asking for Idle before is refused if nothing can be preempted */
+  if ((omx_base_component_Private->state == OMX_StateLoaded ||
+       omx_base_component_Private->state == OMX_StateWaitForResources) && destinationState == OMX_StateIdle) {
 	  err = RM_getResource(openmaxStandComp);
 	  if (err != OMX_ErrorNone) {
 		  return OMX_ErrorInsufficientResources;
@@ -430,15 +517,8 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
           }
           pPort->sPortParam.bPopulated = OMX_FALSE;
 
-          if(pPort->pInternalBufferStorage != NULL) {
-            free(pPort->pInternalBufferStorage);
-            pPort->pInternalBufferStorage=NULL;
-          }
-
-          if(pPort->bBufferStateAllocated != NULL) {
-            free(pPort->bBufferStateAllocated);
-            pPort->bBufferStateAllocated=NULL;
-          }
+          base_port_ReleasePayloadCache(pPort, 0, pPort->sPortParam.nBufferCountActual);
+          base_port_FreeBufferStorage(pPort);
         }
       }
       omx_base_component_Private->state = OMX_StateLoaded;
@@ -908,13 +988,16 @@ OSCL_EXPORT_REF OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_GetParameter(
   OMX_ERRORTYPE err = OMX_ErrorNone;
   OMX_VENDOR_PROP_TUNNELSETUPTYPE *pPropTunnelSetup;
   OMX_PARAM_BELLAGIOTHREADS_ID *threadID;
+  OMX_PARAM_U32TYPE *pMaxBufferSize;
+  OMX_PARAM_BELLAGIOCOALESCINGTYPE *pCoalescing;
+  OMX_PARAM_BELLAGIOKERNELTYPE *pKernel;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
   DEBUG(DEB_LEV_PARAMS, "Getting parameter %i\n", nParamIndex);
   if (ComponentParameterStructure == NULL) {
     return OMX_ErrorBadParameter;
   }
-  switch(nParamIndex) {
+  switch((OMX_U32)nParamIndex) {
   case OMX_IndexParameterThreadsID:
 	    if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_BELLAGIOTHREADS_ID))) != OMX_ErrorNone) {
 	      break;
@@ -923,6 +1006,44 @@ OSCL_EXPORT_REF OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_GetParameter(
 	  threadID->nThreadBufferMngtID = omx_base_component_Private->bellagioThreads->nThreadBufferMngtID;
 	  threadID->nThreadMessageID = omx_base_component_Private->bellagioThreads->nThreadMessageID;
 	  break;
+  case OMX_IndexParameterMaxBufferSize:
+    pMaxBufferSize = (OMX_PARAM_U32TYPE*)ComponentParameterStructure;
+    if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_U32TYPE))) != OMX_ErrorNone) {
+      break;
+    }
+    if (pMaxBufferSize->nPortIndex >= (omx_base_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts +
+                                      omx_base_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts +
+                                      omx_base_component_Private->sPortTypesParam[OMX_PortDomainImage].nPorts +
+                                      omx_base_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts)) {
+      return OMX_ErrorBadPortIndex;
+    }
+    pMaxBufferSize->nU32 = omx_base_component_Private->ports[pMaxBufferSize->nPortIndex]->nMaxBufferSize;
+    break;
+  case OMX_IndexParameterCoalescing:
+    pCoalescing = (OMX_PARAM_BELLAGIOCOALESCINGTYPE*)ComponentParameterStructure;
+    if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_BELLAGIOCOALESCINGTYPE))) != OMX_ErrorNone) {
+      break;
+    }
+    if (pCoalescing->nPortIndex >= (omx_base_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts +
+                                    omx_base_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts +
+                                    omx_base_component_Private->sPortTypesParam[OMX_PortDomainImage].nPorts +
+                                    omx_base_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts)) {
+      return OMX_ErrorBadPortIndex;
+    }
+    pCoalescing->nMaxBytes = omx_base_component_Private->ports[pCoalescing->nPortIndex]->nCoalesceBytes;
+    pCoalescing->nMaxDuration = omx_base_component_Private->ports[pCoalescing->nPortIndex]->nCoalesceDuration;
+    break;
+  case OMX_IndexParameterKernel:
+    if (!omx_base_component_Private->sKernelName) {
+      return OMX_ErrorUnsupportedIndex;
+    }
+    pKernel = (OMX_PARAM_BELLAGIOKERNELTYPE*)ComponentParameterStructure;
+    if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_BELLAGIOKERNELTYPE))) != OMX_ErrorNone) {
+      break;
+    }
+    strncpy((char*)pKernel->cName, omx_base_component_Private->sKernelName, OMX_MAX_STRINGNAME_SIZE - 1);
+    pKernel->cName[OMX_MAX_STRINGNAME_SIZE - 1] = '\0';
+    break;
   case OMX_IndexParamAudioInit:
   case OMX_IndexParamVideoInit:
   case OMX_IndexParamImageInit:
@@ -1034,6 +1155,8 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SetParameter(
   OMX_COMPONENTTYPE *omxcomponent = (OMX_COMPONENTTYPE*)hComponent;
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)omxcomponent->pComponentPrivate;
   OMX_PARAM_BUFFERSUPPLIERTYPE *pBufferSupplier;
+  OMX_PARAM_U32TYPE *pMaxBufferSize;
+  OMX_PARAM_BELLAGIOCOALESCINGTYPE *pCoalescing;
   omx_base_PortType *pPort;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
@@ -1043,7 +1166,44 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SetParameter(
     return OMX_ErrorBadParameter;
   }
 
-  switch(nParamIndex) {
+  switch((OMX_U32)nParamIndex) {
+  case OMX_IndexParameterMaxBufferSize:
+    /* it only applies to the next allocations, so it can be set in any state */
+    pMaxBufferSize = (OMX_PARAM_U32TYPE*)ComponentParameterStructure;
+    if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_U32TYPE))) != OMX_ErrorNone) {
+      break;
+    }
+    if (pMaxBufferSize->nPortIndex >= (omx_base_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts +
+                                      omx_base_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts +
+                                      omx_base_component_Private->sPortTypesParam[OMX_PortDomainImage].nPorts +
+                                      omx_base_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts)) {
+      return OMX_ErrorBadPortIndex;
+    }
+    omx_base_component_Private->ports[pMaxBufferSize->nPortIndex]->nMaxBufferSize = pMaxBufferSize->nU32;
+    break;
+  case OMX_IndexParameterCoalescing:
+    /* the buffer management thread chooses how to process the buffers when it starts */
+    if (omx_base_component_Private->state != OMX_StateLoaded &&
+      omx_base_component_Private->state != OMX_StateWaitForResources) {
+      return OMX_ErrorIncorrectStateOperation;
+    }
+    pCoalescing = (OMX_PARAM_BELLAGIOCOALESCINGTYPE*)ComponentParameterStructure;
+    if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_BELLAGIOCOALESCINGTYPE))) != OMX_ErrorNone) {
+      break;
+    }
+    if (pCoalescing->nPortIndex >= (omx_base_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts +
+                                    omx_base_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts +
+                                    omx_base_component_Private->sPortTypesParam[OMX_PortDomainImage].nPorts +
+                                    omx_base_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts)) {
+      return OMX_ErrorBadPortIndex;
+    }
+    pPort = omx_base_component_Private->ports[pCoalescing->nPortIndex];
+    if (pPort->sPortParam.eDir != OMX_DirOutput) {
+      return OMX_ErrorUnsupportedSetting;
+    }
+    pPort->nCoalesceBytes = pCoalescing->nMaxBytes;
+    pPort->nCoalesceDuration = pCoalescing->nMaxDuration;
+    break;
   case OMX_IndexParamAudioInit:
   case OMX_IndexParamVideoInit:
   case OMX_IndexParamImageInit:
@@ -1067,7 +1227,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SetParameter(
     }
     {
       OMX_PARAM_PORTDEFINITIONTYPE *pPortParam;
-      OMX_U32 j,old_nBufferCountActual=0;
+      OMX_U32 old_nBufferCountActual=0;
       pPortParam = &omx_base_component_Private->ports[pPortDef->nPortIndex]->sPortParam;
       if(pPortDef->nBufferCountActual < pPortParam->nBufferCountMin) {
         DEBUG(DEB_LEV_ERR, "In %s nBufferCountActual of param (%i) is < of nBufferCountMin of port(%i)\n",__func__, (int)pPortDef->nBufferCountActual, (int)pPortParam->nBufferCountMin);
@@ -1110,6 +1270,15 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SetParameter(
         break;
       }
 
+      /*If component state Idle/Pause/Executing free the payloads kept for the slots that are no longer used */
+      if ((omx_base_component_Private->state == OMX_StateIdle ||
+        omx_base_component_Private->state == OMX_StatePause  ||
+        omx_base_component_Private->state == OMX_StateExecuting) &&
+        (pPortParam->nBufferCountActual < old_nBufferCountActual)) {
+        base_port_ReleasePayloadCache(omx_base_component_Private->ports[pPortDef->nPortIndex],
+                                      pPortParam->nBufferCountActual, old_nBufferCountActual);
+      }
+
       /*If component state Idle/Pause/Executing and re-alloc the following private variables */
       if ((omx_base_component_Private->state == OMX_StateIdle ||
         omx_base_component_Private->state == OMX_StatePause  ||
@@ -1117,14 +1286,10 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SetParameter(
         (pPortParam->nBufferCountActual > old_nBufferCountActual)) {
 // todo check if here it is not better != instead of >
         pPort = omx_base_component_Private->ports[pPortDef->nPortIndex];
-        if(pPort->pInternalBufferStorage) {
-          pPort->pInternalBufferStorage = realloc(pPort->pInternalBufferStorage,pPort->sPortParam.nBufferCountActual*sizeof(OMX_BUFFERHEADERTYPE *));
-        }
-
-        if(pPort->bBufferStateAllocated) {
-          pPort->bBufferStateAllocated = realloc(pPort->bBufferStateAllocated,pPort->sPortParam.nBufferCountActual*sizeof(BUFFER_STATUS_FLAG));
-          for(j=0; j < pPort->sPortParam.nBufferCountActual; j++) {
-            pPort->bBufferStateAllocated[j] = BUFFER_FREE;
+        if(pPort->pBufferStorage) {
+          err = base_port_AllocBufferStorage(pPort, old_nBufferCountActual);
+          if(err != OMX_ErrorNone) {
+            pPortParam->nBufferCountActual = old_nBufferCountActual;
           }
         }
       }
@@ -1259,6 +1424,12 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_GetExtensionIndex(
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
 	if(strcmp(cParameterName,"OMX.st.index.param.BellagioThreadsID") == 0) {
 		*pIndexType = OMX_IndexParameterThreadsID;
+	} else if(strcmp(cParameterName,"OMX.st.index.param.BellagioMaxBufferSize") == 0) {
+		*pIndexType = OMX_IndexParameterMaxBufferSize;
+	} else if(strcmp(cParameterName,"OMX.st.index.param.BellagioCoalescing") == 0) {
+		*pIndexType = OMX_IndexParameterCoalescing;
+	} else if(strcmp(cParameterName,"OMX.st.index.param.BellagioKernel") == 0) {
+		*pIndexType = OMX_IndexParameterKernel;
 	} else {
 		return OMX_ErrorBadParameter;
 	}
@@ -1326,16 +1497,15 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SendCommand(
 
           pPort = omx_base_component_Private->ports[i];
 
-          if(pPort->pInternalBufferStorage == NULL) {
-            pPort->pInternalBufferStorage = calloc(pPort->sPortParam.nBufferCountActual,sizeof(OMX_BUFFERHEADERTYPE *));
-          }
-
-          if(pPort->bBufferStateAllocated == NULL) {
-            pPort->bBufferStateAllocated = calloc(pPort->sPortParam.nBufferCountActual,sizeof(BUFFER_STATUS_FLAG));
+          if(pPort->pBufferStorage == NULL &&
+             base_port_AllocBufferStorage(pPort, 0) != OMX_ErrorNone) {
+            free(message);
+            return OMX_ErrorInsufficientResources;
           }
 
           for(k=0; k < pPort->sPortParam.nBufferCountActual; k++) {
             pPort->bBufferStateAllocated[k] = BUFFER_FREE;
+            pPort->pExternalBufferStorage[k] = NULL;
           }
         }
       }
@@ -1429,6 +1599,34 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SendCommand(
   return err;
 }
 
+/** @brief queues the preemption of the component by the resource manager
+ *
+ * The message is handled after the commands already queued, so the
+ * component is preempted in the state those commands leave it in.
+ */
+OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Preempt(
+  OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  internalRequestMessageType *message;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+  if (omx_base_component_Private->state == OMX_StateInvalid) {
+    return OMX_ErrorInvalidState;
+  }
+  message = calloc(1,sizeof(internalRequestMessageType));
+  if (message == NULL) {
+    return OMX_ErrorInsufficientResources;
+  }
+  message->messageType = PREEMPT_MSG_TYPE;
+  if (queue(omx_base_component_Private->messageQueue, message)) {
+    free(message);
+    return OMX_ErrorInsufficientResources;
+  }
+  tsem_up(omx_base_component_Private->messageSem);
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
 /** @brief Component's message handler thread function
  *
  * Handles all messages coming from components and
@@ -1474,6 +1672,103 @@ void* compMessageHandlerFunction(void* param) {
   return NULL;
 }
 
+/** Flushes all the ports of the component at once.
+ *
+ * When every port uses the base flush function, the buffer management
+ * thread is stopped once for all the ports, then all the queues are
+ * returned before waiting for the tunneled suppliers, so that the peers
+ * send their buffers back in parallel. Otherwise each port is flushed
+ * in turn by its own FlushProcessingBuffers.
+ *
+ * The caller must have set bIsPortFlushed on all the ports.
+ *
+ * @param openmaxStandComp the component to be flushed
+ */
+OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_FlushAllPorts(OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_base_component_PrivateType* omx_base_component_Private=openmaxStandComp->pComponentPrivate;
+  OMX_U32                         i,j;
+  OMX_ERRORTYPE                   err = OMX_ErrorNone;
+  OMX_BOOL                        bBatchFlush = OMX_TRUE;
+  OMX_BOOL                        bMgmtUsed = OMX_FALSE;
+  omx_base_PortType*              pPort;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+
+  for(j = 0; j < NUM_DOMAINS; j++) {
+    for(i = omx_base_component_Private->sPortTypesParam[j].nStartPortNumber;
+    i < omx_base_component_Private->sPortTypesParam[j].nStartPortNumber +
+      omx_base_component_Private->sPortTypesParam[j].nPorts; i++) {
+      pPort=omx_base_component_Private->ports[i];
+      if (pPort->FlushProcessingBuffers != &base_port_FlushProcessingBuffers) {
+        bBatchFlush = OMX_FALSE;
+      }
+      if (pPort->sPortParam.eDomain != OMX_PortDomainOther) {
+        bMgmtUsed = OMX_TRUE;
+      }
+    }
+  }
+
+  if (bBatchFlush == OMX_FALSE) {
+    for(j = 0; j < NUM_DOMAINS; j++) {
+      for(i = omx_base_component_Private->sPortTypesParam[j].nStartPortNumber;
+      i < omx_base_component_Private->sPortTypesParam[j].nStartPortNumber +
+        omx_base_component_Private->sPortTypesParam[j].nPorts; i++) {
+        pPort=omx_base_component_Private->ports[i];
+        err = pPort->FlushProcessingBuffers(pPort);
+      }
+    }
+    return err;
+  }
+
+  if (bMgmtUsed == OMX_TRUE) { /* clock buffers not used in the clients buffer managment function */
+    pthread_mutex_lock(&omx_base_component_Private->flush_mutex);
+    /*Signal the buffer management thread of port flush,if it is waiting for buffers*/
+    if(omx_base_component_Private->bMgmtSem->semval==0) {
+      tsem_up(omx_base_component_Private->bMgmtSem);
+    }
+    if(omx_base_component_Private->state != OMX_StateExecuting ) {
+      /*Waiting at paused state*/
+      tsem_signal(omx_base_component_Private->bStateSem);
+    }
+    pthread_mutex_unlock(&omx_base_component_Private->flush_mutex);
+    tsem_down(omx_base_component_Private->flush_all_condition);
+  }
+  tsem_reset(omx_base_component_Private->bMgmtSem);
+
+  /* Flush all the buffers not under processing, then wait for the suppliers */
+  for(j = 0; j < NUM_DOMAINS; j++) {
+    for(i = omx_base_component_Private->sPortTypesParam[j].nStartPortNumber;
+    i < omx_base_component_Private->sPortTypesParam[j].nStartPortNumber +
+      omx_base_component_Private->sPortTypesParam[j].nPorts; i++) {
+      base_port_ReturnQueuedBuffers(omx_base_component_Private->ports[i]);
+    }
+  }
+  for(j = 0; j < NUM_DOMAINS; j++) {
+    for(i = omx_base_component_Private->sPortTypesParam[j].nStartPortNumber;
+    i < omx_base_component_Private->sPortTypesParam[j].nStartPortNumber +
+      omx_base_component_Private->sPortTypesParam[j].nPorts; i++) {
+      base_port_WaitTunnelBuffers(omx_base_component_Private->ports[i]);
+    }
+  }
+
+  pthread_mutex_lock(&omx_base_component_Private->flush_mutex);
+  for(j = 0; j < NUM_DOMAINS; j++) {
+    for(i = omx_base_component_Private->sPortTypesParam[j].nStartPortNumber;
+    i < omx_base_component_Private->sPortTypesParam[j].nStartPortNumber +
+      omx_base_component_Private->sPortTypesParam[j].nPorts; i++) {
+      omx_base_component_Private->ports[i]->bIsPortFlushed = OMX_FALSE;
+    }
+  }
+  pthread_mutex_unlock(&omx_base_component_Private->flush_mutex);
+
+  if (bMgmtUsed == OMX_TRUE) {
+    tsem_up(omx_base_component_Private->flush_condition);
+  }
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
 /** This is called by the component message entry point.
  * In this base version this function is named compMessageHandlerFunction
  *
@@ -1536,15 +1831,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_MessageHandler(OMX_COMPONENTTYP
           omx_base_component_Private->ports[i]->bIsPortFlushed = OMX_TRUE;
         }
       }
-      /* for all ports */
-      for(j = 0; j < NUM_DOMAINS; j++) {
-        for(i = omx_base_component_Private->sPortTypesParam[j].nStartPortNumber;
-        i < omx_base_component_Private->sPortTypesParam[j].nStartPortNumber +
-          omx_base_component_Private->sPortTypesParam[j].nPorts; i++) {
-          pPort=omx_base_component_Private->ports[i];
-          err = pPort->FlushProcessingBuffers(pPort);
-        }
-      }
+      err = omx_base_component_FlushAllPorts(openmaxStandComp);
     }
     else {
       pPort=omx_base_component_Private->ports[message->messageParam];
@@ -1760,6 +2047,37 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_MessageHandler(OMX_COMPONENTTYP
     omx_base_component_Private->pMark.pMarkData            = ((OMX_MARKTYPE *)message->pCmdData)->pMarkData;
   }
   break;
+  case PREEMPT_MSG_TYPE: {
+    /* the resource has already been given to another component:
+     * a running component stops and returns its buffers, then the
+     * component leaves Idle as soon as the IL client frees them */
+    if (omx_base_component_Private->state == OMX_StateExecuting ||
+        omx_base_component_Private->state == OMX_StatePause) {
+      omx_base_component_Private->transientState = (omx_base_component_Private->state == OMX_StateExecuting) ?
+        OMX_TransStateExecutingToIdle : OMX_TransStatePauseToIdle;
+      err = (*(omx_base_component_Private->DoStateSet))(openmaxStandComp, OMX_StateIdle);
+      (*(omx_base_component_Private->callbacks->EventHandler))
+        (openmaxStandComp, omx_base_component_Private->callbackData,
+        OMX_EventError, (err == OMX_ErrorNone) ? OMX_ErrorResourcesPreempted : err, 0, NULL);
+    }
+    if (omx_base_component_Private->state == OMX_StateIdle) {
+      (*(omx_base_component_Private->callbacks->EventHandler))
+        (openmaxStandComp, omx_base_component_Private->callbackData,
+        OMX_EventError, OMX_ErrorResourcesLost, 0, NULL);
+      omx_base_component_Private->transientState = OMX_TransStateIdleToLoaded;
+      err = (*(omx_base_component_Private->DoStateSet))(openmaxStandComp, OMX_StateLoaded);
+      if (err != OMX_ErrorNone) {
+        (*(omx_base_component_Private->callbacks->EventHandler))
+          (openmaxStandComp, omx_base_component_Private->callbackData,
+          OMX_EventError, err, 0, NULL);
+      } else {
+        (*(omx_base_component_Private->callbacks->EventHandler))
+          (openmaxStandComp, omx_base_component_Private->callbackData,
+          OMX_EventCmdComplete, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+      }
+    }
+  }
+  break;
   default:
     DEBUG(DEB_LEV_ERR, "In %s: Unrecognized command %i\n", __func__, message->messageType);
   break;
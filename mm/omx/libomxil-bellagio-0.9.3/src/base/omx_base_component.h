@@ -79,7 +79,12 @@ typedef enum OMX_INDEXVENDORTYPE {
 	OMX_IndexVendorOutputFilename,
 	OMX_IndexVendorCompPropTunnelFlags, /* Will use OMX_TUNNELSETUPTYPE structure*/
 	OMX_IndexParameterThreadsID,
-	OMX_VIDEO_CodingTheora
+	OMX_VIDEO_CodingTheora,
+	OMX_IndexParameterMaxBufferSize, /* Will use OMX_PARAM_U32TYPE structure, nU32 is the payload size to be allocated for the port */
+	OMX_IndexParameterCoalescing, /* Will use OMX_PARAM_BELLAGIOCOALESCINGTYPE structure */
+	OMX_IndexConfigChannelMatrix, /* Will use OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE structure */
+	OMX_IndexParameterReadOnlyBuffers, /* Will use OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE structure */
+	OMX_IndexParameterKernel /* Will use OMX_PARAM_BELLAGIOKERNELTYPE structure */
 } OMX_INDEXVENDORTYPE;
 
 /** This enum defines the transition states of the Component*/
@@ -102,7 +107,8 @@ typedef enum OMX_TRANS_STATETYPE {
 typedef enum INTERNAL_MESSAGE_TYPE {
   SENDCOMMAND_MSG_TYPE = 1,/**< this flag specifies that the message send is a command */
   ERROR_MSG_TYPE,/**< this flag specifies that the message send is an error message */
-  WARNING_MSG_TYPE /**< this flag specifies that the message send is a warning message */
+  WARNING_MSG_TYPE, /**< this flag specifies that the message send is a warning message */
+  PREEMPT_MSG_TYPE = OMX_CommandVendorStartUnused + 1 /**< the resource manager preempts the component, the value does not clash with the commands */
 } INTERNAL_MESSAGE_TYPE;
 
 /** @brief The container of an internal message
@@ -118,35 +124,40 @@ typedef struct internalRequestMessageType {
 
 /**
  * @brief the base descriptor for a ST component
+ *
+ * The fields read by the buffer management thread and by the IL client for
+ * every buffer come first, in the first two cache lines of the structure.
+ * The fields used only at the state changes and by the resource manager
+ * come after them.
  */
 CLASS(omx_base_component_PrivateType)
 #define omx_base_component_PrivateType_FIELDS \
 	OMX_COMPONENTTYPE *openmaxStandComp; /**< The OpenMAX standard data structure describing a component */ \
 	omx_base_PortType **ports; /** @param ports The ports of the component */ \
-	OMX_PORT_PARAM_TYPE sPortTypesParam[NUM_DOMAINS]; /** @param sPortTypesParam OpenMAX standard parameter that contains a short description of the available ports */ \
-	char uniqueID; /**< ID code that identifies an ST static component*/ \
-	char* name; /**< component name */\
+	OMX_CALLBACKTYPE* callbacks; /**< pointer to every client callback function, \
+                                as specified by the standard*/ \
+	OMX_PTR callbackData;/**< Private data that can be send with \
+                        the client callbacks. Not specified by the standard */ \
+	tsem_t* bMgmtSem;/**< @param bMgmtSem the semaphore that control BufferMgmtFunction processing */\
 	OMX_STATETYPE state; /**< The state of the component */ \
 	OMX_TRANS_STATETYPE transientState; /**< The transient state in case of transition between \
                               Loaded/waitForResources - Idle. It is equal to  \
                               Invalid if the state or transition are not corect \
                               Loaded when the transition is from Idle to Loaded \
                               Idle when the transition is from Loaded to Idle */ \
-	OMX_CALLBACKTYPE* callbacks; /**< pointer to every client callback function, \
-                                as specified by the standard*/ \
-	OMX_PTR callbackData;/**< Private data that can be send with \
-                        the client callbacks. Not specified by the standard */ \
+	OMX_BOOL bIsEOSReached; /** @param bIsEOSReached boolean flag is true when EOS has been reached */ \
+	pthread_mutex_t flush_mutex;  /** @param flush_mutex mutex for the flush condition from buffers */ \
+	OMX_MARKTYPE pMark; /**< @param pMark This field holds the private data associated with a mark request, if any */\
+	OMX_PORT_PARAM_TYPE sPortTypesParam[NUM_DOMAINS]; /** @param sPortTypesParam OpenMAX standard parameter that contains a short description of the available ports */ \
+	char uniqueID; /**< ID code that identifies an ST static component*/ \
+	char* name; /**< component name */\
 	queue_t* messageQueue;/**< the queue of all the messages recevied by the component */\
 	tsem_t* messageSem;/**< the semaphore that coordinates the access to the message queue */\
 	OMX_U32 nGroupPriority; /**< @param nGroupPriority Resource management field: component priority (common to a group of components) */\
 	OMX_U32 nGroupID; /**< @param nGroupID ID of a group of components that share the same logical chain */\
 	OMX_PARAM_BELLAGIOTHREADS_ID* bellagioThreads;\
-	OMX_BOOL bIsEOSReached; /** @param bIsEOSReached boolean flag is true when EOS has been reached */ \
-	OMX_MARKTYPE pMark; /**< @param pMark This field holds the private data associated with a mark request, if any */\
-	pthread_mutex_t flush_mutex;  /** @param flush_mutex mutex for the flush condition from buffers */ \
 	tsem_t* flush_all_condition;  /** @param flush_all_condition condition for the flush all buffers */ \
 	tsem_t* flush_condition;  /** @param The flush_condition condition */ \
-	tsem_t* bMgmtSem;/**< @param bMgmtSem the semaphore that control BufferMgmtFunction processing */\
 	tsem_t* bStateSem;/**< @param bMgmtSem the semaphore that control BufferMgmtFunction processing */\
 	pthread_t messageHandlerThread; /** @param  messageHandlerThread This field contains the reference to the thread that receives messages for the components */ \
 	int bufferMgmtThreadID; /** @param  bufferMgmtThreadID The ID of the pthread that process buffers */ \
@@ -160,7 +171,12 @@ CLASS(omx_base_component_PrivateType)
 	OMX_ERRORTYPE (*setQualityLevel)(OMX_COMPONENTTYPE *openmaxStandComp, OMX_U32 nQualityLevel); /** RM entry point. By default is not implemented */ \
 	OMX_U32 nqualitylevels;/**< number of available quality levels */ \
 	multiResourceDescriptor** multiResourceLevel; \
-	int currentQualityLevel; /** if supported the current quality level set for this component */
+	int currentQualityLevel; /** if supported the current quality level set for this component */ \
+	int nResourceId; /**< The index of the component in the resource manager, RM_RESOURCE_UNKNOWN before its first request */\
+	void* pResourceEntry; /**< The entry of the component in the resource manager while it holds or waits for a resource */\
+	void* pSyncStorage; /**< The block holding the semaphores, the message queue and the name, allocated by the base constructor */\
+	const char* sKernelName; /**< The name of the kernel the component runs, NULL if it has no kernels to choose from */\
+	OMX_U32 nStorageSize; /**< The size of the block allocated by omx_base_component_AllocPrivate, starting with this structure, 0 if the component allocated it itself */
 ENDCLASS(omx_base_component_PrivateType)
 
 void base_constructor_remove_garbage_collected(omx_base_component_PrivateType* omx_base_component_Private);
@@ -183,6 +199,34 @@ void base_constructor_remove_garbage_collected(omx_base_component_PrivateType* o
  */
 OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
 
+/**
+ * @brief Allocates the private structure of a component with its ports
+ *
+ * The private structure, the array of the ports, the ports and the
+ * synchronization objects of the component and of each port are laid out
+ * in a single zeroed block aligned to the cache line, each object starting
+ * on its own line. A derived constructor calls it in place of allocating
+ * pComponentPrivate. The base and port constructors then use the objects
+ * found in the block, the destructors leave them to
+ * omx_base_component_ComponentDeInit, that frees the block with the private
+ * structure.
+ *
+ * @param openmaxStandComp the component, whose pComponentPrivate is set
+ * @param nPrivateSize the size of the private structure of the component
+ * @param nPorts the number of ports
+ * @param nPortSize the size of the structure of the largest port
+ *
+ * @return OMX_ErrorInsufficientResources if the allocation fails
+ */
+OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_component_AllocPrivate(OMX_COMPONENTTYPE *openmaxStandComp, size_t nPrivateSize, OMX_U32 nPorts, size_t nPortSize);
+
+/**
+ * @brief Frees the array of the ports of a component, a port or its
+ * synchronization objects, unless they lie in the block allocated by
+ * omx_base_component_AllocPrivate
+ */
+OSCL_IMPORT_REF void omx_base_component_FreeStorage(OMX_COMPONENTTYPE *openmaxStandComp, void* pObject);
+
 /** @brief the base destructor for ST OpenMAX components
  *
  * This function is called by the standard function ComponentDeInit()
@@ -346,6 +390,17 @@ OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_component_SendCommand(
   OMX_U32 nParam,
   OMX_PTR pCmdData);
 
+/** @brief queues the preemption of the component by the resource manager
+ *
+ * The message thread of the component then moves it to Loaded, so that
+ * the caller does not wait for the buffers to be returned and freed.
+ * An Executing or Paused component goes first to Idle, returning its
+ * buffers, and sends OMX_ErrorResourcesPreempted. An Idle component sends
+ * OMX_ErrorResourcesLost and waits for the IL client to free its buffers.
+ */
+OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_component_Preempt(
+  OMX_COMPONENTTYPE *openmaxStandComp);
+
 /** @brief This standard functionality is called when the component is
  * destroyed in the FreeHandle standard call.
  *
@@ -378,6 +433,13 @@ void* compMessageHandlerFunction(void*);
  */
 OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_component_MessageHandler(OMX_COMPONENTTYPE *openmaxStandComp,internalRequestMessageType* message);
 
+/** Flushes all the ports of the component, stopping the buffer
+ * management thread only once when the ports use the base flush function
+ *
+ * @param openmaxStandComp the component to be flushed
+ */
+OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_component_FlushAllPorts(OMX_COMPONENTTYPE *openmaxStandComp);
+
 /**
  * This function verify Component State and Structure header
  */
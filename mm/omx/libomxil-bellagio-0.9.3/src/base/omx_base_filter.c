@@ -75,6 +75,43 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_filter_Destructor(OMX_COMPONENTTYPE *open
 	  return OMX_ErrorNone;
 }
 
+/** Tells if the output buffer must be returned before the input buffer is
+  * packed in it: the input data don't fit, start a new time line, are too
+  * late for the coalescing duration, or carry a mark while the output
+  * buffer already has one
+  */
+static OMX_BOOL omx_base_filter_IsCoalescingDone(omx_base_filter_PrivateType* omx_base_filter_Private, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_base_PortType *pOutPort=(omx_base_PortType *)omx_base_filter_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+
+  if(pOutputBuffer->nFilledLen == 0) {
+    return OMX_FALSE;
+  }
+  if(pInputBuffer->nFilledLen > pOutputBuffer->nAllocLen - pOutputBuffer->nFilledLen) {
+    return OMX_TRUE;
+  }
+  if((pInputBuffer->nFlags & OMX_BUFFERFLAG_STARTTIME) == OMX_BUFFERFLAG_STARTTIME) {
+    return OMX_TRUE;
+  }
+  if(pOutPort->nCoalesceDuration != 0 && pInputBuffer->nTimeStamp - pOutputBuffer->nTimeStamp >= (OMX_TICKS)pOutPort->nCoalesceDuration) {
+    return OMX_TRUE;
+  }
+  if(omx_base_filter_Private->pMark.hMarkTargetComponent != NULL && pOutputBuffer->hMarkTargetComponent != NULL) {
+    return OMX_TRUE;
+  }
+  return OMX_FALSE;
+}
+
+/** Tells if a coalesced output buffer can be returned after the callback
+  * produced nLastLen bytes in it: it reached the coalescing byte count or
+  * another buffer as big as the last one would not fit
+  */
+static OMX_BOOL omx_base_filter_IsCoalescingFull(omx_base_PortType *pOutPort, OMX_BUFFERHEADERTYPE* pOutputBuffer, OMX_U32 nLastLen) {
+  if(pOutPort->nCoalesceBytes != 0 && pOutputBuffer->nFilledLen >= pOutPort->nCoalesceBytes) {
+    return OMX_TRUE;
+  }
+  return (pOutputBuffer->nAllocLen - pOutputBuffer->nFilledLen < nLastLen) ? OMX_TRUE : OMX_FALSE;
+}
+
 /** This is the central function for component processing. It
   * is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
@@ -93,6 +130,11 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
   OMX_BUFFERHEADERTYPE* pInputBuffer=NULL;
   OMX_BOOL isInputBufferNeeded=OMX_TRUE,isOutputBufferNeeded=OMX_TRUE;
   int inBufExchanged=0,outBufExchanged=0;
+  OMX_U32 nCoalescedLen=0;
+
+  if (omx_base_filter_Private->BufferMgmtBatchCallback && !PORT_IS_COALESCING(pOutPort)) {
+    return omx_base_filter_BatchBufferMgmtFunction(param);
+  }
 
   omx_base_filter_Private->bellagioThreads->nThreadBufferMngtID = (long int)syscall(__NR_gettid);
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s of component %p\n", __func__, openmaxStandComp);
@@ -211,6 +253,15 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
 
     if(isInputBufferNeeded==OMX_FALSE && isOutputBufferNeeded==OMX_FALSE) {
 
+      if(PORT_IS_COALESCING(pOutPort) && omx_base_filter_IsCoalescingDone(omx_base_filter_Private, pInputBuffer, pOutputBuffer)) {
+        /*The input buffer can't be packed with the data already in the output buffer*/
+        pOutPort->ReturnBufferFunction(pOutPort,pOutputBuffer);
+        outBufExchanged--;
+        pOutputBuffer=NULL;
+        isOutputBufferNeeded=OMX_TRUE;
+        continue;
+      }
+
       if(omx_base_filter_Private->pMark.hMarkTargetComponent != NULL){
         pOutputBuffer->hMarkTargetComponent = omx_base_filter_Private->pMark.hMarkTargetComponent;
         pOutputBuffer->pMarkData            = omx_base_filter_Private->pMark.pMarkData;
@@ -218,15 +269,30 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
         omx_base_filter_Private->pMark.pMarkData            = NULL;
       }
 
-      pOutputBuffer->nTimeStamp = pInputBuffer->nTimeStamp;
+      /*A coalesced output buffer keeps the time stamp of its first data*/
+      if(pOutputBuffer->nFilledLen == 0 || !PORT_IS_COALESCING(pOutPort)) {
+        pOutputBuffer->nTimeStamp = pInputBuffer->nTimeStamp;
+      }
       if((pInputBuffer->nFlags & OMX_BUFFERFLAG_STARTTIME) == OMX_BUFFERFLAG_STARTTIME) {
          DEBUG(DEB_LEV_FULL_SEQ, "Detected  START TIME flag in the input buffer filled len=%d\n", (int)pInputBuffer->nFilledLen);
          pOutputBuffer->nFlags = pInputBuffer->nFlags;
          pInputBuffer->nFlags = 0;
       }
 
+      nCoalescedLen = 0;
       if(omx_base_filter_Private->state == OMX_StateExecuting)  {
-        if (omx_base_filter_Private->BufferMgmtCallback && pInputBuffer->nFilledLen > 0) {
+        if (omx_base_filter_Private->BufferMgmtCallback && pInputBuffer->nFilledLen > 0 && PORT_IS_COALESCING(pOutPort)) {
+          /*The callback sees only the free space of the output buffer, after the data already packed*/
+          nCoalescedLen = pOutputBuffer->nFilledLen;
+          pOutputBuffer->pBuffer += nCoalescedLen;
+          pOutputBuffer->nAllocLen -= nCoalescedLen;
+          pOutputBuffer->nFilledLen = 0;
+          (*(omx_base_filter_Private->BufferMgmtCallback))(openmaxStandComp, pInputBuffer, pOutputBuffer);
+          pOutputBuffer->pBuffer -= nCoalescedLen;
+          pOutputBuffer->nAllocLen += nCoalescedLen;
+          pOutputBuffer->nFilledLen += nCoalescedLen;
+          nCoalescedLen = pOutputBuffer->nFilledLen - nCoalescedLen;
+        } else if (omx_base_filter_Private->BufferMgmtCallback && pInputBuffer->nFilledLen > 0) {
           (*(omx_base_filter_Private->BufferMgmtCallback))(openmaxStandComp, pInputBuffer, pOutputBuffer);
         } else {
           /*It no buffer management call back the explicitly consume input buffer*/
@@ -257,7 +323,8 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
       }
 
       /*If EOS and Input buffer Filled Len Zero then Return output buffer immediately*/
-      if((pOutputBuffer->nFilledLen != 0) || ((pOutputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) || (omx_base_filter_Private->bIsEOSReached == OMX_TRUE)) {
+      if(((pOutputBuffer->nFilledLen != 0) && (!PORT_IS_COALESCING(pOutPort) || omx_base_filter_IsCoalescingFull(pOutPort, pOutputBuffer, nCoalescedLen))) ||
+         ((pOutputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) || (omx_base_filter_Private->bIsEOSReached == OMX_TRUE)) {
         pOutPort->ReturnBufferFunction(pOutPort,pOutputBuffer);
         outBufExchanged--;
         pOutputBuffer=NULL;
@@ -281,3 +348,155 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s of component %p\n", __func__, openmaxStandComp);
   return NULL;
 }
+
+/** Chooses the output buffer carrying the EOS of a consumed input buffer:
+  * the one already flagged by the component if any, otherwise the last
+  * filled one, otherwise the first one.
+  */
+static OMX_BUFFERHEADERTYPE* omx_base_filter_GetEOSOutputBuffer(OMX_BUFFERHEADERTYPE** pOutputBuffers, int nOutputBuffers) {
+  int i, nLastFilled = 0;
+
+  for (i = 0; i < nOutputBuffers; i++) {
+    if ((pOutputBuffers[i]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+      return pOutputBuffers[i];
+    }
+    if (pOutputBuffers[i]->nFilledLen != 0) {
+      nLastFilled = i;
+    }
+  }
+  return pOutputBuffers[nLastFilled];
+}
+
+/** This is the central function for component processing when the
+  * component provides a batch callback. At each wakeup all the buffers
+  * queued on the ports, up to BUFFER_BATCH_SIZE per port, are taken with
+  * a single lock of each queue, handed at once to the callback and the
+  * processed ones are returned together.
+  */
+void* omx_base_filter_BatchBufferMgmtFunction (void* param) {
+  OMX_COMPONENTTYPE* openmaxStandComp = (OMX_COMPONENTTYPE*)param;
+  omx_base_filter_PrivateType* omx_base_filter_Private = (omx_base_filter_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_PortType *pInPort=(omx_base_PortType *)omx_base_filter_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  omx_base_PortType *pOutPort=(omx_base_PortType *)omx_base_filter_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+  tsem_t* pInputSem = pInPort->pBufferSem;
+  tsem_t* pOutputSem = pOutPort->pBufferSem;
+  OMX_BUFFERHEADERTYPE* pInputBuffers[BUFFER_BATCH_SIZE];
+  OMX_BUFFERHEADERTYPE* pOutputBuffers[BUFFER_BATCH_SIZE];
+  OMX_BUFFERHEADERTYPE* pEOSBuffer;
+  int nInputBuffers=0,nOutputBuffers=0,nNewInputBuffers,i;
+
+  omx_base_filter_Private->bellagioThreads->nThreadBufferMngtID = (long int)syscall(__NR_gettid);
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s of component %p\n", __func__, openmaxStandComp);
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the thread ID is %i\n", __func__, (int)omx_base_filter_Private->bellagioThreads->nThreadBufferMngtID);
+
+  /* checks if the component is in a state able to receive buffers */
+  while(omx_base_filter_Private->state == OMX_StateIdle || omx_base_filter_Private->state == OMX_StateExecuting ||  omx_base_filter_Private->state == OMX_StatePause ||
+    omx_base_filter_Private->transientState == OMX_TransStateLoadedToIdle){
+
+    /*Wait till the ports are being flushed*/
+    pthread_mutex_lock(&omx_base_filter_Private->flush_mutex);
+    while( PORT_IS_BEING_FLUSHED(pInPort) ||
+           PORT_IS_BEING_FLUSHED(pOutPort)) {
+      pthread_mutex_unlock(&omx_base_filter_Private->flush_mutex);
+
+      if(PORT_IS_BEING_FLUSHED(pOutPort)) {
+        nOutputBuffers = base_port_ReturnProcessedBuffers(pOutPort, pOutputBuffers, nOutputBuffers, OMX_TRUE);
+      }
+      if(PORT_IS_BEING_FLUSHED(pInPort)) {
+        nInputBuffers = base_port_ReturnProcessedBuffers(pInPort, pInputBuffers, nInputBuffers, OMX_TRUE);
+      }
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s signaling flush all cond in=%d,out=%d\n", __func__, nInputBuffers, nOutputBuffers);
+
+      tsem_up(omx_base_filter_Private->flush_all_condition);
+      tsem_down(omx_base_filter_Private->flush_condition);
+      pthread_mutex_lock(&omx_base_filter_Private->flush_mutex);
+    }
+    pthread_mutex_unlock(&omx_base_filter_Private->flush_mutex);
+
+    /*No buffer to take. So wait here*/
+    if(!(pInputSem->semval>0 && nInputBuffers<BUFFER_BATCH_SIZE) &&
+       !(pOutputSem->semval>0 && nOutputBuffers<BUFFER_BATCH_SIZE) &&
+       (omx_base_filter_Private->state != OMX_StateLoaded && omx_base_filter_Private->state != OMX_StateInvalid)) {
+      //Signaled from EmptyThisBuffer or FillThisBuffer or some thing else
+      DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next input/output buffer\n");
+      tsem_down(omx_base_filter_Private->bMgmtSem);
+    }
+    if(omx_base_filter_Private->state == OMX_StateLoaded || omx_base_filter_Private->state == OMX_StateInvalid) {
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s Buffer Management Thread is exiting\n",__func__);
+      break;
+    }
+
+    nNewInputBuffers = base_port_DequeueBuffers(pInPort, pInputBuffers + nInputBuffers, BUFFER_BATCH_SIZE - nInputBuffers);
+    nOutputBuffers += base_port_DequeueBuffers(pOutPort, pOutputBuffers + nOutputBuffers, BUFFER_BATCH_SIZE - nOutputBuffers);
+
+    for(i = nInputBuffers; i < nInputBuffers + nNewInputBuffers; i++) {
+      if(pInputBuffers[i]->hMarkTargetComponent != NULL){
+        if((OMX_COMPONENTTYPE*)pInputBuffers[i]->hMarkTargetComponent ==(OMX_COMPONENTTYPE *)openmaxStandComp) {
+          /*Clear the mark and generate an event*/
+          (*(omx_base_filter_Private->callbacks->EventHandler))
+            (openmaxStandComp,
+            omx_base_filter_Private->callbackData,
+            OMX_EventMark, /* The command was completed */
+            1, /* The commands was a OMX_CommandStateSet */
+            0, /* The state has been changed in message->messageParam2 */
+            pInputBuffers[i]->pMarkData);
+        } else {
+          /*If this is not the target component then pass the mark*/
+          omx_base_filter_Private->pMark.hMarkTargetComponent = pInputBuffers[i]->hMarkTargetComponent;
+          omx_base_filter_Private->pMark.pMarkData            = pInputBuffers[i]->pMarkData;
+        }
+        pInputBuffers[i]->hMarkTargetComponent = NULL;
+      }
+    }
+    nInputBuffers += nNewInputBuffers;
+
+    if(nInputBuffers == 0 || nOutputBuffers == 0 || PORT_IS_BEING_FLUSHED(pInPort) || PORT_IS_BEING_FLUSHED(pOutPort)) {
+      continue;
+    }
+
+    if(omx_base_filter_Private->state==OMX_StatePause) {
+      /*Waiting at paused state*/
+      tsem_wait(omx_base_filter_Private->bStateSem);
+    }
+    if(omx_base_filter_Private->state != OMX_StateExecuting) {
+      continue;
+    }
+
+    (*(omx_base_filter_Private->BufferMgmtBatchCallback))(openmaxStandComp,
+      pInputBuffers, nInputBuffers, pOutputBuffers, nOutputBuffers);
+
+    for(i = 0; i < nInputBuffers; i++) {
+      if((pInputBuffers[i]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS && pInputBuffers[i]->nFilledLen==0) {
+        DEBUG(DEB_LEV_FULL_SEQ, "Detected EOS flags in input buffer %d\n", i);
+        pEOSBuffer = omx_base_filter_GetEOSOutputBuffer(pOutputBuffers, nOutputBuffers);
+        pEOSBuffer->nFlags |= pInputBuffers[i]->nFlags;
+        pInputBuffers[i]->nFlags=0;
+        (*(omx_base_filter_Private->callbacks->EventHandler))
+          (openmaxStandComp,
+          omx_base_filter_Private->callbackData,
+          OMX_EventBufferFlag, /* The command was completed */
+          1, /* The commands was a OMX_CommandStateSet */
+          pEOSBuffer->nFlags, /* The state has been changed in message->messageParam2 */
+          NULL);
+        omx_base_filter_Private->bIsEOSReached = OMX_TRUE;
+      }
+    }
+
+    if(omx_base_filter_Private->pMark.hMarkTargetComponent != NULL){
+      for(i = 0; i < nOutputBuffers; i++) {
+        if(pOutputBuffers[i]->nFilledLen != 0 || (pOutputBuffers[i]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+          pOutputBuffers[i]->hMarkTargetComponent = omx_base_filter_Private->pMark.hMarkTargetComponent;
+          pOutputBuffers[i]->pMarkData            = omx_base_filter_Private->pMark.pMarkData;
+          omx_base_filter_Private->pMark.hMarkTargetComponent = NULL;
+          omx_base_filter_Private->pMark.pMarkData            = NULL;
+          break;
+        }
+      }
+    }
+
+    nOutputBuffers = base_port_ReturnProcessedBuffers(pOutPort, pOutputBuffers, nOutputBuffers, OMX_FALSE);
+    nInputBuffers = base_port_ReturnProcessedBuffers(pInPort, pInputBuffers, nInputBuffers, OMX_FALSE);
+  }
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s of component %p\n", __func__, openmaxStandComp);
+  return NULL;
+}
@@ -53,7 +53,11 @@ DERIVEDCLASS(omx_base_filter_PrivateType, omx_base_component_PrivateType)
   /** @param pPendingOutputBuffer pending Output Buffer pointer */ \
   OMX_BUFFERHEADERTYPE* pPendingOutputBuffer; \
   /** @param BufferMgmtCallback function pointer for algorithm callback */ \
-  void (*BufferMgmtCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* inputbuffer, OMX_BUFFERHEADERTYPE* outputbuffer);
+  void (*BufferMgmtCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* inputbuffer, OMX_BUFFERHEADERTYPE* outputbuffer); \
+  /** @param BufferMgmtBatchCallback optional function pointer for algorithm callback working on all the available buffers. \
+    * Input buffers left with nFilledLen zero are returned, output buffers with nFilledLen not zero or the EOS flag are returned, \
+    * all the others are handed again at the next call */ \
+  void (*BufferMgmtBatchCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE** pInputBuffers, OMX_U32 nInputBuffers, OMX_BUFFERHEADERTYPE** pOutputBuffers, OMX_U32 nOutputBuffers);
 ENDCLASS(omx_base_filter_PrivateType)
 
 /**
@@ -79,4 +83,10 @@ OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_filter_Destructor(OMX_COMPONENTTYPE *open
  */
 void* omx_base_filter_BufferMgmtFunction(void* param);
 
+/** Central processing function used when the component sets a
+ * BufferMgmtBatchCallback. All the buffers available on both ports
+ * at each wakeup are handed to the callback at once.
+ */
+void* omx_base_filter_BatchBufferMgmtFunction(void* param);
+
 #endif
@@ -36,6 +36,17 @@
 #define DEFAULT_NUMBER_BUFFERS_PER_PORT 2
 /** The default value for the minimum number of needed buffers for each port. */
 #define DEFAULT_MIN_NUMBER_BUFFERS_PER_PORT 2
+
+/** Frees an object of the port, unless it belongs to the block of the
+  * synchronization objects
+  */
+static void base_port_FreeSyncObject(omx_base_PortType *openmaxStandPort, void* pObject) {
+  char* pStorage = openmaxStandPort->pSyncStorage;
+
+  if (pStorage == NULL || (char*)pObject < pStorage || (char*)pObject >= pStorage + sizeof(base_port_SyncStorage)) {
+    free(pObject);
+  }
+}
 /**
   * @brief The base contructor for the generic OpenMAX ST port
   *
@@ -53,6 +64,7 @@
   */
 
 OMX_ERRORTYPE base_port_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,omx_base_PortType **openmaxStandPort,OMX_U32 nPortIndex, OMX_BOOL isInput) {
+  base_port_SyncStorage* pSyncStorage;
 
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
 
@@ -72,25 +84,30 @@ OMX_ERRORTYPE base_port_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,omx_base
   (*openmaxStandPort)->eBufferSupplier=OMX_BufferSupplyUnspecified;
   (*openmaxStandPort)->nNumTunnelBuffer=0;
 
-  if((*openmaxStandPort)->pAllocSem==NULL) {
-    (*openmaxStandPort)->pAllocSem = calloc(1,sizeof(tsem_t));
-    if((*openmaxStandPort)->pAllocSem==NULL) {
+  /** Allocate the block of the queue and of the semaphores */
+  if((*openmaxStandPort)->pSyncStorage==NULL) {
+    if(posix_memalign(&(*openmaxStandPort)->pSyncStorage, BASE_CACHE_LINE_SIZE, sizeof(base_port_SyncStorage))) {
+      (*openmaxStandPort)->pSyncStorage = NULL;
       return OMX_ErrorInsufficientResources;
     }
+    memset((*openmaxStandPort)->pSyncStorage, 0, sizeof(base_port_SyncStorage));
+  }
+  pSyncStorage = (*openmaxStandPort)->pSyncStorage;
+
+  if((*openmaxStandPort)->pAllocSem==NULL) {
+    (*openmaxStandPort)->pAllocSem = &pSyncStorage->allocSem;
     tsem_init((*openmaxStandPort)->pAllocSem, 0);
   }
   (*openmaxStandPort)->nNumBufferFlushed=0;
   (*openmaxStandPort)->bIsPortFlushed=OMX_FALSE;
-  /** Allocate and initialize buffer queue */
+  /** Initialize buffer queue */
   if(!(*openmaxStandPort)->pBufferQueue) {
-    (*openmaxStandPort)->pBufferQueue = calloc(1,sizeof(queue_t));
-    if((*openmaxStandPort)->pBufferQueue==NULL) return OMX_ErrorInsufficientResources;
+    (*openmaxStandPort)->pBufferQueue = &pSyncStorage->bufferQueue.queue;
     queue_init((*openmaxStandPort)->pBufferQueue);
   }
-  /*Allocate and initialise port semaphores*/
+  /*Initialise port semaphores*/
   if(!(*openmaxStandPort)->pBufferSem) {
-    (*openmaxStandPort)->pBufferSem = calloc(1,sizeof(tsem_t));
-    if((*openmaxStandPort)->pBufferSem==NULL) return OMX_ErrorInsufficientResources;
+    (*openmaxStandPort)->pBufferSem = &pSyncStorage->bufferSem.sem;
     tsem_init((*openmaxStandPort)->pBufferSem, 0);
   }
 
@@ -110,6 +127,12 @@ OMX_ERRORTYPE base_port_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,omx_base
   (*openmaxStandPort)->bIsEmptyOfBuffers=OMX_FALSE;
   (*openmaxStandPort)->bBufferStateAllocated = NULL;
   (*openmaxStandPort)->pInternalBufferStorage = NULL;
+  (*openmaxStandPort)->pExternalBufferStorage = NULL;
+  (*openmaxStandPort)->pPayloadCache = NULL;
+  (*openmaxStandPort)->pBufferStorage = NULL;
+  (*openmaxStandPort)->nMaxBufferSize = 0;
+  (*openmaxStandPort)->nCoalesceBytes = 0;
+  (*openmaxStandPort)->nCoalesceDuration = 0;
 
   (*openmaxStandPort)->PortDestructor = &base_port_Destructor;
   (*openmaxStandPort)->Port_AllocateBuffer = &base_port_AllocateBuffer;
@@ -145,38 +168,199 @@ OMX_ERRORTYPE base_port_Destructor(omx_base_PortType *openmaxStandPort){
 //		tsem_up(openmaxStandPort->pAllocSem);
  */
 		tsem_deinit(openmaxStandPort->pAllocSem);
-		free(openmaxStandPort->pAllocSem);
+		base_port_FreeSyncObject(openmaxStandPort, openmaxStandPort->pAllocSem);
 		openmaxStandPort->pAllocSem=NULL;
 	}
 	/** Allocate and initialize buffer queue */
 	if(openmaxStandPort->pBufferQueue) {
 		queue_deinit(openmaxStandPort->pBufferQueue);
-		free(openmaxStandPort->pBufferQueue);
+		base_port_FreeSyncObject(openmaxStandPort, openmaxStandPort->pBufferQueue);
 		openmaxStandPort->pBufferQueue=NULL;
 	}
 	/*Allocate and initialize port semaphores*/
 	if(openmaxStandPort->pBufferSem) {
 		tsem_deinit(openmaxStandPort->pBufferSem);
-		free(openmaxStandPort->pBufferSem);
+		base_port_FreeSyncObject(openmaxStandPort, openmaxStandPort->pBufferSem);
 		openmaxStandPort->pBufferSem=NULL;
 	}
+	omx_base_component_FreeStorage(openmaxStandPort->standCompContainer, openmaxStandPort->pSyncStorage);
+	openmaxStandPort->pSyncStorage=NULL;
+	/* the arrays of the slots, if the port is destroyed out of the Loaded state */
+	base_port_ReleasePayloadCache(openmaxStandPort, 0, openmaxStandPort->sPortParam.nBufferCountActual);
+	base_port_FreeBufferStorage(openmaxStandPort);
 
 	pthread_mutex_destroy(&openmaxStandPort->exitMutex);
 
-	free(openmaxStandPort);
+	omx_base_component_FreeStorage(openmaxStandPort->standCompContainer, openmaxStandPort);
 	openmaxStandPort = NULL;
 	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for port %p\n", __func__, openmaxStandPort);
 	return OMX_ErrorNone;
 }
 
+/** @brief Binds a buffer header to a slot of the port buffer storage
+ *
+ * The slot index is stored, biased by one, in the port private field of the header.
+ * The header itself is stored in pExternalBufferStorage, that is the reference used
+ * to validate the buffers received through EmptyThisBuffer/FillThisBuffer.
+ * A NULL header releases the slot, without accessing the header previously bound.
+ */
+void base_port_BindBufferSlot(omx_base_PortType *openmaxStandPort, OMX_U32 nSlot, OMX_BUFFERHEADERTYPE* pBuffer) {
+  openmaxStandPort->pExternalBufferStorage[nSlot] = pBuffer;
+  if (pBuffer) {
+    PORT_BUFFER_PRIVATE(openmaxStandPort, pBuffer) = (OMX_PTR)(unsigned long)(nSlot + 1);
+  }
+}
+
+/** @brief Returns the slot of a buffer header bound to the port
+ *
+ * The lookup does not scan the buffer storage: the slot is read from the
+ * port private field of the header and then checked against the storage.
+ *
+ * @return the slot index, or -1 if the header does not belong to the port
+ */
+int base_port_GetBufferSlot(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer) {
+  unsigned long nSlot;
+
+  if (pBuffer == NULL || openmaxStandPort->pExternalBufferStorage == NULL) {
+    return -1;
+  }
+  nSlot = (unsigned long)PORT_BUFFER_PRIVATE(openmaxStandPort, pBuffer);
+  if (nSlot == 0 || nSlot > openmaxStandPort->sPortParam.nBufferCountActual) {
+    return -1;
+  }
+  nSlot--;
+  if (openmaxStandPort->pExternalBufferStorage[nSlot] != pBuffer ||
+      openmaxStandPort->bBufferStateAllocated[nSlot] == BUFFER_FREE) {
+    return -1;
+  }
+  return (int)nSlot;
+}
+
+/** @brief Gets a payload for the given slot
+ *
+ * The payload kept in the slot since the port was disabled is reused if it is
+ * big enough, otherwise a new one is allocated, at least nMaxBufferSize big.
+ *
+ * @param pAllocLen filled with the size of the returned payload
+ *
+ * @return the payload, or NULL if the memory is not enough
+ */
+static OMX_U8* base_port_GetPayload(omx_base_PortType *openmaxStandPort, OMX_U32 nSlot, OMX_U32 nSizeBytes, OMX_U32* pAllocLen) {
+  OMX_U8* pBuffer = NULL;
+
+  if (openmaxStandPort->pPayloadCache && openmaxStandPort->pPayloadCache[nSlot].pBuffer) {
+    if (openmaxStandPort->pPayloadCache[nSlot].nAllocLen >= nSizeBytes) {
+      pBuffer = openmaxStandPort->pPayloadCache[nSlot].pBuffer;
+      *pAllocLen = openmaxStandPort->pPayloadCache[nSlot].nAllocLen;
+      DEBUG(DEB_LEV_PARAMS, "In %s reusing %i pBuffer=%p\n",__func__, (int)nSlot, pBuffer);
+    } else {
+      free(openmaxStandPort->pPayloadCache[nSlot].pBuffer);
+    }
+    openmaxStandPort->pPayloadCache[nSlot].pBuffer = NULL;
+    openmaxStandPort->pPayloadCache[nSlot].nAllocLen = 0;
+  }
+  if (pBuffer == NULL) {
+    if (nSizeBytes < openmaxStandPort->nMaxBufferSize) {
+      nSizeBytes = openmaxStandPort->nMaxBufferSize;
+    }
+    pBuffer = calloc(1, nSizeBytes);
+    *pAllocLen = nSizeBytes;
+  }
+  return pBuffer;
+}
+
+/** @brief Releases the payload of the given slot
+ *
+ * While the port is being disabled the payload is kept in the slot,
+ * to be reused by base_port_GetPayload, otherwise it is freed.
+ */
+static void base_port_PutPayload(omx_base_PortType *openmaxStandPort, OMX_U32 nSlot, OMX_U8* pBuffer, OMX_U32 nAllocLen) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandPort->standCompContainer->pComponentPrivate;
+
+  if (pBuffer == NULL) {
+    return;
+  }
+  if (openmaxStandPort->pPayloadCache && PORT_IS_BEING_DISABLED(openmaxStandPort) &&
+      omx_base_component_Private->transientState != OMX_TransStateIdleToLoaded) {
+    base_port_ReleasePayloadCache(openmaxStandPort, nSlot, nSlot + 1);
+    openmaxStandPort->pPayloadCache[nSlot].pBuffer = pBuffer;
+    openmaxStandPort->pPayloadCache[nSlot].nAllocLen = nAllocLen;
+    DEBUG(DEB_LEV_PARAMS, "In %s keeping %i pBuffer=%p\n",__func__, (int)nSlot, pBuffer);
+  } else {
+    free(pBuffer);
+  }
+}
+
+/** @brief Frees the payloads kept by the port in the given range of slots
+ */
+void base_port_ReleasePayloadCache(omx_base_PortType *openmaxStandPort, OMX_U32 nStartSlot, OMX_U32 nEndSlot) {
+  OMX_U32 i;
+
+  if (openmaxStandPort->pPayloadCache == NULL) {
+    return;
+  }
+  for (i = nStartSlot; i < nEndSlot; i++) {
+    if (openmaxStandPort->pPayloadCache[i].pBuffer) {
+      free(openmaxStandPort->pPayloadCache[i].pBuffer);
+      openmaxStandPort->pPayloadCache[i].pBuffer = NULL;
+      openmaxStandPort->pPayloadCache[i].nAllocLen = 0;
+    }
+  }
+}
+
+/** @brief Allocates the arrays indexed by buffer slot in a single block
+ *
+ * The block is laid out by decreasing temperature: the external headers and
+ * the states, read for every buffer by base_port_GetBufferSlot, then the
+ * internal headers, then the payload cache, used only when buffers are
+ * allocated or freed. Every array starts on a cache line.
+ */
+OMX_ERRORTYPE base_port_AllocBufferStorage(omx_base_PortType *openmaxStandPort, OMX_U32 nOldCount) {
+  OMX_U32 nCount = openmaxStandPort->sPortParam.nBufferCountActual;
+  size_t nHeadersSize = BASE_CACHE_ALIGN(nCount * sizeof(OMX_BUFFERHEADERTYPE*));
+  size_t nStatesSize = BASE_CACHE_ALIGN(nCount * sizeof(BUFFER_STATUS_FLAG));
+  size_t nPayloadsSize = nCount * sizeof(omx_base_PayloadType);
+  char* pStorage;
+  void* pBlock;
+
+  if (nCount == 0 || posix_memalign(&pBlock, BASE_CACHE_LINE_SIZE, 2 * nHeadersSize + nStatesSize + nPayloadsSize)) {
+    DEBUG(DEB_LEV_ERR, "In %s cannot allocate the storage of %i buffers\n", __func__, (int)nCount);
+    return OMX_ErrorInsufficientResources;
+  }
+  pStorage = pBlock;
+  memset(pStorage, 0, 2 * nHeadersSize + nStatesSize + nPayloadsSize);
+
+  if (openmaxStandPort->pBufferStorage != NULL) {
+    if (nOldCount > nCount) {
+      nOldCount = nCount;
+    }
+    memcpy(pStorage + nHeadersSize + nStatesSize, openmaxStandPort->pInternalBufferStorage, nOldCount * sizeof(OMX_BUFFERHEADERTYPE*));
+    memcpy(pStorage + 2 * nHeadersSize + nStatesSize, openmaxStandPort->pPayloadCache, nOldCount * sizeof(omx_base_PayloadType));
+    free(openmaxStandPort->pBufferStorage);
+  }
+  openmaxStandPort->pBufferStorage = pStorage;
+  openmaxStandPort->pExternalBufferStorage = (OMX_BUFFERHEADERTYPE**)pStorage;
+  openmaxStandPort->bBufferStateAllocated = (BUFFER_STATUS_FLAG*)(pStorage + nHeadersSize);
+  openmaxStandPort->pInternalBufferStorage = (OMX_BUFFERHEADERTYPE**)(pStorage + nHeadersSize + nStatesSize);
+  openmaxStandPort->pPayloadCache = (omx_base_PayloadType*)(pStorage + 2 * nHeadersSize + nStatesSize);
+  return OMX_ErrorNone;
+}
+
+void base_port_FreeBufferStorage(omx_base_PortType *openmaxStandPort) {
+  free(openmaxStandPort->pBufferStorage);
+  openmaxStandPort->pBufferStorage = NULL;
+  openmaxStandPort->pExternalBufferStorage = NULL;
+  openmaxStandPort->bBufferStateAllocated = NULL;
+  openmaxStandPort->pInternalBufferStorage = NULL;
+  openmaxStandPort->pPayloadCache = NULL;
+}
+
 /** @brief Releases buffers under processing.
  * This function must be implemented in the derived classes, for the
  * specific processing
  */
 OMX_ERRORTYPE base_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort) {
   omx_base_component_PrivateType* omx_base_component_Private;
-  OMX_BUFFERHEADERTYPE* pBuffer;
-  int errQue;
 
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for port %p\n", __func__, openmaxStandPort);
   omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandPort->standCompContainer->pComponentPrivate;
@@ -203,45 +387,8 @@ DEBUG(DEB_LEV_FUNCTION_NAME, "In %s flushed all the buffers under processing\n",
   tsem_reset(omx_base_component_Private->bMgmtSem);
 
   /* Flush all the buffers not under processing */
-  while (openmaxStandPort->pBufferSem->semval > 0) {
-    DEBUG(DEB_LEV_FULL_SEQ, "In %s TFlag=%x Flusing Port=%d,Semval=%d Qelem=%d\n",
-    __func__,(int)openmaxStandPort->nTunnelFlags,(int)openmaxStandPort->sPortParam.nPortIndex,
-    (int)openmaxStandPort->pBufferSem->semval,(int)openmaxStandPort->pBufferQueue->nelem);
-
-    tsem_down(openmaxStandPort->pBufferSem);
-    pBuffer = dequeue(openmaxStandPort->pBufferQueue);
-    if (PORT_IS_TUNNELED(openmaxStandPort) && !PORT_IS_BUFFER_SUPPLIER(openmaxStandPort)) {
-      DEBUG(DEB_LEV_FULL_SEQ, "In %s: Comp %s is returning io:%d buffer\n",
-        __func__,omx_base_component_Private->name,(int)openmaxStandPort->sPortParam.nPortIndex);
-      if (openmaxStandPort->sPortParam.eDir == OMX_DirInput) {
-        ((OMX_COMPONENTTYPE*)(openmaxStandPort->hTunneledComponent))->FillThisBuffer(openmaxStandPort->hTunneledComponent, pBuffer);
-      } else {
-        ((OMX_COMPONENTTYPE*)(openmaxStandPort->hTunneledComponent))->EmptyThisBuffer(openmaxStandPort->hTunneledComponent, pBuffer);
-      }
-    } else if (PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort)) {
-        errQue = queue(openmaxStandPort->pBufferQueue,pBuffer);
-        if (errQue) {
-      	  /* /TODO the queue is full. This can be handled in a fine way with
-      	   * some retrials, or other checking. For the moment this is a critical error
-      	   * and simply causes the failure of this call
-      	   */
-      	  return OMX_ErrorInsufficientResources;
-        }
-    } else {
-      (*(openmaxStandPort->BufferProcessedCallback))(
-        openmaxStandPort->standCompContainer,
-        omx_base_component_Private->callbackData,
-        pBuffer);
-    }
-  }
-  /*Port is tunneled and supplier and didn't received all it's buffer then wait for the buffers*/
-  if (PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort)) {
-    while(openmaxStandPort->pBufferQueue->nelem!= openmaxStandPort->nNumAssignedBuffers){
-      tsem_down(openmaxStandPort->pBufferSem);
-      DEBUG(DEB_LEV_PARAMS, "In %s Got a buffer qelem=%d\n",__func__,openmaxStandPort->pBufferQueue->nelem);
-    }
-    tsem_reset(openmaxStandPort->pBufferSem);
-  }
+  base_port_ReturnQueuedBuffers(openmaxStandPort);
+  base_port_WaitTunnelBuffers(openmaxStandPort);
 
   pthread_mutex_lock(&omx_base_component_Private->flush_mutex);
   openmaxStandPort->bIsPortFlushed=OMX_FALSE;
@@ -263,6 +410,132 @@ DEBUG(DEB_LEV_FUNCTION_NAME, "In %s flushed all the buffers under processing\n",
   return OMX_ErrorNone;
 }
 
+/** @brief Returns all the buffers queued on the port to their owner.
+ *
+ * The queue is drained with a single lock of the semaphore and of the
+ * queue, then the buffers are handed back to the tunneled component or
+ * to the IL client. A tunneled supplier keeps its buffers queued, so
+ * only the semaphore is drained. The buffer management thread must not
+ * be using the port, that is the port is being flushed.
+ *
+ * @param openmaxStandPort the reference to the port
+ */
+void base_port_ReturnQueuedBuffers(omx_base_PortType *openmaxStandPort) {
+  omx_base_component_PrivateType* omx_base_component_Private;
+  OMX_BUFFERHEADERTYPE* pBuffers[MAX_QUEUE_ELEMENTS];
+  unsigned int nSem;
+  int nBuffers, i;
+
+  omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandPort->standCompContainer->pComponentPrivate;
+
+  nSem = tsem_down_all(openmaxStandPort->pBufferSem);
+  DEBUG(DEB_LEV_FULL_SEQ, "In %s TFlag=%x Flusing Port=%d,Semval=%d Qelem=%d\n",
+    __func__,(int)openmaxStandPort->nTunnelFlags,(int)openmaxStandPort->sPortParam.nPortIndex,
+    (int)nSem,(int)openmaxStandPort->pBufferQueue->nelem);
+  if (nSem == 0 || PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort)) {
+    return;
+  }
+
+  while (nSem > 0) {
+    nBuffers = dequeue_n(openmaxStandPort->pBufferQueue, (void**)pBuffers,
+                         nSem < MAX_QUEUE_ELEMENTS ? (int)nSem : MAX_QUEUE_ELEMENTS);
+    if (nBuffers == 0) {
+      break;
+    }
+    nSem -= nBuffers;
+    for (i = 0; i < nBuffers; i++) {
+      if (PORT_IS_TUNNELED(openmaxStandPort)) {
+        DEBUG(DEB_LEV_FULL_SEQ, "In %s: Comp %s is returning io:%d buffer\n",
+          __func__,omx_base_component_Private->name,(int)openmaxStandPort->sPortParam.nPortIndex);
+        if (openmaxStandPort->sPortParam.eDir == OMX_DirInput) {
+          ((OMX_COMPONENTTYPE*)(openmaxStandPort->hTunneledComponent))->FillThisBuffer(openmaxStandPort->hTunneledComponent, pBuffers[i]);
+        } else {
+          ((OMX_COMPONENTTYPE*)(openmaxStandPort->hTunneledComponent))->EmptyThisBuffer(openmaxStandPort->hTunneledComponent, pBuffers[i]);
+        }
+      } else {
+        (*(openmaxStandPort->BufferProcessedCallback))(
+          openmaxStandPort->standCompContainer,
+          omx_base_component_Private->callbackData,
+          pBuffers[i]);
+      }
+    }
+  }
+}
+
+/** @brief Takes without blocking up to nMax buffers queued on the port.
+ *
+ * The semaphore and the queue are locked once for all the buffers.
+ *
+ * @param openmaxStandPort the reference to the port
+ * @param pBuffers the array filled with the buffers taken
+ * @param nMax the size of the array
+ *
+ * @return the number of buffers taken
+ */
+int base_port_DequeueBuffers(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE** pBuffers, int nMax) {
+  unsigned int nSem;
+
+  if (nMax <= 0) {
+    return 0;
+  }
+  nSem = tsem_down_max(openmaxStandPort->pBufferSem, (unsigned int)nMax);
+  if (nSem == 0) {
+    return 0;
+  }
+  return dequeue_n(openmaxStandPort->pBufferQueue, (void**)pBuffers, (int)nSem);
+}
+
+/** @brief Returns the processed buffers of an array taken from the port.
+ *
+ * @param openmaxStandPort the reference to the port
+ * @param pBuffers the array of buffers held by the component
+ * @param nBuffers the number of buffers in the array
+ * @param bReturnAll if OMX_TRUE all the buffers are returned
+ *
+ * @return the number of buffers still held
+ */
+int base_port_ReturnProcessedBuffers(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE** pBuffers, int nBuffers, OMX_BOOL bReturnAll) {
+  omx_base_component_PrivateType* omx_base_component_Private;
+  OMX_BOOL bProcessed;
+  int i, nHeld = 0;
+
+  omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandPort->standCompContainer->pComponentPrivate;
+  for (i = 0; i < nBuffers; i++) {
+    if (bReturnAll == OMX_TRUE) {
+      bProcessed = OMX_TRUE;
+    } else if (openmaxStandPort->sPortParam.eDir == OMX_DirInput) {
+      bProcessed = (pBuffers[i]->nFilledLen == 0) ? OMX_TRUE : OMX_FALSE;
+    } else {
+      bProcessed = (pBuffers[i]->nFilledLen != 0 ||
+                    (pBuffers[i]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS ||
+                    omx_base_component_Private->bIsEOSReached == OMX_TRUE) ? OMX_TRUE : OMX_FALSE;
+    }
+    if (bProcessed == OMX_TRUE) {
+      openmaxStandPort->ReturnBufferFunction(openmaxStandPort, pBuffers[i]);
+    } else {
+      pBuffers[nHeld++] = pBuffers[i];
+    }
+  }
+  return nHeld;
+}
+
+/** @brief Waits until a tunneled supplier port holds all of its buffers.
+ *
+ * Does nothing if the port is not a tunneled buffer supplier.
+ *
+ * @param openmaxStandPort the reference to the port
+ */
+void base_port_WaitTunnelBuffers(omx_base_PortType *openmaxStandPort) {
+  /*Port is tunneled and supplier and didn't received all it's buffer then wait for the buffers*/
+  if (PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort)) {
+    while(openmaxStandPort->pBufferQueue->nelem!= openmaxStandPort->nNumAssignedBuffers){
+      tsem_down(openmaxStandPort->pBufferSem);
+      DEBUG(DEB_LEV_PARAMS, "In %s Got a buffer qelem=%d\n",__func__,openmaxStandPort->pBufferQueue->nelem);
+    }
+    tsem_reset(openmaxStandPort->pBufferSem);
+  }
+}
+
 /** @brief Disables the port.
  *
  * This function is called due to a request by the IL client
@@ -418,15 +691,16 @@ OMX_ERRORTYPE base_port_AllocateBuffer(
         return OMX_ErrorInsufficientResources;
       }
       setHeader(openmaxStandPort->pInternalBufferStorage[i], sizeof(OMX_BUFFERHEADERTYPE));
-      /* allocate the buffer */
-      openmaxStandPort->pInternalBufferStorage[i]->pBuffer = calloc(1,nSizeBytes);
+      /* allocate the buffer, or reuse the one kept since the port was disabled */
+      openmaxStandPort->pInternalBufferStorage[i]->pBuffer = base_port_GetPayload(openmaxStandPort, i, nSizeBytes,
+                                                              &openmaxStandPort->pInternalBufferStorage[i]->nAllocLen);
       if(openmaxStandPort->pInternalBufferStorage[i]->pBuffer==NULL) {
         return OMX_ErrorInsufficientResources;
       }
-      openmaxStandPort->pInternalBufferStorage[i]->nAllocLen = nSizeBytes;
       openmaxStandPort->pInternalBufferStorage[i]->pPlatformPrivate = openmaxStandPort;
       openmaxStandPort->pInternalBufferStorage[i]->pAppPrivate = pAppPrivate;
       *pBuffer = openmaxStandPort->pInternalBufferStorage[i];
+      base_port_BindBufferSlot(openmaxStandPort, i, *pBuffer);
       openmaxStandPort->bBufferStateAllocated[i] = BUFFER_ALLOCATED;
       openmaxStandPort->bBufferStateAllocated[i] |= HEADER_ALLOCATED;
       if (openmaxStandPort->sPortParam.eDir == OMX_DirInput) {
@@ -498,6 +772,8 @@ OMX_ERRORTYPE base_port_UseBuffer(
         return OMX_ErrorInsufficientResources;
       }
       openmaxStandPort->bIsEmptyOfBuffers = OMX_FALSE;
+      /* the client provides the payload, the one kept for this slot is not needed anymore */
+      base_port_ReleasePayloadCache(openmaxStandPort, i, i + 1);
       setHeader(openmaxStandPort->pInternalBufferStorage[i], sizeof(OMX_BUFFERHEADERTYPE));
 
       openmaxStandPort->pInternalBufferStorage[i]->pBuffer = pBuffer;
@@ -523,6 +799,7 @@ OMX_ERRORTYPE base_port_UseBuffer(
         returnBufferHeader->nOutputPortIndex = openmaxStandPort->sPortParam.nPortIndex;
       }
       *ppBufferHdr = returnBufferHeader;
+      base_port_BindBufferSlot(openmaxStandPort, i, returnBufferHeader);
       openmaxStandPort->nNumAssignedBuffers++;
       DEBUG(DEB_LEV_PARAMS, "openmaxStandPort->nNumAssignedBuffers %i\n", (int)openmaxStandPort->nNumAssignedBuffers);
 
@@ -550,6 +827,7 @@ OMX_ERRORTYPE base_port_FreeBuffer(
   OMX_BUFFERHEADERTYPE* pBuffer) {
 
   unsigned int i;
+  int nSlot;
   OMX_COMPONENTTYPE* omxComponent = openmaxStandPort->standCompContainer;
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)omxComponent->pComponentPrivate;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for port %p\n", __func__, openmaxStandPort);
@@ -574,14 +852,18 @@ OMX_ERRORTYPE base_port_FreeBuffer(
     }
   }
 
-  for(i=0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++){
+  /* start from the slot the header is bound to, so that the matching internal header is released */
+  nSlot = base_port_GetBufferSlot(openmaxStandPort, pBuffer);
+  for(i = (nSlot >= 0) ? nSlot : 0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++){
     if (openmaxStandPort->bBufferStateAllocated[i] & (BUFFER_ASSIGNED | BUFFER_ALLOCATED)) {
 
       openmaxStandPort->bIsFullOfBuffers = OMX_FALSE;
+      base_port_BindBufferSlot(openmaxStandPort, i, NULL);
       if (openmaxStandPort->bBufferStateAllocated[i] & BUFFER_ALLOCATED) {
         if(openmaxStandPort->pInternalBufferStorage[i]->pBuffer){
           DEBUG(DEB_LEV_PARAMS, "In %s freeing %i pBuffer=%p\n",__func__, (int)i, openmaxStandPort->pInternalBufferStorage[i]->pBuffer);
-          free(openmaxStandPort->pInternalBufferStorage[i]->pBuffer);
+          base_port_PutPayload(openmaxStandPort, i, openmaxStandPort->pInternalBufferStorage[i]->pBuffer,
+                               openmaxStandPort->pInternalBufferStorage[i]->nAllocLen);
           openmaxStandPort->pInternalBufferStorage[i]->pBuffer=NULL;
         }
       } else if (openmaxStandPort->bBufferStateAllocated[i] & BUFFER_ASSIGNED) {
@@ -620,7 +902,7 @@ OMX_ERRORTYPE base_port_AllocateTunnelBuffer(
   OMX_U8* pBuffer=NULL;
   OMX_ERRORTYPE eError=OMX_ErrorNone,err;
   int errQue;
-  OMX_U32 numRetry=0,nBufferSize;
+  OMX_U32 numRetry=0,nBufferSize,nAllocLen;
   OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
   OMX_U32 nLocalBufferCountActual;
 
@@ -676,14 +958,14 @@ OMX_ERRORTYPE base_port_AllocateTunnelBuffer(
   }
   for(i=0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++){
     if (openmaxStandPort->bBufferStateAllocated[i] == BUFFER_FREE) {
-      pBuffer = calloc(1,nBufferSize);
+      pBuffer = base_port_GetPayload(openmaxStandPort, i, nBufferSize, &nAllocLen);
       if(pBuffer==NULL) {
         return OMX_ErrorInsufficientResources;
       }
       /*Retry more than once, if the tunneled component is not in Loaded->Idle State*/
       while(numRetry <TUNNEL_USE_BUFFER_RETRY) {
         eError=OMX_UseBuffer(openmaxStandPort->hTunneledComponent,&openmaxStandPort->pInternalBufferStorage[i],
-                             openmaxStandPort->nTunneledPort,NULL,nBufferSize,pBuffer);
+                             openmaxStandPort->nTunneledPort,NULL,nAllocLen,pBuffer);
         if(eError!=OMX_ErrorNone) {
           DEBUG(DEB_LEV_FULL_SEQ,"Tunneled Component Couldn't Use buffer %i From Comp=%s Retry=%d\n",
           i,omx_base_component_Private->name,(int)numRetry);
@@ -715,6 +997,7 @@ OMX_ERRORTYPE base_port_AllocateTunnelBuffer(
         DEBUG(DEB_LEV_ERR,"In %s Tunneled Component Couldn't Use Buffer err = %x \n",__func__,(int)eError);
         return eError;
       }
+      base_port_BindBufferSlot(openmaxStandPort, i, openmaxStandPort->pInternalBufferStorage[i]);
       openmaxStandPort->bBufferStateAllocated[i] = BUFFER_ALLOCATED;
       openmaxStandPort->nNumAssignedBuffers++;
       DEBUG(DEB_LEV_PARAMS, "openmaxStandPort->nNumAssignedBuffers %i\n", (int)openmaxStandPort->nNumAssignedBuffers);
@@ -773,8 +1056,10 @@ OMX_ERRORTYPE base_port_FreeTunnelBuffer(omx_base_PortType *openmaxStandPort,OMX
     if (openmaxStandPort->bBufferStateAllocated[i] & (BUFFER_ASSIGNED | BUFFER_ALLOCATED)) {
 
       openmaxStandPort->bIsFullOfBuffers = OMX_FALSE;
+      base_port_BindBufferSlot(openmaxStandPort, i, NULL);
       if (openmaxStandPort->bBufferStateAllocated[i] & BUFFER_ALLOCATED) {
-        free(openmaxStandPort->pInternalBufferStorage[i]->pBuffer);
+        base_port_PutPayload(openmaxStandPort, i, openmaxStandPort->pInternalBufferStorage[i]->pBuffer,
+                             openmaxStandPort->pInternalBufferStorage[i]->nAllocLen);
         openmaxStandPort->pInternalBufferStorage[i]->pBuffer = NULL;
       }
       /*Retry more than once, if the tunneled component is not in Idle->Loaded State*/
@@ -819,15 +1104,11 @@ OMX_ERRORTYPE base_port_SendBufferFunction(
   omx_base_PortType *openmaxStandPort,
   OMX_BUFFERHEADERTYPE* pBuffer) {
 
-  OMX_ERRORTYPE err;
   int errQue;
   OMX_U32 portIndex;
   OMX_COMPONENTTYPE* omxComponent = openmaxStandPort->standCompContainer;
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)omxComponent->pComponentPrivate;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for port %p\n", __func__, openmaxStandPort);
-#if NO_GST_OMX_PATCH
-  unsigned int i;
-#endif
   portIndex = (openmaxStandPort->sPortParam.eDir == OMX_DirInput)?pBuffer->nInputPortIndex:pBuffer->nOutputPortIndex;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s portIndex %lu\n", __func__, portIndex);
 
@@ -855,28 +1136,14 @@ OMX_ERRORTYPE base_port_SendBufferFunction(
     return OMX_ErrorIncorrectStateOperation;
   }
 
-  /* Temporarily disable this check for gst-openmax */
-#if NO_GST_OMX_PATCH
-  {
-  OMX_BOOL foundBuffer = OMX_FALSE;
-  if(pBuffer!=NULL && pBuffer->pBuffer!=NULL) {
-    for(i=0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++){
-    if (pBuffer->pBuffer == openmaxStandPort->pInternalBufferStorage[i]->pBuffer) {
-      foundBuffer = OMX_TRUE;
-      break;
-    }
-    }
-  }
-  if (!foundBuffer) {
+  /* The header must be one of the headers handed out by this port. The check is done on the
+   * header and not on the payload, so it holds also when the client replaces pBuffer (gst-openmax).
+   * The size and version of the header have been set by the port when the slot was bound.
+   */
+  if (base_port_GetBufferSlot(openmaxStandPort, pBuffer) < 0) {
+    DEBUG(DEB_LEV_ERR, "In %s: received unknown buffer header %p on port %d\n", __func__, pBuffer, (int)portIndex);
     return OMX_ErrorBadParameter;
   }
-  }
-#endif
-
-  if ((err = checkHeader(pBuffer, sizeof(OMX_BUFFERHEADERTYPE))) != OMX_ErrorNone) {
-    DEBUG(DEB_LEV_ERR, "In %s: received wrong buffer header on input port\n", __func__);
-    return err;
-  }
 
   /* And notify the buffer management thread we have a fresh new buffer to manage */
   if(!PORT_IS_BEING_FLUSHED(openmaxStandPort) && !(PORT_IS_BEING_DISABLED(openmaxStandPort) && PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort))){
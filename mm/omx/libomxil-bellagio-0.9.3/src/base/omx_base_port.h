@@ -33,6 +33,19 @@
 #define TUNNEL_USE_BUFFER_RETRY 20
 #define TUNNEL_USE_BUFFER_RETRY_USLEEP_TIME 50000
 
+/** Maximum number of buffers per port handed at once to a batch
+  * buffer management callback
+  */
+#define BUFFER_BATCH_SIZE 16
+
+/** Size of a line of the data cache. The objects touched for every buffer
+  * are aligned to it, so that they do not share a line with colder data
+  */
+#define BASE_CACHE_LINE_SIZE 64
+
+/** Rounds a size up to a whole number of cache lines */
+#define BASE_CACHE_ALIGN(nSize) (((nSize) + BASE_CACHE_LINE_SIZE - 1) & ~((size_t)BASE_CACHE_LINE_SIZE - 1))
+
 /**
  * Port Specific Macro's
  */
@@ -44,6 +57,13 @@
 #define PORT_IS_DEEP_TUNNELED(pPort)                             (pPort->nTunnelFlags & PROPRIETARY_COMMUNICATION_ESTABLISHED)
 #define PORT_IS_BUFFER_SUPPLIER(pPort)                           (pPort->nTunnelFlags & TUNNEL_IS_SUPPLIER)
 #define PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(pPort)                ((pPort->nTunnelFlags & TUNNEL_ESTABLISHED) && (pPort->nTunnelFlags & TUNNEL_IS_SUPPLIER))
+#define PORT_IS_COALESCING(pPort)                                (pPort->nCoalesceBytes != 0 || pPort->nCoalesceDuration != 0)
+
+/** The port private field of a buffer header owned by the given port.
+  * Input ports use pInputPortPrivate and output ports use pOutputPortPrivate,
+  * so that the two ends of a tunnel never overwrite each other
+  */
+#define PORT_BUFFER_PRIVATE(pPort, pBuffer)                      (*(((pPort)->sPortParam.eDir == OMX_DirInput) ? &(pBuffer)->pInputPortPrivate : &(pBuffer)->pOutputPortPrivate))
 
 /** The following enum values are used to characterize each buffer
   * allocated or assigned to the component. A buffer list is
@@ -96,16 +116,59 @@ typedef enum TUNNEL_STATUS_FLAG {
 } TUNNEL_STATUS_FLAG;
 
 
+/** A payload allocated by the port and kept while the port is disabled,
+  * so that it can be reused when the port is enabled again
+  */
+typedef struct omx_base_PayloadType {
+  OMX_U8* pBuffer; /**< The payload, NULL if the slot keeps nothing */
+  OMX_U32 nAllocLen; /**< The size of the payload */
+} omx_base_PayloadType;
+
+/** The synchronization objects of a port, allocated in a single block by
+  * the port constructor, or with the port by omx_base_component_AllocPrivate.
+  * The buffer queue and its semaphore are touched for every buffer, by
+  * the IL client and by the buffer management thread: each one gets its
+  * own cache lines. The allocation semaphore is used only at the state
+  * changes.
+  */
+typedef struct base_port_SyncStorage {
+  union {
+    queue_t queue;
+    char line[BASE_CACHE_ALIGN(sizeof(queue_t))];
+  } bufferQueue;
+  union {
+    tsem_t sem;
+    char line[BASE_CACHE_ALIGN(sizeof(tsem_t))];
+  } bufferSem;
+  tsem_t allocSem;
+} base_port_SyncStorage;
+
 /**
  * @brief the base structure that describes each port.
  *
  * The data structure that describes a port contains the basic elements used in the
  * base component. Other elements can be added in the derived components structures.
+ * The fields read for every buffer come first, up to the head of sPortParam
+ * that holds the direction and the enabled flag of the port, in the first two
+ * cache lines of the structure.
  */
 CLASS(omx_base_PortType)
 #define omx_base_PortType_FIELDS \
+  queue_t* pBufferQueue; /**< @param pBufferQueue queue for buffer to be processed by the port */\
+  tsem_t* pBufferSem; /**< @param pBufferSem Semaphore for buffer queue access synchronization */\
+  OMX_BUFFERHEADERTYPE **pExternalBufferStorage; /**< The headers exchanged with the IL client or the tunneled port, indexed as pInternalBufferStorage */\
+  OMX_BUFFERHEADERTYPE **pInternalBufferStorage; /**< This array contains the reference to all the buffers hadled by this port and already registered*/\
+  BUFFER_STATUS_FLAG *bBufferStateAllocated; /**< @param bBufferStateAllocated The State of the Buffer whether assigned or allocated */\
+  OMX_COMPONENTTYPE *standCompContainer;/**< The OpenMAX component reference that contains this port */\
+  OMX_ERRORTYPE (*BufferProcessedCallback)(OMX_HANDLETYPE hComponent, OMX_PTR pAppData, OMX_BUFFERHEADERTYPE* pBuffer);/**< Holds the EmptyBufferDone or FillBufferDone callback, if the port is input or output port */ \
+  OMX_ERRORTYPE (*ReturnBufferFunction)(omx_base_PortType* openmaxStandPort,OMX_BUFFERHEADERTYPE* pBuffer); /**< Call appropriate function to return buffers to peer or IL Client*/ \
+  OMX_ERRORTYPE (*Port_SendBufferFunction)(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer);  /**< Holds the EmptyThisBuffer of FillThisBuffer function, if the port is input or output */ \
   OMX_HANDLETYPE hTunneledComponent; /**< @param hTunneledComponent Handle to the tunnelled component */\
   OMX_U32 nTunnelFlags; /**< This field contains one or more tags that describe the tunnel status of the port */\
+  OMX_BOOL bIsPortFlushed;/**< @param bIsPortFlushed Boolean variables indicate port is being flushed at the moment */ \
+  OMX_U32 nCoalesceBytes; /**< If not zero, an output port packs input data until its buffers hold this many bytes */\
+  OMX_U32 nCoalesceDuration; /**< If not zero, an output port packs input data until its buffers span this many microseconds */ \
+  OMX_PARAM_PORTDEFINITIONTYPE sPortParam; /**< @param sPortParam General OpenMAX port parameter */\
   OMX_U32 nTunneledPort; /**< @param nTunneledPort Tunneled port number */ \
   OMX_BUFFERSUPPLIERTYPE eBufferSupplier; /**< @param eBufferSupplier the type of supplier in case of tunneling */\
   OMX_U32 nNumTunnelBuffer; /**< @param nNumTunnelBuffer Number of buffer to be tunnelled */\
@@ -113,14 +176,7 @@ CLASS(omx_base_PortType)
   pthread_mutex_t exitMutex; /** This mutex synchronizes the access to the boolean variable bIsDestroying */ \
   OMX_BOOL bIsDestroying; /** This variable is set to true when the port has been selected for destruction */ \
   OMX_U32 nNumBufferFlushed; /**< @param nNumBufferFlushed Number of buffer Flushed */\
-  OMX_BOOL bIsPortFlushed;/**< @param bIsPortFlushed Boolean variables indicate port is being flushed at the moment */ \
-  queue_t* pBufferQueue; /**< @param pBufferQueue queue for buffer to be processed by the port */\
-  tsem_t* pBufferSem; /**< @param pBufferSem Semaphore for buffer queue access synchronization */\
   OMX_U32 nNumAssignedBuffers; /**< @param nNumAssignedBuffers Number of buffer assigned on each port */\
-  OMX_PARAM_PORTDEFINITIONTYPE sPortParam; /**< @param sPortParam General OpenMAX port parameter */\
-  OMX_BUFFERHEADERTYPE **pInternalBufferStorage; /**< This array contains the reference to all the buffers hadled by this port and already registered*/\
-  BUFFER_STATUS_FLAG *bBufferStateAllocated; /**< @param bBufferStateAllocated The State of the Buffer whether assigned or allocated */\
-  OMX_COMPONENTTYPE *standCompContainer;/**< The OpenMAX component reference that contains this port */\
   OMX_BOOL bIsTransientToEnabled;/**< It indicates that the port is going from disabled to enabled */ \
   OMX_BOOL bIsTransientToDisabled;/**< It indicates that the port is going from enabled to disabled */ \
   OMX_BOOL bIsFullOfBuffers; /**< It indicates if the port has all the buffers needed */ \
@@ -129,16 +185,17 @@ CLASS(omx_base_PortType)
   OMX_ERRORTYPE (*PortDestructor)(omx_base_PortType *openmaxStandPort); /**< The destructor of the port*/ \
   OMX_ERRORTYPE (*Port_DisablePort)(omx_base_PortType *openmaxStandPort); /**< Disables the port */ \
   OMX_ERRORTYPE (*Port_EnablePort)(omx_base_PortType *openmaxStandPort); /**< Enables the port */ \
-  OMX_ERRORTYPE (*Port_SendBufferFunction)(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer);  /**< Holds the EmptyThisBuffer of FillThisBuffer function, if the port is input or output */ \
   OMX_ERRORTYPE (*Port_AllocateBuffer)(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE** pBuffer, OMX_U32 nPortIndex, OMX_PTR pAppPrivate, OMX_U32 nSizeBytes);/**< Replaces the AllocateBuffer call for the base port. */   \
   OMX_ERRORTYPE (*Port_UseBuffer)(omx_base_PortType *openmaxStandPort,OMX_BUFFERHEADERTYPE** ppBufferHdr,OMX_U32 nPortIndex,OMX_PTR pAppPrivate,OMX_U32 nSizeBytes,OMX_U8* pBuffer);/**< The standard use buffer function applied to the port class */ \
   OMX_ERRORTYPE (*Port_FreeBuffer)(omx_base_PortType *openmaxStandPort,OMX_U32 nPortIndex,OMX_BUFFERHEADERTYPE* pBuffer); /**< The standard free buffer function applied to the port class */ \
   OMX_ERRORTYPE (*Port_AllocateTunnelBuffer)(omx_base_PortType *openmaxStandPort,OMX_U32 nPortIndex);/**< AllocateTunnelBuffer call for the base port. */   \
   OMX_ERRORTYPE (*Port_FreeTunnelBuffer)(omx_base_PortType *openmaxStandPort,OMX_U32 nPortIndex); /**< The free buffer function used to free tunnelled buffers */ \
-  OMX_ERRORTYPE (*BufferProcessedCallback)(OMX_HANDLETYPE hComponent, OMX_PTR pAppData, OMX_BUFFERHEADERTYPE* pBuffer);/**< Holds the EmptyBufferDone or FillBufferDone callback, if the port is input or output port */ \
   OMX_ERRORTYPE (*FlushProcessingBuffers)(omx_base_PortType *openmaxStandPort); /**< release all the buffers currently under processing */ \
-  OMX_ERRORTYPE (*ReturnBufferFunction)(omx_base_PortType* openmaxStandPort,OMX_BUFFERHEADERTYPE* pBuffer); /**< Call appropriate function to return buffers to peer or IL Client*/ \
-  OMX_ERRORTYPE (*ComponentTunnelRequest)(omx_base_PortType* openmaxStandPort, OMX_HANDLETYPE hTunneledComp, OMX_U32 nTunneledPort, OMX_TUNNELSETUPTYPE* pTunnelSetup); /**< Setup tunnel with the port */
+  OMX_ERRORTYPE (*ComponentTunnelRequest)(omx_base_PortType* openmaxStandPort, OMX_HANDLETYPE hTunneledComp, OMX_U32 nTunneledPort, OMX_TUNNELSETUPTYPE* pTunnelSetup); /**< Setup tunnel with the port */ \
+  omx_base_PayloadType *pPayloadCache; /**< The payloads released while the port is being disabled, indexed as pInternalBufferStorage */\
+  void* pSyncStorage; /**< The block holding the buffer queue and the semaphores of the port, allocated by the base constructor */\
+  void* pBufferStorage; /**< The block holding the arrays indexed by buffer slot, allocated at the transition to Idle */\
+  OMX_U32 nMaxBufferSize; /**< The payloads are allocated at least this big, so that they can be reused when nBufferSize grows */
 ENDCLASS(omx_base_PortType)
 
 /**
@@ -234,6 +291,57 @@ OMX_ERRORTYPE base_port_FreeBuffer(
   OMX_U32 nPortIndex,
   OMX_BUFFERHEADERTYPE* pBuffer);
 
+/** @brief Binds a buffer header to a slot of the port buffer storage
+ *
+ * The slot index is recorded in the port private field of the header,
+ * so that the port can recognize its own buffers in constant time.
+ * A NULL header releases the slot.
+ */
+void base_port_BindBufferSlot(
+  omx_base_PortType *openmaxStandPort,
+  OMX_U32 nSlot,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+/** @brief Returns the slot of a buffer header bound to the port
+ *
+ * @return the slot index, or -1 if the header does not belong to the port
+ */
+int base_port_GetBufferSlot(
+  omx_base_PortType *openmaxStandPort,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+/** @brief Allocates the arrays indexed by buffer slot for nBufferCountActual buffers
+ *
+ * pExternalBufferStorage, bBufferStateAllocated, pInternalBufferStorage and
+ * pPayloadCache share one block aligned to the cache line. The first two,
+ * read for every buffer, come first, the payload cache last. If the port
+ * already has the arrays, the internal headers and the payloads of the first
+ * nOldCount slots are kept. All the slots are left free.
+ *
+ * @return OMX_ErrorInsufficientResources if the allocation fails, the previous
+ * arrays are then kept
+ */
+OMX_ERRORTYPE base_port_AllocBufferStorage(
+  omx_base_PortType *openmaxStandPort,
+  OMX_U32 nOldCount);
+
+/** @brief Frees the arrays allocated by base_port_AllocBufferStorage
+ *
+ * The payloads still kept must be released before.
+ */
+void base_port_FreeBufferStorage(omx_base_PortType *openmaxStandPort);
+
+/** @brief Frees the payloads kept by the port in the given range of slots
+ *
+ * @param openmaxStandPort the port keeping the payloads
+ * @param nStartSlot the first slot to be released
+ * @param nEndSlot the slot after the last one to be released
+ */
+void base_port_ReleasePayloadCache(
+  omx_base_PortType *openmaxStandPort,
+  OMX_U32 nStartSlot,
+  OMX_U32 nEndSlot);
+
 /** @brief Releases buffers under processing.
  *
  * This function must be implemented in the derived classes, for the
@@ -241,6 +349,49 @@ OMX_ERRORTYPE base_port_FreeBuffer(
  */
 OMX_ERRORTYPE base_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort);
 
+/** @brief Returns all the buffers queued on the port to their owner.
+ *
+ * The queue is drained in one batch while the port is being flushed.
+ * A tunneled supplier keeps its buffers, only its semaphore is drained.
+ *
+ * @param openmaxStandPort the port to be drained
+ */
+void base_port_ReturnQueuedBuffers(omx_base_PortType *openmaxStandPort);
+
+/** @brief Takes without blocking up to nMax buffers queued on the port.
+ *
+ * Used by the buffer management thread to fetch in one go all the
+ * buffers available for a batch callback.
+ *
+ * @param openmaxStandPort the port the buffers are taken from
+ * @param pBuffers the array filled with the buffers taken
+ * @param nMax the size of the array
+ *
+ * @return the number of buffers taken
+ */
+int base_port_DequeueBuffers(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE** pBuffers, int nMax);
+
+/** @brief Returns the processed buffers of an array taken from the port.
+ *
+ * Input buffers are processed when empty, output buffers when filled,
+ * flagged with EOS or once the component reached the EOS. The buffers
+ * kept are compacted at the start of the array in their order.
+ *
+ * @param openmaxStandPort the port the buffers were taken from
+ * @param pBuffers the array of buffers held by the component
+ * @param nBuffers the number of buffers in the array
+ * @param bReturnAll if OMX_TRUE all the buffers are returned
+ *
+ * @return the number of buffers still held
+ */
+int base_port_ReturnProcessedBuffers(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE** pBuffers, int nBuffers, OMX_BOOL bReturnAll);
+
+/** @brief Waits until a tunneled supplier port got back all of its buffers.
+ *
+ * @param openmaxStandPort the port to wait for
+ */
+void base_port_WaitTunnelBuffers(omx_base_PortType *openmaxStandPort);
+
 /** @brief Returns buffers when processed.
  *
  * Call appropriate function to return buffers to peer or IL Client
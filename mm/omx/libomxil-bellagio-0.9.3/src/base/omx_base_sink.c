@@ -76,6 +76,10 @@ void* omx_base_sink_BufferMgmtFunction (void* param) {
   OMX_BOOL                        isInputBufferNeeded         = OMX_TRUE;
   int                             inBufExchanged              = 0;
 
+  if (omx_base_sink_Private->BufferMgmtBatchCallback) {
+    return omx_base_sink_BatchBufferMgmtFunction(param);
+  }
+
   omx_base_sink_Private->bellagioThreads->nThreadBufferMngtID = (long int)syscall(__NR_gettid);
   DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the thread ID is %i\n", __func__, (int)omx_base_sink_Private->bellagioThreads->nThreadBufferMngtID);
 
@@ -197,6 +201,108 @@ void* omx_base_sink_BufferMgmtFunction (void* param) {
   return NULL;
 }
 
+/** This is the central function for component processing when the
+  * component provides a batch callback. All the buffers queued on the
+  * input port, up to BUFFER_BATCH_SIZE, are taken with a single lock of
+  * the queue, handed at once to the callback and the consumed ones are
+  * returned together.
+  */
+void* omx_base_sink_BatchBufferMgmtFunction (void* param) {
+  OMX_COMPONENTTYPE* openmaxStandComp = (OMX_COMPONENTTYPE*)param;
+  omx_base_component_PrivateType* omx_base_component_Private  = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_sink_PrivateType*      omx_base_sink_Private       = (omx_base_sink_PrivateType*)omx_base_component_Private;
+  omx_base_PortType               *pInPort                    = (omx_base_PortType *)omx_base_sink_Private->ports[OMX_BASE_SINK_INPUTPORT_INDEX];
+  tsem_t*                         pInputSem                   = pInPort->pBufferSem;
+  OMX_BUFFERHEADERTYPE*           pInputBuffers[BUFFER_BATCH_SIZE];
+  int                             nInputBuffers               = 0;
+  int                             nNewInputBuffers, i;
+
+  omx_base_sink_Private->bellagioThreads->nThreadBufferMngtID = (long int)syscall(__NR_gettid);
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the thread ID is %i\n", __func__, (int)omx_base_sink_Private->bellagioThreads->nThreadBufferMngtID);
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s \n", __func__);
+  while(omx_base_component_Private->state == OMX_StateIdle || omx_base_component_Private->state == OMX_StateExecuting ||  omx_base_component_Private->state == OMX_StatePause ||
+    omx_base_component_Private->transientState == OMX_TransStateLoadedToIdle){
+
+    /*Wait till the ports are being flushed*/
+    pthread_mutex_lock(&omx_base_sink_Private->flush_mutex);
+    while( PORT_IS_BEING_FLUSHED(pInPort)) {
+      pthread_mutex_unlock(&omx_base_sink_Private->flush_mutex);
+
+      nInputBuffers = base_port_ReturnProcessedBuffers(pInPort, pInputBuffers, nInputBuffers, OMX_TRUE);
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s signalling flush all condition \n", __func__);
+
+      tsem_up(omx_base_sink_Private->flush_all_condition);
+      tsem_down(omx_base_sink_Private->flush_condition);
+      pthread_mutex_lock(&omx_base_sink_Private->flush_mutex);
+    }
+    pthread_mutex_unlock(&omx_base_sink_Private->flush_mutex);
+
+    /*No buffer to take. So wait here*/
+    if(!(pInputSem->semval>0 && nInputBuffers<BUFFER_BATCH_SIZE) &&
+      (omx_base_sink_Private->state != OMX_StateLoaded && omx_base_sink_Private->state != OMX_StateInvalid)) {
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for input buffer \n");
+      tsem_down(omx_base_sink_Private->bMgmtSem);
+    }
+
+    if(omx_base_sink_Private->state == OMX_StateLoaded || omx_base_sink_Private->state == OMX_StateInvalid) {
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s Buffer Management Thread is exiting\n",__func__);
+      break;
+    }
+
+    nNewInputBuffers = base_port_DequeueBuffers(pInPort, pInputBuffers + nInputBuffers, BUFFER_BATCH_SIZE - nInputBuffers);
+    for(i = nInputBuffers; i < nInputBuffers + nNewInputBuffers; i++) {
+      if((OMX_COMPONENTTYPE*)pInputBuffers[i]->hMarkTargetComponent == (OMX_COMPONENTTYPE *)openmaxStandComp) {
+        /*Clear the mark and generate an event*/
+        (*(omx_base_component_Private->callbacks->EventHandler))
+          (openmaxStandComp,
+          omx_base_component_Private->callbackData,
+          OMX_EventMark, /* The command was completed */
+          1, /* The commands was a OMX_CommandStateSet */
+          0, /* The state has been changed in message->messageParam2 */
+          pInputBuffers[i]->pMarkData);
+      } else if(pInputBuffers[i]->hMarkTargetComponent != NULL) {
+        /*If this is not the target component then pass the mark*/
+        DEBUG(DEB_LEV_FULL_SEQ, "Can't Pass Mark. This is a Sink!!\n");
+      }
+    }
+    nInputBuffers += nNewInputBuffers;
+
+    if(nInputBuffers == 0 || PORT_IS_BEING_FLUSHED(pInPort)) {
+      continue;
+    }
+
+    if(omx_base_sink_Private->state==OMX_StatePause) {
+      /*Waiting at paused state*/
+      tsem_wait(omx_base_sink_Private->bStateSem);
+    }
+    if((omx_base_sink_Private->state != OMX_StateExecuting) && (omx_base_sink_Private->state != OMX_StateIdle)) {
+      continue;
+    }
+
+    (*(omx_base_sink_Private->BufferMgmtBatchCallback))(openmaxStandComp, pInputBuffers, nInputBuffers);
+
+    for(i = 0; i < nInputBuffers; i++) {
+      if((pInputBuffers[i]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS && pInputBuffers[i]->nFilledLen == 0) {
+        DEBUG(DEB_LEV_SIMPLE_SEQ, "Detected EOS flags in input buffer\n");
+
+        (*(omx_base_component_Private->callbacks->EventHandler))
+          (openmaxStandComp,
+          omx_base_component_Private->callbackData,
+          OMX_EventBufferFlag, /* The command was completed */
+          0, /* The commands was a OMX_CommandStateSet */
+          pInputBuffers[i]->nFlags, /* The state has been changed in message->messageParam2 */
+          NULL);
+        pInputBuffers[i]->nFlags=0;
+      }
+    }
+
+    nInputBuffers = base_port_ReturnProcessedBuffers(pInPort, pInputBuffers, nInputBuffers, OMX_FALSE);
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ,"Exiting Buffer Management Thread\n");
+  return NULL;
+}
+
 /** This is the central function for buffer processing of a two port sink component.
   * It is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
@@ -46,7 +46,10 @@
 DERIVEDCLASS(omx_base_sink_PrivateType, omx_base_component_PrivateType)
 #define omx_base_sink_PrivateType_FIELDS omx_base_component_PrivateType_FIELDS \
   /** @param BufferMgmtCallback function pointer for algorithm callback */ \
-  void (*BufferMgmtCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* inputbuffer);
+  void (*BufferMgmtCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* inputbuffer); \
+  /** @param BufferMgmtBatchCallback optional function pointer for algorithm callback working on all the available buffers. \
+    * Input buffers left with nFilledLen zero are returned, the others are handed again at the next call */ \
+  void (*BufferMgmtBatchCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE** pInputBuffers, OMX_U32 nInputBuffers);
 ENDCLASS(omx_base_sink_PrivateType)
 
 /** Base sink contructor
@@ -64,6 +67,12 @@ OMX_ERRORTYPE omx_base_sink_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
  */
 void* omx_base_sink_BufferMgmtFunction(void* param);
 
+/** Central processing function used when the component sets a
+ * BufferMgmtBatchCallback. All the buffers available at each wakeup
+ * are handed to the callback at once.
+ */
+void* omx_base_sink_BatchBufferMgmtFunction(void* param);
+
 void* omx_base_sink_twoport_BufferMgmtFunction (void* param);
 
 #endif
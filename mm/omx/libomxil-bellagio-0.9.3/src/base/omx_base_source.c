@@ -78,6 +78,10 @@ void* omx_base_source_BufferMgmtFunction (void* param) {
   OMX_BOOL isOutputBufferNeeded = OMX_TRUE;
   int outBufExchanged = 0;
 
+  if (omx_base_source_Private->BufferMgmtBatchCallback) {
+    return omx_base_source_BatchBufferMgmtFunction(param);
+  }
+
   omx_base_source_Private->bellagioThreads->nThreadBufferMngtID = (long int)syscall(__NR_gettid);
   DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the thread ID is %i\n", __func__, (int)omx_base_source_Private->bellagioThreads->nThreadBufferMngtID);
 
@@ -202,6 +206,117 @@ void* omx_base_source_BufferMgmtFunction (void* param) {
   return NULL;
 }
 
+/** This is the central function for component processing when the
+  * component provides a batch callback. All the buffers queued on the
+  * output port, up to BUFFER_BATCH_SIZE, are taken with a single lock of
+  * the queue, handed at once to the callback and the produced ones are
+  * returned together.
+  */
+void* omx_base_source_BatchBufferMgmtFunction (void* param) {
+  OMX_COMPONENTTYPE* openmaxStandComp = (OMX_COMPONENTTYPE*)param;
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_source_PrivateType* omx_base_source_Private = (omx_base_source_PrivateType*)omx_base_component_Private;
+  omx_base_PortType *pOutPort = (omx_base_PortType *)omx_base_source_Private->ports[OMX_BASE_SOURCE_OUTPUTPORT_INDEX];
+  tsem_t* pOutputSem = pOutPort->pBufferSem;
+  OMX_BUFFERHEADERTYPE* pOutputBuffers[BUFFER_BATCH_SIZE];
+  int nOutputBuffers = 0;
+  int nNewOutputBuffers, i;
+
+  omx_base_source_Private->bellagioThreads->nThreadBufferMngtID = (long int)syscall(__NR_gettid);
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the thread ID is %i\n", __func__, (int)omx_base_source_Private->bellagioThreads->nThreadBufferMngtID);
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s \n", __func__);
+  while(omx_base_component_Private->state == OMX_StateIdle || omx_base_component_Private->state == OMX_StateExecuting ||
+    omx_base_component_Private->state == OMX_StatePause || omx_base_component_Private->transientState == OMX_TransStateLoadedToIdle){
+
+    /*Wait till the ports are being flushed*/
+    pthread_mutex_lock(&omx_base_source_Private->flush_mutex);
+    while( PORT_IS_BEING_FLUSHED(pOutPort)) {
+      pthread_mutex_unlock(&omx_base_source_Private->flush_mutex);
+
+      nOutputBuffers = base_port_ReturnProcessedBuffers(pOutPort, pOutputBuffers, nOutputBuffers, OMX_TRUE);
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s signalling flush all condition \n", __func__);
+
+      tsem_up(omx_base_source_Private->flush_all_condition);
+      tsem_down(omx_base_source_Private->flush_condition);
+      pthread_mutex_lock(&omx_base_source_Private->flush_mutex);
+    }
+    pthread_mutex_unlock(&omx_base_source_Private->flush_mutex);
+
+    /*No buffer to take. So wait here*/
+    if(!(pOutputSem->semval>0 && nOutputBuffers<BUFFER_BATCH_SIZE) &&
+      (omx_base_source_Private->state != OMX_StateLoaded && omx_base_source_Private->state != OMX_StateInvalid)) {
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for output buffer \n");
+      tsem_down(omx_base_source_Private->bMgmtSem);
+    }
+
+    if(omx_base_source_Private->state == OMX_StateLoaded || omx_base_source_Private->state == OMX_StateInvalid) {
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s Buffer Management Thread is exiting\n",__func__);
+      break;
+    }
+
+    nNewOutputBuffers = base_port_DequeueBuffers(pOutPort, pOutputBuffers + nOutputBuffers, BUFFER_BATCH_SIZE - nOutputBuffers);
+    for(i = nOutputBuffers; i < nOutputBuffers + nNewOutputBuffers; i++) {
+      if((pOutputBuffers[i]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+        pOutputBuffers[i]->nFlags = 0;
+      }
+    }
+    nOutputBuffers += nNewOutputBuffers;
+
+    if(nOutputBuffers == 0 || PORT_IS_BEING_FLUSHED(pOutPort)) {
+      continue;
+    }
+
+    if(omx_base_source_Private->state == OMX_StatePause) {
+      /*Waiting at paused state*/
+      tsem_wait(omx_base_source_Private->bStateSem);
+    }
+    if(omx_base_source_Private->state != OMX_StateExecuting) {
+      continue;
+    }
+
+    (*(omx_base_source_Private->BufferMgmtBatchCallback))(openmaxStandComp, pOutputBuffers, nOutputBuffers);
+
+    for(i = 0; i < nOutputBuffers; i++) {
+      if(pOutputBuffers[i]->nFilledLen == 0 && (pOutputBuffers[i]->nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS) {
+        continue;
+      }
+      if(omx_base_source_Private->pMark.hMarkTargetComponent != NULL){
+        pOutputBuffers[i]->hMarkTargetComponent = omx_base_source_Private->pMark.hMarkTargetComponent;
+        pOutputBuffers[i]->pMarkData            = omx_base_source_Private->pMark.pMarkData;
+        omx_base_source_Private->pMark.hMarkTargetComponent = NULL;
+        omx_base_source_Private->pMark.pMarkData            = NULL;
+      }
+      if((OMX_COMPONENTTYPE*)pOutputBuffers[i]->hMarkTargetComponent == (OMX_COMPONENTTYPE *)openmaxStandComp) {
+        /*Clear the mark and generate an event*/
+        (*(omx_base_component_Private->callbacks->EventHandler))
+          (openmaxStandComp,
+          omx_base_component_Private->callbackData,
+          OMX_EventMark, /* The command was completed */
+          1, /* The commands was a OMX_CommandStateSet */
+          0, /* The state has been changed in message->messageParam2 */
+          pOutputBuffers[i]->pMarkData);
+      }
+      if((pOutputBuffers[i]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+        DEBUG(DEB_LEV_SIMPLE_SEQ, "Detected EOS flags in output buffer\n");
+
+        (*(omx_base_component_Private->callbacks->EventHandler))
+          (openmaxStandComp,
+          omx_base_component_Private->callbackData,
+          OMX_EventBufferFlag, /* The command was completed */
+          0, /* The commands was a OMX_CommandStateSet */
+          pOutputBuffers[i]->nFlags, /* The state has been changed in message->messageParam2 */
+          NULL);
+        omx_base_source_Private->bIsEOSReached = OMX_TRUE;
+      }
+    }
+
+    nOutputBuffers = base_port_ReturnProcessedBuffers(pOutPort, pOutputBuffers, nOutputBuffers, OMX_FALSE);
+  }
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s of component %p\n", __func__, openmaxStandComp);
+  return NULL;
+}
+
 /** This is the central function for buffer processing of a two port source component.
   * It is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
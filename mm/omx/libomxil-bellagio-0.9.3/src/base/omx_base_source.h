@@ -50,7 +50,10 @@
 DERIVEDCLASS(omx_base_source_PrivateType, omx_base_component_PrivateType)
 #define omx_base_source_PrivateType_FIELDS omx_base_component_PrivateType_FIELDS \
   /** @param BufferMgmtCallback function pointer for algorithm callback */ \
-  void (*BufferMgmtCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* outputbuffer);
+  void (*BufferMgmtCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* outputbuffer); \
+  /** @param BufferMgmtBatchCallback optional function pointer for algorithm callback working on all the available buffers. \
+    * Output buffers with nFilledLen not zero or the EOS flag are returned, the others are handed again at the next call */ \
+  void (*BufferMgmtBatchCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE** pOutputBuffers, OMX_U32 nOutputBuffers);
 ENDCLASS(omx_base_source_PrivateType)
 
 /** Base source contructor
@@ -68,6 +71,12 @@ OMX_ERRORTYPE omx_base_source_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
  */
 void* omx_base_source_BufferMgmtFunction(void* param);
 
+/** Central processing function used when the component sets a
+ * BufferMgmtBatchCallback. All the buffers available at each wakeup
+ * are handed to the callback at once.
+ */
+void* omx_base_source_BatchBufferMgmtFunction(void* param);
+
 /** This is the central function for buffer processing of a two port source component.
   * It is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
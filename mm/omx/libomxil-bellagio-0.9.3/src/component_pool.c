@@ -0,0 +1,292 @@
+/**
+  src/component_pool.c
+
+  Pool of components constructed in advance, so that OMX_GetHandle hands
+  out an instance already built instead of running the constructor of the
+  component. The pool is filled, and the instances released are destroyed,
+  by a thread of the pool, out of the path of the IL client.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "component_pool.h"
+#include "omx_comp_debug_levels.h"
+
+/** The instances kept for a name
+ */
+typedef struct component_pool_entry_t {
+  char* name; /**< The name requested to OMX_GetHandle */
+  unsigned int target; /**< The number of instances to keep ready */
+  unsigned int nidle; /**< The number of instances ready */
+  OMX_COMPONENTTYPE* idle[COMPONENT_POOL_MAX_INSTANCES]; /**< The instances ready */
+  int failed; /**< The last construction failed, it is not retried until the name is requested again */
+} component_pool_entry_t;
+
+struct component_pool_t {
+  component_pool_entry_t* entries;
+  unsigned int nentries;
+  OMX_COMPONENTTYPE** released; /**< The instances given back, waiting to be destroyed */
+  unsigned int nreleased;
+  unsigned int nreleased_max;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  pthread_t thread;
+  int quit;
+  component_pool_construct_t construct;
+  component_pool_destroy_t destroy;
+  void* owner;
+};
+
+static OMX_ERRORTYPE component_pool_EventHandler(OMX_HANDLETYPE hComponent, OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent, OMX_U32 Data1, OMX_U32 Data2, OMX_PTR pEventData) {
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE component_pool_BufferDone(OMX_HANDLETYPE hComponent, OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  return OMX_ErrorNone;
+}
+
+/** The callbacks of the instances held by the pool, so that the client is
+ * never called once OMX_FreeHandle has returned
+ */
+static OMX_CALLBACKTYPE component_pool_callbacks = {
+  .EventHandler = component_pool_EventHandler,
+  .EmptyBufferDone = component_pool_BufferDone,
+  .FillBufferDone = component_pool_BufferDone,
+};
+
+static component_pool_entry_t* component_pool_find(component_pool_t* pool, const char* name) {
+  unsigned int i;
+
+  for (i = 0; i < pool->nentries; i++) {
+    if (!strcmp(pool->entries[i].name, name)) {
+      return &pool->entries[i];
+    }
+  }
+  return NULL;
+}
+
+static void* component_pool_thread(void* param) {
+  component_pool_t* pool = param;
+  component_pool_entry_t* entry;
+  OMX_COMPONENTTYPE* component;
+  OMX_ERRORTYPE err;
+  unsigned int i;
+
+  pthread_mutex_lock(&pool->mutex);
+  while (!pool->quit) {
+    /* the instances released first, they may hold resources needed by the new ones */
+    if (pool->nreleased > 0) {
+      component = pool->released[--pool->nreleased];
+      pthread_mutex_unlock(&pool->mutex);
+      pool->destroy(pool->owner, component);
+      pthread_mutex_lock(&pool->mutex);
+      continue;
+    }
+    entry = NULL;
+    for (i = 0; i < pool->nentries; i++) {
+      if (!pool->entries[i].failed && pool->entries[i].nidle < pool->entries[i].target) {
+        entry = &pool->entries[i];
+        break;
+      }
+    }
+    if (entry == NULL) {
+      pthread_cond_wait(&pool->cond, &pool->mutex);
+      continue;
+    }
+    /* the entries are never moved, the name can be used without the lock */
+    pthread_mutex_unlock(&pool->mutex);
+    component = NULL;
+    err = pool->construct(pool->owner, entry->name, &component_pool_callbacks, &component);
+    pthread_mutex_lock(&pool->mutex);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "In %s cannot build %s for the pool, error %x\n", __func__, entry->name, err);
+      entry->failed = 1;
+    } else if (entry->nidle < entry->target) {
+      entry->idle[entry->nidle++] = component;
+    } else {
+      pthread_mutex_unlock(&pool->mutex);
+      pool->destroy(pool->owner, component);
+      pthread_mutex_lock(&pool->mutex);
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return NULL;
+}
+
+/** Parses the configuration, a comma separated list of name=count
+ */
+static int component_pool_parse(component_pool_t* pool, const char* config) {
+  component_pool_entry_t* entries;
+  char *copy, *item, *save, *equal, *end;
+  long count;
+
+  copy = strdup(config);
+  if (copy == NULL) {
+    return -1;
+  }
+  for (item = strtok_r(copy, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save)) {
+    equal = strrchr(item, '=');
+    if (equal == NULL || equal == item) {
+      DEBUG(DEB_LEV_ERR, "In %s ignoring %s, name=count expected\n", __func__, item);
+      continue;
+    }
+    *equal = '\0';
+    count = strtol(equal + 1, &end, 10);
+    if (*end != '\0' || count <= 0 || count > COMPONENT_POOL_MAX_INSTANCES) {
+      DEBUG(DEB_LEV_ERR, "In %s ignoring %s, the count must be between 1 and %d\n", __func__, item, COMPONENT_POOL_MAX_INSTANCES);
+      continue;
+    }
+    if (component_pool_find(pool, item) != NULL) {
+      continue;
+    }
+    entries = realloc(pool->entries, (pool->nentries + 1) * sizeof(component_pool_entry_t));
+    if (entries == NULL) {
+      free(copy);
+      return -1;
+    }
+    pool->entries = entries;
+    memset(&pool->entries[pool->nentries], 0, sizeof(component_pool_entry_t));
+    pool->entries[pool->nentries].name = strdup(item);
+    if (pool->entries[pool->nentries].name == NULL) {
+      free(copy);
+      return -1;
+    }
+    pool->entries[pool->nentries].target = count;
+    pool->nentries++;
+  }
+  free(copy);
+  return 0;
+}
+
+static void component_pool_free(component_pool_t* pool) {
+  unsigned int i;
+
+  for (i = 0; i < pool->nentries; i++) {
+    free(pool->entries[i].name);
+  }
+  free(pool->entries);
+  free(pool->released);
+  free(pool);
+}
+
+component_pool_t* component_pool_create(const char* config, component_pool_construct_t construct,
+                                        component_pool_destroy_t destroy, void* owner) {
+  component_pool_t* pool;
+
+  if (config == NULL || *config == '\0') {
+    return NULL;
+  }
+  pool = calloc(1, sizeof(component_pool_t));
+  if (pool == NULL) {
+    return NULL;
+  }
+  if (component_pool_parse(pool, config) != 0 || pool->nentries == 0) {
+    component_pool_free(pool);
+    return NULL;
+  }
+  pool->construct = construct;
+  pool->destroy = destroy;
+  pool->owner = owner;
+  pthread_mutex_init(&pool->mutex, NULL);
+  pthread_cond_init(&pool->cond, NULL);
+  if (pthread_create(&pool->thread, NULL, component_pool_thread, pool) != 0) {
+    DEBUG(DEB_LEV_ERR, "In %s cannot create the thread of the pool\n", __func__);
+    pthread_cond_destroy(&pool->cond);
+    pthread_mutex_destroy(&pool->mutex);
+    component_pool_free(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+void component_pool_destroy(component_pool_t* pool) {
+  unsigned int i, j;
+
+  if (pool == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  pool->quit = 1;
+  pthread_cond_signal(&pool->cond);
+  pthread_mutex_unlock(&pool->mutex);
+  pthread_join(pool->thread, NULL);
+
+  for (i = 0; i < pool->nreleased; i++) {
+    pool->destroy(pool->owner, pool->released[i]);
+  }
+  for (i = 0; i < pool->nentries; i++) {
+    for (j = 0; j < pool->entries[i].nidle; j++) {
+      pool->destroy(pool->owner, pool->entries[i].idle[j]);
+    }
+  }
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->mutex);
+  component_pool_free(pool);
+}
+
+OMX_COMPONENTTYPE* component_pool_get(component_pool_t* pool, const char* name) {
+  component_pool_entry_t* entry;
+  OMX_COMPONENTTYPE* component = NULL;
+
+  pthread_mutex_lock(&pool->mutex);
+  entry = component_pool_find(pool, name);
+  if (entry != NULL) {
+    if (entry->nidle > 0) {
+      component = entry->idle[--entry->nidle];
+    }
+    entry->failed = 0;
+    pthread_cond_signal(&pool->cond);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return component;
+}
+
+int component_pool_release(component_pool_t* pool, const char* name, OMX_COMPONENTTYPE* component) {
+  component_pool_entry_t* entry;
+  OMX_COMPONENTTYPE** released;
+
+  pthread_mutex_lock(&pool->mutex);
+  entry = component_pool_find(pool, name);
+  if (entry == NULL) {
+    pthread_mutex_unlock(&pool->mutex);
+    return -1;
+  }
+  if (pool->nreleased == pool->nreleased_max) {
+    released = realloc(pool->released, (pool->nreleased_max + COMPONENT_POOL_MAX_INSTANCES) * sizeof(OMX_COMPONENTTYPE*));
+    if (released == NULL) {
+      pthread_mutex_unlock(&pool->mutex);
+      return -1;
+    }
+    pool->released = released;
+    pool->nreleased_max += COMPONENT_POOL_MAX_INSTANCES;
+  }
+  component->SetCallbacks(component, &component_pool_callbacks, NULL);
+  pool->released[pool->nreleased++] = component;
+  entry->failed = 0;
+  pthread_cond_signal(&pool->cond);
+  pthread_mutex_unlock(&pool->mutex);
+  return 0;
+}
@@ -0,0 +1,95 @@
+/**
+  src/component_pool.h
+
+  Pool of components constructed in advance, so that OMX_GetHandle hands
+  out an instance already built instead of running the constructor of the
+  component. The pool is filled, and the instances released are destroyed,
+  by a thread of the pool, out of the path of the IL client.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __COMPONENT_POOL_H__
+#define __COMPONENT_POOL_H__
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+
+/** The environment variable that configures the pool, as a comma separated
+ * list of name=count, for instance "OMX.st.volume.component=2". The name is
+ * the one requested to OMX_GetHandle, general or specific.
+ */
+#define COMPONENT_POOL_ENV "OMX_BELLAGIO_POOL"
+
+/** The maximum number of instances kept for a single name
+ */
+#define COMPONENT_POOL_MAX_INSTANCES 16
+
+/** Builds a component of the given name for the pool, as OMX_GetHandle
+ * does, with the callbacks of the pool that ignore every event
+ */
+typedef OMX_ERRORTYPE (*component_pool_construct_t)(void* owner, const char* name,
+                                                    OMX_CALLBACKTYPE* callbacks, OMX_COMPONENTTYPE** pComponent);
+
+/** Destroys a component built by the construct function of the pool
+ */
+typedef void (*component_pool_destroy_t)(void* owner, OMX_COMPONENTTYPE* component);
+
+typedef struct component_pool_t component_pool_t;
+
+/** Creates a pool and starts its thread, that builds the instances
+ *
+ * @param config the list of the names and of the number of instances,
+ * in the format of COMPONENT_POOL_ENV
+ * @param construct the function building an instance
+ * @param destroy the function destroying an instance
+ * @param owner passed to construct and destroy
+ *
+ * @return NULL if the configuration is empty or not valid, or if the
+ * resources are not enough
+ */
+component_pool_t* component_pool_create(const char* config, component_pool_construct_t construct,
+                                        component_pool_destroy_t destroy, void* owner);
+
+/** Stops the thread of the pool and destroys all the instances it holds
+ */
+void component_pool_destroy(component_pool_t* pool);
+
+/** Takes an instance of the component from the pool
+ *
+ * The instance has the callbacks of the pool, the caller must set its own.
+ * The pool is refilled in the background.
+ *
+ * @return NULL if the name is not pooled or if no instance is ready
+ */
+OMX_COMPONENTTYPE* component_pool_get(component_pool_t* pool, const char* name);
+
+/** Gives back an instance taken from the pool, or built by OMX_GetHandle
+ *
+ * The instance is destroyed by the thread of the pool, and a new one is
+ * built in its place. The caller must check that the component is in the
+ * Loaded state.
+ *
+ * @return -1 if the name is not pooled, the caller must then destroy the
+ * instance itself
+ */
+int component_pool_release(component_pool_t* pool, const char* name, OMX_COMPONENTTYPE* component);
+
+#endif
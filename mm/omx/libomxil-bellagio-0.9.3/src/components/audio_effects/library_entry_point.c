@@ -31,6 +31,8 @@
 #include <st_static_component_loader.h>
 #include <omx_volume_component.h>
 #include <omx_audiomixer_component.h>
+#include <omx_audioresampler_component.h>
+#include <omx_channelmapper_component.h>
 
 /** @brief The library entry point. It must have the same name for each
   * library of the components loaded by the ST static component loader.
@@ -51,7 +53,7 @@ int omx_component_library_Setup(stLoaderComponentType **stComponents) {
 
   if (stComponents == NULL) {
     DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s \n",__func__);
-    return 2; // Return Number of Components - one for audio volume component
+    return 4; // Return Number of Components - volume, mixer, resampler and channel mapper
   }
 
   /** component 1 - volume component */
@@ -136,6 +138,88 @@ int omx_component_library_Setup(stLoaderComponentType **stComponents) {
 	  stComponents[1]->multiResourceLevel[i]->MemoryResourceRequested = mixerQualityLevels[i * 2 + 1];
   }
 
+  /** component 3 - audio resampler component */
+  stComponents[2]->componentVersion.s.nVersionMajor = 1;
+  stComponents[2]->componentVersion.s.nVersionMinor = 1;
+  stComponents[2]->componentVersion.s.nRevision = 1;
+  stComponents[2]->componentVersion.s.nStep = 1;
+
+  stComponents[2]->name = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+  if (stComponents[2]->name == NULL) {
+    return OMX_ErrorInsufficientResources;
+  }
+  strcpy(stComponents[2]->name, RESAMPLER_COMP_NAME);
+  stComponents[2]->name_specific_length = 1;
+  stComponents[2]->constructor = omx_audio_resampler_component_Constructor;
+
+  stComponents[2]->name_specific = calloc(stComponents[2]->name_specific_length,sizeof(char *));
+  stComponents[2]->role_specific = calloc(stComponents[2]->name_specific_length,sizeof(char *));
+
+  for(i=0;i<stComponents[2]->name_specific_length;i++) {
+    stComponents[2]->name_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[2]->name_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  for(i=0;i<stComponents[2]->name_specific_length;i++) {
+    stComponents[2]->role_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[2]->role_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+
+  strcpy(stComponents[2]->name_specific[0], RESAMPLER_COMP_NAME);
+  strcpy(stComponents[2]->role_specific[0], RESAMPLER_COMP_ROLE);
+
+  stComponents[2]->nqualitylevels = RESAMPLER_QUALITY_LEVELS;
+  stComponents[2]->multiResourceLevel = malloc(stComponents[2]->nqualitylevels * sizeof(multiResourceDescriptor *));
+  for (i=0; i<stComponents[2]->nqualitylevels; i++) {
+	  stComponents[2]->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  stComponents[2]->multiResourceLevel[i]->CPUResourceRequested = resamplerQualityLevels[i * 2];
+	  stComponents[2]->multiResourceLevel[i]->MemoryResourceRequested = resamplerQualityLevels[i * 2 + 1];
+  }
+
+  /** component 4 - channel mapper component */
+  stComponents[3]->componentVersion.s.nVersionMajor = 1;
+  stComponents[3]->componentVersion.s.nVersionMinor = 1;
+  stComponents[3]->componentVersion.s.nRevision = 1;
+  stComponents[3]->componentVersion.s.nStep = 1;
+
+  stComponents[3]->name = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+  if (stComponents[3]->name == NULL) {
+    return OMX_ErrorInsufficientResources;
+  }
+  strcpy(stComponents[3]->name, CHANNELMAPPER_COMP_NAME);
+  stComponents[3]->name_specific_length = 1;
+  stComponents[3]->constructor = omx_channelmapper_component_Constructor;
+
+  stComponents[3]->name_specific = calloc(stComponents[3]->name_specific_length,sizeof(char *));
+  stComponents[3]->role_specific = calloc(stComponents[3]->name_specific_length,sizeof(char *));
+
+  for(i=0;i<stComponents[3]->name_specific_length;i++) {
+    stComponents[3]->name_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[3]->name_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  for(i=0;i<stComponents[3]->name_specific_length;i++) {
+    stComponents[3]->role_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[3]->role_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+
+  strcpy(stComponents[3]->name_specific[0], CHANNELMAPPER_COMP_NAME);
+  strcpy(stComponents[3]->role_specific[0], CHANNELMAPPER_COMP_ROLE);
+
+  stComponents[3]->nqualitylevels = CHANNELMAPPER_QUALITY_LEVELS;
+  stComponents[3]->multiResourceLevel = malloc(stComponents[3]->nqualitylevels * sizeof(multiResourceDescriptor *));
+  for (i=0; i<stComponents[3]->nqualitylevels; i++) {
+	  stComponents[3]->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  stComponents[3]->multiResourceLevel[i]->CPUResourceRequested = channelmapperQualityLevels[i * 2];
+	  stComponents[3]->multiResourceLevel[i]->MemoryResourceRequested = channelmapperQualityLevels[i * 2 + 1];
+  }
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s \n",__func__);
-  return 2;
+  return 4;
 }
@@ -41,16 +41,15 @@ OMX_ERRORTYPE omx_audio_mixer_component_Constructor(OMX_COMPONENTTYPE *openmaxSt
   RM_RegisterComponent(MIXER_COMP_NAME, MAX_MIXER_COMPONENTS);
   if (!openmaxStandComp->pComponentPrivate) {
     DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, allocating component\n",__func__);
-    openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_audio_mixer_component_PrivateType));
-    if(openmaxStandComp->pComponentPrivate == NULL) {
-      return OMX_ErrorInsufficientResources;
+    err = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_audio_mixer_component_PrivateType), MAX_PORTS, sizeof(omx_audio_mixer_component_PortType));
+    if (err != OMX_ErrorNone) {
+      return err;
     }
   } else {
     DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
   }
 
   omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
-  omx_audio_mixer_component_Private->ports = NULL;
 
   /** Calling base filter constructor */
   err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
@@ -143,7 +142,7 @@ OMX_ERRORTYPE omx_audio_mixer_component_Destructor(OMX_COMPONENTTYPE *openmaxSta
       if(omx_audio_mixer_component_Private->ports[i])
         omx_audio_mixer_component_Private->ports[i]->PortDestructor(omx_audio_mixer_component_Private->ports[i]);
     }
-    free(omx_audio_mixer_component_Private->ports);
+    omx_base_component_FreeStorage(openmaxStandComp, omx_audio_mixer_component_Private->ports);
     omx_audio_mixer_component_Private->ports=NULL;
   }
 
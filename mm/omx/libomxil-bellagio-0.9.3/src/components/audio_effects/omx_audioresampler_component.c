@@ -0,0 +1,607 @@
+/**
+  src/components/audio_effects/omx_audioresampler_component.c
+
+  OpenMAX audio resampler component. This component implements a filter that
+  converts the sampling rate of an audio PCM stream by a rational ratio, with
+  a polyphase FIR filter.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <math.h>
+#include <omxcore.h>
+#include <omx_base_audio_port.h>
+#include <omx_audioresampler_component.h>
+#include <OMX_Audio.h>
+
+/** The filters of the quality levels, the first one being the best */
+static const resampler_preset_t resamplerPresets[RESAMPLER_QUALITY_LEVELS] = {
+  { 64, 0.94f, 9.0f },
+  { 32, 0.90f, 7.0f },
+  { 16, 0.84f, 5.5f }
+};
+
+OMX_ERRORTYPE omx_audio_resampler_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+  OMX_ERRORTYPE err;
+  omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private;
+  OMX_U32 i;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+  RM_RegisterComponent(RESAMPLER_COMP_NAME, MAX_RESAMPLER_COMPONENTS);
+  if (!openmaxStandComp->pComponentPrivate) {
+    err = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_audio_resampler_component_PrivateType), 2, sizeof(omx_base_audio_PortType));
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+  } else {
+    DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+    return OMX_ErrorUndefined;
+  }
+
+  omx_audio_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+
+  /** Calling base filter constructor */
+  err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+    return err;
+  }
+
+  omx_audio_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+  omx_audio_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 2;
+
+  /** Allocate Ports and call port constructor. */
+  if (omx_audio_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts && !omx_audio_resampler_component_Private->ports) {
+    omx_audio_resampler_component_Private->ports = calloc(omx_audio_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts, sizeof(omx_base_PortType *));
+    if (!omx_audio_resampler_component_Private->ports) {
+      return OMX_ErrorInsufficientResources;
+    }
+    for (i=0; i < omx_audio_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+      omx_audio_resampler_component_Private->ports[i] = calloc(1, sizeof(omx_base_audio_PortType));
+      if (!omx_audio_resampler_component_Private->ports[i]) {
+        return OMX_ErrorInsufficientResources;
+      }
+    }
+  }
+
+  err = base_audio_port_Constructor(openmaxStandComp, &omx_audio_resampler_component_Private->ports[0], 0, OMX_TRUE);
+  if (err != OMX_ErrorNone) {
+    return OMX_ErrorInsufficientResources;
+  }
+  err = base_audio_port_Constructor(openmaxStandComp, &omx_audio_resampler_component_Private->ports[1], 1, OMX_FALSE);
+  if (err != OMX_ErrorNone) {
+    return OMX_ErrorInsufficientResources;
+  }
+
+  /** Domain specific section for the ports. */
+  omx_audio_resampler_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+  omx_audio_resampler_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+
+  for (i = 0; i < 2; i++) {
+    setHeader(&omx_audio_resampler_component_Private->sPcmMode[i], sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+    omx_audio_resampler_component_Private->sPcmMode[i].nPortIndex = i;
+    omx_audio_resampler_component_Private->sPcmMode[i].nChannels = 2;
+    omx_audio_resampler_component_Private->sPcmMode[i].eNumData = OMX_NumericalDataSigned;
+    omx_audio_resampler_component_Private->sPcmMode[i].eEndian = OMX_EndianLittle;
+    omx_audio_resampler_component_Private->sPcmMode[i].bInterleaved = OMX_TRUE;
+    omx_audio_resampler_component_Private->sPcmMode[i].nBitPerSample = 16;
+    omx_audio_resampler_component_Private->sPcmMode[i].nSamplingRate = 44100;
+    omx_audio_resampler_component_Private->sPcmMode[i].ePCMMode = OMX_AUDIO_PCMModeLinear;
+    omx_audio_resampler_component_Private->sPcmMode[i].eChannelMapping[0] = OMX_AUDIO_ChannelLF;
+    omx_audio_resampler_component_Private->sPcmMode[i].eChannelMapping[1] = OMX_AUDIO_ChannelRF;
+  }
+
+  omx_audio_resampler_component_Private->pKernel = resampler_SelectKernel(NULL);
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s using the %s kernel\n", __func__, omx_audio_resampler_component_Private->pKernel->sName);
+  omx_audio_resampler_component_Private->sKernelName = omx_audio_resampler_component_Private->pKernel->sName;
+
+  omx_audio_resampler_component_Private->destructor = omx_audio_resampler_component_Destructor;
+  omx_audio_resampler_component_Private->DoStateSet = omx_audio_resampler_component_DoStateSet;
+  openmaxStandComp->SetParameter = omx_audio_resampler_component_SetParameter;
+  openmaxStandComp->GetParameter = omx_audio_resampler_component_GetParameter;
+  omx_audio_resampler_component_Private->BufferMgmtCallback = omx_audio_resampler_component_BufferMgmtCallback;
+
+  /* resource management special section */
+  omx_audio_resampler_component_Private->nqualitylevels = RESAMPLER_QUALITY_LEVELS;
+  omx_audio_resampler_component_Private->currentQualityLevel = 1;
+  omx_audio_resampler_component_Private->multiResourceLevel = malloc(sizeof(multiResourceDescriptor *) * RESAMPLER_QUALITY_LEVELS);
+  for (i = 0; i<RESAMPLER_QUALITY_LEVELS; i++) {
+    omx_audio_resampler_component_Private->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+    omx_audio_resampler_component_Private->multiResourceLevel[i]->CPUResourceRequested = resamplerQualityLevels[i * 2];
+    omx_audio_resampler_component_Private->multiResourceLevel[i]->MemoryResourceRequested = resamplerQualityLevels[i * 2 + 1];
+  }
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+static void resampler_FreeFilter(omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private) {
+  free(omx_audio_resampler_component_Private->pBank);
+  omx_audio_resampler_component_Private->pBank = NULL;
+  free(omx_audio_resampler_component_Private->pWork);
+  omx_audio_resampler_component_Private->pWork = NULL;
+  omx_audio_resampler_component_Private->nWorkChannels = 0;
+}
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_audio_resampler_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_U32 i;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+  resampler_FreeFilter(omx_audio_resampler_component_Private);
+
+  /* frees port/s */
+  if (omx_audio_resampler_component_Private->ports) {
+    for (i=0; i < omx_audio_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+      if(omx_audio_resampler_component_Private->ports[i]) {
+        omx_audio_resampler_component_Private->ports[i]->PortDestructor(omx_audio_resampler_component_Private->ports[i]);
+      }
+    }
+    omx_base_component_FreeStorage(openmaxStandComp, omx_audio_resampler_component_Private->ports);
+    omx_audio_resampler_component_Private->ports=NULL;
+  }
+
+  omx_base_filter_Destructor(openmaxStandComp);
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+/** Starts a new stream: the history holds the zeros before its first sample,
+ * so that the first output frame is centred on it
+ */
+static void resampler_ResetStream(omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private) {
+  OMX_U32 nLead = omx_audio_resampler_component_Private->nTaps / 2 - 1;
+  OMX_U32 c;
+
+  for (c = 0; c < omx_audio_resampler_component_Private->nWorkChannels; c++) {
+    memset(omx_audio_resampler_component_Private->pWork + c * omx_audio_resampler_component_Private->nWorkFrames, 0, nLead * sizeof(float));
+  }
+  omx_audio_resampler_component_Private->nFill = nLead;
+  omx_audio_resampler_component_Private->nPos = 0;
+  omx_audio_resampler_component_Private->nPhase = 0;
+}
+
+/** Drops the history before nPos, the frames still to skip when nPos is past
+ * the end of it staying in nPos, then shifts the history by nShift frames
+ * to the right, filling the first ones with zeros
+ */
+static void resampler_Compact(omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private, OMX_U32 nShift) {
+  OMX_U32 nDrop = omx_audio_resampler_component_Private->nPos;
+  OMX_U32 nKeep;
+  float* pChannel;
+  OMX_U32 c;
+
+  if (nDrop > omx_audio_resampler_component_Private->nFill) {
+    nDrop = omx_audio_resampler_component_Private->nFill;
+  }
+  nKeep = omx_audio_resampler_component_Private->nFill - nDrop;
+  for (c = 0; c < omx_audio_resampler_component_Private->nWorkChannels; c++) {
+    pChannel = omx_audio_resampler_component_Private->pWork + c * omx_audio_resampler_component_Private->nWorkFrames;
+    memmove(pChannel + nShift, pChannel + nDrop, nKeep * sizeof(float));
+    memset(pChannel, 0, nShift * sizeof(float));
+  }
+  omx_audio_resampler_component_Private->nFill = nKeep + nShift;
+  omx_audio_resampler_component_Private->nPos = omx_audio_resampler_component_Private->nPos - nDrop + nShift;
+}
+
+static OMX_U32 resampler_Gcd(OMX_U32 a, OMX_U32 b) {
+  OMX_U32 t;
+
+  while (b != 0) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/** Builds the filter for the rates, the channels and the quality level in use,
+ * when one of them has changed. A new quality level keeps the stream going:
+ * the history is moved so that the next output frame stays centred on the
+ * same input sample.
+ */
+static OMX_ERRORTYPE resampler_Prepare(omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private) {
+  OMX_U32 nRateIn = omx_audio_resampler_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].nSamplingRate;
+  OMX_U32 nRateOut = omx_audio_resampler_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX].nSamplingRate;
+  OMX_U32 nChannels = omx_audio_resampler_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].nChannels;
+  OMX_U32 nLevel = omx_audio_resampler_component_Private->currentQualityLevel;
+  OMX_U32 nGcd = resampler_Gcd(nRateIn, nRateOut);
+  OMX_U32 nUp = nRateOut / nGcd;
+  OMX_U32 nDown = nRateIn / nGcd;
+  OMX_U32 nTaps, nOldTaps, nSkip;
+  OMX_BOOL bNewStream;
+  float* pBank;
+
+  if (nUp > RESAMPLER_MAX_PHASES) {
+    DEBUG(DEB_LEV_ERR, "In %s ratio %d/%d not supported\n", __func__, (int)nRateOut, (int)nRateIn);
+    return OMX_ErrorUnsupportedSetting;
+  }
+  if (nLevel < 1 || nLevel > RESAMPLER_QUALITY_LEVELS) {
+    nLevel = (nLevel < 1) ? 1 : RESAMPLER_QUALITY_LEVELS;
+  }
+  if (omx_audio_resampler_component_Private->pBank != NULL &&
+      omx_audio_resampler_component_Private->nBankLevel == nLevel &&
+      omx_audio_resampler_component_Private->nUp == nUp &&
+      omx_audio_resampler_component_Private->nDown == nDown &&
+      omx_audio_resampler_component_Private->nWorkChannels == nChannels) {
+    return OMX_ErrorNone;
+  }
+
+  nTaps = resampler_FilterTaps(&resamplerPresets[nLevel - 1], nUp, nDown);
+  pBank = resampler_DesignBank(&resamplerPresets[nLevel - 1], nUp, nDown, nTaps);
+  if (pBank == NULL) {
+    return OMX_ErrorInsufficientResources;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s %d/%d phases of %d taps at quality level %d\n", __func__,
+    (int)nUp, (int)nDown, (int)nTaps, (int)nLevel);
+
+  bNewStream = (omx_audio_resampler_component_Private->pBank == NULL ||
+                omx_audio_resampler_component_Private->nUp != nUp ||
+                omx_audio_resampler_component_Private->nDown != nDown ||
+                omx_audio_resampler_component_Private->nWorkChannels != nChannels) ? OMX_TRUE : OMX_FALSE;
+  if (omx_audio_resampler_component_Private->nWorkChannels != nChannels) {
+    free(omx_audio_resampler_component_Private->pWork);
+    omx_audio_resampler_component_Private->nWorkFrames = 2 * RESAMPLER_MAX_TAPS + RESAMPLER_CHUNK_FRAMES;
+    omx_audio_resampler_component_Private->pWork = malloc(nChannels * omx_audio_resampler_component_Private->nWorkFrames * sizeof(float));
+    if (omx_audio_resampler_component_Private->pWork == NULL) {
+      free(pBank);
+      resampler_FreeFilter(omx_audio_resampler_component_Private);
+      return OMX_ErrorInsufficientResources;
+    }
+    omx_audio_resampler_component_Private->nWorkChannels = nChannels;
+  }
+
+  free(omx_audio_resampler_component_Private->pBank);
+  omx_audio_resampler_component_Private->pBank = pBank;
+  nOldTaps = omx_audio_resampler_component_Private->nTaps;
+  omx_audio_resampler_component_Private->nTaps = nTaps;
+  omx_audio_resampler_component_Private->nBankLevel = nLevel;
+  omx_audio_resampler_component_Private->nUp = nUp;
+  omx_audio_resampler_component_Private->nDown = nDown;
+
+  if (bNewStream) {
+    resampler_ResetStream(omx_audio_resampler_component_Private);
+  } else if (nOldTaps / 2 >= nTaps / 2) {
+    omx_audio_resampler_component_Private->nPos += nOldTaps / 2 - nTaps / 2;
+  } else {
+    /* the longer filter reaches before the history kept, taken as silence */
+    nSkip = (omx_audio_resampler_component_Private->nPos > omx_audio_resampler_component_Private->nFill) ?
+      omx_audio_resampler_component_Private->nPos - omx_audio_resampler_component_Private->nFill : 0;
+    resampler_Compact(omx_audio_resampler_component_Private,
+      (nSkip + nOldTaps / 2 >= nTaps / 2) ? 0 : nTaps / 2 - nOldTaps / 2 - nSkip);
+    omx_audio_resampler_component_Private->nPos -= nTaps / 2 - nOldTaps / 2;
+  }
+  return OMX_ErrorNone;
+}
+
+/** Converts nFrames interleaved frames to the planar history */
+static void resampler_Append(omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private, const OMX_S16* pIn, OMX_U32 nFrames) {
+  OMX_U32 nChannels = omx_audio_resampler_component_Private->nWorkChannels;
+  float* pChannel;
+  OMX_U32 c, i;
+
+  for (c = 0; c < nChannels; c++) {
+    pChannel = omx_audio_resampler_component_Private->pWork + c * omx_audio_resampler_component_Private->nWorkFrames + omx_audio_resampler_component_Private->nFill;
+    if (pIn == NULL) {
+      memset(pChannel, 0, nFrames * sizeof(float));
+      continue;
+    }
+    for (i = 0; i < nFrames; i++) {
+      pChannel[i] = pIn[i * nChannels + c] * (1.0f / 32768.0f);
+    }
+  }
+  omx_audio_resampler_component_Private->nFill += nFrames;
+}
+
+/** Computes up to nRoom output frames from the history, and returns their number */
+static OMX_U32 resampler_Produce(omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private, OMX_S16* pOut, OMX_U32 nRoom) {
+  OMX_U32 nChannels = omx_audio_resampler_component_Private->nWorkChannels;
+  OMX_U32 nTaps = omx_audio_resampler_component_Private->nTaps;
+  resampler_dot_t DotProduct = omx_audio_resampler_component_Private->pKernel->DotProduct;
+  const float* pTaps;
+  const float* pSamples;
+  OMX_U32 nDone = 0;
+  OMX_U32 c;
+  long nSample;
+
+  while (nDone < nRoom && omx_audio_resampler_component_Private->nPos + nTaps <= omx_audio_resampler_component_Private->nFill) {
+    pTaps = omx_audio_resampler_component_Private->pBank + omx_audio_resampler_component_Private->nPhase * nTaps;
+    pSamples = omx_audio_resampler_component_Private->pWork + omx_audio_resampler_component_Private->nPos;
+    for (c = 0; c < nChannels; c++) {
+      nSample = lrintf(DotProduct(pSamples + c * omx_audio_resampler_component_Private->nWorkFrames, pTaps, nTaps) * 32768.0f);
+      if (nSample > 32767) {
+        nSample = 32767;
+      } else if (nSample < -32768) {
+        nSample = -32768;
+      }
+      *pOut++ = (OMX_S16)nSample;
+    }
+    omx_audio_resampler_component_Private->nPhase += omx_audio_resampler_component_Private->nDown;
+    omx_audio_resampler_component_Private->nPos += omx_audio_resampler_component_Private->nPhase / omx_audio_resampler_component_Private->nUp;
+    omx_audio_resampler_component_Private->nPhase %= omx_audio_resampler_component_Private->nUp;
+    nDone++;
+  }
+  return nDone;
+}
+
+/** Returns the output frames the history would give if it held nFill frames */
+static OMX_U64 resampler_Available(omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private, OMX_U64 nFill) {
+  OMX_U64 nLast;
+
+  if (nFill < (OMX_U64)omx_audio_resampler_component_Private->nPos + omx_audio_resampler_component_Private->nTaps) {
+    return 0;
+  }
+  nLast = nFill - omx_audio_resampler_component_Private->nPos - omx_audio_resampler_component_Private->nTaps;
+  return ((nLast + 1) * omx_audio_resampler_component_Private->nUp - omx_audio_resampler_component_Private->nPhase - 1) /
+    omx_audio_resampler_component_Private->nDown + 1;
+}
+
+/** Returns the frames the history must hold to give nRoom output frames, more being kept for later */
+static OMX_U64 resampler_Needed(omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private, OMX_U32 nRoom) {
+  return (OMX_U64)omx_audio_resampler_component_Private->nPos + omx_audio_resampler_component_Private->nTaps +
+    ((OMX_U64)omx_audio_resampler_component_Private->nPhase + (OMX_U64)(nRoom - 1) * omx_audio_resampler_component_Private->nDown) /
+    omx_audio_resampler_component_Private->nUp;
+}
+
+/** This function is used to process the input buffer and provide one output buffer.
+ * The input is consumed only as far as the output buffer can take the frames it
+ * gives, the rest staying in the input buffer for the next output buffer. The
+ * filter is flushed by an EOS flag on a buffer holding data: the flag is passed
+ * on once the last frames, the tail of the filter included, are in the output.
+ */
+void omx_audio_resampler_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_U32 nChannels = omx_audio_resampler_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].nChannels;
+  OMX_U32 nFrameSize = nChannels * sizeof(OMX_S16);
+  const OMX_S16* pIn = (const OMX_S16*)(pInputBuffer->pBuffer + pInputBuffer->nOffset);
+  OMX_S16* pOut = (OMX_S16*)pOutputBuffer->pBuffer;
+  OMX_U32 nLeft = pInputBuffer->nFilledLen / nFrameSize;
+  OMX_U32 nRoom = pOutputBuffer->nAllocLen / nFrameSize;
+  OMX_BOOL bEOS = ((pInputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) ? OMX_TRUE : OMX_FALSE;
+  OMX_U32 nDone = 0;
+  OMX_U32 nDrain;
+  OMX_U64 nFrames;
+  OMX_ERRORTYPE err;
+
+  pOutputBuffer->nFilledLen = 0;
+  err = resampler_Prepare(omx_audio_resampler_component_Private);
+  if (err != OMX_ErrorNone || nRoom == 0) {
+    DEBUG(DEB_LEV_ERR, "In %s dropping the input buffer, err=%x output frames=%d\n", __func__, err, (int)nRoom);
+    pInputBuffer->nFilledLen = 0;
+    return;
+  }
+  nDrain = omx_audio_resampler_component_Private->nTaps / 2;
+
+  for (;;) {
+    nDone += resampler_Produce(omx_audio_resampler_component_Private, pOut + nDone * nChannels, nRoom - nDone);
+    if (nLeft == 0 || nDone == nRoom) {
+      break;
+    }
+    if (omx_audio_resampler_component_Private->nWorkFrames - omx_audio_resampler_component_Private->nFill < RESAMPLER_CHUNK_FRAMES + nDrain) {
+      resampler_Compact(omx_audio_resampler_component_Private, 0);
+    }
+    nFrames = resampler_Needed(omx_audio_resampler_component_Private, nRoom - nDone) - omx_audio_resampler_component_Private->nFill;
+    if (nFrames > nLeft) {
+      nFrames = nLeft;
+    }
+    if (nFrames > RESAMPLER_CHUNK_FRAMES) {
+      nFrames = RESAMPLER_CHUNK_FRAMES;
+    }
+    /* the last frames wait for the next output buffer if the tail would not fit in this one */
+    if (bEOS && nFrames == nLeft && nDone > 0 &&
+        resampler_Available(omx_audio_resampler_component_Private, omx_audio_resampler_component_Private->nFill + nFrames + nDrain) > nRoom - nDone) {
+      nFrames--;
+    }
+    if (nFrames == 0) {
+      break;
+    }
+    resampler_Append(omx_audio_resampler_component_Private, pIn, (OMX_U32)nFrames);
+    pIn += nFrames * nChannels;
+    nLeft -= (OMX_U32)nFrames;
+  }
+
+  if (bEOS && nLeft == 0) {
+    if (omx_audio_resampler_component_Private->nWorkFrames - omx_audio_resampler_component_Private->nFill < nDrain) {
+      resampler_Compact(omx_audio_resampler_component_Private, 0);
+    }
+    resampler_Append(omx_audio_resampler_component_Private, NULL, nDrain);
+    nDone += resampler_Produce(omx_audio_resampler_component_Private, pOut + nDone * nChannels, nRoom - nDone);
+    resampler_ResetStream(omx_audio_resampler_component_Private);
+  }
+
+  if (nLeft == 0) {
+    /* a partial frame at the end is dropped */
+    pInputBuffer->nOffset = 0;
+    pInputBuffer->nFilledLen = 0;
+  } else {
+    pInputBuffer->nOffset = (OMX_U32)((const OMX_U8*)pIn - pInputBuffer->pBuffer);
+    pInputBuffer->nFilledLen = nLeft * nFrameSize;
+  }
+  pOutputBuffer->nFilledLen = nDone * nFrameSize;
+}
+
+/** The stream restarts when the component stops executing, and the filter is freed in Loaded */
+OMX_ERRORTYPE omx_audio_resampler_component_DoStateSet(OMX_COMPONENTTYPE *openmaxStandComp, OMX_U32 destinationState) {
+  omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_STATETYPE state = omx_audio_resampler_component_Private->state;
+  OMX_ERRORTYPE err;
+
+  err = omx_base_component_DoStateSet(openmaxStandComp, destinationState);
+  if (err != OMX_ErrorNone) {
+    return err;
+  }
+  if (destinationState == OMX_StateLoaded) {
+    resampler_FreeFilter(omx_audio_resampler_component_Private);
+  } else if (destinationState == OMX_StateIdle && (state == OMX_StateExecuting || state == OMX_StatePause) &&
+             omx_audio_resampler_component_Private->pBank != NULL) {
+    resampler_ResetStream(omx_audio_resampler_component_Private);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_audio_resampler_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_U32 portIndex, nRateOut, nRateIn;
+  omx_base_audio_PortType *port;
+
+  /* Check which structure we are being fed and make control its header */
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      portIndex = pAudioPortFormat->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_audio_resampler_component_Private->ports[portIndex];
+        memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      portIndex = pAudioPcmMode->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (pAudioPcmMode->nBitPerSample != 16 || pAudioPcmMode->eNumData != OMX_NumericalDataSigned ||
+          pAudioPcmMode->bInterleaved != OMX_TRUE || pAudioPcmMode->nChannels < 1 ||
+          pAudioPcmMode->nChannels > OMX_AUDIO_MAXCHANNELS || pAudioPcmMode->nSamplingRate == 0) {
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      nRateIn = (portIndex == OMX_BASE_FILTER_INPUTPORT_INDEX) ? pAudioPcmMode->nSamplingRate :
+        omx_audio_resampler_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].nSamplingRate;
+      nRateOut = (portIndex == OMX_BASE_FILTER_OUTPUTPORT_INDEX) ? pAudioPcmMode->nSamplingRate :
+        omx_audio_resampler_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX].nSamplingRate;
+      if (nRateOut / resampler_Gcd(nRateIn, nRateOut) > RESAMPLER_MAX_PHASES) {
+        DEBUG(DEB_LEV_ERR, "In %s ratio %d/%d not supported\n", __func__, (int)nRateOut, (int)nRateIn);
+        err = OMX_ErrorUnsupportedSetting;
+        break;
+      }
+      memcpy(&omx_audio_resampler_component_Private->sPcmMode[portIndex], pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      /* the two ports carry the same channels */
+      portIndex = 1 - portIndex;
+      omx_audio_resampler_component_Private->sPcmMode[portIndex].nChannels = pAudioPcmMode->nChannels;
+      memcpy(omx_audio_resampler_component_Private->sPcmMode[portIndex].eChannelMapping, pAudioPcmMode->eChannelMapping, sizeof(pAudioPcmMode->eChannelMapping));
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_audio_resampler_component_Private->state != OMX_StateLoaded && omx_audio_resampler_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_audio_resampler_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, RESAMPLER_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_audio_resampler_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_audio_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_audio_resampler_component_PrivateType* omx_audio_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_audio_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_audio_resampler_component_Private->ports[pAudioPortFormat->nPortIndex];
+        memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPcmMode->nPortIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      memcpy(pAudioPcmMode, &omx_audio_resampler_component_Private->sPcmMode[pAudioPcmMode->nPortIndex], sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, RESAMPLER_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
@@ -0,0 +1,107 @@
+/**
+  src/components/audio_effects/omx_audioresampler_component.h
+
+  OpenMAX audio resampler component. This component implements a filter that
+  converts the sampling rate of an audio PCM stream by a rational ratio, with
+  a polyphase FIR filter.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_AUDIORESAMPLER_COMPONENT_H_
+#define _OMX_AUDIORESAMPLER_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <OMX_Audio.h>
+#include <string.h>
+#include <omx_base_filter.h>
+#include "omx_audioresampler_kernel.h"
+
+#define RESAMPLER_COMP_NAME "OMX.st.audio.resampler"
+#define RESAMPLER_COMP_ROLE "audio.resampler"
+#define MAX_RESAMPLER_COMPONENTS 10
+
+/** The quality levels of the resource manager select the filter: 1 the
+ * sharpest one, 2 and 3 cheaper ones with fewer taps and a wider transition
+ */
+#define RESAMPLER_QUALITY_LEVELS 3
+static int resamplerQualityLevels []={40, 1048576, 20, 524288, 10, 262144};
+
+/** Input frames converted at once from the input buffer to the work buffer */
+#define RESAMPLER_CHUNK_FRAMES 1024
+
+/** Audio resampler component private structure.
+ * @param sPcmMode the PCM format of the input and output ports, the channels being the same
+ * @param pKernel the dot products used
+ * @param pBank the phases of the filter, NULL until the first buffer
+ * @param nBankLevel the quality level of pBank
+ * @param nUp the phases, the output rate divided by the greatest common divisor of the rates
+ * @param nDown the input rate divided by the greatest common divisor of the rates
+ * @param nTaps the taps of a phase
+ * @param pWork the input samples of each channel as floats, nWorkFrames apart
+ * @param nWorkChannels the channels in pWork
+ * @param nWorkFrames the frames pWork holds for each channel
+ * @param nFill the frames in pWork
+ * @param nPos the frame of pWork at the first tap of the next output frame
+ * @param nPhase the phase of the next output frame
+ */
+DERIVEDCLASS(omx_audio_resampler_component_PrivateType, omx_base_filter_PrivateType)
+#define omx_audio_resampler_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
+  OMX_AUDIO_PARAM_PCMMODETYPE sPcmMode[2]; \
+  const resampler_kernel_t* pKernel; \
+  float* pBank; \
+  OMX_U32 nBankLevel; \
+  OMX_U32 nUp; \
+  OMX_U32 nDown; \
+  OMX_U32 nTaps; \
+  float* pWork; \
+  OMX_U32 nWorkChannels; \
+  OMX_U32 nWorkFrames; \
+  OMX_U32 nFill; \
+  OMX_U32 nPos; \
+  OMX_U32 nPhase;
+ENDCLASS(omx_audio_resampler_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_audio_resampler_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_audio_resampler_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_audio_resampler_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* inputbuffer,
+  OMX_BUFFERHEADERTYPE* outputbuffer);
+
+OMX_ERRORTYPE omx_audio_resampler_component_DoStateSet(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_U32 destinationState);
+
+OMX_ERRORTYPE omx_audio_resampler_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_audio_resampler_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+#endif
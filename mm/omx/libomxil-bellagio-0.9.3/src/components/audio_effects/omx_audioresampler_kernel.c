@@ -0,0 +1,198 @@
+/**
+  src/components/audio_effects/omx_audioresampler_kernel.c
+
+  Polyphase filter design and vectorized dot products of the audio resampler
+  component. The kernels are chosen at run time among the ones built for the
+  target: SSE and AVX2 with FMA on x86, NEON on ARM, and the scalar one.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <omxcore.h>
+#include "omx_audioresampler_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define RESAMPLER_HAVE_AVX2
+#ifdef __SSE__
+#define RESAMPLER_HAVE_SSE
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define RESAMPLER_HAVE_NEON
+#endif
+
+static float resampler_DotScalar(const float* pSamples, const float* pTaps, OMX_U32 nTaps) {
+  float s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  OMX_U32 i;
+
+  /* four sums, so that the additions do not wait for each other */
+  for (i = 0; i < nTaps; i += 4) {
+    s0 += pSamples[i] * pTaps[i];
+    s1 += pSamples[i + 1] * pTaps[i + 1];
+    s2 += pSamples[i + 2] * pTaps[i + 2];
+    s3 += pSamples[i + 3] * pTaps[i + 3];
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+#ifdef RESAMPLER_HAVE_SSE
+static float resampler_DotSSE(const float* pSamples, const float* pTaps, OMX_U32 nTaps) {
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  __m128 sum;
+  OMX_U32 i;
+
+  for (i = 0; i < nTaps; i += 8) {
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(pSamples + i), _mm_load_ps(pTaps + i)));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(pSamples + i + 4), _mm_load_ps(pTaps + i + 4)));
+  }
+  sum = _mm_add_ps(sum0, sum1);
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+#endif
+
+#ifdef RESAMPLER_HAVE_AVX2
+__attribute__((target("avx2,fma")))
+static float resampler_DotAVX2(const float* pSamples, const float* pTaps, OMX_U32 nTaps) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  __m128 sum;
+  OMX_U32 i = 0;
+
+  for (; i + 16 <= nTaps; i += 16) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(pSamples + i), _mm256_load_ps(pTaps + i), sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(pSamples + i + 8), _mm256_load_ps(pTaps + i + 8), sum1);
+  }
+  if (i < nTaps) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(pSamples + i), _mm256_load_ps(pTaps + i), sum0);
+  }
+  sum0 = _mm256_add_ps(sum0, sum1);
+  sum = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+#endif
+
+#ifdef RESAMPLER_HAVE_NEON
+static float resampler_DotNEON(const float* pSamples, const float* pTaps, OMX_U32 nTaps) {
+  float32x4_t sum0 = vdupq_n_f32(0);
+  float32x4_t sum1 = vdupq_n_f32(0);
+  float32x2_t sum;
+  OMX_U32 i;
+
+  for (i = 0; i < nTaps; i += 8) {
+    sum0 = vmlaq_f32(sum0, vld1q_f32(pSamples + i), vld1q_f32(pTaps + i));
+    sum1 = vmlaq_f32(sum1, vld1q_f32(pSamples + i + 4), vld1q_f32(pTaps + i + 4));
+  }
+  sum0 = vaddq_f32(sum0, sum1);
+  sum = vadd_f32(vget_low_f32(sum0), vget_high_f32(sum0));
+  return vget_lane_f32(vpadd_f32(sum, sum), 0);
+}
+#endif
+
+/** The kernels built, the best first */
+static const resampler_kernel_t resamplerKernels[] = {
+#ifdef RESAMPLER_HAVE_AVX2
+  { "avx2", KERNEL_CPU_AVX2 | KERNEL_CPU_FMA, resampler_DotAVX2 },
+#endif
+#ifdef RESAMPLER_HAVE_SSE
+  { "sse", 0, resampler_DotSSE },
+#endif
+#ifdef RESAMPLER_HAVE_NEON
+  { "neon", 0, resampler_DotNEON },
+#endif
+  { "scalar", 0, resampler_DotScalar },
+};
+
+#define RESAMPLER_KERNELS (sizeof(resamplerKernels) / sizeof(resamplerKernels[0]))
+
+const resampler_kernel_t* resampler_SelectKernel(const char* sName) {
+  return kernel_table_select(resamplerKernels, RESAMPLER_KERNELS, sizeof(resampler_kernel_t), sName, RESAMPLER_KERNEL_ENV);
+}
+
+OMX_U32 resampler_FilterTaps(const resampler_preset_t* pPreset, OMX_U32 nUp, OMX_U32 nDown) {
+  OMX_U32 nTaps = pPreset->nTaps;
+
+  /* the filter keeps as many zero crossings below the lower Nyquist frequency */
+  if (nDown > nUp) {
+    nTaps = (OMX_U32) (((OMX_U64) nTaps * nDown + nUp - 1) / nUp);
+  }
+  nTaps = (nTaps + RESAMPLER_TAPS_ALIGN - 1) / RESAMPLER_TAPS_ALIGN * RESAMPLER_TAPS_ALIGN;
+  return nTaps < RESAMPLER_MAX_TAPS ? nTaps : RESAMPLER_MAX_TAPS;
+}
+
+/** The modified Bessel function of the first kind and order 0 */
+static double resampler_BesselI0(double x) {
+  double sum = 1, term = 1;
+  int k;
+
+  for (k = 1; k < 64 && term > sum * 1e-12; k++) {
+    term *= (x / (2 * k)) * (x / (2 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+float* resampler_DesignBank(const resampler_preset_t* pPreset, OMX_U32 nUp, OMX_U32 nDown, OMX_U32 nTaps) {
+  double fCutoff = pPreset->fCutoff;
+  double fHalf = nTaps / 2;
+  double fI0Beta = resampler_BesselI0(pPreset->fBeta);
+  double d, x, h, fSum;
+  float* pBank;
+  OMX_U32 p, k;
+
+  if (posix_memalign((void**) &pBank, RESAMPLER_TAPS_ALIGN * sizeof(float), (size_t) nUp * nTaps * sizeof(float))) {
+    return NULL;
+  }
+  if (nDown > nUp) {
+    fCutoff = fCutoff * nUp / nDown;
+  }
+  for (p = 0; p < nUp; p++) {
+    fSum = 0;
+    for (k = 0; k < nTaps; k++) {
+      /* distance of the tap to the interpolated position, in input samples */
+      d = (double) k - (fHalf - 1) - (double) p / nUp;
+      x = d / fHalf;
+      if (x <= -1 || x >= 1) {
+        h = 0;
+      } else {
+        h = (d == 0) ? fCutoff : sin(M_PI * fCutoff * d) / (M_PI * d);
+        h *= resampler_BesselI0(pPreset->fBeta * sqrt(1 - x * x)) / fI0Beta;
+      }
+      pBank[p * nTaps + k] = (float) h;
+      fSum += h;
+    }
+    /* each phase passes the DC unchanged */
+    for (k = 0; k < nTaps; k++) {
+      pBank[p * nTaps + k] = (float) (pBank[p * nTaps + k] / fSum);
+    }
+  }
+  return pBank;
+}
@@ -0,0 +1,87 @@
+/**
+  src/components/audio_effects/omx_audioresampler_kernel.h
+
+  Polyphase filter design and vectorized dot products of the audio resampler
+  component.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_AUDIORESAMPLER_KERNEL_H_
+#define _OMX_AUDIORESAMPLER_KERNEL_H_
+
+#include <OMX_Types.h>
+
+#include "kernel_table.h"
+
+/** The environment variable naming the kernel used by the resamplers, as
+ * "scalar", "sse", "avx2" or "neon". The best kernel supported by the CPU is
+ * used when it is not set or names a kernel not available.
+ */
+#define RESAMPLER_KERNEL_ENV "OMX_BELLAGIO_RESAMPLER_KERNEL"
+
+/** The taps of a phase are a multiple of this, the widest vector of the kernels */
+#define RESAMPLER_TAPS_ALIGN 8
+
+/** Most taps of a phase, reached when downsampling with the best quality */
+#define RESAMPLER_MAX_TAPS 256
+
+/** Most phases of a filter bank, the output rate divided by the greatest common
+ * divisor of the two rates. The common rates from 8000 to 192000 Hz need at most 640.
+ */
+#define RESAMPLER_MAX_PHASES 1024
+
+/** The filter of a quality preset
+ * @param nTaps the taps of a phase when upsampling, scaled by the ratio when downsampling
+ * @param fCutoff the cutoff frequency, relative to the lower of the two Nyquist frequencies
+ * @param fBeta the parameter of the Kaiser window, the stopband attenuation growing with it
+ */
+typedef struct resampler_preset_t {
+  OMX_U32 nTaps;
+  float fCutoff;
+  float fBeta;
+} resampler_preset_t;
+
+/** A dot product of nTaps samples and taps, nTaps being a multiple of
+ * RESAMPLER_TAPS_ALIGN and pTaps aligned on RESAMPLER_TAPS_ALIGN floats
+ */
+typedef float (*resampler_dot_t)(const float* pSamples, const float* pTaps, OMX_U32 nTaps);
+
+typedef struct resampler_kernel_t {
+  kernel_table_entry_FIELDS
+  resampler_dot_t DotProduct;
+} resampler_kernel_t;
+
+/** Returns the kernel named sName if the CPU supports it, the one named by
+ * RESAMPLER_KERNEL_ENV if sName is NULL, or else the best one available
+ */
+const resampler_kernel_t* resampler_SelectKernel(const char* sName);
+
+/** Returns the taps of a phase for a preset and a ratio nUp/nDown */
+OMX_U32 resampler_FilterTaps(const resampler_preset_t* pPreset, OMX_U32 nUp, OMX_U32 nDown);
+
+/** Allocates and computes the bank of nUp phases of nTaps taps of the
+ * Kaiser windowed sinc filter of a preset, NULL if out of memory. Phase p
+ * interpolates at p/nUp of an input sample after the tap nTaps/2 - 1, and
+ * its taps add up to 1. The bank is freed with free().
+ */
+float* resampler_DesignBank(const resampler_preset_t* pPreset, OMX_U32 nUp, OMX_U32 nDown, OMX_U32 nTaps);
+
+#endif
@@ -0,0 +1,714 @@
+/**
+  src/components/audio_effects/omx_channelmapper_component.c
+
+  OpenMAX channel mapper component. This component implements a filter that
+  mixes the channels of an audio PCM stream into other channels with a matrix,
+  converting the sample format and the interleaving on the way.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <math.h>
+#include <omxcore.h>
+#include <omx_base_audio_port.h>
+#include <omx_channelmapper_component.h>
+#include <OMX_Audio.h>
+
+/** The positions of the channels when the client gives no channel mapping */
+static const OMX_AUDIO_CHANNELTYPE defaultLayouts[8][8] = {
+  { OMX_AUDIO_ChannelCF },
+  { OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF },
+  { OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelCF },
+  { OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelRS },
+  { OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelCF, OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelRS },
+  { OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelCF, OMX_AUDIO_ChannelLFE, OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelRS },
+  { OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelCF, OMX_AUDIO_ChannelLFE, OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelRS,
+    OMX_AUDIO_ChannelCS },
+  { OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelCF, OMX_AUDIO_ChannelLFE, OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelRS,
+    OMX_AUDIO_ChannelLR, OMX_AUDIO_ChannelRR }
+};
+
+/** Where a channel missing in the output goes: the first rule whose
+ * channels are all in the output applies, the gain going to both of them
+ */
+typedef struct channelmapper_fold_t {
+  OMX_AUDIO_CHANNELTYPE eChannel;
+  OMX_AUDIO_CHANNELTYPE eFirst;
+  OMX_AUDIO_CHANNELTYPE eSecond;
+  float fGain;
+} channelmapper_fold_t;
+
+static const channelmapper_fold_t foldRules[] = {
+  { OMX_AUDIO_ChannelCF, OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, 0.7071f },
+  { OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelCF, OMX_AUDIO_ChannelNone, 0.7071f },
+  { OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelCF, OMX_AUDIO_ChannelNone, 0.7071f },
+  { OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelLR, OMX_AUDIO_ChannelNone, 1.0f },
+  { OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelNone, 0.7071f },
+  { OMX_AUDIO_ChannelRS, OMX_AUDIO_ChannelRR, OMX_AUDIO_ChannelNone, 1.0f },
+  { OMX_AUDIO_ChannelRS, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelNone, 0.7071f },
+  { OMX_AUDIO_ChannelLR, OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelNone, 1.0f },
+  { OMX_AUDIO_ChannelLR, OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelNone, 0.7071f },
+  { OMX_AUDIO_ChannelRR, OMX_AUDIO_ChannelRS, OMX_AUDIO_ChannelNone, 1.0f },
+  { OMX_AUDIO_ChannelRR, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelNone, 0.7071f },
+  { OMX_AUDIO_ChannelCS, OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelRS, 0.7071f },
+  { OMX_AUDIO_ChannelCS, OMX_AUDIO_ChannelLR, OMX_AUDIO_ChannelRR, 0.7071f },
+  { OMX_AUDIO_ChannelCS, OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, 0.5f }
+};
+
+#define FOLD_RULES (sizeof(foldRules) / sizeof(foldRules[0]))
+
+OMX_ERRORTYPE omx_channelmapper_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+  OMX_ERRORTYPE err;
+  omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private;
+  OMX_U32 i;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+  RM_RegisterComponent(CHANNELMAPPER_COMP_NAME, MAX_CHANNELMAPPER_COMPONENTS);
+  if (!openmaxStandComp->pComponentPrivate) {
+    err = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_channelmapper_component_PrivateType), 2, sizeof(omx_base_audio_PortType));
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+  } else {
+    DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+    return OMX_ErrorUndefined;
+  }
+
+  omx_channelmapper_component_Private = openmaxStandComp->pComponentPrivate;
+
+  /** Calling base filter constructor */
+  err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+    return err;
+  }
+
+  omx_channelmapper_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+  omx_channelmapper_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 2;
+
+  /** Allocate Ports and call port constructor. */
+  if (omx_channelmapper_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts && !omx_channelmapper_component_Private->ports) {
+    omx_channelmapper_component_Private->ports = calloc(omx_channelmapper_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts, sizeof(omx_base_PortType *));
+    if (!omx_channelmapper_component_Private->ports) {
+      return OMX_ErrorInsufficientResources;
+    }
+    for (i=0; i < omx_channelmapper_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+      omx_channelmapper_component_Private->ports[i] = calloc(1, sizeof(omx_base_audio_PortType));
+      if (!omx_channelmapper_component_Private->ports[i]) {
+        return OMX_ErrorInsufficientResources;
+      }
+    }
+  }
+
+  err = base_audio_port_Constructor(openmaxStandComp, &omx_channelmapper_component_Private->ports[0], 0, OMX_TRUE);
+  if (err != OMX_ErrorNone) {
+    return OMX_ErrorInsufficientResources;
+  }
+  err = base_audio_port_Constructor(openmaxStandComp, &omx_channelmapper_component_Private->ports[1], 1, OMX_FALSE);
+  if (err != OMX_ErrorNone) {
+    return OMX_ErrorInsufficientResources;
+  }
+
+  /** Domain specific section for the ports. */
+  omx_channelmapper_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+  omx_channelmapper_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+
+  for (i = 0; i < 2; i++) {
+    setHeader(&omx_channelmapper_component_Private->sPcmMode[i], sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+    omx_channelmapper_component_Private->sPcmMode[i].nPortIndex = i;
+    omx_channelmapper_component_Private->sPcmMode[i].nChannels = 2;
+    omx_channelmapper_component_Private->sPcmMode[i].eNumData = OMX_NumericalDataSigned;
+    omx_channelmapper_component_Private->sPcmMode[i].eEndian = OMX_EndianLittle;
+    omx_channelmapper_component_Private->sPcmMode[i].bInterleaved = OMX_TRUE;
+    omx_channelmapper_component_Private->sPcmMode[i].nBitPerSample = 16;
+    omx_channelmapper_component_Private->sPcmMode[i].nSamplingRate = 44100;
+    omx_channelmapper_component_Private->sPcmMode[i].ePCMMode = OMX_AUDIO_PCMModeLinear;
+    omx_channelmapper_component_Private->sPcmMode[i].eChannelMapping[0] = OMX_AUDIO_ChannelLF;
+    omx_channelmapper_component_Private->sPcmMode[i].eChannelMapping[1] = OMX_AUDIO_ChannelRF;
+  }
+
+  /* the float planes of all the input channels, the output channels being mixed in registers */
+  if (posix_memalign((void**) &omx_channelmapper_component_Private->pPlanes, 32, OMX_AUDIO_MAXCHANNELS * CHANNELMAPPER_BLOCK_FRAMES * sizeof(float))) {
+    omx_channelmapper_component_Private->pPlanes = NULL;
+    return OMX_ErrorInsufficientResources;
+  }
+  pthread_mutex_init(&omx_channelmapper_component_Private->matrixMutex, NULL);
+  setHeader(&omx_channelmapper_component_Private->sMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+  omx_channelmapper_component_Private->sMatrix.nPortIndex = OMX_BASE_FILTER_OUTPUTPORT_INDEX;
+  omx_channelmapper_component_Private->sMatrix.bDerived = OMX_TRUE;
+  omx_channelmapper_component_Private->bMatrixChanged = OMX_TRUE;
+
+  omx_channelmapper_component_Private->pKernel = channelmapper_SelectKernel(NULL);
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s using the %s kernel\n", __func__, omx_channelmapper_component_Private->pKernel->sName);
+  omx_channelmapper_component_Private->sKernelName = omx_channelmapper_component_Private->pKernel->sName;
+
+  omx_channelmapper_component_Private->destructor = omx_channelmapper_component_Destructor;
+  omx_channelmapper_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX]->ReturnBufferFunction = omx_channelmapper_component_port_ReturnBufferFunction;
+  openmaxStandComp->SetParameter = omx_channelmapper_component_SetParameter;
+  openmaxStandComp->GetParameter = omx_channelmapper_component_GetParameter;
+  openmaxStandComp->GetConfig = omx_channelmapper_component_GetConfig;
+  openmaxStandComp->SetConfig = omx_channelmapper_component_SetConfig;
+  openmaxStandComp->GetExtensionIndex = omx_channelmapper_component_GetExtensionIndex;
+  omx_channelmapper_component_Private->BufferMgmtCallback = omx_channelmapper_component_BufferMgmtCallback;
+
+  /* resource management special section */
+  omx_channelmapper_component_Private->nqualitylevels = CHANNELMAPPER_QUALITY_LEVELS;
+  omx_channelmapper_component_Private->currentQualityLevel = 1;
+  omx_channelmapper_component_Private->multiResourceLevel = malloc(sizeof(multiResourceDescriptor *) * CHANNELMAPPER_QUALITY_LEVELS);
+  for (i = 0; i<CHANNELMAPPER_QUALITY_LEVELS; i++) {
+    omx_channelmapper_component_Private->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+    omx_channelmapper_component_Private->multiResourceLevel[i]->CPUResourceRequested = channelmapperQualityLevels[i * 2];
+    omx_channelmapper_component_Private->multiResourceLevel[i]->MemoryResourceRequested = channelmapperQualityLevels[i * 2 + 1];
+  }
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_channelmapper_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_U32 i;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+  if (omx_channelmapper_component_Private->pPlanes) {
+    free(omx_channelmapper_component_Private->pPlanes);
+    omx_channelmapper_component_Private->pPlanes = NULL;
+    pthread_mutex_destroy(&omx_channelmapper_component_Private->matrixMutex);
+  }
+
+  /* frees port/s */
+  if (omx_channelmapper_component_Private->ports) {
+    for (i=0; i < omx_channelmapper_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+      if(omx_channelmapper_component_Private->ports[i]) {
+        omx_channelmapper_component_Private->ports[i]->PortDestructor(omx_channelmapper_component_Private->ports[i]);
+      }
+    }
+    omx_base_component_FreeStorage(openmaxStandComp, omx_channelmapper_component_Private->ports);
+    omx_channelmapper_component_Private->ports=NULL;
+  }
+
+  omx_base_filter_Destructor(openmaxStandComp);
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+static channelmapper_format_t channelmapper_PortFormat(const OMX_AUDIO_PARAM_PCMMODETYPE* pPcmMode) {
+  if (pPcmMode->eNumData == OMX_NumericalDataFloat) {
+    return CHANNELMAPPER_F32;
+  }
+  switch (pPcmMode->nBitPerSample) {
+    case 24:
+      return CHANNELMAPPER_S24;
+    case 32:
+      return CHANNELMAPPER_S32;
+    default:
+      return CHANNELMAPPER_S16;
+  }
+}
+
+/** Returns the positions of the channels of a port, from its channel mapping
+ * or else from the usual order for its number of channels
+ */
+static void channelmapper_PortLayout(const OMX_AUDIO_PARAM_PCMMODETYPE* pPcmMode, OMX_AUDIO_CHANNELTYPE* pLayout) {
+  OMX_BOOL bMapped = OMX_FALSE;
+  OMX_U32 i;
+
+  for (i = 0; i < pPcmMode->nChannels; i++) {
+    if (pPcmMode->eChannelMapping[i] != OMX_AUDIO_ChannelNone) {
+      bMapped = OMX_TRUE;
+    }
+  }
+  for (i = 0; i < pPcmMode->nChannels; i++) {
+    if (bMapped) {
+      pLayout[i] = pPcmMode->eChannelMapping[i];
+    } else if (pPcmMode->nChannels <= 8) {
+      pLayout[i] = defaultLayouts[pPcmMode->nChannels - 1][i];
+    } else {
+      pLayout[i] = OMX_AUDIO_ChannelNone;
+    }
+  }
+}
+
+static OMX_S32 channelmapper_FindChannel(const OMX_AUDIO_CHANNELTYPE* pLayout, OMX_U32 nChannels, OMX_AUDIO_CHANNELTYPE eChannel) {
+  OMX_U32 i;
+
+  for (i = 0; i < nChannels; i++) {
+    if (pLayout[i] == eChannel) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/** Derives the matrix from the channel mappings of the ports. An input
+ * channel goes to the output channel at the same position, or else is folded
+ * by the first rule that applies, or else in the centre at half gain; the
+ * LFE and the channels with nowhere to go are dropped. Channels without
+ * position go by index. The matrix is scaled down when an output channel
+ * would sum to more than full scale.
+ */
+static void channelmapper_DeriveMatrix(omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private) {
+  OMX_AUDIO_CHANNELTYPE eIn[OMX_AUDIO_MAXCHANNELS], eOut[OMX_AUDIO_MAXCHANNELS];
+  float fMatrix[OMX_AUDIO_MAXCHANNELS][OMX_AUDIO_MAXCHANNELS];
+  OMX_U32 nIn = omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].nChannels;
+  OMX_U32 nOut = omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX].nChannels;
+  OMX_S32 nFirst, nSecond, nCentre;
+  float fSum, fMax = 1.0f;
+  OMX_U32 i, o, r;
+
+  channelmapper_PortLayout(&omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX], eIn);
+  channelmapper_PortLayout(&omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX], eOut);
+  memset(fMatrix, 0, sizeof(fMatrix));
+  nCentre = channelmapper_FindChannel(eOut, nOut, OMX_AUDIO_ChannelCF);
+
+  for (i = 0; i < nIn; i++) {
+    if (eIn[i] == OMX_AUDIO_ChannelNone) {
+      if (i < nOut && eOut[i] == OMX_AUDIO_ChannelNone) {
+        fMatrix[i][i] = 1.0f;
+      }
+      continue;
+    }
+    nFirst = channelmapper_FindChannel(eOut, nOut, eIn[i]);
+    if (nFirst >= 0) {
+      fMatrix[nFirst][i] = 1.0f;
+      continue;
+    }
+    if (eIn[i] == OMX_AUDIO_ChannelLFE) {
+      continue;
+    }
+    for (r = 0; r < FOLD_RULES; r++) {
+      if (foldRules[r].eChannel != eIn[i]) {
+        continue;
+      }
+      nFirst = channelmapper_FindChannel(eOut, nOut, foldRules[r].eFirst);
+      nSecond = (foldRules[r].eSecond == OMX_AUDIO_ChannelNone) ? -1 : channelmapper_FindChannel(eOut, nOut, foldRules[r].eSecond);
+      if (nFirst >= 0 && (nSecond >= 0 || foldRules[r].eSecond == OMX_AUDIO_ChannelNone)) {
+        fMatrix[nFirst][i] += foldRules[r].fGain;
+        if (nSecond >= 0) {
+          fMatrix[nSecond][i] += foldRules[r].fGain;
+        }
+        break;
+      }
+    }
+    if (r == FOLD_RULES && nCentre >= 0) {
+      fMatrix[nCentre][i] += 0.5f;
+    }
+  }
+
+  for (o = 0; o < nOut; o++) {
+    fSum = 0;
+    for (i = 0; i < nIn; i++) {
+      fSum += fMatrix[o][i];
+    }
+    if (fSum > fMax) {
+      fMax = fSum;
+    }
+  }
+  omx_channelmapper_component_Private->sMatrix.nInputChannels = nIn;
+  omx_channelmapper_component_Private->sMatrix.nOutputChannels = nOut;
+  omx_channelmapper_component_Private->sMatrix.bDerived = OMX_TRUE;
+  for (o = 0; o < nOut; o++) {
+    for (i = 0; i < nIn; i++) {
+      omx_channelmapper_component_Private->sMatrix.nCoef[o * nIn + i] = (OMX_S32) lrintf(fMatrix[o][i] / fMax * 65536.0f);
+    }
+  }
+}
+
+/** Lists the input channels mixed in each output channel, from the matrix.
+ * Must be called with matrixMutex.
+ */
+static void channelmapper_ComputeTerms(omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private) {
+  OMX_U32 nIn = omx_channelmapper_component_Private->sMatrix.nInputChannels;
+  OMX_U32 nOut = omx_channelmapper_component_Private->sMatrix.nOutputChannels;
+  OMX_S32 nCoef;
+  OMX_U32 i, o;
+
+  omx_channelmapper_component_Private->bPassthrough = (nIn == nOut &&
+    channelmapper_PortFormat(&omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX]) == channelmapper_PortFormat(&omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX]) &&
+    omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].bInterleaved == OMX_TRUE &&
+    omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX].bInterleaved == OMX_TRUE) ? OMX_TRUE : OMX_FALSE;
+  for (o = 0; o < nOut; o++) {
+    omx_channelmapper_component_Private->nTerms[o] = 0;
+    for (i = 0; i < nIn; i++) {
+      nCoef = omx_channelmapper_component_Private->sMatrix.nCoef[o * nIn + i];
+      if (nCoef != 0) {
+        omx_channelmapper_component_Private->nTermInput[o][omx_channelmapper_component_Private->nTerms[o]] = i;
+        omx_channelmapper_component_Private->fTermCoef[o][omx_channelmapper_component_Private->nTerms[o]] = nCoef / 65536.0f;
+        omx_channelmapper_component_Private->nTerms[o]++;
+      }
+      if (nCoef != ((i == o) ? 65536 : 0)) {
+        omx_channelmapper_component_Private->bPassthrough = OMX_FALSE;
+      }
+    }
+  }
+}
+
+/** This function is used to process the input buffer and provide one output buffer.
+ * The input is converted by blocks: the samples of a block of each input
+ * channel are unpacked to floats, then each output channel is mixed from
+ * them, quantized and packed in the output buffer in the same pass, so that
+ * the buffers are read and written once. When the output buffer has room for fewer frames than the
+ * input one, the rest of the input stays for the next output buffer.
+ */
+void omx_channelmapper_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private = openmaxStandComp->pComponentPrivate;
+  channelmapper_format_t eFormatIn, eFormatOut;
+  OMX_U32 nSizeIn, nSizeOut;
+  OMX_BOOL bPlanarIn, bPlanarOut;
+  const OMX_U8* pIn = pInputBuffer->pBuffer + pInputBuffer->nOffset;
+  OMX_U8* pOut = pOutputBuffer->pBuffer;
+  const float* ppTerms[OMX_AUDIO_MAXCHANNELS];
+  OMX_U32 nIn, nOut, nFrameIn, nFrameOut, nTotal, nFrames, nBlock, f, i, o, t;
+
+  /* the formats and the matrix are taken together, as SetParameter changes both */
+  pthread_mutex_lock(&omx_channelmapper_component_Private->matrixMutex);
+  if (omx_channelmapper_component_Private->bMatrixChanged) {
+    channelmapper_ComputeTerms(omx_channelmapper_component_Private);
+    omx_channelmapper_component_Private->bMatrixChanged = OMX_FALSE;
+  }
+  eFormatIn = channelmapper_PortFormat(&omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX]);
+  eFormatOut = channelmapper_PortFormat(&omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX]);
+  bPlanarIn = omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].bInterleaved ? OMX_FALSE : OMX_TRUE;
+  bPlanarOut = omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX].bInterleaved ? OMX_FALSE : OMX_TRUE;
+  nIn = omx_channelmapper_component_Private->sMatrix.nInputChannels;
+  nOut = omx_channelmapper_component_Private->sMatrix.nOutputChannels;
+  pthread_mutex_unlock(&omx_channelmapper_component_Private->matrixMutex);
+
+  nSizeIn = channelmapper_FormatSize(eFormatIn);
+  nSizeOut = channelmapper_FormatSize(eFormatOut);
+  nFrameIn = nIn * nSizeIn;
+  nFrameOut = nOut * nSizeOut;
+  nTotal = pInputBuffer->nFilledLen / nFrameIn;
+  if (!bPlanarIn || omx_channelmapper_component_Private->nPlanarDone >= nTotal) {
+    omx_channelmapper_component_Private->nPlanarDone = 0;
+  }
+  nFrames = nTotal - omx_channelmapper_component_Private->nPlanarDone;
+  if (nFrames > pOutputBuffer->nAllocLen / nFrameOut) {
+    nFrames = pOutputBuffer->nAllocLen / nFrameOut;
+  }
+  pOutputBuffer->nFilledLen = 0;
+  if (nFrames == 0) {
+    DEBUG(DEB_LEV_ERR, "In %s dropping %d bytes, less than a frame or an output buffer too small\n", __func__, (int)pInputBuffer->nFilledLen);
+    pInputBuffer->nFilledLen = 0;
+    return;
+  }
+
+  if (omx_channelmapper_component_Private->bPassthrough) {
+    memcpy(pOut, pIn, nFrames * nFrameIn);
+  } else {
+    for (f = 0; f < nFrames; f += nBlock) {
+      nBlock = (nFrames - f < CHANNELMAPPER_BLOCK_FRAMES) ? nFrames - f : CHANNELMAPPER_BLOCK_FRAMES;
+      for (i = 0; i < nIn; i++) {
+        if (bPlanarIn) {
+          omx_channelmapper_component_Private->pKernel->Unpack(eFormatIn, omx_channelmapper_component_Private->pPlanes + i * CHANNELMAPPER_BLOCK_FRAMES,
+            pIn + (i * nTotal + omx_channelmapper_component_Private->nPlanarDone + f) * nSizeIn, 1, nBlock);
+        } else {
+          omx_channelmapper_component_Private->pKernel->Unpack(eFormatIn, omx_channelmapper_component_Private->pPlanes + i * CHANNELMAPPER_BLOCK_FRAMES,
+            pIn + f * nFrameIn + i * nSizeIn, nIn, nBlock);
+        }
+      }
+      for (o = 0; o < nOut; o++) {
+        for (t = 0; t < omx_channelmapper_component_Private->nTerms[o]; t++) {
+          ppTerms[t] = omx_channelmapper_component_Private->pPlanes + omx_channelmapper_component_Private->nTermInput[o][t] * CHANNELMAPPER_BLOCK_FRAMES;
+        }
+        if (bPlanarOut) {
+          omx_channelmapper_component_Private->pKernel->Mix(eFormatOut, pOut + (o * nFrames + f) * nSizeOut, 1,
+            ppTerms, omx_channelmapper_component_Private->fTermCoef[o], omx_channelmapper_component_Private->nTerms[o], nBlock);
+        } else {
+          omx_channelmapper_component_Private->pKernel->Mix(eFormatOut, pOut + f * nFrameOut + o * nSizeOut, nOut,
+            ppTerms, omx_channelmapper_component_Private->fTermCoef[o], omx_channelmapper_component_Private->nTerms[o], nBlock);
+        }
+      }
+    }
+  }
+  pOutputBuffer->nFilledLen = nFrames * nFrameOut;
+
+  if (bPlanarIn) {
+    /* the channels of a planar buffer are nTotal frames apart, so it is kept whole until done */
+    omx_channelmapper_component_Private->nPlanarDone += nFrames;
+    if (omx_channelmapper_component_Private->nPlanarDone == nTotal) {
+      omx_channelmapper_component_Private->nPlanarDone = 0;
+      pInputBuffer->nFilledLen = 0;
+    }
+  } else {
+    pInputBuffer->nOffset += nFrames * nFrameIn;
+    pInputBuffer->nFilledLen -= nFrames * nFrameIn;
+    if (pInputBuffer->nFilledLen < nFrameIn) {
+      /* a partial frame at the end is dropped */
+      pInputBuffer->nFilledLen = 0;
+    }
+  }
+  if (pInputBuffer->nFilledLen == 0) {
+    pInputBuffer->nOffset = 0;
+  }
+}
+
+/** A planar input buffer half converted is forgotten when it is returned. Besides
+ * the end of its conversion, this happens when the input port is flushed or
+ * disabled, or when the component goes to idle, all of which return the buffer
+ * from the buffer management thread or while that thread waits for the flush,
+ * so the next buffer is converted from its first frame.
+ */
+OMX_ERRORTYPE omx_channelmapper_component_port_ReturnBufferFunction(omx_base_PortType* openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer) {
+  omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+
+  omx_channelmapper_component_Private->nPlanarDone = 0;
+  return base_port_ReturnBufferFunction(openmaxStandPort, pBuffer);
+}
+
+OMX_ERRORTYPE omx_channelmapper_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType) {
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
+  if(strcmp(cParameterName,"OMX.st.index.config.BellagioChannelMatrix") == 0) {
+    *pIndexType = OMX_IndexConfigChannelMatrix;
+    return OMX_ErrorNone;
+  }
+  return omx_base_component_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+}
+
+/** setting configurations */
+OMX_ERRORTYPE omx_channelmapper_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+
+  if (pComponentConfigStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigChannelMatrix:
+      pMatrix = (OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pMatrix->nPortIndex != OMX_BASE_FILTER_OUTPUTPORT_INDEX) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      pthread_mutex_lock(&omx_channelmapper_component_Private->matrixMutex);
+      if (pMatrix->bDerived) {
+        channelmapper_DeriveMatrix(omx_channelmapper_component_Private);
+      } else if (pMatrix->nInputChannels != omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].nChannels ||
+                 pMatrix->nOutputChannels != omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX].nChannels) {
+        DEBUG(DEB_LEV_ERR, "In %s a %dx%d matrix for %d input and %d output channels\n", __func__,
+          (int)pMatrix->nOutputChannels, (int)pMatrix->nInputChannels,
+          (int)omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_INPUTPORT_INDEX].nChannels, (int)omx_channelmapper_component_Private->sPcmMode[OMX_BASE_FILTER_OUTPUTPORT_INDEX].nChannels);
+        err = OMX_ErrorBadParameter;
+      } else {
+        memcpy(&omx_channelmapper_component_Private->sMatrix, pMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+      }
+      omx_channelmapper_component_Private->bMatrixChanged = OMX_TRUE;
+      pthread_mutex_unlock(&omx_channelmapper_component_Private->matrixMutex);
+      break;
+    default: // delegate to superclass
+      err = omx_base_component_SetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_channelmapper_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+
+  if (pComponentConfigStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigChannelMatrix:
+      pMatrix = (OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pMatrix->nPortIndex != OMX_BASE_FILTER_OUTPUTPORT_INDEX) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      pthread_mutex_lock(&omx_channelmapper_component_Private->matrixMutex);
+      memcpy(pMatrix, &omx_channelmapper_component_Private->sMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+      pthread_mutex_unlock(&omx_channelmapper_component_Private->matrixMutex);
+      break;
+    default :
+      err = omx_base_component_GetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_channelmapper_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_U32 portIndex;
+  omx_base_audio_PortType *port;
+
+  /* Check which structure we are being fed and make control its header */
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      portIndex = pAudioPortFormat->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_channelmapper_component_Private->ports[portIndex];
+        memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      portIndex = pAudioPcmMode->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (pAudioPcmMode->nChannels < 1 || pAudioPcmMode->nChannels > OMX_AUDIO_MAXCHANNELS ||
+          !((pAudioPcmMode->eNumData == OMX_NumericalDataSigned &&
+             (pAudioPcmMode->nBitPerSample == 16 || pAudioPcmMode->nBitPerSample == 24 || pAudioPcmMode->nBitPerSample == 32)) ||
+            (pAudioPcmMode->eNumData == OMX_NumericalDataFloat && pAudioPcmMode->nBitPerSample == 32))) {
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      pthread_mutex_lock(&omx_channelmapper_component_Private->matrixMutex);
+      memcpy(&omx_channelmapper_component_Private->sPcmMode[portIndex], pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      /* the two ports carry the same rate */
+      omx_channelmapper_component_Private->sPcmMode[1 - portIndex].nSamplingRate = pAudioPcmMode->nSamplingRate;
+      if (!omx_channelmapper_component_Private->sMatrix.bDerived) {
+        DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the matrix set is replaced by the one of the channel mappings\n", __func__);
+      }
+      channelmapper_DeriveMatrix(omx_channelmapper_component_Private);
+      omx_channelmapper_component_Private->bMatrixChanged = OMX_TRUE;
+      pthread_mutex_unlock(&omx_channelmapper_component_Private->matrixMutex);
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_channelmapper_component_Private->state != OMX_StateLoaded && omx_channelmapper_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_channelmapper_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, CHANNELMAPPER_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_channelmapper_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_audio_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_channelmapper_component_PrivateType* omx_channelmapper_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_channelmapper_component_Private->sPortTypesParam[OMX_PortDomainAudio], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_channelmapper_component_Private->ports[pAudioPortFormat->nPortIndex];
+        memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPcmMode->nPortIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      pthread_mutex_lock(&omx_channelmapper_component_Private->matrixMutex);
+      memcpy(pAudioPcmMode, &omx_channelmapper_component_Private->sPcmMode[pAudioPcmMode->nPortIndex], sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      pthread_mutex_unlock(&omx_channelmapper_component_Private->matrixMutex);
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, CHANNELMAPPER_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
@@ -0,0 +1,114 @@
+/**
+  src/components/audio_effects/omx_channelmapper_component.h
+
+  OpenMAX channel mapper component. This component implements a filter that
+  mixes the channels of an audio PCM stream into other channels with a matrix,
+  converting the sample format and the interleaving on the way.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_CHANNELMAPPER_COMPONENT_H_
+#define _OMX_CHANNELMAPPER_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <OMX_Audio.h>
+#include <pthread.h>
+#include <string.h>
+#include <omx_base_filter.h>
+#include "omx_channelmapper_kernel.h"
+
+#define CHANNELMAPPER_COMP_NAME "OMX.st.audio.channelmapper"
+#define CHANNELMAPPER_COMP_ROLE "audio.channelmapper"
+#define MAX_CHANNELMAPPER_COMPONENTS 10
+
+/** Channel mapper component resources */
+#define CHANNELMAPPER_QUALITY_LEVELS 1
+static int channelmapperQualityLevels []={20, 131072};
+
+/** Channel mapper component private structure.
+ * @param sPcmMode the PCM format of the input and output ports
+ * @param sMatrix the matrix set by the client or derived from the channel mappings
+ * @param matrixMutex protects sPcmMode and sMatrix, set while the component is executing
+ * @param bMatrixChanged sMatrix changed since the terms were computed
+ * @param pKernel the matrix and conversion kernels used
+ * @param nTerms the input channels mixed in each output channel
+ * @param nTermInput the input channels mixed in each output channel
+ * @param fTermCoef their gains
+ * @param bPassthrough the output is a copy of the input
+ * @param pPlanes the float samples of a block of each input channel
+ * @param nPlanarDone the frames of the current planar input buffer already converted
+ */
+DERIVEDCLASS(omx_channelmapper_component_PrivateType, omx_base_filter_PrivateType)
+#define omx_channelmapper_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
+  OMX_AUDIO_PARAM_PCMMODETYPE sPcmMode[2]; \
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sMatrix; \
+  pthread_mutex_t matrixMutex; \
+  OMX_BOOL bMatrixChanged; \
+  const channelmapper_kernel_t* pKernel; \
+  OMX_U32 nTerms[OMX_AUDIO_MAXCHANNELS]; \
+  OMX_U32 nTermInput[OMX_AUDIO_MAXCHANNELS][OMX_AUDIO_MAXCHANNELS]; \
+  float fTermCoef[OMX_AUDIO_MAXCHANNELS][OMX_AUDIO_MAXCHANNELS]; \
+  OMX_BOOL bPassthrough; \
+  float* pPlanes; \
+  OMX_U32 nPlanarDone;
+ENDCLASS(omx_channelmapper_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_channelmapper_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_channelmapper_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_channelmapper_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* inputbuffer,
+  OMX_BUFFERHEADERTYPE* outputbuffer);
+
+OMX_ERRORTYPE omx_channelmapper_component_port_ReturnBufferFunction(
+  omx_base_PortType* openmaxStandPort,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE omx_channelmapper_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType);
+
+OMX_ERRORTYPE omx_channelmapper_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_channelmapper_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_channelmapper_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_channelmapper_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+#endif
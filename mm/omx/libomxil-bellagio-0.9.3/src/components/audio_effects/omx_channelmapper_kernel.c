@@ -0,0 +1,574 @@
+/**
+  src/components/audio_effects/omx_channelmapper_kernel.c
+
+  Vectorized kernels of the channel mapper component, which unpack the
+  samples of the input channels to floats, and mix, quantize and pack the
+  samples of an output channel in a single pass. The kernels are chosen at
+  run time among the ones built for the target: SSE2 and AVX2 with FMA on
+  x86, NEON on ARM, and the scalar one.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <omxcore.h>
+#include "omx_channelmapper_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CHANNELMAPPER_HAVE_AVX2
+#ifdef __SSE2__
+#define CHANNELMAPPER_HAVE_SSE
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CHANNELMAPPER_HAVE_NEON
+#endif
+
+OMX_U32 channelmapper_FormatSize(channelmapper_format_t eFormat) {
+  switch (eFormat) {
+    case CHANNELMAPPER_S16:
+      return 2;
+    case CHANNELMAPPER_S24:
+      return 3;
+    default:
+      return 4;
+  }
+}
+
+/** The full scale of an integer format, and its largest sample as a float */
+static void channelmapper_FormatRange(channelmapper_format_t eFormat, float* pScale, float* pMax) {
+  switch (eFormat) {
+    case CHANNELMAPPER_S16:
+      *pScale = 32768.0f;
+      *pMax = 32767.0f;
+      break;
+    case CHANNELMAPPER_S24:
+      *pScale = 8388608.0f;
+      *pMax = 8388607.0f;
+      break;
+    default:
+      /* the largest float below 2^31 */
+      *pScale = 2147483648.0f;
+      *pMax = 2147483520.0f;
+      break;
+  }
+}
+
+/** Stores n integer samples, nStride samples apart in pOut */
+static inline void channelmapper_StoreInts(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride, const int32_t* pIn, OMX_U32 n) {
+  OMX_S16* pS16 = (OMX_S16*) pOut;
+  int32_t* pS32 = (int32_t*) pOut;
+  OMX_U8* p;
+  OMX_U32 f;
+
+  switch (eFormat) {
+    case CHANNELMAPPER_S16:
+      for (f = 0; f < n; f++) {
+        pS16[f * nStride] = (OMX_S16) pIn[f];
+      }
+      break;
+    case CHANNELMAPPER_S24:
+      for (f = 0; f < n; f++) {
+        p = pOut + f * nStride * 3;
+        p[0] = (OMX_U8) pIn[f];
+        p[1] = (OMX_U8) (pIn[f] >> 8);
+        p[2] = (OMX_U8) (pIn[f] >> 16);
+      }
+      break;
+    default:
+      for (f = 0; f < n; f++) {
+        pS32[f * nStride] = pIn[f];
+      }
+      break;
+  }
+}
+
+/** Stores n mixed samples, nStride samples apart in pOut. Unless the format is
+ * float, they are scaled, saturated and rounded to the nearest integer.
+ */
+static inline void channelmapper_StoreScalar(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride, const float* pIn, OMX_U32 n) {
+  int32_t nQuantized[CHANNELMAPPER_BLOCK_FRAMES];
+  float* pF32 = (float*) pOut;
+  float fScale, fMax, x;
+  OMX_U32 f;
+
+  if (eFormat == CHANNELMAPPER_F32) {
+    for (f = 0; f < n; f++) {
+      pF32[f * nStride] = pIn[f];
+    }
+    return;
+  }
+  channelmapper_FormatRange(eFormat, &fScale, &fMax);
+  for (f = 0; f < n; f++) {
+    x = pIn[f] * fScale;
+    if (x > fMax) {
+      x = fMax;
+    } else if (x < -fScale) {
+      x = -fScale;
+    }
+    nQuantized[f] = (int32_t) lrintf(x);
+  }
+  channelmapper_StoreInts(eFormat, pOut, nStride, nQuantized, n);
+}
+
+/** Mixes and stores the frames of an output channel from nFirst to nFrames,
+ * by blocks, pOut pointing to the frame 0. Also the tail of the vector kernels.
+ */
+static void channelmapper_MixFrom(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  const float* const* ppIn, const float* pCoef, OMX_U32 nTerms, OMX_U32 nFirst, OMX_U32 nFrames) {
+  float fSum[CHANNELMAPPER_BLOCK_FRAMES];
+  OMX_U32 nSize = channelmapper_FormatSize(eFormat);
+  OMX_U32 f, n, i, t;
+  float sum;
+
+  for (f = nFirst; f < nFrames; f += n) {
+    n = (nFrames - f < CHANNELMAPPER_BLOCK_FRAMES) ? nFrames - f : CHANNELMAPPER_BLOCK_FRAMES;
+    for (i = 0; i < n; i++) {
+      sum = 0;
+      for (t = 0; t < nTerms; t++) {
+        sum += pCoef[t] * ppIn[t][f + i];
+      }
+      fSum[i] = sum;
+    }
+    channelmapper_StoreScalar(eFormat, pOut + f * nStride * nSize, nStride, fSum, n);
+  }
+}
+
+static void channelmapper_MixScalar(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  const float* const* ppIn, const float* pCoef, OMX_U32 nTerms, OMX_U32 nFrames) {
+  channelmapper_MixFrom(eFormat, pOut, nStride, ppIn, pCoef, nTerms, 0, nFrames);
+}
+
+static void channelmapper_UnpackScalar(channelmapper_format_t eFormat, float* pOut, const OMX_U8* pIn, OMX_U32 nStride, OMX_U32 nFrames) {
+  const OMX_S16* pS16 = (const OMX_S16*) pIn;
+  const int32_t* pS32 = (const int32_t*) pIn;
+  const float* pF32 = (const float*) pIn;
+  const OMX_U8* p;
+  OMX_U32 f;
+
+  switch (eFormat) {
+    case CHANNELMAPPER_S16:
+      for (f = 0; f < nFrames; f++) {
+        pOut[f] = pS16[f * nStride] * (1.0f / 32768.0f);
+      }
+      break;
+    case CHANNELMAPPER_S24:
+      for (f = 0; f < nFrames; f++) {
+        p = pIn + f * nStride * 3;
+        /* the third byte is shifted to the top of the word, so that the sign is kept */
+        pOut[f] = (int32_t) (((OMX_U32) p[0] << 8) | ((OMX_U32) p[1] << 16) | ((OMX_U32) p[2] << 24)) * (1.0f / 2147483648.0f);
+      }
+      break;
+    case CHANNELMAPPER_S32:
+      for (f = 0; f < nFrames; f++) {
+        pOut[f] = pS32[f * nStride] * (1.0f / 2147483648.0f);
+      }
+      break;
+    case CHANNELMAPPER_F32:
+      for (f = 0; f < nFrames; f++) {
+        pOut[f] = pF32[f * nStride];
+      }
+      break;
+  }
+}
+
+#ifdef CHANNELMAPPER_HAVE_SSE
+/** Stores the 8 mixed samples of x0 and x1 from the registers */
+__attribute__((always_inline))
+static inline void channelmapper_Store8SSE(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  __m128 x0, __m128 x1, __m128 scale, __m128 low, __m128 high) {
+  int32_t nQuantized[8];
+  OMX_S16 nPacked[8];
+  float fMixed[8];
+  __m128i q0, q1;
+  OMX_U32 f;
+
+  if (eFormat == CHANNELMAPPER_F32) {
+    if (nStride == 1) {
+      _mm_storeu_ps((float*) pOut, x0);
+      _mm_storeu_ps((float*) pOut + 4, x1);
+    } else {
+      _mm_storeu_ps(fMixed, x0);
+      _mm_storeu_ps(fMixed + 4, x1);
+      for (f = 0; f < 8; f++) {
+        ((float*) pOut)[f * nStride] = fMixed[f];
+      }
+    }
+    return;
+  }
+  q0 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(x0, scale), low), high));
+  q1 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(x1, scale), low), high));
+  if (eFormat == CHANNELMAPPER_S16) {
+    /* the samples are saturated already, so the packing keeps them */
+    if (nStride == 1) {
+      _mm_storeu_si128((__m128i*) pOut, _mm_packs_epi32(q0, q1));
+    } else {
+      _mm_storeu_si128((__m128i*) nPacked, _mm_packs_epi32(q0, q1));
+      for (f = 0; f < 8; f++) {
+        ((OMX_S16*) pOut)[f * nStride] = nPacked[f];
+      }
+    }
+  } else if (nStride == 1 && eFormat == CHANNELMAPPER_S32) {
+    _mm_storeu_si128((__m128i*) pOut, q0);
+    _mm_storeu_si128((__m128i*) pOut + 1, q1);
+  } else {
+    _mm_storeu_si128((__m128i*) nQuantized, q0);
+    _mm_storeu_si128((__m128i*) (nQuantized + 4), q1);
+    channelmapper_StoreInts(eFormat, pOut, nStride, nQuantized, 8);
+  }
+}
+
+static void channelmapper_MixSSE(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  const float* const* ppIn, const float* pCoef, OMX_U32 nTerms, OMX_U32 nFrames) {
+  OMX_U32 nSize = channelmapper_FormatSize(eFormat);
+  __m128 sum0, sum1, coef, scale, low, high;
+  float fScale, fMax;
+  OMX_U32 f = 0, t;
+
+  channelmapper_FormatRange(eFormat, &fScale, &fMax);
+  scale = _mm_set1_ps(fScale);
+  low = _mm_set1_ps(-fScale);
+  high = _mm_set1_ps(fMax);
+  /* the sums of 8 frames stay in registers across the terms, and are stored from there */
+  for (; f + 8 <= nFrames; f += 8) {
+    sum0 = _mm_setzero_ps();
+    sum1 = _mm_setzero_ps();
+    for (t = 0; t < nTerms; t++) {
+      coef = _mm_set1_ps(pCoef[t]);
+      sum0 = _mm_add_ps(sum0, _mm_mul_ps(coef, _mm_loadu_ps(ppIn[t] + f)));
+      sum1 = _mm_add_ps(sum1, _mm_mul_ps(coef, _mm_loadu_ps(ppIn[t] + f + 4)));
+    }
+    channelmapper_Store8SSE(eFormat, pOut + f * nStride * nSize, nStride, sum0, sum1, scale, low, high);
+  }
+  channelmapper_MixFrom(eFormat, pOut, nStride, ppIn, pCoef, nTerms, f, nFrames);
+}
+
+/** Unpacks the channels of planar buffers, SSE2 having no gather for the
+ * interleaved ones, which are left to the scalar code
+ */
+static void channelmapper_UnpackSSE(channelmapper_format_t eFormat, float* pOut, const OMX_U8* pIn, OMX_U32 nStride, OMX_U32 nFrames) {
+  __m128 unit = _mm_set1_ps(1.0f / 2147483648.0f);
+  __m128i x;
+  OMX_U32 f = 0;
+
+  if (nStride == 1) {
+    switch (eFormat) {
+      case CHANNELMAPPER_S16:
+        for (; f + 8 <= nFrames; f += 8) {
+          x = _mm_loadu_si128((const __m128i*) (pIn + f * 2));
+          /* each sample goes to the top of a word, which is scaled as a 32 bit one */
+          _mm_storeu_ps(pOut + f, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), x)), unit));
+          _mm_storeu_ps(pOut + f + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(_mm_setzero_si128(), x)), unit));
+        }
+        break;
+      case CHANNELMAPPER_S32:
+        for (; f + 4 <= nFrames; f += 4) {
+          _mm_storeu_ps(pOut + f, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) (pIn + f * 4))), unit));
+        }
+        break;
+      case CHANNELMAPPER_F32:
+        memcpy(pOut, pIn, nFrames * sizeof(float));
+        f = nFrames;
+        break;
+      default:
+        break;
+    }
+  }
+  channelmapper_UnpackScalar(eFormat, pOut + f, pIn + f * nStride * channelmapper_FormatSize(eFormat), nStride, nFrames - f);
+}
+#endif
+
+#ifdef CHANNELMAPPER_HAVE_AVX2
+/** Stores the 16 mixed samples of x0 and x1 from the registers */
+__attribute__((target("avx2,fma"), always_inline))
+static inline void channelmapper_Store16AVX2(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  __m256 x0, __m256 x1, __m256 scale, __m256 low, __m256 high) {
+  int32_t nQuantized[16];
+  OMX_S16 nPacked[16];
+  float fMixed[16];
+  __m256i q0, q1;
+  OMX_U32 f;
+
+  if (eFormat == CHANNELMAPPER_F32) {
+    if (nStride == 1) {
+      _mm256_storeu_ps((float*) pOut, x0);
+      _mm256_storeu_ps((float*) pOut + 8, x1);
+    } else {
+      _mm256_storeu_ps(fMixed, x0);
+      _mm256_storeu_ps(fMixed + 8, x1);
+      for (f = 0; f < 16; f++) {
+        ((float*) pOut)[f * nStride] = fMixed[f];
+      }
+    }
+    return;
+  }
+  q0 = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(x0, scale), low), high));
+  q1 = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(x1, scale), low), high));
+  if (eFormat == CHANNELMAPPER_S16) {
+    /* the packing works in each 128 bit lane, so the quarters are put back in order */
+    if (nStride == 1) {
+      _mm256_storeu_si256((__m256i*) pOut, _mm256_permute4x64_epi64(_mm256_packs_epi32(q0, q1), 0xd8));
+    } else {
+      _mm256_storeu_si256((__m256i*) nPacked, _mm256_permute4x64_epi64(_mm256_packs_epi32(q0, q1), 0xd8));
+      for (f = 0; f < 16; f++) {
+        ((OMX_S16*) pOut)[f * nStride] = nPacked[f];
+      }
+    }
+  } else if (nStride == 1 && eFormat == CHANNELMAPPER_S32) {
+    _mm256_storeu_si256((__m256i*) pOut, q0);
+    _mm256_storeu_si256((__m256i*) pOut + 1, q1);
+  } else {
+    _mm256_storeu_si256((__m256i*) nQuantized, q0);
+    _mm256_storeu_si256((__m256i*) (nQuantized + 8), q1);
+    channelmapper_StoreInts(eFormat, pOut, nStride, nQuantized, 16);
+  }
+}
+
+__attribute__((target("avx2,fma")))
+static void channelmapper_MixAVX2(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  const float* const* ppIn, const float* pCoef, OMX_U32 nTerms, OMX_U32 nFrames) {
+  OMX_U32 nSize = channelmapper_FormatSize(eFormat);
+  __m256 sum0, sum1, coef, scale, low, high;
+  float fScale, fMax;
+  OMX_U32 f = 0, t;
+
+  channelmapper_FormatRange(eFormat, &fScale, &fMax);
+  scale = _mm256_set1_ps(fScale);
+  low = _mm256_set1_ps(-fScale);
+  high = _mm256_set1_ps(fMax);
+  for (; f + 16 <= nFrames; f += 16) {
+    sum0 = _mm256_setzero_ps();
+    sum1 = _mm256_setzero_ps();
+    for (t = 0; t < nTerms; t++) {
+      coef = _mm256_set1_ps(pCoef[t]);
+      sum0 = _mm256_fmadd_ps(coef, _mm256_loadu_ps(ppIn[t] + f), sum0);
+      sum1 = _mm256_fmadd_ps(coef, _mm256_loadu_ps(ppIn[t] + f + 8), sum1);
+    }
+    channelmapper_Store16AVX2(eFormat, pOut + f * nStride * nSize, nStride, sum0, sum1, scale, low, high);
+  }
+  channelmapper_MixFrom(eFormat, pOut, nStride, ppIn, pCoef, nTerms, f, nFrames);
+}
+
+/** Unpacks the channels of planar buffers and of stereo 16 bit ones with
+ * loads, and the ones of other interleaved buffers with gathers, but for 16
+ * and 24 bit samples, which gathers read slower than the scalar code
+ */
+__attribute__((target("avx2,fma")))
+static void channelmapper_UnpackAVX2(channelmapper_format_t eFormat, float* pOut, const OMX_U8* pIn, OMX_U32 nStride, OMX_U32 nFrames) {
+  OMX_U32 nStep = nStride * channelmapper_FormatSize(eFormat);
+  __m256i index = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int) nStep));
+  __m256 unit = _mm256_set1_ps(1.0f / 2147483648.0f);
+  __m256i shuffle24 = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+    -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+  __m256i x;
+  OMX_U32 nWordFrames;
+  OMX_U32 f = 0;
+
+  /* a word is read for each stereo 16 bit frame, so up to the last frame but
+   * one, the word of the last one ending past the buffer
+   */
+  nWordFrames = (nFrames > 0) ? nFrames - 1 : 0;
+  switch (eFormat) {
+    case CHANNELMAPPER_S16:
+      if (nStride == 1) {
+        for (; f + 8 <= nFrames; f += 8) {
+          x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*) (pIn + f * 2)));
+          _mm256_storeu_ps(pOut + f, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_slli_epi32(x, 16)), unit));
+        }
+      } else if (nStride == 2) {
+        /* a stereo frame is a word, whose low half is the sample of the channel */
+        for (; f + 8 <= nWordFrames; f += 8) {
+          x = _mm256_loadu_si256((const __m256i*) (pIn + f * 4));
+          _mm256_storeu_ps(pOut + f, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_slli_epi32(x, 16)), unit));
+        }
+      }
+      break;
+    case CHANNELMAPPER_S24:
+      if (nStride == 1) {
+        /* the 4 samples of each 16 byte load are shuffled up in their words,
+         * the second load ending 4 bytes past the 8 samples
+         */
+        for (; f + 10 <= nFrames; f += 8) {
+          x = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) (pIn + f * 3))),
+            _mm_loadu_si128((const __m128i*) (pIn + f * 3 + 12)), 1);
+          x = _mm256_shuffle_epi8(x, shuffle24);
+          _mm256_storeu_ps(pOut + f, _mm256_mul_ps(_mm256_cvtepi32_ps(x), unit));
+        }
+      }
+      break;
+    case CHANNELMAPPER_S32:
+      for (; f + 8 <= nFrames; f += 8) {
+        if (nStride == 1) {
+          x = _mm256_loadu_si256((const __m256i*) (pIn + f * 4));
+        } else {
+          x = _mm256_i32gather_epi32((const int*) (pIn + f * nStep), index, 1);
+        }
+        _mm256_storeu_ps(pOut + f, _mm256_mul_ps(_mm256_cvtepi32_ps(x), unit));
+      }
+      break;
+    case CHANNELMAPPER_F32:
+      if (nStride == 1) {
+        memcpy(pOut, pIn, nFrames * sizeof(float));
+        f = nFrames;
+      } else {
+        for (; f + 8 <= nFrames; f += 8) {
+          _mm256_storeu_ps(pOut + f, _mm256_i32gather_ps((const float*) (pIn + f * nStep), index, 1));
+        }
+      }
+      break;
+  }
+  channelmapper_UnpackScalar(eFormat, pOut + f, pIn + f * nStep, nStride, nFrames - f);
+}
+#endif
+
+#ifdef CHANNELMAPPER_HAVE_NEON
+/** Scales, saturates and rounds 4 mixed samples, the conversion truncating
+ * so that half a unit away from zero is added first
+ */
+static inline int32x4_t channelmapper_QuantizeNEON(float32x4_t x, float fScale, float32x4_t low, float32x4_t high) {
+  float32x4_t half = vdupq_n_f32(0.5f);
+
+  x = vminq_f32(vmaxq_f32(vmulq_n_f32(x, fScale), low), high);
+  x = vaddq_f32(x, vbslq_f32(vcltq_f32(x, vdupq_n_f32(0)), vnegq_f32(half), half));
+  return vcvtq_s32_f32(x);
+}
+
+/** Stores the 8 mixed samples of x0 and x1 from the registers */
+__attribute__((always_inline))
+static inline void channelmapper_Store8NEON(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  float32x4_t x0, float32x4_t x1, float fScale, float32x4_t low, float32x4_t high) {
+  int32_t nQuantized[8];
+  OMX_S16 nPacked[8];
+  float fMixed[8];
+  int32x4_t q0, q1;
+  OMX_U32 f;
+
+  if (eFormat == CHANNELMAPPER_F32) {
+    if (nStride == 1) {
+      vst1q_f32((float*) pOut, x0);
+      vst1q_f32((float*) pOut + 4, x1);
+    } else {
+      vst1q_f32(fMixed, x0);
+      vst1q_f32(fMixed + 4, x1);
+      for (f = 0; f < 8; f++) {
+        ((float*) pOut)[f * nStride] = fMixed[f];
+      }
+    }
+    return;
+  }
+  q0 = channelmapper_QuantizeNEON(x0, fScale, low, high);
+  q1 = channelmapper_QuantizeNEON(x1, fScale, low, high);
+  if (eFormat == CHANNELMAPPER_S16) {
+    if (nStride == 1) {
+      vst1q_s16((int16_t*) pOut, vcombine_s16(vqmovn_s32(q0), vqmovn_s32(q1)));
+    } else {
+      vst1q_s16((int16_t*) nPacked, vcombine_s16(vqmovn_s32(q0), vqmovn_s32(q1)));
+      for (f = 0; f < 8; f++) {
+        ((OMX_S16*) pOut)[f * nStride] = nPacked[f];
+      }
+    }
+  } else if (nStride == 1 && eFormat == CHANNELMAPPER_S32) {
+    vst1q_s32((int32_t*) pOut, q0);
+    vst1q_s32((int32_t*) pOut + 4, q1);
+  } else {
+    vst1q_s32(nQuantized, q0);
+    vst1q_s32(nQuantized + 4, q1);
+    channelmapper_StoreInts(eFormat, pOut, nStride, nQuantized, 8);
+  }
+}
+
+static void channelmapper_MixNEON(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  const float* const* ppIn, const float* pCoef, OMX_U32 nTerms, OMX_U32 nFrames) {
+  OMX_U32 nSize = channelmapper_FormatSize(eFormat);
+  float32x4_t sum0, sum1, low, high;
+  float fScale, fMax;
+  OMX_U32 f = 0, t;
+
+  channelmapper_FormatRange(eFormat, &fScale, &fMax);
+  low = vdupq_n_f32(-fScale);
+  high = vdupq_n_f32(fMax);
+  for (; f + 8 <= nFrames; f += 8) {
+    sum0 = vdupq_n_f32(0);
+    sum1 = vdupq_n_f32(0);
+    for (t = 0; t < nTerms; t++) {
+      sum0 = vmlaq_n_f32(sum0, vld1q_f32(ppIn[t] + f), pCoef[t]);
+      sum1 = vmlaq_n_f32(sum1, vld1q_f32(ppIn[t] + f + 4), pCoef[t]);
+    }
+    channelmapper_Store8NEON(eFormat, pOut + f * nStride * nSize, nStride, sum0, sum1, fScale, low, high);
+  }
+  channelmapper_MixFrom(eFormat, pOut, nStride, ppIn, pCoef, nTerms, f, nFrames);
+}
+
+/** Unpacks the channels of planar buffers, the interleaved ones being left to the scalar code */
+static void channelmapper_UnpackNEON(channelmapper_format_t eFormat, float* pOut, const OMX_U8* pIn, OMX_U32 nStride, OMX_U32 nFrames) {
+  int16x8_t x;
+  OMX_U32 f = 0;
+
+  if (nStride == 1) {
+    switch (eFormat) {
+      case CHANNELMAPPER_S16:
+        for (; f + 8 <= nFrames; f += 8) {
+          x = vld1q_s16((const int16_t*) (pIn + f * 2));
+          vst1q_f32(pOut + f, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), 1.0f / 32768.0f));
+          vst1q_f32(pOut + f + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), 1.0f / 32768.0f));
+        }
+        break;
+      case CHANNELMAPPER_S32:
+        for (; f + 4 <= nFrames; f += 4) {
+          vst1q_f32(pOut + f, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32((const int32_t*) (pIn + f * 4))), 1.0f / 2147483648.0f));
+        }
+        break;
+      case CHANNELMAPPER_F32:
+        memcpy(pOut, pIn, nFrames * sizeof(float));
+        f = nFrames;
+        break;
+      default:
+        break;
+    }
+  }
+  channelmapper_UnpackScalar(eFormat, pOut + f, pIn + f * nStride * channelmapper_FormatSize(eFormat), nStride, nFrames - f);
+}
+#endif
+
+/** The kernels built, the best first */
+static const channelmapper_kernel_t channelmapperKernels[] = {
+#ifdef CHANNELMAPPER_HAVE_AVX2
+  { "avx2", KERNEL_CPU_AVX2 | KERNEL_CPU_FMA, channelmapper_UnpackAVX2, channelmapper_MixAVX2 },
+#endif
+#ifdef CHANNELMAPPER_HAVE_SSE
+  { "sse", 0, channelmapper_UnpackSSE, channelmapper_MixSSE },
+#endif
+#ifdef CHANNELMAPPER_HAVE_NEON
+  { "neon", 0, channelmapper_UnpackNEON, channelmapper_MixNEON },
+#endif
+  { "scalar", 0, channelmapper_UnpackScalar, channelmapper_MixScalar },
+};
+
+#define CHANNELMAPPER_KERNELS (sizeof(channelmapperKernels) / sizeof(channelmapperKernels[0]))
+
+const channelmapper_kernel_t* channelmapper_SelectKernel(const char* sName) {
+  return kernel_table_select(channelmapperKernels, CHANNELMAPPER_KERNELS, sizeof(channelmapper_kernel_t), sName, CHANNELMAPPER_KERNEL_ENV);
+}
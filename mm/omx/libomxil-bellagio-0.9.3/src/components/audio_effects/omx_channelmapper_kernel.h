@@ -0,0 +1,79 @@
+/**
+  src/components/audio_effects/omx_channelmapper_kernel.h
+
+  Sample format conversions and vectorized matrix kernels of the channel
+  mapper component.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_CHANNELMAPPER_KERNEL_H_
+#define _OMX_CHANNELMAPPER_KERNEL_H_
+
+#include <stdint.h>
+#include <OMX_Types.h>
+
+#include "kernel_table.h"
+
+/** The environment variable naming the kernel used by the channel mappers, as
+ * "scalar", "sse", "avx2" or "neon". The best kernel supported by the CPU is
+ * used when it is not set or names a kernel not available.
+ */
+#define CHANNELMAPPER_KERNEL_ENV "OMX_BELLAGIO_CHANNELMAPPER_KERNEL"
+
+/** Frames converted at once, so that the float planes of all the channels stay in the cache */
+#define CHANNELMAPPER_BLOCK_FRAMES 256
+
+/** The sample formats of the ports */
+typedef enum channelmapper_format_t {
+  CHANNELMAPPER_S16,
+  CHANNELMAPPER_S24, /**< packed in 3 bytes */
+  CHANNELMAPPER_S32,
+  CHANNELMAPPER_F32  /**< from -1.0 to 1.0 */
+} channelmapper_format_t;
+
+/** Converts nFrames samples of an input channel to floats, consecutive samples
+ * being nStride samples apart in pIn
+ */
+typedef void (*channelmapper_unpack_t)(channelmapper_format_t eFormat, float* pOut, const OMX_U8* pIn, OMX_U32 nStride, OMX_U32 nFrames);
+
+/** Computes nFrames samples of an output channel, the sum of nTerms input
+ * planes ppIn weighted by pCoef, and stores them in eFormat nStride samples
+ * apart in pOut. Integer samples are rounded and saturated on the way, the
+ * sums never leaving the registers.
+ */
+typedef void (*channelmapper_mix_t)(channelmapper_format_t eFormat, OMX_U8* pOut, OMX_U32 nStride,
+  const float* const* ppIn, const float* pCoef, OMX_U32 nTerms, OMX_U32 nFrames);
+
+typedef struct channelmapper_kernel_t {
+  kernel_table_entry_FIELDS
+  channelmapper_unpack_t Unpack;
+  channelmapper_mix_t Mix;
+} channelmapper_kernel_t;
+
+/** Returns the kernel named sName if the CPU supports it, the one named by
+ * CHANNELMAPPER_KERNEL_ENV if sName is NULL, or else the best one available
+ */
+const channelmapper_kernel_t* channelmapper_SelectKernel(const char* sName);
+
+/** Returns the bytes of a sample */
+OMX_U32 channelmapper_FormatSize(channelmapper_format_t eFormat);
+
+#endif
@@ -41,11 +41,11 @@ OMX_ERRORTYPE omx_volume_component_Constructor(OMX_COMPONENTTYPE *openmaxStandCo
 
 	RM_RegisterComponent(VOLUME_COMP_NAME, MAX_VOLUME_COMPONENTS);
 	if (!openmaxStandComp->pComponentPrivate) {
-		openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_volume_component_PrivateType));
+		err = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_volume_component_PrivateType), 2, sizeof(omx_base_audio_PortType));
 		DEBUG(DEB_LEV_FUNCTION_NAME, "In %s allocated private structure %p for std component %p\n",
 				__func__, openmaxStandComp->pComponentPrivate, openmaxStandComp);
-		if(openmaxStandComp->pComponentPrivate == NULL) {
-			return OMX_ErrorInsufficientResources;
+		if (err != OMX_ErrorNone) {
+			return err;
 		}
 	} else {
 		DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
@@ -53,7 +53,6 @@ OMX_ERRORTYPE omx_volume_component_Constructor(OMX_COMPONENTTYPE *openmaxStandCo
 	}
 
 	omx_volume_component_Private = openmaxStandComp->pComponentPrivate;
-	omx_volume_component_Private->ports = NULL;
 
 	/** Calling base filter constructor */
 	err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
@@ -99,6 +98,7 @@ OMX_ERRORTYPE omx_volume_component_Constructor(OMX_COMPONENTTYPE *openmaxStandCo
 	openmaxStandComp->GetConfig = omx_volume_component_GetConfig;
 	openmaxStandComp->SetConfig = omx_volume_component_SetConfig;
 	omx_volume_component_Private->BufferMgmtCallback = omx_volume_component_BufferMgmtCallback;
+	omx_volume_component_Private->BufferMgmtBatchCallback = omx_volume_component_BufferMgmtBatchCallback;
 
   /* resource management special section */
   omx_volume_component_Private->nqualitylevels = VOLUME_QUALITY_LEVELS;
@@ -130,7 +130,7 @@ OMX_ERRORTYPE omx_volume_component_Destructor(OMX_COMPONENTTYPE *openmaxStandCom
 				omx_volume_component_Private->ports[i]->PortDestructor(omx_volume_component_Private->ports[i]);
 			}
 		}
-		free(omx_volume_component_Private->ports);
+		omx_base_component_FreeStorage(openmaxStandComp, omx_volume_component_Private->ports);
 		omx_volume_component_Private->ports=NULL;
 	}
 
@@ -159,6 +159,23 @@ void omx_volume_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp
   pInputBuffer->nFilledLen=0;
 }
 
+/** This function processes at once all the available buffers, each input
+  * buffer being copied in the output buffer at the same position
+  */
+void omx_volume_component_BufferMgmtBatchCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE** pInputBuffers, OMX_U32 nInputBuffers,
+                                                  OMX_BUFFERHEADERTYPE** pOutputBuffers, OMX_U32 nOutputBuffers) {
+  OMX_U32 i;
+
+  for (i = 0; i < nInputBuffers && i < nOutputBuffers; i++) {
+    pOutputBuffers[i]->nTimeStamp = pInputBuffers[i]->nTimeStamp;
+    if((pInputBuffers[i]->nFlags & OMX_BUFFERFLAG_STARTTIME) == OMX_BUFFERFLAG_STARTTIME) {
+      pOutputBuffers[i]->nFlags |= OMX_BUFFERFLAG_STARTTIME;
+      pInputBuffers[i]->nFlags &= ~OMX_BUFFERFLAG_STARTTIME;
+    }
+    omx_volume_component_BufferMgmtCallback(openmaxStandComp, pInputBuffers[i], pOutputBuffers[i]);
+  }
+}
+
 /** setting configurations */
 OMX_ERRORTYPE omx_volume_component_SetConfig(
   OMX_HANDLETYPE hComponent,
@@ -56,6 +56,13 @@ void omx_volume_component_BufferMgmtCallback(
   OMX_BUFFERHEADERTYPE* inputbuffer,
   OMX_BUFFERHEADERTYPE* outputbuffer);
 
+void omx_volume_component_BufferMgmtBatchCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE** pInputBuffers,
+  OMX_U32 nInputBuffers,
+  OMX_BUFFERHEADERTYPE** pOutputBuffers,
+  OMX_U32 nOutputBuffers);
+
 OMX_ERRORTYPE omx_volume_component_GetParameter(
   OMX_HANDLETYPE hComponent,
   OMX_INDEXTYPE nParamIndex,
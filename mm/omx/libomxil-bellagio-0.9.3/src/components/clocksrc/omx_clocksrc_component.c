@@ -40,14 +40,13 @@ OMX_ERRORTYPE omx_clocksrc_component_Constructor(OMX_COMPONENTTYPE *openmaxStand
 	RM_RegisterComponent(CLOCK_COMP_NAME, MAX_CLOCK_COMPONENTS);
 
   if (!openmaxStandComp->pComponentPrivate) {
-    openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_clocksrc_component_PrivateType));
-    if(openmaxStandComp->pComponentPrivate==NULL) {
-      return OMX_ErrorInsufficientResources;
+    omxErr = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_clocksrc_component_PrivateType), 3, sizeof(omx_base_clock_PortType));
+    if (omxErr != OMX_ErrorNone) {
+      return omxErr;
     }
   }
 
   omx_clocksrc_component_Private = openmaxStandComp->pComponentPrivate;
-  omx_clocksrc_component_Private->ports = NULL;
 
   omxErr = omx_base_source_Constructor(openmaxStandComp,cComponentName);
   if (omxErr != OMX_ErrorNone) {
@@ -68,10 +67,12 @@ OMX_ERRORTYPE omx_clocksrc_component_Constructor(OMX_COMPONENTTYPE *openmaxStand
       if (!omx_clocksrc_component_Private->ports[i]) {
         return OMX_ErrorInsufficientResources;
       }
-      base_clock_port_Constructor(openmaxStandComp, &omx_clocksrc_component_Private->ports[i], i, OMX_FALSE);
-      omx_clocksrc_component_Private->ports[i]->FlushProcessingBuffers = clocksrc_port_FlushProcessingBuffers;
     }
   }
+  for (i=0; i < omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts; i++) {
+    base_clock_port_Constructor(openmaxStandComp, &omx_clocksrc_component_Private->ports[i], i, OMX_FALSE);
+    omx_clocksrc_component_Private->ports[i]->FlushProcessingBuffers = clocksrc_port_FlushProcessingBuffers;
+  }
 
 
   /* initializing the OMX_TIME_CONFIG_CLOCKSTATETYPE */
@@ -142,7 +143,7 @@ OMX_ERRORTYPE omx_clocksrc_component_Destructor(OMX_COMPONENTTYPE *openmaxStandC
       if(omx_clocksrc_component_Private->ports[i])
         omx_clocksrc_component_Private->ports[i]->PortDestructor(omx_clocksrc_component_Private->ports[i]);
     }
-    free(omx_clocksrc_component_Private->ports);
+    omx_base_component_FreeStorage(openmaxStandComp, omx_clocksrc_component_Private->ports);
     omx_clocksrc_component_Private->ports=NULL;
   }
 
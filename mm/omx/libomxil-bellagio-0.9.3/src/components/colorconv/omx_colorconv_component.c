@@ -0,0 +1,888 @@
+/**
+  src/components/colorconv/omx_colorconv_component.c
+
+  OpenMAX color converter component. This component implements a filter that
+  converts raw video frames between the YUV 4:2:0 and the RGB color formats
+  and scales them, spreading each frame on several threads.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <math.h>
+#include <unistd.h>
+#include <omxcore.h>
+#include <omx_base_video_port.h>
+#include <omx_colorconv_component.h>
+#include <OMX_Video.h>
+
+/** The color formats of the ports */
+static const OMX_COLOR_FORMATTYPE colorconvFormats[] = {
+  OMX_COLOR_FormatYUV420Planar,
+  OMX_COLOR_FormatYUV420PackedPlanar,
+  OMX_COLOR_FormatYUV420SemiPlanar,
+  OMX_COLOR_FormatYUV420PackedSemiPlanar,
+  OMX_COLOR_Format16bitRGB565,
+  OMX_COLOR_Format32bitARGB8888
+};
+
+#define COLORCONV_FORMATS (sizeof(colorconvFormats) / sizeof(colorconvFormats[0]))
+
+/** The bytes of a pixel in the rows of a format, of the luma for YUV, 0 for the formats not converted */
+static OMX_U32 colorconv_PixelBytes(OMX_COLOR_FORMATTYPE eColorFormat) {
+  switch (eColorFormat) {
+    case OMX_COLOR_FormatYUV420Planar:
+    case OMX_COLOR_FormatYUV420PackedPlanar:
+    case OMX_COLOR_FormatYUV420SemiPlanar:
+    case OMX_COLOR_FormatYUV420PackedSemiPlanar:
+      return 1;
+    case OMX_COLOR_Format16bitRGB565:
+      return 2;
+    case OMX_COLOR_Format32bitARGB8888:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+static OMX_BOOL colorconv_IsYuv(OMX_COLOR_FORMATTYPE eColorFormat) {
+  return colorconv_PixelBytes(eColorFormat) == 1 ? OMX_TRUE : OMX_FALSE;
+}
+
+/** Checks the frames of a port definition can be converted: even sizes, no bottom up rows */
+static OMX_ERRORTYPE colorconv_CheckVideoFormat(const OMX_VIDEO_PORTDEFINITIONTYPE* pVideo) {
+  OMX_U32 nPixelBytes = colorconv_PixelBytes(pVideo->eColorFormat);
+
+  if (nPixelBytes == 0 || pVideo->eCompressionFormat != OMX_VIDEO_CodingUnused) {
+    DEBUG(DEB_LEV_ERR, "In %s color format %x not converted\n", __func__, (int)pVideo->eColorFormat);
+    return OMX_ErrorUnsupportedSetting;
+  }
+  if (pVideo->nFrameWidth == 0 || pVideo->nFrameHeight == 0 ||
+      pVideo->nFrameWidth > COLORCONV_MAX_SIZE || pVideo->nFrameHeight > COLORCONV_MAX_SIZE ||
+      (pVideo->nFrameWidth & 1) || (pVideo->nFrameHeight & 1)) {
+    DEBUG(DEB_LEV_ERR, "In %s frame size %dx%d not converted\n", __func__, (int)pVideo->nFrameWidth, (int)pVideo->nFrameHeight);
+    return OMX_ErrorBadParameter;
+  }
+  if (pVideo->nStride < 0 || (pVideo->nStride > 0 && (OMX_U32)pVideo->nStride < pVideo->nFrameWidth * nPixelBytes) ||
+      (nPixelBytes == 1 && (pVideo->nStride & 1))) {
+    DEBUG(DEB_LEV_ERR, "In %s stride %d not converted\n", __func__, (int)pVideo->nStride);
+    return OMX_ErrorBadParameter;
+  }
+  if ((pVideo->nSliceHeight > 0 && pVideo->nSliceHeight < pVideo->nFrameHeight) || (nPixelBytes == 1 && (pVideo->nSliceHeight & 1))) {
+    DEBUG(DEB_LEV_ERR, "In %s slice height %d not converted\n", __func__, (int)pVideo->nSliceHeight);
+    return OMX_ErrorBadParameter;
+  }
+  return OMX_ErrorNone;
+}
+
+/** Derives the stride and the slice height of a port left to 0, and the size of its buffers */
+static void colorconv_UpdatePort(omx_base_video_PortType* pPort) {
+  OMX_VIDEO_PORTDEFINITIONTYPE* pVideo = &pPort->sPortParam.format.video;
+  OMX_U32 nSize;
+
+  if (pVideo->nStride == 0) {
+    pVideo->nStride = pVideo->nFrameWidth * colorconv_PixelBytes(pVideo->eColorFormat);
+  }
+  if (pVideo->nSliceHeight == 0) {
+    pVideo->nSliceHeight = pVideo->nFrameHeight;
+  }
+  nSize = (OMX_U32)pVideo->nStride * pVideo->nSliceHeight;
+  pPort->sPortParam.nBufferSize = colorconv_IsYuv(pVideo->eColorFormat) ? nSize * 3 / 2 : nSize;
+  pPort->sVideoParam.eColorFormat = pVideo->eColorFormat;
+}
+
+OMX_ERRORTYPE omx_colorconv_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+  OMX_ERRORTYPE err;
+  omx_colorconv_component_PrivateType* omx_colorconv_component_Private;
+  omx_base_video_PortType *pPort;
+  OMX_U32 i;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+  RM_RegisterComponent(COLORCONV_COMP_NAME, MAX_COLORCONV_COMPONENTS);
+  if (!openmaxStandComp->pComponentPrivate) {
+    err = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_colorconv_component_PrivateType), 2, sizeof(omx_base_video_PortType));
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+  } else {
+    DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+    return OMX_ErrorUndefined;
+  }
+
+  omx_colorconv_component_Private = openmaxStandComp->pComponentPrivate;
+
+  /** Calling base filter constructor */
+  err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+    return err;
+  }
+
+  omx_colorconv_component_Private->sPortTypesParam[OMX_PortDomainVideo].nStartPortNumber = 0;
+  omx_colorconv_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts = 2;
+
+  /** Allocate Ports and call port constructor. */
+  if (omx_colorconv_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts && !omx_colorconv_component_Private->ports) {
+    omx_colorconv_component_Private->ports = calloc(omx_colorconv_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts, sizeof(omx_base_PortType *));
+    if (!omx_colorconv_component_Private->ports) {
+      return OMX_ErrorInsufficientResources;
+    }
+    for (i=0; i < omx_colorconv_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts; i++) {
+      omx_colorconv_component_Private->ports[i] = calloc(1, sizeof(omx_base_video_PortType));
+      if (!omx_colorconv_component_Private->ports[i]) {
+        return OMX_ErrorInsufficientResources;
+      }
+    }
+  }
+
+  err = base_video_port_Constructor(openmaxStandComp, &omx_colorconv_component_Private->ports[0], 0, OMX_TRUE);
+  if (err != OMX_ErrorNone) {
+    return OMX_ErrorInsufficientResources;
+  }
+  err = base_video_port_Constructor(openmaxStandComp, &omx_colorconv_component_Private->ports[1], 1, OMX_FALSE);
+  if (err != OMX_ErrorNone) {
+    return OMX_ErrorInsufficientResources;
+  }
+
+  /** Domain specific section for the ports: QVGA, I420 in and ARGB out */
+  for (i = 0; i < 2; i++) {
+    pPort = (omx_base_video_PortType *) omx_colorconv_component_Private->ports[i];
+    pPort->sPortParam.format.video.nFrameWidth = 320;
+    pPort->sPortParam.format.video.nFrameHeight = 240;
+    pPort->sPortParam.format.video.eColorFormat = (i == OMX_BASE_FILTER_INPUTPORT_INDEX) ? OMX_COLOR_FormatYUV420Planar : OMX_COLOR_Format32bitARGB8888;
+    colorconv_UpdatePort(pPort);
+  }
+
+  pthread_mutex_init(&omx_colorconv_component_Private->poolMutex, NULL);
+  pthread_cond_init(&omx_colorconv_component_Private->workCond, NULL);
+  pthread_cond_init(&omx_colorconv_component_Private->doneCond, NULL);
+  omx_colorconv_component_Private->bRebuild = OMX_TRUE;
+
+  omx_colorconv_component_Private->pKernel = colorconv_SelectKernel(NULL);
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s using the %s kernel\n", __func__, omx_colorconv_component_Private->pKernel->sName);
+  omx_colorconv_component_Private->sKernelName = omx_colorconv_component_Private->pKernel->sName;
+
+  omx_colorconv_component_Private->destructor = omx_colorconv_component_Destructor;
+  omx_colorconv_component_Private->DoStateSet = omx_colorconv_component_DoStateSet;
+  openmaxStandComp->SetParameter = omx_colorconv_component_SetParameter;
+  openmaxStandComp->GetParameter = omx_colorconv_component_GetParameter;
+  omx_colorconv_component_Private->BufferMgmtCallback = omx_colorconv_component_BufferMgmtCallback;
+
+  /* resource management special section */
+  omx_colorconv_component_Private->nqualitylevels = COLORCONV_QUALITY_LEVELS;
+  omx_colorconv_component_Private->currentQualityLevel = 1;
+  omx_colorconv_component_Private->multiResourceLevel = malloc(sizeof(multiResourceDescriptor *) * COLORCONV_QUALITY_LEVELS);
+  for (i = 0; i<COLORCONV_QUALITY_LEVELS; i++) {
+    omx_colorconv_component_Private->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+    omx_colorconv_component_Private->multiResourceLevel[i]->CPUResourceRequested = colorconvQualityLevels[i * 2];
+    omx_colorconv_component_Private->multiResourceLevel[i]->MemoryResourceRequested = colorconvQualityLevels[i * 2 + 1];
+  }
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+static void colorconv_FreeScaler(colorconv_scaler_t* pScaler) {
+  free(pScaler->pVPos);
+  free(pScaler->pVCoef);
+  free(pScaler->pHPos);
+  free(pScaler->pHCoef);
+  memset(pScaler, 0, sizeof(colorconv_scaler_t));
+}
+
+static void colorconv_StopWorkers(omx_colorconv_component_PrivateType* omx_colorconv_component_Private);
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_colorconv_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_colorconv_component_PrivateType* omx_colorconv_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_U32 i;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+  if (omx_colorconv_component_Private->pKernel) {
+    colorconv_StopWorkers(omx_colorconv_component_Private);
+    pthread_mutex_destroy(&omx_colorconv_component_Private->poolMutex);
+    pthread_cond_destroy(&omx_colorconv_component_Private->workCond);
+    pthread_cond_destroy(&omx_colorconv_component_Private->doneCond);
+    omx_colorconv_component_Private->pKernel = NULL;
+  }
+  for (i = 0; i < COLORCONV_PLANES; i++) {
+    colorconv_FreeScaler(&omx_colorconv_component_Private->sScaler[i]);
+  }
+
+  /* frees port/s */
+  if (omx_colorconv_component_Private->ports) {
+    for (i=0; i < omx_colorconv_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts; i++) {
+      if(omx_colorconv_component_Private->ports[i]) {
+        omx_colorconv_component_Private->ports[i]->PortDestructor(omx_colorconv_component_Private->ports[i]);
+      }
+    }
+    omx_base_component_FreeStorage(openmaxStandComp, omx_colorconv_component_Private->ports);
+    omx_colorconv_component_Private->ports=NULL;
+  }
+
+  omx_base_filter_Destructor(openmaxStandComp);
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+/** The Keys cubic with a = -0.5, or the triangle of the bilinear filter */
+static float colorconv_Weight(float x, OMX_BOOL bBicubic) {
+  x = fabsf(x);
+  if (!bBicubic) {
+    return x < 1.0f ? 1.0f - x : 0.0f;
+  }
+  if (x < 1.0f) {
+    return (1.5f * x - 2.5f) * x * x + 1.0f;
+  }
+  if (x < 2.0f) {
+    return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+  }
+  return 0.0f;
+}
+
+/** Computes the taps of the filter scaling nSrc pixels to nDst ones, widened when
+ * scaling down so that every source pixel counts. The windows are kept inside the
+ * source, the taps falling out of it going to the pixel at the edge, and the
+ * coefficients of each output pixel add up to one exactly.
+ */
+static OMX_ERRORTYPE colorconv_BuildFilter(OMX_U32 nSrc, OMX_U32 nDst, OMX_BOOL bBicubic, OMX_U32 nAlign,
+  OMX_U32* pTaps, int32_t** ppPos, int16_t** ppCoef) {
+  float fRatio = (float) nSrc / nDst;
+  float fScale = fRatio > COLORCONV_MAX_DOWNSCALE ? COLORCONV_MAX_DOWNSCALE : (fRatio > 1.0f ? fRatio : 1.0f);
+  float fSupport = (bBicubic ? 2.0f : 1.0f) * fScale;
+  float fWeights[COLORCONV_MAX_TAPS];
+  float fCenter, fWeight, fSum;
+  OMX_U32 nTaps = 2 * (OMX_U32) ceilf(fSupport);
+  OMX_U32 nPadded = (nTaps + nAlign - 1) / nAlign * nAlign;
+  OMX_U32 x, t, nLargest;
+  int32_t nStart, nPos, nIndex, nTotal;
+  int16_t* pCoef;
+
+  *ppPos = malloc(nDst * sizeof(int32_t));
+  *ppCoef = calloc(nDst * nPadded, sizeof(int16_t));
+  if (!*ppPos || !*ppCoef) {
+    return OMX_ErrorInsufficientResources;
+  }
+  for (x = 0; x < nDst; x++) {
+    fCenter = (x + 0.5f) * fRatio - 0.5f;
+    nStart = (int32_t) floorf(fCenter - fSupport) + 1;
+    nPos = nStart;
+    if (nPos > (int32_t) nSrc - (int32_t) nTaps) {
+      nPos = (int32_t) nSrc - (int32_t) nTaps;
+    }
+    if (nPos < 0) {
+      nPos = 0;
+    }
+    memset(fWeights, 0, sizeof(fWeights));
+    fSum = 0.0f;
+    for (t = 0; t < nTaps; t++) {
+      nIndex = nStart + (int32_t) t;
+      nIndex = nIndex < 0 ? 0 : (nIndex >= (int32_t) nSrc ? (int32_t) nSrc - 1 : nIndex);
+      fWeight = colorconv_Weight((nStart + (int32_t) t - fCenter) / fScale, bBicubic);
+      fWeights[nIndex - nPos] += fWeight;
+      fSum += fWeight;
+    }
+    pCoef = *ppCoef + x * nPadded;
+    nTotal = 0;
+    nLargest = 0;
+    for (t = 0; t < nTaps; t++) {
+      pCoef[t] = (int16_t) lrintf(fWeights[t] / fSum * (1 << COLORCONV_COEF_BITS));
+      nTotal += pCoef[t];
+      if (pCoef[t] > pCoef[nLargest]) {
+        nLargest = t;
+      }
+    }
+    pCoef[nLargest] += (int16_t) ((1 << COLORCONV_COEF_BITS) - nTotal);
+    (*ppPos)[x] = nPos;
+  }
+  *pTaps = nPadded;
+  return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE colorconv_BuildScaler(colorconv_scaler_t* pScaler, OMX_U32 nSrcWidth, OMX_U32 nSrcHeight,
+  OMX_U32 nDstWidth, OMX_U32 nDstHeight, OMX_BOOL bBicubic) {
+  OMX_ERRORTYPE err;
+
+  colorconv_FreeScaler(pScaler);
+  pScaler->nSrcWidth = nSrcWidth;
+  pScaler->nSrcHeight = nSrcHeight;
+  pScaler->nDstWidth = nDstWidth;
+  pScaler->nDstHeight = nDstHeight;
+  pScaler->bScaled = (nSrcWidth != nDstWidth || nSrcHeight != nDstHeight) ? OMX_TRUE : OMX_FALSE;
+  if (!pScaler->bScaled) {
+    return OMX_ErrorNone;
+  }
+  /* the vertical kernels take the rows in pairs, the horizontal ones the taps four at once */
+  err = colorconv_BuildFilter(nSrcHeight, nDstHeight, bBicubic, 2, &pScaler->nVTaps, &pScaler->pVPos, &pScaler->pVCoef);
+  if (err == OMX_ErrorNone) {
+    err = colorconv_BuildFilter(nSrcWidth, nDstWidth, bBicubic, 4, &pScaler->nHTaps, &pScaler->pHPos, &pScaler->pHCoef);
+  }
+  return err;
+}
+
+static void colorconv_PortLayout(omx_base_video_PortType* pPort, colorconv_layout_t* pLayout) {
+  OMX_VIDEO_PORTDEFINITIONTYPE* pVideo = &pPort->sPortParam.format.video;
+
+  pLayout->eColorFormat = pVideo->eColorFormat;
+  pLayout->nWidth = pVideo->nFrameWidth;
+  pLayout->nHeight = pVideo->nFrameHeight;
+  pLayout->nStride = (OMX_U32)pVideo->nStride;
+  pLayout->nSliceHeight = pVideo->nSliceHeight;
+  pLayout->bYuv = colorconv_IsYuv(pVideo->eColorFormat);
+  pLayout->bSemiPlanar = (pVideo->eColorFormat == OMX_COLOR_FormatYUV420SemiPlanar ||
+                          pVideo->eColorFormat == OMX_COLOR_FormatYUV420PackedSemiPlanar) ? OMX_TRUE : OMX_FALSE;
+  pLayout->nFrameSize = pPort->sPortParam.nBufferSize;
+}
+
+/** Computes the layouts, the filters of the quality level and the rows of the threads */
+static OMX_ERRORTYPE colorconv_Rebuild(omx_colorconv_component_PrivateType* omx_colorconv_component_Private) {
+  colorconv_layout_t* pIn = &omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  colorconv_layout_t* pOut = &omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+  OMX_BOOL bBicubic = (omx_colorconv_component_Private->currentQualityLevel == 1) ? OMX_TRUE : OMX_FALSE;
+  colorconv_worker_t* pWorker;
+  OMX_ERRORTYPE err;
+  OMX_U32 i, k, p, nSub, nRow;
+  OMX_U8* pRows;
+
+  colorconv_PortLayout((omx_base_video_PortType *) omx_colorconv_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX], pIn);
+  colorconv_PortLayout((omx_base_video_PortType *) omx_colorconv_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX], pOut);
+
+  /* the planes are scaled in the color space of the input, the chroma of YUV at half the size */
+  for (p = 0; p < COLORCONV_PLANES; p++) {
+    nSub = (pIn->bYuv && p > 0) ? 2 : 1;
+    err = colorconv_BuildScaler(&omx_colorconv_component_Private->sScaler[p], pIn->nWidth / nSub, pIn->nHeight / nSub,
+      pOut->nWidth / nSub, pOut->nHeight / nSub, bBicubic);
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+  }
+
+  /* the rows of a plane, with room for the kernels reading past the width */
+  nRow = ((pIn->nWidth > pOut->nWidth ? pIn->nWidth : pOut->nWidth) + 64) & ~31;
+  for (i = 0; i < omx_colorconv_component_Private->nThreads; i++) {
+    pWorker = &omx_colorconv_component_Private->pWorkers[i];
+    free(pWorker->pScratch);
+    pWorker->pScratch = calloc(1, (nRow + 2 * COLORCONV_MAX_TAPS) * sizeof(int16_t) + (COLORCONV_MAX_TAPS + 2 * COLORCONV_PLANES) * nRow);
+    if (!pWorker->pScratch) {
+      return OMX_ErrorInsufficientResources;
+    }
+    pWorker->pTemp = (int16_t*) pWorker->pScratch;
+    pRows = pWorker->pScratch + (nRow + 2 * COLORCONV_MAX_TAPS) * sizeof(int16_t);
+    for (k = 0; k < COLORCONV_MAX_TAPS; k++) {
+      pWorker->ppSourceRows[k] = pRows;
+      pRows += nRow;
+    }
+    for (p = 0; p < COLORCONV_PLANES; p++) {
+      for (k = 0; k < 2; k++) {
+        pWorker->ppPlaneRows[p][k] = pRows;
+        pRows += nRow;
+      }
+    }
+  }
+
+  omx_colorconv_component_Private->nSlices = (pOut->nHeight / 2 + COLORCONV_SLICE_PAIRS - 1) / COLORCONV_SLICE_PAIRS;
+  omx_colorconv_component_Private->nFilterLevel = omx_colorconv_component_Private->currentQualityLevel;
+  omx_colorconv_component_Private->bRebuild = OMX_FALSE;
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s %dx%d to %dx%d with the %s filter on %d threads\n", __func__,
+    (int)pIn->nWidth, (int)pIn->nHeight, (int)pOut->nWidth, (int)pOut->nHeight, bBicubic ? "bicubic" : "bilinear",
+    (int)omx_colorconv_component_Private->nThreads);
+  return OMX_ErrorNone;
+}
+
+/** Returns a row of a plane of a frame, in place when its pixels are contiguous
+ * bytes, else gathered in pScratch. The RGB planes are R, G and B.
+ */
+static const OMX_U8* colorconv_SourceRow(const colorconv_layout_t* pLayout, const OMX_U8* pFrame,
+  OMX_U32 nPlane, OMX_U32 nRow, OMX_U32 nWidth, OMX_U8* pScratch) {
+  const OMX_U8* pRow;
+  uint32_t nWord;
+  uint16_t nPixel;
+  OMX_U32 x, v;
+
+  if (pLayout->bYuv) {
+    if (nPlane == 0) {
+      return pFrame + nRow * pLayout->nStride;
+    }
+    pRow = pFrame + pLayout->nStride * pLayout->nSliceHeight;
+    if (!pLayout->bSemiPlanar) {
+      if (nPlane == 2) {
+        pRow += (pLayout->nStride / 2) * (pLayout->nSliceHeight / 2);
+      }
+      return pRow + nRow * (pLayout->nStride / 2);
+    }
+    pRow += nRow * pLayout->nStride + nPlane - 1;
+    for (x = 0; x < nWidth; x++) {
+      pScratch[x] = pRow[2 * x];
+    }
+    return pScratch;
+  }
+
+  pRow = pFrame + nRow * pLayout->nStride;
+  if (pLayout->eColorFormat == OMX_COLOR_Format32bitARGB8888) {
+    for (x = 0; x < nWidth; x++) {
+      memcpy(&nWord, pRow + 4 * x, sizeof(nWord));
+      pScratch[x] = (OMX_U8) (nWord >> (16 - 8 * nPlane));
+    }
+  } else {
+    /* the 5 and 6 bit components are widened repeating their high bits */
+    for (x = 0; x < nWidth; x++) {
+      memcpy(&nPixel, pRow + 2 * x, sizeof(nPixel));
+      if (nPlane == 1) {
+        v = (nPixel >> 5) & 0x3f;
+        pScratch[x] = (OMX_U8) ((v << 2) | (v >> 4));
+      } else {
+        v = (nPlane == 0) ? (OMX_U32) (nPixel >> 11) : (OMX_U32) (nPixel & 0x1f);
+        pScratch[x] = (OMX_U8) ((v << 3) | (v >> 2));
+      }
+    }
+  }
+  return pScratch;
+}
+
+/** Returns a row of a plane at the output size, scaled into pDst if needed */
+static const OMX_U8* colorconv_PlaneRow(omx_colorconv_component_PrivateType* omx_colorconv_component_Private,
+  colorconv_worker_t* pWorker, OMX_U32 nPlane, OMX_U32 nRow, OMX_U8* pDst) {
+  const colorconv_layout_t* pIn = &omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  const colorconv_scaler_t* pScaler = &omx_colorconv_component_Private->sScaler[nPlane];
+  const colorconv_kernel_t* pKernel = omx_colorconv_component_Private->pKernel;
+  const OMX_U8* ppRows[COLORCONV_MAX_TAPS];
+  OMX_U32 t, nSrcRow;
+
+  if (!pScaler->bScaled) {
+    return colorconv_SourceRow(pIn, omx_colorconv_component_Private->pFrameIn, nPlane, nRow, pScaler->nSrcWidth, pDst);
+  }
+  for (t = 0; t < pScaler->nVTaps; t++) {
+    nSrcRow = pScaler->pVPos[nRow] + t;
+    if (nSrcRow >= pScaler->nSrcHeight) {
+      nSrcRow = pScaler->nSrcHeight - 1;
+    }
+    ppRows[t] = colorconv_SourceRow(pIn, omx_colorconv_component_Private->pFrameIn, nPlane, nSrcRow, pScaler->nSrcWidth, pWorker->ppSourceRows[t]);
+  }
+  pKernel->Vertical(pWorker->pTemp, ppRows, pScaler->pVCoef + nRow * pScaler->nVTaps, pScaler->nVTaps, pScaler->nSrcWidth);
+  pKernel->Horizontal(pDst, pWorker->pTemp, pScaler->pHPos, pScaler->pHCoef, pScaler->nHTaps, pScaler->nDstWidth);
+  return pDst;
+}
+
+/** Writes two rows of a YUV frame from the R, G and B rows, the chroma averaging 2x2 pixels */
+static void colorconv_RgbToYuvRows(const colorconv_layout_t* pLayout, OMX_U8* pFrame, OMX_U32 nPair,
+  const OMX_U8* ppRows[COLORCONV_PLANES][2]) {
+  OMX_U8* pY = pFrame + 2 * nPair * pLayout->nStride;
+  OMX_U8* pU;
+  OMX_U8* pV;
+  OMX_U32 nStep, x, k;
+  int32_t r, g, b;
+
+  for (k = 0; k < 2; k++) {
+    for (x = 0; x < pLayout->nWidth; x++) {
+      pY[k * pLayout->nStride + x] = (OMX_U8) (((66 * ppRows[0][k][x] + 129 * ppRows[1][k][x] + 25 * ppRows[2][k][x] + 128) >> 8) + 16);
+    }
+  }
+  pU = pFrame + pLayout->nStride * pLayout->nSliceHeight;
+  if (pLayout->bSemiPlanar) {
+    pU += nPair * pLayout->nStride;
+    pV = pU + 1;
+    nStep = 2;
+  } else {
+    pU += nPair * (pLayout->nStride / 2);
+    pV = pU + (pLayout->nStride / 2) * (pLayout->nSliceHeight / 2);
+    nStep = 1;
+  }
+  for (x = 0; x < pLayout->nWidth / 2; x++) {
+    r = (ppRows[0][0][2 * x] + ppRows[0][0][2 * x + 1] + ppRows[0][1][2 * x] + ppRows[0][1][2 * x + 1] + 2) >> 2;
+    g = (ppRows[1][0][2 * x] + ppRows[1][0][2 * x + 1] + ppRows[1][1][2 * x] + ppRows[1][1][2 * x + 1] + 2) >> 2;
+    b = (ppRows[2][0][2 * x] + ppRows[2][0][2 * x + 1] + ppRows[2][1][2 * x] + ppRows[2][1][2 * x + 1] + 2) >> 2;
+    pU[x * nStep] = (OMX_U8) (((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    pV[x * nStep] = (OMX_U8) (((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+  }
+}
+
+static void colorconv_PackRgbRow(const colorconv_layout_t* pLayout, OMX_U8* pOut, const OMX_U8* pR, const OMX_U8* pG, const OMX_U8* pB) {
+  uint32_t nWord;
+  uint16_t nPixel;
+  OMX_U32 x;
+
+  if (pLayout->eColorFormat == OMX_COLOR_Format32bitARGB8888) {
+    for (x = 0; x < pLayout->nWidth; x++) {
+      nWord = 0xff000000u | ((uint32_t) pR[x] << 16) | ((uint32_t) pG[x] << 8) | pB[x];
+      memcpy(pOut + 4 * x, &nWord, sizeof(nWord));
+    }
+  } else {
+    for (x = 0; x < pLayout->nWidth; x++) {
+      nPixel = (uint16_t) (((pR[x] & 0xf8) << 8) | ((pG[x] & 0xfc) << 3) | (pB[x] >> 3));
+      memcpy(pOut + 2 * x, &nPixel, sizeof(nPixel));
+    }
+  }
+}
+
+/** Converts the output rows 2 * nPair and 2 * nPair + 1, and the chroma row nPair of a YUV output */
+static void colorconv_ConvertRows(omx_colorconv_component_PrivateType* omx_colorconv_component_Private,
+  colorconv_worker_t* pWorker, OMX_U32 nPair) {
+  const colorconv_layout_t* pIn = &omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  const colorconv_layout_t* pOut = &omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+  const colorconv_kernel_t* pKernel = omx_colorconv_component_Private->pKernel;
+  OMX_U8* pFrame = omx_colorconv_component_Private->pFrameOut;
+  const OMX_U8* ppRows[COLORCONV_PLANES][2];
+  OMX_U8* pChroma;
+  OMX_U32 p, k, x;
+
+  for (p = 0; p < COLORCONV_PLANES; p++) {
+    if (pIn->bYuv && p > 0) {
+      ppRows[p][0] = ppRows[p][1] = colorconv_PlaneRow(omx_colorconv_component_Private, pWorker, p, nPair, pWorker->ppPlaneRows[p][0]);
+    } else {
+      for (k = 0; k < 2; k++) {
+        ppRows[p][k] = colorconv_PlaneRow(omx_colorconv_component_Private, pWorker, p, 2 * nPair + k, pWorker->ppPlaneRows[p][k]);
+      }
+    }
+  }
+
+  if (pIn->bYuv && pOut->bYuv) {
+    for (k = 0; k < 2; k++) {
+      memcpy(pFrame + (2 * nPair + k) * pOut->nStride, ppRows[0][k], pOut->nWidth);
+    }
+    pChroma = pFrame + pOut->nStride * pOut->nSliceHeight;
+    if (pOut->bSemiPlanar) {
+      pChroma += nPair * pOut->nStride;
+      for (x = 0; x < pOut->nWidth / 2; x++) {
+        pChroma[2 * x] = ppRows[1][0][x];
+        pChroma[2 * x + 1] = ppRows[2][0][x];
+      }
+    } else {
+      memcpy(pChroma + nPair * (pOut->nStride / 2), ppRows[1][0], pOut->nWidth / 2);
+      memcpy(pChroma + (pOut->nStride / 2) * (pOut->nSliceHeight / 2) + nPair * (pOut->nStride / 2), ppRows[2][0], pOut->nWidth / 2);
+    }
+  } else if (pIn->bYuv) {
+    for (k = 0; k < 2; k++) {
+      if (pOut->eColorFormat == OMX_COLOR_Format32bitARGB8888) {
+        pKernel->YuvToArgb(pFrame + (2 * nPair + k) * pOut->nStride, ppRows[0][k], ppRows[1][0], ppRows[2][0], pOut->nWidth);
+      } else {
+        pKernel->YuvToRgb565(pFrame + (2 * nPair + k) * pOut->nStride, ppRows[0][k], ppRows[1][0], ppRows[2][0], pOut->nWidth);
+      }
+    }
+  } else if (pOut->bYuv) {
+    colorconv_RgbToYuvRows(pOut, pFrame, nPair, ppRows);
+  } else {
+    for (k = 0; k < 2; k++) {
+      colorconv_PackRgbRow(pOut, pFrame + (2 * nPair + k) * pOut->nStride, ppRows[0][k], ppRows[1][k], ppRows[2][k]);
+    }
+  }
+}
+
+/** Converts the slices of the current frame nobody took yet */
+static void colorconv_RunSlices(omx_colorconv_component_PrivateType* omx_colorconv_component_Private, colorconv_worker_t* pWorker) {
+  OMX_U32 nPairs = omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_OUTPUTPORT_INDEX].nHeight / 2;
+  OMX_U32 nSlice, nPair, nLast;
+
+  while ((nSlice = __atomic_fetch_add(&omx_colorconv_component_Private->nNextSlice, 1, __ATOMIC_SEQ_CST)) < omx_colorconv_component_Private->nSlices) {
+    nLast = (nSlice + 1) * COLORCONV_SLICE_PAIRS;
+    if (nLast > nPairs) {
+      nLast = nPairs;
+    }
+    for (nPair = nSlice * COLORCONV_SLICE_PAIRS; nPair < nLast; nPair++) {
+      colorconv_ConvertRows(omx_colorconv_component_Private, pWorker, nPair);
+    }
+  }
+}
+
+static void* colorconv_WorkerThread(void* param) {
+  colorconv_worker_t* pWorker = (colorconv_worker_t*) param;
+  omx_colorconv_component_PrivateType* omx_colorconv_component_Private = pWorker->openmaxStandComp->pComponentPrivate;
+  OMX_U32 nSeen;
+
+  pthread_mutex_lock(&omx_colorconv_component_Private->poolMutex);
+  nSeen = omx_colorconv_component_Private->nGeneration;
+  while (1) {
+    while (!omx_colorconv_component_Private->bStopWorkers && omx_colorconv_component_Private->nGeneration == nSeen) {
+      pthread_cond_wait(&omx_colorconv_component_Private->workCond, &omx_colorconv_component_Private->poolMutex);
+    }
+    if (omx_colorconv_component_Private->bStopWorkers) {
+      break;
+    }
+    nSeen = omx_colorconv_component_Private->nGeneration;
+    pthread_mutex_unlock(&omx_colorconv_component_Private->poolMutex);
+
+    colorconv_RunSlices(omx_colorconv_component_Private, pWorker);
+
+    pthread_mutex_lock(&omx_colorconv_component_Private->poolMutex);
+    if (--omx_colorconv_component_Private->nActive == 0) {
+      pthread_cond_signal(&omx_colorconv_component_Private->doneCond);
+    }
+  }
+  pthread_mutex_unlock(&omx_colorconv_component_Private->poolMutex);
+  return NULL;
+}
+
+/** Starts the threads converting the frames with the caller of the buffer callback,
+ * as many as the processors online or as set in the environment
+ */
+static OMX_ERRORTYPE colorconv_StartWorkers(OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_colorconv_component_PrivateType* omx_colorconv_component_Private = openmaxStandComp->pComponentPrivate;
+  const char* sThreads = getenv(COLORCONV_THREADS_ENV);
+  long nThreads = sThreads ? atol(sThreads) : sysconf(_SC_NPROCESSORS_ONLN);
+  long i;
+
+  if (nThreads < 1) {
+    nThreads = 1;
+  } else if (nThreads > COLORCONV_MAX_THREADS) {
+    nThreads = COLORCONV_MAX_THREADS;
+  }
+  omx_colorconv_component_Private->pWorkers = calloc(nThreads, sizeof(colorconv_worker_t));
+  if (!omx_colorconv_component_Private->pWorkers) {
+    return OMX_ErrorInsufficientResources;
+  }
+  omx_colorconv_component_Private->bStopWorkers = OMX_FALSE;
+  omx_colorconv_component_Private->nActive = 0;
+  omx_colorconv_component_Private->pWorkers[0].openmaxStandComp = openmaxStandComp;
+  for (i = 1; i < nThreads; i++) {
+    omx_colorconv_component_Private->pWorkers[i].openmaxStandComp = openmaxStandComp;
+    if (pthread_create(&omx_colorconv_component_Private->pWorkers[i].thread, NULL, colorconv_WorkerThread, &omx_colorconv_component_Private->pWorkers[i])) {
+      DEBUG(DEB_LEV_ERR, "In %s converting on %d threads only\n", __func__, (int)i);
+      break;
+    }
+  }
+  omx_colorconv_component_Private->nThreads = i;
+  omx_colorconv_component_Private->bRebuild = OMX_TRUE;
+  return OMX_ErrorNone;
+}
+
+static void colorconv_StopWorkers(omx_colorconv_component_PrivateType* omx_colorconv_component_Private) {
+  OMX_U32 i;
+
+  if (!omx_colorconv_component_Private->pWorkers) {
+    return;
+  }
+  pthread_mutex_lock(&omx_colorconv_component_Private->poolMutex);
+  omx_colorconv_component_Private->bStopWorkers = OMX_TRUE;
+  pthread_cond_broadcast(&omx_colorconv_component_Private->workCond);
+  pthread_mutex_unlock(&omx_colorconv_component_Private->poolMutex);
+  for (i = 0; i < omx_colorconv_component_Private->nThreads; i++) {
+    if (i > 0) {
+      pthread_join(omx_colorconv_component_Private->pWorkers[i].thread, NULL);
+    }
+    free(omx_colorconv_component_Private->pWorkers[i].pScratch);
+  }
+  free(omx_colorconv_component_Private->pWorkers);
+  omx_colorconv_component_Private->pWorkers = NULL;
+  omx_colorconv_component_Private->nThreads = 0;
+}
+
+/** Converts a frame per buffer, the threads taking the slices of the output rows in turn */
+void omx_colorconv_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_colorconv_component_PrivateType* omx_colorconv_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err;
+
+  pOutputBuffer->nFilledLen = 0;
+  if (omx_colorconv_component_Private->bRebuild || omx_colorconv_component_Private->nFilterLevel != omx_colorconv_component_Private->currentQualityLevel) {
+    err = colorconv_Rebuild(omx_colorconv_component_Private);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "In %s dropping a frame, no memory for the filters\n", __func__);
+      omx_colorconv_component_Private->bRebuild = OMX_TRUE;
+      pInputBuffer->nFilledLen = 0;
+      return;
+    }
+  }
+  if (pInputBuffer->nFilledLen < omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_INPUTPORT_INDEX].nFrameSize ||
+      pOutputBuffer->nAllocLen < omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_OUTPUTPORT_INDEX].nFrameSize) {
+    DEBUG(DEB_LEV_ERR, "In %s dropping %d bytes, less than a frame or an output buffer too small\n", __func__, (int)pInputBuffer->nFilledLen);
+    pInputBuffer->nFilledLen = 0;
+    pInputBuffer->nOffset = 0;
+    return;
+  }
+
+  omx_colorconv_component_Private->pFrameIn = pInputBuffer->pBuffer + pInputBuffer->nOffset;
+  omx_colorconv_component_Private->pFrameOut = pOutputBuffer->pBuffer;
+  omx_colorconv_component_Private->nNextSlice = 0;
+  pthread_mutex_lock(&omx_colorconv_component_Private->poolMutex);
+  omx_colorconv_component_Private->nActive = omx_colorconv_component_Private->nThreads - 1;
+  omx_colorconv_component_Private->nGeneration++;
+  pthread_cond_broadcast(&omx_colorconv_component_Private->workCond);
+  pthread_mutex_unlock(&omx_colorconv_component_Private->poolMutex);
+
+  colorconv_RunSlices(omx_colorconv_component_Private, &omx_colorconv_component_Private->pWorkers[0]);
+
+  pthread_mutex_lock(&omx_colorconv_component_Private->poolMutex);
+  while (omx_colorconv_component_Private->nActive > 0) {
+    pthread_cond_wait(&omx_colorconv_component_Private->doneCond, &omx_colorconv_component_Private->poolMutex);
+  }
+  pthread_mutex_unlock(&omx_colorconv_component_Private->poolMutex);
+
+  pOutputBuffer->nFilledLen = omx_colorconv_component_Private->sLayout[OMX_BASE_FILTER_OUTPUTPORT_INDEX].nFrameSize;
+  pInputBuffer->nFilledLen = 0;
+  pInputBuffer->nOffset = 0;
+}
+
+/** The threads run from Idle to Loaded */
+OMX_ERRORTYPE omx_colorconv_component_DoStateSet(OMX_COMPONENTTYPE *openmaxStandComp, OMX_U32 destinationState) {
+  omx_colorconv_component_PrivateType* omx_colorconv_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_STATETYPE eState = omx_colorconv_component_Private->state;
+  OMX_ERRORTYPE err;
+
+  err = omx_base_component_DoStateSet(openmaxStandComp, destinationState);
+  if (err != OMX_ErrorNone) {
+    return err;
+  }
+  if (eState == OMX_StateLoaded && destinationState == OMX_StateIdle) {
+    err = colorconv_StartWorkers(openmaxStandComp);
+  } else if (destinationState == OMX_StateLoaded || destinationState == OMX_StateInvalid) {
+    colorconv_StopWorkers(omx_colorconv_component_Private);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_colorconv_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_PARAM_PORTDEFINITIONTYPE *pPortDef;
+  OMX_VIDEO_PARAM_PORTFORMATTYPE *pVideoPortFormat;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_U32 portIndex;
+  omx_base_video_PortType *port;
+
+  /* Check which structure we are being fed and make control its header */
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_colorconv_component_PrivateType* omx_colorconv_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch(nParamIndex) {
+    case OMX_IndexParamPortDefinition:
+      pPortDef = (OMX_PARAM_PORTDEFINITIONTYPE*) ComponentParameterStructure;
+      portIndex = pPortDef->nPortIndex;
+      if ((err = checkHeader(pPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (portIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      if ((err = colorconv_CheckVideoFormat(&pPortDef->format.video)) != OMX_ErrorNone) {
+        break;
+      }
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+      if (err != OMX_ErrorNone) {
+        break;
+      }
+      port = (omx_base_video_PortType *) omx_colorconv_component_Private->ports[portIndex];
+      port->sPortParam.format.video.nSliceHeight = pPortDef->format.video.nSliceHeight;
+      colorconv_UpdatePort(port);
+      omx_colorconv_component_Private->bRebuild = OMX_TRUE;
+      break;
+    case OMX_IndexParamVideoPortFormat:
+      pVideoPortFormat = (OMX_VIDEO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      portIndex = pVideoPortFormat->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pVideoPortFormat, sizeof(OMX_VIDEO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      if (pVideoPortFormat->eCompressionFormat != OMX_VIDEO_CodingUnused || colorconv_PixelBytes(pVideoPortFormat->eColorFormat) == 0) {
+        return OMX_ErrorUnsupportedSetting;
+      }
+      /* the stride of the previous format is derived again */
+      port = (omx_base_video_PortType *) omx_colorconv_component_Private->ports[portIndex];
+      port->sVideoParam.xFramerate = pVideoPortFormat->xFramerate;
+      port->sPortParam.format.video.xFramerate = pVideoPortFormat->xFramerate;
+      port->sPortParam.format.video.eColorFormat = pVideoPortFormat->eColorFormat;
+      port->sPortParam.format.video.nStride = 0;
+      colorconv_UpdatePort(port);
+      omx_colorconv_component_Private->bRebuild = OMX_TRUE;
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_colorconv_component_Private->state != OMX_StateLoaded && omx_colorconv_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_colorconv_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, COLORCONV_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_colorconv_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_VIDEO_PARAM_PORTFORMATTYPE *pVideoPortFormat;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_video_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_colorconv_component_PrivateType* omx_colorconv_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch(nParamIndex) {
+    case OMX_IndexParamVideoInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_colorconv_component_Private->sPortTypesParam[OMX_PortDomainVideo], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamVideoPortFormat:
+      /* nIndex enumerates the color formats converted */
+      pVideoPortFormat = (OMX_VIDEO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_VIDEO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pVideoPortFormat->nPortIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      if (pVideoPortFormat->nIndex >= COLORCONV_FORMATS) {
+        return OMX_ErrorNoMore;
+      }
+      port = (omx_base_video_PortType *) omx_colorconv_component_Private->ports[pVideoPortFormat->nPortIndex];
+      pVideoPortFormat->eCompressionFormat = OMX_VIDEO_CodingUnused;
+      pVideoPortFormat->eColorFormat = colorconvFormats[pVideoPortFormat->nIndex];
+      pVideoPortFormat->xFramerate = port->sVideoParam.xFramerate;
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, COLORCONV_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
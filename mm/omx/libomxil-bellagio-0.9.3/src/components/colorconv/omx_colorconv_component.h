@@ -0,0 +1,195 @@
+/**
+  src/components/colorconv/omx_colorconv_component.h
+
+  OpenMAX color converter component. This component implements a filter that
+  converts raw video frames between the YUV 4:2:0 and the RGB color formats
+  and scales them, spreading each frame on several threads.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_COLORCONV_COMPONENT_H_
+#define _OMX_COLORCONV_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <OMX_Video.h>
+#include <pthread.h>
+#include <string.h>
+#include <omx_base_filter.h>
+#include "omx_colorconv_kernel.h"
+
+#define COLORCONV_COMP_NAME "OMX.st.video.colorconv"
+#define COLORCONV_COMP_ROLE "video.colorconv"
+#define MAX_COLORCONV_COMPONENTS 10
+
+/** The environment variable setting the threads converting a frame, the calling one included */
+#define COLORCONV_THREADS_ENV "OMX_BELLAGIO_COLORCONV_THREADS"
+#define COLORCONV_MAX_THREADS 16
+
+/** Largest frame width or height of a port */
+#define COLORCONV_MAX_SIZE 8192
+
+/** Largest scale down factor filtered, a larger one leaving out source pixels */
+#define COLORCONV_MAX_DOWNSCALE 8
+
+/** Largest taps of a filter, the bicubic one at the largest scale down factor */
+#define COLORCONV_MAX_TAPS (4 * COLORCONV_MAX_DOWNSCALE)
+
+/** Pairs of output rows converted by a thread at once */
+#define COLORCONV_SLICE_PAIRS 8
+
+/** The planes scaled: Y, U and V of a YUV input or R, G and B of an RGB one */
+#define COLORCONV_PLANES 3
+
+/** Color converter component resources, level 1 scaling with the bicubic filter and level 2 with the bilinear one */
+#define COLORCONV_QUALITY_LEVELS 2
+static int colorconvQualityLevels []={60, 1048576, 30, 1048576};
+
+/** The layout of the frames of a port.
+ * @param eColorFormat the color format
+ * @param nWidth the frame width
+ * @param nHeight the frame height
+ * @param nStride the bytes between two rows
+ * @param nSliceHeight the rows of the luma plane, the chroma planes following them
+ * @param bYuv the frames are YUV 4:2:0 rather than RGB
+ * @param bSemiPlanar the chroma is interleaved in one plane
+ * @param nFrameSize the bytes of a frame
+ */
+typedef struct colorconv_layout_t {
+  OMX_COLOR_FORMATTYPE eColorFormat;
+  OMX_U32 nWidth;
+  OMX_U32 nHeight;
+  OMX_U32 nStride;
+  OMX_U32 nSliceHeight;
+  OMX_BOOL bYuv;
+  OMX_BOOL bSemiPlanar;
+  OMX_U32 nFrameSize;
+} colorconv_layout_t;
+
+/** The filters scaling a plane, the rows first and then the columns.
+ * @param bScaled the plane changes size, else its rows are copied
+ * @param nSrcWidth the width of the plane in the input
+ * @param nSrcHeight the height of the plane in the input
+ * @param nDstWidth the width of the plane in the output
+ * @param nDstHeight the height of the plane in the output
+ * @param nVTaps the taps of the vertical filter, even
+ * @param pVPos the first source row of each output row
+ * @param pVCoef the nVTaps coefficients of each output row
+ * @param nHTaps the taps of the horizontal filter, a multiple of 4
+ * @param pHPos the first source column of each output column
+ * @param pHCoef the nHTaps coefficients of each output column
+ */
+typedef struct colorconv_scaler_t {
+  OMX_BOOL bScaled;
+  OMX_U32 nSrcWidth;
+  OMX_U32 nSrcHeight;
+  OMX_U32 nDstWidth;
+  OMX_U32 nDstHeight;
+  OMX_U32 nVTaps;
+  int32_t* pVPos;
+  int16_t* pVCoef;
+  OMX_U32 nHTaps;
+  int32_t* pHPos;
+  int16_t* pHCoef;
+} colorconv_scaler_t;
+
+/** A thread converting slices of the frames and its rows.
+ * @param thread the thread, none for the first one which is the caller of the buffer callback
+ * @param openmaxStandComp the component
+ * @param pScratch the memory of the rows
+ * @param ppSourceRows the source rows of the taps of the vertical filter
+ * @param pTemp the plane row filtered vertically
+ * @param ppPlaneRows the two rows of each plane at the output size
+ */
+typedef struct colorconv_worker_t {
+  pthread_t thread;
+  OMX_COMPONENTTYPE* openmaxStandComp;
+  OMX_U8* pScratch;
+  OMX_U8* ppSourceRows[COLORCONV_MAX_TAPS];
+  int16_t* pTemp;
+  OMX_U8* ppPlaneRows[COLORCONV_PLANES][2];
+} colorconv_worker_t;
+
+/** Color converter component private structure.
+ * @param sLayout the frame layouts of the input and output ports
+ * @param bRebuild the ports changed since the filters were computed
+ * @param nFilterLevel the quality level the filters were computed for
+ * @param sScaler the filters of each plane
+ * @param pKernel the row kernels used
+ * @param pWorkers the threads converting the frames, nThreads of them
+ * @param nThreads the threads converting the frames, the caller of the buffer callback included
+ * @param poolMutex protects the fields below
+ * @param workCond signalled when a frame is to be converted or the threads are to stop
+ * @param doneCond signalled when the last thread is done with a frame
+ * @param nGeneration counts the frames handed to the threads
+ * @param nActive the threads still converting the current frame
+ * @param bStopWorkers the threads are to exit
+ * @param pFrameIn the input frame converted
+ * @param pFrameOut the output frame written
+ * @param nSlices the slices of the output frame
+ * @param nNextSlice the first slice nobody took yet
+ */
+DERIVEDCLASS(omx_colorconv_component_PrivateType, omx_base_filter_PrivateType)
+#define omx_colorconv_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
+  colorconv_layout_t sLayout[2]; \
+  OMX_BOOL bRebuild; \
+  OMX_U32 nFilterLevel; \
+  colorconv_scaler_t sScaler[COLORCONV_PLANES]; \
+  const colorconv_kernel_t* pKernel; \
+  colorconv_worker_t* pWorkers; \
+  OMX_U32 nThreads; \
+  pthread_mutex_t poolMutex; \
+  pthread_cond_t workCond; \
+  pthread_cond_t doneCond; \
+  OMX_U32 nGeneration; \
+  OMX_U32 nActive; \
+  OMX_BOOL bStopWorkers; \
+  const OMX_U8* pFrameIn; \
+  OMX_U8* pFrameOut; \
+  OMX_U32 nSlices; \
+  OMX_U32 nNextSlice;
+ENDCLASS(omx_colorconv_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_colorconv_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_colorconv_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_colorconv_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* inputbuffer,
+  OMX_BUFFERHEADERTYPE* outputbuffer);
+
+OMX_ERRORTYPE omx_colorconv_component_DoStateSet(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_U32 destinationState);
+
+OMX_ERRORTYPE omx_colorconv_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_colorconv_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+#endif
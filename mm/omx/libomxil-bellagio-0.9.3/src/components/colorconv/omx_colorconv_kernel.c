@@ -0,0 +1,540 @@
+/**
+  src/components/colorconv/omx_colorconv_kernel.c
+
+  Scalar, SSE2, AVX2 and NEON row kernels of the color converter. All of them
+  compute in integers with the same roundings, so that they give the same
+  pixels.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <omxcore.h>
+#include "omx_colorconv_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define COLORCONV_HAVE_SSE
+#define COLORCONV_HAVE_AVX2
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define COLORCONV_HAVE_NEON
+#endif
+
+/** Shift of the vertical pass, from the coefficients to the rows */
+#define VERTICAL_SHIFT (COLORCONV_COEF_BITS - COLORCONV_ROW_BITS)
+
+/** Shift of the horizontal pass, from the rows times the coefficients to the pixels */
+#define HORIZONTAL_SHIFT (COLORCONV_COEF_BITS + COLORCONV_ROW_BITS)
+
+static void colorconv_VerticalPixels(int16_t* pOut, const OMX_U8* const* ppRows, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 x, OMX_U32 nWidth) {
+  int32_t sum;
+  OMX_U32 t;
+
+  for (; x < nWidth; x++) {
+    sum = 1 << (VERTICAL_SHIFT - 1);
+    for (t = 0; t < nTaps; t++) {
+      sum += pCoef[t] * ppRows[t][x];
+    }
+    pOut[x] = (int16_t) (sum >> VERTICAL_SHIFT);
+  }
+}
+
+static void colorconv_HorizontalPixels(OMX_U8* pOut, const int16_t* pIn, const int32_t* pPos, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 x, OMX_U32 nWidth) {
+  const int16_t* pTaps;
+  const int16_t* pCoefs;
+  int32_t sum;
+  OMX_U32 t;
+
+  for (; x < nWidth; x++) {
+    pTaps = pIn + pPos[x];
+    pCoefs = pCoef + x * nTaps;
+    sum = 1 << (HORIZONTAL_SHIFT - 1);
+    for (t = 0; t < nTaps; t++) {
+      sum += pCoefs[t] * pTaps[t];
+    }
+    sum >>= HORIZONTAL_SHIFT;
+    pOut[x] = (OMX_U8) (sum < 0 ? 0 : (sum > 255 ? 255 : sum));
+  }
+}
+
+static inline OMX_U8 colorconv_Clamp(int32_t v) {
+  return (OMX_U8) (v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+static void colorconv_YuvToArgbPixels(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV,
+  OMX_U32 x, OMX_U32 nWidth) {
+  int32_t c, d, e;
+  uint32_t nPixel;
+
+  for (; x < nWidth; x++) {
+    c = pY[x] - 16;
+    d = pU[x / 2] - 128;
+    e = pV[x / 2] - 128;
+    nPixel = 0xff000000u |
+      ((uint32_t) colorconv_Clamp((298 * c + 409 * e + 128) >> 8) << 16) |
+      ((uint32_t) colorconv_Clamp((298 * c - 100 * d - 208 * e + 128) >> 8) << 8) |
+      (uint32_t) colorconv_Clamp((298 * c + 516 * d + 128) >> 8);
+    memcpy(pOut + x * 4, &nPixel, sizeof(nPixel));
+  }
+}
+
+static void colorconv_YuvToRgb565Pixels(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV,
+  OMX_U32 x, OMX_U32 nWidth) {
+  int32_t c, d, e;
+  uint16_t nPixel;
+
+  for (; x < nWidth; x++) {
+    c = pY[x] - 16;
+    d = pU[x / 2] - 128;
+    e = pV[x / 2] - 128;
+    nPixel = (uint16_t) (((colorconv_Clamp((298 * c + 409 * e + 128) >> 8) & 0xf8) << 8) |
+      ((colorconv_Clamp((298 * c - 100 * d - 208 * e + 128) >> 8) & 0xfc) << 3) |
+      (colorconv_Clamp((298 * c + 516 * d + 128) >> 8) >> 3));
+    memcpy(pOut + x * 2, &nPixel, sizeof(nPixel));
+  }
+}
+
+static void colorconv_VerticalScalar(int16_t* pOut, const OMX_U8* const* ppRows, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth) {
+  colorconv_VerticalPixels(pOut, ppRows, pCoef, nTaps, 0, nWidth);
+}
+
+static void colorconv_HorizontalScalar(OMX_U8* pOut, const int16_t* pIn, const int32_t* pPos, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth) {
+  colorconv_HorizontalPixels(pOut, pIn, pPos, pCoef, nTaps, 0, nWidth);
+}
+
+static void colorconv_YuvToArgbScalar(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth) {
+  colorconv_YuvToArgbPixels(pOut, pY, pU, pV, 0, nWidth);
+}
+
+static void colorconv_YuvToRgb565Scalar(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth) {
+  colorconv_YuvToRgb565Pixels(pOut, pY, pU, pV, 0, nWidth);
+}
+
+#ifdef COLORCONV_HAVE_SSE
+/** Two 16 bit coefficients for _mm_madd_epi16, lo multiplying the even elements */
+#define COLORCONV_PAIR(lo, hi) ((int32_t) (((uint32_t) (uint16_t) (hi) << 16) | (uint16_t) (lo)))
+
+static void colorconv_VerticalSSE(int16_t* pOut, const OMX_U8* const* ppRows, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi32(1 << (VERTICAL_SHIFT - 1));
+  __m128i acc0, acc1, acc2, acc3, coef, lo, hi;
+  OMX_U32 x = 0, t;
+
+  for (; x + 16 <= nWidth; x += 16) {
+    acc0 = acc1 = acc2 = acc3 = round;
+    /* the pixels of two rows are interleaved, and multiplied by their two coefficients at once */
+    for (t = 0; t < nTaps; t += 2) {
+      coef = _mm_set1_epi32(COLORCONV_PAIR(pCoef[t], pCoef[t + 1]));
+      lo = _mm_loadu_si128((const __m128i*) (ppRows[t] + x));
+      hi = _mm_loadu_si128((const __m128i*) (ppRows[t + 1] + x));
+      acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(lo, hi), zero), coef));
+      acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(_mm_unpacklo_epi8(lo, hi), zero), coef));
+      acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(_mm_unpackhi_epi8(lo, hi), zero), coef));
+      acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(_mm_unpackhi_epi8(lo, hi), zero), coef));
+    }
+    _mm_storeu_si128((__m128i*) (pOut + x),
+      _mm_packs_epi32(_mm_srai_epi32(acc0, VERTICAL_SHIFT), _mm_srai_epi32(acc1, VERTICAL_SHIFT)));
+    _mm_storeu_si128((__m128i*) (pOut + x + 8),
+      _mm_packs_epi32(_mm_srai_epi32(acc2, VERTICAL_SHIFT), _mm_srai_epi32(acc3, VERTICAL_SHIFT)));
+  }
+  colorconv_VerticalPixels(pOut, ppRows, pCoef, nTaps, x, nWidth);
+}
+
+static void colorconv_HorizontalSSE(OMX_U8* pOut, const int16_t* pIn, const int32_t* pPos, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth) {
+  const __m128i round = _mm_set1_epi32(1 << (HORIZONTAL_SHIFT - 1));
+  const int16_t* pCoefs;
+  __m128i acc01, acc23, sum;
+  OMX_U32 x = 0, t;
+  int32_t nPixels;
+
+  /* four pixels at once, four taps of two pixels in each multiplication */
+  for (; x + 4 <= nWidth; x += 4) {
+    pCoefs = pCoef + x * nTaps;
+    acc01 = acc23 = _mm_setzero_si128();
+    for (t = 0; t < nTaps; t += 4) {
+      acc01 = _mm_add_epi32(acc01, _mm_madd_epi16(
+        _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*) (pIn + pPos[x] + t)),
+                           _mm_loadl_epi64((const __m128i*) (pIn + pPos[x + 1] + t))),
+        _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*) (pCoefs + t)),
+                           _mm_loadl_epi64((const __m128i*) (pCoefs + nTaps + t)))));
+      acc23 = _mm_add_epi32(acc23, _mm_madd_epi16(
+        _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*) (pIn + pPos[x + 2] + t)),
+                           _mm_loadl_epi64((const __m128i*) (pIn + pPos[x + 3] + t))),
+        _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*) (pCoefs + 2 * nTaps + t)),
+                           _mm_loadl_epi64((const __m128i*) (pCoefs + 3 * nTaps + t)))));
+    }
+    /* each pixel has two partial sums side by side */
+    sum = _mm_add_epi32(
+      _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(acc01), _mm_castsi128_ps(acc23), _MM_SHUFFLE(2, 0, 2, 0))),
+      _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(acc01), _mm_castsi128_ps(acc23), _MM_SHUFFLE(3, 1, 3, 1))));
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, round), HORIZONTAL_SHIFT);
+    sum = _mm_packs_epi32(sum, sum);
+    nPixels = _mm_cvtsi128_si32(_mm_packus_epi16(sum, sum));
+    memcpy(pOut + x, &nPixels, sizeof(nPixels));
+  }
+  colorconv_HorizontalPixels(pOut, pIn, pPos, pCoef, nTaps, x, nWidth);
+}
+
+/** Computes the R, G and B of 8 pixels from c = Y - 16, d = U - 128 and e = V - 128 */
+static inline void colorconv_YuvToRgbSSE(__m128i c, __m128i d, __m128i e, __m128i* pR, __m128i* pG, __m128i* pB) {
+  const __m128i round = _mm_set1_epi32(128);
+  const __m128i one = _mm_set1_epi16(1);
+  const __m128i kR = _mm_set1_epi32(COLORCONV_PAIR(298, 409));
+  const __m128i kG = _mm_set1_epi32(COLORCONV_PAIR(298, -208));
+  const __m128i kGd = _mm_set1_epi32(COLORCONV_PAIR(-100, 128));
+  const __m128i kB = _mm_set1_epi32(COLORCONV_PAIR(298, 516));
+  __m128i ceLo = _mm_unpacklo_epi16(c, e), ceHi = _mm_unpackhi_epi16(c, e);
+  __m128i cdLo = _mm_unpacklo_epi16(c, d), cdHi = _mm_unpackhi_epi16(c, d);
+  /* the rounding of G comes with d, multiplied by one */
+  __m128i d1Lo = _mm_unpacklo_epi16(d, one), d1Hi = _mm_unpackhi_epi16(d, one);
+
+  *pR = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, kR), round), 8),
+                        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, kR), round), 8));
+  *pG = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, kG), _mm_madd_epi16(d1Lo, kGd)), 8),
+                        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, kG), _mm_madd_epi16(d1Hi, kGd)), 8));
+  *pB = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, kB), round), 8),
+                        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, kB), round), 8));
+}
+
+/** Computes the R, G and B bytes of 16 pixels */
+static inline void colorconv_YuvRowSSE(const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 x,
+  __m128i* pR, __m128i* pG, __m128i* pB) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i k16 = _mm_set1_epi16(16);
+  const __m128i k128 = _mm_set1_epi16(128);
+  __m128i y = _mm_loadu_si128((const __m128i*) (pY + x));
+  __m128i u = _mm_loadl_epi64((const __m128i*) (pU + x / 2));
+  __m128i v = _mm_loadl_epi64((const __m128i*) (pV + x / 2));
+  __m128i r0, g0, b0, r1, g1, b1;
+
+  /* each chroma sample covers two pixels */
+  u = _mm_unpacklo_epi8(u, u);
+  v = _mm_unpacklo_epi8(v, v);
+  colorconv_YuvToRgbSSE(_mm_sub_epi16(_mm_unpacklo_epi8(y, zero), k16), _mm_sub_epi16(_mm_unpacklo_epi8(u, zero), k128),
+    _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), k128), &r0, &g0, &b0);
+  colorconv_YuvToRgbSSE(_mm_sub_epi16(_mm_unpackhi_epi8(y, zero), k16), _mm_sub_epi16(_mm_unpackhi_epi8(u, zero), k128),
+    _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), k128), &r1, &g1, &b1);
+  *pR = _mm_packus_epi16(r0, r1);
+  *pG = _mm_packus_epi16(g0, g1);
+  *pB = _mm_packus_epi16(b0, b1);
+}
+
+static void colorconv_YuvToArgbSSE(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth) {
+  const __m128i alpha = _mm_set1_epi8((char) 0xff);
+  __m128i r, g, b, bgLo, bgHi, raLo, raHi;
+  OMX_U32 x = 0;
+
+  for (; x + 16 <= nWidth; x += 16) {
+    colorconv_YuvRowSSE(pY, pU, pV, x, &r, &g, &b);
+    bgLo = _mm_unpacklo_epi8(b, g);
+    bgHi = _mm_unpackhi_epi8(b, g);
+    raLo = _mm_unpacklo_epi8(r, alpha);
+    raHi = _mm_unpackhi_epi8(r, alpha);
+    _mm_storeu_si128((__m128i*) (pOut + x * 4), _mm_unpacklo_epi16(bgLo, raLo));
+    _mm_storeu_si128((__m128i*) (pOut + x * 4 + 16), _mm_unpackhi_epi16(bgLo, raLo));
+    _mm_storeu_si128((__m128i*) (pOut + x * 4 + 32), _mm_unpacklo_epi16(bgHi, raHi));
+    _mm_storeu_si128((__m128i*) (pOut + x * 4 + 48), _mm_unpackhi_epi16(bgHi, raHi));
+  }
+  colorconv_YuvToArgbPixels(pOut, pY, pU, pV, x, nWidth);
+}
+
+static inline __m128i colorconv_Rgb565SSE(__m128i r, __m128i g, __m128i b) {
+  return _mm_or_si128(_mm_or_si128(_mm_slli_epi16(_mm_and_si128(r, _mm_set1_epi16(0xf8)), 8),
+                                   _mm_slli_epi16(_mm_and_si128(g, _mm_set1_epi16(0xfc)), 3)),
+                      _mm_srli_epi16(b, 3));
+}
+
+static void colorconv_YuvToRgb565SSE(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth) {
+  const __m128i zero = _mm_setzero_si128();
+  __m128i r, g, b;
+  OMX_U32 x = 0;
+
+  for (; x + 16 <= nWidth; x += 16) {
+    colorconv_YuvRowSSE(pY, pU, pV, x, &r, &g, &b);
+    _mm_storeu_si128((__m128i*) (pOut + x * 2),
+      colorconv_Rgb565SSE(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero), _mm_unpacklo_epi8(b, zero)));
+    _mm_storeu_si128((__m128i*) (pOut + x * 2 + 16),
+      colorconv_Rgb565SSE(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero), _mm_unpackhi_epi8(b, zero)));
+  }
+  colorconv_YuvToRgb565Pixels(pOut, pY, pU, pV, x, nWidth);
+}
+#endif
+
+#ifdef COLORCONV_HAVE_AVX2
+/* The 256 bit unpacks and packs work in each 128 bit lane, so the pixels of a
+ * vector are in the order 0-7 16-23 or 8-15 24-31 between them, and are put
+ * back in order with _mm256_permute2x128_si256 before being stored.
+ */
+__attribute__((target("avx2")))
+static void colorconv_VerticalAVX2(int16_t* pOut, const OMX_U8* const* ppRows, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i round = _mm256_set1_epi32(1 << (VERTICAL_SHIFT - 1));
+  __m256i acc0, acc1, acc2, acc3, coef, lo, hi, out0, out1;
+  OMX_U32 x = 0, t;
+
+  for (; x + 32 <= nWidth; x += 32) {
+    acc0 = acc1 = acc2 = acc3 = round;
+    for (t = 0; t < nTaps; t += 2) {
+      coef = _mm256_set1_epi32(COLORCONV_PAIR(pCoef[t], pCoef[t + 1]));
+      lo = _mm256_loadu_si256((const __m256i*) (ppRows[t] + x));
+      hi = _mm256_loadu_si256((const __m256i*) (ppRows[t + 1] + x));
+      acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi8(_mm256_unpacklo_epi8(lo, hi), zero), coef));
+      acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi8(_mm256_unpacklo_epi8(lo, hi), zero), coef));
+      acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi8(_mm256_unpackhi_epi8(lo, hi), zero), coef));
+      acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi8(_mm256_unpackhi_epi8(lo, hi), zero), coef));
+    }
+    out0 = _mm256_packs_epi32(_mm256_srai_epi32(acc0, VERTICAL_SHIFT), _mm256_srai_epi32(acc1, VERTICAL_SHIFT));
+    out1 = _mm256_packs_epi32(_mm256_srai_epi32(acc2, VERTICAL_SHIFT), _mm256_srai_epi32(acc3, VERTICAL_SHIFT));
+    _mm256_storeu_si256((__m256i*) (pOut + x), _mm256_permute2x128_si256(out0, out1, 0x20));
+    _mm256_storeu_si256((__m256i*) (pOut + x + 16), _mm256_permute2x128_si256(out0, out1, 0x31));
+  }
+  colorconv_VerticalPixels(pOut, ppRows, pCoef, nTaps, x, nWidth);
+}
+
+__attribute__((target("avx2")))
+static inline void colorconv_YuvToRgbAVX2(__m256i c, __m256i d, __m256i e, __m256i* pR, __m256i* pG, __m256i* pB) {
+  const __m256i round = _mm256_set1_epi32(128);
+  const __m256i one = _mm256_set1_epi16(1);
+  const __m256i kR = _mm256_set1_epi32(COLORCONV_PAIR(298, 409));
+  const __m256i kG = _mm256_set1_epi32(COLORCONV_PAIR(298, -208));
+  const __m256i kGd = _mm256_set1_epi32(COLORCONV_PAIR(-100, 128));
+  const __m256i kB = _mm256_set1_epi32(COLORCONV_PAIR(298, 516));
+  __m256i ceLo = _mm256_unpacklo_epi16(c, e), ceHi = _mm256_unpackhi_epi16(c, e);
+  __m256i cdLo = _mm256_unpacklo_epi16(c, d), cdHi = _mm256_unpackhi_epi16(c, d);
+  __m256i d1Lo = _mm256_unpacklo_epi16(d, one), d1Hi = _mm256_unpackhi_epi16(d, one);
+
+  *pR = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ceLo, kR), round), 8),
+                           _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ceHi, kR), round), 8));
+  *pG = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ceLo, kG), _mm256_madd_epi16(d1Lo, kGd)), 8),
+                           _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(ceHi, kG), _mm256_madd_epi16(d1Hi, kGd)), 8));
+  *pB = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cdLo, kB), round), 8),
+                           _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(cdHi, kB), round), 8));
+}
+
+/** Computes the R, G and B bytes of 32 pixels, in order */
+__attribute__((target("avx2")))
+static inline void colorconv_YuvRowAVX2(const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 x,
+  __m256i* pR, __m256i* pG, __m256i* pB) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i k16 = _mm256_set1_epi16(16);
+  const __m256i k128 = _mm256_set1_epi16(128);
+  __m256i y = _mm256_loadu_si256((const __m256i*) (pY + x));
+  __m128i u = _mm_loadu_si128((const __m128i*) (pU + x / 2));
+  __m128i v = _mm_loadu_si128((const __m128i*) (pV + x / 2));
+  __m256i uu = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(u, u)), _mm_unpackhi_epi8(u, u), 1);
+  __m256i vv = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(v, v)), _mm_unpackhi_epi8(v, v), 1);
+  __m256i r0, g0, b0, r1, g1, b1;
+
+  colorconv_YuvToRgbAVX2(_mm256_sub_epi16(_mm256_unpacklo_epi8(y, zero), k16), _mm256_sub_epi16(_mm256_unpacklo_epi8(uu, zero), k128),
+    _mm256_sub_epi16(_mm256_unpacklo_epi8(vv, zero), k128), &r0, &g0, &b0);
+  colorconv_YuvToRgbAVX2(_mm256_sub_epi16(_mm256_unpackhi_epi8(y, zero), k16), _mm256_sub_epi16(_mm256_unpackhi_epi8(uu, zero), k128),
+    _mm256_sub_epi16(_mm256_unpackhi_epi8(vv, zero), k128), &r1, &g1, &b1);
+  /* packing the lanes back gives the bytes in order */
+  *pR = _mm256_packus_epi16(r0, r1);
+  *pG = _mm256_packus_epi16(g0, g1);
+  *pB = _mm256_packus_epi16(b0, b1);
+}
+
+__attribute__((target("avx2")))
+static void colorconv_YuvToArgbAVX2(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth) {
+  const __m256i alpha = _mm256_set1_epi8((char) 0xff);
+  __m256i r, g, b, bgLo, bgHi, raLo, raHi, p0, p1, p2, p3;
+  OMX_U32 x = 0;
+
+  for (; x + 32 <= nWidth; x += 32) {
+    colorconv_YuvRowAVX2(pY, pU, pV, x, &r, &g, &b);
+    bgLo = _mm256_unpacklo_epi8(b, g);
+    bgHi = _mm256_unpackhi_epi8(b, g);
+    raLo = _mm256_unpacklo_epi8(r, alpha);
+    raHi = _mm256_unpackhi_epi8(r, alpha);
+    p0 = _mm256_unpacklo_epi16(bgLo, raLo);
+    p1 = _mm256_unpackhi_epi16(bgLo, raLo);
+    p2 = _mm256_unpacklo_epi16(bgHi, raHi);
+    p3 = _mm256_unpackhi_epi16(bgHi, raHi);
+    _mm256_storeu_si256((__m256i*) (pOut + x * 4), _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256((__m256i*) (pOut + x * 4 + 32), _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256((__m256i*) (pOut + x * 4 + 64), _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256((__m256i*) (pOut + x * 4 + 96), _mm256_permute2x128_si256(p2, p3, 0x31));
+  }
+  colorconv_YuvToArgbPixels(pOut, pY, pU, pV, x, nWidth);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i colorconv_Rgb565AVX2(__m256i r, __m256i g, __m256i b) {
+  return _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(r, _mm256_set1_epi16(0xf8)), 8),
+                                         _mm256_slli_epi16(_mm256_and_si256(g, _mm256_set1_epi16(0xfc)), 3)),
+                         _mm256_srli_epi16(b, 3));
+}
+
+__attribute__((target("avx2")))
+static void colorconv_YuvToRgb565AVX2(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth) {
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i r, g, b, lo, hi;
+  OMX_U32 x = 0;
+
+  for (; x + 32 <= nWidth; x += 32) {
+    colorconv_YuvRowAVX2(pY, pU, pV, x, &r, &g, &b);
+    lo = colorconv_Rgb565AVX2(_mm256_unpacklo_epi8(r, zero), _mm256_unpacklo_epi8(g, zero), _mm256_unpacklo_epi8(b, zero));
+    hi = colorconv_Rgb565AVX2(_mm256_unpackhi_epi8(r, zero), _mm256_unpackhi_epi8(g, zero), _mm256_unpackhi_epi8(b, zero));
+    _mm256_storeu_si256((__m256i*) (pOut + x * 2), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i*) (pOut + x * 2 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+  }
+  colorconv_YuvToRgb565Pixels(pOut, pY, pU, pV, x, nWidth);
+}
+#endif
+
+#ifdef COLORCONV_HAVE_NEON
+static void colorconv_VerticalNEON(int16_t* pOut, const OMX_U8* const* ppRows, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth) {
+  int32x4_t acc0, acc1, acc2, acc3;
+  int16x8_t lo, hi;
+  uint8x16_t row;
+  OMX_U32 x = 0, t;
+
+  for (; x + 16 <= nWidth; x += 16) {
+    acc0 = acc1 = acc2 = acc3 = vdupq_n_s32(0);
+    for (t = 0; t < nTaps; t++) {
+      row = vld1q_u8(ppRows[t] + x);
+      lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(row)));
+      hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(row)));
+      acc0 = vmlal_n_s16(acc0, vget_low_s16(lo), pCoef[t]);
+      acc1 = vmlal_n_s16(acc1, vget_high_s16(lo), pCoef[t]);
+      acc2 = vmlal_n_s16(acc2, vget_low_s16(hi), pCoef[t]);
+      acc3 = vmlal_n_s16(acc3, vget_high_s16(hi), pCoef[t]);
+    }
+    /* the rounding shift adds half a unit first, as the scalar kernel */
+    vst1q_s16(pOut + x, vcombine_s16(vrshrn_n_s32(acc0, VERTICAL_SHIFT), vrshrn_n_s32(acc1, VERTICAL_SHIFT)));
+    vst1q_s16(pOut + x + 8, vcombine_s16(vrshrn_n_s32(acc2, VERTICAL_SHIFT), vrshrn_n_s32(acc3, VERTICAL_SHIFT)));
+  }
+  colorconv_VerticalPixels(pOut, ppRows, pCoef, nTaps, x, nWidth);
+}
+
+static void colorconv_HorizontalNEON(OMX_U8* pOut, const int16_t* pIn, const int32_t* pPos, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth) {
+  const int16_t* pCoefs;
+  int32x4_t acc;
+  int32x2_t pair;
+  int32_t sum;
+  OMX_U32 x, t;
+
+  for (x = 0; x < nWidth; x++) {
+    pCoefs = pCoef + x * nTaps;
+    acc = vdupq_n_s32(0);
+    for (t = 0; t < nTaps; t += 4) {
+      acc = vmlal_s16(acc, vld1_s16(pIn + pPos[x] + t), vld1_s16(pCoefs + t));
+    }
+    pair = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    sum = (vget_lane_s32(vpadd_s32(pair, pair), 0) + (1 << (HORIZONTAL_SHIFT - 1))) >> HORIZONTAL_SHIFT;
+    pOut[x] = colorconv_Clamp(sum);
+  }
+}
+
+/** Computes the R, G and B bytes of 8 pixels */
+static inline void colorconv_YuvToRgbNEON(uint8x8_t y, uint8x8_t u, uint8x8_t v, uint8x8_t* pR, uint8x8_t* pG, uint8x8_t* pB) {
+  int16x8_t c = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(16));
+  int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+  int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+  int32x4_t lo, hi;
+
+  lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(c), 298), vget_low_s16(e), 409);
+  hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(c), 298), vget_high_s16(e), 409);
+  *pR = vqmovun_s16(vcombine_s16(vrshrn_n_s32(lo, 8), vrshrn_n_s32(hi, 8)));
+  lo = vmlsl_n_s16(vmlsl_n_s16(vmull_n_s16(vget_low_s16(c), 298), vget_low_s16(d), 100), vget_low_s16(e), 208);
+  hi = vmlsl_n_s16(vmlsl_n_s16(vmull_n_s16(vget_high_s16(c), 298), vget_high_s16(d), 100), vget_high_s16(e), 208);
+  *pG = vqmovun_s16(vcombine_s16(vrshrn_n_s32(lo, 8), vrshrn_n_s32(hi, 8)));
+  lo = vmlal_n_s16(vmull_n_s16(vget_low_s16(c), 298), vget_low_s16(d), 516);
+  hi = vmlal_n_s16(vmull_n_s16(vget_high_s16(c), 298), vget_high_s16(d), 516);
+  *pB = vqmovun_s16(vcombine_s16(vrshrn_n_s32(lo, 8), vrshrn_n_s32(hi, 8)));
+}
+
+static void colorconv_YuvToArgbNEON(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth) {
+  uint8x16_t y;
+  uint8x8x2_t u, v;
+  uint8x8x4_t pixels;
+  OMX_U32 x = 0;
+
+  pixels.val[3] = vdup_n_u8(0xff);
+  for (; x + 16 <= nWidth; x += 16) {
+    y = vld1q_u8(pY + x);
+    u = vzip_u8(vld1_u8(pU + x / 2), vld1_u8(pU + x / 2));
+    v = vzip_u8(vld1_u8(pV + x / 2), vld1_u8(pV + x / 2));
+    colorconv_YuvToRgbNEON(vget_low_u8(y), u.val[0], v.val[0], &pixels.val[2], &pixels.val[1], &pixels.val[0]);
+    vst4_u8(pOut + x * 4, pixels);
+    colorconv_YuvToRgbNEON(vget_high_u8(y), u.val[1], v.val[1], &pixels.val[2], &pixels.val[1], &pixels.val[0]);
+    vst4_u8(pOut + x * 4 + 32, pixels);
+  }
+  colorconv_YuvToArgbPixels(pOut, pY, pU, pV, x, nWidth);
+}
+
+static inline uint16x8_t colorconv_Rgb565NEON(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+  return vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(vshr_n_u8(r, 3)), 11), vshlq_n_u16(vmovl_u8(vshr_n_u8(g, 2)), 5)),
+                   vmovl_u8(vshr_n_u8(b, 3)));
+}
+
+static void colorconv_YuvToRgb565NEON(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth) {
+  uint8x16_t y;
+  uint8x8x2_t u, v;
+  uint8x8_t r, g, b;
+  OMX_U32 x = 0;
+
+  for (; x + 16 <= nWidth; x += 16) {
+    y = vld1q_u8(pY + x);
+    u = vzip_u8(vld1_u8(pU + x / 2), vld1_u8(pU + x / 2));
+    v = vzip_u8(vld1_u8(pV + x / 2), vld1_u8(pV + x / 2));
+    colorconv_YuvToRgbNEON(vget_low_u8(y), u.val[0], v.val[0], &r, &g, &b);
+    vst1q_u16((uint16_t*) (pOut + x * 2), colorconv_Rgb565NEON(r, g, b));
+    colorconv_YuvToRgbNEON(vget_high_u8(y), u.val[1], v.val[1], &r, &g, &b);
+    vst1q_u16((uint16_t*) (pOut + x * 2 + 16), colorconv_Rgb565NEON(r, g, b));
+  }
+  colorconv_YuvToRgb565Pixels(pOut, pY, pU, pV, x, nWidth);
+}
+#endif
+
+/** The kernels built, the best first */
+static const colorconv_kernel_t colorconvKernels[] = {
+#ifdef COLORCONV_HAVE_AVX2
+  { "avx2", KERNEL_CPU_AVX2, colorconv_VerticalAVX2, colorconv_HorizontalSSE, colorconv_YuvToArgbAVX2, colorconv_YuvToRgb565AVX2 },
+#endif
+#ifdef COLORCONV_HAVE_SSE
+  { "sse", 0, colorconv_VerticalSSE, colorconv_HorizontalSSE, colorconv_YuvToArgbSSE, colorconv_YuvToRgb565SSE },
+#endif
+#ifdef COLORCONV_HAVE_NEON
+  { "neon", 0, colorconv_VerticalNEON, colorconv_HorizontalNEON, colorconv_YuvToArgbNEON, colorconv_YuvToRgb565NEON },
+#endif
+  { "scalar", 0, colorconv_VerticalScalar, colorconv_HorizontalScalar, colorconv_YuvToArgbScalar, colorconv_YuvToRgb565Scalar },
+};
+
+#define COLORCONV_KERNELS (sizeof(colorconvKernels) / sizeof(colorconvKernels[0]))
+
+const colorconv_kernel_t* colorconv_SelectKernel(const char* sName) {
+  return kernel_table_select(colorconvKernels, COLORCONV_KERNELS, sizeof(colorconv_kernel_t), sName, COLORCONV_KERNEL_ENV);
+}
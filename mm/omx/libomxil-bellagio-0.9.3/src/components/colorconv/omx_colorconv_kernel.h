@@ -0,0 +1,78 @@
+/**
+  src/components/colorconv/omx_colorconv_kernel.h
+
+  Vectorized row kernels of the color converter component: the two passes of
+  the scaler and the conversion of YUV rows to RGB.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_COLORCONV_KERNEL_H_
+#define _OMX_COLORCONV_KERNEL_H_
+
+#include <stdint.h>
+#include <OMX_Types.h>
+
+#include "kernel_table.h"
+
+/** The environment variable naming the kernel used by the color converters, as
+ * "scalar", "sse", "avx2" or "neon". The best kernel supported by the CPU is
+ * used when it is not set or names a kernel not available.
+ */
+#define COLORCONV_KERNEL_ENV "OMX_BELLAGIO_COLORCONV_KERNEL"
+
+/** Fractional bits of the filter coefficients */
+#define COLORCONV_COEF_BITS 14
+
+/** Fractional bits of the rows filtered vertically, before the horizontal pass */
+#define COLORCONV_ROW_BITS 6
+
+/** Sums nTaps rows ppRows weighted by pCoef into nWidth pixels of pOut, with
+ * COLORCONV_ROW_BITS fractional bits. nTaps is even.
+ */
+typedef void (*colorconv_vertical_t)(int16_t* pOut, const OMX_U8* const* ppRows, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth);
+
+/** Computes nWidth pixels of pOut, pixel x being the sum of the nTaps pixels
+ * of pIn from pPos[x] weighted by pCoef[x * nTaps], rounded and saturated.
+ * nTaps is a multiple of 4 and pIn has nTaps pixels readable past its end.
+ */
+typedef void (*colorconv_horizontal_t)(OMX_U8* pOut, const int16_t* pIn, const int32_t* pPos, const int16_t* pCoef,
+  OMX_U32 nTaps, OMX_U32 nWidth);
+
+/** Converts nWidth pixels of BT.601 YUV to opaque 32 bit ARGB words or to
+ * RGB565, pixel x taking the chroma pU[x / 2] and pV[x / 2]
+ */
+typedef void (*colorconv_yuvrow_t)(OMX_U8* pOut, const OMX_U8* pY, const OMX_U8* pU, const OMX_U8* pV, OMX_U32 nWidth);
+
+typedef struct colorconv_kernel_t {
+  kernel_table_entry_FIELDS
+  colorconv_vertical_t Vertical;
+  colorconv_horizontal_t Horizontal;
+  colorconv_yuvrow_t YuvToArgb;
+  colorconv_yuvrow_t YuvToRgb565;
+} colorconv_kernel_t;
+
+/** Returns the kernel named sName if the CPU supports it, the one named by
+ * COLORCONV_KERNEL_ENV if sName is NULL, or else the best one available
+ */
+const colorconv_kernel_t* colorconv_SelectKernel(const char* sName);
+
+#endif
@@ -0,0 +1,116 @@
+/**
+  src/components/file_io/omx_fileio_pipe.c
+
+  The content pipes of the file reader and file writer components.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include <omxcore.h>
+#include "omx_fileio_pipe.h"
+
+OMX_ERRORTYPE fileio_SetContentURI(fileio_content_t* pContent, OMX_PARAM_CONTENTURITYPE* pContentURI) {
+  size_t nMaxLength;
+  OMX_STRING sURI;
+
+  if (pContentURI->nSize <= offsetof(OMX_PARAM_CONTENTURITYPE, contentURI)) {
+    return OMX_ErrorBadParameter;
+  }
+  /* the structure ends with the URI, up to nSize */
+  nMaxLength = pContentURI->nSize - offsetof(OMX_PARAM_CONTENTURITYPE, contentURI);
+  sURI = calloc(1, nMaxLength + 1);
+  if (!sURI) {
+    return OMX_ErrorInsufficientResources;
+  }
+  strncpy(sURI, (char*) pContentURI->contentURI, nMaxLength);
+  free(pContent->sURI);
+  pContent->sURI = sURI;
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s content URI %s\n", __func__, sURI);
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE fileio_GetContentURI(fileio_content_t* pContent, OMX_PARAM_CONTENTURITYPE* pContentURI) {
+  size_t nMaxLength;
+
+  if (pContentURI->nSize <= offsetof(OMX_PARAM_CONTENTURITYPE, contentURI)) {
+    return OMX_ErrorBadParameter;
+  }
+  nMaxLength = pContentURI->nSize - offsetof(OMX_PARAM_CONTENTURITYPE, contentURI);
+  if (!pContent->sURI) {
+    pContentURI->contentURI[0] = '\0';
+  } else {
+    strncpy((char*) pContentURI->contentURI, pContent->sURI, nMaxLength);
+    pContentURI->contentURI[nMaxLength - 1] = '\0';
+  }
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE fileio_OpenContent(fileio_content_t* pContent, OMX_BOOL bCreate) {
+  CP_PIPETYPE* pPipe = pContent->pCustomPipe;
+  CPresult res;
+
+  if (!pContent->sURI) {
+    DEBUG(DEB_LEV_ERR, "In %s no content URI\n", __func__);
+    return OMX_ErrorContentPipeOpenFailed;
+  }
+  if (!pPipe && OMX_GetContentPipe((OMX_HANDLETYPE*) &pPipe, pContent->sURI) != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "In %s no content pipe for %s\n", __func__, pContent->sURI);
+    return OMX_ErrorContentPipeCreationFailed;
+  }
+
+  if (bCreate == OMX_TRUE) {
+    res = pPipe->Create((CPhandle*) pPipe, pContent->sURI);
+  } else {
+    res = pPipe->Open((CPhandle*) pPipe, pContent->sURI, CP_AccessRead);
+  }
+  if (res != 0) {
+    DEBUG(DEB_LEV_ERR, "In %s could not open %s (%x)\n", __func__, pContent->sURI, (int) res);
+    if (pPipe != pContent->pCustomPipe) {
+      free(pPipe);
+    }
+    return OMX_ErrorContentPipeOpenFailed;
+  }
+  pContent->pPipe = pPipe;
+
+  return OMX_ErrorNone;
+}
+
+void fileio_CloseContent(fileio_content_t* pContent) {
+  if (!pContent->pPipe) {
+    return;
+  }
+  pContent->pPipe->Close((CPhandle) pContent->pPipe);
+  if (pContent->pPipe != pContent->pCustomPipe) {
+    free(pContent->pPipe);
+  }
+  pContent->pPipe = NULL;
+}
+
+void fileio_FreeContent(fileio_content_t* pContent) {
+  fileio_CloseContent(pContent);
+  free(pContent->sURI);
+  pContent->sURI = NULL;
+}
@@ -0,0 +1,59 @@
+/**
+  src/components/file_io/omx_fileio_pipe.h
+
+  The content pipes of the file reader and file writer components: the URI of
+  the content, set with OMX_IndexParamContentURI, and the pipe opened on it,
+  either one built by OMX_GetContentPipe for the scheme of the URI or the one
+  given by the IL client with OMX_IndexParamCustomContentPipe.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_FILEIO_PIPE_H_
+#define _OMX_FILEIO_PIPE_H_
+
+#include <OMX_Types.h>
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_ContentPipe.h>
+
+/** The content of a file reader or writer */
+typedef struct fileio_content_t {
+  OMX_STRING sURI;          /**< the URI of the content, NULL until set */
+  CP_PIPETYPE* pCustomPipe; /**< the pipe given by the IL client, NULL if none */
+  CP_PIPETYPE* pPipe;       /**< the pipe open on the content, NULL if closed */
+} fileio_content_t;
+
+/** Sets the URI of the content from OMX_IndexParamContentURI */
+OMX_ERRORTYPE fileio_SetContentURI(fileio_content_t* pContent, OMX_PARAM_CONTENTURITYPE* pContentURI);
+
+/** Fills OMX_IndexParamContentURI, the URI being truncated to the size of the structure */
+OMX_ERRORTYPE fileio_GetContentURI(fileio_content_t* pContent, OMX_PARAM_CONTENTURITYPE* pContentURI);
+
+/** Opens the pipe on the content, to read it or to create it for writing */
+OMX_ERRORTYPE fileio_OpenContent(fileio_content_t* pContent, OMX_BOOL bCreate);
+
+/** Closes the pipe, and frees it unless the IL client gave it */
+void fileio_CloseContent(fileio_content_t* pContent);
+
+/** Frees the URI, the pipe being closed */
+void fileio_FreeContent(fileio_content_t* pContent);
+
+#endif
@@ -0,0 +1,461 @@
+/**
+  src/components/file_io/omx_filereader_component.c
+
+  OpenMAX file reader component. This component does not perform any multimedia
+  processing. It reads the content at the URI set with OMX_IndexParamContentURI
+  through a content pipe, and sends it on its output port.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <omxcore.h>
+#include <omx_base_audio_port.h>
+#include <omx_filereader_component.h>
+
+/** Buffers of the pipe sent at once in place of the payloads of the port,
+ * below the buffers a pipe lets out with ReadBuffer
+ */
+#define MAX_LENT_BUFFERS 8
+
+static OMX_ERRORTYPE filereader_port_FreeBuffer(omx_base_PortType *openmaxStandPort, OMX_U32 nPortIndex, OMX_BUFFERHEADERTYPE* pBuffer);
+static OMX_ERRORTYPE filereader_port_FreeTunnelBuffer(omx_base_PortType *openmaxStandPort, OMX_U32 nPortIndex);
+
+OMX_ERRORTYPE omx_filereader_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+  OMX_ERRORTYPE err;
+  omx_filereader_component_PrivateType* omx_filereader_component_Private;
+  omx_base_PortType* pPort;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+  RM_RegisterComponent(FILEREADER_COMP_NAME, MAX_FILEREADER_COMPONENTS);
+  if (!openmaxStandComp->pComponentPrivate) {
+    err = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_filereader_component_PrivateType), 1, sizeof(omx_base_audio_PortType));
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+  } else {
+    DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+    return OMX_ErrorUndefined;
+  }
+
+  omx_filereader_component_Private = openmaxStandComp->pComponentPrivate;
+
+  /** Calling base source constructor */
+  err = omx_base_source_Constructor(openmaxStandComp, cComponentName);
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+    return err;
+  }
+
+  omx_filereader_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+  omx_filereader_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 1;
+
+  /** Allocate Ports and call port constructor. */
+  if (!omx_filereader_component_Private->ports) {
+    omx_filereader_component_Private->ports = calloc(1, sizeof(omx_base_PortType *));
+    if (!omx_filereader_component_Private->ports) {
+      return OMX_ErrorInsufficientResources;
+    }
+    omx_filereader_component_Private->ports[0] = calloc(1, sizeof(omx_base_audio_PortType));
+    if (!omx_filereader_component_Private->ports[0]) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  err = base_audio_port_Constructor(openmaxStandComp, &omx_filereader_component_Private->ports[0], 0, OMX_FALSE);
+  if (err != OMX_ErrorNone) {
+    return OMX_ErrorInsufficientResources;
+  }
+
+  /* the payloads lent to the pipe are given back before the buffers are freed */
+  pPort = omx_filereader_component_Private->ports[OMX_BASE_SOURCE_OUTPUTPORT_INDEX];
+  pPort->Port_FreeBuffer = filereader_port_FreeBuffer;
+  pPort->Port_FreeTunnelBuffer = filereader_port_FreeTunnelBuffer;
+
+  omx_filereader_component_Private->bReadBuffer = OMX_TRUE;
+  omx_filereader_component_Private->destructor = omx_filereader_component_Destructor;
+  omx_filereader_component_Private->DoStateSet = omx_filereader_component_DoStateSet;
+  omx_filereader_component_Private->BufferMgmtCallback = omx_filereader_component_BufferMgmtCallback;
+  openmaxStandComp->SetParameter = omx_filereader_component_SetParameter;
+  openmaxStandComp->GetParameter = omx_filereader_component_GetParameter;
+  openmaxStandComp->GetExtensionIndex = omx_filereader_component_GetExtensionIndex;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_filereader_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_filereader_component_PrivateType* omx_filereader_component_Private = openmaxStandComp->pComponentPrivate;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+
+  fileio_FreeContent(&omx_filereader_component_Private->content);
+  free(omx_filereader_component_Private->pLentPayloads);
+  omx_filereader_component_Private->pLentPayloads = NULL;
+  omx_filereader_component_Private->nLentSlots = 0;
+
+  /* frees port/s */
+  if (omx_filereader_component_Private->ports) {
+    if (omx_filereader_component_Private->ports[0]) {
+      omx_filereader_component_Private->ports[0]->PortDestructor(omx_filereader_component_Private->ports[0]);
+    }
+    omx_base_component_FreeStorage(openmaxStandComp, omx_filereader_component_Private->ports);
+    omx_filereader_component_Private->ports = NULL;
+  }
+
+  omx_base_source_Destructor(openmaxStandComp);
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+/** Gives its payload back to the buffer in a slot of the output port, if it
+ * was sent with a buffer of the pipe, and releases the buffer of the pipe
+ */
+static void filereader_ReturnPayload(omx_filereader_component_PrivateType* omx_filereader_component_Private,
+                                     omx_base_PortType *openmaxStandPort, int nSlot) {
+  CP_PIPETYPE* pPipe = omx_filereader_component_Private->content.pPipe;
+  OMX_BUFFERHEADERTYPE* pBuffer;
+
+  if (nSlot < 0 || (OMX_U32) nSlot >= omx_filereader_component_Private->nLentSlots ||
+      !omx_filereader_component_Private->pLentPayloads[nSlot]) {
+    return;
+  }
+  pBuffer = openmaxStandPort->pInternalBufferStorage[nSlot];
+  if (pPipe) {
+    pPipe->ReleaseReadBuffer((CPhandle) pPipe, (CPbyte*) pBuffer->pBuffer);
+  }
+  pBuffer->pBuffer = omx_filereader_component_Private->pLentPayloads[nSlot];
+  omx_filereader_component_Private->pLentPayloads[nSlot] = NULL;
+}
+
+/** Gives their payloads back to all the buffers of the output port */
+static void filereader_ReturnPayloads(omx_filereader_component_PrivateType* omx_filereader_component_Private,
+                                      omx_base_PortType *openmaxStandPort) {
+  OMX_U32 i;
+
+  for (i = 0; i < omx_filereader_component_Private->nLentSlots; i++) {
+    filereader_ReturnPayload(omx_filereader_component_Private, openmaxStandPort, i);
+  }
+}
+
+/** Whether the buffer in a slot of the output port can be sent with a buffer
+ * of the pipe: the receiver must not write it, the buffer of the pipe being
+ * possibly read-only, and the port must have allocated its payload, and so be
+ * the one that frees it
+ */
+static OMX_BOOL filereader_CanLend(omx_filereader_component_PrivateType* omx_filereader_component_Private,
+                                   omx_base_PortType *openmaxStandPort, int nSlot) {
+  OMX_U32 i, nLent = 0;
+  OMX_U8** pLentPayloads;
+
+  if (omx_filereader_component_Private->bReadOnlyBuffers == OMX_FALSE ||
+      nSlot < 0 || !(openmaxStandPort->bBufferStateAllocated[nSlot] & BUFFER_ALLOCATED)) {
+    return OMX_FALSE;
+  }
+  if ((OMX_U32) nSlot >= omx_filereader_component_Private->nLentSlots) {
+    pLentPayloads = realloc(omx_filereader_component_Private->pLentPayloads,
+                            openmaxStandPort->sPortParam.nBufferCountActual * sizeof(OMX_U8*));
+    if (!pLentPayloads) {
+      return OMX_FALSE;
+    }
+    for (i = omx_filereader_component_Private->nLentSlots; i < openmaxStandPort->sPortParam.nBufferCountActual; i++) {
+      pLentPayloads[i] = NULL;
+    }
+    omx_filereader_component_Private->pLentPayloads = pLentPayloads;
+    omx_filereader_component_Private->nLentSlots = openmaxStandPort->sPortParam.nBufferCountActual;
+  }
+  for (i = 0; i < omx_filereader_component_Private->nLentSlots; i++) {
+    if (omx_filereader_component_Private->pLentPayloads[i]) {
+      nLent++;
+    }
+  }
+
+  return (nLent < MAX_LENT_BUFFERS) ? OMX_TRUE : OMX_FALSE;
+}
+
+/** This function fills an output buffer with the next bytes of the content.
+  * A buffer of the pipe is sent in place of the payload when the port allocated
+  * it and the receiver does not write it, so that the content is not copied.
+  * Otherwise the buffer of the pipe is copied in the payload, or the payload
+  * read with Read for a pipe without ReadBuffer. The end of the content sets
+  * the EOS flag.
+  */
+void omx_filereader_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_filereader_component_PrivateType* omx_filereader_component_Private = openmaxStandComp->pComponentPrivate;
+  omx_base_PortType *pPort = omx_filereader_component_Private->ports[OMX_BASE_SOURCE_OUTPUTPORT_INDEX];
+  CP_PIPETYPE* pPipe = omx_filereader_component_Private->content.pPipe;
+  CPuint nSize = pOutputBuffer->nAllocLen;
+  CPuint nStart, nPosition;
+  CPbyte* pData;
+  CPresult res = 0;
+  int nSlot;
+
+  nSlot = base_port_GetBufferSlot(pPort, pOutputBuffer);
+  filereader_ReturnPayload(omx_filereader_component_Private, pPort, nSlot);
+  pOutputBuffer->nOffset = 0;
+  pOutputBuffer->nFilledLen = 0;
+  if (!pPipe || omx_filereader_component_Private->bIsEOSReached == OMX_TRUE) {
+    return;
+  }
+
+  if (omx_filereader_component_Private->bReadBuffer == OMX_TRUE) {
+    res = pPipe->ReadBuffer((CPhandle) pPipe, &pData, &nSize, OMX_TRUE);
+    if (res == 0) {
+      if (filereader_CanLend(omx_filereader_component_Private, pPort, nSlot) == OMX_TRUE) {
+        omx_filereader_component_Private->pLentPayloads[nSlot] = pOutputBuffer->pBuffer;
+        pOutputBuffer->pBuffer = (OMX_U8*) pData;
+      } else {
+        memcpy(pOutputBuffer->pBuffer, pData, nSize);
+        pPipe->ReleaseReadBuffer((CPhandle) pPipe, pData);
+      }
+      pOutputBuffer->nFilledLen = nSize;
+    } else if (res != KD_EIO || nSize != 0) {
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the pipe gives no buffers (%x), reading it\n", __func__, (int) res);
+      omx_filereader_component_Private->bReadBuffer = OMX_FALSE;
+      nSize = pOutputBuffer->nAllocLen;
+    }
+  }
+
+  if (omx_filereader_component_Private->bReadBuffer == OMX_FALSE) {
+    pPipe->GetPosition((CPhandle) pPipe, &nStart);
+    res = pPipe->Read((CPhandle) pPipe, (CPbyte*) pOutputBuffer->pBuffer, nSize);
+    if (res == 0) {
+      pOutputBuffer->nFilledLen = nSize;
+    } else if (pPipe->GetPosition((CPhandle) pPipe, &nPosition) == 0 && nPosition > nStart) {
+      pOutputBuffer->nFilledLen = nPosition - nStart;
+    }
+  }
+
+  if (res != 0) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s end of the content %s\n", __func__, omx_filereader_component_Private->content.sURI);
+    pOutputBuffer->nFlags |= OMX_BUFFERFLAG_EOS;
+  }
+}
+
+/** The pipe is open from Loaded to Idle and back, and the payloads lent are given back
+ * before the pipe is closed
+ */
+OMX_ERRORTYPE omx_filereader_component_DoStateSet(OMX_COMPONENTTYPE *openmaxStandComp, OMX_U32 destinationState) {
+  omx_filereader_component_PrivateType* omx_filereader_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_STATETYPE state = omx_filereader_component_Private->state;
+  OMX_ERRORTYPE err;
+
+  if (state == OMX_StateLoaded && destinationState == OMX_StateIdle) {
+    err = fileio_OpenContent(&omx_filereader_component_Private->content, OMX_FALSE);
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+    omx_filereader_component_Private->bReadBuffer = OMX_TRUE;
+  }
+
+  err = omx_base_component_DoStateSet(openmaxStandComp, destinationState);
+
+  if ((state == OMX_StateLoaded && destinationState == OMX_StateIdle && err != OMX_ErrorNone) ||
+      (state == OMX_StateIdle && destinationState == OMX_StateLoaded && err == OMX_ErrorNone)) {
+    filereader_ReturnPayloads(omx_filereader_component_Private, omx_filereader_component_Private->ports[OMX_BASE_SOURCE_OUTPUTPORT_INDEX]);
+    fileio_CloseContent(&omx_filereader_component_Private->content);
+  }
+
+  return err;
+}
+
+static OMX_ERRORTYPE filereader_port_FreeBuffer(omx_base_PortType *openmaxStandPort, OMX_U32 nPortIndex, OMX_BUFFERHEADERTYPE* pBuffer) {
+  omx_filereader_component_PrivateType* omx_filereader_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+
+  filereader_ReturnPayload(omx_filereader_component_Private, openmaxStandPort, base_port_GetBufferSlot(openmaxStandPort, pBuffer));
+  return base_port_FreeBuffer(openmaxStandPort, nPortIndex, pBuffer);
+}
+
+static OMX_ERRORTYPE filereader_port_FreeTunnelBuffer(omx_base_PortType *openmaxStandPort, OMX_U32 nPortIndex) {
+  omx_filereader_component_PrivateType* omx_filereader_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+
+  filereader_ReturnPayloads(omx_filereader_component_Private, openmaxStandPort);
+  return base_port_FreeTunnelBuffer(openmaxStandPort, nPortIndex);
+}
+
+OMX_ERRORTYPE omx_filereader_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_PARAM_CONTENTPIPETYPE *pContentPipe;
+  OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE *pReadOnly;
+  omx_base_audio_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_filereader_component_PrivateType* omx_filereader_component_Private = openmaxStandComp->pComponentPrivate;
+
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch((OMX_U32)nParamIndex) {
+    case OMX_IndexParamContentURI:
+    case OMX_IndexParamCustomContentPipe:
+      if (omx_filereader_component_Private->state != OMX_StateLoaded && omx_filereader_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_filereader_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+      if (nParamIndex == OMX_IndexParamContentURI) {
+        err = fileio_SetContentURI(&omx_filereader_component_Private->content, (OMX_PARAM_CONTENTURITYPE*)ComponentParameterStructure);
+      } else if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_CONTENTPIPETYPE))) == OMX_ErrorNone) {
+        pContentPipe = (OMX_PARAM_CONTENTPIPETYPE*)ComponentParameterStructure;
+        omx_filereader_component_Private->content.pCustomPipe = (CP_PIPETYPE*) pContentPipe->hPipe;
+      }
+      break;
+    case OMX_IndexParameterReadOnlyBuffers:
+      /* the buffers already lent keep the buffers of the pipe until they return */
+      if (omx_filereader_component_Private->state != OMX_StateLoaded && omx_filereader_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_filereader_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      pReadOnly = (OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE*)ComponentParameterStructure;
+      if (pReadOnly->nPortIndex != OMX_BASE_SOURCE_OUTPUTPORT_INDEX) {
+        return OMX_ErrorBadPortIndex;
+      }
+      omx_filereader_component_Private->bReadOnlyBuffers = pReadOnly->bReadOnly;
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      err = omx_base_component_ParameterSanityCheck(hComponent, pAudioPortFormat->nPortIndex, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex == 0) {
+        port = (omx_base_audio_PortType *)omx_filereader_component_Private->ports[0];
+        memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_filereader_component_Private->state != OMX_StateLoaded && omx_filereader_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_filereader_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, FILEREADER_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_filereader_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_PARAM_CONTENTPIPETYPE *pContentPipe;
+  OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE *pReadOnly;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_audio_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_filereader_component_PrivateType* omx_filereader_component_Private = openmaxStandComp->pComponentPrivate;
+
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch((OMX_U32)nParamIndex) {
+    case OMX_IndexParamContentURI:
+      err = fileio_GetContentURI(&omx_filereader_component_Private->content, (OMX_PARAM_CONTENTURITYPE*)ComponentParameterStructure);
+      break;
+    case OMX_IndexParamCustomContentPipe:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_CONTENTPIPETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      pContentPipe = (OMX_PARAM_CONTENTPIPETYPE*)ComponentParameterStructure;
+      pContentPipe->hPipe = (OMX_HANDLETYPE) omx_filereader_component_Private->content.pCustomPipe;
+      break;
+    case OMX_IndexParameterReadOnlyBuffers:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      pReadOnly = (OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE*)ComponentParameterStructure;
+      if (pReadOnly->nPortIndex != OMX_BASE_SOURCE_OUTPUTPORT_INDEX) {
+        return OMX_ErrorBadPortIndex;
+      }
+      pReadOnly->bReadOnly = omx_filereader_component_Private->bReadOnlyBuffers;
+      break;
+    case OMX_IndexParamAudioInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_filereader_component_Private->sPortTypesParam[OMX_PortDomainAudio], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex == 0) {
+        port = (omx_base_audio_PortType *)omx_filereader_component_Private->ports[0];
+        memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, FILEREADER_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_filereader_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType) {
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
+  if(strcmp(cParameterName,"OMX.st.index.param.BellagioReadOnlyBuffers") == 0) {
+    *pIndexType = OMX_IndexParameterReadOnlyBuffers;
+    return OMX_ErrorNone;
+  }
+  return omx_base_component_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+}
@@ -0,0 +1,90 @@
+/**
+  src/components/file_io/omx_filereader_component.h
+
+  OpenMAX file reader component. This component does not perform any multimedia
+  processing. It reads the content at the URI set with OMX_IndexParamContentURI
+  through a content pipe, and sends it on its output port.
+  Once the receiver declares with OMX_IndexParameterReadOnlyBuffers that it
+  does not write them, the buffers it allocates may be sent with a buffer of
+  the pipe in place of their payload, which can be read-only memory.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_FILEREADER_COMPONENT_H_
+#define _OMX_FILEREADER_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <string.h>
+#include <omx_base_source.h>
+#include "omx_fileio_pipe.h"
+
+#define FILEREADER_COMP_NAME "OMX.st.audio.filereader"
+#define FILEREADER_COMP_ROLE "audio_reader.binary"
+#define MAX_FILEREADER_COMPONENTS 10
+
+/** File reader component private structure.
+ * @param content the URI and the pipe of the content read
+ * @param bReadBuffer false once the pipe failed to return a buffer with ReadBuffer, Read is then used
+ * @param bReadOnlyBuffers the receiver of the output buffers does not write them, false by default
+ * @param pLentPayloads for each slot of the output port, the payload of the port replaced by a
+ * buffer of the pipe, or NULL. With bReadOnlyBuffers, a buffer allocated by the port is sent with
+ * the buffer of the pipe, so that the content is not copied, and gets its payload back when it returns.
+ * @param nLentSlots the slots in pLentPayloads
+ */
+DERIVEDCLASS(omx_filereader_component_PrivateType, omx_base_source_PrivateType)
+#define omx_filereader_component_PrivateType_FIELDS omx_base_source_PrivateType_FIELDS \
+  fileio_content_t content; \
+  OMX_BOOL bReadBuffer; \
+  OMX_BOOL bReadOnlyBuffers; \
+  OMX_U8** pLentPayloads; \
+  OMX_U32 nLentSlots;
+ENDCLASS(omx_filereader_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_filereader_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_filereader_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_filereader_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* outputbuffer);
+
+OMX_ERRORTYPE omx_filereader_component_DoStateSet(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_U32 destinationState);
+
+OMX_ERRORTYPE omx_filereader_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_filereader_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_filereader_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType);
+
+#endif
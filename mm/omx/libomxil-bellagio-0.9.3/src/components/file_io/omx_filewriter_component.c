@@ -0,0 +1,284 @@
+/**
+  src/components/file_io/omx_filewriter_component.c
+
+  OpenMAX file writer component. This component does not perform any multimedia
+  processing. It writes the data received on its input port through a content
+  pipe, in the content at the URI set with OMX_IndexParamContentURI.
+
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <omxcore.h>
+#include <omx_base_audio_port.h>
+#include <omx_filewriter_component.h>
+
+OMX_ERRORTYPE omx_filewriter_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+  OMX_ERRORTYPE err;
+  omx_filewriter_component_PrivateType* omx_filewriter_component_Private;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+  RM_RegisterComponent(FILEWRITER_COMP_NAME, MAX_FILEWRITER_COMPONENTS);
+  if (!openmaxStandComp->pComponentPrivate) {
+    err = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_filewriter_component_PrivateType), 1, sizeof(omx_base_audio_PortType));
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+  } else {
+    DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+    return OMX_ErrorUndefined;
+  }
+
+  omx_filewriter_component_Private = openmaxStandComp->pComponentPrivate;
+
+  /** Calling base sink constructor */
+  err = omx_base_sink_Constructor(openmaxStandComp, cComponentName);
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+    return err;
+  }
+
+  omx_filewriter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+  omx_filewriter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 1;
+
+  /** Allocate Ports and call port constructor. */
+  if (!omx_filewriter_component_Private->ports) {
+    omx_filewriter_component_Private->ports = calloc(1, sizeof(omx_base_PortType *));
+    if (!omx_filewriter_component_Private->ports) {
+      return OMX_ErrorInsufficientResources;
+    }
+    omx_filewriter_component_Private->ports[0] = calloc(1, sizeof(omx_base_audio_PortType));
+    if (!omx_filewriter_component_Private->ports[0]) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  err = base_audio_port_Constructor(openmaxStandComp, &omx_filewriter_component_Private->ports[0], 0, OMX_TRUE);
+  if (err != OMX_ErrorNone) {
+    return OMX_ErrorInsufficientResources;
+  }
+
+  omx_filewriter_component_Private->destructor = omx_filewriter_component_Destructor;
+  omx_filewriter_component_Private->DoStateSet = omx_filewriter_component_DoStateSet;
+  omx_filewriter_component_Private->BufferMgmtCallback = omx_filewriter_component_BufferMgmtCallback;
+  openmaxStandComp->SetParameter = omx_filewriter_component_SetParameter;
+  openmaxStandComp->GetParameter = omx_filewriter_component_GetParameter;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_filewriter_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_filewriter_component_PrivateType* omx_filewriter_component_Private = openmaxStandComp->pComponentPrivate;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+
+  fileio_FreeContent(&omx_filewriter_component_Private->content);
+
+  /* frees port/s */
+  if (omx_filewriter_component_Private->ports) {
+    if (omx_filewriter_component_Private->ports[0]) {
+      omx_filewriter_component_Private->ports[0]->PortDestructor(omx_filewriter_component_Private->ports[0]);
+    }
+    omx_base_component_FreeStorage(openmaxStandComp, omx_filewriter_component_Private->ports);
+    omx_filewriter_component_Private->ports = NULL;
+  }
+
+  omx_base_sink_Destructor(openmaxStandComp);
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+  return OMX_ErrorNone;
+}
+
+/** This function writes the data of an input buffer in the content. A failed
+  * write is reported to the IL client with an error event.
+  */
+void omx_filewriter_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer) {
+  omx_filewriter_component_PrivateType* omx_filewriter_component_Private = openmaxStandComp->pComponentPrivate;
+  CP_PIPETYPE* pPipe = omx_filewriter_component_Private->content.pPipe;
+  CPresult res;
+
+  if (pPipe && pInputBuffer->nFilledLen > 0) {
+    res = pPipe->Write((CPhandle) pPipe, (CPbyte*) pInputBuffer->pBuffer + pInputBuffer->nOffset, pInputBuffer->nFilledLen);
+    if (res != 0) {
+      DEBUG(DEB_LEV_ERR, "In %s failed to write %s (%x)\n", __func__, omx_filewriter_component_Private->content.sURI, (int) res);
+      (*(omx_filewriter_component_Private->callbacks->EventHandler))
+        (openmaxStandComp,
+        omx_filewriter_component_Private->callbackData,
+        OMX_EventError,
+        OMX_ErrorStreamCorrupt,
+        0,
+        NULL);
+    }
+  }
+  pInputBuffer->nFilledLen = 0;
+}
+
+/** The content is created going from Loaded to Idle, and closed so that its data is
+ * flushed by the pipe when the component is back to Loaded
+ */
+OMX_ERRORTYPE omx_filewriter_component_DoStateSet(OMX_COMPONENTTYPE *openmaxStandComp, OMX_U32 destinationState) {
+  omx_filewriter_component_PrivateType* omx_filewriter_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_STATETYPE state = omx_filewriter_component_Private->state;
+  OMX_ERRORTYPE err;
+
+  if (state == OMX_StateLoaded && destinationState == OMX_StateIdle) {
+    err = fileio_OpenContent(&omx_filewriter_component_Private->content, OMX_TRUE);
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+  }
+
+  err = omx_base_component_DoStateSet(openmaxStandComp, destinationState);
+
+  if ((state == OMX_StateLoaded && destinationState == OMX_StateIdle && err != OMX_ErrorNone) ||
+      (state == OMX_StateIdle && destinationState == OMX_StateLoaded && err == OMX_ErrorNone)) {
+    fileio_CloseContent(&omx_filewriter_component_Private->content);
+  }
+
+  return err;
+}
+
+OMX_ERRORTYPE omx_filewriter_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_PARAM_CONTENTPIPETYPE *pContentPipe;
+  omx_base_audio_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_filewriter_component_PrivateType* omx_filewriter_component_Private = openmaxStandComp->pComponentPrivate;
+
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch(nParamIndex) {
+    case OMX_IndexParamContentURI:
+    case OMX_IndexParamCustomContentPipe:
+      if (omx_filewriter_component_Private->state != OMX_StateLoaded && omx_filewriter_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_filewriter_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+      if (nParamIndex == OMX_IndexParamContentURI) {
+        err = fileio_SetContentURI(&omx_filewriter_component_Private->content, (OMX_PARAM_CONTENTURITYPE*)ComponentParameterStructure);
+      } else if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_CONTENTPIPETYPE))) == OMX_ErrorNone) {
+        pContentPipe = (OMX_PARAM_CONTENTPIPETYPE*)ComponentParameterStructure;
+        omx_filewriter_component_Private->content.pCustomPipe = (CP_PIPETYPE*) pContentPipe->hPipe;
+      }
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      err = omx_base_component_ParameterSanityCheck(hComponent, pAudioPortFormat->nPortIndex, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex == 0) {
+        port = (omx_base_audio_PortType *)omx_filewriter_component_Private->ports[0];
+        memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_filewriter_component_Private->state != OMX_StateLoaded && omx_filewriter_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_filewriter_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, FILEWRITER_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_filewriter_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_PARAM_CONTENTPIPETYPE *pContentPipe;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_audio_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_filewriter_component_PrivateType* omx_filewriter_component_Private = openmaxStandComp->pComponentPrivate;
+
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch(nParamIndex) {
+    case OMX_IndexParamContentURI:
+      err = fileio_GetContentURI(&omx_filewriter_component_Private->content, (OMX_PARAM_CONTENTURITYPE*)ComponentParameterStructure);
+      break;
+    case OMX_IndexParamCustomContentPipe:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_CONTENTPIPETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      pContentPipe = (OMX_PARAM_CONTENTPIPETYPE*)ComponentParameterStructure;
+      pContentPipe->hPipe = (OMX_HANDLETYPE) omx_filewriter_component_Private->content.pCustomPipe;
+      break;
+    case OMX_IndexParamAudioInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_filewriter_component_Private->sPortTypesParam[OMX_PortDomainAudio], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex == 0) {
+        port = (omx_base_audio_PortType *)omx_filewriter_component_Private->ports[0];
+        memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, FILEWRITER_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
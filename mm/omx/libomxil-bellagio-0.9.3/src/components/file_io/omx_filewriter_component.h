@@ -0,0 +1,72 @@
+/**
+  src/components/file_io/omx_filewriter_component.h
+
+  OpenMAX file writer component. This component does not perform any multimedia
+  processing. It writes the data received on its input port through a content
+  pipe, in the content at the URI set with OMX_IndexParamContentURI.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_FILEWRITER_COMPONENT_H_
+#define _OMX_FILEWRITER_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <string.h>
+#include <omx_base_sink.h>
+#include "omx_fileio_pipe.h"
+
+#define FILEWRITER_COMP_NAME "OMX.st.audio.filewriter"
+#define FILEWRITER_COMP_ROLE "audio_writer.binary"
+#define MAX_FILEWRITER_COMPONENTS 10
+
+/** File writer component private structure.
+ * @param content the URI and the pipe of the content written
+ */
+DERIVEDCLASS(omx_filewriter_component_PrivateType, omx_base_sink_PrivateType)
+#define omx_filewriter_component_PrivateType_FIELDS omx_base_sink_PrivateType_FIELDS \
+  fileio_content_t content;
+ENDCLASS(omx_filewriter_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_filewriter_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_filewriter_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_filewriter_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* inputbuffer);
+
+OMX_ERRORTYPE omx_filewriter_component_DoStateSet(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_U32 destinationState);
+
+OMX_ERRORTYPE omx_filewriter_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_filewriter_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+#endif
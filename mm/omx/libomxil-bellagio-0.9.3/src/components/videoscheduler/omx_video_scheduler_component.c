@@ -42,21 +42,25 @@ OMX_ERRORTYPE omx_video_scheduler_component_Constructor(OMX_COMPONENTTYPE *openm
   omx_video_scheduler_component_PrivateType*   omx_video_scheduler_component_Private;
   omx_base_video_PortType       *inPort,*outPort;
   OMX_U32                                      i;
+  size_t                                       nPortSize = sizeof(omx_base_video_PortType);
 
 
 	RM_RegisterComponent(VIDEO_SCHEDULER_COMP_NAME, MAX_VIDEOSCHED_COMPONENTS);
   if (!openmaxStandComp->pComponentPrivate) {
     DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, allocating component\n", __func__);
-    openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_video_scheduler_component_PrivateType));
-    if(openmaxStandComp->pComponentPrivate == NULL) {
-      return OMX_ErrorInsufficientResources;
+    /* the clock port shares the block with the video ports */
+    if (nPortSize < sizeof(omx_base_clock_PortType)) {
+      nPortSize = sizeof(omx_base_clock_PortType);
+    }
+    err = omx_base_component_AllocPrivate(openmaxStandComp, sizeof(omx_video_scheduler_component_PrivateType), 3, nPortSize);
+    if (err != OMX_ErrorNone) {
+      return err;
     }
   } else {
     DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
   }
 
   omx_video_scheduler_component_Private        = openmaxStandComp->pComponentPrivate;
-  omx_video_scheduler_component_Private->ports = NULL;
 
   /** we could create our own port structures here
     * fixme maybe the base class could use a "port factory" function pointer?
@@ -85,16 +89,15 @@ OMX_ERRORTYPE omx_video_scheduler_component_Constructor(OMX_COMPONENTTYPE *openm
         return OMX_ErrorInsufficientResources;
       }
     }
-    base_video_port_Constructor(openmaxStandComp, &omx_video_scheduler_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX], 0, OMX_TRUE);
-    base_video_port_Constructor(openmaxStandComp, &omx_video_scheduler_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX], 1, OMX_FALSE);
-
     omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX] = calloc(1, sizeof(omx_base_clock_PortType));
     if (!omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX]) {
       return OMX_ErrorInsufficientResources;
     }
-    base_clock_port_Constructor(openmaxStandComp, &omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX], 2, OMX_TRUE);
-    omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX]->sPortParam.bEnabled = OMX_TRUE;
   }
+  base_video_port_Constructor(openmaxStandComp, &omx_video_scheduler_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX], 0, OMX_TRUE);
+  base_video_port_Constructor(openmaxStandComp, &omx_video_scheduler_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX], 1, OMX_FALSE);
+  base_clock_port_Constructor(openmaxStandComp, &omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX], 2, OMX_TRUE);
+  omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX]->sPortParam.bEnabled = OMX_TRUE;
 
   inPort = (omx_base_video_PortType *) omx_video_scheduler_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX];
   outPort= (omx_base_video_PortType *) omx_video_scheduler_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
@@ -149,7 +152,7 @@ OMX_ERRORTYPE omx_video_scheduler_component_Destructor(OMX_COMPONENTTYPE *openma
     if(omx_video_scheduler_component_Private->ports[i])
        omx_video_scheduler_component_Private->ports[i]->PortDestructor(omx_video_scheduler_component_Private->ports[i]);
     }
-    free(omx_video_scheduler_component_Private->ports);
+    omx_base_component_FreeStorage(openmaxStandComp, omx_video_scheduler_component_Private->ports);
     omx_video_scheduler_component_Private->ports=NULL;
   }
 
@@ -167,16 +170,12 @@ OMX_ERRORTYPE omx_video_scheduler_component_Destructor(OMX_COMPONENTTYPE *openma
  */
 OMX_ERRORTYPE omx_video_scheduler_component_port_SendBufferFunction(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer) {
 
-  OMX_ERRORTYPE                   err;
   int                             errQue;
   OMX_U32                         portIndex;
   OMX_COMPONENTTYPE*              omxComponent = openmaxStandPort->standCompContainer;
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)omxComponent->pComponentPrivate;
   OMX_BOOL                        SendFrame;
   omx_base_clock_PortType*        pClockPort;
-#if NO_GST_OMX_PATCH
-  unsigned int i;
-#endif
 
   portIndex = (openmaxStandPort->sPortParam.eDir == OMX_DirInput)?pBuffer->nInputPortIndex:pBuffer->nOutputPortIndex;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s portIndex %lu\n", __func__, portIndex);
@@ -205,28 +204,11 @@ OMX_ERRORTYPE omx_video_scheduler_component_port_SendBufferFunction(omx_base_Por
     return OMX_ErrorIncorrectStateOperation;
   }
 
-  /* Temporarily disable this check for gst-openmax */
-#if NO_GST_OMX_PATCH
-  {
-  OMX_BOOL foundBuffer = OMX_FALSE;
-  if(pBuffer!=NULL && pBuffer->pBuffer!=NULL) {
-    for(i=0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++){
-    if (pBuffer->pBuffer == openmaxStandPort->pInternalBufferStorage[i]->pBuffer) {
-      foundBuffer = OMX_TRUE;
-      break;
-    }
-    }
-  }
-  if (!foundBuffer) {
+  /* The header must be one of the headers handed out by this port */
+  if (base_port_GetBufferSlot(openmaxStandPort, pBuffer) < 0) {
+    DEBUG(DEB_LEV_ERR, "In %s: received unknown buffer header %p on port %d\n", __func__, pBuffer, (int)portIndex);
     return OMX_ErrorBadParameter;
   }
-  }
-#endif
-
-  if ((err = checkHeader(pBuffer, sizeof(OMX_BUFFERHEADERTYPE))) != OMX_ErrorNone) {
-    DEBUG(DEB_LEV_ERR, "In %s: received wrong buffer header on input port\n", __func__);
-    return err;
-  }
 
   pClockPort  = (omx_base_clock_PortType*)omx_base_component_Private->ports[CLOCKPORT_INDEX];
   if(PORT_IS_TUNNELED(pClockPort) && !PORT_IS_BEING_FLUSHED(openmaxStandPort) &&
@@ -23,8 +23,596 @@
 
 */
 
+#define _GNU_SOURCE
 #include "content_pipe_file.h"
 
+/** Unmaps a window of the file and frees it */
+static void unmapWindow(file_pipe_window* pWindow)
+{
+  munmap(pWindow->pBase, pWindow->nLength);
+  free(pWindow);
+}
+
+/** Unmaps all the windows of the pipe, the ones with buffers still out included */
+static void unmapAllWindows(file_ContentPipe* pFilePipe)
+{
+  file_pipe_window* pWindow;
+
+  if(NULL != pFilePipe->pWindow) {
+    unmapWindow(pFilePipe->pWindow);
+    pFilePipe->pWindow = NULL;
+  }
+  while(NULL != pFilePipe->pRetired) {
+    pWindow = pFilePipe->pRetired;
+    pFilePipe->pRetired = pWindow->pNext;
+    unmapWindow(pWindow);
+  }
+}
+
+/** Reads again the size of the file, that may have grown since it was opened */
+static CPresult refreshFileSize(file_ContentPipe* pFilePipe)
+{
+  struct stat sStat;
+
+  if(-1 == fstat(pFilePipe->fd, &sStat)) {
+    return KD_EIO;
+  }
+  pFilePipe->nFileSize = sStat.st_size;
+  return 0;
+}
+
+/** Maps a new window starting at the page of the current position, long enough
+ * for nSize bytes. The window it replaces is unmapped at once if none of its
+ * buffers is out, and retired otherwise.
+ */
+static CPresult slideWindow(file_ContentPipe* pFilePipe, size_t nSize)
+{
+  file_pipe_window* pWindow = pFilePipe->pWindow;
+  off_t nOffset = pFilePipe->nPosition & ~((off_t) pFilePipe->nPageSize - 1);
+  size_t nLength = FILE_PIPE_WINDOW_SIZE;
+  void* pBase;
+
+  if(nLength < (size_t) (pFilePipe->nPosition - nOffset) + nSize) {
+    nLength = (size_t) (pFilePipe->nPosition - nOffset) + nSize;
+  }
+  /* the pages past the end of the file can not be accessed */
+  if(nLength > (size_t) (pFilePipe->nFileSize - nOffset)) {
+    nLength = (size_t) (pFilePipe->nFileSize - nOffset);
+  }
+
+  pBase = mmap(NULL, nLength, PROT_READ, MAP_SHARED, pFilePipe->fd, nOffset);
+  if(MAP_FAILED == pBase) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_file: mmap of %i bytes failed\n", (int) nLength);
+    return KD_ENOMEM;
+  }
+  madvise(pBase, nLength, MADV_SEQUENTIAL);
+  madvise(pBase, nLength, MADV_WILLNEED);
+
+  if(NULL != pWindow) {
+    if(0 == pWindow->nBuffers) {
+      munmap(pWindow->pBase, pWindow->nLength);
+    } else {
+      pFilePipe->pWindow = NULL;
+      pWindow->pNext = pFilePipe->pRetired;
+      pFilePipe->pRetired = pWindow;
+      pWindow = NULL;
+    }
+  }
+  if(NULL == pWindow) {
+    pWindow = (file_pipe_window*) calloc(1, sizeof(file_pipe_window));
+    if(NULL == pWindow) {
+      munmap(pBase, nLength);
+      return KD_ENOMEM;
+    }
+    pFilePipe->pWindow = pWindow;
+  }
+  pWindow->pBase = (CPbyte*) pBase;
+  pWindow->nOffset = nOffset;
+  pWindow->nLength = nLength;
+  pWindow->nBuffers = 0;
+  pWindow->pNext = NULL;
+
+  return 0;
+}
+
+/** Assigns the blocks of the read-ahead to the ones following the position.
+ * The blocks already there are kept, the others are emptied so that the
+ * read-ahead thread reads them, and the reads in flight for them are dropped.
+ * Called with the read-ahead mutex held.
+ */
+static void readAheadMove(file_ContentPipe* pFilePipe, off_t nPosition)
+{
+  off_t nBlockSize = (off_t) pFilePipe->nBlockSize;
+  file_pipe_block* pBlock;
+  off_t nOffset;
+  int i;
+
+  pFilePipe->nBase = nPosition - nPosition % nBlockSize;
+  for(i = 0; i < pFilePipe->nBlocks; i++) {
+    nOffset = pFilePipe->nBase + i * nBlockSize;
+    pBlock = &pFilePipe->pBlocks[(nOffset / nBlockSize) % pFilePipe->nBlocks];
+    if(pBlock->nOffset != nOffset) {
+      pBlock->nOffset = nOffset;
+      pBlock->nLength = 0;
+      pBlock->eState = FILE_BLOCK_EMPTY;
+    }
+  }
+  pthread_cond_broadcast(&pFilePipe->blockCond);
+}
+
+/** Counts the bytes from the position, up to nSize, that are in the blocks
+ * already read, and tells whether the end of the file is among them.
+ * Called with the read-ahead mutex held.
+ */
+static size_t readAheadReady(file_ContentPipe* pFilePipe, off_t nPosition, size_t nSize, int* pbEnd)
+{
+  off_t nBlockSize = (off_t) pFilePipe->nBlockSize;
+  off_t nEnd = pFilePipe->nBase + pFilePipe->nBlocks * nBlockSize;
+  file_pipe_block* pBlock;
+  size_t nReady = 0;
+  off_t nOffset, nPos;
+
+  *pbEnd = 0;
+  while(nReady < nSize) {
+    nPos = nPosition + (off_t) nReady;
+    nOffset = nPos - nPos % nBlockSize;
+    if(nOffset < pFilePipe->nBase || nOffset >= nEnd)
+      break;
+    pBlock = &pFilePipe->pBlocks[(nOffset / nBlockSize) % pFilePipe->nBlocks];
+    if(pBlock->nOffset != nOffset || FILE_BLOCK_READY != pBlock->eState)
+      break;
+    if(nPos - nOffset >= (off_t) pBlock->nLength) {
+      *pbEnd = 1;
+      break;
+    }
+    nReady += pBlock->nLength - (size_t) (nPos - nOffset);
+  }
+
+  return nReady < nSize ? nReady : nSize;
+}
+
+/** Reads the empty blocks of the read-ahead, the nearest to the position
+ * first, and notifies the client waiting for them
+ */
+static void* readAheadThread(void* param)
+{
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) param;
+  off_t nBlockSize = (off_t) pFilePipe->nBlockSize;
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+  file_pipe_block* pBlock;
+  off_t nOffset = 0;
+  ssize_t count;
+  CPuint nNotify;
+  int i, bEnd;
+
+  pthread_mutex_lock(&pFilePipe->blockMutex);
+  while(!pFilePipe->bStopBlocks) {
+    pBlock = NULL;
+    for(i = 0; i < pFilePipe->nBlocks && NULL == pBlock; i++) {
+      nOffset = pFilePipe->nBase + i * nBlockSize;
+      pBlock = &pFilePipe->pBlocks[(nOffset / nBlockSize) % pFilePipe->nBlocks];
+      if(FILE_BLOCK_EMPTY != pBlock->eState)
+        pBlock = NULL;
+    }
+    if(NULL == pBlock) {
+      pthread_cond_wait(&pFilePipe->blockCond, &pFilePipe->blockMutex);
+      continue;
+    }
+
+    pBlock->eState = FILE_BLOCK_LOADING;
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+    count = pread(pFilePipe->fd, pBlock->pData, pFilePipe->nBlockSize, nOffset);
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+
+    /* the block may have been moved by a seek while it was read */
+    if(FILE_BLOCK_LOADING == pBlock->eState && nOffset == pBlock->nOffset) {
+      if(-1 == count) {
+        DEBUG(DEB_LEV_ERR, "content_pipe_file: read ahead at %lli failed\n", (long long) nOffset);
+        count = 0;
+      }
+      pBlock->nLength = (size_t) count;
+      pBlock->eState = FILE_BLOCK_READY;
+      pthread_cond_broadcast(&pFilePipe->blockCond);
+    }
+
+    nNotify = 0;
+    if(0 != pFilePipe->nBytesWaited &&
+       (readAheadReady(pFilePipe, pFilePipe->nWaitedPosition, pFilePipe->nBytesWaited, &bEnd) == pFilePipe->nBytesWaited || bEnd)) {
+      nNotify = pFilePipe->nBytesWaited;
+      pFilePipe->nBytesWaited = 0;
+    }
+    ClientCallback = pFilePipe->ClientCallback;
+    if(0 != nNotify && NULL != ClientCallback) {
+      pthread_mutex_unlock(&pFilePipe->blockMutex);
+      ClientCallback(CP_BytesAvailable, nNotify);
+      pthread_mutex_lock(&pFilePipe->blockMutex);
+    }
+  }
+  pthread_mutex_unlock(&pFilePipe->blockMutex);
+
+  return NULL;
+}
+
+/** Stops the thread of the blocks and frees them */
+static void blocksStop(file_ContentPipe* pFilePipe)
+{
+  int i;
+
+  if(FILE_BLOCKS_NONE == pFilePipe->eBlocks)
+    return;
+
+  pthread_mutex_lock(&pFilePipe->blockMutex);
+  pFilePipe->bStopBlocks = 1;
+  pthread_cond_broadcast(&pFilePipe->blockCond);
+  pthread_mutex_unlock(&pFilePipe->blockMutex);
+  pthread_join(pFilePipe->blockThread, NULL);
+
+  for(i = 0; i < pFilePipe->nBlocks; i++)
+    free(pFilePipe->pBlocks[i].pData);
+  free(pFilePipe->pBlocks);
+  pFilePipe->pBlocks = NULL;
+  pFilePipe->nBlocks = 0;
+  pFilePipe->eBlocks = FILE_BLOCKS_NONE;
+  pthread_cond_destroy(&pFilePipe->blockCond);
+  pthread_mutex_destroy(&pFilePipe->blockMutex);
+}
+
+/** Allocates the blocks, aligned on pages, and starts their thread. When they
+ * can not be allocated the pipe reads and writes synchronously.
+ */
+static CPresult blocksStart(file_ContentPipe* pFilePipe, file_pipe_blocks_mode eBlocks, int nBlocks, size_t nBlockSize, void* (*thread)(void*))
+{
+  int i;
+
+  pFilePipe->nBlockSize = (nBlockSize + pFilePipe->nPageSize - 1) & ~((size_t) pFilePipe->nPageSize - 1);
+  pFilePipe->pBlocks = (file_pipe_block*) calloc(nBlocks, sizeof(file_pipe_block));
+  if(NULL == pFilePipe->pBlocks)
+    return KD_ENOMEM;
+  for(i = 0; i < nBlocks; i++) {
+    pFilePipe->pBlocks[i].nOffset = -1;
+    if(0 != posix_memalign((void**) &pFilePipe->pBlocks[i].pData, pFilePipe->nPageSize, pFilePipe->nBlockSize))
+      break;
+  }
+  pFilePipe->nBlocks = i;
+  pFilePipe->bStopBlocks = 0;
+  pthread_mutex_init(&pFilePipe->blockMutex, NULL);
+  pthread_cond_init(&pFilePipe->blockCond, NULL);
+
+  if(i < nBlocks || 0 != pthread_create(&pFilePipe->blockThread, NULL, thread, pFilePipe)) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_file: %i blocks not started\n", nBlocks);
+    while(--i >= 0)
+      free(pFilePipe->pBlocks[i].pData);
+    free(pFilePipe->pBlocks);
+    pFilePipe->pBlocks = NULL;
+    pFilePipe->nBlocks = 0;
+    pthread_cond_destroy(&pFilePipe->blockCond);
+    pthread_mutex_destroy(&pFilePipe->blockMutex);
+    return KD_ENOMEM;
+  }
+  pFilePipe->eBlocks = eBlocks;
+
+  return 0;
+}
+
+/** Starts the read-ahead if FILE_PIPE_READAHEAD_ENV asks for it */
+static void readAheadStart(file_ContentPipe* pFilePipe)
+{
+  const char* config = getenv(FILE_PIPE_READAHEAD_ENV);
+  const char* size;
+  size_t nBlockSize = FILE_PIPE_BLOCK_SIZE;
+  int nBlocks;
+
+  if(NULL == config || (nBlocks = atoi(config)) <= 0)
+    return;
+
+  size = strchr(config, ',');
+  if(NULL != size && atoi(size + 1) > 0)
+    nBlockSize = (size_t) atoi(size + 1) * 1024;
+
+  pFilePipe->nBytesWaited = 0;
+  if(0 != blocksStart(pFilePipe, FILE_BLOCKS_READAHEAD, nBlocks, nBlockSize, readAheadThread))
+    return;
+
+  pthread_mutex_lock(&pFilePipe->blockMutex);
+  readAheadMove(pFilePipe, pFilePipe->nPosition);
+  pthread_mutex_unlock(&pFilePipe->blockMutex);
+}
+
+/** Moves the read-ahead to a position set by other means than Read */
+static void readAheadSeek(file_ContentPipe* pFilePipe)
+{
+  if(FILE_BLOCKS_READAHEAD != pFilePipe->eBlocks)
+    return;
+
+  pthread_mutex_lock(&pFilePipe->blockMutex);
+  pFilePipe->nBytesWaited = 0;
+  if(pFilePipe->nPosition - pFilePipe->nPosition % (off_t) pFilePipe->nBlockSize != pFilePipe->nBase)
+    readAheadMove(pFilePipe, pFilePipe->nPosition);
+  pthread_mutex_unlock(&pFilePipe->blockMutex);
+}
+
+/** Copies the data from the blocks read ahead, waiting only for the ones
+ * not read yet
+ */
+static CPresult readAheadRead(file_ContentPipe* pFilePipe, CPbyte *pData, size_t nSize)
+{
+  off_t nBlockSize = (off_t) pFilePipe->nBlockSize;
+  file_pipe_block* pBlock;
+  size_t nCopied = 0, nCount;
+  off_t nOffset;
+
+  pthread_mutex_lock(&pFilePipe->blockMutex);
+  while(nCopied < nSize) {
+    nOffset = pFilePipe->nPosition - pFilePipe->nPosition % nBlockSize;
+    if(nOffset != pFilePipe->nBase)
+      readAheadMove(pFilePipe, pFilePipe->nPosition);
+    pBlock = &pFilePipe->pBlocks[(nOffset / nBlockSize) % pFilePipe->nBlocks];
+    while(FILE_BLOCK_READY != pBlock->eState)
+      pthread_cond_wait(&pFilePipe->blockCond, &pFilePipe->blockMutex);
+    if(pFilePipe->nPosition - nOffset >= (off_t) pBlock->nLength)
+      break;  /* end of file */
+
+    nCount = pBlock->nLength - (size_t) (pFilePipe->nPosition - nOffset);
+    if(nCount > nSize - nCopied)
+      nCount = nSize - nCopied;
+    /* only the client moves the blocks already read, so they can be copied unlocked */
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+    memcpy(pData + nCopied, pBlock->pData + (pFilePipe->nPosition - nOffset), nCount);
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    pFilePipe->nPosition += nCount;
+    nCopied += nCount;
+  }
+  pthread_mutex_unlock(&pFilePipe->blockMutex);
+
+  return nCopied < nSize ? KD_EIO : 0;
+}
+
+/** Tells whether the bytes requested are in the blocks already read. When they
+ * are not, the client is notified with CP_BytesAvailable once they are, or at
+ * once with CP_Overflow when they do not fit in the blocks of the read-ahead.
+ */
+static CPresult readAheadCheckAvailableBytes(file_ContentPipe* pFilePipe, CPuint nBytesRequested, CP_CHECKBYTESRESULTTYPE *eResult)
+{
+  size_t nReady, nCapacity;
+  int bEnd;
+
+  if(pFilePipe->nPosition + (off_t) nBytesRequested > pFilePipe->nFileSize && 0 != refreshFileSize(pFilePipe))
+    return KD_EIO;
+  if(pFilePipe->nPosition + (off_t) nBytesRequested > pFilePipe->nFileSize) {
+    *eResult = (pFilePipe->nPosition >= pFilePipe->nFileSize) ? CP_CheckBytesAtEndOfStream : CP_CheckBytesInsufficientBytes;
+    return 0;
+  }
+
+  pthread_mutex_lock(&pFilePipe->blockMutex);
+  if(pFilePipe->nPosition - pFilePipe->nPosition % (off_t) pFilePipe->nBlockSize != pFilePipe->nBase)
+    readAheadMove(pFilePipe, pFilePipe->nPosition);
+  nReady = readAheadReady(pFilePipe, pFilePipe->nPosition, nBytesRequested, &bEnd);
+  nCapacity = (size_t) (pFilePipe->nBase + pFilePipe->nBlocks * (off_t) pFilePipe->nBlockSize - pFilePipe->nPosition);
+
+  if(nReady == nBytesRequested) {
+    *eResult = CP_CheckBytesOk;
+  } else if(bEnd) {
+    *eResult = (0 == nReady) ? CP_CheckBytesAtEndOfStream : CP_CheckBytesInsufficientBytes;
+  } else if(nBytesRequested > nCapacity) {
+    *eResult = CP_CheckBytesOutOfBuffers;
+  } else {
+    *eResult = CP_CheckBytesNotReady;
+    pFilePipe->nBytesWaited = nBytesRequested;
+    pFilePipe->nWaitedPosition = pFilePipe->nPosition;
+  }
+  pthread_mutex_unlock(&pFilePipe->blockMutex);
+
+  if(CP_CheckBytesOutOfBuffers == *eResult && NULL != pFilePipe->ClientCallback)
+    pFilePipe->ClientCallback(CP_Overflow, (CPuint) nCapacity);
+
+  return 0;
+}
+
+/** Writes the full blocks in the order they were filled. The consecutive ones
+ * are written at once, with O_DIRECT when they are aligned and it was asked for.
+ */
+static void* writeBehindThread(void* param)
+{
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) param;
+  int nMax = pFilePipe->nBlocks < IOV_MAX ? pFilePipe->nBlocks : IOV_MAX;
+  struct iovec* pIov = (struct iovec*) malloc(nMax * sizeof(struct iovec));
+  size_t nAlign = (size_t) pFilePipe->nPageSize - 1;
+  file_pipe_block* pBlock;
+  off_t nOffset;
+  size_t nBytes;
+  ssize_t count;
+  CPresult err;
+  int i, n, bDirect, bAligned;
+
+  pthread_mutex_lock(&pFilePipe->blockMutex);
+  while(NULL != pIov) {
+    pBlock = &pFilePipe->pBlocks[pFilePipe->nWrite];
+    if(FILE_BLOCK_FULL != pBlock->eState) {
+      if(pFilePipe->bStopBlocks)
+        break;
+      pthread_cond_wait(&pFilePipe->blockCond, &pFilePipe->blockMutex);
+      continue;
+    }
+
+    nOffset = pBlock->nOffset;
+    nBytes = 0;
+    bDirect = 0;
+    for(n = 0, i = pFilePipe->nWrite; n < nMax; n++, i = (i + 1) % pFilePipe->nBlocks) {
+      pBlock = &pFilePipe->pBlocks[i];
+      if(FILE_BLOCK_FULL != pBlock->eState || nOffset + (off_t) nBytes != pBlock->nOffset)
+        break;
+      bAligned = -1 != pFilePipe->fdDirect && 0 == ((size_t) pBlock->nOffset & nAlign) && 0 == (pBlock->nLength & nAlign);
+      if(0 == n)
+        bDirect = bAligned;
+      else if(bAligned != bDirect)
+        break;
+      pIov[n].iov_base = pBlock->pData;
+      pIov[n].iov_len = pBlock->nLength;
+      pBlock->eState = FILE_BLOCK_WRITING;
+      nBytes += pBlock->nLength;
+    }
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+
+    err = 0;
+    count = pwritev(bDirect ? pFilePipe->fdDirect : pFilePipe->fd, pIov, n, nOffset);
+    if(count != (ssize_t) nBytes) {
+      DEBUG(DEB_LEV_ERR, "content_pipe_file: write behind at %lli failed\n", (long long) nOffset);
+      err = KD_EIO;
+    }
+    pFilePipe->nUnsynced += nBytes;
+    if(0 == err && 0 != pFilePipe->nSyncBytes && pFilePipe->nUnsynced >= pFilePipe->nSyncBytes) {
+      if(-1 == fdatasync(pFilePipe->fd))
+        err = KD_EIO;
+      pFilePipe->nUnsynced = 0;
+    }
+
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    if(0 != err && 0 == pFilePipe->nWriteError)
+      pFilePipe->nWriteError = err;
+    for(i = 0; i < n; i++) {
+      pFilePipe->pBlocks[pFilePipe->nWrite].eState = FILE_BLOCK_EMPTY;
+      pFilePipe->nWrite = (pFilePipe->nWrite + 1) % pFilePipe->nBlocks;
+    }
+    pthread_cond_broadcast(&pFilePipe->blockCond);
+  }
+  pthread_mutex_unlock(&pFilePipe->blockMutex);
+  free(pIov);
+
+  return NULL;
+}
+
+/** Starts the write-behind if FILE_PIPE_WRITEBEHIND_ENV asks for it */
+static void writeBehindStart(file_ContentPipe* pFilePipe, const char* pathname)
+{
+  const char* config = getenv(FILE_PIPE_WRITEBEHIND_ENV);
+  const char* token;
+  size_t nBlockSize = FILE_PIPE_BLOCK_SIZE;
+  int nBlocks = FILE_PIPE_WRITEBEHIND_BLOCKS;
+  int bDirect = 0;
+
+  if(NULL == config)
+    return;
+
+  pFilePipe->nSyncBytes = 0;
+  for(token = config; token && *token; token = strchr(token, ',')) {
+    if(*token == ',')
+      token++;
+    if(0 == strncmp(token, "blocks=", 7)) {
+      nBlocks = atoi(token + 7);
+    } else if(0 == strncmp(token, "size=", 5) && atoi(token + 5) > 0) {
+      nBlockSize = (size_t) atoi(token + 5) * 1024;
+    } else if(0 == strncmp(token, "sync=", 5) && atoi(token + 5) > 0) {
+      pFilePipe->nSyncBytes = (size_t) atoi(token + 5) * 1024 * 1024;
+    } else if(0 == strncmp(token, "direct", 6)) {
+      bDirect = 1;
+    }
+  }
+  if(nBlocks <= 0)
+    return;
+
+  /* the blocks not aligned, as the last one, go through the page cache */
+  pFilePipe->fdDirect = -1;
+  if(bDirect) {
+    pFilePipe->fdDirect = open(pathname, O_WRONLY | O_DIRECT);
+    if(-1 == pFilePipe->fdDirect)
+      DEBUG(DEB_LEV_ERR, "content_pipe_file: O_DIRECT not supported for %s\n", pathname);
+  }
+  pFilePipe->nFill = 0;
+  pFilePipe->nWrite = 0;
+  pFilePipe->nUnsynced = 0;
+  pFilePipe->nWriteError = 0;
+  if(0 != blocksStart(pFilePipe, FILE_BLOCKS_WRITEBEHIND, nBlocks, nBlockSize, writeBehindThread) &&
+     -1 != pFilePipe->fdDirect) {
+    close(pFilePipe->fdDirect);
+    pFilePipe->fdDirect = -1;
+  }
+}
+
+/** Gives the block the client fills, waiting for the write-behind thread to
+ * free one when they are all full. Called with the block mutex held.
+ */
+static file_pipe_block* writeBehindFill(file_ContentPipe* pFilePipe)
+{
+  file_pipe_block* pBlock = &pFilePipe->pBlocks[pFilePipe->nFill];
+
+  if(FILE_BLOCK_FILLING != pBlock->eState) {
+    while(FILE_BLOCK_EMPTY != pBlock->eState)
+      pthread_cond_wait(&pFilePipe->blockCond, &pFilePipe->blockMutex);
+    pBlock->eState = FILE_BLOCK_FILLING;
+    pBlock->nOffset = pFilePipe->nPosition;
+    pBlock->nLength = 0;
+  }
+
+  return pBlock;
+}
+
+/** Hands the block filled by the client to the write-behind thread.
+ * Called with the block mutex held.
+ */
+static void writeBehindQueue(file_ContentPipe* pFilePipe)
+{
+  file_pipe_block* pBlock = &pFilePipe->pBlocks[pFilePipe->nFill];
+
+  if(FILE_BLOCK_FILLING != pBlock->eState)
+    return;
+  if(0 == pBlock->nLength) {
+    pBlock->eState = FILE_BLOCK_EMPTY;
+    return;
+  }
+  pBlock->eState = FILE_BLOCK_FULL;
+  pFilePipe->nFill = (pFilePipe->nFill + 1) % pFilePipe->nBlocks;
+  pthread_cond_broadcast(&pFilePipe->blockCond);
+}
+
+/** Writes all the data given by the client, and returns the first error of
+ * the write-behind. Called with the block mutex held.
+ */
+static CPresult writeBehindFlush(file_ContentPipe* pFilePipe)
+{
+  int i;
+
+  writeBehindQueue(pFilePipe);
+  for(i = 0; i < pFilePipe->nBlocks; i++) {
+    while(FILE_BLOCK_EMPTY != pFilePipe->pBlocks[i].eState)
+      pthread_cond_wait(&pFilePipe->blockCond, &pFilePipe->blockMutex);
+  }
+
+  return pFilePipe->nWriteError;
+}
+
+/** Copies the data in the blocks written behind, waiting only when they are all full */
+static CPresult writeBehindWrite(file_ContentPipe* pFilePipe, CPbyte *pData, size_t nSize)
+{
+  file_pipe_block* pBlock;
+  CPresult err;
+  size_t nCount;
+
+  pthread_mutex_lock(&pFilePipe->blockMutex);
+  err = pFilePipe->nWriteError;
+  while(0 == err && 0 != nSize) {
+    pBlock = writeBehindFill(pFilePipe);
+    nCount = pFilePipe->nBlockSize - pBlock->nLength;
+    if(nCount > nSize)
+      nCount = nSize;
+    /* the block filled belongs to the client, it can be copied unlocked */
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+    memcpy(pBlock->pData + pBlock->nLength, pData, nCount);
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    pBlock->nLength += nCount;
+    pFilePipe->nPosition += nCount;
+    pData += nCount;
+    nSize -= nCount;
+    if(pBlock->nLength == pFilePipe->nBlockSize)
+      writeBehindQueue(pFilePipe);
+    err = pFilePipe->nWriteError;
+  }
+  if(pFilePipe->nPosition > pFilePipe->nFileSize)
+    pFilePipe->nFileSize = pFilePipe->nPosition;
+  pthread_mutex_unlock(&pFilePipe->blockMutex);
+
+  return err;
+}
+
 /** Create a content source and open it for writing. */
 static CPresult Create( CPhandle *hContent, CPstring szURI )
 {
@@ -38,12 +626,15 @@ static CPresult Create( CPhandle *hContent, CPstring szURI )
   if(0 != strncmp(szURI, "file://", 7))
     err = KD_EINVAL;
 
-  flags = O_WRONLY | O_CREAT;
+  flags = O_WRONLY | O_CREAT | O_TRUNC;
 
   if(0 == err) {
-    ret = open(pathname, flags, 0);
+    ret = open(pathname, flags, 0666);
     if(-1 != ret) {
       pFilePipe->fd = ret;
+      pFilePipe->nPosition = 0;
+      pFilePipe->nFileSize = 0;
+      writeBehindStart(pFilePipe, pathname);
     } else {
       err = KD_EIO;  /* ??? */
     }
@@ -85,6 +676,14 @@ static CPresult Open( CPhandle* hContent, CPstring szURI, CP_ACCESSTYPE eAccess
     ret = open(pathname, flags);
     if(-1 != ret) {
       pFilePipe->fd = ret;
+      pFilePipe->nPosition = 0;
+      err = refreshFileSize(pFilePipe);
+      if(CP_AccessRead == eAccess) {
+        posix_fadvise(ret, 0, 0, POSIX_FADV_SEQUENTIAL);
+        readAheadStart(pFilePipe);
+      } else if(CP_AccessWrite == eAccess) {
+        writeBehindStart(pFilePipe, pathname);
+      }
     } else {
       /* Map errno */
       err = KD_EIO;  /* ??? */
@@ -103,7 +702,27 @@ static CPresult Close( CPhandle hContent )
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
+  if(NULL != pFilePipe->pRetired || (NULL != pFilePipe->pWindow && 0 != pFilePipe->pWindow->nBuffers)) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_file: closed with read buffers not released\n");
+  }
+  unmapAllWindows(pFilePipe);
+  if(FILE_BLOCKS_WRITEBEHIND == pFilePipe->eBlocks) {
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    err = writeBehindFlush(pFilePipe);
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+    if(0 != pFilePipe->nSyncBytes && -1 == fdatasync(pFilePipe->fd))
+      err = KD_EIO;
+    if(-1 != pFilePipe->fdDirect)
+      close(pFilePipe->fdDirect);
+    pFilePipe->fdDirect = -1;
+  }
+  blocksStop(pFilePipe);
+  free(pFilePipe->pWriteBuffer);
+  pFilePipe->pWriteBuffer = NULL;
+  pFilePipe->nWriteBufferSize = 0;
+
   ret = close(pFilePipe->fd);
+  pFilePipe->fd = -1;
   if(ret == -1) {
     /* Map errno */
     err = KD_EIO;  /* ??? */
@@ -115,25 +734,111 @@ static CPresult Close( CPhandle hContent )
 /** Check the that specified number of bytes are available for reading or writing (depending on access type).*/
 static CPresult CheckAvailableBytes( CPhandle hContent, CPuint nBytesRequested, CP_CHECKBYTESRESULTTYPE *eResult )
 {
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) hContent;
+  CPresult err = 0;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  return KD_EBADF;
+  if(-1 == pFilePipe->fd)
+    return KD_EBADF;
+
+  if(FILE_BLOCKS_READAHEAD == pFilePipe->eBlocks)
+    return readAheadCheckAvailableBytes(pFilePipe, nBytesRequested, eResult);
+
+  /* a writer finds room as long as a block is not full */
+  if(FILE_BLOCKS_WRITEBEHIND == pFilePipe->eBlocks) {
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    switch(pFilePipe->pBlocks[pFilePipe->nFill].eState) {
+    case FILE_BLOCK_EMPTY:
+    case FILE_BLOCK_FILLING:
+      *eResult = CP_CheckBytesOk;
+      break;
+    default:
+      *eResult = CP_CheckBytesOutOfBuffers;
+      break;
+    }
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+    return 0;
+  }
+
+  if(pFilePipe->nPosition + (off_t) nBytesRequested > pFilePipe->nFileSize)
+    err = refreshFileSize(pFilePipe);
+
+  if(0 == err) {
+    if(pFilePipe->nPosition + (off_t) nBytesRequested <= pFilePipe->nFileSize) {
+      *eResult = CP_CheckBytesOk;
+    } else if(pFilePipe->nPosition >= pFilePipe->nFileSize) {
+      *eResult = CP_CheckBytesAtEndOfStream;
+    } else {
+      *eResult = CP_CheckBytesInsufficientBytes;
+    }
+  }
+
+  return err;
 }
 
 /** Seek to certain position in the content relative to the specified origin. */
 static CPresult SetPosition( CPhandle  hContent, CPint nOffset, CP_ORIGINTYPE eOrigin)
 {
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) hContent;
+  CPresult err = 0;
+  off_t nPosition = 0;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  return KD_EBADF;
+  if(-1 == pFilePipe->fd)
+    return KD_EBADF;
+
+  /* the blocks written behind are written where they were given */
+  if(FILE_BLOCKS_WRITEBEHIND == pFilePipe->eBlocks) {
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    err = writeBehindFlush(pFilePipe);
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+    if(0 != err)
+      return err;
+  }
+
+  switch(eOrigin) {
+  case CP_OriginBegin:
+    nPosition = nOffset;
+    break;
+  case CP_OriginCur:
+    nPosition = pFilePipe->nPosition + nOffset;
+    break;
+  case CP_OriginEnd:
+    err = refreshFileSize(pFilePipe);
+    nPosition = pFilePipe->nFileSize + nOffset;
+    break;
+  default:
+    err = KD_EINVAL;
+    break;
+  }
+
+  if(0 == err && nPosition < 0)
+    err = KD_EINVAL;
+
+  /* the mapped window is kept, the next ReadBuffer slides it if needed */
+  if(0 == err) {
+    pFilePipe->nPosition = nPosition;
+    readAheadSeek(pFilePipe);
+  }
+
+  return err;
 }
 
 /** Retrieve the current position relative to the start of the content. */
 static CPresult GetPosition( CPhandle hContent, CPuint *pPosition)
 {
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) hContent;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  return KD_EBADF;
+  if(-1 == pFilePipe->fd)
+    return KD_EBADF;
+
+  *pPosition = (CPuint) pFilePipe->nPosition;
+
+  return 0;
 }
 
 /** Retrieve data of the specified size from the content stream (advance content pointer by size of data).
@@ -146,12 +851,18 @@ static CPresult Read( CPhandle hContent, CPbyte *pData, CPuint nSize)
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  count = read(pFilePipe->fd, (void*) pData, (size_t) nSize);
+  if(FILE_BLOCKS_READAHEAD == pFilePipe->eBlocks)
+    return readAheadRead(pFilePipe, pData, nSize);
 
-  if(count < nSize) {
-    err = KD_EIO;  /* ??? */
-  } else if(count == -1) {
+  count = pread(pFilePipe->fd, (void*) pData, (size_t) nSize, pFilePipe->nPosition);
+
+  if(count == -1) {
     err = KD_EIO;  /* ??? */
+  } else {
+    pFilePipe->nPosition += count;
+    if(count < nSize) {
+      err = KD_EIO;  /* ??? */
+    }
   }
 
   return err;
@@ -168,20 +879,90 @@ static CPresult Read( CPhandle hContent, CPbyte *pData, CPuint nSize)
     block may straddle the boundary of the circular buffer. By default a pipe implementation
     performs a copy in this case to provide the block to the pipe client in one contiguous buffer.
     If, however, the client sets bForbidCopy, then the pipe returns only those bytes preceding the memory
-    boundary. Here the client may retrieve the data in segments over successive calls. */
+    boundary. Here the client may retrieve the data in segments over successive calls.
+
+    The buffer points straight into a window of the file mapped in memory, so that
+    no copy is made. The boundary is the end of the window: when a block straddles it
+    the window is slid to the block, unless bForbidCopy is set. */
 static CPresult ReadBuffer( CPhandle hContent, CPbyte **ppBuffer, CPuint *nSize, CPbool bForbidCopy)
 {
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) hContent;
+  file_pipe_window* pWindow;
+  CPresult err = 0;
+  size_t nRequested = *nSize;
+  size_t nAvailable = 0;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  return KD_EBADF;
+  if(-1 == pFilePipe->fd)
+    return KD_EBADF;
+
+  if(pFilePipe->nPosition + (off_t) nRequested > pFilePipe->nFileSize) {
+    err = refreshFileSize(pFilePipe);
+    if(0 != err)
+      return err;
+  }
+  if(pFilePipe->nPosition >= pFilePipe->nFileSize) {
+    *nSize = 0;
+    return KD_EIO;
+  }
+  if(pFilePipe->nPosition + (off_t) nRequested > pFilePipe->nFileSize)
+    nRequested = (size_t) (pFilePipe->nFileSize - pFilePipe->nPosition);
+
+  pWindow = pFilePipe->pWindow;
+  if(NULL != pWindow && pFilePipe->nPosition >= pWindow->nOffset &&
+     pFilePipe->nPosition < pWindow->nOffset + (off_t) pWindow->nLength) {
+    nAvailable = (size_t) (pWindow->nOffset + (off_t) pWindow->nLength - pFilePipe->nPosition);
+  }
+
+  if(nAvailable < nRequested) {
+    if(bForbidCopy && 0 != nAvailable) {
+      nRequested = nAvailable;
+    } else {
+      err = slideWindow(pFilePipe, nRequested);
+      if(0 != err) {
+        *nSize = 0;
+        return err;
+      }
+      pWindow = pFilePipe->pWindow;
+    }
+  }
+
+  *ppBuffer = pWindow->pBase + (pFilePipe->nPosition - pWindow->nOffset);
+  *nSize = (CPuint) nRequested;
+  pWindow->nBuffers++;
+  pFilePipe->nPosition += nRequested;
+  readAheadSeek(pFilePipe);
+
+  return 0;
 }
 
 /** Release a buffer obtained by ReadBuffer back to the pipe. */
 static CPresult ReleaseReadBuffer(CPhandle hContent, CPbyte *pBuffer)
 {
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) hContent;
+  file_pipe_window* pWindow = pFilePipe->pWindow;
+  file_pipe_window** ppPrev;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  return KD_EBADF;
+  if(NULL != pWindow && pBuffer >= pWindow->pBase && pBuffer < pWindow->pBase + pWindow->nLength) {
+    pWindow->nBuffers--;
+    return 0;
+  }
+
+  for(ppPrev = &pFilePipe->pRetired; NULL != *ppPrev; ppPrev = &(*ppPrev)->pNext) {
+    pWindow = *ppPrev;
+    if(pBuffer >= pWindow->pBase && pBuffer < pWindow->pBase + pWindow->nLength) {
+      if(0 == --pWindow->nBuffers) {
+        *ppPrev = pWindow->pNext;
+        unmapWindow(pWindow);
+      }
+      return 0;
+    }
+  }
+
+  return KD_EINVAL;
 }
 
 /** Write data of the specified size to the content (advance content pointer by size of data).
@@ -194,12 +975,20 @@ static CPresult Write( CPhandle hContent, CPbyte *pData, CPuint nSize)
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  ret = write(pFilePipe->fd, (void*) pData, (size_t) nSize);
+  if(FILE_BLOCKS_WRITEBEHIND == pFilePipe->eBlocks)
+    return writeBehindWrite(pFilePipe, pData, nSize);
 
-  if(ret < nSize) {
-    err = KD_EIO;  /* ??? */
-  } else if(ret == -1) {
+  ret = pwrite(pFilePipe->fd, (void*) pData, (size_t) nSize, pFilePipe->nPosition);
+
+  if(ret == -1) {
     err = KD_EIO;  /* ??? */
+  } else {
+    pFilePipe->nPosition += ret;
+    if(pFilePipe->nPosition > pFilePipe->nFileSize)
+      pFilePipe->nFileSize = pFilePipe->nPosition;
+    if(ret < nSize) {
+      err = KD_EIO;  /* ??? */
+    }
   }
 
   return err;
@@ -207,29 +996,102 @@ static CPresult Write( CPhandle hContent, CPbyte *pData, CPuint nSize)
 
 /** Retrieve a buffer allocated by the pipe used to write data to the content.
     Client will fill buffer with output data. Note: pipe provides pointer. This function is appropriate
-    for large writes. The client must call WriteBuffer when done it has filled the buffer with data.*/
+    for large writes. The client must call WriteBuffer when done it has filled the buffer with data.
+
+    With the write-behind on, the buffer is taken from the block being filled, so that it is
+    written with the data around it, and can not be larger than a block. */
 static CPresult GetWriteBuffer( CPhandle hContent, CPbyte **ppBuffer, CPuint nSize)
 {
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) hContent;
+  file_pipe_block* pBlock;
+  CPbyte* pWriteBuffer;
+  CPresult err = 0;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  return KD_EBADF;
+  if(-1 == pFilePipe->fd)
+    return KD_EBADF;
+
+  if(FILE_BLOCKS_WRITEBEHIND == pFilePipe->eBlocks) {
+    if(nSize > pFilePipe->nBlockSize)
+      return KD_EINVAL;
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    pBlock = &pFilePipe->pBlocks[pFilePipe->nFill];
+    if(FILE_BLOCK_FILLING == pBlock->eState && pFilePipe->nBlockSize - pBlock->nLength < nSize)
+      writeBehindQueue(pFilePipe);
+    pBlock = writeBehindFill(pFilePipe);
+    *ppBuffer = pBlock->pData + pBlock->nLength;
+    err = pFilePipe->nWriteError;
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+    return err;
+  }
+
+  if(nSize > pFilePipe->nWriteBufferSize) {
+    pWriteBuffer = (CPbyte*) realloc(pFilePipe->pWriteBuffer, nSize);
+    if(NULL == pWriteBuffer)
+      return KD_ENOMEM;
+    pFilePipe->pWriteBuffer = pWriteBuffer;
+    pFilePipe->nWriteBufferSize = nSize;
+  }
+  *ppBuffer = pFilePipe->pWriteBuffer;
+
+  return err;
 }
 
 /** Deliver a buffer obtained via GetWriteBuffer to the pipe. Pipe will write the
     the contents of the buffer to content and advance content pointer by the size of the buffer */
 static CPresult WriteBuffer( CPhandle hContent, CPbyte *pBuffer, CPuint nFilledSize)
 {
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) hContent;
+  file_pipe_block* pBlock;
+  CPresult err = 0;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  return KD_EBADF;
+  if(-1 == pFilePipe->fd)
+    return KD_EBADF;
+
+  if(FILE_BLOCKS_WRITEBEHIND == pFilePipe->eBlocks) {
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    pBlock = &pFilePipe->pBlocks[pFilePipe->nFill];
+    if(FILE_BLOCK_FILLING != pBlock->eState || pBuffer != pBlock->pData + pBlock->nLength ||
+       nFilledSize > pFilePipe->nBlockSize - pBlock->nLength) {
+      err = KD_EINVAL;
+    } else {
+      pBlock->nLength += nFilledSize;
+      pFilePipe->nPosition += nFilledSize;
+      if(pFilePipe->nPosition > pFilePipe->nFileSize)
+        pFilePipe->nFileSize = pFilePipe->nPosition;
+      if(pBlock->nLength == pFilePipe->nBlockSize)
+        writeBehindQueue(pFilePipe);
+      err = pFilePipe->nWriteError;
+    }
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+    return err;
+  }
+
+  if(NULL == pBuffer || pBuffer != pFilePipe->pWriteBuffer)
+    return KD_EINVAL;
+
+  return Write(hContent, pBuffer, nFilledSize);
 }
 
 /** Register a per-handle client callback with the content pipe. */
 static CPresult RegisterCallback( CPhandle hContent, CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam))
 {
+  file_ContentPipe* pFilePipe = (file_ContentPipe*) hContent;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_file:%s \n", __func__);
 
-  return KD_EBADF;
+  if(FILE_BLOCKS_NONE != pFilePipe->eBlocks) {
+    pthread_mutex_lock(&pFilePipe->blockMutex);
+    pFilePipe->ClientCallback = ClientCallback;
+    pthread_mutex_unlock(&pFilePipe->blockMutex);
+  } else {
+    pFilePipe->ClientCallback = ClientCallback;
+  }
+
+  return 0;
 }
 
 CPresult file_pipe_Constructor(CP_PIPETYPE **ppPipe, CPstring szURI)
@@ -255,6 +1117,8 @@ CPresult file_pipe_Constructor(CP_PIPETYPE **ppPipe, CPstring szURI)
     pFilePipe->pipe.RegisterCallback = RegisterCallback;
 
     pFilePipe->fd = -1; /* An invalid value */
+    pFilePipe->fdDirect = -1;
+    pFilePipe->nPageSize = sysconf(_SC_PAGESIZE);
 
     *ppPipe = (CP_PIPETYPE*) pFilePipe;
   }
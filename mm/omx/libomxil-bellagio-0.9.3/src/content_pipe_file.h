@@ -31,12 +31,91 @@
 #include <malloc.h>
 #include <string.h>
 #include <fcntl.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include <OMX_Types.h>
 #include <OMX_ContentPipe.h>
 
 #include "omx_comp_debug_levels.h"
 
+/** Length of the window of the file mapped by ReadBuffer. The window slides
+ * along the file as it is read, and is made larger only for the requests that
+ * do not fit in it.
+ */
+#define FILE_PIPE_WINDOW_SIZE (4 * 1024 * 1024)
+
+/** A region of the file mapped in memory, and the count of the buffers
+ * returned by ReadBuffer that still point into it. A window that slid away
+ * while some of its buffers were still out is kept until they are released.
+ */
+typedef struct file_pipe_window {
+  CPbyte* pBase;
+  off_t nOffset;
+  size_t nLength;
+  int nBuffers;
+  struct file_pipe_window* pNext;
+} file_pipe_window;
+
+/** The environment variable that turns the read-ahead of the files opened for
+ * reading on, as "blocks" or "blocks,size" with the size of a block in KiB.
+ * The read-ahead is off when it is not set, or set to 0 blocks.
+ *
+ * It stays off by default: a gain has not been measured. It can only help
+ * a reader slower than the disk, with a spare core for the thread reading
+ * ahead; with the file in the page cache it costs more than it saves.
+ */
+#define FILE_PIPE_READAHEAD_ENV "OMX_BELLAGIO_PIPE_READAHEAD"
+
+/** The environment variable that turns the write-behind of the files opened
+ * for writing on, as a comma separated list of blocks=value, size=value in
+ * KiB, sync=value in MiB written between two fdatasync, and direct to write
+ * the whole blocks with O_DIRECT. The write-behind is off when it is not set.
+ */
+#define FILE_PIPE_WRITEBEHIND_ENV "OMX_BELLAGIO_PIPE_WRITEBEHIND"
+
+/** Default size of the blocks read ahead or written behind, a multiple of the page size */
+#define FILE_PIPE_BLOCK_SIZE (256 * 1024)
+
+/** Default number of blocks written behind */
+#define FILE_PIPE_WRITEBEHIND_BLOCKS 8
+
+/** What the blocks of a pipe are used for, a pipe opened for reading reads
+ * them ahead and one opened for writing writes them behind
+ */
+typedef enum file_pipe_blocks_mode {
+  FILE_BLOCKS_NONE,
+  FILE_BLOCKS_READAHEAD,
+  FILE_BLOCKS_WRITEBEHIND
+} file_pipe_blocks_mode;
+
+typedef enum file_pipe_block_state {
+  FILE_BLOCK_EMPTY,    /**< to be read from the file, or free to be filled */
+  FILE_BLOCK_LOADING,  /**< being read by the read-ahead thread */
+  FILE_BLOCK_READY,    /**< read, shorter than a block only at the end of the file */
+  FILE_BLOCK_FILLING,  /**< being filled by the client */
+  FILE_BLOCK_FULL,     /**< to be written, shorter than a block only when flushed */
+  FILE_BLOCK_WRITING   /**< being written by the write-behind thread */
+} file_pipe_block_state;
+
+/** A block of the file read ahead of the current position, or written behind
+ * it. The blocks read ahead start at multiples of the block size, and the block
+ * of an offset always goes to the same slot, so that the blocks kept over a
+ * seek are found again. The blocks written behind are filled and written in
+ * the order of the slots.
+ */
+typedef struct file_pipe_block {
+  CPbyte* pData;
+  off_t nOffset;
+  size_t nLength;
+  file_pipe_block_state eState;
+} file_pipe_block;
+
 typedef struct {
 
   /* public */
@@ -44,6 +123,39 @@ typedef struct {
 
   /* private */
   int fd;
+  off_t nPosition;     /**< current position in the content, shared by all the accesses */
+  off_t nFileSize;     /**< size of the file, refreshed when a request goes past it */
+  long nPageSize;
+  file_pipe_window* pWindow;  /**< the window ReadBuffer currently maps from */
+  file_pipe_window* pRetired; /**< windows slid away with buffers still out */
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+
+  /* the single buffer of GetWriteBuffer when the write-behind is off */
+  CPbyte* pWriteBuffer;
+  size_t nWriteBufferSize;
+
+  /* blocks read ahead or written behind, with the thread that reads or writes them */
+  file_pipe_blocks_mode eBlocks;
+  int nBlocks;
+  size_t nBlockSize;
+  file_pipe_block* pBlocks;
+  int bStopBlocks;
+  pthread_t blockThread;
+  pthread_mutex_t blockMutex;
+  pthread_cond_t blockCond;  /**< a block changed state, or the blocks were moved */
+
+  /* read-ahead, used by Read and CheckAvailableBytes */
+  off_t nBase;          /**< offset of the block of the current position */
+  CPuint nBytesWaited;  /**< bytes to notify with CP_BytesAvailable, 0 if none */
+  off_t nWaitedPosition; /**< position the bytes waited start from */
+
+  /* write-behind, used by Write, GetWriteBuffer and WriteBuffer */
+  int nFill;            /**< slot of the block filled by the client */
+  int nWrite;           /**< slot of the next block to write */
+  int fdDirect;         /**< the file opened with O_DIRECT, or -1 */
+  size_t nSyncBytes;    /**< bytes written between two fdatasync, 0 for none */
+  size_t nUnsynced;
+  CPresult nWriteError; /**< the first error of the write-behind thread */
 
 } file_ContentPipe;
 
@@ -25,74 +25,823 @@
 
 #include "content_pipe_inet.h"
 
+/* The positions in the ring and the flags shared with the receive loop are
+ * accessed atomically. Sequential consistency makes sure that the side that
+ * sets a waiting flag and the side that moves a position see each other.
+ */
+#define INET_LOAD(x) __atomic_load_n(&(x), __ATOMIC_SEQ_CST)
+#define INET_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_SEQ_CST)
+
+/* The servers shared by the streams created on a port */
+static pthread_mutex_t serversMutex = PTHREAD_MUTEX_INITIALIZER;
+static inet_server* pServers = NULL;
+
+static void setNonBlocking(int fd)
+{
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+/** Reads the number of loops of a shared server and the size of the rings */
+static void readConfig(int* pnLoops, size_t* pnRingSize)
+{
+  const char* config = getenv(INET_PIPE_ENV);
+  const char* token;
+  size_t nRingSize = INET_PIPE_RING_SIZE;
+  int nLoops;
+
+  *pnLoops = 1;
+  for(token = config; token && *token; token = strchr(token, ',')) {
+    if(*token == ',')
+      token++;
+    if(0 == strncmp(token, "loops=", 6) && (nLoops = atoi(token + 6)) > 0) {
+      *pnLoops = nLoops < INET_PIPE_MAX_LOOPS ? nLoops : INET_PIPE_MAX_LOOPS;
+    } else if(0 == strncmp(token, "ring=", 5) && atoi(token + 5) > 0) {
+      nRingSize = (size_t) atoi(token + 5) * 1024;
+    }
+  }
+
+  /* the positions are taken modulo a power of two */
+  for(*pnRingSize = 4096; *pnRingSize < nRingSize; *pnRingSize <<= 1)
+    ;
+}
+
+/** Wakes the client if it sleeps in Read or ReadBuffer */
+static void wakeClient(inet_ContentPipe* pPipe)
+{
+  if(INET_LOAD(pPipe->bWaitingData)) {
+    pthread_mutex_lock(&pPipe->mutex);
+    pthread_cond_broadcast(&pPipe->cond);
+    pthread_mutex_unlock(&pPipe->mutex);
+  }
+}
+
+/** Sends CP_BytesAvailable once the bytes waited by the client are received,
+ * or the stream ended before them
+ */
+static void notifyWaited(inet_ContentPipe* pPipe)
+{
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+  CPuint nWaited = INET_LOAD(pPipe->nBytesWaited);
+
+  if(0 == nWaited || (INET_LOAD(pPipe->nHead) < INET_LOAD(pPipe->nWaitedEnd) && !INET_LOAD(pPipe->bEnd)))
+    return;
+  if(!__atomic_compare_exchange_n(&pPipe->nBytesWaited, &nWaited, 0, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+    return;
+  ClientCallback = INET_LOAD(pPipe->ClientCallback);
+  if(NULL != ClientCallback)
+    ClientCallback(CP_BytesAvailable, nWaited);
+}
+
+/** Marks the end of the stream and tells the client */
+static void endOfStream(inet_ContentPipe* pPipe)
+{
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+
+  INET_STORE(pPipe->bEnd, 1);
+  wakeClient(pPipe);
+  notifyWaited(pPipe);
+  ClientCallback = INET_LOAD(pPipe->ClientCallback);
+  if(NULL != ClientCallback)
+    ClientCallback(CP_PipeDisconnected, 0);
+}
+
+/** Receives from the socket into the free room of the ring until the socket
+ * has no more data. When the ring is full the socket is left alone until
+ * the client frees some room.
+ */
+static void receive(inet_ContentPipe* pPipe)
+{
+  int epfd = pPipe->pLoop->epfd;
+  size_t nRingSize = pPipe->nRingSize;
+  struct epoll_event event;
+  struct iovec iov[2];
+  size_t nHead, nRoom, nOffset;
+  ssize_t count;
+  int n;
+
+  while(!INET_LOAD(pPipe->bEnd)) {
+    nHead = pPipe->nHead;
+    nRoom = nRingSize - (nHead - INET_LOAD(pPipe->nTail));
+    if(0 == nRoom) {
+      INET_STORE(pPipe->bWaitingRoom, 1);
+      /* the client may have freed room before it could see the flag */
+      if(INET_LOAD(pPipe->nTail) + nRingSize != nHead) {
+        INET_STORE(pPipe->bWaitingRoom, 0);
+        continue;
+      }
+      event.events = 0;
+      event.data.ptr = &pPipe->watchSocket;
+      epoll_ctl(epfd, EPOLL_CTL_MOD, pPipe->cfd, &event);
+      return;
+    }
+
+    nOffset = nHead & (nRingSize - 1);
+    iov[0].iov_base = pPipe->pRing + nOffset;
+    if(nOffset + nRoom <= nRingSize) {
+      iov[0].iov_len = nRoom;
+      n = 1;
+    } else {
+      iov[0].iov_len = nRingSize - nOffset;
+      iov[1].iov_base = pPipe->pRing;
+      iov[1].iov_len = nRoom - iov[0].iov_len;
+      n = 2;
+    }
+
+    count = readv(pPipe->cfd, iov, n);
+    if(count > 0) {
+      INET_STORE(pPipe->nHead, nHead + count);
+      wakeClient(pPipe);
+      notifyWaited(pPipe);
+    } else if(-1 == count && EINTR == errno) {
+      continue;
+    } else if(-1 == count && (EAGAIN == errno || EWOULDBLOCK == errno)) {
+      return;
+    } else {
+      if(-1 == count)
+        DEBUG(DEB_LEV_ERR, "content_pipe_inet: receive failed, errno %i\n", errno);
+      epoll_ctl(epfd, EPOLL_CTL_DEL, pPipe->cfd, NULL);
+      endOfStream(pPipe);
+    }
+  }
+}
+
+/** Receives again into a ring that was full, once the client freed room */
+static void resumeReceive(inet_ContentPipe* pPipe)
+{
+  struct epoll_event event;
+  uint64_t nWakeups;
+
+  if(read(pPipe->efd, &nWakeups, sizeof(nWakeups)) != sizeof(nWakeups))
+    return;
+  if(INET_LOAD(pPipe->bWaitingRoom)) {
+    INET_STORE(pPipe->bWaitingRoom, 0);
+    event.events = EPOLLIN;
+    event.data.ptr = &pPipe->watchSocket;
+    epoll_ctl(pPipe->pLoop->epfd, EPOLL_CTL_MOD, pPipe->cfd, &event);
+  }
+}
+
+static void loopWake(inet_loop* pLoop)
+{
+  uint64_t nWakeup = 1;
+
+  if(write(pLoop->efd, &nWakeup, sizeof(nWakeup)) != sizeof(nWakeup))
+    DEBUG(DEB_LEV_ERR, "content_pipe_inet: receive loop not woken\n");
+}
+
+/** Makes a loop receive a connected socket into the ring of a pipe */
+static void loopAttach(inet_loop* pLoop, inet_ContentPipe* pPipe, int fd)
+{
+  struct epoll_event event;
+
+  pPipe->pLoop = pLoop;
+  INET_STORE(pPipe->cfd, fd);
+  pPipe->bAttached = 1;
+
+  event.events = EPOLLIN;
+  event.data.ptr = &pPipe->watchRoom;
+  epoll_ctl(pLoop->epfd, EPOLL_CTL_ADD, pPipe->efd, &event);
+  event.data.ptr = &pPipe->watchSocket;
+  epoll_ctl(pLoop->epfd, EPOLL_CTL_ADD, fd, &event);
+}
+
+/** Asks a loop to forget a pipe, and waits until it is done. The loop does
+ * it between two epoll_wait, when no event about the pipe is pending.
+ */
+static void loopDetach(inet_loop* pLoop, inet_ContentPipe* pPipe)
+{
+  pthread_mutex_lock(&pLoop->mutex);
+  pPipe->pNextDetach = pLoop->pDetach;
+  pLoop->pDetach = pPipe;
+  loopWake(pLoop);
+  while(pPipe->bAttached)
+    pthread_cond_wait(&pLoop->cond, &pLoop->mutex);
+  pthread_mutex_unlock(&pLoop->mutex);
+}
+
+static void loopDetachAll(inet_loop* pLoop)
+{
+  inet_ContentPipe* pPipe;
+
+  pthread_mutex_lock(&pLoop->mutex);
+  if(NULL != pLoop->pDetach) {
+    while(NULL != (pPipe = pLoop->pDetach)) {
+      pLoop->pDetach = pPipe->pNextDetach;
+      epoll_ctl(pLoop->epfd, EPOLL_CTL_DEL, pPipe->cfd, NULL);
+      epoll_ctl(pLoop->epfd, EPOLL_CTL_DEL, pPipe->efd, NULL);
+      pPipe->bAttached = 0;
+    }
+    pthread_cond_broadcast(&pLoop->cond);
+  }
+  pthread_mutex_unlock(&pLoop->mutex);
+}
+
+static void dropHandshake(inet_loop* pLoop, inet_handshake* pHandshake)
+{
+  inet_handshake** ppHandshake;
+
+  for(ppHandshake = &pLoop->pHandshakes; *ppHandshake != pHandshake; ppHandshake = &(*ppHandshake)->pNext)
+    ;
+  *ppHandshake = pHandshake->pNext;
+  epoll_ctl(pLoop->epfd, EPOLL_CTL_DEL, pHandshake->fd, NULL);
+  free(pHandshake);
+}
+
+/** Accepts the peers. The peer of a private loop is received at once, the
+ * peers of a shared server send first the identifier of their stream.
+ */
+static void loopAccept(inet_loop* pLoop)
+{
+  struct epoll_event event;
+  inet_handshake* pHandshake;
+  int fd;
+
+  while(SOCKET_ERROR != (fd = accept(pLoop->sfd, NULL, NULL))) {
+    setNonBlocking(fd);
+
+    if(NULL == pLoop->pServer) {
+      /* a private loop accepts its first peer only */
+      epoll_ctl(pLoop->epfd, EPOLL_CTL_DEL, pLoop->sfd, NULL);
+      loopAttach(pLoop, pLoop->pPipe, fd);
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "content_pipe_inet: peer accepted\n");
+      return;
+    }
+
+    pHandshake = (inet_handshake*) calloc(1, sizeof(inet_handshake));
+    if(NULL == pHandshake) {
+      close(fd);
+      continue;
+    }
+    pHandshake->watch.eType = INET_WATCH_HANDSHAKE;
+    pHandshake->watch.pOwner = pHandshake;
+    pHandshake->fd = fd;
+    pHandshake->pNext = pLoop->pHandshakes;
+    pLoop->pHandshakes = pHandshake;
+    event.events = EPOLLIN;
+    event.data.ptr = &pHandshake->watch;
+    epoll_ctl(pLoop->epfd, EPOLL_CTL_ADD, fd, &event);
+  }
+}
+
+/** Reads the identifier of the stream of a peer, ended by a new line, and
+ * gives the peer to the pipe created for that stream
+ */
+static void loopHandshake(inet_loop* pLoop, inet_handshake* pHandshake)
+{
+  inet_server* pServer = pLoop->pServer;
+  inet_ContentPipe* pPipe;
+  char* pEnd;
+  ssize_t count;
+  int fd = pHandshake->fd;
+
+  /* only the identifier is taken out of the socket, the rest is the stream */
+  count = recv(fd, pHandshake->id + pHandshake->nId, INET_PIPE_ID_SIZE - pHandshake->nId, MSG_PEEK);
+  if(-1 == count && (EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno))
+    return;
+  if(count <= 0) {
+    dropHandshake(pLoop, pHandshake);
+    close(fd);
+    return;
+  }
+  pEnd = memchr(pHandshake->id + pHandshake->nId, '\n', count);
+  if(NULL != pEnd)
+    count = pEnd - (pHandshake->id + pHandshake->nId) + 1;
+  count = recv(fd, pHandshake->id + pHandshake->nId, count, 0);
+  if(count > 0)
+    pHandshake->nId += count;
+  if(NULL == pEnd) {
+    if(INET_PIPE_ID_SIZE == pHandshake->nId) {
+      DEBUG(DEB_LEV_ERR, "content_pipe_inet: stream identifier too long\n");
+      dropHandshake(pLoop, pHandshake);
+      close(fd);
+    }
+    return;
+  }
+  pHandshake->id[pHandshake->nId - 1] = '\0';
+
+  pthread_mutex_lock(&pServer->mutex);
+  for(pPipe = pServer->pStreams; NULL != pPipe; pPipe = pPipe->pNextStream)
+    if(!pPipe->bAttached && 0 == strcmp(pPipe->id, pHandshake->id))
+      break;
+  dropHandshake(pLoop, pHandshake);
+  if(NULL != pPipe) {
+    loopAttach(pLoop, pPipe, fd);
+  } else {
+    DEBUG(DEB_LEV_ERR, "content_pipe_inet: no stream %s on port %i\n", pHandshake->id, pServer->nPort);
+    close(fd);
+  }
+  pthread_mutex_unlock(&pServer->mutex);
+}
+
+/** The receive loop. All the pipes of a loop are received by its thread. */
+static void* loopThread(void* param)
+{
+  inet_loop* pLoop = (inet_loop*) param;
+  struct epoll_event events[INET_PIPE_LOOP_EVENTS];
+  inet_watch* pWatch;
+  uint64_t nWakeups;
+  int i, n;
+
+  while(!INET_LOAD(pLoop->bStop)) {
+    n = epoll_wait(pLoop->epfd, events, INET_PIPE_LOOP_EVENTS, -1);
+    for(i = 0; i < n; i++) {
+      pWatch = (inet_watch*) events[i].data.ptr;
+      switch(pWatch->eType) {
+      case INET_WATCH_WAKEUP:
+        if(read(pLoop->efd, &nWakeups, sizeof(nWakeups)) != sizeof(nWakeups))
+          DEBUG(DEB_LEV_ERR, "content_pipe_inet: wakeup not read\n");
+        break;
+      case INET_WATCH_LISTEN:
+        loopAccept(pLoop);
+        break;
+      case INET_WATCH_HANDSHAKE:
+        loopHandshake(pLoop, (inet_handshake*) pWatch->pOwner);
+        break;
+      case INET_WATCH_SOCKET:
+        receive((inet_ContentPipe*) pWatch->pOwner);
+        break;
+      case INET_WATCH_ROOM:
+        resumeReceive((inet_ContentPipe*) pWatch->pOwner);
+        break;
+      }
+    }
+    loopDetachAll(pLoop);
+  }
+
+  return NULL;
+}
+
+/** Starts a loop, listening on sfd unless it is SOCKET_ERROR */
+static CPresult loopStart(inet_loop* pLoop, int sfd)
+{
+  struct epoll_event event;
+
+  pLoop->wakeup.eType = INET_WATCH_WAKEUP;
+  pLoop->wakeup.pOwner = pLoop;
+  pLoop->listen.eType = INET_WATCH_LISTEN;
+  pLoop->listen.pOwner = pLoop;
+  pLoop->bStop = 0;
+  pLoop->pHandshakes = NULL;
+  pLoop->pDetach = NULL;
+
+  pLoop->epfd = epoll_create(INET_PIPE_LOOP_EVENTS);
+  pLoop->efd = eventfd(0, 0);
+  if(-1 == pLoop->epfd || -1 == pLoop->efd) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_inet: could not make a receive loop\n");
+    if(-1 != pLoop->epfd)
+      close(pLoop->epfd);
+    if(-1 != pLoop->efd)
+      close(pLoop->efd);
+    return KD_EMFILE;
+  }
+  event.events = EPOLLIN;
+  event.data.ptr = &pLoop->wakeup;
+  epoll_ctl(pLoop->epfd, EPOLL_CTL_ADD, pLoop->efd, &event);
+  pLoop->sfd = sfd;
+  if(SOCKET_ERROR != sfd) {
+    event.data.ptr = &pLoop->listen;
+    epoll_ctl(pLoop->epfd, EPOLL_CTL_ADD, sfd, &event);
+  }
+  pthread_mutex_init(&pLoop->mutex, NULL);
+  pthread_cond_init(&pLoop->cond, NULL);
+
+  if(0 != pthread_create(&pLoop->thread, NULL, loopThread, pLoop)) {
+    pthread_cond_destroy(&pLoop->cond);
+    pthread_mutex_destroy(&pLoop->mutex);
+    close(pLoop->epfd);
+    close(pLoop->efd);
+    return KD_ENOMEM;
+  }
+
+  return 0;
+}
+
+/** Stops a loop, and closes its listening socket and the peers that did not
+ * send their stream identifier
+ */
+static void loopStop(inet_loop* pLoop)
+{
+  inet_handshake* pHandshake;
+
+  INET_STORE(pLoop->bStop, 1);
+  loopWake(pLoop);
+  pthread_join(pLoop->thread, NULL);
+
+  while(NULL != (pHandshake = pLoop->pHandshakes)) {
+    pLoop->pHandshakes = pHandshake->pNext;
+    close(pHandshake->fd);
+    free(pHandshake);
+  }
+  if(SOCKET_ERROR != pLoop->sfd)
+    close(pLoop->sfd);
+  close(pLoop->epfd);
+  close(pLoop->efd);
+  pthread_cond_destroy(&pLoop->cond);
+  pthread_mutex_destroy(&pLoop->mutex);
+}
+
+/** Makes a socket listening on a port */
+static CPresult listenSocket(int nHostPort, int bReusePort, int nQueueSize, int* pfd)
+{
+  struct sockaddr_in sAddress;  /* Internet socket address stuct */
+  int nReuse = 1;
+  int fd;
+
+  fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if(SOCKET_ERROR == fd) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_inet: could not make a socket\n");
+    return KD_EIO;
+  }
+
+  /* fill address struct */
+  sAddress.sin_addr.s_addr = INADDR_ANY;
+  sAddress.sin_port = htons(nHostPort);
+  sAddress.sin_family = AF_INET;
+
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &nReuse, sizeof(nReuse));
+#ifdef SO_REUSEPORT
+  if(bReusePort)
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &nReuse, sizeof(nReuse));
+#endif
+
+  /* bind to a port */
+  if(SOCKET_ERROR == bind(fd, (struct sockaddr*) &sAddress, sizeof(sAddress))) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_inet: could not bind port %i\n", nHostPort);
+    close(fd);
+    return KD_EADDRINUSE;
+  }
+
+  /* establish listen queue */
+  if(SOCKET_ERROR == listen(fd, nQueueSize)) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_inet: could not listen\n");
+    close(fd);
+    return KD_EIO;
+  }
+  setNonBlocking(fd);
+  *pfd = fd;
+
+  return 0;
+}
+
+/** Starts a shared server on a port, with loops listening on it together */
+static CPresult serverStart(int nHostPort, inet_server** ppServer)
+{
+  inet_server* pServer;
+  size_t nRingSize;
+  CPresult err = 0;
+  int i, fd;
+
+  pServer = (inet_server*) calloc(1, sizeof(inet_server));
+  if(NULL == pServer)
+    return KD_ENOMEM;
+  pServer->nPort = nHostPort;
+  readConfig(&pServer->nLoops, &nRingSize);
+  pthread_mutex_init(&pServer->mutex, NULL);
+
+  for(i = 0; i < pServer->nLoops && 0 == err; i++) {
+    err = listenSocket(nHostPort, pServer->nLoops > 1, SOMAXCONN, &fd);
+    if(0 == err) {
+      pServer->loops[i].pServer = pServer;
+      err = loopStart(&pServer->loops[i], fd);
+      if(0 != err)
+        close(fd);
+    }
+  }
+  if(0 != err) {
+    for(i = i - 2; i >= 0; i--)
+      loopStop(&pServer->loops[i]);
+    pthread_mutex_destroy(&pServer->mutex);
+    free(pServer);
+    return err;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "content_pipe_inet: server on port %i with %i loops\n", nHostPort, pServer->nLoops);
+
+  *ppServer = pServer;
+  return 0;
+}
+
+/** Adds a pipe to the streams of the shared server of a port */
+static CPresult serverAdd(inet_ContentPipe* pPipe, int nHostPort)
+{
+  inet_server* pServer;
+  inet_ContentPipe* pStream;
+  CPresult err = 0;
+
+  pthread_mutex_lock(&serversMutex);
+  for(pServer = pServers; NULL != pServer; pServer = pServer->pNext)
+    if(pServer->nPort == nHostPort)
+      break;
+  if(NULL == pServer) {
+    err = serverStart(nHostPort, &pServer);
+    if(0 == err) {
+      pServer->pNext = pServers;
+      pServers = pServer;
+    }
+  }
+
+  if(0 == err) {
+    pthread_mutex_lock(&pServer->mutex);
+    for(pStream = pServer->pStreams; NULL != pStream; pStream = pStream->pNextStream)
+      if(0 == strcmp(pStream->id, pPipe->id))
+        break;
+    if(NULL == pStream) {
+      pPipe->pServer = pServer;
+      pPipe->pNextStream = pServer->pStreams;
+      pServer->pStreams = pPipe;
+    } else {
+      DEBUG(DEB_LEV_ERR, "content_pipe_inet: stream %s already on port %i\n", pPipe->id, nHostPort);
+      err = KD_EEXIST;
+    }
+    pthread_mutex_unlock(&pServer->mutex);
+  }
+  pthread_mutex_unlock(&serversMutex);
+
+  return err;
+}
+
+/** Removes a pipe from the streams of its server, and stops the server after
+ * its last stream
+ */
+static void serverRemove(inet_ContentPipe* pPipe)
+{
+  inet_server* pServer = pPipe->pServer;
+  inet_server** ppServer;
+  inet_ContentPipe** ppStream;
+  int i, bAttached;
+
+  pthread_mutex_lock(&serversMutex);
+
+  pthread_mutex_lock(&pServer->mutex);
+  for(ppStream = &pServer->pStreams; *ppStream != pPipe; ppStream = &(*ppStream)->pNextStream)
+    ;
+  *ppStream = pPipe->pNextStream;
+  bAttached = pPipe->bAttached;
+  pthread_mutex_unlock(&pServer->mutex);
+
+  if(bAttached)
+    loopDetach(pPipe->pLoop, pPipe);
+
+  if(NULL == pServer->pStreams) {
+    for(ppServer = &pServers; *ppServer != pServer; ppServer = &(*ppServer)->pNext)
+      ;
+    *ppServer = pServer->pNext;
+    for(i = 0; i < pServer->nLoops; i++)
+      loopStop(&pServer->loops[i]);
+    pthread_mutex_destroy(&pServer->mutex);
+    free(pServer);
+  }
+
+  pthread_mutex_unlock(&serversMutex);
+
+  pPipe->pServer = NULL;
+  pPipe->pLoop = NULL;
+}
+
+/** Starts a private loop for a pipe, listening on sfd unless it is SOCKET_ERROR */
+static CPresult privateLoopStart(inet_ContentPipe* pPipe, int sfd)
+{
+  inet_loop* pLoop;
+  CPresult err;
+
+  pLoop = (inet_loop*) calloc(1, sizeof(inet_loop));
+  if(NULL == pLoop)
+    return KD_ENOMEM;
+  pLoop->pPipe = pPipe;
+  err = loopStart(pLoop, sfd);
+  if(0 != err) {
+    free(pLoop);
+    return err;
+  }
+  pPipe->pLoop = pLoop;
+  pPipe->bPrivateLoop = 1;
+
+  return 0;
+}
+
+/** Allocates the ring of a pipe */
+static CPresult pipeStart(inet_ContentPipe* pPipe)
+{
+  int nLoops;
+
+  readConfig(&nLoops, &pPipe->nRingSize);
+  pPipe->pRing = (CPbyte*) malloc(pPipe->nRingSize);
+  pPipe->efd = eventfd(0, 0);
+  if(NULL == pPipe->pRing || -1 == pPipe->efd) {
+    free(pPipe->pRing);
+    pPipe->pRing = NULL;
+    if(-1 != pPipe->efd)
+      close(pPipe->efd);
+    pPipe->efd = -1;
+    return KD_ENOMEM;
+  }
+  pPipe->nHead = pPipe->nTail = pPipe->nRead = 0;
+  pPipe->bEnd = pPipe->bWaitingRoom = pPipe->bWaitingData = 0;
+  pPipe->nFirstBuffer = pPipe->nBuffers = 0;
+  pPipe->nBytesWaited = 0;
+  pPipe->bAttached = 0;
+  pPipe->watchSocket.eType = INET_WATCH_SOCKET;
+  pPipe->watchSocket.pOwner = pPipe;
+  pPipe->watchRoom.eType = INET_WATCH_ROOM;
+  pPipe->watchRoom.pOwner = pPipe;
+  pthread_mutex_init(&pPipe->mutex, NULL);
+  pthread_cond_init(&pPipe->cond, NULL);
+  pPipe->bStarted = 1;
+
+  return 0;
+}
+
+/** Stops receiving into a pipe and frees its ring */
+static void pipeStop(inet_ContentPipe* pPipe)
+{
+  int i;
+
+  if(NULL != pPipe->pServer) {
+    serverRemove(pPipe);
+  } else if(pPipe->bPrivateLoop) {
+    loopStop(pPipe->pLoop);
+    free(pPipe->pLoop);
+    pPipe->pLoop = NULL;
+    pPipe->bPrivateLoop = 0;
+  }
+
+  close(pPipe->efd);
+  pPipe->efd = -1;
+  for(i = 0; i < pPipe->nBuffers; i++)
+    free(pPipe->buffers[(pPipe->nFirstBuffer + i) % INET_PIPE_MAX_BUFFERS].pCopy);
+  pPipe->nBuffers = 0;
+  free(pPipe->pRing);
+  pPipe->pRing = NULL;
+  pthread_cond_destroy(&pPipe->cond);
+  pthread_mutex_destroy(&pPipe->mutex);
+  pPipe->bStarted = 0;
+}
+
+/** Waits until at least nSize bytes are received after the ones given to the
+ * client, or the stream ended, and returns the bytes received
+ */
+static size_t waitData(inet_ContentPipe* pPipe, size_t nSize)
+{
+  size_t nAvailable = INET_LOAD(pPipe->nHead) - pPipe->nRead;
+
+  if(nAvailable >= nSize || INET_LOAD(pPipe->bEnd))
+    return nAvailable;
+
+  pthread_mutex_lock(&pPipe->mutex);
+  INET_STORE(pPipe->bWaitingData, 1);
+  while((nAvailable = INET_LOAD(pPipe->nHead) - pPipe->nRead) < nSize && !INET_LOAD(pPipe->bEnd))
+    pthread_cond_wait(&pPipe->cond, &pPipe->mutex);
+  INET_STORE(pPipe->bWaitingData, 0);
+  pthread_mutex_unlock(&pPipe->mutex);
+
+  return nAvailable;
+}
+
+/** Frees the ring up to a position, and wakes the receive loop if it waits for room */
+static void setTail(inet_ContentPipe* pPipe, size_t nTail)
+{
+  uint64_t nWakeup = 1;
+
+  INET_STORE(pPipe->nTail, nTail);
+  if(INET_LOAD(pPipe->bWaitingRoom)) {
+    if(write(pPipe->efd, &nWakeup, sizeof(nWakeup)) != sizeof(nWakeup))
+      DEBUG(DEB_LEV_ERR, "content_pipe_inet: receive loop not woken\n");
+  }
+}
+
+/** Frees the ring up to the buffers released in order */
+static void releaseBuffers(inet_ContentPipe* pPipe)
+{
+  inet_pipe_buffer* pBuffer;
+  size_t nTail = 0;
+  int bMoved = 0;
+
+  while(0 != pPipe->nBuffers) {
+    pBuffer = &pPipe->buffers[pPipe->nFirstBuffer];
+    if(!pBuffer->bReleased)
+      break;
+    nTail = pBuffer->nEnd;
+    bMoved = 1;
+    pPipe->nFirstBuffer = (pPipe->nFirstBuffer + 1) % INET_PIPE_MAX_BUFFERS;
+    pPipe->nBuffers--;
+  }
+  if(bMoved)
+    setTail(pPipe, nTail);
+}
+
+/** Records a buffer given to the client, that holds the ring up to nEnd */
+static inet_pipe_buffer* addBuffer(inet_ContentPipe* pPipe, size_t nEnd)
+{
+  inet_pipe_buffer* pBuffer;
+
+  if(INET_PIPE_MAX_BUFFERS == pPipe->nBuffers)
+    return NULL;
+  pBuffer = &pPipe->buffers[(pPipe->nFirstBuffer + pPipe->nBuffers) % INET_PIPE_MAX_BUFFERS];
+  pPipe->nBuffers++;
+  pBuffer->pBuffer = NULL;
+  pBuffer->pCopy = NULL;
+  pBuffer->nEnd = nEnd;
+  pBuffer->bReleased = 0;
+
+  return pBuffer;
+}
+
+/** Copies bytes out of the ring, across its end if needed */
+static void copyFromRing(inet_ContentPipe* pPipe, CPbyte* pData, size_t nPosition, size_t nSize)
+{
+  size_t nOffset = nPosition & (pPipe->nRingSize - 1);
+  size_t nFirst = pPipe->nRingSize - nOffset;
+
+  if(nFirst >= nSize) {
+    memcpy(pData, pPipe->pRing + nOffset, nSize);
+  } else {
+    memcpy(pData, pPipe->pRing + nOffset, nFirst);
+    memcpy(pData + nFirst, pPipe->pRing, nSize - nFirst);
+  }
+}
+
 /*
  * Create a socket
+ * The peer is accepted by the receive loop, so that the pipe can be
+ * created before the peer connects.
+ * e.g. inet://2102 accepts one peer on its own port, inet://2102/camera1
+ * receives the stream camera1 from the server shared by the port.
 */
 
 static CPresult Create( CPhandle *hContent, CPstring szURI )
 {
   inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
   CPresult err = 0;
+  const char* pId;
   int nHostPort;
-  struct sockaddr_in sAddress;  /* Internet socket address stuct */
-  int nAddressSize=sizeof(struct sockaddr_in);
+  int sfd;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
   if(1 != sscanf(szURI, "inet://%d", &nHostPort))
-    err = KD_EINVAL;
-
-  pPipe->sfd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-  if(SOCKET_ERROR == pPipe->sfd) {
-    printf("\nCould not make a socket\n");
-    err = KD_EIO;
+    return KD_EINVAL;
+
+  pId = strchr(szURI + 7, '/');
+  if(NULL != pId && '\0' != pId[1]) {
+    if(strlen(pId + 1) >= INET_PIPE_ID_SIZE || NULL != strchr(pId + 1, '\n'))
+      return KD_EINVAL;
+    strcpy(pPipe->id, pId + 1);
+
+    err = pipeStart(pPipe);
+    if(0 == err) {
+      err = serverAdd(pPipe, nHostPort);
+      if(0 != err)
+        pipeStop(pPipe);
+    }
+    return err;
   }
 
-  if(0 == err) {
-
-    /* fill address struct */
-    sAddress.sin_addr.s_addr = INADDR_ANY;
-    sAddress.sin_port = htons(nHostPort);
-    sAddress.sin_family = AF_INET;
-
-    /* bind to a port */
-    if(SOCKET_ERROR == bind(pPipe->sfd ,(struct sockaddr*) &sAddress, sizeof(sAddress))) {
-      printf("\nCould not connect to host\n");
-      err = KD_EIO;
-    }
+  err = listenSocket(nHostPort, 0, QUEUE_SIZE, &sfd);
 
+  if(0 == err) {
+    err = pipeStart(pPipe);
+    if(0 != err)
+      close(sfd);
   }
 
-  if(0 == err) /* establish listen queue */
-    if(listen(pPipe->sfd, QUEUE_SIZE) == SOCKET_ERROR) {
-      printf("\nCould not listen\n");
-      err = KD_EIO;
+  if(0 == err) {
+    err = privateLoopStart(pPipe, sfd);
+    if(0 != err) {
+      close(sfd);
+      pipeStop(pPipe);
     }
-
-  if(0 == err) /* get the connected socket */
-    pPipe->cfd = accept(pPipe->sfd, (struct sockaddr*) &sAddress, (socklen_t*) &nAddressSize);
+  }
 
   return err;
 }
 
 /** Open socket for reading or writing.
- ** e.g. inet://faex05:2102
+ ** e.g. inet://faex05:2102, or inet://faex05:2102/camera1 to send the
+ ** stream camera1 to a shared server
 */
 static CPresult Open( CPhandle* hContent, CPstring szURI, CP_ACCESSTYPE eAccess )
 {
   inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
   CPresult err = 0;
   char strHostName[80];
+  char strId[INET_PIPE_ID_SIZE + 1];
   int nHostPort = 0;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
+  strId[0] = '\0';
   {
     char *pc = strrchr(szURI, ':');
-    if(pc != NULL) {
-      strncpy(strHostName, szURI+7, (long) pc - (long) szURI - 7);
-      strHostName[(long) pc - (long) szURI - 7] = '\0';
-      nHostPort = atoi(++pc);
+    char *pId;
+    if(pc == NULL || pc - szURI - 7 <= 0 || pc - szURI - 7 >= sizeof(strHostName))
+      return KD_EINVAL;
+    strncpy(strHostName, szURI+7, (long) pc - (long) szURI - 7);
+    strHostName[(long) pc - (long) szURI - 7] = '\0';
+    nHostPort = atoi(++pc);
+    pId = strchr(pc, '/');
+    if(pId != NULL && pId[1] != '\0') {
+      if(strlen(pId + 1) >= INET_PIPE_ID_SIZE || strchr(pId + 1, '\n') != NULL)
+        return KD_EINVAL;
+      sprintf(strId, "%s\n", pId + 1);
     }
   }
 
@@ -111,20 +860,48 @@ static CPresult Open( CPhandle* hContent, CPstring szURI, CP_ACCESSTYPE eAccess
     /* get IP address from name */
     pHostInfo = gethostbyname(strHostName);
 
-    /* copy address into long */
-    memcpy(&nHostAddress, pHostInfo->h_addr, pHostInfo->h_length);
+    if(NULL == pHostInfo) {
+      DEBUG(DEB_LEV_ERR, "content_pipe_inet: unknown host %s\n", strHostName);
+      err = KD_EHOSTUNREACH;
+    } else {
+      /* copy address into long */
+      memcpy(&nHostAddress, pHostInfo->h_addr, pHostInfo->h_length);
+
+      /* fill address struct */
+      sAddress.sin_addr.s_addr = nHostAddress;
+      sAddress.sin_port = htons(nHostPort);
+      sAddress.sin_family = AF_INET;
+
+      /* connect to host */
+      if(SOCKET_ERROR == connect(pPipe->cfd, (struct sockaddr*) &sAddress, sizeof(sAddress))) {
+        DEBUG(DEB_LEV_ERR, "content_pipe_inet: could not connect to %s:%i\n", strHostName, nHostPort);
+        err = KD_ECONNREFUSED;
+      }
+    }
 
-    /* fill address struct */
-    sAddress.sin_addr.s_addr = nHostAddress;
-    sAddress.sin_port = htons(nHostPort);
-    sAddress.sin_family = AF_INET;
+  }
 
-    /* connect to host */
-    if(SOCKET_ERROR == connect(pPipe->cfd, (struct sockaddr*) &sAddress, sizeof(sAddress))) {
-      printf("\nCould not connect to host\n");
+  /* the shared server learns the stream first */
+  if(0 == err && '\0' != strId[0])
+    if(send(pPipe->cfd, strId, strlen(strId), MSG_NOSIGNAL) != strlen(strId))
       err = KD_EIO;
-    }
 
+  if(0 == err) {
+    setNonBlocking(pPipe->cfd);
+    err = pipeStart(pPipe);
+  }
+
+  if(0 == err) {
+    err = privateLoopStart(pPipe, SOCKET_ERROR);
+    if(0 == err)
+      loopAttach(pPipe->pLoop, pPipe, pPipe->cfd);
+    else
+      pipeStop(pPipe);
+  }
+
+  if(0 != err && SOCKET_ERROR != pPipe->cfd) {
+    close(pPipe->cfd);
+    pPipe->cfd = SOCKET_ERROR;
   }
 
   return err;
@@ -138,11 +915,15 @@ static CPresult Close( CPhandle hContent )
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
+  if(pPipe->bStarted)
+    pipeStop(pPipe);
+
   /* close socket */
-  if(SOCKET_ERROR == close(pPipe->cfd)) {
-    printf("\nCould not close client socket\n");
+  if(SOCKET_ERROR != pPipe->cfd && SOCKET_ERROR == close(pPipe->cfd)) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_inet: could not close client socket\n");
     err = KD_EIO;
   }
+  pPipe->cfd = SOCKET_ERROR;
 
   return err;
 }
@@ -150,9 +931,40 @@ static CPresult Close( CPhandle hContent )
 /** Check the that specified number of bytes are available for reading or writing (depending on access type).*/
 static CPresult CheckAvailableBytes( CPhandle hContent, CPuint nBytesRequested, CP_CHECKBYTESRESULTTYPE *eResult )
 {
+  inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+  CPuint nWaited = nBytesRequested;
+  size_t nAvailable, nCapacity;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
-  return KD_EBADF;
+  if(!pPipe->bStarted)
+    return KD_EBADF;
+
+  nAvailable = INET_LOAD(pPipe->nHead) - pPipe->nRead;
+  /* the buffers still out hold their part of the ring */
+  nCapacity = pPipe->nRingSize - (pPipe->nRead - INET_LOAD(pPipe->nTail));
+
+  if(nAvailable >= nBytesRequested) {
+    *eResult = CP_CheckBytesOk;
+  } else if(INET_LOAD(pPipe->bEnd)) {
+    *eResult = (0 == nAvailable) ? CP_CheckBytesAtEndOfStream : CP_CheckBytesInsufficientBytes;
+  } else if(nBytesRequested > nCapacity) {
+    *eResult = CP_CheckBytesOutOfBuffers;
+    ClientCallback = INET_LOAD(pPipe->ClientCallback);
+    if(NULL != ClientCallback)
+      ClientCallback(CP_Overflow, (CPuint) nCapacity);
+  } else {
+    *eResult = CP_CheckBytesNotReady;
+    INET_STORE(pPipe->nWaitedEnd, pPipe->nRead + nBytesRequested);
+    INET_STORE(pPipe->nBytesWaited, nBytesRequested);
+    /* the bytes may have been received before the wait could be seen */
+    if((INET_LOAD(pPipe->nHead) >= pPipe->nRead + nBytesRequested || INET_LOAD(pPipe->bEnd)) &&
+       __atomic_compare_exchange_n(&pPipe->nBytesWaited, &nWaited, 0, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+      return CheckAvailableBytes(hContent, nBytesRequested, eResult);
+  }
+
+  return 0;
 }
 
 /** Seek to certain position in the content relative to the specified origin. */
@@ -166,9 +978,16 @@ static CPresult SetPosition( CPhandle  hContent, CPint nOffset, CP_ORIGINTYPE eO
 /** Retrieve the current position relative to the start of the content. */
 static CPresult GetPosition( CPhandle hContent, CPuint *pPosition)
 {
+  inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
-  return KD_EBADF;
+  if(!pPipe->bStarted)
+    return KD_EBADF;
+
+  *pPosition = (CPuint) pPipe->nRead;
+
+  return 0;
 }
 
 /** Retrieve data of the specified size from the content stream (advance content pointer by size of data).
@@ -176,20 +995,37 @@ static CPresult GetPosition( CPhandle hContent, CPuint *pPosition)
 static CPresult Read( CPhandle hContent, CPbyte *pData, CPuint nSize)
 {
   inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
-  CPresult err = 0;
-  ssize_t count;
+  inet_pipe_buffer* pBuffer;
+  size_t nCopied = 0, nCount;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
-  count = read(pPipe->cfd, (void*) pData, (size_t) nSize);
-
-  if(count < nSize) {
-    err = KD_EIO;  /* ??? */
-  } else if(count == -1) {
-    err = KD_EIO;  /* ??? */
+  if(!pPipe->bStarted)
+    return KD_EBADF;
+
+  /* the data is copied as it comes, so that more than the ring can be read */
+  while(nCopied < nSize) {
+    nCount = waitData(pPipe, 1);
+    if(0 == nCount)
+      break;  /* end of stream */
+    if(nCount > nSize - nCopied)
+      nCount = nSize - nCopied;
+    copyFromRing(pPipe, pData + nCopied, pPipe->nRead, nCount);
+    pPipe->nRead += nCount;
+    nCopied += nCount;
+
+    if(0 == pPipe->nBuffers) {
+      setTail(pPipe, pPipe->nRead);
+    } else {
+      /* the ring is freed once the buffers before are released */
+      pBuffer = addBuffer(pPipe, pPipe->nRead);
+      if(NULL == pBuffer)
+        return KD_EBUSY;
+      pBuffer->bReleased = 1;
+    }
   }
 
-  return err;
+  return nCopied < nSize ? KD_EIO : 0;
 }
 
 /** Retrieve a buffer allocated by the pipe that contains the requested number of bytes.
@@ -203,20 +1039,75 @@ static CPresult Read( CPhandle hContent, CPbyte *pData, CPuint nSize)
     block may straddle the boundary of the circular buffer. By default a pipe implementation
     performs a copy in this case to provide the block to the pipe client in one contiguous buffer.
     If, however, the client sets bForbidCopy, then the pipe returns only those bytes preceding the memory
-    boundary. Here the client may retrieve the data in segments over successive calls. */
+    boundary. Here the client may retrieve the data in segments over successive calls.
+
+    The buffer points into the ring filled by the receive loop. The call waits only when
+    nothing was received, and returns less than requested when less was received. */
 static CPresult ReadBuffer( CPhandle hContent, CPbyte **ppBuffer, CPuint *nSize, CPbool bForbidCopy)
 {
+  inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
+  inet_pipe_buffer* pBuffer;
+  size_t nCount, nOffset;
+  CPbyte* pCopy = NULL;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
-  return KD_EBADF;
+  if(!pPipe->bStarted)
+    return KD_EBADF;
+  if(INET_PIPE_MAX_BUFFERS == pPipe->nBuffers)
+    return KD_EBUSY;
+
+  nCount = waitData(pPipe, 1);
+  if(0 == nCount) {
+    *nSize = 0;
+    return KD_EIO;  /* end of stream */
+  }
+  if(nCount > *nSize)
+    nCount = *nSize;
+
+  nOffset = pPipe->nRead & (pPipe->nRingSize - 1);
+  if(nOffset + nCount > pPipe->nRingSize) {
+    if(bForbidCopy) {
+      nCount = pPipe->nRingSize - nOffset;
+    } else {
+      pCopy = (CPbyte*) malloc(nCount);
+      if(NULL == pCopy)
+        return KD_ENOMEM;
+      copyFromRing(pPipe, pCopy, pPipe->nRead, nCount);
+    }
+  }
+
+  pPipe->nRead += nCount;
+  pBuffer = addBuffer(pPipe, pPipe->nRead);
+  pBuffer->pCopy = pCopy;
+  pBuffer->pBuffer = (NULL != pCopy) ? pCopy : pPipe->pRing + nOffset;
+  *ppBuffer = pBuffer->pBuffer;
+  *nSize = (CPuint) nCount;
+
+  return 0;
 }
 
 /** Release a buffer obtained by ReadBuffer back to the pipe. */
 static CPresult ReleaseReadBuffer(CPhandle hContent, CPbyte *pBuffer)
 {
+  inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
+  inet_pipe_buffer* pEntry;
+  int i;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
-  return KD_EBADF;
+  for(i = 0; i < pPipe->nBuffers; i++) {
+    pEntry = &pPipe->buffers[(pPipe->nFirstBuffer + i) % INET_PIPE_MAX_BUFFERS];
+    if(!pEntry->bReleased && pEntry->pBuffer == pBuffer) {
+      pEntry->bReleased = 1;
+      free(pEntry->pCopy);
+      pEntry->pCopy = NULL;
+      releaseBuffers(pPipe);
+      return 0;
+    }
+  }
+
+  return KD_EINVAL;
 }
 
 /** Write data of the specified size to the content (advance content pointer by size of data).
@@ -224,20 +1115,32 @@ static CPresult ReleaseReadBuffer(CPhandle hContent, CPbyte *pBuffer)
 static CPresult Write( CPhandle hContent, CPbyte *pData, CPuint nSize)
 {
   inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
-  CPresult err = 0;
+  struct pollfd sPoll;
+  size_t nWritten = 0;
   ssize_t count;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
-  count = write(pPipe->cfd, (void*) pData, (size_t) nSize);
-
-  if(count < nSize) {
-    err = KD_EIO;  /* ??? */
-  } else if(count == -1) {
-    err = KD_EIO;  /* ??? */
+  sPoll.fd = INET_LOAD(pPipe->cfd);
+  sPoll.events = POLLOUT;
+  if(SOCKET_ERROR == sPoll.fd)
+    return KD_ENOTCONN;
+
+  /* the socket does not block, the call waits only while it is full */
+  while(nWritten < nSize) {
+    count = send(sPoll.fd, (void*) (pData + nWritten), (size_t) nSize - nWritten, MSG_NOSIGNAL);
+    if(count > 0) {
+      nWritten += count;
+    } else if(-1 == count && (EAGAIN == errno || EWOULDBLOCK == errno)) {
+      poll(&sPoll, 1, -1);
+    } else if(-1 == count && EINTR == errno) {
+      continue;
+    } else {
+      return KD_EIO;  /* ??? */
+    }
   }
 
-  return err;
+  return 0;
 }
 
 /** Retrieve a buffer allocated by the pipe used to write data to the content.
@@ -262,9 +1165,13 @@ static CPresult WriteBuffer( CPhandle hContent, CPbyte *pBuffer, CPuint nFilledS
 /** Register a per-handle client callback with the content pipe. */
 static CPresult RegisterCallback( CPhandle hContent, CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam))
 {
+  inet_ContentPipe* pPipe = (inet_ContentPipe*) hContent;
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_inet:%s \n", __func__);
 
-  return KD_EBADF;
+  INET_STORE(pPipe->ClientCallback, ClientCallback);
+
+  return 0;
 }
 
 CPresult inet_pipe_Constructor(CP_PIPETYPE **ppPipe, CPstring szURI)
@@ -289,8 +1196,8 @@ CPresult inet_pipe_Constructor(CP_PIPETYPE **ppPipe, CPstring szURI)
     pPipe->pipe.WriteBuffer = WriteBuffer;
     pPipe->pipe.RegisterCallback = RegisterCallback;
 
-    pPipe->sfd = SOCKET_ERROR; /* Server file descriptor */
     pPipe->cfd = SOCKET_ERROR; /* Client file descriptor */
+    pPipe->efd = -1;
 
     *ppPipe = (CP_PIPETYPE*) pPipe;
   }
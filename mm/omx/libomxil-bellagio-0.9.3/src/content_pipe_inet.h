@@ -35,6 +35,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <malloc.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
 
 
 #include <OMX_Types.h>
@@ -45,15 +52,146 @@
 #define SOCKET_ERROR        -1
 #define QUEUE_SIZE          1
 
-typedef struct {
+/** Size of the ring of each pipe, a power of two */
+#define INET_PIPE_RING_SIZE (1024 * 1024)
+
+/** Buffers returned by ReadBuffer that can be out at once */
+#define INET_PIPE_MAX_BUFFERS 16
+
+/** A buffer returned by ReadBuffer. The ring is freed up to nEnd once it and
+ * the buffers before it are released. pCopy is set for the buffers copied
+ * out of the ring because they straddled its end.
+ */
+typedef struct inet_pipe_buffer {
+  CPbyte* pBuffer;
+  CPbyte* pCopy;
+  size_t nEnd;
+  int bReleased;
+} inet_pipe_buffer;
+
+/** The environment variable that configures the receive loops, e.g.
+ * "loops=4,ring=256": the loops sharing a port through SO_REUSEPORT, and the
+ * size of the ring of each pipe in KiB
+ */
+#define INET_PIPE_ENV "OMX_BELLAGIO_PIPE_INET"
+
+/** Longest stream identifier, as in inet://port/stream */
+#define INET_PIPE_ID_SIZE 64
+
+#define INET_PIPE_MAX_LOOPS 16
+#define INET_PIPE_LOOP_EVENTS 64
+
+struct inet_ContentPipe;
+struct inet_loop;
+struct inet_server;
+
+typedef enum inet_watch_type {
+  INET_WATCH_WAKEUP,     /**< the loop is asked to stop, or to detach pipes */
+  INET_WATCH_LISTEN,     /**< a peer connects */
+  INET_WATCH_HANDSHAKE,  /**< a peer sends the identifier of its stream */
+  INET_WATCH_SOCKET,     /**< a pipe receives data */
+  INET_WATCH_ROOM        /**< a pipe freed room in its ring */
+} inet_watch_type;
+
+/** What an epoll event is about, pointed by its data */
+typedef struct inet_watch {
+  inet_watch_type eType;
+  void* pOwner;
+} inet_watch;
+
+/** A peer of a shared server that has not sent its stream identifier yet */
+typedef struct inet_handshake {
+  inet_watch watch;
+  int fd;
+  char id[INET_PIPE_ID_SIZE];
+  int nId;
+  struct inet_handshake* pNext;
+} inet_handshake;
+
+/** A receive loop: a thread waiting with epoll on the sockets of its pipes.
+ * A loop is private to a pipe, or is one of the loops of a shared server.
+ */
+typedef struct inet_loop {
+  inet_watch wakeup;
+  inet_watch listen;
+  int epfd;
+  int efd;          /**< wakes the loop up */
+  int sfd;          /**< listening socket, SOCKET_ERROR if none */
+  pthread_t thread;
+  int bStop;
+
+  struct inet_server* pServer;      /**< NULL for a private loop */
+  struct inet_ContentPipe* pPipe;   /**< the pipe of a private loop */
+  inet_handshake* pHandshakes;
+
+  /* the pipes closed are detached by the loop, between two epoll_wait */
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  struct inet_ContentPipe* pDetach;
+} inet_loop;
+
+/** A server shared by the pipes created on a port with a stream identifier.
+ * The peers send the identifier of their stream on connection, and the loop
+ * that accepts them receives into the ring of the pipe of that stream.
+ */
+typedef struct inet_server {
+  int nPort;
+  pthread_mutex_t mutex;  /**< protects the list of the streams */
+  int nLoops;
+  inet_loop loops[INET_PIPE_MAX_LOOPS];
+  struct inet_ContentPipe* pStreams;  /**< the pipes created on the port */
+  struct inet_server* pNext;
+} inet_server;
+
+typedef struct inet_ContentPipe {
 
   /* public */
   CP_PIPETYPE pipe;
 
   /* private */
-  int sfd;
   int cfd;
 
+  /* the ring, filled by the receive loop and emptied by the client without
+   * locks. The positions only grow, and are taken modulo the size of the ring.
+   */
+  CPbyte* pRing;
+  size_t nRingSize;
+  size_t nHead;     /**< end of the data received, written by the receive loop */
+  size_t nTail;     /**< end of the data released, written by the client */
+  size_t nRead;     /**< end of the data given to the client */
+  int bEnd;         /**< the peer closed the connection, or it failed */
+
+  inet_pipe_buffer buffers[INET_PIPE_MAX_BUFFERS];
+  int nFirstBuffer;
+  int nBuffers;
+
+  /* the receive loop, woken through the event descriptor when the client
+   * frees room in the ring
+   */
+  inet_loop* pLoop;
+  int bPrivateLoop;
+  int bStarted;
+  int efd;
+  int bWaitingRoom;  /**< the receive loop waits for room in the ring */
+  inet_watch watchSocket;
+  inet_watch watchRoom;
+
+  /* the stream of a shared server */
+  char id[INET_PIPE_ID_SIZE];
+  inet_server* pServer;
+  struct inet_ContentPipe* pNextStream;
+  struct inet_ContentPipe* pNextDetach;
+  int bAttached;
+
+  /* the client sleeps on the condition only when Read has to wait */
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int bWaitingData;
+
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+  CPuint nBytesWaited;  /**< bytes to notify with CP_BytesAvailable, 0 if none */
+  size_t nWaitedEnd;    /**< position the bytes waited end at */
+
 } inet_ContentPipe;
 
 #endif
@@ -0,0 +1,707 @@
+/**
+  src/content_pipe_mem.c
+
+  This file implements the support for content pipes related to memory.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "content_pipe_mem.h"
+
+/* The arenas with a name, shared by the pipes of the process */
+static pthread_mutex_t arenasMutex = PTHREAD_MUTEX_INITIALIZER;
+static mem_arena* pArenas = NULL;
+
+static mem_arena* arenaNew(void)
+{
+  pthread_mutexattr_t attr;
+  mem_arena* pArena;
+
+  pArena = (mem_arena*) calloc(1, sizeof(mem_arena));
+  if(NULL == pArena)
+    return NULL;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&pArena->mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+  pthread_cond_init(&pArena->cond, NULL);
+  pArena->nRefs = 1;
+
+  return pArena;
+}
+
+static void arenaFree(mem_arena* pArena)
+{
+  int i;
+
+  if(!pArena->bFixed)
+    for(i = 0; i < pArena->nChunks; i++)
+      free(pArena->pChunks[i]);
+  free(pArena->szName);
+  pthread_cond_destroy(&pArena->cond);
+  pthread_mutex_destroy(&pArena->mutex);
+  free(pArena);
+}
+
+/** Finds the arena of a name, and makes it if asked to */
+static CPresult arenaGet(const char* szName, int bCreate, mem_arena** ppArena)
+{
+  mem_arena* pArena;
+  CPresult err = 0;
+
+  pthread_mutex_lock(&arenasMutex);
+  for(pArena = pArenas; NULL != pArena; pArena = pArena->pNext)
+    if(0 == strcmp(pArena->szName, szName))
+      break;
+
+  if(NULL != pArena) {
+    pArena->nRefs++;
+  } else if(!bCreate) {
+    err = KD_ENOENT;
+  } else {
+    pArena = arenaNew();
+    if(NULL != pArena)
+      pArena->szName = strdup(szName);
+    if(NULL == pArena || NULL == pArena->szName) {
+      if(NULL != pArena)
+        arenaFree(pArena);
+      err = KD_ENOMEM;
+    } else {
+      pArena->pNext = pArenas;
+      pArenas = pArena;
+    }
+  }
+  pthread_mutex_unlock(&arenasMutex);
+
+  *ppArena = pArena;
+  return err;
+}
+
+/** Releases an arena, freed with its last pipe */
+static void arenaRelease(mem_arena* pArena)
+{
+  mem_arena** ppArena;
+
+  pthread_mutex_lock(&arenasMutex);
+  if(0 == --pArena->nRefs) {
+    if(NULL != pArena->szName) {
+      for(ppArena = &pArenas; *ppArena != pArena; ppArena = &(*ppArena)->pNext)
+        ;
+      *ppArena = pArena->pNext;
+    }
+    arenaFree(pArena);
+  }
+  pthread_mutex_unlock(&arenasMutex);
+}
+
+/** Finds the chunk holding an offset, the offset in it and the bytes left in it */
+static CPbyte* arenaLocate(mem_arena* pArena, size_t nOffset, size_t* pnLeft)
+{
+  size_t nStart = 0, nSize = MEM_PIPE_CHUNK_SIZE;
+  int i = 0;
+
+  if(pArena->bFixed) {
+    *pnLeft = pArena->nCapacity - nOffset;
+    return pArena->pChunks[0] + nOffset;
+  }
+  while(nOffset >= nStart + nSize) {
+    nStart += nSize;
+    nSize <<= 1;
+    i++;
+  }
+  *pnLeft = nStart + nSize - nOffset;
+  return pArena->pChunks[i] + (nOffset - nStart);
+}
+
+/** Adds chunks to an arena until it holds nEnd bytes */
+static CPresult arenaGrow(mem_arena* pArena, size_t nEnd)
+{
+  size_t nSize;
+
+  while(pArena->nCapacity < nEnd) {
+    if(pArena->bFixed)
+      return KD_ENOSPC;
+    if(MEM_PIPE_MAX_CHUNKS == pArena->nChunks)
+      return KD_ENOMEM;
+    nSize = (size_t) MEM_PIPE_CHUNK_SIZE << pArena->nChunks;
+    pArena->pChunks[pArena->nChunks] = (CPbyte*) malloc(nSize);
+    if(NULL == pArena->pChunks[pArena->nChunks])
+      return KD_ENOMEM;
+    pArena->nChunks++;
+    pArena->nCapacity += nSize;
+  }
+
+  return 0;
+}
+
+static void arenaCopyOut(mem_arena* pArena, size_t nOffset, CPbyte* pData, size_t nSize)
+{
+  CPbyte* pChunk;
+  size_t nLeft, nCount;
+
+  while(nSize > 0) {
+    pChunk = arenaLocate(pArena, nOffset, &nLeft);
+    nCount = nSize < nLeft ? nSize : nLeft;
+    memcpy(pData, pChunk, nCount);
+    pData += nCount;
+    nOffset += nCount;
+    nSize -= nCount;
+  }
+}
+
+static void arenaCopyIn(mem_arena* pArena, size_t nOffset, const CPbyte* pData, size_t nSize)
+{
+  CPbyte* pChunk;
+  size_t nLeft, nCount;
+
+  while(nSize > 0) {
+    pChunk = arenaLocate(pArena, nOffset, &nLeft);
+    nCount = nSize < nLeft ? nSize : nLeft;
+    memcpy(pChunk, pData, nCount);
+    pData += nCount;
+    nOffset += nCount;
+    nSize -= nCount;
+  }
+}
+
+/** Whether the content of an arena can still grow for a pipe, by the writes
+ * of the other pipes. Called with the arena locked.
+ */
+static int arenaMayGrow(mem_ContentPipe* pPipe)
+{
+  return pPipe->pArena->nWriters > (pPipe->bWriter ? 1 : 0);
+}
+
+/** Wakes the readers up, and sends CP_BytesAvailable to the pipes whose bytes
+ * waited were written, or will never be. Called with the arena locked.
+ */
+static void arenaNotify(mem_arena* pArena)
+{
+  mem_ContentPipe* pPipe;
+  CPuint nWaited;
+
+  pthread_cond_broadcast(&pArena->cond);
+  for(pPipe = pArena->pPipes; NULL != pPipe; pPipe = pPipe->pNext) {
+    if(0 == pPipe->nBytesWaited || (pArena->nSize < pPipe->nWaitedEnd && arenaMayGrow(pPipe)))
+      continue;
+    nWaited = pPipe->nBytesWaited;
+    pPipe->nBytesWaited = 0;
+    if(NULL != pPipe->ClientCallback)
+      pPipe->ClientCallback(CP_BytesAvailable, nWaited);
+  }
+}
+
+/** Waits until nSize bytes can be read, or no more will be written, and
+ * returns the bytes that can be read. Called with the arena locked.
+ */
+static size_t waitContent(mem_ContentPipe* pPipe, size_t nSize)
+{
+  mem_arena* pArena = pPipe->pArena;
+
+  while(pArena->nSize < pPipe->nPosition + nSize && arenaMayGrow(pPipe))
+    pthread_cond_wait(&pArena->cond, &pArena->mutex);
+
+  return pArena->nSize > pPipe->nPosition ? pArena->nSize - pPipe->nPosition : 0;
+}
+
+/** Attaches a pipe to its arena */
+static void attach(mem_ContentPipe* pPipe, mem_arena* pArena, int bWriter)
+{
+  pthread_mutex_lock(&pArena->mutex);
+  pPipe->pArena = pArena;
+  pPipe->nPosition = 0;
+  pPipe->bWriter = bWriter;
+  if(bWriter)
+    pArena->nWriters++;
+  pPipe->pNext = pArena->pPipes;
+  pArena->pPipes = pPipe;
+  pthread_mutex_unlock(&pArena->mutex);
+}
+
+/** Parses the URI of a buffer of the client, as mem://0x12345678:4096 */
+static int parseBuffer(CPstring szURI, void** ppBuffer, size_t* pnSize)
+{
+  unsigned long nSize;
+  char cEnd;
+
+  if(2 != sscanf(szURI, "mem://%p:%lu%c", ppBuffer, &nSize, &cEnd) || NULL == *ppBuffer || 0 == nSize)
+    return 0;
+  *pnSize = (size_t) nSize;
+
+  return 1;
+}
+
+/** Makes the arena of a buffer of the client, that holds nContent bytes */
+static CPresult bufferArena(void* pBuffer, size_t nSize, size_t nContent, mem_arena** ppArena)
+{
+  mem_arena* pArena = arenaNew();
+
+  if(NULL == pArena)
+    return KD_ENOMEM;
+  pArena->bFixed = 1;
+  pArena->pChunks[0] = (CPbyte*) pBuffer;
+  pArena->nChunks = 1;
+  pArena->nCapacity = nSize;
+  pArena->nSize = nContent;
+  *ppArena = pArena;
+
+  return 0;
+}
+
+/*
+ * Create the content, empty, and open it for writing
+ * e.g. mem://clip for the arena clip of the process, or
+ * mem://0x12345678:4096 for a buffer of the client.
+*/
+static CPresult Create( CPhandle *hContent, CPstring szURI )
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena;
+  CPresult err;
+  void* pBuffer;
+  size_t nSize;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(parseBuffer(szURI, &pBuffer, &nSize)) {
+    err = bufferArena(pBuffer, nSize, 0, &pArena);
+  } else {
+    if(strlen(szURI) <= 6)
+      return KD_EINVAL;
+    err = arenaGet(szURI + 6, 1, &pArena);
+    if(0 == err) {
+      /* the content is truncated, as a file would be */
+      pthread_mutex_lock(&pArena->mutex);
+      pArena->nSize = 0;
+      pthread_mutex_unlock(&pArena->mutex);
+    }
+  }
+
+  if(0 == err)
+    attach(pPipe, pArena, 1);
+
+  return err;
+}
+
+/** Open the content for reading or writing.
+ ** The content of an arena lives while a pipe is open on it.
+*/
+static CPresult Open( CPhandle* hContent, CPstring szURI, CP_ACCESSTYPE eAccess )
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena;
+  CPresult err;
+  void* pBuffer;
+  size_t nSize;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(parseBuffer(szURI, &pBuffer, &nSize)) {
+    err = bufferArena(pBuffer, nSize, nSize, &pArena);
+  } else {
+    if(strlen(szURI) <= 6)
+      return KD_EINVAL;
+    err = arenaGet(szURI + 6, 0, &pArena);
+  }
+
+  if(0 == err)
+    attach(pPipe, pArena, CP_AccessRead != eAccess);
+
+  return err;
+}
+
+/** Close the content */
+static CPresult Close( CPhandle hContent )
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena = pPipe->pArena;
+  mem_ContentPipe** ppPipe;
+  mem_pipe_copy* pCopy;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pArena)
+    return KD_EBADF;
+
+  pthread_mutex_lock(&pArena->mutex);
+  for(ppPipe = &pArena->pPipes; *ppPipe != pPipe; ppPipe = &(*ppPipe)->pNext)
+    ;
+  *ppPipe = pPipe->pNext;
+  if(pPipe->bWriter && 0 == --pArena->nWriters)
+    arenaNotify(pArena);  /* the readers waiting will not get more */
+  pthread_mutex_unlock(&pArena->mutex);
+
+  while(NULL != (pCopy = pPipe->pCopies)) {
+    pPipe->pCopies = pCopy->pNext;
+    free(pCopy->pBuffer);
+    free(pCopy);
+  }
+  free(pPipe->pWriteBuffer);
+  pPipe->pWriteBuffer = NULL;
+
+  arenaRelease(pArena);
+  pPipe->pArena = NULL;
+
+  return 0;
+}
+
+/** Check the that specified number of bytes are available for reading or writing (depending on access type).*/
+static CPresult CheckAvailableBytes( CPhandle hContent, CPuint nBytesRequested, CP_CHECKBYTESRESULTTYPE *eResult )
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena = pPipe->pArena;
+  size_t nAvailable;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pArena)
+    return KD_EBADF;
+
+  pthread_mutex_lock(&pArena->mutex);
+  nAvailable = pArena->nSize > pPipe->nPosition ? pArena->nSize - pPipe->nPosition : 0;
+  if(nAvailable >= nBytesRequested) {
+    *eResult = CP_CheckBytesOk;
+  } else if(!arenaMayGrow(pPipe) || pPipe->nPosition + nBytesRequested > (pArena->bFixed ? pArena->nCapacity : (size_t) -1)) {
+    *eResult = (0 == nAvailable) ? CP_CheckBytesAtEndOfStream : CP_CheckBytesInsufficientBytes;
+  } else {
+    *eResult = CP_CheckBytesNotReady;
+    pPipe->nWaitedEnd = pPipe->nPosition + nBytesRequested;
+    pPipe->nBytesWaited = nBytesRequested;
+  }
+  pthread_mutex_unlock(&pArena->mutex);
+
+  return 0;
+}
+
+/** Seek to certain position in the content relative to the specified origin. */
+static CPresult SetPosition( CPhandle  hContent, CPint nOffset, CP_ORIGINTYPE eOrigin)
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena = pPipe->pArena;
+  long nPosition;
+  CPresult err = 0;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pArena)
+    return KD_EBADF;
+
+  pthread_mutex_lock(&pArena->mutex);
+  switch(eOrigin) {
+  case CP_OriginBegin:
+    nPosition = nOffset;
+    break;
+  case CP_OriginCur:
+    nPosition = (long) pPipe->nPosition + nOffset;
+    break;
+  case CP_OriginEnd:
+    nPosition = (long) pArena->nSize + nOffset;
+    break;
+  default:
+    nPosition = -1;
+    break;
+  }
+  if(nPosition < 0 || (size_t) nPosition > pArena->nSize)
+    err = KD_EINVAL;
+  else
+    pPipe->nPosition = (size_t) nPosition;
+  pthread_mutex_unlock(&pArena->mutex);
+
+  return err;
+}
+
+/** Retrieve the current position relative to the start of the content. */
+static CPresult GetPosition( CPhandle hContent, CPuint *pPosition)
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pPipe->pArena)
+    return KD_EBADF;
+
+  *pPosition = (CPuint) pPipe->nPosition;
+
+  return 0;
+}
+
+/** Retrieve data of the specified size from the content stream (advance content pointer by size of data).
+    Note: pipe client provides pointer. This function is appropriate for small high frequency reads.
+    The call waits for the bytes still to be written by the other pipes of the arena. */
+static CPresult Read( CPhandle hContent, CPbyte *pData, CPuint nSize)
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena = pPipe->pArena;
+  size_t nCount;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pArena)
+    return KD_EBADF;
+
+  pthread_mutex_lock(&pArena->mutex);
+  nCount = waitContent(pPipe, nSize);
+  if(nCount > nSize)
+    nCount = nSize;
+  arenaCopyOut(pArena, pPipe->nPosition, pData, nCount);
+  pPipe->nPosition += nCount;
+  pthread_mutex_unlock(&pArena->mutex);
+
+  return nCount < nSize ? KD_EIO : 0;
+}
+
+/** Retrieve a buffer allocated by the pipe that contains the requested number of bytes.
+    Buffer contains the next block of bytes, as specified by nSize, of the content. nSize also
+    returns the size of the block actually read. Content pointer advances the by the returned size.
+    Note: pipe provides pointer. This function is appropriate for large reads. The client must call
+    ReleaseReadBuffer when done with buffer.
+
+    In some cases the requested block may not reside in contiguous memory within the
+    pipe implementation. For instance if the pipe leverages a circular buffer then the requested
+    block may straddle the boundary of the circular buffer. By default a pipe implementation
+    performs a copy in this case to provide the block to the pipe client in one contiguous buffer.
+    If, however, the client sets bForbidCopy, then the pipe returns only those bytes preceding the memory
+    boundary. Here the client may retrieve the data in segments over successive calls.
+
+    The buffer points into the arena, and is copied only across two of its chunks. The call
+    waits only when nothing can be read yet. */
+static CPresult ReadBuffer( CPhandle hContent, CPbyte **ppBuffer, CPuint *nSize, CPbool bForbidCopy)
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena = pPipe->pArena;
+  mem_pipe_copy* pCopy;
+  size_t nCount, nLeft;
+  CPresult err = 0;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pArena)
+    return KD_EBADF;
+
+  pthread_mutex_lock(&pArena->mutex);
+  nCount = waitContent(pPipe, 1);
+  if(nCount > *nSize)
+    nCount = *nSize;
+
+  if(0 == nCount) {
+    err = KD_EIO;  /* end of the content */
+  } else {
+    *ppBuffer = arenaLocate(pArena, pPipe->nPosition, &nLeft);
+    if(nCount > nLeft) {
+      if(bForbidCopy) {
+        nCount = nLeft;
+      } else {
+        pCopy = (mem_pipe_copy*) malloc(sizeof(mem_pipe_copy));
+        if(NULL != pCopy)
+          pCopy->pBuffer = (CPbyte*) malloc(nCount);
+        if(NULL == pCopy || NULL == pCopy->pBuffer) {
+          free(pCopy);
+          err = KD_ENOMEM;
+        } else {
+          arenaCopyOut(pArena, pPipe->nPosition, pCopy->pBuffer, nCount);
+          pCopy->pNext = pPipe->pCopies;
+          pPipe->pCopies = pCopy;
+          *ppBuffer = pCopy->pBuffer;
+        }
+      }
+    }
+  }
+  if(0 == err)
+    pPipe->nPosition += nCount;
+  else
+    nCount = 0;
+  *nSize = (CPuint) nCount;
+  pthread_mutex_unlock(&pArena->mutex);
+
+  return err;
+}
+
+/** Release a buffer obtained by ReadBuffer back to the pipe. */
+static CPresult ReleaseReadBuffer(CPhandle hContent, CPbyte *pBuffer)
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_pipe_copy** ppCopy;
+  mem_pipe_copy* pCopy;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  /* the buffers pointing into the arena need nothing */
+  for(ppCopy = &pPipe->pCopies; NULL != *ppCopy; ppCopy = &(*ppCopy)->pNext) {
+    if((*ppCopy)->pBuffer == pBuffer) {
+      pCopy = *ppCopy;
+      *ppCopy = pCopy->pNext;
+      free(pCopy->pBuffer);
+      free(pCopy);
+      break;
+    }
+  }
+
+  return 0;
+}
+
+/** Makes the bytes written up to the position visible to the other pipes.
+ * Called with the arena locked.
+ */
+static void written(mem_ContentPipe* pPipe)
+{
+  if(pPipe->nPosition > pPipe->pArena->nSize) {
+    pPipe->pArena->nSize = pPipe->nPosition;
+    arenaNotify(pPipe->pArena);
+  }
+}
+
+/** Write data of the specified size to the content (advance content pointer by size of data).
+    Note: pipe client provides pointer. This function is appropriate for small high frequency writes. */
+static CPresult Write( CPhandle hContent, CPbyte *pData, CPuint nSize)
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena = pPipe->pArena;
+  CPresult err;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pArena || !pPipe->bWriter)
+    return KD_EBADF;
+
+  pthread_mutex_lock(&pArena->mutex);
+  err = arenaGrow(pArena, pPipe->nPosition + nSize);
+  if(0 == err) {
+    arenaCopyIn(pArena, pPipe->nPosition, pData, nSize);
+    pPipe->nPosition += nSize;
+    written(pPipe);
+  }
+  pthread_mutex_unlock(&pArena->mutex);
+
+  return err;
+}
+
+/** Retrieve a buffer allocated by the pipe used to write data to the content.
+    Client will fill buffer with output data. Note: pipe provides pointer. This function is appropriate
+    for large writes. The client must call WriteBuffer when done it has filled the buffer with data.
+    The buffer points into the arena, and is a copy only across two of its chunks. */
+static CPresult GetWriteBuffer( CPhandle hContent, CPbyte **ppBuffer, CPuint nSize)
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena = pPipe->pArena;
+  size_t nLeft;
+  CPresult err;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pArena || !pPipe->bWriter)
+    return KD_EBADF;
+  if(NULL != pPipe->pWriteBuffer)
+    return KD_EBUSY;
+
+  pthread_mutex_lock(&pArena->mutex);
+  err = arenaGrow(pArena, pPipe->nPosition + nSize);
+  if(0 == err) {
+    *ppBuffer = arenaLocate(pArena, pPipe->nPosition, &nLeft);
+    if(nSize > nLeft) {
+      pPipe->pWriteBuffer = (CPbyte*) malloc(nSize);
+      if(NULL == pPipe->pWriteBuffer)
+        err = KD_ENOMEM;
+      pPipe->nWriteBufferSize = nSize;
+      *ppBuffer = pPipe->pWriteBuffer;
+    }
+  }
+  pthread_mutex_unlock(&pArena->mutex);
+
+  return err;
+}
+
+/** Deliver a buffer obtained via GetWriteBuffer to the pipe. Pipe will write the
+    the contents of the buffer to content and advance content pointer by the size of the buffer */
+static CPresult WriteBuffer( CPhandle hContent, CPbyte *pBuffer, CPuint nFilledSize)
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+  mem_arena* pArena = pPipe->pArena;
+  size_t nLeft;
+  CPresult err = 0;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL == pArena || !pPipe->bWriter)
+    return KD_EBADF;
+
+  pthread_mutex_lock(&pArena->mutex);
+  if(NULL != pPipe->pWriteBuffer && pBuffer == pPipe->pWriteBuffer) {
+    if(nFilledSize > pPipe->nWriteBufferSize) {
+      err = KD_EINVAL;
+    } else {
+      arenaCopyIn(pArena, pPipe->nPosition, pBuffer, nFilledSize);
+      free(pPipe->pWriteBuffer);
+      pPipe->pWriteBuffer = NULL;
+    }
+  } else if(pBuffer != arenaLocate(pArena, pPipe->nPosition, &nLeft) || nFilledSize > nLeft) {
+    err = KD_EINVAL;
+  }
+  if(0 == err) {
+    pPipe->nPosition += nFilledSize;
+    written(pPipe);
+  }
+  pthread_mutex_unlock(&pArena->mutex);
+
+  return err;
+}
+
+/** Register a per-handle client callback with the content pipe. */
+static CPresult RegisterCallback( CPhandle hContent, CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam))
+{
+  mem_ContentPipe* pPipe = (mem_ContentPipe*) hContent;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_mem:%s \n", __func__);
+
+  if(NULL != pPipe->pArena)
+    pthread_mutex_lock(&pPipe->pArena->mutex);
+  pPipe->ClientCallback = ClientCallback;
+  if(NULL != pPipe->pArena)
+    pthread_mutex_unlock(&pPipe->pArena->mutex);
+
+  return 0;
+}
+
+CPresult mem_pipe_Constructor(CP_PIPETYPE **ppPipe, CPstring szURI)
+{
+  mem_ContentPipe* pPipe;
+
+  pPipe = (mem_ContentPipe*) calloc(1, sizeof(mem_ContentPipe));
+
+  if(NULL == pPipe)
+    return KD_ENOMEM;
+
+  pPipe->pipe.Open = Open;
+  pPipe->pipe.Close = Close;
+  pPipe->pipe.Create = Create;
+  pPipe->pipe.CheckAvailableBytes = CheckAvailableBytes;
+  pPipe->pipe.SetPosition = SetPosition;
+  pPipe->pipe.GetPosition = GetPosition;
+  pPipe->pipe.Read = Read;
+  pPipe->pipe.ReadBuffer = ReadBuffer;
+  pPipe->pipe.ReleaseReadBuffer = ReleaseReadBuffer;
+  pPipe->pipe.Write = Write;
+  pPipe->pipe.GetWriteBuffer = GetWriteBuffer;
+  pPipe->pipe.WriteBuffer = WriteBuffer;
+  pPipe->pipe.RegisterCallback = RegisterCallback;
+
+  *ppPipe = (CP_PIPETYPE*) pPipe;
+
+  return 0;
+}
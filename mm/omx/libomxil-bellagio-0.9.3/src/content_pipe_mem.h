@@ -0,0 +1,98 @@
+/**
+  src/content_pipe_mem.h
+
+  This file implements the support for content pipes related to memory.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __CONTENT_PIPE_MEM_H__
+#define __CONTENT_PIPE_MEM_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
+
+#include "omx_comp_debug_levels.h"
+
+/** Size of the first chunk of a growable arena, each next chunk is twice the
+ * previous one. The chunks never move, so that the buffers returned by
+ * ReadBuffer stay valid while the arena grows.
+ */
+#define MEM_PIPE_CHUNK_SIZE (64 * 1024)
+#define MEM_PIPE_MAX_CHUNKS 32
+
+struct mem_ContentPipe;
+
+/** The memory of a mem:// content: a growable arena shared by the pipes
+ * opened on its name in the process, or a buffer of the client, as in
+ * mem://0x12345678:4096, that belongs to one pipe and does not grow.
+ */
+typedef struct mem_arena {
+  char* szName;           /**< NULL for a buffer of the client */
+  CPbyte* pChunks[MEM_PIPE_MAX_CHUNKS];
+  int nChunks;
+  size_t nCapacity;
+  size_t nSize;           /**< end of the content written */
+  int bFixed;             /**< a buffer of the client */
+  int nRefs;
+  int nWriters;
+  struct mem_ContentPipe* pPipes;  /**< the pipes open on the arena */
+
+  /* recursive, so that the callbacks can call the pipe back */
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+
+  struct mem_arena* pNext;
+} mem_arena;
+
+/** A copy made by ReadBuffer for a block across two chunks */
+typedef struct mem_pipe_copy {
+  CPbyte* pBuffer;
+  struct mem_pipe_copy* pNext;
+} mem_pipe_copy;
+
+typedef struct mem_ContentPipe {
+
+  /* public */
+  CP_PIPETYPE pipe;
+
+  /* private */
+  mem_arena* pArena;
+  size_t nPosition;
+  int bWriter;
+
+  mem_pipe_copy* pCopies;
+  CPbyte* pWriteBuffer;   /**< copy given by GetWriteBuffer for a block across two chunks */
+  size_t nWriteBufferSize;
+
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+  CPuint nBytesWaited;    /**< bytes to notify with CP_BytesAvailable, 0 if none */
+  size_t nWaitedEnd;      /**< position the bytes waited end at */
+
+  struct mem_ContentPipe* pNext;
+
+} mem_ContentPipe;
+
+#endif
@@ -0,0 +1,44 @@
+/**
+  src/content_pipe_scheme.h
+
+  Bellagio extension of the OpenMAX core adding schemes of content pipe URIs
+  to OMX_GetContentPipe. It only depends on the OpenMAX headers, so that an
+  IL client can include it along with its own debug macros.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __CONTENT_PIPE_SCHEME_H__
+#define __CONTENT_PIPE_SCHEME_H__
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
+
+/** Builds the content pipe for an URI of a scheme, as OMX_GetContentPipe returns it */
+typedef CPresult (*BOSA_CONTENTPIPECONSTRUCTOR)(CP_PIPETYPE **ppPipe, CPstring szURI);
+
+/** Makes OMX_GetContentPipe build the pipes of the URIs "scheme:..." with the
+ * given constructor, in place of the one of the scheme if it has one already.
+ * The schemes added are forgotten by OMX_Deinit.
+ */
+OMX_ERRORTYPE BOSA_AddContentPipeScheme(OMX_STRING scheme, BOSA_CONTENTPIPECONSTRUCTOR constructor);
+
+#endif
@@ -0,0 +1,675 @@
+/**
+  src/content_pipe_shm.c
+
+  This file implements the support for content pipes related to shared memory.
+
+  A pipe created as shm://name makes the POSIX shared memory /name, and writes
+  to it as the producer of a ring. A pipe opened on the same name, in any
+  process, reads from it as the consumer, and removes the name: the memory
+  then lives while the two pipes are open. The ring is a single producer,
+  single consumer ring without locks, and ReadBuffer and GetWriteBuffer give
+  pointers into it, never copies.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "content_pipe_shm.h"
+
+/* The header is shared with another process: its fields are accessed
+ * atomically, and sequential consistency makes sure that the side that waits
+ * and the side that moves a position see each other.
+ */
+#define SHM_LOAD(x) __atomic_load_n(&(x), __ATOMIC_SEQ_CST)
+#define SHM_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_SEQ_CST)
+#define SHM_ADD(x, v) __atomic_add_fetch(&(x), (v), __ATOMIC_SEQ_CST)
+
+static void futexWait(uint32_t* pWord, uint32_t nValue)
+{
+  syscall(SYS_futex, pWord, FUTEX_WAIT, nValue, NULL, NULL, 0);
+}
+
+/** Wakes the other side up if it waits on a sequence */
+static void wakeSequence(uint32_t* pSequence, uint32_t* pWaiters)
+{
+  if(0 != __atomic_load_n(pWaiters, __ATOMIC_SEQ_CST)) {
+    __atomic_add_fetch(pSequence, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, pSequence, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+  }
+}
+
+/** Waits until the producer wrote up to nEnd, or closed the pipe, or *pbStop is set */
+static void waitHead(shm_ContentPipe* pPipe, uint64_t nEnd, int* pbStop)
+{
+  shm_pipe_header* pHeader = pPipe->pHeader;
+  uint32_t nSequence;
+
+  for(;;) {
+    if(SHM_LOAD(pHeader->nHead) >= nEnd || SHM_LOAD(pHeader->bClosed) || (pbStop && SHM_LOAD(*pbStop)))
+      return;
+    nSequence = SHM_LOAD(pHeader->nHeadSequence);
+    SHM_ADD(pHeader->nHeadWaiters, 1);
+    if(SHM_LOAD(pHeader->nHead) < nEnd && !SHM_LOAD(pHeader->bClosed) && !(pbStop && SHM_LOAD(*pbStop)))
+      futexWait(&pHeader->nHeadSequence, nSequence);
+    SHM_ADD(pHeader->nHeadWaiters, -1);
+  }
+}
+
+/** Waits until the ring has room for nSize bytes, or the consumer closed the pipe */
+static void waitRoom(shm_ContentPipe* pPipe, size_t nSize)
+{
+  shm_pipe_header* pHeader = pPipe->pHeader;
+  uint64_t nHead = pHeader->nHead;
+  uint32_t nSequence;
+
+  for(;;) {
+    if(pPipe->nRingSize - (nHead - SHM_LOAD(pHeader->nTail)) >= nSize || SHM_LOAD(pHeader->bConsumerClosed))
+      return;
+    nSequence = SHM_LOAD(pHeader->nTailSequence);
+    SHM_ADD(pHeader->nTailWaiters, 1);
+    if(pPipe->nRingSize - (nHead - SHM_LOAD(pHeader->nTail)) < nSize && !SHM_LOAD(pHeader->bConsumerClosed))
+      futexWait(&pHeader->nTailSequence, nSequence);
+    SHM_ADD(pHeader->nTailWaiters, -1);
+  }
+}
+
+static void publishHead(shm_ContentPipe* pPipe, uint64_t nHead)
+{
+  SHM_STORE(pPipe->pHeader->nHead, nHead);
+  wakeSequence(&pPipe->pHeader->nHeadSequence, &pPipe->pHeader->nHeadWaiters);
+}
+
+static void setTail(shm_ContentPipe* pPipe, uint64_t nTail)
+{
+  SHM_STORE(pPipe->pHeader->nTail, nTail);
+  wakeSequence(&pPipe->pHeader->nTailSequence, &pPipe->pHeader->nTailWaiters);
+}
+
+/** Frees the ring up to the buffers released in order */
+static void releaseBuffers(shm_ContentPipe* pPipe)
+{
+  shm_pipe_buffer* pBuffer;
+  uint64_t nTail = 0;
+  int bMoved = 0;
+
+  while(0 != pPipe->nBuffers) {
+    pBuffer = &pPipe->buffers[pPipe->nFirstBuffer];
+    if(!pBuffer->bReleased)
+      break;
+    nTail = pBuffer->nEnd;
+    bMoved = 1;
+    pPipe->nFirstBuffer = (pPipe->nFirstBuffer + 1) % SHM_PIPE_MAX_BUFFERS;
+    pPipe->nBuffers--;
+  }
+  if(bMoved)
+    setTail(pPipe, nTail);
+}
+
+/** Records a buffer given to the consumer, that holds the ring up to nEnd */
+static shm_pipe_buffer* addBuffer(shm_ContentPipe* pPipe, uint64_t nEnd)
+{
+  shm_pipe_buffer* pBuffer;
+
+  if(SHM_PIPE_MAX_BUFFERS == pPipe->nBuffers)
+    return NULL;
+  pBuffer = &pPipe->buffers[(pPipe->nFirstBuffer + pPipe->nBuffers) % SHM_PIPE_MAX_BUFFERS];
+  pPipe->nBuffers++;
+  pBuffer->pBuffer = NULL;
+  pBuffer->nEnd = nEnd;
+  pBuffer->bReleased = 0;
+
+  return pBuffer;
+}
+
+/** Sends CP_BytesAvailable to the consumer once the bytes it waits for are
+ * written, or the producer closed the pipe
+ */
+static void* notifyThread(void* param)
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) param;
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+  uint64_t nWaitedEnd;
+  CPuint nWaited;
+
+  for(;;) {
+    pthread_mutex_lock(&pPipe->mutex);
+    while(!pPipe->bStopNotify && 0 == pPipe->nBytesWaited)
+      pthread_cond_wait(&pPipe->cond, &pPipe->mutex);
+    nWaitedEnd = pPipe->nWaitedEnd;
+    pthread_mutex_unlock(&pPipe->mutex);
+    if(SHM_LOAD(pPipe->bStopNotify))
+      break;
+
+    waitHead(pPipe, nWaitedEnd, &pPipe->bStopNotify);
+
+    pthread_mutex_lock(&pPipe->mutex);
+    nWaited = pPipe->bStopNotify ? 0 : pPipe->nBytesWaited;
+    pPipe->nBytesWaited = 0;
+    pthread_mutex_unlock(&pPipe->mutex);
+    ClientCallback = SHM_LOAD(pPipe->ClientCallback);
+    if(0 != nWaited && NULL != ClientCallback)
+      ClientCallback(CP_BytesAvailable, nWaited);
+  }
+
+  return NULL;
+}
+
+/** Makes the name of the shared memory out of the URI, as /name for shm://name */
+static CPresult shmName(CPstring szURI, char* szName)
+{
+  if(strncmp(szURI, "shm://", 6) || '\0' == szURI[6] || NULL != strchr(szURI + 6, '/') ||
+     strlen(szURI + 6) + 1 >= NAME_MAX)
+    return KD_EINVAL;
+  sprintf(szName, "/%s", szURI + 6);
+
+  return 0;
+}
+
+/** Maps the header and the ring, and the ring again right after it */
+static CPresult mapRing(shm_ContentPipe* pPipe, size_t nRingSize)
+{
+  size_t nPageSize = sysconf(_SC_PAGESIZE);
+  CPbyte* pBase;
+
+  pPipe->nRingSize = nRingSize;
+  pPipe->nMapSize = nPageSize + 2 * nRingSize;
+  pBase = (CPbyte*) mmap(NULL, pPipe->nMapSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(MAP_FAILED == pBase)
+    return KD_ENOMEM;
+  if(MAP_FAILED == mmap(pBase, nPageSize + nRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, pPipe->fd, 0) ||
+     MAP_FAILED == mmap(pBase + nPageSize + nRingSize, nRingSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_FIXED, pPipe->fd, nPageSize)) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_shm: could not map the ring\n");
+    munmap(pBase, pPipe->nMapSize);
+    return KD_ENOMEM;
+  }
+  pPipe->pMap = pBase;
+  pPipe->pHeader = (shm_pipe_header*) pBase;
+  pPipe->pRing = pBase + nPageSize;
+
+  return 0;
+}
+
+static void start(shm_ContentPipe* pPipe, int bProducer)
+{
+  pPipe->bProducer = bProducer;
+  pPipe->nRead = 0;
+  pPipe->nFirstBuffer = pPipe->nBuffers = 0;
+  pPipe->pWriteBuffer = NULL;
+  pPipe->nBytesWaited = 0;
+  pPipe->bNotifyThread = 0;
+  pPipe->bStopNotify = 0;
+  pthread_mutex_init(&pPipe->mutex, NULL);
+  pthread_cond_init(&pPipe->cond, NULL);
+}
+
+/*
+ * Create the shared memory, and open it as the producer of the ring.
+ * Fails with KD_EEXIST if the name is already used by another ring.
+*/
+static CPresult Create( CPhandle *hContent, CPstring szURI )
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  const char* config = getenv(SHM_PIPE_ENV);
+  size_t nRingSize = SHM_PIPE_RING_SIZE;
+  size_t nPageSize = sysconf(_SC_PAGESIZE);
+  char szName[NAME_MAX];
+  CPresult err;
+  size_t nSize;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  err = shmName(szURI, szName);
+  if(0 != err)
+    return err;
+
+  if(NULL != config && 0 == strncmp(config, "ring=", 5) && atoi(config + 5) > 0) {
+    nSize = (size_t) atoi(config + 5) * 1024;
+    for(nRingSize = nPageSize; nRingSize < nSize; nRingSize <<= 1)
+      ;
+  }
+
+  /* a name that exists belongs to a ring another pipe may have mapped */
+  pPipe->fd = shm_open(szName, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if(-1 == pPipe->fd) {
+    DEBUG(DEB_LEV_ERR, "content_pipe_shm: could not create %s\n", szName);
+    return EEXIST == errno ? KD_EEXIST : KD_EACCES;
+  }
+  if(-1 == ftruncate(pPipe->fd, nPageSize + nRingSize))
+    err = KD_ENOSPC;
+  if(0 == err)
+    err = mapRing(pPipe, nRingSize);
+  if(0 != err) {
+    close(pPipe->fd);
+    pPipe->fd = -1;
+    shm_unlink(szName);
+    return err;
+  }
+
+  memset(pPipe->pHeader, 0, sizeof(shm_pipe_header));
+  pPipe->pHeader->nRingSize = (uint32_t) nRingSize;
+  SHM_STORE(pPipe->pHeader->nMagic, SHM_PIPE_MAGIC);
+  start(pPipe, 1);
+
+  return 0;
+}
+
+/** Open the shared memory created by another pipe, as the consumer of the ring. */
+static CPresult Open( CPhandle* hContent, CPstring szURI, CP_ACCESSTYPE eAccess )
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  size_t nPageSize = sysconf(_SC_PAGESIZE);
+  shm_pipe_header* pHeader;
+  char szName[NAME_MAX];
+  struct stat sStat;
+  size_t nRingSize = 0;
+  CPresult err;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(CP_AccessRead != eAccess)
+    return KD_EACCES;
+  err = shmName(szURI, szName);
+  if(0 != err)
+    return err;
+
+  pPipe->fd = shm_open(szName, O_RDWR, 0);
+  if(-1 == pPipe->fd)
+    return KD_ENOENT;
+
+  /* the producer wrote the size of the ring in the header */
+  if(-1 == fstat(pPipe->fd, &sStat) || sStat.st_size < (off_t) nPageSize) {
+    err = KD_EINVAL;
+  } else {
+    pHeader = (shm_pipe_header*) mmap(NULL, nPageSize, PROT_READ, MAP_SHARED, pPipe->fd, 0);
+    if(MAP_FAILED == pHeader) {
+      err = KD_ENOMEM;
+    } else {
+      if(SHM_PIPE_MAGIC == SHM_LOAD(pHeader->nMagic))
+        nRingSize = pHeader->nRingSize;
+      munmap(pHeader, nPageSize);
+      if(0 == nRingSize || sStat.st_size < (off_t) (nPageSize + nRingSize))
+        err = KD_EINVAL;
+    }
+  }
+  if(0 == err)
+    err = mapRing(pPipe, nRingSize);
+  if(0 != err) {
+    close(pPipe->fd);
+    pPipe->fd = -1;
+    return err;
+  }
+
+  /* the ring has its two ends now, no other pipe may join */
+  shm_unlink(szName);
+  start(pPipe, 0);
+
+  return 0;
+}
+
+/** Close the pipe, telling the other side */
+static CPresult Close( CPhandle hContent )
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  shm_pipe_header* pHeader = pPipe->pHeader;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(NULL == pHeader)
+    return KD_EBADF;
+
+  if(pPipe->bProducer) {
+    SHM_STORE(pHeader->bClosed, 1);
+    wakeSequence(&pHeader->nHeadSequence, &pHeader->nHeadWaiters);
+  } else {
+    if(pPipe->bNotifyThread) {
+      pthread_mutex_lock(&pPipe->mutex);
+      SHM_STORE(pPipe->bStopNotify, 1);
+      pthread_cond_signal(&pPipe->cond);
+      pthread_mutex_unlock(&pPipe->mutex);
+      /* the thread may wait for the producer */
+      SHM_ADD(pHeader->nHeadSequence, 1);
+      syscall(SYS_futex, &pHeader->nHeadSequence, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+      pthread_join(pPipe->notifyThread, NULL);
+      pPipe->bNotifyThread = 0;
+    }
+    SHM_STORE(pHeader->bConsumerClosed, 1);
+    wakeSequence(&pHeader->nTailSequence, &pHeader->nTailWaiters);
+  }
+
+  munmap(pPipe->pMap, pPipe->nMapSize);
+  pPipe->pMap = NULL;
+  pPipe->pHeader = NULL;
+  pPipe->pRing = NULL;
+  close(pPipe->fd);
+  pPipe->fd = -1;
+  pthread_cond_destroy(&pPipe->cond);
+  pthread_mutex_destroy(&pPipe->mutex);
+
+  return 0;
+}
+
+/** Check the that specified number of bytes are available for reading or writing (depending on access type).*/
+static CPresult CheckAvailableBytes( CPhandle hContent, CPuint nBytesRequested, CP_CHECKBYTESRESULTTYPE *eResult )
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  shm_pipe_header* pHeader = pPipe->pHeader;
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+  uint64_t nAvailable, nCapacity;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(NULL == pHeader)
+    return KD_EBADF;
+
+  if(pPipe->bProducer) {
+    /* the room to write, the events are sent to the consumer only */
+    nAvailable = pPipe->nRingSize - (pHeader->nHead - SHM_LOAD(pHeader->nTail));
+    if(nAvailable >= nBytesRequested)
+      *eResult = CP_CheckBytesOk;
+    else if(SHM_LOAD(pHeader->bConsumerClosed))
+      *eResult = CP_CheckBytesAtEndOfStream;
+    else if(nBytesRequested > pPipe->nRingSize)
+      *eResult = CP_CheckBytesOutOfBuffers;
+    else
+      *eResult = CP_CheckBytesNotReady;
+    return 0;
+  }
+
+  nAvailable = SHM_LOAD(pHeader->nHead) - pPipe->nRead;
+  /* the buffers still out hold their part of the ring */
+  nCapacity = pPipe->nRingSize - (pPipe->nRead - SHM_LOAD(pHeader->nTail));
+
+  if(nAvailable >= nBytesRequested) {
+    *eResult = CP_CheckBytesOk;
+  } else if(SHM_LOAD(pHeader->bClosed)) {
+    nAvailable = SHM_LOAD(pHeader->nHead) - pPipe->nRead;
+    if(nAvailable >= nBytesRequested)
+      *eResult = CP_CheckBytesOk;
+    else
+      *eResult = (0 == nAvailable) ? CP_CheckBytesAtEndOfStream : CP_CheckBytesInsufficientBytes;
+  } else if(nBytesRequested > nCapacity) {
+    *eResult = CP_CheckBytesOutOfBuffers;
+    ClientCallback = SHM_LOAD(pPipe->ClientCallback);
+    if(NULL != ClientCallback)
+      ClientCallback(CP_Overflow, (CPuint) nCapacity);
+  } else {
+    *eResult = CP_CheckBytesNotReady;
+    pthread_mutex_lock(&pPipe->mutex);
+    pPipe->nWaitedEnd = pPipe->nRead + nBytesRequested;
+    pPipe->nBytesWaited = nBytesRequested;
+    if(!pPipe->bNotifyThread && NULL != SHM_LOAD(pPipe->ClientCallback))
+      pPipe->bNotifyThread = (0 == pthread_create(&pPipe->notifyThread, NULL, notifyThread, pPipe));
+    pthread_cond_signal(&pPipe->cond);
+    pthread_mutex_unlock(&pPipe->mutex);
+  }
+
+  return 0;
+}
+
+/** Seek to certain position in the content relative to the specified origin. */
+static CPresult SetPosition( CPhandle  hContent, CPint nOffset, CP_ORIGINTYPE eOrigin)
+{
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  return KD_EBADF;
+}
+
+/** Retrieve the current position relative to the start of the content. */
+static CPresult GetPosition( CPhandle hContent, CPuint *pPosition)
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(NULL == pPipe->pHeader)
+    return KD_EBADF;
+
+  *pPosition = (CPuint) (pPipe->bProducer ? pPipe->pHeader->nHead : pPipe->nRead);
+
+  return 0;
+}
+
+/** Retrieve data of the specified size from the content stream (advance content pointer by size of data).
+    Note: pipe client provides pointer. This function is appropriate for small high frequency reads. */
+static CPresult Read( CPhandle hContent, CPbyte *pData, CPuint nSize)
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  shm_pipe_buffer* pBuffer;
+  size_t nCopied = 0, nCount;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(NULL == pPipe->pHeader || pPipe->bProducer)
+    return KD_EBADF;
+
+  /* the data is copied as it comes, so that more than the ring can be read */
+  while(nCopied < nSize) {
+    waitHead(pPipe, pPipe->nRead + 1, NULL);
+    nCount = SHM_LOAD(pPipe->pHeader->nHead) - pPipe->nRead;
+    if(0 == nCount)
+      break;  /* end of stream */
+    if(nCount > nSize - nCopied)
+      nCount = nSize - nCopied;
+    memcpy(pData + nCopied, pPipe->pRing + (pPipe->nRead & (pPipe->nRingSize - 1)), nCount);
+    pPipe->nRead += nCount;
+    nCopied += nCount;
+
+    if(0 == pPipe->nBuffers) {
+      setTail(pPipe, pPipe->nRead);
+    } else {
+      /* the ring is freed once the buffers before are released */
+      pBuffer = addBuffer(pPipe, pPipe->nRead);
+      if(NULL == pBuffer)
+        return KD_EBUSY;
+      pBuffer->bReleased = 1;
+    }
+  }
+
+  return nCopied < nSize ? KD_EIO : 0;
+}
+
+/** Retrieve a buffer allocated by the pipe that contains the requested number of bytes.
+    Buffer contains the next block of bytes, as specified by nSize, of the content. nSize also
+    returns the size of the block actually read. Content pointer advances the by the returned size.
+    Note: pipe provides pointer. This function is appropriate for large reads. The client must call
+    ReleaseReadBuffer when done with buffer.
+
+    In some cases the requested block may not reside in contiguous memory within the
+    pipe implementation. For instance if the pipe leverages a circular buffer then the requested
+    block may straddle the boundary of the circular buffer. By default a pipe implementation
+    performs a copy in this case to provide the block to the pipe client in one contiguous buffer.
+    If, however, the client sets bForbidCopy, then the pipe returns only those bytes preceding the memory
+    boundary. Here the client may retrieve the data in segments over successive calls.
+
+    The ring is mapped twice in a row, so the buffer always points into the ring, across its
+    end too. The call waits only when nothing was written, and returns less than requested
+    when less was written. */
+static CPresult ReadBuffer( CPhandle hContent, CPbyte **ppBuffer, CPuint *nSize, CPbool bForbidCopy)
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  shm_pipe_buffer* pBuffer;
+  size_t nCount;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(NULL == pPipe->pHeader || pPipe->bProducer)
+    return KD_EBADF;
+  if(SHM_PIPE_MAX_BUFFERS == pPipe->nBuffers)
+    return KD_EBUSY;
+
+  waitHead(pPipe, pPipe->nRead + 1, NULL);
+  nCount = SHM_LOAD(pPipe->pHeader->nHead) - pPipe->nRead;
+  if(0 == nCount) {
+    *nSize = 0;
+    return KD_EIO;  /* end of stream */
+  }
+  if(nCount > *nSize)
+    nCount = *nSize;
+
+  pBuffer = addBuffer(pPipe, pPipe->nRead + nCount);
+  pBuffer->pBuffer = pPipe->pRing + (pPipe->nRead & (pPipe->nRingSize - 1));
+  pPipe->nRead += nCount;
+  *ppBuffer = pBuffer->pBuffer;
+  *nSize = (CPuint) nCount;
+
+  return 0;
+}
+
+/** Release a buffer obtained by ReadBuffer back to the pipe. */
+static CPresult ReleaseReadBuffer(CPhandle hContent, CPbyte *pBuffer)
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  shm_pipe_buffer* pEntry;
+  int i;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  for(i = 0; i < pPipe->nBuffers; i++) {
+    pEntry = &pPipe->buffers[(pPipe->nFirstBuffer + i) % SHM_PIPE_MAX_BUFFERS];
+    if(!pEntry->bReleased && pEntry->pBuffer == pBuffer) {
+      pEntry->bReleased = 1;
+      releaseBuffers(pPipe);
+      return 0;
+    }
+  }
+
+  return KD_EINVAL;
+}
+
+/** Write data of the specified size to the content (advance content pointer by size of data).
+    Note: pipe client provides pointer. This function is appropriate for small high frequency writes.
+    The call waits while the ring is full. */
+static CPresult Write( CPhandle hContent, CPbyte *pData, CPuint nSize)
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  shm_pipe_header* pHeader = pPipe->pHeader;
+  size_t nWritten = 0, nCount;
+  uint64_t nHead;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(NULL == pHeader || !pPipe->bProducer)
+    return KD_EBADF;
+
+  while(nWritten < nSize) {
+    waitRoom(pPipe, 1);
+    if(SHM_LOAD(pHeader->bConsumerClosed))
+      return KD_EIO;
+    nHead = pHeader->nHead;
+    nCount = pPipe->nRingSize - (nHead - SHM_LOAD(pHeader->nTail));
+    if(nCount > nSize - nWritten)
+      nCount = nSize - nWritten;
+    memcpy(pPipe->pRing + (nHead & (pPipe->nRingSize - 1)), pData + nWritten, nCount);
+    publishHead(pPipe, nHead + nCount);
+    nWritten += nCount;
+  }
+
+  return 0;
+}
+
+/** Retrieve a buffer allocated by the pipe used to write data to the content.
+    Client will fill buffer with output data. Note: pipe provides pointer. This function is appropriate
+    for large writes. The client must call WriteBuffer when done it has filled the buffer with data.
+    The buffer points into the ring, the call waits until it has room for the buffer. */
+static CPresult GetWriteBuffer( CPhandle hContent, CPbyte **ppBuffer, CPuint nSize)
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+  shm_pipe_header* pHeader = pPipe->pHeader;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(NULL == pHeader || !pPipe->bProducer)
+    return KD_EBADF;
+  if(NULL != pPipe->pWriteBuffer)
+    return KD_EBUSY;
+  if(nSize > pPipe->nRingSize)
+    return KD_EINVAL;
+
+  waitRoom(pPipe, nSize);
+  if(SHM_LOAD(pHeader->bConsumerClosed))
+    return KD_EIO;
+
+  pPipe->pWriteBuffer = pPipe->pRing + (pHeader->nHead & (pPipe->nRingSize - 1));
+  pPipe->nWriteBufferSize = nSize;
+  *ppBuffer = pPipe->pWriteBuffer;
+
+  return 0;
+}
+
+/** Deliver a buffer obtained via GetWriteBuffer to the pipe. Pipe will write the
+    the contents of the buffer to content and advance content pointer by the size of the buffer */
+static CPresult WriteBuffer( CPhandle hContent, CPbyte *pBuffer, CPuint nFilledSize)
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  if(NULL == pPipe->pHeader || !pPipe->bProducer)
+    return KD_EBADF;
+  if(NULL == pPipe->pWriteBuffer || pBuffer != pPipe->pWriteBuffer || nFilledSize > pPipe->nWriteBufferSize)
+    return KD_EINVAL;
+
+  publishHead(pPipe, pPipe->pHeader->nHead + nFilledSize);
+  pPipe->pWriteBuffer = NULL;
+
+  return 0;
+}
+
+/** Register a per-handle client callback with the content pipe. */
+static CPresult RegisterCallback( CPhandle hContent, CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam))
+{
+  shm_ContentPipe* pPipe = (shm_ContentPipe*) hContent;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "content_pipe_shm:%s \n", __func__);
+
+  SHM_STORE(pPipe->ClientCallback, ClientCallback);
+
+  return 0;
+}
+
+CPresult shm_pipe_Constructor(CP_PIPETYPE **ppPipe, CPstring szURI)
+{
+  shm_ContentPipe* pPipe;
+
+  pPipe = (shm_ContentPipe*) calloc(1, sizeof(shm_ContentPipe));
+
+  if(NULL == pPipe)
+    return KD_ENOMEM;
+
+  pPipe->pipe.Open = Open;
+  pPipe->pipe.Close = Close;
+  pPipe->pipe.Create = Create;
+  pPipe->pipe.CheckAvailableBytes = CheckAvailableBytes;
+  pPipe->pipe.SetPosition = SetPosition;
+  pPipe->pipe.GetPosition = GetPosition;
+  pPipe->pipe.Read = Read;
+  pPipe->pipe.ReadBuffer = ReadBuffer;
+  pPipe->pipe.ReleaseReadBuffer = ReleaseReadBuffer;
+  pPipe->pipe.Write = Write;
+  pPipe->pipe.GetWriteBuffer = GetWriteBuffer;
+  pPipe->pipe.WriteBuffer = WriteBuffer;
+  pPipe->pipe.RegisterCallback = RegisterCallback;
+
+  pPipe->fd = -1;
+
+  *ppPipe = (CP_PIPETYPE*) pPipe;
+
+  return 0;
+}
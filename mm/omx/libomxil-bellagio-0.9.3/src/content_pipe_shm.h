@@ -0,0 +1,123 @@
+/**
+  src/content_pipe_shm.h
+
+  This file implements the support for content pipes related to shared memory.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __CONTENT_PIPE_SHM_H__
+#define __CONTENT_PIPE_SHM_H__
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
+
+#include "omx_comp_debug_levels.h"
+
+/** Size of the ring, a power of two of at least a page */
+#define SHM_PIPE_RING_SIZE (1024 * 1024)
+
+/** The environment variable that sets the size of the ring in KiB, as "ring=256" */
+#define SHM_PIPE_ENV "OMX_BELLAGIO_PIPE_SHM"
+
+#define SHM_PIPE_MAGIC 0x4f4d5853
+
+/** Buffers returned by ReadBuffer that can be out at once */
+#define SHM_PIPE_MAX_BUFFERS 16
+
+/** The shared memory starts with this header, in a page of its own. The ring
+ * follows, and is mapped twice in a row so that any block of it, even across
+ * its end, is contiguous in memory. The producer writes nHead and the consumer
+ * nTail, and they wait for each other with futexes on the sequence numbers.
+ */
+typedef struct shm_pipe_header {
+  uint32_t nMagic;
+  uint32_t nRingSize;
+  uint64_t nHead;           /**< end of the data written */
+  uint64_t nTail;           /**< end of the data released */
+  uint32_t nHeadSequence;   /**< changed when nHead moves while the consumer waits */
+  uint32_t nTailSequence;   /**< changed when nTail moves while the producer waits */
+  uint32_t nHeadWaiters;
+  uint32_t nTailWaiters;
+  uint32_t bClosed;         /**< the producer closed the pipe */
+  uint32_t bConsumerClosed;
+} shm_pipe_header;
+
+/** A buffer returned by ReadBuffer. The ring is freed up to nEnd once it and
+ * the buffers before it are released.
+ */
+typedef struct shm_pipe_buffer {
+  CPbyte* pBuffer;
+  uint64_t nEnd;
+  int bReleased;
+} shm_pipe_buffer;
+
+typedef struct shm_ContentPipe {
+
+  /* public */
+  CP_PIPETYPE pipe;
+
+  /* private */
+  int fd;
+  int bProducer;
+  void* pMap;
+  size_t nMapSize;
+  shm_pipe_header* pHeader;
+  CPbyte* pRing;
+  size_t nRingSize;
+
+  uint64_t nRead;           /**< end of the data given to the consumer */
+  shm_pipe_buffer buffers[SHM_PIPE_MAX_BUFFERS];
+  int nFirstBuffer;
+  int nBuffers;
+
+  CPbyte* pWriteBuffer;     /**< the buffer given by GetWriteBuffer */
+  size_t nWriteBufferSize;
+
+  /* the CP_BytesAvailable events of the consumer are sent by a thread
+   * waiting for the producer, started with the first wait
+   */
+  CPresult (*ClientCallback)(CP_EVENTTYPE eEvent, CPuint iParam);
+  CPuint nBytesWaited;      /**< bytes to notify with CP_BytesAvailable, 0 if none */
+  uint64_t nWaitedEnd;      /**< position the bytes waited end at */
+  pthread_t notifyThread;
+  int bNotifyThread;
+  int bStopNotify;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+
+} shm_ContentPipe;
+
+#endif
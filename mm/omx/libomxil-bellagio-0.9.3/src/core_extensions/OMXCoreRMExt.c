@@ -30,117 +30,218 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include "common.h"
 #include "OMXCoreRMExt.h"
 #include "st_static_component_loader.h"
+#include "registry_cache.h"
+#include "name_index.h"
 
 static int data_loaded = 0;
 static stLoaderComponentType** qualityList;
 static int qualityListItems = 0;
+/** The general and specific names of qualityList, to the index of the component */
+static name_index_t qualityIndex;
+/** The binary registry, queried in place when it is up to date */
+static registryCache* qualityCache = NULL;
+/** The text registry, and its size and modification time when it was loaded */
+static char* qualityRegistryName = NULL;
+static struct stat qualityRegistryStat;
+/** Set by invalidateQualityLevels, the next query checks if the registry changed */
+static int qualityStale = 0;
+/** Protects the data above, loaded again by a query after a change of the registry */
+static pthread_mutex_t qualityMutex = PTHREAD_MUTEX_INITIALIZER;
 
-OMX_ERRORTYPE getSupportedQualityLevels(OMX_STRING cComponentName, OMX_U32** ppQualityLevel, OMX_U32* pNrOfQualityLevels) {
-	OMX_ERRORTYPE err;
-	int found = 0;
-	int j,i,k;
-	if (pNrOfQualityLevels == NULL) {
-		return OMX_ErrorUndefined;
+/** Releases the components read from the text registry, and their index */
+static void freeQualityList() {
+	int i, j;
+
+	for (i = 0; i < qualityListItems; i++) {
+		if (qualityList[i] == NULL) {
+			continue;
+		}
+		for (j = 0; j < qualityList[i]->name_specific_length; j++) {
+			free(qualityList[i]->name_specific[j]);
+		}
+		free(qualityList[i]->name_specific);
+		for (j = 0; j < qualityList[i]->nqualitylevels; j++) {
+			free(qualityList[i]->multiResourceLevel[j]);
+		}
+		free(qualityList[i]->multiResourceLevel);
+		free(qualityList[i]->name);
+		free(qualityList[i]);
+	}
+	free(qualityList);
+	qualityList = NULL;
+	if (qualityListItems > 0) {
+		name_index_deinit(&qualityIndex);
+	}
+	qualityListItems = 0;
+}
+
+/** Indexes the general and specific names of the components read from the
+ * text registry. A name shared by two components finds the first one, as
+ * a linear search of the list would.
+ */
+static OMX_ERRORTYPE indexQualityList() {
+	int nNames = 0;
+	int i, j;
+
+	for (i = 0; i < qualityListItems; i++) {
+		nNames += 1 + qualityList[i]->name_specific_length;
+	}
+	if (name_index_init(&qualityIndex, nNames) != 0) {
+		return OMX_ErrorInsufficientResources;
+	}
+	for (i = 0; i < qualityListItems; i++) {
+		name_index_add(&qualityIndex, qualityList[i]->name, i, NAME_INDEX_GENERAL);
+		for (j = 0; j < qualityList[i]->name_specific_length; j++) {
+			name_index_add(&qualityIndex, qualityList[i]->name_specific[j], i, j);
+		}
 	}
+	return OMX_ErrorNone;
+}
 
-	if (!data_loaded) {
+/** Loads the quality levels, from the binary registry if possible. After
+ * invalidateQualityLevels, they are loaded again if the size or the
+ * modification time of the text registry changed since, so that a new
+ * omxregister is seen without restarting. Otherwise nothing is checked.
+ * Must be called with qualityMutex.
+ */
+static OMX_ERRORTYPE loadQualityLevels() {
+	struct stat registry_stat;
+	OMX_ERRORTYPE err;
+
+	if (data_loaded && !qualityStale) {
+		return OMX_ErrorNone;
+	}
+	qualityStale = 0;
+	if (qualityRegistryName == NULL) {
+		qualityRegistryName = componentsRegistryGetFilename();
+	}
+	if (stat(qualityRegistryName, &registry_stat) != 0) {
+		memset(&registry_stat, 0, sizeof(registry_stat));
+	}
+	if (data_loaded) {
+		if ((registry_stat.st_size == qualityRegistryStat.st_size) &&
+		    (registry_stat.st_mtim.tv_sec == qualityRegistryStat.st_mtim.tv_sec) &&
+		    (registry_stat.st_mtim.tv_nsec == qualityRegistryStat.st_mtim.tv_nsec)) {
+			return OMX_ErrorNone;
+		}
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the registry changed, loading it again\n", __func__);
+		registryCacheClose(qualityCache);
+		qualityCache = NULL;
+		freeQualityList();
+		data_loaded = 0;
+	}
+	qualityCache = registryCacheOpen();
+	if (qualityCache == NULL) {
 		err = readRegistryFile();
 		if (err != OMX_ErrorNone) {
 			return err;
 		}
-		data_loaded = 1;
 	}
-	for (i = 0; i<qualityListItems; i++) {
-		if(!strcmp(qualityList[i]->name, cComponentName)) {
-			DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s found requested component %s with quality levels %i\n", __func__, cComponentName, (int)qualityList[i]->nqualitylevels);
-			*pNrOfQualityLevels = qualityList[i]->nqualitylevels;
-			if (ppQualityLevel == NULL) {
-				return OMX_ErrorNone;
-			}
-			for (k=0; k<qualityList[i]->nqualitylevels; k++) {
-				(*ppQualityLevel)[k] = k+1;
-			}
-			found = 1;
-		} else {
-			for(j=0;j<qualityList[i]->name_specific_length;j++) {
-	        if(!strcmp(qualityList[i]->name_specific[j], cComponentName)) {
-		        	DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested component %s IN SPECIFIC COMPONENT \n", cComponentName);
-						*pNrOfQualityLevels = qualityList[i]->nqualitylevels;
-						if (ppQualityLevel == NULL) {
-							return OMX_ErrorNone;
-						}
-						for (k=0; k<qualityList[i]->nqualitylevels; k++) {
-							(*ppQualityLevel)[k] = k+1;
-						}
-						found = 1;
-		     }
-			}
-		}
-		if(found) {
-			break;
-		}
+	qualityRegistryStat = registry_stat;
+	data_loaded = 1;
+	return OMX_ErrorNone;
+}
+
+/** Searches a component by its general or specific name
+ *
+ * @return the number of quality levels of the component, -1 if not found.
+ * Must be called with qualityMutex, after loadQualityLevels.
+ */
+static int findQualityLevels(OMX_STRING cComponentName, int* pIndex) {
+	const name_index_entry_t* entry;
+
+	if (qualityCache != NULL) {
+		*pIndex = registryCacheFind(qualityCache, cComponentName, NULL);
+		return (*pIndex < 0) ? -1 : (int)qualityCache->pComponents[*pIndex].nQualityLevels;
+	}
+	if (qualityListItems == 0 || (entry = name_index_find(&qualityIndex, cComponentName, NULL)) == NULL) {
+		return -1;
+	}
+	*pIndex = entry->component;
+	DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s found requested component %s with quality levels %i\n", __func__, cComponentName, (int)qualityList[*pIndex]->nqualitylevels);
+	return qualityList[*pIndex]->nqualitylevels;
+}
+
+OMX_ERRORTYPE getSupportedQualityLevels(OMX_STRING cComponentName, OMX_U32** ppQualityLevel, OMX_U32* pNrOfQualityLevels) {
+	OMX_ERRORTYPE err;
+	int levels, i, k;
+
+	if (pNrOfQualityLevels == NULL) {
+		return OMX_ErrorUndefined;
+	}
+	pthread_mutex_lock(&qualityMutex);
+	err = loadQualityLevels();
+	if (err != OMX_ErrorNone) {
+		pthread_mutex_unlock(&qualityMutex);
+		return err;
 	}
-	if(!found) {
+	levels = findQualityLevels(cComponentName, &i);
+	pthread_mutex_unlock(&qualityMutex);
+	if (levels < 0) {
 		DEBUG(DEB_LEV_ERR, "Not found any component\n");
 		*pNrOfQualityLevels = 0;
+		return OMX_ErrorNone;
+	}
+	*pNrOfQualityLevels = levels;
+	if (ppQualityLevel != NULL) {
+		for (k=0; k<levels; k++) {
+			(*ppQualityLevel)[k] = k+1;
+		}
 	}
 	return OMX_ErrorNone;
 }
 
 OMX_ERRORTYPE getMultiResourceEstimates(OMX_STRING cComponentName, OMX_U32 nQualityLevel, multiResourceDescriptor* pMultiResourceEstimates) {
 	OMX_ERRORTYPE err;
-	int found = 0;
-	int j,i = 0;
+	int levels, i, j;
 
 	if (pMultiResourceEstimates == NULL) {
 		return OMX_ErrorUndefined;
 	}
-	if (!data_loaded) {
-		err = readRegistryFile();
-		if (err != OMX_ErrorNone) {
-			return err;
-		}
-		data_loaded = 1;
-	}
-	for (i = 0; i<qualityListItems; i++) {
-		if(!strcmp(qualityList[i]->name, cComponentName)) {
-			DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s found requested component %s with quality level %i\n", __func__, cComponentName, (int)nQualityLevel);
-			if ((nQualityLevel>0) && (nQualityLevel<=qualityList[i]->nqualitylevels)) {
-				found = 1;
-				pMultiResourceEstimates->CPUResourceRequested = qualityList[i]->multiResourceLevel[nQualityLevel-1]->CPUResourceRequested;
-				pMultiResourceEstimates->MemoryResourceRequested = qualityList[i]->multiResourceLevel[nQualityLevel-1]->MemoryResourceRequested;
-				break;
-			}
-		} else {
-			for(j=0;j<qualityList[i]->name_specific_length;j++) {
-		        if(!strcmp(qualityList[i]-> name_specific[j], cComponentName)) {
-		        	DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested component %s IN SPECIFIC COMPONENT \n", cComponentName);
-					if ((nQualityLevel>0) && (nQualityLevel<=qualityList[i]->nqualitylevels)) {
-						found = 1;
-						pMultiResourceEstimates->CPUResourceRequested = qualityList[i]->multiResourceLevel[nQualityLevel-1]->CPUResourceRequested;
-						pMultiResourceEstimates->MemoryResourceRequested = qualityList[i]->multiResourceLevel[nQualityLevel-1]->MemoryResourceRequested;
-						break;
-					}
-					if (found) {
-						break;
-					}
-		        }
-			}
-		}
-		if(found) {
-			break;
-		}
+	pthread_mutex_lock(&qualityMutex);
+	err = loadQualityLevels();
+	if (err != OMX_ErrorNone) {
+		pthread_mutex_unlock(&qualityMutex);
+		return err;
 	}
-	if(!found) {
+	levels = findQualityLevels(cComponentName, &i);
+	if ((levels < 0) || (nQualityLevel == 0) || (nQualityLevel > levels)) {
 		pMultiResourceEstimates->CPUResourceRequested = -1;
 		pMultiResourceEstimates->MemoryResourceRequested = -1;
+	} else if (qualityCache != NULL) {
+		j = qualityCache->pComponents[i].nFirstQualityLevel + nQualityLevel - 1;
+		pMultiResourceEstimates->CPUResourceRequested = qualityCache->pQualityLevels[j].nCPU;
+		pMultiResourceEstimates->MemoryResourceRequested = qualityCache->pQualityLevels[j].nMemory;
+	} else {
+		pMultiResourceEstimates->CPUResourceRequested = qualityList[i]->multiResourceLevel[nQualityLevel-1]->CPUResourceRequested;
+		pMultiResourceEstimates->MemoryResourceRequested = qualityList[i]->multiResourceLevel[nQualityLevel-1]->MemoryResourceRequested;
 	}
+	pthread_mutex_unlock(&qualityMutex);
 	return OMX_ErrorNone;
 }
 
+void invalidateQualityLevels() {
+	pthread_mutex_lock(&qualityMutex);
+	qualityStale = 1;
+	pthread_mutex_unlock(&qualityMutex);
+}
+
+void releaseQualityLevels() {
+	pthread_mutex_lock(&qualityMutex);
+	registryCacheClose(qualityCache);
+	qualityCache = NULL;
+	freeQualityList();
+	free(qualityRegistryName);
+	qualityRegistryName = NULL;
+	data_loaded = 0;
+	pthread_mutex_unlock(&qualityMutex);
+}
+
 /** This function reads the .omxregister file and retrieve all the information about resources and quality levels.
  */
 OMX_ERRORTYPE readRegistryFile() {
@@ -159,16 +260,18 @@ OMX_ERRORTYPE readRegistryFile() {
 	int i;
 
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-	qualityList = NULL;
+	freeQualityList();
 
 	registry_filename = componentsRegistryGetFilename();
 	omxregistryfp = fopen(registry_filename, "r");
 	if (omxregistryfp == NULL){
 		DEBUG(DEB_LEV_ERR, "Cannot open OpenMAX registry file %s\n", registry_filename);
+		free(registry_filename);
 		return OMX_ErrorUndefined;
 	}
 	free(registry_filename);
 	libname = malloc(OMX_MAX_STRINGNAME_SIZE * 2);
+	line = malloc(MAX_LINE_LENGTH);
 	fseek(omxregistryfp, 0, 0);
 
 	  while(1) {
@@ -191,9 +294,8 @@ OMX_ERRORTYPE readRegistryFile() {
 		}
 	}
 	fseek(omxregistryfp, 0, 0);
-	qualityList = malloc(numberOfLines * sizeof (stLoaderComponentType*));
+	qualityList = calloc(numberOfLines, sizeof (stLoaderComponentType*));
 	qualityListItems = numberOfLines;
-	line = malloc(MAX_LINE_LENGTH);
 	listindex = 0;
 
 	  while(1) {
@@ -299,6 +401,10 @@ OMX_ERRORTYPE readRegistryFile() {
     free(libname);
     libname = NULL;
     fclose(omxregistryfp);
+    if (qualityListItems > 0 && indexQualityList() != OMX_ErrorNone) {
+    	qualityListItems = 0;
+    	return OMX_ErrorInsufficientResources;
+    }
     DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
     return OMX_ErrorNone;
 }
@@ -65,5 +65,20 @@ OMX_ERRORTYPE getSupportedQualityLevels(OMX_STRING cComponentName, OMX_U32** ppQ
  */
 OMX_ERRORTYPE getMultiResourceEstimates(OMX_STRING cComponentName, OMX_U32 nQualityLevel, multiResourceDescriptor* pMultiResourceEstimates);
 OMX_ERRORTYPE readRegistryFile();
+/**
+ * @brief Asks the next query to check if the registry changed.
+ *
+ * The core calls it at each OMX_GetHandle, so that the queries themselves
+ * never look at the registry file.
+ */
+void invalidateQualityLevels();
+/**
+ * @brief Releases the quality levels loaded by the queries above.
+ *
+ * The quality levels are loaded at the first query, and loaded again when
+ * the registry changed before an invalidation, so that both queries are
+ * constant time lookups.
+ */
+void releaseQualityLevels();
 #endif
 
@@ -39,6 +39,8 @@
 
 #include "common.h"
 #include "ste_dynamic_component_loader.h"
+#include "name_index.h"
+#include "library_scan.h"
 #include "omx_reference_resource_manager.h"
 #include "base/omx_base_component.h"
 
@@ -53,6 +55,12 @@ void *handleLibList[100];
  */
 OMX_U32 numLib=0;
 static struct BOSA_COMPONENTLOADER *ste_static_loader;
+/** The general and specific names of the components found
+ */
+static name_index_t componentNames;
+/** The roles of the components, an entry for each specific name
+ */
+static name_index_t componentRoles;
 
 /** @brief The initialization of the ST specific component loader.
  *
@@ -69,6 +77,36 @@ void setup_component_loader(BOSA_COMPONENTLOADER * loader) {
 	  ste_static_loader->BOSA_GetComponentsOfRole = &BOSA_STE_GetComponentsOfRole;
 }
 
+/** Builds the indexes of the names and of the roles of the components,
+ * in the order of the list, so that the first match is found as with a
+ * linear search of the list.
+ */
+static int ste_dynamic_build_index(steLoaderComponentType** templateList) {
+  unsigned int nNames = 0, nRoles = 0;
+  unsigned int j;
+  int i;
+
+  for (i = 0; templateList[i]; i++) {
+    nNames += 1 + templateList[i]->name_specific_length;
+    nRoles += templateList[i]->name_specific_length;
+  }
+  if (name_index_init(&componentNames, nNames) != 0) {
+    return -1;
+  }
+  if (name_index_init(&componentRoles, nRoles) != 0) {
+    name_index_deinit(&componentNames);
+    return -1;
+  }
+  for (i = 0; templateList[i]; i++) {
+    name_index_add(&componentNames, templateList[i]->name, i, NAME_INDEX_GENERAL);
+    for (j = 0; j < templateList[i]->name_specific_length; j++) {
+      name_index_add(&componentNames, templateList[i]->name_specific[j], i, j);
+      name_index_add(&componentRoles, templateList[i]->role_specific[j], i, j);
+    }
+  }
+  return 0;
+}
+
 /** @brief the ST static loader constructor
  *
  * This function creates the ST static component loader, and creates
@@ -77,74 +115,60 @@ void setup_component_loader(BOSA_COMPONENTLOADER * loader) {
  * and must be called before the use of this loader
  */
 OMX_ERRORTYPE BOSA_STE_InitComponentLoader(BOSA_COMPONENTLOADER *loader) {
-  DIR *dirp;
-  struct dirent *dp;
   int num_of_comp=0;
   steLoaderComponentType** templateList;
-  steLoaderComponentType** stComponentsTemp;
-  void* handle;
-  int (*fptr)(steLoaderComponentType **stComponents);
-  int i;
+  libraryScanType* libraries = NULL;
+  int num_of_libraries = 0;
+  int i, l;
   int listindex;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-  
-  /* Populate the registry file */
-  dirp = opendir(OMX_COMPONENT_PATH);
-  if(dirp == NULL){
+
+  /* the libraries are loaded in parallel, and listed in the order of their names */
+  if (libraryScanDirectory(OMX_COMPONENT_PATH, &libraries, &num_of_libraries)) {
 	DEBUG(DEB_LEV_ERR, "Failed to open directory %s\n", OMX_COMPONENT_PATH);
 	return OMX_ErrorUndefined;
   }
+  libraryScanProbe(libraries, num_of_libraries, sizeof(steLoaderComponentType), 0);
 
   templateList = malloc(sizeof (steLoaderComponentType*));
   templateList[0] = NULL;
 
-  listindex = 0;   
-  while((dp = readdir(dirp)) != NULL) {
-	int len = strlen(dp->d_name);
-		
-	if(len <= 3)
-		continue;    
-	  
-	if(strncmp(dp->d_name+len-3, ".so", 3) == 0) {
-	  char lib_absolute_path[strlen(OMX_COMPONENT_PATH) + len + 1];
-		
-	  strcpy(lib_absolute_path, OMX_COMPONENT_PATH);
-	  strcat(lib_absolute_path, dp->d_name);	  
-	  
-	  if((handle = dlopen(lib_absolute_path, RTLD_NOW)) == NULL) {
-	    DEBUG(DEB_LEV_ERR, "could not load %s: %s\n", lib_absolute_path, dlerror());
-	  } else {
-	    handleLibList[numLib]=handle;
-	    numLib++;
-	    if ((fptr = dlsym(handle, "omx_component_library_Setup")) == NULL) {
-	      DEBUG(DEB_LEV_ERR, "the library %s is not compatible with ST static component loader - %s\n", lib_absolute_path, dlerror());
-	    } else {
-	      num_of_comp = (int)(*fptr)(NULL);
-	      templateList = realloc(templateList, (listindex + num_of_comp + 1) * sizeof (steLoaderComponentType*));
-	      templateList[listindex + num_of_comp] = NULL;
-	      stComponentsTemp = calloc(num_of_comp,sizeof(steLoaderComponentType*));
-	      for (i = 0; i<num_of_comp; i++) {
-			stComponentsTemp[i] = calloc(1,sizeof(steLoaderComponentType));
-	      }
-	      (*fptr)(stComponentsTemp);
-	      for (i = 0; i<num_of_comp; i++) {
-			templateList[listindex + i] = stComponentsTemp[i];
-			DEBUG(DEB_LEV_FULL_SEQ, "In %s comp name[%d]=%s\n",__func__,listindex + i,templateList[listindex + i]->name);
-	      }
-	      
-	      free(stComponentsTemp);
-	      stComponentsTemp = NULL;
-	      listindex+= i;
-	    }
+  listindex = 0;
+  for (l = 0; l < num_of_libraries; l++) {
+	if (libraries[l].handle == NULL) {
+	  continue;
+	}
+	if (numLib >= sizeof(handleLibList) / sizeof(handleLibList[0])) {
+	  DEBUG(DEB_LEV_ERR, "Too many libraries, %s is not used\n", libraries[l].path);
+	  for (i = 0; i < libraries[l].nComponents; i++) {
+		free(libraries[l].components[i]);
 	  }
-	}    
+	  dlclose(libraries[l].handle);
+	  continue;
+	}
+	handleLibList[numLib]=libraries[l].handle;
+	numLib++;
+	num_of_comp = libraries[l].nComponents;
+	templateList = realloc(templateList, (listindex + num_of_comp + 1) * sizeof (steLoaderComponentType*));
+	templateList[listindex + num_of_comp] = NULL;
+	for (i = 0; i<num_of_comp; i++) {
+	  templateList[listindex + i] = libraries[l].components[i];
+	  DEBUG(DEB_LEV_FULL_SEQ, "In %s comp name[%d]=%s\n",__func__,listindex + i,templateList[listindex + i]->name);
+	}
+	listindex+= num_of_comp;
   }
-  
+  libraryScanFree(libraries, num_of_libraries);
+
   loader->loaderPrivate = templateList;
 
   RM_Init();
-  closedir(dirp);
+
+  if (ste_dynamic_build_index(templateList) != 0) {
+    DEBUG(DEB_LEV_ERR, "In %s cannot allocate the index of the components\n", __func__);
+    BOSA_STE_DeInitComponentLoader(loader);
+    return OMX_ErrorInsufficientResources;
+  }
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
   return OMX_ErrorNone;
 }
@@ -208,6 +232,8 @@ OMX_ERRORTYPE BOSA_STE_DeInitComponentLoader(BOSA_COMPONENTLOADER *loader) {
     }
   }
   numLib=0;
+  name_index_deinit(&componentNames);
+  name_index_deinit(&componentRoles);
 
   RM_Deinit();
 
@@ -229,8 +255,7 @@ OMX_ERRORTYPE BOSA_STE_CreateComponent(
   OMX_PTR pAppData,
   OMX_CALLBACKTYPE* pCallBacks) {
 
-  int i;
-  unsigned int j;
+  const name_index_entry_t* entry;
   int componentPosition = -1;
   OMX_ERRORTYPE eError = OMX_ErrorNone;
   steLoaderComponentType** templateList;
@@ -239,28 +264,12 @@ OMX_ERRORTYPE BOSA_STE_CreateComponent(
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   templateList = (steLoaderComponentType**)loader->loaderPrivate;
-  i = 0;
-  while(templateList[i]) {
-    if(!strcmp(templateList[i]->name, cComponentName)) {
-      //given component name matches with the general component names
-      componentPosition = i;
-      break;
-    } else {
-      for(j=0;j<templateList[i]->name_specific_length;j++) {
-        if(!strcmp(templateList[i]->name_specific[j], cComponentName)) {
-          //given component name matches with specific component names
-          componentPosition = i;
-          break;
-        }
-      }
-      if(componentPosition != -1) {
-        break;
-      }
-    }
-    i++;
+  entry = name_index_find(&componentNames, cComponentName, NULL);
+  if (entry != NULL) {
+    componentPosition = entry->component;
   }
   if (componentPosition == -1) {
-    DEBUG(DEB_LEV_ERR, "Component not found with current ST static component loader.\n");
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Component not found with current ST static component loader.\n");
     return OMX_ErrorComponentNotFound;
   }
 
@@ -382,53 +391,41 @@ OMX_ERRORTYPE BOSA_STE_GetRolesOfComponent(
   OMX_U8 **roles) {
 
   steLoaderComponentType** templateList;
-  int i;
-  unsigned int j, index;
+  steLoaderComponentType* template;
+  const name_index_entry_t* entry;
+  unsigned int index;
   unsigned int max_roles = *pNumRoles;
-  int found = 0;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   templateList = (steLoaderComponentType**)loader->loaderPrivate;
   *pNumRoles = 0;
-  i = 0;
-  while (templateList[i]) {
-    if(!strcmp(templateList[i]->name, compName)) {
-      DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested template %s IN GENERAL COMPONENT\n", compName);
-      // set the no of roles field
-      *pNumRoles = templateList[i]->name_specific_length;
-      if(roles == NULL) {
-        return OMX_ErrorNone;
-      }
-      //append the roles
-      for (index = 0; index < templateList[i]->name_specific_length; index++) {
-        if (index < max_roles) {
-          strcpy ((char*)*(roles+index), templateList[i]->role_specific[index]);
-        }
-      }
-      found = 1;
-    } else {
-      for(j=0;j<templateList[i]->name_specific_length;j++) {
-        if(!strcmp(templateList[i]-> name_specific[j], compName)) {
-          DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested component %s IN SPECIFIC COMPONENT \n", compName);
-          *pNumRoles = 1;
-          found = 1;
-          if(roles == NULL) {
-            return OMX_ErrorNone;
-          }
-          if (max_roles > 0) {
-            strcpy ((char*)*roles , templateList[i]->role_specific[j]);
-          }
-        }
+  entry = name_index_find(&componentNames, compName, NULL);
+  if (entry == NULL) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "no component match in whole template list has been found\n");
+    return OMX_ErrorComponentNotFound;
+  }
+  template = templateList[entry->component];
+  if (entry->specific == NAME_INDEX_GENERAL) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested template %s IN GENERAL COMPONENT\n", compName);
+    // set the no of roles field
+    *pNumRoles = template->name_specific_length;
+    if(roles == NULL) {
+      return OMX_ErrorNone;
+    }
+    //append the roles
+    for (index = 0; index < template->name_specific_length; index++) {
+      if (index < max_roles) {
+        strcpy ((char*)*(roles+index), template->role_specific[index]);
       }
     }
-    i++;
-    if(found) {
-      break;
+  } else {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested component %s IN SPECIFIC COMPONENT \n", compName);
+    *pNumRoles = 1;
+    if(roles == NULL) {
+      return OMX_ErrorNone;
+    }
+    if (max_roles > 0) {
+      strcpy ((char*)*roles , template->role_specific[entry->specific]);
     }
-  }
-  if(!found) {
-    DEBUG(DEB_LEV_ERR, "no component match in whole template list has been found\n");
-    *pNumRoles = 0;
-    return OMX_ErrorComponentNotFound;
   }
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
   return OMX_ErrorNone;
@@ -447,26 +444,20 @@ OMX_ERRORTYPE BOSA_STE_GetComponentsOfRole (
   OMX_U8  **compNames) {
 
   steLoaderComponentType** templateList;
-  int i = 0;
-  unsigned int j = 0;
+  const name_index_entry_t* entry = NULL;
   int num_comp = 0;
   int max_entries = *pNumComps;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   templateList = (steLoaderComponentType**)loader->loaderPrivate;
-  i = 0;
-  while(templateList[i]) {
-    for (j = 0; j<templateList[i]->name_specific_length; j++) {
-      if (!strcmp(templateList[i]->role_specific[j], role)) {
-        if (compNames != NULL) {
-          if (num_comp < max_entries) {
-            strcpy((char*)(compNames[num_comp]), templateList[i]->name);
-          }
-        }
-      num_comp++;
+  /* the entries of a role are found in the order of the list */
+  while ((entry = name_index_find(&componentRoles, role, entry)) != NULL) {
+    if (compNames != NULL) {
+      if (num_comp < max_entries) {
+        strcpy((char*)(compNames[num_comp]), templateList[entry->component]->name);
       }
     }
-    i++;
+    num_comp++;
   }
 
   *pNumComps = num_comp;
@@ -28,6 +28,8 @@
 #ifndef EXTENSION_STRUCT_H_
 #define EXTENSION_STRUCT_H_
 
+#include <OMX_Audio.h>
+
 /** This structure is threaded like a parameter with the
  * extension index OMX_IndexParameterThreadsID
  */
@@ -38,6 +40,61 @@ typedef struct OMX_PARAM_BELLAGIOTHREADS_ID {
 	long int nThreadMessageID; /**< @param nThreadMessageID the linux thread ID of the message handler thread*/\
 } OMX_PARAM_BELLAGIOTHREADS_ID;
 
+/** This structure is threaded like a parameter with the
+ * extension index OMX_IndexParameterCoalescing. It applies to the
+ * output port of a filter component: consecutive input buffers are
+ * packed in the same output buffer until one of the limits is reached
+ */
+typedef struct OMX_PARAM_BELLAGIOCOALESCINGTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< Port that this structure applies to */
+    OMX_U32 nMaxBytes;             /**< Output buffers are returned once they hold at least this many bytes, 0 for no limit */
+    OMX_U32 nMaxDuration;          /**< Output buffers are returned once they span at least this many microseconds, 0 for no limit */
+} OMX_PARAM_BELLAGIOCOALESCINGTYPE;
+
+/** Vendor value of eNumData in OMX_AUDIO_PARAM_PCMMODETYPE for float samples
+ * from -1.0 to 1.0, nBitPerSample being 32
+ */
+#define OMX_NumericalDataFloat ((OMX_NUMERICALDATATYPE) 0x7F000001)
+
+/** This structure is threaded like a config with the extension index
+ * OMX_IndexConfigChannelMatrix. It applies to the output port of the channel
+ * mapper: output channel o is the sum of the input channels i weighted by
+ * nCoef[o * nInputChannels + i]
+ */
+typedef struct OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< Port that this structure applies to */
+    OMX_U32 nInputChannels;        /**< Channels of the input port, the columns of the matrix */
+    OMX_U32 nOutputChannels;       /**< Channels of the output port, the rows of the matrix */
+    OMX_BOOL bDerived;             /**< The matrix follows the channel mappings of the ports, nCoef being ignored when set */
+    OMX_S32 nCoef[OMX_AUDIO_MAXCHANNELS * OMX_AUDIO_MAXCHANNELS]; /**< Gains in Q16, 65536 being 1.0 */
+} OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE;
+
+/** This structure is threaded like a parameter with the extension index
+ * OMX_IndexParameterReadOnlyBuffers. It applies to an output port whose
+ * buffers may be sent with read-only memory in place of their payload, which
+ * the port does only once the receiver declared that it does not write them
+ */
+typedef struct OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< Port that this structure applies to */
+    OMX_BOOL bReadOnly;            /**< The receiver of the buffers of the port does not write their payload */
+} OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE;
+
+/** This structure is threaded like a parameter with the extension index
+ * OMX_IndexParameterKernel. It is read only, and names the kernel chosen by
+ * a component among the ones built for different instruction sets
+ */
+typedef struct OMX_PARAM_BELLAGIOKERNELTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U8 cName[OMX_MAX_STRINGNAME_SIZE]; /**< The name of the kernel, as "scalar", "sse", "avx2" or "neon" */
+} OMX_PARAM_BELLAGIOKERNELTYPE;
+
 typedef struct multiResourceDescriptor {
 	int CPUResourceRequested;
 	int MemoryResourceRequested;
@@ -0,0 +1,75 @@
+/**
+  src/kernel_table.c
+
+  Implements the selection of the kernel run by a component among a table
+  of kernels built for different instruction sets.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "kernel_table.h"
+#include "omx_comp_debug_levels.h"
+
+OMX_BOOL kernel_table_supported(const kernel_table_entry_t* pKernel) {
+  if (pKernel->nCpuFeatures == 0) {
+    return OMX_TRUE;
+  }
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  if ((pKernel->nCpuFeatures & KERNEL_CPU_AVX2) && !__builtin_cpu_supports("avx2")) {
+    return OMX_FALSE;
+  }
+  if ((pKernel->nCpuFeatures & KERNEL_CPU_FMA) && !__builtin_cpu_supports("fma")) {
+    return OMX_FALSE;
+  }
+  return OMX_TRUE;
+#else
+  return OMX_FALSE;
+#endif
+}
+
+const void* kernel_table_select(const void* pKernels, OMX_U32 nKernels, size_t nSize,
+  const char* sName, const char* sEnv) {
+  const kernel_table_entry_t* pKernel;
+  OMX_U32 i;
+
+  if (!sName) {
+    sName = getenv(sEnv);
+  }
+  if (sName) {
+    for (i = 0; i < nKernels; i++) {
+      pKernel = (const kernel_table_entry_t*) ((const char*) pKernels + i * nSize);
+      if (!strcmp(pKernel->sName, sName) && kernel_table_supported(pKernel)) {
+        return pKernel;
+      }
+    }
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s kernel %s not available\n", __func__, sName);
+  }
+  for (i = 0; i < nKernels - 1; i++) {
+    pKernel = (const kernel_table_entry_t*) ((const char*) pKernels + i * nSize);
+    if (kernel_table_supported(pKernel)) {
+      return pKernel;
+    }
+  }
+  return (const char*) pKernels + (nKernels - 1) * nSize;
+}
@@ -0,0 +1,74 @@
+/**
+  src/kernel_table.h
+
+  Selection of the kernel run by a component among a table of kernels built
+  for different instruction sets, such as the scalar, SSE, AVX2 and NEON
+  versions of the same functions.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __KERNEL_TABLE_H__
+#define __KERNEL_TABLE_H__
+
+#include <stddef.h>
+#include <OMX_Types.h>
+
+/** The CPU features a kernel needs at run time, beyond the ones the
+ * library is built for
+ */
+#define KERNEL_CPU_AVX2 0x1
+#define KERNEL_CPU_FMA  0x2
+
+/** The first fields of the kernels of a table, followed by their functions */
+#define kernel_table_entry_FIELDS \
+  const char* sName; /**< The name of the kernel, as given in the environment */ \
+  OMX_U32 nCpuFeatures; /**< The KERNEL_CPU_* features the kernel needs */
+
+typedef struct kernel_table_entry_t {
+  kernel_table_entry_FIELDS
+} kernel_table_entry_t;
+
+/** Whether the CPU runs a kernel
+ *
+ * @param pKernel the kernel
+ *
+ * @return OMX_TRUE if the CPU has all the features the kernel needs
+ */
+OMX_BOOL kernel_table_supported(const kernel_table_entry_t* pKernel);
+
+/** Selects a kernel of a table
+ *
+ * @param pKernels the table, the best kernel first. Its elements are
+ * nSize bytes and begin with kernel_table_entry_FIELDS. The last one
+ * must need no CPU feature.
+ * @param nKernels the number of kernels of the table
+ * @param nSize the size of an element of the table
+ * @param sName the name of the kernel wanted, or NULL for the one named by
+ * the environment variable sEnv
+ * @param sEnv the environment variable naming the kernel
+ *
+ * @return the kernel named if the CPU supports it, or else the best one
+ * the CPU supports
+ */
+const void* kernel_table_select(const void* pKernels, OMX_U32 nKernels, size_t nSize,
+  const char* sName, const char* sEnv);
+
+#endif
@@ -0,0 +1,356 @@
+/**
+  src/library_scan.c
+
+  Scan of the directories of the component libraries, shared by
+  omxregister and the dynamic component loader.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <elf.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "common.h"
+#include "library_scan.h"
+#include "omx_comp_debug_levels.h"
+
+/** Largest note segment read to find the build-id */
+#define LIBRARY_SCAN_MAX_NOTES 65536
+
+/** @brief the work shared by the threads of a probe */
+typedef struct libraryScanWork {
+  libraryScanType* list;
+  int count;
+  int next; /**< next library to be probed */
+  size_t componentSize;
+  pthread_mutex_t mutex;
+} libraryScanWork;
+
+static int libraryScanCompare(const void* a, const void* b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/** Frees the names collected by libraryScanDirectory when it fails
+ */
+static void libraryScanFreeNames(char** names, int nNames) {
+  int i;
+
+  for (i = 0; i < nNames; i++) {
+    free(names[i]);
+  }
+  free(names);
+}
+
+int libraryScanDirectory(const char* directory, libraryScanType** list, int* count) {
+  DIR* dirp;
+  struct dirent* dp;
+  struct stat st;
+  char** names = NULL;
+  char** newNames;
+  libraryScanType* newList;
+  int nNames = 0, i;
+  size_t len;
+
+  dirp = opendir(directory);
+  if (dirp == NULL) {
+    return -1;
+  }
+  while ((dp = readdir(dirp)) != NULL) {
+    len = strlen(dp->d_name);
+    if ((len <= 3) || strcmp(dp->d_name + len - 3, ".so")) {
+      continue;
+    }
+    newNames = realloc(names, (nNames + 1) * sizeof(char*));
+    if (newNames == NULL) {
+      closedir(dirp);
+      libraryScanFreeNames(names, nNames);
+      return -1;
+    }
+    names = newNames;
+    names[nNames] = malloc(strlen(directory) + len + 1);
+    if (names[nNames] == NULL) {
+      closedir(dirp);
+      libraryScanFreeNames(names, nNames);
+      return -1;
+    }
+    strcpy(names[nNames], directory);
+    strcat(names[nNames], dp->d_name);
+    nNames++;
+  }
+  closedir(dirp);
+
+  if (nNames > 0) {
+    qsort(names, nNames, sizeof(char*), libraryScanCompare);
+    newList = realloc(*list, (*count + nNames) * sizeof(libraryScanType));
+    if (newList == NULL) {
+      libraryScanFreeNames(names, nNames);
+      return -1;
+    }
+    *list = newList;
+  }
+  for (i = 0; i < nNames; i++) {
+    libraryScanType* library = &(*list)[*count + i];
+    memset(library, 0, sizeof(libraryScanType));
+    library->path = names[i];
+    library->nComponents = -1;
+    if (stat(names[i], &st) == 0) {
+      library->nSize = st.st_size;
+      library->nMtimeSec = st.st_mtim.tv_sec;
+      library->nMtimeNsec = st.st_mtim.tv_nsec;
+    }
+  }
+  *count += nNames;
+  free(names);
+  return 0;
+}
+
+/** Loads a library and asks it the description of its components
+ */
+static void libraryScanProbeOne(libraryScanType* library, size_t componentSize) {
+  int (*fptr)(void **);
+  int i;
+
+  if ((library->handle = dlopen(library->path, RTLD_NOW)) == NULL) {
+    DEBUG(DEB_LEV_ERR, "could not load %s: %s\n", library->path, dlerror());
+    return;
+  }
+  if ((fptr = dlsym(library->handle, "omx_component_library_Setup")) == NULL) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "the library %s is not compatible with ST static component loader\n", library->path);
+    dlclose(library->handle);
+    library->handle = NULL;
+    return;
+  }
+  library->nComponents = fptr(NULL);
+  if (library->nComponents < 0) {
+    library->nComponents = 0;
+  }
+  library->components = calloc(library->nComponents + 1, sizeof(void*));
+  if (library->components == NULL) {
+    library->nComponents = -1;
+    dlclose(library->handle);
+    library->handle = NULL;
+    return;
+  }
+  for (i = 0; i < library->nComponents; i++) {
+    library->components[i] = calloc(1, componentSize);
+    if (library->components[i] == NULL) {
+      break;
+    }
+  }
+  if (i < library->nComponents) {
+    while (i-- > 0) {
+      free(library->components[i]);
+    }
+    free(library->components);
+    library->components = NULL;
+    library->nComponents = -1;
+    dlclose(library->handle);
+    library->handle = NULL;
+    return;
+  }
+  fptr(library->components);
+}
+
+static void* libraryScanThread(void* param) {
+  libraryScanWork* work = param;
+  int i;
+
+  while (1) {
+    pthread_mutex_lock(&work->mutex);
+    i = work->next++;
+    pthread_mutex_unlock(&work->mutex);
+    if (i >= work->count) {
+      break;
+    }
+    if (!work->list[i].bSkip) {
+      libraryScanProbeOne(&work->list[i], work->componentSize);
+    }
+  }
+  return NULL;
+}
+
+void libraryScanProbe(libraryScanType* list, int count, size_t componentSize, int nThreads) {
+  pthread_t threads[LIBRARY_SCAN_MAX_THREADS];
+  libraryScanWork work;
+  int i, fd, started;
+  long cpus;
+
+  /* start reading all the files at once, most of the time of a cold
+   * scan is spent waiting for the pages of the libraries */
+#ifdef POSIX_FADV_WILLNEED
+  for (i = 0; i < count; i++) {
+    if (list[i].bSkip) {
+      continue;
+    }
+    fd = open(list[i].path, O_RDONLY);
+    if (fd >= 0) {
+      posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+      close(fd);
+    }
+  }
+#endif
+
+  if (nThreads <= 0) {
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    nThreads = (cpus > 1) ? (int)cpus : 2;
+  }
+  if (nThreads > LIBRARY_SCAN_MAX_THREADS) {
+    nThreads = LIBRARY_SCAN_MAX_THREADS;
+  }
+  if (nThreads > count) {
+    nThreads = count;
+  }
+
+  work.list = list;
+  work.count = count;
+  work.next = 0;
+  work.componentSize = componentSize;
+  pthread_mutex_init(&work.mutex, NULL);
+  /* the calling thread is one of the nThreads */
+  for (started = 0; started < nThreads - 1; started++) {
+    if (pthread_create(&threads[started], NULL, libraryScanThread, &work) != 0) {
+      break;
+    }
+  }
+  libraryScanThread(&work);
+  for (i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  pthread_mutex_destroy(&work.mutex);
+}
+
+/** Searches the build-id in the notes of a segment
+ */
+static int libraryScanNotes(const unsigned char* notes, size_t size, char* buildId) {
+  size_t offset = 0, nameSize, descSize, i;
+  const Elf32_Nhdr* note;
+
+  while (offset + sizeof(Elf32_Nhdr) <= size) {
+    note = (const Elf32_Nhdr*)(notes + offset);
+    nameSize = (note->n_namesz + 3) & ~3;
+    descSize = (note->n_descsz + 3) & ~3;
+    offset += sizeof(Elf32_Nhdr);
+    if ((nameSize > size - offset) || (descSize > size - offset - nameSize)) {
+      break;
+    }
+    if ((note->n_type == NT_GNU_BUILD_ID) && (note->n_namesz == 4) &&
+        !memcmp(notes + offset, "GNU", 4) && (note->n_descsz > 0)) {
+      for (i = 0; (i < note->n_descsz) && (2 * i + 2 < LIBRARY_SCAN_BUILD_ID_SIZE); i++) {
+        sprintf(buildId + 2 * i, "%02x", notes[offset + nameSize + i]);
+      }
+      return 0;
+    }
+    offset += nameSize + descSize;
+  }
+  return -1;
+}
+
+int libraryScanBuildId(const char* path, char* buildId) {
+  unsigned char ident[EI_NIDENT];
+  unsigned char* notes;
+  Elf64_Ehdr ehdr64;
+  Elf64_Phdr phdr64;
+  Elf32_Ehdr ehdr32;
+  Elf32_Phdr phdr32;
+  uint64_t phoff, offset, size;
+  unsigned int phnum, phentsize, i;
+  uint32_t type;
+  int fd, found = -1;
+
+  strcpy(buildId, "-");
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  if ((pread(fd, ident, EI_NIDENT, 0) != EI_NIDENT) || memcmp(ident, ELFMAG, SELFMAG)) {
+    close(fd);
+    return 0;
+  }
+  if (ident[EI_CLASS] == ELFCLASS64) {
+    if (pread(fd, &ehdr64, sizeof(ehdr64), 0) != sizeof(ehdr64)) {
+      close(fd);
+      return 0;
+    }
+    phoff = ehdr64.e_phoff;
+    phnum = ehdr64.e_phnum;
+    phentsize = ehdr64.e_phentsize;
+  } else {
+    if (pread(fd, &ehdr32, sizeof(ehdr32), 0) != sizeof(ehdr32)) {
+      close(fd);
+      return 0;
+    }
+    phoff = ehdr32.e_phoff;
+    phnum = ehdr32.e_phnum;
+    phentsize = ehdr32.e_phentsize;
+  }
+  for (i = 0; (i < phnum) && (found != 0); i++) {
+    if (ident[EI_CLASS] == ELFCLASS64) {
+      if (pread(fd, &phdr64, sizeof(phdr64), phoff + i * phentsize) != sizeof(phdr64)) {
+        break;
+      }
+      type = phdr64.p_type;
+      offset = phdr64.p_offset;
+      size = phdr64.p_filesz;
+    } else {
+      if (pread(fd, &phdr32, sizeof(phdr32), phoff + i * phentsize) != sizeof(phdr32)) {
+        break;
+      }
+      type = phdr32.p_type;
+      offset = phdr32.p_offset;
+      size = phdr32.p_filesz;
+    }
+    if ((type != PT_NOTE) || (size == 0) || (size > LIBRARY_SCAN_MAX_NOTES)) {
+      continue;
+    }
+    notes = malloc(size);
+    if (notes == NULL) {
+      break;
+    }
+    if (pread(fd, notes, size, offset) == (ssize_t)size) {
+      found = libraryScanNotes(notes, size, buildId);
+    }
+    free(notes);
+  }
+  close(fd);
+  return 0;
+}
+
+void libraryScanFree(libraryScanType* list, int count) {
+  int i;
+
+  for (i = 0; i < count; i++) {
+    free(list[i].path);
+    free(list[i].components);
+  }
+  free(list);
+}
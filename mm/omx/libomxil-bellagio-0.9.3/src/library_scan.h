@@ -0,0 +1,91 @@
+/**
+  src/library_scan.h
+
+  Scan of the directories of the component libraries. The libraries are
+  probed by a bounded pool of threads, and the results are kept in the
+  order of the names of the libraries, whatever the order of completion.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __LIBRARY_SCAN_H__
+#define __LIBRARY_SCAN_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Maximum number of threads probing the libraries */
+#define LIBRARY_SCAN_MAX_THREADS 8
+
+/** Size of the hexadecimal string of a build-id, with the terminator */
+#define LIBRARY_SCAN_BUILD_ID_SIZE 41
+
+/** @brief a library found in a directory of components */
+typedef struct libraryScanType {
+  char* path; /**< absolute path of the library */
+  int64_t nSize; /**< size of the file */
+  int64_t nMtimeSec; /**< modification time of the file, seconds */
+  int64_t nMtimeNsec; /**< modification time of the file, nanoseconds */
+  int bSkip; /**< set by the caller before the probe, the library is not loaded */
+  void* handle; /**< the library loaded, NULL if not loaded or not compatible */
+  int nComponents; /**< number of components of the library, -1 if it is not a library of components */
+  void** components; /**< the components described by omx_component_library_Setup */
+} libraryScanType;
+
+/** @brief adds the libraries of a directory to a list
+ *
+ * The libraries are added in the order of their names, so that the result
+ * does not depend on the order of the entries of the directory.
+ *
+ * @param directory the directory, terminated by '/'
+ * @param list the list, reallocated, NULL for a new list
+ * @param count the number of libraries in the list, updated
+ *
+ * @return -1 if the directory cannot be read or the memory is exhausted, the
+ * list being left as it was
+ */
+int libraryScanDirectory(const char* directory, libraryScanType** list, int* count);
+
+/** @brief loads the libraries of the list and describes their components
+ *
+ * The libraries not skipped are loaded by up to nThreads threads. Each
+ * compatible library is described by omx_component_library_Setup in an
+ * array of nComponents descriptors of componentSize bytes, allocated
+ * zeroed. A library that is not compatible is closed again.
+ *
+ * @param nThreads the number of threads, 0 for the default
+ */
+void libraryScanProbe(libraryScanType* list, int count, size_t componentSize, int nThreads);
+
+/** @brief reads the GNU build-id of a library without loading it
+ *
+ * @param buildId receives the build-id as an hexadecimal string, or "-"
+ * if the library has no build-id
+ *
+ * @return -1 if the file cannot be read
+ */
+int libraryScanBuildId(const char* path, char* buildId);
+
+/** @brief releases the list, the libraries are not closed and the
+ * arrays of components are released, but not their content
+ */
+void libraryScanFree(libraryScanType* list, int count);
+
+#endif
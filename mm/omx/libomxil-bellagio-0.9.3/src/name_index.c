@@ -0,0 +1,118 @@
+/**
+  src/name_index.c
+
+  Implements an open addressing hash table of the names and the roles of
+  the components, filled once by a component loader at its initialization.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "name_index.h"
+
+/** FNV-1a hash of a name */
+unsigned int name_index_hash(const char* name) {
+  unsigned int hash = 2166136261u;
+
+  while (*name != '\0') {
+    hash ^= (unsigned char)*name++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/** Initialize an index descriptor. The table is kept at most half full.
+ */
+int name_index_init(name_index_t* index, unsigned int nmax) {
+  unsigned int size = 8;
+
+  while (size < 2 * nmax) {
+    size <<= 1;
+  }
+  index->buckets = calloc(size, sizeof(name_index_entry_t));
+  if (index->buckets == NULL) {
+    index->mask = 0;
+    index->nelem = 0;
+    return -1;
+  }
+  index->mask = size - 1;
+  index->nelem = 0;
+  return 0;
+}
+
+/** Deinitialize an index descriptor
+ */
+void name_index_deinit(name_index_t* index) {
+  free(index->buckets);
+  index->buckets = NULL;
+  index->mask = 0;
+  index->nelem = 0;
+}
+
+/** Add an entry to the index. With linear probing and no removal, the
+ * entries of the same name are met in the order they have been added.
+ */
+int name_index_add(name_index_t* index, const char* name, int component, int specific) {
+  name_index_entry_t* entry;
+  unsigned int hash, i;
+
+  if ((index->buckets == NULL) || (index->nelem >= index->mask)) {
+    return -1;
+  }
+  hash = name_index_hash(name);
+  i = hash & index->mask;
+  while (index->buckets[i].name != NULL) {
+    i = (i + 1) & index->mask;
+  }
+  entry = &index->buckets[i];
+  entry->hash = hash;
+  entry->name = name;
+  entry->component = component;
+  entry->specific = specific;
+  index->nelem++;
+  return 0;
+}
+
+/** Search the entries of a name, starting from the home bucket of the name,
+ * or from the bucket following the previous entry returned
+ */
+const name_index_entry_t* name_index_find(const name_index_t* index, const char* name, const name_index_entry_t* previous) {
+  const name_index_entry_t* entry;
+  unsigned int hash, i;
+
+  if (index->buckets == NULL) {
+    return NULL;
+  }
+  hash = name_index_hash(name);
+  if (previous == NULL) {
+    i = hash & index->mask;
+  } else {
+    i = ((previous - index->buckets) + 1) & index->mask;
+  }
+  for (entry = &index->buckets[i]; entry->name != NULL; entry = &index->buckets[i]) {
+    if ((entry->hash == hash) && !strcmp(entry->name, name)) {
+      return entry;
+    }
+    i = (i + 1) & index->mask;
+  }
+  return NULL;
+}
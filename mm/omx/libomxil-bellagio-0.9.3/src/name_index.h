@@ -0,0 +1,100 @@
+/**
+  src/name_index.h
+
+  Hash table of the names and the roles of the components, used by the
+  component loaders to avoid a linear search of their lists.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __NAME_INDEX_H__
+#define __NAME_INDEX_H__
+
+/** Marks a general name of a component in an entry of the index
+ */
+#define NAME_INDEX_GENERAL -1
+
+/** An entry of the index. The name is not copied, and must live as long
+ * as the index.
+ */
+typedef struct name_index_entry_t {
+  unsigned int hash; /**< Hash of the name */
+  const char* name; /**< The name, NULL if the bucket is empty */
+  int component; /**< Index of the component in the list of the loader */
+  int specific; /**< Index of the specific name or role, or NAME_INDEX_GENERAL */
+} name_index_entry_t;
+
+/** An open addressing hash table. The same name can be added more than once,
+ * the entries of a name are found in the order they have been added.
+ */
+typedef struct name_index_t {
+  name_index_entry_t* buckets; /**< The table, its size is a power of 2 */
+  unsigned int mask; /**< The size of the table minus one */
+  unsigned int nelem; /**< Number of entries in the table */
+} name_index_t;
+
+/** FNV-1a hash of a name, also the hash of the names in the binary registry
+ *
+ * @param name the name
+ *
+ * @return the hash of the name
+ */
+unsigned int name_index_hash(const char* name);
+
+/** Initialize an index descriptor
+ *
+ * @param index The index descriptor to initialize.
+ * The user needs to allocate the index
+ *
+ * @param nmax The maximum number of entries that will be added
+ *
+ * @return -1 if the resources are not enough and the allocation cannot be performed
+ */
+int name_index_init(name_index_t* index, unsigned int nmax);
+
+/** Deinitialize an index descriptor, the names are not released
+ *
+ * @param index the index descriptor to release
+ */
+void name_index_deinit(name_index_t* index);
+
+/** Add an entry to the index
+ *
+ * @param index the index descriptor
+ * @param name the name to be added
+ * @param component the index of the component in the list of the loader
+ * @param specific the index of the specific name or role, or NAME_INDEX_GENERAL
+ *
+ * @return -1 if the index is full
+ */
+int name_index_add(name_index_t* index, const char* name, int component, int specific);
+
+/** Search the entries of a name
+ *
+ * @param index the index descriptor
+ * @param name the name searched
+ * @param previous NULL to get the first entry of the name, or the entry
+ * previously returned to get the next one
+ *
+ * @return the entry found, or NULL if there are no more entries of the name
+ */
+const name_index_entry_t* name_index_find(const name_index_t* index, const char* name, const name_index_entry_t* previous);
+
+#endif
@@ -26,412 +26,837 @@
 */
 
 #include <string.h>
+#include <pthread.h>
 #include "omx_reference_resource_manager.h"
 #include "base/omx_base_component.h"
-#include "queue.h"
+#include "name_index.h"
+
+typedef struct RM_ResourceType RM_ResourceType;
 
 /**
- * This is the static base pointer of the list
+ * A component holding, or waiting for, an instance of a resource
  */
-static int globalTimestamp = 0;
+typedef struct RM_EntryType {
+	OMX_COMPONENTTYPE *openmaxStandComp;
+	OMX_U32 nGroupPriority; /**< the priority of the component when it made the request */
+	OMX_U32 timestamp; /**< the order of the request among all the requests, of any resource */
+	int nPosition; /**< the position of the entry in its heap */
+	OMX_BOOL bIsWaiting; /**< the entry is in the waiting queue, not among the holders */
+	int nQualityLevel; /**< the quality level admitted in the budgets, 0 if the component is not accounted */
+	int nPlannedLevel; /**< the quality level considered while admitting another component */
+	int nAppliedLevel; /**< the quality level last set in the component */
+	struct RM_EntryType *pNextConsumer; /**< the list of the components accounted in the budgets */
+	struct RM_EntryType *pPrevConsumer;
+} RM_EntryType;
 
 /**
- * This function initializes the Resource manager. In the current implementation
- * it does not perform any operation
+ * A binary heap of entries, the first element comes before all the others
+ * according to the before function
  */
-OMX_ERRORTYPE RM_Init() {
-	int i;
-	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-	globalIndex = 0;
-	listOfcomponentRegistered = calloc(1, sizeof(struct NameIndexType) * MAX_COMPONENTS_TYPES_HANDLED);
-	for (i = 0; i<MAX_COMPONENTS_TYPES_HANDLED; i++) {
-		listOfcomponentRegistered[i].index = -1;
-		listOfcomponentRegistered[i].component_name = NULL;
-	}
-	globalComponentList = malloc(sizeof(ComponentListType*) * MAX_COMPONENTS_TYPES_HANDLED);
-	globalWaitingComponentList = malloc(sizeof(ComponentListType*) * MAX_COMPONENTS_TYPES_HANDLED);
-	memset(globalComponentList, '\0', sizeof(ComponentListType*) * MAX_COMPONENTS_TYPES_HANDLED);
-	memset(globalWaitingComponentList, '\0', sizeof(ComponentListType*) * MAX_COMPONENTS_TYPES_HANDLED);
-	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-	return OMX_ErrorNone;
+typedef struct RM_HeapType {
+	RM_EntryType **elements;
+	int nelem;
+	int nmax;
+	int (*before)(const RM_EntryType *a, const RM_EntryType *b);
+} RM_HeapType;
+
+/**
+ * The instances of a component type handled by the resource manager.
+ * The heaps are protected by the mutex of the resource.
+ */
+struct RM_ResourceType {
+	pthread_mutex_t mutex;
+	char* component_name;
+	int max_components;
+	RM_HeapType holders;
+	RM_HeapType waiting;
+};
+
+/**
+ * The registered resources. The lock protects the registration and the
+ * resolution of the names, the resources themselves are never moved.
+ */
+static pthread_mutex_t rmMutex = PTHREAD_MUTEX_INITIALIZER;
+static int rmUsers = 0;
+static RM_ResourceType *rmResources = NULL;
+static int rmResourcesCount = 0;
+static name_index_t rmNames;
+
+/**
+ * The aggregate budgets of all the components handled, 0 for no limit,
+ * and the components accounted in them. The lock is always taken after the
+ * lock of a resource, never before.
+ *
+ * The quality levels are set in the components by RM_applyLevels, once the
+ * other locks are released, under rmLevelMutex alone. That lock is taken
+ * before rmBudgetMutex, and never before the lock of a resource.
+ */
+static pthread_mutex_t rmLevelMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t rmBudgetMutex = PTHREAD_MUTEX_INITIALIZER;
+static int rmBudgetCPU = 0;
+static int rmBudgetMemory = 0;
+static int rmUsedCPU = 0;
+static int rmUsedMemory = 0;
+static RM_EntryType *rmConsumers = NULL;
+
+/**
+ * The sequence the timestamps of the requests are taken from. It is shared
+ * by all the resources, so that the consumers of the budgets, holding
+ * different resources, are ordered too.
+ */
+static OMX_U32 rmTimestamp = 0;
+
+static OMX_U32 RM_nextTimestamp() {
+	return __atomic_fetch_add(&rmTimestamp, 1, __ATOMIC_SEQ_CST);
 }
 
-/** This function is called during initialization by any component interested in be
- * handled by the internal resource manager
+/**
+ * Orders two timestamps, also when the counter wrapped around
  */
-OMX_ERRORTYPE RM_RegisterComponent(char *name, int max_components) {
-	int i = 0;
-	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-	while (listOfcomponentRegistered[i].component_name != NULL) {
-		if (!strcmp(listOfcomponentRegistered[i].component_name, name)) {
-			DEBUG(DEB_LEV_FUNCTION_NAME, "In %s component already registered\n", __func__);
-			return OMX_ErrorNone;
+static int RM_isOlder(OMX_U32 a, OMX_U32 b) {
+	return (OMX_S32)(a - b) < 0;
+}
+
+/**
+ * The order of the holders: the preemption candidate first, that is the
+ * lowest priority (the highest nGroupPriority) and, among equals, the oldest
+ */
+static int RM_holderBefore(const RM_EntryType *a, const RM_EntryType *b) {
+	if (a->nGroupPriority != b->nGroupPriority) {
+		return a->nGroupPriority > b->nGroupPriority;
+	}
+	return RM_isOlder(a->timestamp, b->timestamp);
+}
+
+/**
+ * The order of the waiting queue: the next to be served first, that is the
+ * highest priority and, among equals, the oldest
+ */
+static int RM_waiterBefore(const RM_EntryType *a, const RM_EntryType *b) {
+	if (a->nGroupPriority != b->nGroupPriority) {
+		return a->nGroupPriority < b->nGroupPriority;
+	}
+	return RM_isOlder(a->timestamp, b->timestamp);
+}
+
+static void RM_heapSwap(RM_HeapType *heap, int i, int j) {
+	RM_EntryType *entry = heap->elements[i];
+	heap->elements[i] = heap->elements[j];
+	heap->elements[j] = entry;
+	heap->elements[i]->nPosition = i;
+	heap->elements[j]->nPosition = j;
+}
+
+static void RM_heapUp(RM_HeapType *heap, int i) {
+	int parent;
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (!heap->before(heap->elements[i], heap->elements[parent])) {
+			break;
 		}
-		i++;
+		RM_heapSwap(heap, i, parent);
+		i = parent;
 	}
-	listOfcomponentRegistered[i].component_name = calloc(1, OMX_MAX_STRINGNAME_SIZE);
-	if (listOfcomponentRegistered[i].component_name == NULL) {
-		return OMX_ErrorInsufficientResources;
+}
+
+static void RM_heapDown(RM_HeapType *heap, int i) {
+	int child, first;
+	for (;;) {
+		first = i;
+		child = 2 * i + 1;
+		if (child < heap->nelem && heap->before(heap->elements[child], heap->elements[first])) {
+			first = child;
+		}
+		child++;
+		if (child < heap->nelem && heap->before(heap->elements[child], heap->elements[first])) {
+			first = child;
+		}
+		if (first == i) {
+			break;
+		}
+		RM_heapSwap(heap, i, first);
+		i = first;
 	}
-	strcpy(listOfcomponentRegistered[i].component_name, name);
-	listOfcomponentRegistered[i].component_name[strlen(name)] = '\0';
-	listOfcomponentRegistered[i].index = globalIndex;
-	listOfcomponentRegistered[i].max_components = max_components;
-	globalIndex++;
-	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-	return OMX_ErrorNone;
 }
 
 /**
- * This function de-initializes the resource manager.
- * In the current implementation its responsibility is to clean up any queue
- * that can be left pending at the end of usage. With a correct use of the
- * resource manager it won't happen, but it is safer to clean up everything
- * this these lists are global and alive for all the life of IL client,
- * beyond the usual OMX_Init - Deinit scope.
+ * Adds an entry to a heap, growing it if needed
  */
-OMX_ERRORTYPE RM_Deinit() {
-	int i = 0;
-	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-	while(globalComponentList[i] != NULL) {
-		clearList(&globalComponentList[i]);
-		clearList(&globalWaitingComponentList[i]);
-		i++;
+static OMX_ERRORTYPE RM_heapPush(RM_HeapType *heap, RM_EntryType *entry) {
+	RM_EntryType **elements;
+	int nmax;
+
+	if (heap->nelem == heap->nmax) {
+		nmax = heap->nmax ? 2 * heap->nmax : 8;
+		elements = realloc(heap->elements, nmax * sizeof(RM_EntryType*));
+		if (!elements) {
+			return OMX_ErrorInsufficientResources;
+		}
+		heap->elements = elements;
+		heap->nmax = nmax;
 	}
-	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
+	heap->elements[heap->nelem] = entry;
+	entry->nPosition = heap->nelem;
+	heap->nelem++;
+	RM_heapUp(heap, entry->nPosition);
 	return OMX_ErrorNone;
 }
 
 /**
- * This function adds a new element to a given list.
- * If it does not yet exists, this function also allocates the list.
+ * Removes an entry from any position of a heap
  */
-OMX_ERRORTYPE addElemToList(ComponentListType **list, OMX_COMPONENTTYPE *openmaxStandComp, int index, OMX_BOOL bIsWaiting) {
-	ComponentListType *componentTemp;
-	ComponentListType *componentNext;
+static void RM_heapRemove(RM_HeapType *heap, RM_EntryType *entry) {
+	RM_EntryType *moved;
+	int i = entry->nPosition;
+
+	heap->nelem--;
+	if (i == heap->nelem) {
+		return;
+	}
+	moved = heap->elements[heap->nelem];
+	heap->elements[i] = moved;
+	moved->nPosition = i;
+	RM_heapUp(heap, i);
+	RM_heapDown(heap, moved->nPosition);
+}
+
+static RM_EntryType *RM_heapTop(RM_HeapType *heap) {
+	return heap->nelem ? heap->elements[0] : NULL;
+}
+
+static void RM_heapClear(RM_HeapType *heap) {
+	int i;
+	for (i = 0; i < heap->nelem; i++) {
+		free(heap->elements[i]);
+	}
+	free(heap->elements);
+	heap->elements = NULL;
+	heap->nelem = 0;
+	heap->nmax = 0;
+}
+
+/**
+ * Reads the budgets from RM_BUDGET_ENV, as a comma separated list of
+ * cpu=value and memory=value
+ */
+static void RM_readBudget() {
+	const char *config = getenv(RM_BUDGET_ENV);
+	const char *token;
+
+	rmBudgetCPU = 0;
+	rmBudgetMemory = 0;
+	for (token = config; token && *token; token = strchr(token, ',')) {
+		if (*token == ',') {
+			token++;
+		}
+		if (!strncmp(token, "cpu=", 4)) {
+			rmBudgetCPU = atoi(token + 4);
+		} else if (!strncmp(token, "memory=", 7)) {
+			rmBudgetMemory = atoi(token + 7);
+		}
+	}
+	DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s cpu budget %i memory budget %i\n", __func__, rmBudgetCPU, rmBudgetMemory);
+}
+
+static omx_base_component_PrivateType *RM_entryPrivate(const RM_EntryType *entry) {
+	return (omx_base_component_PrivateType*)entry->openmaxStandComp->pComponentPrivate;
+}
+
+/**
+ * The number of quality levels of the component of an entry, 0 if it does
+ * not describe the resources it needs
+ */
+static int RM_qualityLevels(const RM_EntryType *entry) {
+	omx_base_component_PrivateType* omx_base_component_Private = RM_entryPrivate(entry);
+	if (!omx_base_component_Private->multiResourceLevel) {
+		return 0;
+	}
+	return omx_base_component_Private->nqualitylevels;
+}
+
+static multiResourceDescriptor *RM_levelCost(const RM_EntryType *entry, int level) {
+	return RM_entryPrivate(entry)->multiResourceLevel[level - 1];
+}
+
+/**
+ * Accounts a component at a quality level. The component itself is told by
+ * RM_applyLevels. Must be called with rmBudgetMutex.
+ */
+static void RM_setLevel(RM_EntryType *entry, int level) {
+	multiResourceDescriptor *cost;
+
+	if (entry->nQualityLevel) {
+		cost = RM_levelCost(entry, entry->nQualityLevel);
+		rmUsedCPU -= cost->CPUResourceRequested;
+		rmUsedMemory -= cost->MemoryResourceRequested;
+	}
+	cost = RM_levelCost(entry, level);
+	rmUsedCPU += cost->CPUResourceRequested;
+	rmUsedMemory += cost->MemoryResourceRequested;
+	entry->nQualityLevel = level;
+	entry->nPlannedLevel = level;
+}
+
+/**
+ * Sets in the components the quality levels they are accounted at, when they
+ * changed. The levels are read again under rmBudgetMutex, but the components
+ * are called out of it and out of the locks of the resources, so that the
+ * callbacks can take their time. Calls made by concurrent threads are
+ * serialized by rmLevelMutex, the last one setting the latest levels.
+ */
+static void RM_applyLevels() {
 	omx_base_component_PrivateType* omx_base_component_Private;
-	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s is waiting %i\n", __func__, bIsWaiting);
-	omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
-	if (!*list) {
-		*list = malloc(sizeof(ComponentListType));
-		if (!bIsWaiting) {
-			globalComponentList[index] = *list;
-		} else {
-			globalWaitingComponentList[index] = *list;
+	OMX_COMPONENTTYPE *openmaxStandComp;
+	RM_EntryType *consumer;
+	int level;
+
+	pthread_mutex_lock(&rmLevelMutex);
+	for (;;) {
+		pthread_mutex_lock(&rmBudgetMutex);
+		for (consumer = rmConsumers; consumer; consumer = consumer->pNextConsumer) {
+			if (consumer->nAppliedLevel != consumer->nQualityLevel) {
+				break;
+			}
 		}
-		if (!*list) {
-			DEBUG(DEB_LEV_ERR, "In %s OMX_ErrorInsufficientResources\n", __func__);
-			return OMX_ErrorInsufficientResources;
+		if (!consumer) {
+			pthread_mutex_unlock(&rmBudgetMutex);
+			break;
 		}
-		(*list)->openmaxStandComp = openmaxStandComp;
-		(*list)->timestamp = globalTimestamp;
-		globalTimestamp++;
-		(*list)->nGroupPriority = omx_base_component_Private->nGroupPriority;
-		(*list)->next = NULL;
-		DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-		return OMX_ErrorNone;
+		consumer->nAppliedLevel = consumer->nQualityLevel;
+		openmaxStandComp = consumer->openmaxStandComp;
+		level = consumer->nQualityLevel;
+		pthread_mutex_unlock(&rmBudgetMutex);
+		omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+		omx_base_component_Private->setQualityLevel(openmaxStandComp, level);
 	}
-	componentTemp = *list;
-	while(componentTemp->next) {
-		componentTemp = componentTemp->next;
+	pthread_mutex_unlock(&rmLevelMutex);
+}
+
+/**
+ * The consumers in the order of preemption, lowest priority first and, among
+ * equals, the oldest request first, whatever resource they hold
+ */
+static int RM_compareConsumers(const void *a, const void *b) {
+	const RM_EntryType *ea = *(RM_EntryType * const *)a;
+	const RM_EntryType *eb = *(RM_EntryType * const *)b;
+	if (RM_holderBefore(ea, eb)) {
+		return -1;
 	}
-	componentNext = malloc(sizeof(ComponentListType));
-	if (!componentNext) {
-		DEBUG(DEB_LEV_ERR, "In %s OMX_ErrorInsufficientResources\n", __func__);
-		return OMX_ErrorInsufficientResources;
+	return RM_holderBefore(eb, ea) ? 1 : 0;
+}
+
+/**
+ * Returns the consumers sorted lowest priority first, NULL if there are none
+ * or if the memory is not enough
+ */
+static RM_EntryType **RM_sortedConsumers(int *pCount) {
+	RM_EntryType **consumers;
+	RM_EntryType *consumer;
+	int count = 0;
+
+	for (consumer = rmConsumers; consumer; consumer = consumer->pNextConsumer) {
+		count++;
 	}
-	componentTemp->next = componentNext;
-	componentNext->next = NULL;
-	componentNext->openmaxStandComp = openmaxStandComp;
-	componentNext->timestamp = globalTimestamp;
-	globalTimestamp++;
-	componentNext->nGroupPriority = omx_base_component_Private->nGroupPriority;
-	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-	return OMX_ErrorNone;
+	*pCount = 0;
+	if (count == 0 || !(consumers = malloc(count * sizeof(RM_EntryType*)))) {
+		return NULL;
+	}
+	for (consumer = rmConsumers; consumer; consumer = consumer->pNextConsumer) {
+		consumers[(*pCount)++] = consumer;
+	}
+	qsort(consumers, count, sizeof(RM_EntryType*), RM_compareConsumers);
+	return consumers;
+}
+
+static void RM_unlinkConsumer(RM_EntryType *entry) {
+	multiResourceDescriptor *cost = RM_levelCost(entry, entry->nQualityLevel);
+
+	rmUsedCPU -= cost->CPUResourceRequested;
+	rmUsedMemory -= cost->MemoryResourceRequested;
+	if (entry->pPrevConsumer) {
+		entry->pPrevConsumer->pNextConsumer = entry->pNextConsumer;
+	} else {
+		rmConsumers = entry->pNextConsumer;
+	}
+	if (entry->pNextConsumer) {
+		entry->pNextConsumer->pPrevConsumer = entry->pPrevConsumer;
+	}
+	entry->nQualityLevel = 0;
 }
 
 /**
- * This function removes the given element from the list, if present.
- * If the list is empty, this function cleans up everything.
+ * Steps the consumers up again, the highest priority first, as long as the
+ * budgets allow it
  */
-OMX_ERRORTYPE removeElemFromList(ComponentListType **list, OMX_COMPONENTTYPE *openmaxStandComp) {
-	ComponentListType *componentTemp;
-	ComponentListType *componentPrev;
-	OMX_BOOL bFound = OMX_FALSE;
+static void RM_budgetRestore() {
+	RM_EntryType **consumers;
+	RM_EntryType *consumer;
+	multiResourceDescriptor *current, *better;
+	int count, i;
+
+	pthread_mutex_lock(&rmBudgetMutex);
+	consumers = RM_sortedConsumers(&count);
+	for (i = count - 1; i >= 0; i--) {
+		consumer = consumers[i];
+		while (consumer->nQualityLevel > 1) {
+			current = RM_levelCost(consumer, consumer->nQualityLevel);
+			better = RM_levelCost(consumer, consumer->nQualityLevel - 1);
+			if ((rmBudgetCPU && rmUsedCPU + better->CPUResourceRequested - current->CPUResourceRequested > rmBudgetCPU) ||
+			    (rmBudgetMemory && rmUsedMemory + better->MemoryResourceRequested - current->MemoryResourceRequested > rmBudgetMemory)) {
+				break;
+			}
+			DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s component %p back to quality level %i\n", __func__, consumer->openmaxStandComp, consumer->nQualityLevel - 1);
+			RM_setLevel(consumer, consumer->nQualityLevel - 1);
+		}
+	}
+	pthread_mutex_unlock(&rmBudgetMutex);
+	free(consumers);
+	RM_applyLevels();
+}
 
-	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s list %p\n", __func__, *list);
-	if (!*list) {
-		DEBUG(DEB_LEV_ERR, "In %s, the resource manager is not initialized\n", __func__);
-		return OMX_ErrorUndefined;
+/**
+ * Gives back the share of the budgets of a component leaving its resource.
+ * The other components are stepped up by RM_budgetRestore, once the waiting
+ * ones had their chance. Must be called with the lock of the resource.
+ * The component is not called by RM_applyLevels any more once it returns.
+ */
+static void RM_budgetRelease(RM_EntryType *entry) {
+	if (!entry->nQualityLevel) {
+		return;
+	}
+	pthread_mutex_lock(&rmLevelMutex);
+	pthread_mutex_lock(&rmBudgetMutex);
+	RM_unlinkConsumer(entry);
+	pthread_mutex_unlock(&rmBudgetMutex);
+	pthread_mutex_unlock(&rmLevelMutex);
+}
+
+/**
+ * Admits a component in the budgets, at the best quality level that fits.
+ *
+ * When no level fits as is, the running components of lower priority are
+ * stepped down, the lowest priority and oldest first, as far as needed to
+ * admit the requester at the best level possible. The share of the victim
+ * of the preemption, if any, is counted as already released.
+ * Must be called with the lock of the resource, the new levels are set in
+ * the components by RM_applyLevels once it is released.
+ *
+ * @return OMX_ErrorInsufficientResources if not even the lowest quality
+ * level fits, and nothing is changed
+ */
+static OMX_ERRORTYPE RM_budgetAdmit(RM_EntryType *entry, RM_EntryType *victim) {
+	RM_EntryType **consumers;
+	RM_EntryType *consumer;
+	multiResourceDescriptor *cost, *current, *lower;
+	int levels = RM_qualityLevels(entry);
+	int freeCPU, freeMemory, needCPU, needMemory;
+	int count, level, i;
+
+	entry->nQualityLevel = 0;
+	entry->nAppliedLevel = 0;
+	if (levels == 0 || (rmBudgetCPU == 0 && rmBudgetMemory == 0)) {
+		return OMX_ErrorNone;
 	}
-	componentTemp = *list;
-	componentPrev = *list;
-	while(componentTemp) {
-		if (componentTemp->openmaxStandComp == openmaxStandComp) {
-			if (componentTemp == *list) {
-				*list = (*list)->next;
-				free(componentTemp);
-			} else {
-				componentPrev->next = componentTemp->next;
-				free(componentTemp);
+	pthread_mutex_lock(&rmBudgetMutex);
+	freeCPU = rmBudgetCPU - rmUsedCPU;
+	freeMemory = rmBudgetMemory - rmUsedMemory;
+	if (victim && victim->nQualityLevel) {
+		cost = RM_levelCost(victim, victim->nQualityLevel);
+		freeCPU += cost->CPUResourceRequested;
+		freeMemory += cost->MemoryResourceRequested;
+	}
+	consumers = RM_sortedConsumers(&count);
+	for (level = 1; level <= levels; level++) {
+		cost = RM_levelCost(entry, level);
+		needCPU = rmBudgetCPU ? cost->CPUResourceRequested - freeCPU : 0;
+		needMemory = rmBudgetMemory ? cost->MemoryResourceRequested - freeMemory : 0;
+		for (i = 0; i < count && (needCPU > 0 || needMemory > 0); i++) {
+			consumer = consumers[i];
+			if (consumer == victim || consumer->nGroupPriority <= entry->nGroupPriority) {
+				continue;
 			}
-			 bFound = OMX_TRUE;
-			 break;
-		} else {
-			if (componentTemp != *list) {
-				componentPrev = componentPrev->next;
+			consumer->nPlannedLevel = consumer->nQualityLevel;
+			while ((needCPU > 0 || needMemory > 0) && consumer->nPlannedLevel < RM_qualityLevels(consumer)) {
+				current = RM_levelCost(consumer, consumer->nPlannedLevel);
+				lower = RM_levelCost(consumer, consumer->nPlannedLevel + 1);
+				if (!(needCPU > 0 && lower->CPUResourceRequested < current->CPUResourceRequested) &&
+				    !(needMemory > 0 && lower->MemoryResourceRequested < current->MemoryResourceRequested)) {
+					break;
+				}
+				if (rmBudgetCPU) {
+					needCPU -= current->CPUResourceRequested - lower->CPUResourceRequested;
+				}
+				if (rmBudgetMemory) {
+					needMemory -= current->MemoryResourceRequested - lower->MemoryResourceRequested;
+				}
+				consumer->nPlannedLevel++;
 			}
-			componentTemp = componentTemp->next;
+		}
+		if (needCPU <= 0 && needMemory <= 0) {
+			break;
+		}
+		for (i = 0; i < count; i++) {
+			consumers[i]->nPlannedLevel = consumers[i]->nQualityLevel;
+		}
+	}
+	if (level > levels) {
+		pthread_mutex_unlock(&rmBudgetMutex);
+		free(consumers);
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the budgets are exhausted\n", __func__);
+		return OMX_ErrorInsufficientResources;
+	}
+	for (i = 0; i < count; i++) {
+		if (consumers[i]->nPlannedLevel != consumers[i]->nQualityLevel) {
+			DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s component %p stepped down to quality level %i\n", __func__, consumers[i]->openmaxStandComp, consumers[i]->nPlannedLevel);
+			RM_setLevel(consumers[i], consumers[i]->nPlannedLevel);
 		}
 	}
-	if(!bFound) {
-		DEBUG(DEB_LEV_ERR, "In %s, the specified component does not exist\n", __func__);
-		return OMX_ErrorComponentNotFound;
+	free(consumers);
+	if (victim && victim->nQualityLevel) {
+		RM_unlinkConsumer(victim);
 	}
-	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
+	RM_setLevel(entry, level);
+	entry->pPrevConsumer = NULL;
+	entry->pNextConsumer = rmConsumers;
+	if (rmConsumers) {
+		rmConsumers->pPrevConsumer = entry;
+	}
+	rmConsumers = entry;
+	pthread_mutex_unlock(&rmBudgetMutex);
 	return OMX_ErrorNone;
-
 }
 
-
 /**
- * This function returns the number of elements present in the
- * list. If the list does not exists, this function returns 0 elements
- * without further warnings
+ * This function initializes the Resource manager. The first call allocates
+ * the table of the resources, the following ones only count the users.
  */
-int numElemInList(ComponentListType *list) {
-	ComponentListType *componentTemp;
-	int numElem = 0;
+OMX_ERRORTYPE RM_Init() {
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-	if (!list) {
-		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s, no list no elements\n", __func__);
-		return 0;
-	}
-	componentTemp = list;
-	while(componentTemp) {
-		numElem++;
-		componentTemp = componentTemp->next;
+	pthread_mutex_lock(&rmMutex);
+	if (rmUsers == 0) {
+		rmResources = calloc(MAX_COMPONENTS_TYPES_HANDLED, sizeof(RM_ResourceType));
+		if (!rmResources || name_index_init(&rmNames, MAX_COMPONENTS_TYPES_HANDLED) != 0) {
+			free(rmResources);
+			rmResources = NULL;
+			pthread_mutex_unlock(&rmMutex);
+			DEBUG(DEB_LEV_ERR, "In %s OMX_ErrorInsufficientResources\n", __func__);
+			return OMX_ErrorInsufficientResources;
+		}
+		rmResourcesCount = 0;
+		RM_readBudget();
 	}
+	rmUsers++;
+	pthread_mutex_unlock(&rmMutex);
 	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-	return numElem;
+	return OMX_ErrorNone;
 }
 
-/**
- * This function deallocate any remaining element in a list
- * and dispose it
+/** This function is called during initialization by any component interested in be
+ * handled by the internal resource manager
  */
-OMX_ERRORTYPE clearList(ComponentListType **list) {
-	ComponentListType *componentTemp;
-	ComponentListType *componentPrev;
+OMX_ERRORTYPE RM_RegisterComponent(char *name, int max_components) {
+	RM_ResourceType *resource;
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-	if (!*list) {
-		DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, no list no elements\n", __func__);
+	pthread_mutex_lock(&rmMutex);
+	if (!rmResources) {
+		pthread_mutex_unlock(&rmMutex);
+		DEBUG(DEB_LEV_ERR, "In %s, the resource manager is not initialized\n", __func__);
+		return OMX_ErrorNone;
+	}
+	if (name_index_find(&rmNames, name, NULL)) {
+		pthread_mutex_unlock(&rmMutex);
+		DEBUG(DEB_LEV_FUNCTION_NAME, "In %s component already registered\n", __func__);
 		return OMX_ErrorNone;
 	}
-	componentTemp = *list;
-	while(componentTemp) {
-		componentPrev = componentTemp;
-		componentTemp = componentTemp->next;
-		free(componentPrev);
+	if (rmResourcesCount == MAX_COMPONENTS_TYPES_HANDLED) {
+		pthread_mutex_unlock(&rmMutex);
+		return OMX_ErrorInsufficientResources;
+	}
+	resource = &rmResources[rmResourcesCount];
+	resource->component_name = strdup(name);
+	if (resource->component_name == NULL) {
+		pthread_mutex_unlock(&rmMutex);
+		return OMX_ErrorInsufficientResources;
 	}
-	*list = NULL;
+	resource->max_components = max_components;
+	resource->holders.before = RM_holderBefore;
+	resource->waiting.before = RM_waiterBefore;
+	pthread_mutex_init(&resource->mutex, NULL);
+	name_index_add(&rmNames, resource->component_name, rmResourcesCount, NAME_INDEX_GENERAL);
+	rmResourcesCount++;
+	pthread_mutex_unlock(&rmMutex);
 	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
 	return OMX_ErrorNone;
 }
 
 /**
- * This debug function is capable of printing the full list
- * actually stored
+ * This function de-initializes the resource manager.
+ * The last call cleans up any holder or waiter that can be left pending at
+ * the end of usage. With a correct use of the resource manager it won't
+ * happen, but it is safer to clean up everything.
  */
-void RM_printList(ComponentListType *list, int viewFlag) {
-	ComponentListType *componentTemp = list;
-	omx_base_component_PrivateType* omx_base_component_Private;
-	int index;
-
-	if (!list) {
-		printf("The list is empty\n");
-		return;
-	}
-	index = 0;
-	while (componentTemp) {
-		omx_base_component_Private = (omx_base_component_PrivateType*)componentTemp->openmaxStandComp->pComponentPrivate;
-		if ((viewFlag & RM_SHOW_NAME) == RM_SHOW_NAME) {
-			printf("Name %s ", omx_base_component_Private->name);
-		}
-		if ((viewFlag & RM_SHOW_ADDRESS) == RM_SHOW_ADDRESS) {
-			printf("Address %p ", componentTemp->openmaxStandComp);
+OMX_ERRORTYPE RM_Deinit() {
+	int i;
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
+	pthread_mutex_lock(&rmMutex);
+	if (rmUsers > 0 && --rmUsers == 0) {
+		for (i = 0; i < rmResourcesCount; i++) {
+			RM_heapClear(&rmResources[i].holders);
+			RM_heapClear(&rmResources[i].waiting);
+			pthread_mutex_destroy(&rmResources[i].mutex);
+			free(rmResources[i].component_name);
 		}
-		printf("\n");
-		index++;
-		componentTemp = componentTemp->next;
+		free(rmResources);
+		rmResources = NULL;
+		rmResourcesCount = 0;
+		name_index_deinit(&rmNames);
+		pthread_mutex_lock(&rmBudgetMutex);
+		rmConsumers = NULL;
+		rmUsedCPU = 0;
+		rmUsedMemory = 0;
+		pthread_mutex_unlock(&rmBudgetMutex);
 	}
+	pthread_mutex_unlock(&rmMutex);
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
+	return OMX_ErrorNone;
 }
 
 /**
- * This function returns the number of components that have a lower priority
- * than the value specified, and the lowest among all possibles.
- * If the number returned is 0, no component is preemptable. if it is 1 or more,
- * the oldest_component_preemptable will contain the reference to the preemptable
- * component with the oldest time stamp.
+ * This function returns the resource handling the given component, or NULL.
+ * The name is resolved at the first request of the component, the result
+ * is kept in the component.
  */
-int searchLowerPriority(ComponentListType *list, int current_priority, ComponentListType **oldest_component_preemptable) {
-	ComponentListType *componentTemp;
-	ComponentListType *componentCandidate;
-	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-	int nComp = 0;
-	if (!list) {
-		DEBUG(DEB_LEV_ERR, "In %s no list\n", __func__);
-		return OMX_ErrorUndefined;
-	}
-	componentTemp = list;
-	componentCandidate = NULL;
-	while (componentTemp) {
-		if (componentTemp->nGroupPriority > current_priority) {
-			nComp++;
-		}
-		if (nComp>0) {
-			if (componentCandidate) {
-				if (componentCandidate->timestamp > componentTemp->timestamp) {
-					componentCandidate = componentTemp;
-				}
-			} else {
-				componentCandidate = componentTemp;
+static RM_ResourceType *RM_findResource(omx_base_component_PrivateType* omx_base_component_Private) {
+	const name_index_entry_t *entry;
+
+	if (omx_base_component_Private->nResourceId == RM_RESOURCE_UNKNOWN) {
+		pthread_mutex_lock(&rmMutex);
+		omx_base_component_Private->nResourceId = RM_RESOURCE_NONE;
+		if (rmResources) {
+			entry = name_index_find(&rmNames, omx_base_component_Private->name, NULL);
+			if (entry) {
+				omx_base_component_Private->nResourceId = entry->component;
 			}
 		}
-		componentTemp = componentTemp->next;
+		pthread_mutex_unlock(&rmMutex);
 	}
-	*oldest_component_preemptable = componentCandidate;
-	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-	return nComp;
+	if (omx_base_component_Private->nResourceId < 0 || !rmResources) {
+		return NULL;
+	}
+	return &rmResources[omx_base_component_Private->nResourceId];
 }
 
 /**
- * This function tries to preempt the given component, that has been detected as
- * the candidate by the default policy defined in the OpenMAX spec.
+ * This function preempts the given component, that has been detected as
+ * the candidate by the default policy defined in the OpenMAX spec, and
+ * already lost its instance of the resource.
+ *
+ * The component is only asked to leave the resource: an Idle component
+ * sends OMX_ErrorResourcesLost and goes to Loaded, an Executing or Paused
+ * one goes first to Idle, returning its buffers, and sends
+ * OMX_ErrorResourcesPreempted. All of it is done by the message thread of
+ * the victim, so the requester does not wait for the teardown.
  */
-OMX_ERRORTYPE preemptComponent(OMX_COMPONENTTYPE *openmaxStandComp) {
+static OMX_ERRORTYPE preemptComponent(OMX_COMPONENTTYPE *openmaxStandComp) {
 	OMX_ERRORTYPE err;
-	omx_base_component_PrivateType* omx_base_component_Private = openmaxStandComp->pComponentPrivate;
 
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-
-	if (omx_base_component_Private->state == OMX_StateIdle) {
-        (*(omx_base_component_Private->callbacks->EventHandler))
-          (openmaxStandComp, omx_base_component_Private->callbackData,
-            OMX_EventError, OMX_ErrorResourcesLost, 0, NULL);
-        err = OMX_SendCommand(openmaxStandComp, OMX_CommandStateSet, OMX_StateLoaded, NULL);
-        if (err != OMX_ErrorNone) {
-        	DEBUG(DEB_LEV_ERR, "In %s, the state cannot be changed\n", __func__);
-        	return OMX_ErrorUndefined;
-        }
-    } else if ((omx_base_component_Private->state == OMX_StateExecuting) || (omx_base_component_Private->state == OMX_StatePause)) {
-    	// TODO fill also this section that cover the preemption of a running component
-    	// send OMX_ErrorResourcesPreempted
-    	// change state to Idle
-    	// send OMX_ErrorResourcesLost
-    	// change state to Loaded
-    }
+	err = omx_base_component_Preempt(openmaxStandComp);
+	if (err != OMX_ErrorNone) {
+		DEBUG(DEB_LEV_ERR, "In %s, the component cannot be preempted\n", __func__);
+		return OMX_ErrorUndefined;
+	}
 	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
 	return OMX_ErrorNone;
 }
 
+/**
+ * This function gives up a request of the resource that cannot be granted.
+ * A component that was waiting goes back in the waiting queue with its
+ * former timestamp, so that it still gets the resource when an instance is
+ * released; the entry of any other component is freed.
+ * Must be called with the lock of the resource, the entry must have just
+ * left the waiting queue, so that pushing it back does not allocate.
+ */
+static void RM_dropRequest(RM_ResourceType *resource, RM_EntryType *entry, OMX_BOOL bWasWaiting, OMX_U32 timestamp) {
+	if (!bWasWaiting) {
+		free(entry);
+		return;
+	}
+	entry->timestamp = timestamp;
+	entry->bIsWaiting = OMX_TRUE;
+	entry->nQualityLevel = 0;
+	RM_heapPush(&resource->waiting, entry);
+	((omx_base_component_PrivateType*)entry->openmaxStandComp->pComponentPrivate)->pResourceEntry = entry;
+}
+
 /**
  * This function is executed by a component when it changes state from Loaded to Idle.
  * If it return ErrorNone the resource is granted and it can transit to Idle.
  * In case the resource is already busy, the resource manager preempt another component
  * with a lower priority and a oldest time flag if it exists. Differently it returns OMX_ErrorInsufficientResources
+ *
+ * The candidate is taken from the holders under the lock of the resource,
+ * and preempted after the lock is released.
+ *
+ * The component must also fit in the CPU and memory budgets, at one of its
+ * quality levels, possibly stepping down components of lower priority.
  */
 OMX_ERRORTYPE RM_getResource(OMX_COMPONENTTYPE *openmaxStandComp) {
-	ComponentListType *componentCandidate;
 	omx_base_component_PrivateType* omx_base_component_Private;
-	int candidates;
+	RM_ResourceType *resource;
+	RM_EntryType *entry;
+	RM_EntryType *candidate;
+	OMX_COMPONENTTYPE *openmaxVictimComp = NULL;
+	OMX_BOOL bWasWaiting = OMX_FALSE;
+	OMX_U32 nWaitingTimestamp = 0;
 	OMX_ERRORTYPE err;
-	int i = 0;
-	int indexComponent = -1;
 
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
 	omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
-	while(listOfcomponentRegistered[i].component_name != NULL ) {
-		if (!strcmp(listOfcomponentRegistered[i].component_name, omx_base_component_Private->name)) {
-			// found component in the list of the resource manager
-			indexComponent = listOfcomponentRegistered[i].index;
-			break;
-		}
-		i++;
-	}
-	if (indexComponent <0) {
+	resource = RM_findResource(omx_base_component_Private);
+	if (!resource) {
 		// No resource to be handled
-		DEBUG(DEB_LEV_ERR, "In %s No resource to be handled\n", __func__);
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s No resource to be handled\n", __func__);
 		return OMX_ErrorNone;
 	}
-	if (numElemInList(globalComponentList[indexComponent]) >= listOfcomponentRegistered[i].max_components) {
-		candidates = searchLowerPriority(globalComponentList[indexComponent], omx_base_component_Private->nGroupPriority, &componentCandidate);
-		if (candidates) {
-			DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s candidates %i winner %p\n", __func__, candidates, componentCandidate->openmaxStandComp);
-			err = preemptComponent(componentCandidate->openmaxStandComp);
-			if (err != OMX_ErrorNone) {
-				DEBUG(DEB_LEV_ERR, "In %s the component cannot be preempted\n", __func__);
-				return OMX_ErrorInsufficientResources;
-			} else {
-				err = removeElemFromList(&globalComponentList[indexComponent], componentCandidate->openmaxStandComp);
-				err = addElemToList(&globalComponentList[indexComponent], openmaxStandComp, indexComponent, OMX_FALSE);
-				if (err != OMX_ErrorNone) {
-					DEBUG(DEB_LEV_ERR, "In %s memory error\n", __func__);
-					return OMX_ErrorInsufficientResources;
-				}
-			}
-		} else {
+	pthread_mutex_lock(&resource->mutex);
+	entry = omx_base_component_Private->pResourceEntry;
+	if (entry && !entry->bIsWaiting) {
+		// already granted when the component left the waiting queue
+		pthread_mutex_unlock(&resource->mutex);
+		return OMX_ErrorNone;
+	}
+	if (entry) {
+		// kept aside until the request succeeds, and queued again if it fails
+		RM_heapRemove(&resource->waiting, entry);
+		omx_base_component_Private->pResourceEntry = NULL;
+		bWasWaiting = OMX_TRUE;
+		nWaitingTimestamp = entry->timestamp;
+	} else {
+		entry = malloc(sizeof(RM_EntryType));
+		if (!entry) {
+			pthread_mutex_unlock(&resource->mutex);
+			DEBUG(DEB_LEV_ERR, "In %s memory error\n", __func__);
+			return OMX_ErrorInsufficientResources;
+		}
+		entry->openmaxStandComp = openmaxStandComp;
+	}
+	entry->nGroupPriority = omx_base_component_Private->nGroupPriority;
+	entry->timestamp = RM_nextTimestamp();
+	entry->bIsWaiting = OMX_FALSE;
+
+	candidate = NULL;
+	if (resource->holders.nelem >= resource->max_components) {
+		candidate = RM_heapTop(&resource->holders);
+		if (!candidate || candidate->nGroupPriority <= entry->nGroupPriority) {
+			RM_dropRequest(resource, entry, bWasWaiting, nWaitingTimestamp);
+			pthread_mutex_unlock(&resource->mutex);
 			DEBUG(DEB_LEV_SIMPLE_SEQ, "Out of %s with insufficient resources\n", __func__);
 			return OMX_ErrorInsufficientResources;
 		}
-
-	} else {
-		err = addElemToList(&globalComponentList[indexComponent], openmaxStandComp, indexComponent, OMX_FALSE);
+	}
+	if (RM_budgetAdmit(entry, candidate) != OMX_ErrorNone) {
+		RM_dropRequest(resource, entry, bWasWaiting, nWaitingTimestamp);
+		pthread_mutex_unlock(&resource->mutex);
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "Out of %s with insufficient budget\n", __func__);
+		return OMX_ErrorInsufficientResources;
+	}
+	if (candidate) {
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s winner %p\n", __func__, candidate->openmaxStandComp);
+		RM_heapRemove(&resource->holders, candidate);
+		openmaxVictimComp = candidate->openmaxStandComp;
+		((omx_base_component_PrivateType*)openmaxVictimComp->pComponentPrivate)->pResourceEntry = NULL;
+		free(candidate);
+	}
+	err = RM_heapPush(&resource->holders, entry);
+	if (err != OMX_ErrorNone) {
+		RM_budgetRelease(entry);
+		RM_dropRequest(resource, entry, bWasWaiting, nWaitingTimestamp);
+		pthread_mutex_unlock(&resource->mutex);
+		RM_budgetRestore();
+		DEBUG(DEB_LEV_ERR, "In %s memory error\n", __func__);
+		return OMX_ErrorInsufficientResources;
+	}
+	omx_base_component_Private->pResourceEntry = entry;
+	pthread_mutex_unlock(&resource->mutex);
+	RM_applyLevels();
+
+	if (openmaxVictimComp) {
+		err = preemptComponent(openmaxVictimComp);
+		if (err != OMX_ErrorNone) {
+			DEBUG(DEB_LEV_ERR, "In %s the component cannot be preempted\n", __func__);
+		}
 	}
 	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
 	return OMX_ErrorNone;
 }
 
+/**
+ * This function hands the instance of a resource just freed to the first
+ * waiting component, if any. It must be called with the lock of the resource.
+ *
+ * @return the component to be sent to Idle once the lock is released
+ */
+static OMX_COMPONENTTYPE *RM_grantToWaiting(RM_ResourceType *resource) {
+	RM_EntryType *entry;
+	OMX_U32 timestamp;
+
+	entry = RM_heapTop(&resource->waiting);
+	if (!entry || resource->holders.nelem >= resource->max_components) {
+		return NULL;
+	}
+	if (RM_budgetAdmit(entry, NULL) != OMX_ErrorNone) {
+		return NULL;
+	}
+	RM_heapRemove(&resource->waiting, entry);
+	timestamp = entry->timestamp;
+	entry->bIsWaiting = OMX_FALSE;
+	entry->timestamp = RM_nextTimestamp();
+	if (RM_heapPush(&resource->holders, entry) != OMX_ErrorNone) {
+		RM_budgetRelease(entry);
+		RM_dropRequest(resource, entry, OMX_TRUE, timestamp);
+		return NULL;
+	}
+	return entry->openmaxStandComp;
+}
+
 /**
  * This function is called by a component when it transit from Idle to Loaded and can release
  * its used resource handled by the resource manager
  */
 OMX_ERRORTYPE RM_releaseResource(OMX_COMPONENTTYPE *openmaxStandComp){
 	omx_base_component_PrivateType* omx_base_component_Private;
+	RM_ResourceType *resource;
+	RM_EntryType *entry;
 	OMX_COMPONENTTYPE *openmaxWaitingComp;
 	OMX_ERRORTYPE err;
 
-	int i = 0;
-	int indexComponent = -1;
-
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
 	omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
-
-	while(listOfcomponentRegistered[i].component_name != NULL ) {
-		if (!strcmp(listOfcomponentRegistered[i].component_name, omx_base_component_Private->name)) {
-			// found component in the list of the resource manager
-			indexComponent = listOfcomponentRegistered[i].index;
-			break;
-		}
-		i++;
-	}
-	if (indexComponent <0) {
+	resource = RM_findResource(omx_base_component_Private);
+	if (!resource) {
 		// No resource to be handled
-		DEBUG(DEB_LEV_ERR, "In %s No resource to be handled\n", __func__);
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s No resource to be handled\n", __func__);
 		return OMX_ErrorNone;
 	}
-	if (!globalComponentList[indexComponent]) {
-		DEBUG(DEB_LEV_ERR, "In %s, the resource manager is not initialized\n", __func__);
-		return OMX_ErrorUndefined;
-	}
-	err = removeElemFromList(&globalComponentList[indexComponent], openmaxStandComp);
-	if (err != OMX_ErrorNone) {
-		DEBUG(DEB_LEV_ERR, "In %s, the resource cannot be released\n", __func__);
+	pthread_mutex_lock(&resource->mutex);
+	entry = omx_base_component_Private->pResourceEntry;
+	if (!entry || entry->bIsWaiting) {
+		// the resource has been preempted, or never granted
+		pthread_mutex_unlock(&resource->mutex);
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s, the component does not hold the resource\n", __func__);
 		return OMX_ErrorUndefined;
 	}
-	if(numElemInList(globalWaitingComponentList[indexComponent])) {
-		openmaxWaitingComp = globalWaitingComponentList[indexComponent]->openmaxStandComp;
-		removeElemFromList(&globalWaitingComponentList[indexComponent], openmaxWaitingComp);
+	RM_heapRemove(&resource->holders, entry);
+	RM_budgetRelease(entry);
+	omx_base_component_Private->pResourceEntry = NULL;
+	free(entry);
+	openmaxWaitingComp = RM_grantToWaiting(resource);
+	pthread_mutex_unlock(&resource->mutex);
+	RM_budgetRestore();
+
+	if (openmaxWaitingComp) {
         err = OMX_SendCommand(openmaxWaitingComp, OMX_CommandStateSet, OMX_StateIdle, NULL);
         if (err != OMX_ErrorNone) {
         	DEBUG(DEB_LEV_ERR, "In %s, the state cannot be changed\n", __func__);
@@ -446,33 +871,56 @@ OMX_ERRORTYPE RM_releaseResource(OMX_COMPONENTTYPE *openmaxStandComp){
  * This function adds the given component to the waiting queue for
  * the given resource. When a resource becomes available through the
  * RM_releaseResource function the first element in the queue is taken
- * off the list and it receives the resource just released.
+ * off the list and it receives the resource just released. If an instance
+ * is already available the component receives it at once.
  */
 OMX_ERRORTYPE RM_waitForResource(OMX_COMPONENTTYPE *openmaxStandComp) {
 	omx_base_component_PrivateType* omx_base_component_Private;
-
-	int i = 0;
-	int indexComponent = -1;
+	RM_ResourceType *resource;
+	RM_EntryType *entry;
+	OMX_COMPONENTTYPE *openmaxWaitingComp;
+	OMX_ERRORTYPE err;
 
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
 	omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
-
-	while(listOfcomponentRegistered[i].component_name != NULL ) {
-		if (!strcmp(listOfcomponentRegistered[i].component_name, omx_base_component_Private->name)) {
-			// found component in the list of the resource manager
-			indexComponent = listOfcomponentRegistered[i].index;
-			break;
-		}
-		i++;
-	}
-	if (indexComponent <0) {
+	resource = RM_findResource(omx_base_component_Private);
+	if (!resource) {
 		// No resource to be handled
-		DEBUG(DEB_LEV_ERR, "In %s No resource to be handled\n", __func__);
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s No resource to be handled\n", __func__);
 		return OMX_ErrorNone;
 	}
-
-	addElemToList(&globalWaitingComponentList[indexComponent], openmaxStandComp, listOfcomponentRegistered[i].index, OMX_TRUE);
-
+	pthread_mutex_lock(&resource->mutex);
+	if (omx_base_component_Private->pResourceEntry) {
+		pthread_mutex_unlock(&resource->mutex);
+		return OMX_ErrorNone;
+	}
+	entry = malloc(sizeof(RM_EntryType));
+	if (!entry) {
+		pthread_mutex_unlock(&resource->mutex);
+		return OMX_ErrorInsufficientResources;
+	}
+	entry->openmaxStandComp = openmaxStandComp;
+	entry->nGroupPriority = omx_base_component_Private->nGroupPriority;
+	entry->timestamp = RM_nextTimestamp();
+	entry->bIsWaiting = OMX_TRUE;
+	entry->nQualityLevel = 0;
+	err = RM_heapPush(&resource->waiting, entry);
+	if (err != OMX_ErrorNone) {
+		pthread_mutex_unlock(&resource->mutex);
+		free(entry);
+		return err;
+	}
+	omx_base_component_Private->pResourceEntry = entry;
+	openmaxWaitingComp = RM_grantToWaiting(resource);
+	pthread_mutex_unlock(&resource->mutex);
+	RM_applyLevels();
+
+	if (openmaxWaitingComp) {
+		err = OMX_SendCommand(openmaxWaitingComp, OMX_CommandStateSet, OMX_StateIdle, NULL);
+		if (err != OMX_ErrorNone) {
+			DEBUG(DEB_LEV_ERR, "In %s, the state cannot be changed\n", __func__);
+		}
+	}
 	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
 	return OMX_ErrorNone;
 }
@@ -484,25 +932,25 @@ OMX_ERRORTYPE RM_waitForResource(OMX_COMPONENTTYPE *openmaxStandComp) {
  */
 OMX_ERRORTYPE RM_removeFromWaitForResource(OMX_COMPONENTTYPE *openmaxStandComp) {
 	omx_base_component_PrivateType* omx_base_component_Private;
-	int i = 0;
-	int indexComponent = -1;
+	RM_ResourceType *resource;
+	RM_EntryType *entry;
 
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
 	omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
-
-	while(listOfcomponentRegistered[i].component_name != NULL ) {
-		if (!strcmp(listOfcomponentRegistered[i].component_name, omx_base_component_Private->name)) {
-			// found component in the list of the resource manager
-			removeElemFromList(&globalComponentList[indexComponent], openmaxStandComp);
-			break;
-		}
-		i++;
-	}
-	if (indexComponent <0) {
+	resource = RM_findResource(omx_base_component_Private);
+	if (!resource) {
 		// No resource to be handled
-		DEBUG(DEB_LEV_ERR, "In %s No resource to be handled\n", __func__);
+		DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s No resource to be handled\n", __func__);
 		return OMX_ErrorNone;
 	}
+	pthread_mutex_lock(&resource->mutex);
+	entry = omx_base_component_Private->pResourceEntry;
+	if (entry && entry->bIsWaiting) {
+		RM_heapRemove(&resource->waiting, entry);
+		omx_base_component_Private->pResourceEntry = NULL;
+		free(entry);
+	}
+	pthread_mutex_unlock(&resource->mutex);
 	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
 	return OMX_ErrorNone;
 }
@@ -30,47 +30,49 @@
 
 #define MAX_COMPONENTS_TYPES_HANDLED 500
 
-#include "omxcore.h"
-
-
-typedef struct ComponentListType ComponentListType;
-struct ComponentListType {
-	OMX_COMPONENTTYPE *openmaxStandComp;
-	OMX_U32 nGroupPriority;
-	OMX_U32 timestamp;
-	ComponentListType* next;
-};
-
-typedef struct NameIndexType NameIndexType;
-struct NameIndexType {
-	char* component_name;
-	int index;
-	int max_components;
-};
-
-
-int globalIndex;
-NameIndexType *listOfcomponentRegistered;
-ComponentListType **globalComponentList;
-ComponentListType **globalWaitingComponentList;
+/** The resource id cached in a component before its first request */
+#define RM_RESOURCE_UNKNOWN -2
+/** The resource id cached in a component not handled by the resource manager */
+#define RM_RESOURCE_NONE -1
+
+/** The environment variable with the aggregate budgets of the components
+ * handled, for instance "cpu=100,memory=1048576". A missing or zero
+ * budget is not limited. It is read by the first RM_Init.
+ */
+#define RM_BUDGET_ENV "OMX_BELLAGIO_RM_BUDGET"
 
-OMX_ERRORTYPE RM_RegisterComponent(char *name, int max_components);
-OMX_ERRORTYPE addElemToList(ComponentListType **list, OMX_COMPONENTTYPE *openmaxStandComp, int index, OMX_BOOL bIsWaiting);
-OMX_ERRORTYPE removeElemFromList(ComponentListType **list, OMX_COMPONENTTYPE *openmaxStandComp);
-int numElemInList(ComponentListType *list);
-OMX_ERRORTYPE clearList(ComponentListType **list);
+#include "omxcore.h"
 
-/** Debug flags
+/** The resource manager keeps, for each registered component name, the
+ * components holding an instance of the resource in a heap ordered on
+ * (nGroupPriority, timestamp), so that the preemption candidate, the lowest
+ * priority and oldest holder, is found in constant time. The components
+ * waiting for the resource are kept in a queue ordered on the same key,
+ * the highest priority and oldest waiter first.
+ *
+ * Every resource has its own lock, the names are resolved once per
+ * component through a hash table and the result is cached in the
+ * component, so that components of different types never contend.
+ *
+ * A preempted component loses its instance at once, and the requester gets
+ * it without waiting: the victim leaves Executing, Pause or Idle in its own
+ * message thread.
+ *
+ * The components describing their quality levels are also admitted in
+ * aggregate CPU and memory budgets, at the best level that fits. The
+ * components of lower priority are stepped down with setQualityLevel to
+ * make room before the requester is given a lower level, and they are
+ * stepped up again when the budgets are released.
+ *
+ * The calls are reference counted, as every component loader calls RM_Init
+ * and RM_Deinit.
  */
-#define RM_SHOW_NAME 0x01
-#define RM_SHOW_ADDRESS 0x02
-
 OMX_ERRORTYPE RM_Init();
 OMX_ERRORTYPE RM_Deinit();
+OMX_ERRORTYPE RM_RegisterComponent(char *name, int max_components);
 OMX_ERRORTYPE RM_getResource(OMX_COMPONENTTYPE *openmaxStandComp);
 OMX_ERRORTYPE RM_releaseResource(OMX_COMPONENTTYPE *openmaxStandComp);
 OMX_ERRORTYPE RM_waitForResource(OMX_COMPONENTTYPE *openmaxStandComp);
 OMX_ERRORTYPE RM_removeFromWaitForResource(OMX_COMPONENTTYPE *openmaxStandComp);
-void RM_printList(ComponentListType *list, int viewFlag);
 
 #endif
@@ -39,9 +39,29 @@
 
 #include "omxcore.h"
 #include "omx_create_loaders.h"
+#include "component_pool.h"
+#include "core_extensions/OMXCoreRMExt.h"
 
-extern CPresult file_pipe_Constructor(CP_PIPETYPE* pPipe, CPstring szURI);
-extern CPresult inet_pipe_Constructor(CP_PIPETYPE* pPipe, CPstring szURI);
+extern CPresult file_pipe_Constructor(CP_PIPETYPE** ppPipe, CPstring szURI);
+extern CPresult inet_pipe_Constructor(CP_PIPETYPE** ppPipe, CPstring szURI);
+extern CPresult mem_pipe_Constructor(CP_PIPETYPE** ppPipe, CPstring szURI);
+extern CPresult shm_pipe_Constructor(CP_PIPETYPE** ppPipe, CPstring szURI);
+
+/** The maximum length of the scheme of a content pipe URI */
+#define MAX_SCHEME_LENGTH 16
+
+/** A scheme of content pipe URI, and the constructor of its pipes */
+typedef struct content_pipe_scheme_t {
+  char scheme[MAX_SCHEME_LENGTH];
+  BOSA_CONTENTPIPECONSTRUCTOR constructor;
+} content_pipe_scheme_t;
+
+/** The schemes known to OMX_GetContentPipe, the ones of the core first and
+ * then the ones added with BOSA_AddContentPipeScheme
+ */
+static content_pipe_scheme_t* contentPipeSchemes = NULL;
+static int content_pipe_schemes;
+static pthread_mutex_t contentPipeSchemesMutex = PTHREAD_MUTEX_INITIALIZER;
 
 /** The static field initialized is equal to 0 if the core is not initialized.
  * It is equal to 1 when the OMX_Init has been called
@@ -61,6 +81,11 @@ static int bosa_loaders;
  */
 BOSA_COMPONENTLOADER **loadersList = NULL;
 
+/** The instances of components built in advance, NULL unless configured by
+ * the environment variable COMPONENT_POOL_ENV
+ */
+static component_pool_t* componentPool = NULL;
+
 OMX_ERRORTYPE BOSA_AddComponentLoader(BOSA_COMPONENTLOADER *pLoader)
 {
   BOSA_COMPONENTLOADER **newLoadersList = NULL;
@@ -83,6 +108,143 @@ OMX_ERRORTYPE BOSA_AddComponentLoader(BOSA_COMPONENTLOADER *pLoader)
   return OMX_ErrorNone;
 }
 
+/** Adds a scheme, the lock of the schemes held */
+static OMX_ERRORTYPE addContentPipeScheme(const char* scheme, BOSA_CONTENTPIPECONSTRUCTOR constructor)
+{
+  content_pipe_scheme_t* newSchemes;
+  int i;
+
+  for (i = 0; i < content_pipe_schemes; i++) {
+    if (!strcmp(contentPipeSchemes[i].scheme, scheme)) {
+      contentPipeSchemes[i].constructor = constructor;
+      return OMX_ErrorNone;
+    }
+  }
+
+  newSchemes = realloc(contentPipeSchemes, (content_pipe_schemes + 1) * sizeof(content_pipe_scheme_t));
+  if (!newSchemes)
+    return OMX_ErrorInsufficientResources;
+
+  contentPipeSchemes = newSchemes;
+  strcpy(contentPipeSchemes[content_pipe_schemes].scheme, scheme);
+  contentPipeSchemes[content_pipe_schemes].constructor = constructor;
+  content_pipe_schemes++;
+
+  return OMX_ErrorNone;
+}
+
+/** Adds the schemes of the core, the lock of the schemes held */
+static OMX_ERRORTYPE addCoreContentPipeSchemes()
+{
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+
+  if (contentPipeSchemes)
+    return OMX_ErrorNone;
+
+  if (err == OMX_ErrorNone)
+    err = addContentPipeScheme("file", file_pipe_Constructor);
+  if (err == OMX_ErrorNone)
+    err = addContentPipeScheme("inet", inet_pipe_Constructor);
+  if (err == OMX_ErrorNone)
+    err = addContentPipeScheme("mem", mem_pipe_Constructor);
+  if (err == OMX_ErrorNone)
+    err = addContentPipeScheme("shm", shm_pipe_Constructor);
+
+  return err;
+}
+
+OMX_ERRORTYPE BOSA_AddContentPipeScheme(OMX_STRING scheme, BOSA_CONTENTPIPECONSTRUCTOR constructor)
+{
+  OMX_ERRORTYPE err;
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
+
+  if (!scheme || !constructor || !scheme[0] || strlen(scheme) >= MAX_SCHEME_LENGTH || strchr(scheme, ':'))
+    return OMX_ErrorBadParameter;
+
+  pthread_mutex_lock(&contentPipeSchemesMutex);
+  err = addCoreContentPipeSchemes();
+  if (err == OMX_ErrorNone)
+    err = addContentPipeScheme(scheme, constructor);
+  pthread_mutex_unlock(&contentPipeSchemesMutex);
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Content pipe scheme %s added\n", scheme);
+
+  return err;
+}
+
+/** @brief asks the component loaders to build a component
+ *
+ * The first loader that knows the name builds the component.
+ */
+static OMX_ERRORTYPE omx_core_create(OMX_HANDLETYPE* pHandle,
+  const char* cComponentName,
+  OMX_PTR pAppData,
+  OMX_CALLBACKTYPE* pCallBacks) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  int i;
+
+  for (i = 0; i < bosa_loaders; i++) {
+    err = loadersList[i]->BOSA_CreateComponent(
+          loadersList[i],
+          pHandle,
+          (OMX_STRING)cComponentName,
+          pAppData,
+          pCallBacks);
+    if (err == OMX_ErrorNone) {
+      // the component has been found
+      return OMX_ErrorNone;
+    }
+  }
+  /*Required to meet conformance test: do not remove*/
+  if (err == OMX_ErrorInsufficientResources) {
+    return OMX_ErrorInsufficientResources;
+  }
+  return OMX_ErrorComponentNotFound;
+}
+
+/** @brief asks the component loaders to destroy a component
+ *
+ * Only the loader that built the component destroys it.
+ */
+static OMX_ERRORTYPE omx_core_destroy(OMX_HANDLETYPE hComponent) {
+  OMX_ERRORTYPE err;
+  int i;
+
+  for (i = 0; i < bosa_loaders; i++) {
+    err = loadersList[i]->BOSA_DestroyComponent(
+          loadersList[i],
+          hComponent);
+    if (err == OMX_ErrorNone) {
+      // the component has been found and destroyed
+      return OMX_ErrorNone;
+    }
+  }
+  return OMX_ErrorComponentNotFound;
+}
+
+static OMX_ERRORTYPE omx_core_pool_construct(void* owner, const char* name,
+  OMX_CALLBACKTYPE* callbacks, OMX_COMPONENTTYPE** pComponent) {
+
+  OMX_HANDLETYPE handle = NULL;
+  OMX_ERRORTYPE err;
+
+  err = omx_core_create(&handle, name, NULL, callbacks);
+  if (err != OMX_ErrorNone) {
+    /* a component without resources is returned anyway */
+    if (err == OMX_ErrorInsufficientResources && handle != NULL) {
+      omx_core_destroy(handle);
+    }
+    return err;
+  }
+  *pComponent = handle;
+  return OMX_ErrorNone;
+}
+
+static void omx_core_pool_destroy(void* owner, OMX_COMPONENTTYPE* component) {
+  omx_core_destroy(component);
+}
+
 /** @brief The OMX_Init standard function
  *
  * This function calls the init function of each component loader added. If there
@@ -110,6 +272,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_Init() {
         return OMX_ErrorInsufficientResources;
       }
     }
+    componentPool = component_pool_create(getenv(COMPONENT_POOL_ENV), omx_core_pool_construct, omx_core_pool_destroy, NULL);
   }
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
@@ -118,12 +281,17 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_Init() {
 
 /** @brief The OMX_Deinit standard function
  *
- * In this function the Deinit function for each component loader is performed
+ * In this function the Deinit function for each component loader is performed,
+ * and the content pipe schemes, the ones added with BOSA_AddContentPipeScheme
+ * included, are forgotten
  */
 OSCL_EXPORT_REF OMX_ERRORTYPE OMX_Deinit() {
   int i = 0;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   if(initialized == 1) {
+    /* the instances of the pool are destroyed by their loaders */
+    component_pool_destroy(componentPool);
+    componentPool = NULL;
     for (i = 0; i < bosa_loaders; i++) {
       loadersList[i]->BOSA_DeInitComponentLoader(loadersList[i]);
       free(loadersList[i]);
@@ -132,6 +300,12 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_Deinit() {
   }
   free(loadersList);
   loadersList = 0;
+  pthread_mutex_lock(&contentPipeSchemesMutex);
+  free(contentPipeSchemes);
+  contentPipeSchemes = NULL;
+  content_pipe_schemes = 0;
+  pthread_mutex_unlock(&contentPipeSchemesMutex);
+  releaseQualityLevels();
   initialized = 0;
   bosa_loaders = 0;
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
@@ -145,6 +319,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_Deinit() {
  * the first component is returned. The existence of multiple components with
  * the same name is not contemplated in OpenMAX specification. The assumption is
  * that this behavior is NOT allowed.
+ * If the name is pooled, an instance built in advance is returned instead.
  *
  * @return OMX_ErrorNone if a component has been found
  *         OMX_ErrorComponentNotFound if the requested component has not been found
@@ -155,55 +330,53 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_GetHandle(OMX_HANDLETYPE* pHandle,
   OMX_PTR pAppData,
   OMX_CALLBACKTYPE* pCallBacks) {
 
-  OMX_ERRORTYPE err = OMX_ErrorNone;
-  int i;
+  OMX_COMPONENTTYPE* component = NULL;
+  OMX_ERRORTYPE err;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for %s\n", __func__, cComponentName);
 
-  for (i = 0; i < bosa_loaders; i++) {
-    err = loadersList[i]->BOSA_CreateComponent(
-          loadersList[i],
-          pHandle,
-          cComponentName,
-          pAppData,
-          pCallBacks);
-    if (err == OMX_ErrorNone) {
-      // the component has been found
-      return OMX_ErrorNone;
-    }
+  /* a new omxregister is seen by the quality level queries that follow */
+  invalidateQualityLevels();
+  if (componentPool != NULL) {
+    component = component_pool_get(componentPool, cComponentName);
   }
-  /*Required to meet conformance test: do not remove*/
-  if (err == OMX_ErrorInsufficientResources) {
-    return OMX_ErrorInsufficientResources;
+  if (component != NULL) {
+    component->SetCallbacks(component, pCallBacks, pAppData);
+    *pHandle = component;
+    return OMX_ErrorNone;
   }
+  err = omx_core_create(pHandle, cComponentName, pAppData, pCallBacks);
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-  return OMX_ErrorComponentNotFound;
+  return err;
 }
 
 /** @brief The OMX_FreeHandle standard function
  *
- * This function executes the BOSA_DestroyComponent of the component loaders
+ * This function executes the BOSA_DestroyComponent of the component loaders.
+ * If the component is pooled, it is destroyed later by the thread of the pool.
  *
  * @param hComponent the component handle to be freed
  *
  * @return The error of the BOSA_DestroyComponent function or OMX_ErrorNone
  */
 OSCL_EXPORT_REF OMX_ERRORTYPE OMX_FreeHandle(OMX_HANDLETYPE hComponent) {
-	int i;
-    OMX_ERRORTYPE err;
-    DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for %p\n", __func__, hComponent);
-
-    for (i = 0; i < bosa_loaders; i++) {
-    	err = loadersList[i]->BOSA_DestroyComponent(
-    			loadersList[i],
-    			hComponent);
-
-    	if (err == OMX_ErrorNone) {
-    		// the component has been found and destroyed
-    		return OMX_ErrorNone;
-    	}
-    }
-    DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-    return OMX_ErrorComponentNotFound;
+  OMX_COMPONENTTYPE* component = (OMX_COMPONENTTYPE*)hComponent;
+  char name[OMX_MAX_STRINGNAME_SIZE];
+  OMX_VERSIONTYPE componentVersion, specVersion;
+  OMX_UUIDTYPE uuid;
+  OMX_STATETYPE state;
+  OMX_ERRORTYPE err;
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for %p\n", __func__, hComponent);
+
+  /* an instance in the Loaded state is destroyed by the pool, that builds a new one */
+  if (componentPool != NULL &&
+      component->GetState(hComponent, &state) == OMX_ErrorNone && state == OMX_StateLoaded &&
+      component->GetComponentVersion(hComponent, name, &componentVersion, &specVersion, &uuid) == OMX_ErrorNone &&
+      component_pool_release(componentPool, name, component) == 0) {
+    return OMX_ErrorNone;
+  }
+  err = omx_core_destroy(hComponent);
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
+  return err;
 }
 
 /** @brief the OMX_ComponentNameEnum standard function
@@ -360,49 +533,24 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_GetComponentsOfRole (
   OMX_U32 *pNumComps,
   OMX_U8  **compNames) {
   OMX_ERRORTYPE err = OMX_ErrorNone;
-  int i,j;
-  int only_number_requested = 0, full_number=0;
+  int i;
+  OMX_U32 full_number = 0;
   OMX_U32 temp_num_comp = 0;
 
-  OMX_U8 **tempCompNames;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
-  if (compNames == NULL) {
-    only_number_requested = 1;
-  } else {
-    only_number_requested = 0;
-  }
+  /* each loader fills the part of the array left by the previous ones,
+   * and returns the number of its components even if they do not fit */
   for (i = 0; i < bosa_loaders; i++) {
-    temp_num_comp = *pNumComps;
+    temp_num_comp = (full_number < *pNumComps) ? *pNumComps - full_number : 0;
     err = loadersList[i]->BOSA_GetComponentsOfRole(
           loadersList[i],
           role,
           &temp_num_comp,
-          NULL);
+          (compNames != NULL) ? compNames + full_number : NULL);
     if (err != OMX_ErrorNone) {
       DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
       return OMX_ErrorComponentNotFound;
     }
-    if (only_number_requested == 0) {
-      tempCompNames = malloc(temp_num_comp * sizeof(OMX_STRING));
-      for (j=0; j<temp_num_comp; j++) {
-        tempCompNames[j] = malloc(OMX_MAX_STRINGNAME_SIZE * sizeof(char));
-      }
-      err = loadersList[i]->BOSA_GetComponentsOfRole(
-          loadersList[i],
-          role,
-          &temp_num_comp,
-          tempCompNames);
-      if (err != OMX_ErrorNone) {
-        DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
-        return OMX_ErrorComponentNotFound;
-      }
-
-      for (j = 0; j<temp_num_comp; j++) {
-        if (full_number + j < *pNumComps) {
-          strncpy((char *)compNames[full_number + j], (const char *)tempCompNames[j], 128);
-        }
-      }
-    }
     full_number += temp_num_comp;
   }
   *pNumComps = full_number;
@@ -417,16 +565,28 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_GetContentPipe(
 	  CPresult res;
 	  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
 
-	  if(strncmp(szURI, "file", 4) == 0) {
-	    res = file_pipe_Constructor((CP_PIPETYPE*) hPipe, szURI);
-	    if(res == 0x00000000)
-	      err = OMX_ErrorNone;
+	  BOSA_CONTENTPIPECONSTRUCTOR constructor = NULL;
+	  size_t length;
+	  int i;
+
+	  pthread_mutex_lock(&contentPipeSchemesMutex);
+	  if(addCoreContentPipeSchemes() == OMX_ErrorNone) {
+	    for(i = 0; i < content_pipe_schemes; i++) {
+	      length = strlen(contentPipeSchemes[i].scheme);
+	      if(strncmp(szURI, contentPipeSchemes[i].scheme, length) == 0 && szURI[length] == ':') {
+	        constructor = contentPipeSchemes[i].constructor;
+	        break;
+	      }
+	    }
 	  }
+	  pthread_mutex_unlock(&contentPipeSchemesMutex);
 
-	  else if(strncmp(szURI, "inet", 4) == 0) {
-	    res = inet_pipe_Constructor((CP_PIPETYPE*) hPipe, szURI);
+	  if(constructor) {
+	    res = constructor((CP_PIPETYPE**) hPipe, szURI);
 	    if(res == 0x00000000)
 	      err = OMX_ErrorNone;
+	  } else {
+	    DEBUG(DEB_LEV_ERR, "No content pipe for the scheme of %s\n", szURI);
 	  }
 	  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
 	  return err;
@@ -29,10 +29,12 @@
 
 #include <OMX_Component.h>
 #include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
 #include <pthread.h>
 
 #include "utils.h"
 #include "component_loader.h"
+#include "content_pipe_scheme.h"
 #include "omx_comp_debug_levels.h"
 #ifdef ANDROID_COMPILATION
 #include <oscl_base_macros.h>
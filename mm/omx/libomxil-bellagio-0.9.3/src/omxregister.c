@@ -41,27 +41,29 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 #include "st_static_component_loader.h"
+#include "registry_cache.h"
+#include "library_scan.h"
 #include "common.h"
 
 #define DEFAULT_LINE_LENGHT 500
+/** The extension added to the name of the registry for the fingerprints
+ * of the libraries registered
+ */
+#define FINGERPRINTS_EXTENSION ".libraries"
 /** String element to be put in the .omxregister file to indicate  an
  * OpenMAX component and its roles
  */
 static const char arrow[] =  " ==> ";
+/** String element to be put in the .omxregister file to introduce the roles
+ * of the component described in the previous line
+ */
+static const char role_arrow[] =  " --> ";
 
-int int2strlen(int value) {
-	int ret = 0;
-	if (value<0) return -1;
-	while(value>0) {
-		value = value/10;
-		ret++;
-	}
-	return ret;
-}
 /** This function shows all the components and related rules already registered
  * and described in the omxregister file
  */
@@ -99,7 +101,7 @@ static int showComponentsList(FILE* omxregistryfp) {
 		fseek(omxregistryfp, start_pos, SEEK_SET);
 		data_read = fread(buffer, offset, 1, omxregistryfp);
 		buffer[offset] = '\0';
-		if (buffer[0] == '/') {
+		if ((buffer[0] == '/') || (!strncmp(buffer, role_arrow, strlen(role_arrow)))) {
 			continue;
 		}
 		temp_buffer = buffer+5;
@@ -148,42 +150,291 @@ static int showComponentsList(FILE* omxregistryfp) {
 
 	return 0;
 }
-/** @brief Creates a list of components on a registry file
- *
- * This function
- *  - reads for the given directory(ies) any library contained
- *  - check if the library belongs to OpenMAX ST static component loader
- *    (it must contain the function omx_component_library_Setup for the initialization)
- *  - write the openmax names and related libraries to the registry file
+/** @brief a library described by the fingerprints file of a previous run */
+typedef struct storedLibraryType {
+	char* path;
+	long long size;
+	long long mtime_sec;
+	long long mtime_nsec;
+	char buildId[LIBRARY_SCAN_BUILD_ID_SIZE];
+	int num_of_comp;
+	stLoaderComponentType **stComponents;
+	struct storedLibraryType *next;
+} storedLibraryType;
+
+/** Returns the name of the file with the fingerprints of the libraries
+ * registered, next to the registry
  */
-static int buildComponentsList(FILE* omxregistryfp, char *componentspath, int verbose) {
-  DIR *dirp;
-	struct dirent *dp;
-	void *handle = NULL;
-	int i, num_of_comp, k, qi;
-	int num_of_libraries = 0;
+static char* fingerprintsGetFilename(void) {
+	char *registry_filename, *filename;
+
+	registry_filename = componentsRegistryGetFilename();
+	filename = malloc(strlen(registry_filename) + strlen(FINGERPRINTS_EXTENSION) + 1);
+	if (filename != NULL) {
+		strcpy(filename, registry_filename);
+		strcat(filename, FINGERPRINTS_EXTENSION);
+	}
+	free(registry_filename);
+	return filename;
+}
+
+/** Releases the descriptors of the components of a library */
+static void freeComponents(stLoaderComponentType **stComponents, int num_of_comp) {
+	int i, k;
+
+	for (i = 0; i < num_of_comp; i++) {
+		free(stComponents[i]->name);
+		for (k=0; k<stComponents[i]->name_specific_length; k++) {
+			free(stComponents[i]->name_specific[k]);
+			if (stComponents[i]->role_specific) {
+				free(stComponents[i]->role_specific[k]);
+			}
+		}
+		free(stComponents[i]->name_specific);
+		free(stComponents[i]->role_specific);
+		for (k=0; k<stComponents[i]->nqualitylevels; k++) {
+			free(stComponents[i]->multiResourceLevel[k]);
+		}
+		free(stComponents[i]->multiResourceLevel);
+		free(stComponents[i]);
+	}
+	free(stComponents);
+}
+
+/** Parses a list of names terminated by ':', up to a space or the end of the line */
+static unsigned int parseNames(const char* list, char*** names) {
+	const char* name;
+	unsigned int count = 0, i;
+	size_t length;
+
+	for (name = list; (*name != '\0') && (*name != ' ') && (*name != '\n'); name++) {
+		if (*name == ':') {
+			count++;
+		}
+	}
+	*names = calloc(count > 0 ? count : 1, sizeof(char*));
+	name = list;
+	for (i = 0; i < count; i++) {
+		length = strcspn(name, ":");
+		(*names)[i] = malloc(length + 1);
+		memcpy((*names)[i], name, length);
+		(*names)[i][length] = '\0';
+		name += length + 1;
+	}
+	return count;
+}
+
+/** Parses a component line of the registry, the roles are parsed later */
+static stLoaderComponentType* parseComponent(const char* line) {
+	stLoaderComponentType* component;
+	const char* field;
+	size_t length;
+	int qi;
+
+	component = calloc(1, sizeof(stLoaderComponentType));
+	field = line + strlen(arrow);
+	length = strcspn(field, " \n");
+	component->name = malloc(length + 1);
+	memcpy(component->name, field, length);
+	component->name[length] = '\0';
+	field += length;
+	while (!strncmp(field, arrow, strlen(arrow))) {
+		field += strlen(arrow);
+		length = strcspn(field, " \n");
+		if (memchr(field, ':', length) != NULL) {
+			component->name_specific_length = parseNames(field, &component->name_specific);
+			field += length;
+			continue;
+		}
+		/* the quality levels, their number then the CPU,memory pairs */
+		component->nqualitylevels = strtol(field, (char**)&field, 10);
+		component->multiResourceLevel = calloc(component->nqualitylevels + 1, sizeof(multiResourceDescriptor*));
+		for (qi = 0; qi < component->nqualitylevels; qi++) {
+			component->multiResourceLevel[qi] = calloc(1, sizeof(multiResourceDescriptor));
+			component->multiResourceLevel[qi]->CPUResourceRequested = strtol(field, (char**)&field, 10);
+			if (*field == ',') {
+				field++;
+			}
+			component->multiResourceLevel[qi]->MemoryResourceRequested = strtol(field, (char**)&field, 10);
+		}
+		field += strcspn(field, "\n");
+	}
+	return component;
+}
+
+/** Reads the fingerprints file of the previous run. Any library whose
+ * line cannot be parsed is simply probed again.
+ */
+static storedLibraryType* readFingerprints(void) {
+	storedLibraryType *stored = NULL, *last = NULL, *library;
+	stLoaderComponentType* component;
+	char *filename, *line, *field, *end;
+	size_t allocated = 0;
+	FILE* fp;
+	char** roles;
+	unsigned int nroles, j;
+	int i;
+
+	filename = fingerprintsGetFilename();
+	if (filename == NULL) {
+		return NULL;
+	}
+	fp = fopen(filename, "r");
+	free(filename);
+	if (fp == NULL) {
+		return NULL;
+	}
+	line = NULL;
+	library = NULL;
+	while (getline(&line, &allocated, fp) > 0) {
+		if (!strncmp(line, arrow, strlen(arrow))) {
+			if (library == NULL) {
+				continue;
+			}
+			component = parseComponent(line);
+			library->stComponents = realloc(library->stComponents, (library->num_of_comp + 1) * sizeof(stLoaderComponentType*));
+			library->stComponents[library->num_of_comp++] = component;
+		} else if (!strncmp(line, role_arrow, strlen(role_arrow))) {
+			if ((library == NULL) || (library->num_of_comp == 0)) {
+				continue;
+			}
+			component = library->stComponents[library->num_of_comp - 1];
+			nroles = parseNames(line + strlen(role_arrow), &roles);
+			if ((nroles != component->name_specific_length) || (component->role_specific != NULL)) {
+				/* not consistent, the library is probed again */
+				for (j = 0; j < nroles; j++) {
+					free(roles[j]);
+				}
+				free(roles);
+				library->size = -1;
+				continue;
+			}
+			component->role_specific = roles;
+		} else if (line[0] == '/') {
+			library = calloc(1, sizeof(storedLibraryType));
+			field = strchr(line, '\t');
+			if (field == NULL) {
+				free(library);
+				library = NULL;
+				continue;
+			}
+			library->path = malloc(field - line + 1);
+			memcpy(library->path, line, field - line);
+			library->path[field - line] = '\0';
+			library->size = strtoll(field, &end, 10);
+			library->mtime_sec = strtoll(end, &end, 10);
+			library->mtime_nsec = strtoll(end, &end, 10);
+			while (*end == '\t') {
+				end++;
+			}
+			strncpy(library->buildId, end, LIBRARY_SCAN_BUILD_ID_SIZE - 1);
+			library->buildId[strcspn(library->buildId, "\n")] = '\0';
+			if (last == NULL) {
+				stored = library;
+			} else {
+				last->next = library;
+			}
+			last = library;
+		}
+	}
+	free(line);
+	fclose(fp);
+	/* a component without its roles cannot be registered again as it is */
+	for (library = stored; library != NULL; library = library->next) {
+		for (i = 0; i < library->num_of_comp; i++) {
+			component = library->stComponents[i];
+			if ((component->name_specific_length > 0) && (component->role_specific == NULL)) {
+				library->size = -1;
+			}
+		}
+	}
+	return stored;
+}
+
+static void freeFingerprints(storedLibraryType* stored) {
+	storedLibraryType* next;
+
+	while (stored != NULL) {
+		next = stored->next;
+		freeComponents(stored->stComponents, stored->num_of_comp);
+		free(stored->path);
+		free(stored);
+		stored = next;
+	}
+}
+
+/** Searches a library of the previous run that is not changed since.
+ * The build-id is read only when the size and the modification time match.
+ */
+static storedLibraryType* findUnchangedLibrary(storedLibraryType* stored, libraryScanType* library) {
+	char buildId[LIBRARY_SCAN_BUILD_ID_SIZE];
+
+	for (; stored != NULL; stored = stored->next) {
+		if (strcmp(stored->path, library->path)) {
+			continue;
+		}
+		if ((stored->size != library->nSize) ||
+				(stored->mtime_sec != library->nMtimeSec) ||
+				(stored->mtime_nsec != library->nMtimeNsec)) {
+			return NULL;
+		}
+		if (libraryScanBuildId(library->path, buildId) || strcmp(buildId, stored->buildId)) {
+			return NULL;
+		}
+		return stored;
+	}
+	return NULL;
+}
+
+/** Formats the registry lines of a component: its names and quality levels,
+ * then its roles, that let the loader list the components without loading
+ * the library
+ */
+static void formatComponent(char* buffer, stLoaderComponentType* component) {
 	unsigned int j;
-	char *buffer = NULL;
-	int (*fptr)(void *);
-	stLoaderComponentType **stComponents;
-	int ncomponents = 0, nroles=0;
+	int qi;
+	char* end;
+
+	strcpy(buffer, arrow);
+	strcat(buffer, component->name);
+	if (component->name_specific_length>0) {
+		strcat(buffer, arrow);
+		for(j=0;j<component->name_specific_length;j++){
+			strcat(buffer, component->name_specific[j]);
+			strcat(buffer, ":");
+		}
+	}
+	if (component->nqualitylevels > 0) {
+		strcat(buffer, arrow);
+		end = buffer + strlen(buffer);
+		end += sprintf(end, "%i", (int)component->nqualitylevels);
+		for (qi=0; qi<component->nqualitylevels; qi++) {
+			end += sprintf(end, " %i,%i",
+					component->multiResourceLevel[qi]->CPUResourceRequested,
+					component->multiResourceLevel[qi]->MemoryResourceRequested);
+		}
+	}
+	strcat(buffer, "\n");
+	strcat(buffer, role_arrow);
+	for(j=0;j<component->name_specific_length;j++){
+		strcat(buffer, component->role_specific[j]);
+		strcat(buffer, ":");
+	}
+	strcat(buffer, "\n");
+}
+
+/** @brief Adds the libraries of a list of directories to the libraries to be registered
+ *
+ * The componentpath contains a single or multiple directories
+ * and is is colon separated like env variables in Linux
+ */
+static void scanComponentsPath(char *componentspath, libraryScanType** list, int* count, int verbose) {
 	int pathconsumed = 0;
 	int currentgiven;
 	int index;
 	char* currentpath = componentspath;
 	char* actual;
-		int err;
-	nameList *allNames = NULL;
-	nameList *currentName = NULL;
-	nameList *tempName = NULL;
-	char* qualityString = NULL;
-	int index_string;
-	/* the componentpath contains a single or multiple directories
-	 * and is is colon separated like env variables in Linux
-	 */
 
-	qualityString = malloc(4096);
-	buffer = malloc(8192);
 	while (!pathconsumed) {
 		index = 0;
 		currentgiven = 0;
@@ -206,158 +457,153 @@ static int buildComponentsList(FILE* omxregistryfp, char *componentspath, int ve
 			}
 			index++;
 		}
-		/* Populate the registry file */
-		dirp = opendir(actual);
 		if (verbose) {
 			printf("\n Scanning directory %s\n", actual);
 		}
-		if(dirp == NULL){
-			free(actual);
+		if (libraryScanDirectory(actual, list, count)) {
 			DEBUG(DEB_LEV_SIMPLE_SEQ, "Cannot open directory %s\n", actual);
+		}
+		free(actual);
+	}
+}
+
+/** @brief Creates a list of components on a registry file
+ *
+ * This function
+ *  - reuses the description of the libraries not changed since the previous
+ *    run, recognized by their size, modification time and build-id
+ *  - loads the other libraries in parallel, and checks if they belong to the
+ *    OpenMAX ST static component loader (they must contain the function
+ *    omx_component_library_Setup for the initialization)
+ *  - write the openmax names and related libraries to the registry file,
+ *    in the order of the directories and of the names of the libraries
+ */
+static int buildComponentsList(FILE* omxregistryfp, FILE* fingerprintsfp, registryCacheBuilder* cache,
+		libraryScanType* libraries, int num_of_scanned, int nthreads, int verbose) {
+	int i, l, num_of_comp;
+	unsigned int j;
+	int num_of_libraries = 0, num_of_unchanged = 0;
+	char *buffer = NULL;
+	stLoaderComponentType **stComponents;
+	int ncomponents = 0, nroles=0;
+	int err;
+	nameList *allNames = NULL;
+	nameList *currentName = NULL;
+	nameList *tempName = NULL;
+	storedLibraryType *stored, **unchanged;
+	char buildId[LIBRARY_SCAN_BUILD_ID_SIZE];
+
+	stored = readFingerprints();
+	unchanged = calloc(num_of_scanned + 1, sizeof(storedLibraryType*));
+	for (l = 0; l < num_of_scanned; l++) {
+		unchanged[l] = findUnchangedLibrary(stored, &libraries[l]);
+		if (unchanged[l] != NULL) {
+			libraries[l].bSkip = 1;
+			num_of_unchanged++;
+		}
+	}
+	libraryScanProbe(libraries, num_of_scanned, sizeof(stLoaderComponentType), nthreads);
+
+	buffer = malloc(8192);
+	for (l = 0; l < num_of_scanned; l++) {
+		if (libraries[l].bSkip) {
+			stComponents = unchanged[l]->stComponents;
+			num_of_comp = unchanged[l]->num_of_comp;
+			strcpy(buildId, unchanged[l]->buildId);
+			if (verbose) {
+				printf("\n Library %s not changed\n", libraries[l].path);
+			}
+		} else if (libraries[l].nComponents >= 0) {
+			stComponents = (stLoaderComponentType **)libraries[l].components;
+			num_of_comp = libraries[l].nComponents;
+			libraryScanBuildId(libraries[l].path, buildId);
+			if (verbose) {
+				printf("\n Scanning library %s\n", libraries[l].path);
+			}
+		} else {
 			continue;
 		}
-		while((dp = readdir(dirp)) != NULL) {
-			int len = strlen(dp->d_name);
-
-			if(len >= 3){
-
-
-				if(strncmp(dp->d_name+len-3, ".so", 3) == 0){
-					char lib_absolute_path[strlen(actual) + len + 1];
-
-					strcpy(lib_absolute_path, actual);
-					strcat(lib_absolute_path, dp->d_name);
-
-					if((handle = dlopen(lib_absolute_path, RTLD_NOW)) == NULL) {
-						DEBUG(DEB_LEV_ERR, "could not load %s: %s\n", lib_absolute_path, dlerror());
-					} else {
-						if (verbose) {
-							printf("\n Scanning library %s\n", lib_absolute_path);
-						}
-						if ((fptr = dlsym(handle, "omx_component_library_Setup")) == NULL) {
-							DEBUG(DEB_LEV_SIMPLE_SEQ, "the library %s is not compatible with ST static component loader - %s\n", lib_absolute_path, dlerror());
-							continue;
-						}
-						num_of_libraries++;
-						num_of_comp = fptr(NULL);
-						stComponents = malloc(num_of_comp * sizeof(stLoaderComponentType*));
-						for (i = 0; i<num_of_comp; i++) {
-							stComponents[i] = calloc(1,sizeof(stLoaderComponentType));
-							stComponents[i]->nqualitylevels = 0;
-							stComponents[i]->multiResourceLevel = NULL;
-						}
-						fptr(stComponents);
-						err = fwrite(lib_absolute_path, 1, strlen(lib_absolute_path), omxregistryfp);
-						err = fwrite("\n", 1, 1, omxregistryfp);
-
-
-						for (i = 0; i<num_of_comp; i++) {
-							tempName = allNames;
-							if (tempName != NULL) {
-								do  {
-									if (!strcmp(tempName->name, stComponents[i]->name)) {
-										DEBUG(DEB_LEV_ERR, "Component %s already registered. Skip\n", stComponents[i]->name);
-										break;
-									}
-									tempName = tempName->next;
-								} while(tempName != NULL);
-								if (tempName != NULL) {
-									continue;
-								}
-							}
-							if (allNames == NULL) {
-								allNames = malloc(sizeof(nameList));
-								currentName = allNames;
-							} else {
-								currentName->next = malloc(sizeof(nameList));
-								currentName = currentName->next;
-							}
-							currentName->next = NULL;
-							currentName->name = malloc(strlen(stComponents[i]->name) + 1);
-							strcpy(currentName->name, stComponents[i]->name);
-							*(currentName->name + strlen(currentName->name)) = '\0';
-
-							DEBUG(DEB_LEV_PARAMS, "Found component %s version=%d.%d.%d.%d in shared object %s\n",
-								stComponents[i]->name,
-								stComponents[i]->componentVersion.s.nVersionMajor,
-								stComponents[i]->componentVersion.s.nVersionMinor,
-								stComponents[i]->componentVersion.s.nRevision,
-								stComponents[i]->componentVersion.s.nStep,
-								lib_absolute_path);
-							if (verbose) {
-								printf("Component %s registered with %i quality levels\n", stComponents[i]->name, (int)stComponents[i]->nqualitylevels);
-							}
-							if (stComponents[i]->nqualitylevels > 0) {
-								index_string = 0;
-								sprintf((qualityString + index_string), "%i ", (int)stComponents[i]->nqualitylevels);
-								index_string = index_string + int2strlen(stComponents[i]->nqualitylevels) + 1;
-								for (qi=0; qi<stComponents[i]->nqualitylevels; qi++) {
-									sprintf((qualityString + index_string), "%i,%i ",
-											stComponents[i]->multiResourceLevel[qi]->CPUResourceRequested,
-											stComponents[i]->multiResourceLevel[qi]->MemoryResourceRequested);
-									index_string = index_string + 2 +
-										int2strlen(stComponents[i]->multiResourceLevel[qi]->CPUResourceRequested) +
-										int2strlen(stComponents[i]->multiResourceLevel[qi]->MemoryResourceRequested);
-								}
-								index_string--;
-								*(qualityString + index_string) = '\0';
-							}
-							// insert first of all the name of the library
-							strcpy(buffer, arrow);
-							strcat(buffer, stComponents[i]->name);
-							if (stComponents[i]->name_specific_length>0) {
-								nroles += stComponents[i]->name_specific_length;
-								strcat(buffer, arrow);
-								for(j=0;j<stComponents[i]->name_specific_length;j++){
-									if (verbose) {
-										printf("  Specific role %s registered\n", stComponents[i]->name_specific[j]);
-									}
-									strcat(buffer, stComponents[i]->name_specific[j]);
-									strcat(buffer, ":");
-								}
-							}
-
-							if ((qualityString != NULL) && (qualityString[0] != '\0')) {
-								strcat(buffer, arrow);
-								strcat(buffer, qualityString);
-							}
-							qualityString[0] = '\0';
-							strcat(buffer, "\n");
-							err = fwrite(buffer, 1, strlen(buffer), omxregistryfp);
-							ncomponents++;
-						}
-						for (i = 0; i < num_of_comp; i++) {
-							free(stComponents[i]->name);
-							for (k=0; k<stComponents[i]->name_specific_length; k++) {
-								free(stComponents[i]->name_specific[k]);
-								free(stComponents[i]->role_specific[k]);
-							}
-							if (stComponents[i]->name_specific_length > 0) {
-								free(stComponents[i]->name_specific);
-								free(stComponents[i]->role_specific);
-							}
-							for (k=0; k<stComponents[i]->nqualitylevels; k++) {
-								free(stComponents[i]->multiResourceLevel[k]);
-							}
-							if (stComponents[i]->multiResourceLevel) {
-								free(stComponents[i]->multiResourceLevel);
-							}
-							free(stComponents[i]);
-						}
-						free(stComponents);
+		num_of_libraries++;
+		err = fwrite(libraries[l].path, 1, strlen(libraries[l].path), omxregistryfp);
+		err = fwrite("\n", 1, 1, omxregistryfp);
+		if (fingerprintsfp) {
+			fprintf(fingerprintsfp, "%s\t%lld\t%lld\t%lld\t%s\n", libraries[l].path,
+					(long long)libraries[l].nSize, (long long)libraries[l].nMtimeSec,
+					(long long)libraries[l].nMtimeNsec, buildId);
+		}
+		if (cache) {
+			registryCacheAddLibrary(cache, libraries[l].path);
+		}
+
+		for (i = 0; i<num_of_comp; i++) {
+			/* the whole description of the library is kept, to be reused as it is */
+			formatComponent(buffer, stComponents[i]);
+			if (fingerprintsfp) {
+				fputs(buffer, fingerprintsfp);
+			}
+			tempName = allNames;
+			if (tempName != NULL) {
+				do  {
+					if (!strcmp(tempName->name, stComponents[i]->name)) {
+						DEBUG(DEB_LEV_ERR, "Component %s already registered. Skip\n", stComponents[i]->name);
+						break;
 					}
+					tempName = tempName->next;
+				} while(tempName != NULL);
+				if (tempName != NULL) {
+					continue;
+				}
+			}
+			if (allNames == NULL) {
+				allNames = malloc(sizeof(nameList));
+				currentName = allNames;
+			} else {
+				currentName->next = malloc(sizeof(nameList));
+				currentName = currentName->next;
+			}
+			currentName->next = NULL;
+			currentName->name = malloc(strlen(stComponents[i]->name) + 1);
+			strcpy(currentName->name, stComponents[i]->name);
+			*(currentName->name + strlen(currentName->name)) = '\0';
+
+			DEBUG(DEB_LEV_PARAMS, "Found component %s version=%d.%d.%d.%d in shared object %s\n",
+				stComponents[i]->name,
+				stComponents[i]->componentVersion.s.nVersionMajor,
+				stComponents[i]->componentVersion.s.nVersionMinor,
+				stComponents[i]->componentVersion.s.nRevision,
+				stComponents[i]->componentVersion.s.nStep,
+				libraries[l].path);
+			if (verbose) {
+				printf("Component %s registered with %i quality levels\n", stComponents[i]->name, (int)stComponents[i]->nqualitylevels);
+				for (j = 0; j < stComponents[i]->name_specific_length; j++) {
+					printf("  Specific role %s registered\n", stComponents[i]->name_specific[j]);
 				}
 			}
+			nroles += stComponents[i]->name_specific_length;
+			err = fwrite(buffer, 1, strlen(buffer), omxregistryfp);
+			if (cache) {
+				registryCacheAddComponent(cache, stComponents[i]);
+			}
+			ncomponents++;
+		}
+		if (!libraries[l].bSkip) {
+			freeComponents(stComponents, num_of_comp);
+			libraries[l].components = NULL;
 		}
-		free(actual);
-		closedir(dirp);
 	}
 	if (verbose) {
-		printf("\n %i OpenMAX IL ST static components in %i libraries succesfully scanned\n", ncomponents, num_of_libraries);
+		printf("\n %i OpenMAX IL ST static components in %i libraries succesfully scanned, %i not changed\n", ncomponents, num_of_libraries, num_of_unchanged);
 	} else {
 		DEBUG(DEB_LEV_SIMPLE_SEQ, "\n %i OpenMAX IL ST static components with %i roles in %i libraries succesfully scanned\n", ncomponents, nroles, num_of_libraries);
 	}
-	free(qualityString);
+	while (allNames != NULL) {
+		tempName = allNames->next;
+		free(allNames->name);
+		free(allNames);
+		allNames = tempName;
+	}
+	free(unchanged);
+	freeFingerprints(stored);
 	free(buffer);
 	return 0;
 }
@@ -367,14 +613,17 @@ static void usage(const char *app) {
 	registry_filename = componentsRegistryGetFilename();
 
 	printf(
-      "Usage: %s [-l] [-v] [-h] [componentspath[:other_components_path]]...\n"
+      "Usage: %s [-l] [-v] [-f] [-jN] [-h] [componentspath[:other_components_path]]...\n"
 	  "\n"
 	  "Version 0.9.2\n"
 	  "\n"
       "This programs scans for a given list of directory searching for any OpenMAX\n"
       "component compatible with the ST static component loader.\n"
 			"The registry is saved under %s. (can be changed via OMX_BELLAGIO_REGISTRY\n"
-			"environment variable)\n"
+			"environment variable), together with a binary index of it in the same\n"
+			"directory, that the loaders read when it is up to date, and with the\n"
+			"fingerprints of the libraries, so that the libraries not changed are\n"
+			"not loaded again by the next registration.\n"
       "\n"
       "The following options are supported:\n"
       "\n"
@@ -382,6 +631,10 @@ static void usage(const char *app) {
       "        -l   list only the components already registered. If -l is specified \n"
       "             all the other parameters are ignored and only the register file\n"
       "             is checked\n"
+      "        -f   load again all the libraries, even those not changed since\n"
+      "             the previous registration\n"
+      "        -jN  load up to N libraries at the same time, the default depends\n"
+      "             on the number of processors\n"
       "        -h   display this message\n"
       "\n"
       "         componentspath: a searching path for components can be specified.\n"
@@ -401,13 +654,21 @@ static void usage(const char *app) {
  */
 int main(int argc, char *argv[]) {
 	int found;
-	int err, i;
+	int err, i, fd;
 	int verbose=0;
+	int nthreads=0;
+	int force=0;
 	FILE *omxregistryfp;
+	FILE *fingerprintsfp = NULL;
 	char *registry_filename;
+	char *fingerprints_filename;
+	char *fingerprints_temp = NULL;
 	char *dir,*dirp;
 	char *buffer;
 	int isListOnly = 0;
+	registryCacheBuilder* cache;
+	libraryScanType* libraries = NULL;
+	int num_of_scanned = 0;
 
 	for(i = 1; i < argc; i++) {
 		if(*(argv[i]) != '-') {
@@ -417,6 +678,10 @@ int main(int argc, char *argv[]) {
 			verbose = 1;
 		} else if (*(argv[i]+1) == 'l') {
 			isListOnly = 1;
+		} else if (*(argv[i]+1) == 'f') {
+			force = 1;
+		} else if ((*(argv[i]+1) == 'j') && (atoi(argv[i]+2) > 0)) {
+			nthreads = atoi(argv[i]+2);
 		} else {
 			usage(argv[0]);
 			exit(*(argv[i]+1) == 'h' ? 0 : -EINVAL);
@@ -465,29 +730,59 @@ int main(int argc, char *argv[]) {
 		}
 
 		found = 1;
-		err = buildComponentsList(omxregistryfp, argv[i], verbose);
-		if(err) {
-			DEBUG(DEB_LEV_ERR, "Error registering OpenMAX components with ST static component loader %s\n", strerror(err));
-			continue;
-		}
+		scanComponentsPath(argv[i], &libraries, &num_of_scanned, verbose);
 	}
 
 	if (found == 0) {
 		buffer=getenv("BELLAGIO_SEARCH_PATH");
 		if (buffer!=NULL&&*buffer!='\0') {
-			err = buildComponentsList(omxregistryfp, buffer, verbose);
-			if(err) {
-				DEBUG(DEB_LEV_ERR, "Error registering OpenMAX components with ST static component loader %s\n", strerror(err));
-			}
+			scanComponentsPath(buffer, &libraries, &num_of_scanned, verbose);
 		} else {
-			err = buildComponentsList(omxregistryfp, OMXILCOMPONENTSPATH, verbose);
-			if(err) {
-				DEBUG(DEB_LEV_ERR, "Error registering OpenMAX components with ST static component loader %s\n", strerror(err));
+			scanComponentsPath(OMXILCOMPONENTSPATH, &libraries, &num_of_scanned, verbose);
+		}
+	}
+
+	/* the fingerprints are written aside, and replace the previous ones at the end */
+	fingerprints_filename = fingerprintsGetFilename();
+	if (fingerprints_filename != NULL) {
+		if (force) {
+			unlink(fingerprints_filename);
+		}
+		fingerprints_temp = malloc(strlen(fingerprints_filename) + 8);
+		if (fingerprints_temp != NULL) {
+			strcpy(fingerprints_temp, fingerprints_filename);
+			strcat(fingerprints_temp, ".XXXXXX");
+			fd = mkstemp(fingerprints_temp);
+			if (fd >= 0) {
+				fingerprintsfp = fdopen(fd, "w");
 			}
 		}
 	}
 
+	cache = registryCacheBuilderCreate();
+	err = buildComponentsList(omxregistryfp, fingerprintsfp, cache, libraries, num_of_scanned, nthreads, verbose);
+	if(err) {
+		DEBUG(DEB_LEV_ERR, "Error registering OpenMAX components with ST static component loader %s\n", strerror(err));
+	}
+	libraryScanFree(libraries, num_of_scanned);
+
 	fclose(omxregistryfp);
 
+	/* the binary index refers to the registry just closed */
+	if (cache) {
+		registryCacheWrite(cache);
+		registryCacheBuilderDestroy(cache);
+	}
+
+	if (fingerprintsfp != NULL) {
+		fchmod(fileno(fingerprintsfp), 0644);
+		if ((fclose(fingerprintsfp) != 0) || (rename(fingerprints_temp, fingerprints_filename) != 0)) {
+			DEBUG(DEB_LEV_ERR, "Cannot write the fingerprints file %s\n", fingerprints_filename);
+			unlink(fingerprints_temp);
+		}
+	}
+	free(fingerprints_temp);
+	free(fingerprints_filename);
+
 	return 0;
 }
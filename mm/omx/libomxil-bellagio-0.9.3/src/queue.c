@@ -134,6 +134,30 @@ void* dequeue(queue_t* queue) {
   return data;
 }
 
+/** Dequeue up to nmax elements from the given queue descriptor
+ * holding the queue lock only once
+ *
+ * @param queue the queue descriptor from which to dequeue the elements
+ *
+ * @param data the array filled with the dequeued elements, in queue order
+ *
+ * @param nmax the size of the data array
+ *
+ * @return the number of elements that have been dequeued
+ */
+int dequeue_n(queue_t* queue, void** data, int nmax) {
+  int n = 0;
+  pthread_mutex_lock(&queue->mutex);
+  while (n < nmax && queue->first->data != NULL) {
+    data[n++] = queue->first->data;
+    queue->first->data = NULL;
+    queue->first = queue->first->q_forw;
+  }
+  queue->nelem -= n;
+  pthread_mutex_unlock(&queue->mutex);
+  return n;
+}
+
 /** Returns the number of elements hold in the queue
  *
  * @param queue the requested queue
@@ -82,6 +82,19 @@ int queue(queue_t* queue, void* data);
  */
 void* dequeue(queue_t* queue);
 
+/** Dequeue up to nmax elements from the given queue descriptor
+ * holding the queue lock only once
+ *
+ * @param queue the queue descriptor from which to dequeue the elements
+ *
+ * @param data the array filled with the dequeued elements, in queue order
+ *
+ * @param nmax the size of the data array
+ *
+ * @return the number of elements that have been dequeued
+ */
+int dequeue_n(queue_t* queue, void** data, int nmax);
+
 /** Returns the number of elements hold in the queue
  *
  * @param queue the requested queue
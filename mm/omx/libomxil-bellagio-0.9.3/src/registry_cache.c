@@ -0,0 +1,505 @@
+/**
+  src/registry_cache.c
+
+  Binary index of the components registry. It is written by omxregister
+  next to the text registry, and mapped read-only by the loaders, that
+  query it in place without parsing the text registry.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "common.h"
+#include "registry_cache.h"
+#include "name_index.h"
+
+/** Checks that an array of the file lies inside the file */
+static int registryCacheCheckArray(const registryCacheHeader* header, uint32_t nOffset, uint32_t nItems, size_t nItemSize) {
+  return ((nOffset % sizeof(uint32_t)) == 0) &&
+         ((uint64_t)nOffset + (uint64_t)nItems * nItemSize <= header->nSize);
+}
+
+/** Checks the consistency of all the indexes and offsets of the file,
+ * so that the users of the mapping can follow them without any check
+ */
+static int registryCacheCheck(const registryCache* cache) {
+  const registryCacheHeader* header = cache->pHeader;
+  const registryCacheComponent* component;
+  const registryCacheEntry* entry;
+  uint32_t i;
+
+  if (!registryCacheCheckArray(header, header->nLibrariesOffset, header->nLibraries, sizeof(uint32_t)) ||
+      !registryCacheCheckArray(header, header->nComponentsOffset, header->nComponents, sizeof(registryCacheComponent)) ||
+      !registryCacheCheckArray(header, header->nSpecificsOffset, header->nSpecifics, sizeof(registryCacheSpecific)) ||
+      !registryCacheCheckArray(header, header->nQualityLevelsOffset, header->nQualityLevels, sizeof(registryCacheQuality)) ||
+      !registryCacheCheckArray(header, header->nBucketsOffset, header->nBuckets, sizeof(registryCacheEntry)) ||
+      ((uint64_t)header->nStringsOffset + header->nStringsSize > header->nSize)) {
+    return 0;
+  }
+  if ((header->nStringsSize == 0) || (cache->pStrings[header->nStringsSize - 1] != '\0')) {
+    return 0;
+  }
+  if ((header->nBuckets == 0) || (header->nBuckets & (header->nBuckets - 1))) {
+    return 0;
+  }
+  for (i = 0; i < header->nLibraries; i++) {
+    if (cache->pLibraries[i] >= header->nStringsSize) {
+      return 0;
+    }
+  }
+  for (i = 0; i < header->nComponents; i++) {
+    component = &cache->pComponents[i];
+    if ((component->nName >= header->nStringsSize) ||
+        (component->nLibrary >= header->nLibraries) ||
+        ((uint64_t)component->nFirstSpecific + component->nSpecifics > header->nSpecifics) ||
+        ((uint64_t)component->nFirstQualityLevel + component->nQualityLevels > header->nQualityLevels)) {
+      return 0;
+    }
+  }
+  for (i = 0; i < header->nSpecifics; i++) {
+    if ((cache->pSpecifics[i].nName >= header->nStringsSize) ||
+        (cache->pSpecifics[i].nRole >= header->nStringsSize)) {
+      return 0;
+    }
+  }
+  for (i = 0; i < header->nBuckets; i++) {
+    entry = &cache->pBuckets[i];
+    if (entry->nComponent == REGISTRY_CACHE_NONE) {
+      continue;
+    }
+    if ((entry->nComponent >= header->nComponents) ||
+        (entry->nName >= header->nStringsSize) ||
+        ((entry->nSpecific != REGISTRY_CACHE_NONE) && (entry->nSpecific >= header->nSpecifics))) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+char* registryCacheGetFilename(void) {
+  char* registry_filename;
+  char* cache_filename;
+
+  registry_filename = componentsRegistryGetFilename();
+  if (registry_filename == NULL) {
+    return NULL;
+  }
+  cache_filename = malloc(strlen(registry_filename) + strlen(REGISTRY_CACHE_EXTENSION) + 1);
+  if (cache_filename != NULL) {
+    strcpy(cache_filename, registry_filename);
+    strcat(cache_filename, REGISTRY_CACHE_EXTENSION);
+  }
+  free(registry_filename);
+  return cache_filename;
+}
+
+registryCache* registryCacheOpen(void) {
+  registryCache* cache;
+  const registryCacheHeader* header;
+  char* registry_filename;
+  char* cache_filename;
+  struct stat registry_stat;
+  struct stat cache_stat;
+  void* data;
+  int fd;
+  int err;
+
+  registry_filename = componentsRegistryGetFilename();
+  if (registry_filename == NULL) {
+    return NULL;
+  }
+  err = stat(registry_filename, &registry_stat);
+  free(registry_filename);
+  if (err != 0) {
+    return NULL;
+  }
+
+  cache_filename = registryCacheGetFilename();
+  if (cache_filename == NULL) {
+    return NULL;
+  }
+  fd = open(cache_filename, O_RDONLY);
+  free(cache_filename);
+  if (fd < 0) {
+    return NULL;
+  }
+  if ((fstat(fd, &cache_stat) != 0) || (cache_stat.st_size < (off_t)sizeof(registryCacheHeader))) {
+    close(fd);
+    return NULL;
+  }
+  data = mmap(NULL, cache_stat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return NULL;
+  }
+
+  header = data;
+  if ((header->nMagic != REGISTRY_CACHE_MAGIC) ||
+      (header->nVersion != REGISTRY_CACHE_VERSION) ||
+      (header->nSize != (uint64_t)cache_stat.st_size)) {
+    DEBUG(DEB_LEV_ERR, "In %s the binary registry is not valid\n", __func__);
+    munmap(data, cache_stat.st_size);
+    return NULL;
+  }
+  if ((header->nRegistrySize != (uint64_t)registry_stat.st_size) ||
+      (header->nRegistryMtimeSec != (int64_t)registry_stat.st_mtim.tv_sec) ||
+      (header->nRegistryMtimeNsec != (int64_t)registry_stat.st_mtim.tv_nsec)) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the binary registry is older than the registry\n", __func__);
+    munmap(data, cache_stat.st_size);
+    return NULL;
+  }
+
+  cache = calloc(1, sizeof(registryCache));
+  if (cache == NULL) {
+    munmap(data, cache_stat.st_size);
+    return NULL;
+  }
+  cache->pData = data;
+  cache->nSize = cache_stat.st_size;
+  cache->pHeader = header;
+  cache->pLibraries = (const uint32_t*)((const char*)data + header->nLibrariesOffset);
+  cache->pComponents = (const registryCacheComponent*)((const char*)data + header->nComponentsOffset);
+  cache->pSpecifics = (const registryCacheSpecific*)((const char*)data + header->nSpecificsOffset);
+  cache->pQualityLevels = (const registryCacheQuality*)((const char*)data + header->nQualityLevelsOffset);
+  cache->pBuckets = (const registryCacheEntry*)((const char*)data + header->nBucketsOffset);
+  cache->pStrings = (const char*)data + header->nStringsOffset;
+  if (!registryCacheCheck(cache)) {
+    DEBUG(DEB_LEV_ERR, "In %s the binary registry is corrupted\n", __func__);
+    registryCacheClose(cache);
+    return NULL;
+  }
+  return cache;
+}
+
+void registryCacheClose(registryCache* cache) {
+  if (cache == NULL) {
+    return;
+  }
+  munmap(cache->pData, cache->nSize);
+  free(cache);
+}
+
+const char* registryCacheString(const registryCache* cache, uint32_t nOffset) {
+  return cache->pStrings + nOffset;
+}
+
+int registryCacheContains(const registryCache* cache, const void* pointer) {
+  if (cache == NULL) {
+    return 0;
+  }
+  return ((const char*)pointer >= (const char*)cache->pData) &&
+         ((const char*)pointer < (const char*)cache->pData + cache->nSize);
+}
+
+int registryCacheFind(const registryCache* cache, const char* name, uint32_t* pSpecific) {
+  const registryCacheEntry* entry;
+  uint32_t hash;
+  uint32_t mask;
+  uint32_t i, n;
+
+  hash = name_index_hash(name);
+  mask = cache->pHeader->nBuckets - 1;
+  for (i = hash & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+    entry = &cache->pBuckets[i];
+    if (entry->nComponent == REGISTRY_CACHE_NONE) {
+      break;
+    }
+    if ((entry->nHash == hash) && !strcmp(cache->pStrings + entry->nName, name)) {
+      if (pSpecific != NULL) {
+        *pSpecific = entry->nSpecific;
+      }
+      return entry->nComponent;
+    }
+  }
+  return -1;
+}
+
+registryCacheBuilder* registryCacheBuilderCreate(void) {
+  registryCacheBuilder* builder;
+
+  builder = calloc(1, sizeof(registryCacheBuilder));
+  if (builder == NULL) {
+    return NULL;
+  }
+  builder->nStringsAllocated = 4096;
+  builder->pStrings = malloc(builder->nStringsAllocated);
+  if (builder->pStrings == NULL) {
+    free(builder);
+    return NULL;
+  }
+  /* the offset 0 is the empty string */
+  builder->pStrings[0] = '\0';
+  builder->nStringsSize = 1;
+  return builder;
+}
+
+/** Appends a string to the string table, and returns its offset */
+static uint32_t registryCacheAddString(registryCacheBuilder* builder, const char* string) {
+  uint32_t length;
+  uint32_t offset;
+  char* strings;
+
+  if ((string == NULL) || (*string == '\0')) {
+    return 0;
+  }
+  length = strlen(string) + 1;
+  if (builder->nStringsSize + length > builder->nStringsAllocated) {
+    strings = realloc(builder->pStrings, (builder->nStringsAllocated + length) * 2);
+    if (strings == NULL) {
+      return REGISTRY_CACHE_NONE;
+    }
+    builder->pStrings = strings;
+    builder->nStringsAllocated = (builder->nStringsAllocated + length) * 2;
+  }
+  offset = builder->nStringsSize;
+  memcpy(builder->pStrings + offset, string, length);
+  builder->nStringsSize += length;
+  return offset;
+}
+
+int registryCacheAddLibrary(registryCacheBuilder* builder, const char* libname) {
+  uint32_t* libraries;
+
+  libraries = realloc(builder->pLibraries, (builder->nLibraries + 1) * sizeof(uint32_t));
+  if (libraries == NULL) {
+    return -1;
+  }
+  builder->pLibraries = libraries;
+  builder->pLibraries[builder->nLibraries] = registryCacheAddString(builder, libname);
+  if (builder->pLibraries[builder->nLibraries] == REGISTRY_CACHE_NONE) {
+    return -1;
+  }
+  return builder->nLibraries++;
+}
+
+int registryCacheAddComponent(registryCacheBuilder* builder, stLoaderComponentType* component) {
+  registryCacheComponent* components;
+  registryCacheSpecific* specifics;
+  registryCacheQuality* qualityLevels;
+  registryCacheComponent* added;
+  unsigned int i;
+
+  if (builder->nLibraries == 0) {
+    return -1;
+  }
+  components = realloc(builder->pComponents, (builder->nComponents + 1) * sizeof(registryCacheComponent));
+  if (components == NULL) {
+    return -1;
+  }
+  builder->pComponents = components;
+  specifics = realloc(builder->pSpecifics, (builder->nSpecifics + component->name_specific_length + 1) * sizeof(registryCacheSpecific));
+  if (specifics == NULL) {
+    return -1;
+  }
+  builder->pSpecifics = specifics;
+  qualityLevels = realloc(builder->pQualityLevels, (builder->nQualityLevels + component->nqualitylevels + 1) * sizeof(registryCacheQuality));
+  if (qualityLevels == NULL) {
+    return -1;
+  }
+  builder->pQualityLevels = qualityLevels;
+
+  added = &builder->pComponents[builder->nComponents];
+  added->nName = registryCacheAddString(builder, component->name);
+  added->nLibrary = builder->nLibraries - 1;
+  added->nFirstSpecific = builder->nSpecifics;
+  added->nSpecifics = component->name_specific_length;
+  added->nFirstQualityLevel = builder->nQualityLevels;
+  added->nQualityLevels = component->nqualitylevels;
+  if (added->nName == REGISTRY_CACHE_NONE) {
+    return -1;
+  }
+  for (i = 0; i < component->name_specific_length; i++) {
+    specifics = &builder->pSpecifics[builder->nSpecifics + i];
+    specifics->nName = registryCacheAddString(builder, component->name_specific[i]);
+    specifics->nRole = registryCacheAddString(builder, component->role_specific[i]);
+    if ((specifics->nName == REGISTRY_CACHE_NONE) || (specifics->nRole == REGISTRY_CACHE_NONE)) {
+      return -1;
+    }
+  }
+  for (i = 0; i < component->nqualitylevels; i++) {
+    builder->pQualityLevels[builder->nQualityLevels + i].nCPU = component->multiResourceLevel[i]->CPUResourceRequested;
+    builder->pQualityLevels[builder->nQualityLevels + i].nMemory = component->multiResourceLevel[i]->MemoryResourceRequested;
+  }
+  builder->nSpecifics += component->name_specific_length;
+  builder->nQualityLevels += component->nqualitylevels;
+  return builder->nComponents++;
+}
+
+/** Inserts a name in the hash table, unless a previous component has the same name */
+static void registryCacheInsert(registryCacheEntry* buckets, uint32_t nBuckets, const char* strings,
+                                uint32_t nName, uint32_t nComponent, uint32_t nSpecific) {
+  uint32_t hash;
+  uint32_t i;
+
+  hash = name_index_hash(strings + nName);
+  for (i = hash & (nBuckets - 1); buckets[i].nComponent != REGISTRY_CACHE_NONE; i = (i + 1) & (nBuckets - 1)) {
+    if ((buckets[i].nHash == hash) && !strcmp(strings + buckets[i].nName, strings + nName)) {
+      return;
+    }
+  }
+  buckets[i].nHash = hash;
+  buckets[i].nName = nName;
+  buckets[i].nComponent = nComponent;
+  buckets[i].nSpecific = nSpecific;
+}
+
+int registryCacheWrite(registryCacheBuilder* builder) {
+  registryCacheHeader* header;
+  registryCacheEntry* buckets;
+  char* registry_filename;
+  char* cache_filename;
+  char* temp_filename;
+  struct stat registry_stat;
+  char* data;
+  uint32_t nBuckets;
+  uint32_t offset;
+  uint32_t i, j;
+  int fd;
+  int err;
+
+  registry_filename = componentsRegistryGetFilename();
+  if (registry_filename == NULL) {
+    return -1;
+  }
+  err = stat(registry_filename, &registry_stat);
+  free(registry_filename);
+  if (err != 0) {
+    return -1;
+  }
+
+  /* at most half of the buckets are used, to keep the probes short */
+  nBuckets = 8;
+  while (nBuckets < 2 * (builder->nComponents + builder->nSpecifics)) {
+    nBuckets *= 2;
+  }
+
+  header = calloc(1, sizeof(registryCacheHeader));
+  if (header == NULL) {
+    return -1;
+  }
+  header->nMagic = REGISTRY_CACHE_MAGIC;
+  header->nVersion = REGISTRY_CACHE_VERSION;
+  header->nRegistrySize = registry_stat.st_size;
+  header->nRegistryMtimeSec = registry_stat.st_mtim.tv_sec;
+  header->nRegistryMtimeNsec = registry_stat.st_mtim.tv_nsec;
+  header->nLibraries = builder->nLibraries;
+  header->nComponents = builder->nComponents;
+  header->nSpecifics = builder->nSpecifics;
+  header->nQualityLevels = builder->nQualityLevels;
+  header->nBuckets = nBuckets;
+  header->nStringsSize = builder->nStringsSize;
+  offset = sizeof(registryCacheHeader);
+  header->nLibrariesOffset = offset;
+  offset += builder->nLibraries * sizeof(uint32_t);
+  header->nComponentsOffset = offset;
+  offset += builder->nComponents * sizeof(registryCacheComponent);
+  header->nSpecificsOffset = offset;
+  offset += builder->nSpecifics * sizeof(registryCacheSpecific);
+  header->nQualityLevelsOffset = offset;
+  offset += builder->nQualityLevels * sizeof(registryCacheQuality);
+  header->nBucketsOffset = offset;
+  offset += nBuckets * sizeof(registryCacheEntry);
+  header->nStringsOffset = offset;
+  offset += builder->nStringsSize;
+  header->nSize = offset;
+
+  data = calloc(1, header->nSize);
+  if (data == NULL) {
+    free(header);
+    return -1;
+  }
+  memcpy(data, header, sizeof(registryCacheHeader));
+  memcpy(data + header->nLibrariesOffset, builder->pLibraries, builder->nLibraries * sizeof(uint32_t));
+  memcpy(data + header->nComponentsOffset, builder->pComponents, builder->nComponents * sizeof(registryCacheComponent));
+  memcpy(data + header->nSpecificsOffset, builder->pSpecifics, builder->nSpecifics * sizeof(registryCacheSpecific));
+  memcpy(data + header->nQualityLevelsOffset, builder->pQualityLevels, builder->nQualityLevels * sizeof(registryCacheQuality));
+  memcpy(data + header->nStringsOffset, builder->pStrings, builder->nStringsSize);
+
+  buckets = (registryCacheEntry*)(data + header->nBucketsOffset);
+  for (i = 0; i < nBuckets; i++) {
+    buckets[i].nComponent = REGISTRY_CACHE_NONE;
+  }
+  for (i = 0; i < builder->nComponents; i++) {
+    registryCacheInsert(buckets, nBuckets, builder->pStrings, builder->pComponents[i].nName, i, REGISTRY_CACHE_NONE);
+    for (j = 0; j < builder->pComponents[i].nSpecifics; j++) {
+      registryCacheInsert(buckets, nBuckets, builder->pStrings,
+          builder->pSpecifics[builder->pComponents[i].nFirstSpecific + j].nName, i, builder->pComponents[i].nFirstSpecific + j);
+    }
+  }
+
+  cache_filename = registryCacheGetFilename();
+  temp_filename = (cache_filename != NULL) ? malloc(strlen(cache_filename) + 8) : NULL;
+  if (temp_filename == NULL) {
+    DEBUG(DEB_LEV_ERR, "In %s cannot allocate the name of the binary registry\n", __func__);
+    free(cache_filename);
+    free(data);
+    free(header);
+    return -1;
+  }
+  strcpy(temp_filename, cache_filename);
+  strcat(temp_filename, ".XXXXXX");
+  err = -1;
+  fd = mkstemp(temp_filename);
+  if (fd >= 0) {
+    if (write(fd, data, header->nSize) == (ssize_t)header->nSize) {
+      err = 0;
+    }
+    fchmod(fd, 0644);
+    close(fd);
+    if (err == 0) {
+      err = rename(temp_filename, cache_filename);
+    }
+    if (err != 0) {
+      unlink(temp_filename);
+    }
+  }
+  if (err != 0) {
+    DEBUG(DEB_LEV_ERR, "Cannot write the binary registry %s\n", cache_filename);
+  }
+  free(temp_filename);
+  free(cache_filename);
+  free(data);
+  free(header);
+  return err;
+}
+
+void registryCacheBuilderDestroy(registryCacheBuilder* builder) {
+  if (builder == NULL) {
+    return;
+  }
+  free(builder->pLibraries);
+  free(builder->pComponents);
+  free(builder->pSpecifics);
+  free(builder->pQualityLevels);
+  free(builder->pStrings);
+  free(builder);
+}
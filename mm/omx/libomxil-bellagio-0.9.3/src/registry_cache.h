@@ -0,0 +1,184 @@
+/**
+  src/registry_cache.h
+
+  Binary index of the components registry. It is written by omxregister
+  next to the text registry, and mapped read-only by the loaders, that
+  query it in place without parsing the text registry.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __REGISTRY_CACHE_H__
+#define __REGISTRY_CACHE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "st_static_component_loader.h"
+
+/** The extension added to the name of the text registry for its binary index */
+#define REGISTRY_CACHE_EXTENSION ".cache"
+
+/** "OMXR" on a little endian host, the file is in the byte order of the host */
+#define REGISTRY_CACHE_MAGIC 0x52584d4f
+/** Incremented at any change of the layout of the file */
+#define REGISTRY_CACHE_VERSION 1
+/** Marks an empty hash bucket, or a general name in a name entry */
+#define REGISTRY_CACHE_NONE 0xffffffff
+
+/** @brief Header of the binary registry
+ *
+ * All the offsets are in bytes from the beginning of the file. The strings
+ * are referenced by their offset in the string table. The size and the
+ * modification time of the text registry are stored to detect a stale index.
+ */
+typedef struct registryCacheHeader {
+  uint32_t nMagic;
+  uint32_t nVersion;
+  uint32_t nSize; /**< size of the whole file */
+  uint32_t nRegistrySize; /**< size of the text registry described */
+  int64_t nRegistryMtimeSec; /**< modification time of the text registry, seconds */
+  int64_t nRegistryMtimeNsec; /**< modification time of the text registry, nanoseconds */
+  uint32_t nLibraries; /**< number of libraries */
+  uint32_t nComponents; /**< number of components */
+  uint32_t nSpecifics; /**< number of specific names, of all the components */
+  uint32_t nQualityLevels; /**< number of quality levels, of all the components */
+  uint32_t nBuckets; /**< size of the hash table of the names, a power of 2 */
+  uint32_t nStringsSize; /**< size of the string table */
+  uint32_t nLibrariesOffset; /**< array of nLibraries string offsets with the library paths */
+  uint32_t nComponentsOffset; /**< array of nComponents registryCacheComponent */
+  uint32_t nSpecificsOffset; /**< array of nSpecifics registryCacheSpecific */
+  uint32_t nQualityLevelsOffset; /**< array of nQualityLevels registryCacheQuality */
+  uint32_t nBucketsOffset; /**< array of nBuckets registryCacheEntry */
+  uint32_t nStringsOffset; /**< string table, every string is terminated by '\0' */
+} registryCacheHeader;
+
+/** @brief a component, in the order of the text registry */
+typedef struct registryCacheComponent {
+  uint32_t nName; /**< offset of the name of the component */
+  uint32_t nLibrary; /**< index of the library containing the component */
+  uint32_t nFirstSpecific; /**< index of the first specific name of the component */
+  uint32_t nSpecifics; /**< number of specific names, and of roles */
+  uint32_t nFirstQualityLevel; /**< index of the first quality level of the component */
+  uint32_t nQualityLevels; /**< number of quality levels */
+} registryCacheComponent;
+
+/** @brief a specific name of a component and the related role */
+typedef struct registryCacheSpecific {
+  uint32_t nName; /**< offset of the specific name */
+  uint32_t nRole; /**< offset of the role */
+} registryCacheSpecific;
+
+/** @brief the resources requested by a quality level of a component */
+typedef struct registryCacheQuality {
+  uint32_t nCPU; /**< CPU resource requested */
+  uint32_t nMemory; /**< memory resource requested */
+} registryCacheQuality;
+
+/** @brief a bucket of the hash table of the names
+ *
+ * Both the general and the specific names are hashed. When two components
+ * share a name, the first one in the registry is found, as with a linear
+ * search of the registry.
+ */
+typedef struct registryCacheEntry {
+  uint32_t nHash; /**< hash of the name */
+  uint32_t nName; /**< offset of the name */
+  uint32_t nComponent; /**< index of the component, REGISTRY_CACHE_NONE if the bucket is empty */
+  uint32_t nSpecific; /**< index of the specific name, REGISTRY_CACHE_NONE for the general name */
+} registryCacheEntry;
+
+/** @brief a binary registry mapped in memory */
+typedef struct registryCache {
+  void* pData; /**< the mapping of the file */
+  size_t nSize; /**< the size of the mapping */
+  const registryCacheHeader* pHeader;
+  const uint32_t* pLibraries;
+  const registryCacheComponent* pComponents;
+  const registryCacheSpecific* pSpecifics;
+  const registryCacheQuality* pQualityLevels;
+  const registryCacheEntry* pBuckets;
+  const char* pStrings;
+} registryCache;
+
+/** @brief the binary registry while omxregister builds it */
+typedef struct registryCacheBuilder {
+  uint32_t* pLibraries;
+  uint32_t nLibraries;
+  registryCacheComponent* pComponents;
+  uint32_t nComponents;
+  registryCacheSpecific* pSpecifics;
+  uint32_t nSpecifics;
+  registryCacheQuality* pQualityLevels;
+  uint32_t nQualityLevels;
+  char* pStrings;
+  uint32_t nStringsSize;
+  uint32_t nStringsAllocated;
+} registryCacheBuilder;
+
+/** @brief returns the name of the binary registry related to the text registry */
+char* registryCacheGetFilename(void);
+
+/** @brief maps the binary registry
+ *
+ * @return NULL if the binary registry does not exist, is not valid, or
+ * does not describe the current text registry. The caller must then read
+ * the text registry.
+ */
+registryCache* registryCacheOpen(void);
+
+/** @brief unmaps the binary registry */
+void registryCacheClose(registryCache* cache);
+
+/** @brief returns a string of the binary registry from its offset */
+const char* registryCacheString(const registryCache* cache, uint32_t nOffset);
+
+/** @brief returns 1 if the pointer is inside the mapping of the binary registry */
+int registryCacheContains(const registryCache* cache, const void* pointer);
+
+/** @brief searches a component by its general or specific name
+ *
+ * @param pSpecific if not NULL, receives the index of the specific name
+ * matched, or REGISTRY_CACHE_NONE if the general name matched
+ *
+ * @return the index of the component, or -1 if not found
+ */
+int registryCacheFind(const registryCache* cache, const char* name, uint32_t* pSpecific);
+
+/** @brief creates an empty binary registry */
+registryCacheBuilder* registryCacheBuilderCreate(void);
+
+/** @brief adds a library, that contains the components added after it */
+int registryCacheAddLibrary(registryCacheBuilder* builder, const char* libname);
+
+/** @brief adds a component, with its specific names, roles and quality levels */
+int registryCacheAddComponent(registryCacheBuilder* builder, stLoaderComponentType* component);
+
+/** @brief writes the binary registry for the text registry just written
+ *
+ * The file is written aside and renamed, so that a process mapping the
+ * previous version is not affected.
+ */
+int registryCacheWrite(registryCacheBuilder* builder);
+
+/** @brief releases the binary registry built */
+void registryCacheBuilderDestroy(registryCacheBuilder* builder);
+
+#endif
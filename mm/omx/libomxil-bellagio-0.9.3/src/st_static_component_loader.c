@@ -33,22 +33,40 @@
 #include <strings.h>
 #include <errno.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "common.h"
 #include "st_static_component_loader.h"
+#include "registry_cache.h"
+#include "name_index.h"
 #include "omx_reference_resource_manager.h"
 #include "base/omx_base_component.h"
 
-/** This pointer holds and handle allocate by this loader and requested by
- * some application. If the IL client does not de-allocate it calling
- * explicitly the FreeHandle function, any pending handle is release at the
- * end, when the global function OMX_Deinit is called. This list takes track of
- * any handle
+/** The list of the libraries found in the registry. Each library is loaded
+ * when the first of its components is created, and unloaded when the last
+ * instance of its components is destroyed. Any library still loaded is
+ * released at the end, when the global function OMX_Deinit is called.
  */
-void *handleLibList[100];
-/** Current number of handles already allocated by this loader
+static stLoaderLibraryType** libraryList = NULL;
+/** Current number of libraries listed by this loader
  */
-OMX_U32 numLib=0;
+static OMX_U32 numLib = 0;
+/** Protects the handles and the reference counts of the libraries
+ */
+static pthread_mutex_t libraryMutex = PTHREAD_MUTEX_INITIALIZER;
+/** The binary registry, when it is up to date. The names and the roles of
+ * the components, and the paths of the libraries, point inside it.
+ */
+static registryCache* componentsCache = NULL;
+/** The general and specific names of the components, built at the
+ * initialization of the loader when the binary registry is not available.
+ * Otherwise the names are searched in the hash table of the binary registry.
+ */
+static name_index_t componentNames;
+/** The roles of the components, an entry for each specific name. The binary
+ * registry does not index the roles, so this one is always built.
+ */
+static name_index_t componentRoles;
 
 /** @brief The initialization of the ST specific component loader.
  *
@@ -65,100 +83,507 @@ void st_static_setup_component_loader(BOSA_COMPONENTLOADER * st_static_loader) {
 
 }
 
-/** @brief the ST static loader constructor
+/** Copies a word of the registry in a string of the size used by the components
+ */
+static char* st_static_copy_word(const char* word, size_t length) {
+  char* copy;
+
+  if (length >= OMX_MAX_STRINGNAME_SIZE) {
+    length = OMX_MAX_STRINGNAME_SIZE - 1;
+  }
+  copy = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+  if (copy != NULL) {
+    memcpy(copy, word, length);
+  }
+  return copy;
+}
+
+/** Parses a list of names of the registry, each terminated by ':'.
+ * The list ends with a space or with the end of the line.
  *
- * This function creates the ST static component loader, and creates
- * the list of available components, based on a registry file
- * created by a separate application. It is called omxregister,
- * and must be called before the use of this loader
+ * @return the number of names stored in the newly allocated array names
  */
-OMX_ERRORTYPE BOSA_ST_InitComponentLoader(BOSA_COMPONENTLOADER *loader) {
-  FILE* omxregistryfp;
-  char* line = NULL;
-  char *libname;
-  int num_of_comp=0;
-  stLoaderComponentType** templateList;
+static unsigned int st_static_parse_names(const char* list, char*** names) {
+  const char* name;
+  unsigned int count = 0;
+  unsigned int i;
+
+  for (name = list; (*name != '\0') && (*name != ' '); name++) {
+    if (*name == ':') {
+      count++;
+    }
+  }
+  *names = calloc(count > 0 ? count : 1, sizeof(char *));
+  if (*names == NULL) {
+    return 0;
+  }
+  name = list;
+  for (i = 0; i < count; i++) {
+    (*names)[i] = st_static_copy_word(name, strcspn(name, ":"));
+    name += strcspn(name, ":") + 1;
+  }
+  return count;
+}
+
+/** Releases a string of a component descriptor, unless it belongs to the
+ * binary registry
+ */
+static void st_static_free_string(char* string) {
+  if (!registryCacheContains(componentsCache, string)) {
+    free(string);
+  }
+}
+
+/** Releases a component descriptor, either built from the registry or
+ * filled by a library
+ */
+static void st_static_free_template(stLoaderComponentType* template) {
+  unsigned int j;
+
+  if(template->name_requested){
+    free(template->name_requested);
+    template->name_requested=NULL;
+  }
+
+  for(j = 0 ; j < template->name_specific_length; j++){
+    if(template->name_specific && template->name_specific[j]) {
+      st_static_free_string(template->name_specific[j]);
+      template->name_specific[j]=NULL;
+    }
+    if(template->role_specific && template->role_specific[j]){
+      st_static_free_string(template->role_specific[j]);
+      template->role_specific[j]=NULL;
+    }
+  }
+
+  if(template->name_specific){
+    free(template->name_specific);
+    template->name_specific=NULL;
+  }
+  if(template->role_specific){
+    free(template->role_specific);
+    template->role_specific=NULL;
+  }
+  if(template->name){
+    st_static_free_string(template->name);
+    template->name=NULL;
+  }
+  for(j = 0 ; j < template->nqualitylevels; j++){
+    if(template->multiResourceLevel && template->multiResourceLevel[j]) {
+      free(template->multiResourceLevel[j]);
+    }
+  }
+  if(template->multiResourceLevel){
+    free(template->multiResourceLevel);
+    template->multiResourceLevel=NULL;
+  }
+  free(template);
+}
+
+/** Searches a component by its general name or by one of its specific names,
+ * in the binary registry if it is mapped, and returns its index in the list,
+ * or -1. The index of the specific name matched, or NAME_INDEX_GENERAL, is
+ * returned in pSpecific.
+ */
+static int st_static_find_name(const char* cComponentName, int* pSpecific) {
+  const name_index_entry_t* entry;
+  uint32_t nSpecific;
+  int component;
+
+  if (componentsCache != NULL) {
+    component = registryCacheFind(componentsCache, cComponentName, &nSpecific);
+    if (component >= 0) {
+      /* the components of the list are in the order of the binary registry */
+      *pSpecific = (nSpecific == REGISTRY_CACHE_NONE) ? NAME_INDEX_GENERAL :
+        (int)(nSpecific - componentsCache->pComponents[component].nFirstSpecific);
+    }
+    return component;
+  }
+  entry = name_index_find(&componentNames, cComponentName, NULL);
+  if (entry == NULL) {
+    return -1;
+  }
+  *pSpecific = entry->specific;
+  return entry->component;
+}
+
+/** Searches a component in the list, either by its general name or
+ * by one of its specific names
+ */
+static stLoaderComponentType* st_static_find_template(stLoaderComponentType** templateList, const char* cComponentName) {
+  int component, specific;
+
+  component = st_static_find_name(cComponentName, &specific);
+  return (component >= 0) ? templateList[component] : NULL;
+}
+
+/** Builds the indexes of the names and of the roles of the components,
+ * the one of the names only when the binary registry is not mapped.
+ * The names are added in the order of the list, so that the first component
+ * with a given name is found, as with a linear search of the list.
+ */
+static int st_static_build_index(stLoaderComponentType** templateList) {
+  unsigned int nNames = 0, nRoles = 0;
+  unsigned int j;
+  int i;
+
+  for (i = 0; templateList[i]; i++) {
+    nNames += 1 + templateList[i]->name_specific_length;
+    nRoles += templateList[i]->name_specific_length;
+  }
+  if ((componentsCache == NULL) && (name_index_init(&componentNames, nNames) != 0)) {
+    return -1;
+  }
+  if (name_index_init(&componentRoles, nRoles) != 0) {
+    name_index_deinit(&componentNames);
+    return -1;
+  }
+  for (i = 0; templateList[i]; i++) {
+    if (componentsCache == NULL) {
+      name_index_add(&componentNames, templateList[i]->name, i, NAME_INDEX_GENERAL);
+    }
+    for (j = 0; j < templateList[i]->name_specific_length; j++) {
+      if (componentsCache == NULL) {
+        name_index_add(&componentNames, templateList[i]->name_specific[j], i, j);
+      }
+      name_index_add(&componentRoles, templateList[i]->role_specific[j], i, j);
+    }
+  }
+  return 0;
+}
+
+/** @brief loads a library of components
+ *
+ * The library is opened and its components are described again by
+ * omx_component_library_Setup. Their constructors and versions are stored
+ * in the descriptors built from the registry. If the registry does not
+ * contain the roles of a component, they are taken from the library too.
+ *
+ * It must be called with the libraryMutex held.
+ */
+static OMX_ERRORTYPE st_static_load_library(stLoaderComponentType** templateList, stLoaderLibraryType* library) {
   stLoaderComponentType** stComponentsTemp;
-  void* handle;
+  stLoaderComponentType* template;
   int (*fptr)(stLoaderComponentType **stComponents);
+  int num_of_comp;
+  int i, j;
+  unsigned int k;
+
+  DEBUG(DEB_LEV_FULL_SEQ, "libname: >%s<\n", library->libname);
+  if((library->handle = dlopen(library->libname, RTLD_NOW)) == NULL) {
+    DEBUG(DEB_LEV_ERR, "could not load %s: %s\n", library->libname, dlerror());
+    return OMX_ErrorComponentNotFound;
+  }
+  if ((fptr = dlsym(library->handle, "omx_component_library_Setup")) == NULL) {
+    DEBUG(DEB_LEV_ERR, "the library %s is not compatible with ST static component loader - %s\n", library->libname, dlerror());
+    dlclose(library->handle);
+    library->handle = NULL;
+    return OMX_ErrorComponentNotFound;
+  }
+  num_of_comp = (int)(*fptr)(NULL);
+  stComponentsTemp = calloc(num_of_comp,sizeof(stLoaderComponentType*));
+  if (stComponentsTemp == NULL) {
+    dlclose(library->handle);
+    library->handle = NULL;
+    return OMX_ErrorInsufficientResources;
+  }
+  for (i = 0; i<num_of_comp; i++) {
+    stComponentsTemp[i] = calloc(1,sizeof(stLoaderComponentType));
+  }
+  (*fptr)(stComponentsTemp);
+  for (i = 0; i<num_of_comp; i++) {
+    for (j = 0; stComponentsTemp[i]->name && templateList[j]; j++) {
+      template = templateList[j];
+      if ((template->library != library) || strcmp(template->name, stComponentsTemp[i]->name)) {
+        continue;
+      }
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s comp name[%d]=%s\n",__func__, j, template->name);
+      template->componentVersion = stComponentsTemp[i]->componentVersion;
+      template->constructor = stComponentsTemp[i]->constructor;
+      if (template->role_specific == NULL) {
+        for (k = 0; k < template->name_specific_length; k++) {
+          free(template->name_specific[k]);
+        }
+        free(template->name_specific);
+        template->name_specific_length = stComponentsTemp[i]->name_specific_length;
+        template->name_specific = stComponentsTemp[i]->name_specific;
+        template->role_specific = stComponentsTemp[i]->role_specific;
+        stComponentsTemp[i]->name_specific_length = 0;
+        stComponentsTemp[i]->name_specific = NULL;
+        stComponentsTemp[i]->role_specific = NULL;
+      }
+      break;
+    }
+    st_static_free_template(stComponentsTemp[i]);
+  }
+  free(stComponentsTemp);
+  return OMX_ErrorNone;
+}
+
+/** @brief releases an instance of a component of the library
+ *
+ * When the last instance is released the library is closed, and its
+ * components are loaded again the next time they are requested.
+ */
+static void st_static_release_library(stLoaderComponentType** templateList, stLoaderLibraryType* library) {
   int i;
+  int err;
+
+  pthread_mutex_lock(&libraryMutex);
+  if (library->refcount > 0) {
+    library->refcount--;
+  }
+  if ((library->refcount == 0) && (library->handle != NULL)) {
+    for (i = 0; templateList[i]; i++) {
+      if (templateList[i]->library == library) {
+        templateList[i]->constructor = NULL;
+      }
+    }
+    err = dlclose(library->handle);
+    if(err!=0) {
+      DEBUG(DEB_LEV_ERR, "In %s Error %d in dlclose of lib %s\n", __func__, err, library->libname);
+    }
+    library->handle = NULL;
+  }
+  pthread_mutex_unlock(&libraryMutex);
+}
+
+/** @brief builds the list of the components from the text registry
+ *
+ * @return the list of the components, or NULL if the registry cannot be read
+ */
+static stLoaderComponentType** st_static_read_registry(void) {
+  FILE* omxregistryfp;
+  char* registry;
+  char* line;
+  char* next;
+  char* word;
+  long registry_size;
+  stLoaderComponentType** templateList;
+  stLoaderComponentType* component = NULL;
+  stLoaderLibraryType* library = NULL;
+  unsigned int j;
   int listindex;
   char *registry_filename;
-  int index_readline = 0;
-
-  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
 
   registry_filename = componentsRegistryGetFilename();
   omxregistryfp = fopen(registry_filename, "r");
   if (omxregistryfp == NULL){
     DEBUG(DEB_LEV_ERR, "Cannot open OpenMAX registry file %s\n", registry_filename);
-    return ENOENT;
+    free(registry_filename);
+    return NULL;
   }
   free(registry_filename);
-  libname = malloc(OMX_MAX_STRINGNAME_SIZE * 2);
+
+  /* the registry is read at once and parsed in memory */
+  fseek(omxregistryfp, 0, SEEK_END);
+  registry_size = ftell(omxregistryfp);
+  fseek(omxregistryfp, 0, SEEK_SET);
+  registry = malloc(registry_size + 1);
+  if (registry == NULL) {
+    fclose(omxregistryfp);
+    return NULL;
+  }
+  registry_size = fread(registry, 1, registry_size, omxregistryfp);
+  registry[registry_size] = '\0';
+  fclose(omxregistryfp);
 
   templateList = malloc(sizeof (stLoaderComponentType*));
   templateList[0] = NULL;
-  line = malloc(MAX_LINE_LENGTH);
-  fseek(omxregistryfp, 0, 0);
   listindex = 0;
 
-  while(1) {
-	  index_readline = 0;
-	  while(index_readline < MAX_LINE_LENGTH) {
-		  *(line+index_readline) = fgetc(omxregistryfp);
-		  if ((*(line+index_readline) == '\n') || (*(line+index_readline) == '\0')) {
-			  break;
-		  }
-		  index_readline++;
-	  }
-	  *(line+index_readline) = '\0';
-	  if ((index_readline >= MAX_LINE_LENGTH) || (index_readline == 0)) {
-		  break;
-	  }
-	  if ((*line == ' ') && (*(line+1) == '=')) {
-		  // not a library line. skip
-		  continue;
-	  }
-	  strcpy(libname, line);
-	  DEBUG(DEB_LEV_FULL_SEQ, "libname: >%s<\n",libname);
-	  if((handle = dlopen(libname, RTLD_NOW)) == NULL) {
-		  DEBUG(DEB_LEV_ERR, "could not load %s: %s\n", libname, dlerror());
-	  } else {
-		  handleLibList[numLib]=handle;
-		  numLib++;
-		  if ((fptr = dlsym(handle, "omx_component_library_Setup")) == NULL) {
-			  DEBUG(DEB_LEV_ERR, "the library %s is not compatible with ST static component loader - %s\n", libname, dlerror());
-		  } else {
-			  num_of_comp = (int)(*fptr)(NULL);
-			  templateList = realloc(templateList, (listindex + num_of_comp + 1) * sizeof (stLoaderComponentType*));
-			  templateList[listindex + num_of_comp] = NULL;
-			  stComponentsTemp = calloc(num_of_comp,sizeof(stLoaderComponentType*));
-			  for (i = 0; i<num_of_comp; i++) {
-				  stComponentsTemp[i] = calloc(1,sizeof(stLoaderComponentType));
-			  }
-			  (*fptr)(stComponentsTemp);
-			  for (i = 0; i<num_of_comp; i++) {
-				  templateList[listindex + i] = stComponentsTemp[i];
-				  DEBUG(DEB_LEV_FULL_SEQ, "In %s comp name[%d]=%s\n",__func__,listindex + i,templateList[listindex + i]->name);
-			  }
-			  free(stComponentsTemp);
-			  stComponentsTemp = NULL;
-			  listindex+= i;
-		  }
-	  }
-  }
-  if(line) {
-    free(line);
-    line = NULL;
-  }
-  free(libname);
-  libname = NULL;
-  fclose(omxregistryfp);
+  for (line = registry; *line != '\0'; line = next) {
+    next = strchr(line, '\n');
+    if (next != NULL) {
+      *next++ = '\0';
+    } else {
+      next = line + strlen(line);
+    }
+    if ((*line == ' ') && (*(line+1) == '=')) {
+      /* component line: " ==> name ==> name_specific: ==> quality levels" */
+      if (library == NULL) {
+        continue;
+      }
+      component = calloc(1,sizeof(stLoaderComponentType));
+      if (component == NULL) {
+        break;
+      }
+      word = line + 5;
+      component->name = st_static_copy_word(word, strcspn(word, " "));
+      word += strcspn(word, " ");
+      if (!strncmp(word, " ==> ", 5)) {
+        component->name_specific_length = st_static_parse_names(word + 5, &component->name_specific);
+      }
+      component->library = library;
+      templateList = realloc(templateList, (listindex + 2) * sizeof (stLoaderComponentType*));
+      templateList[listindex] = component;
+      templateList[listindex + 1] = NULL;
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s comp name[%d]=%s\n",__func__,listindex,component->name);
+      listindex++;
+    } else if ((*line == ' ') && (*(line+1) == '-')) {
+      /* roles line: " --> role_specific:" of the previous component */
+      if ((component == NULL) || (component->role_specific != NULL)) {
+        continue;
+      }
+      if (st_static_parse_names(line + 5, &component->role_specific) != component->name_specific_length) {
+        DEBUG(DEB_LEV_ERR, "In %s wrong roles for component %s\n", __func__, component->name);
+        for (j = 0; j < component->name_specific_length; j++) {
+          if (component->role_specific[j]) {
+            free(component->role_specific[j]);
+          }
+        }
+        free(component->role_specific);
+        component->role_specific = NULL;
+      }
+    } else if (*line != '\0') {
+      /* library line */
+      library = calloc(1,sizeof(stLoaderLibraryType));
+      if (library == NULL) {
+        break;
+      }
+      library->libname = strdup(line);
+      libraryList = realloc(libraryList, (numLib + 1) * sizeof (stLoaderLibraryType*));
+      libraryList[numLib] = library;
+      numLib++;
+      component = NULL;
+    }
+  }
+  free(registry);
+  return templateList;
+}
+
+/** @brief builds the list of the components from the binary registry
+ *
+ * Nothing is parsed: the descriptors point to the strings of the mapping.
+ */
+static stLoaderComponentType** st_static_read_cache(const registryCache* cache) {
+  const registryCacheHeader* header = cache->pHeader;
+  const registryCacheComponent* cached;
+  stLoaderComponentType** templateList;
+  stLoaderComponentType* component;
+  uint32_t i, j;
+
+  libraryList = calloc(header->nLibraries + 1, sizeof (stLoaderLibraryType*));
+  templateList = calloc(header->nComponents + 1, sizeof (stLoaderComponentType*));
+  if ((libraryList == NULL) || (templateList == NULL)) {
+    free(templateList);
+    return NULL;
+  }
+  for (numLib = 0; numLib < header->nLibraries; numLib++) {
+    libraryList[numLib] = calloc(1,sizeof(stLoaderLibraryType));
+    if (libraryList[numLib] == NULL) {
+      free(templateList);
+      return NULL;
+    }
+    libraryList[numLib]->libname = (char*)registryCacheString(cache, cache->pLibraries[numLib]);
+  }
+  for (i = 0; i < header->nComponents; i++) {
+    cached = &cache->pComponents[i];
+    component = calloc(1,sizeof(stLoaderComponentType));
+    if (component == NULL) {
+      break;
+    }
+    component->name = (char*)registryCacheString(cache, cached->nName);
+    component->library = libraryList[cached->nLibrary];
+    component->name_specific_length = cached->nSpecifics;
+    component->name_specific = calloc(cached->nSpecifics + 1, sizeof(char *));
+    component->role_specific = calloc(cached->nSpecifics + 1, sizeof(char *));
+    templateList[i] = component;
+    if ((component->name_specific == NULL) || (component->role_specific == NULL)) {
+      break;
+    }
+    for (j = 0; j < cached->nSpecifics; j++) {
+      component->name_specific[j] = (char*)registryCacheString(cache, cache->pSpecifics[cached->nFirstSpecific + j].nName);
+      component->role_specific[j] = (char*)registryCacheString(cache, cache->pSpecifics[cached->nFirstSpecific + j].nRole);
+    }
+  }
+  if (i < header->nComponents) {
+    /* out of memory: the partial list is released */
+    for (j = 0; j < i; j++) {
+      st_static_free_template(templateList[j]);
+    }
+    if (templateList[i]) {
+      st_static_free_template(templateList[i]);
+    }
+    free(templateList);
+    return NULL;
+  }
+  return templateList;
+}
+
+/** @brief the ST static loader constructor
+ *
+ * This function creates the ST static component loader, and creates
+ * the list of available components, based on a registry file
+ * created by a separate application. It is called omxregister,
+ * and must be called before the use of this loader.
+ *
+ * The names and the roles of the components are read from the binary
+ * registry written by omxregister when it is up to date, otherwise from the
+ * text registry, so that no library is loaded here. Only a registry written
+ * by an older omxregister, that does not contain the roles, needs its
+ * libraries to be loaded at this point.
+ */
+OMX_ERRORTYPE BOSA_ST_InitComponentLoader(BOSA_COMPONENTLOADER *loader) {
+  stLoaderComponentType** templateList = NULL;
+  stLoaderLibraryType* library;
+  unsigned int j;
+  int i;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
+
+  componentsCache = registryCacheOpen();
+  if (componentsCache != NULL) {
+    templateList = st_static_read_cache(componentsCache);
+    if (templateList == NULL) {
+      for (j = 0; j < numLib; j++) {
+        free(libraryList[j]);
+      }
+      free(libraryList);
+      libraryList = NULL;
+      numLib = 0;
+      registryCacheClose(componentsCache);
+      componentsCache = NULL;
+    }
+  }
+  if (templateList == NULL) {
+    templateList = st_static_read_registry();
+    if (templateList == NULL) {
+      return OMX_ErrorComponentNotFound;
+    }
+  }
+
+  /* registries without roles need the libraries to describe the components */
+  for (i = 0; templateList[i]; i++) {
+    if ((templateList[i]->role_specific != NULL) || (templateList[i]->name_specific_length == 0)) {
+      continue;
+    }
+    library = templateList[i]->library;
+    if (library->handle == NULL) {
+      pthread_mutex_lock(&libraryMutex);
+      if (st_static_load_library(templateList, library) == OMX_ErrorNone) {
+        /* keep it loaded until the loader is deinitialized */
+        library->refcount++;
+      }
+      pthread_mutex_unlock(&libraryMutex);
+    }
+    if (templateList[i]->role_specific == NULL) {
+      templateList[i]->role_specific = calloc(templateList[i]->name_specific_length + 1, sizeof(char *));
+      for (j = 0; j < templateList[i]->name_specific_length; j++) {
+        templateList[i]->role_specific[j] = st_static_copy_word("", 0);
+      }
+    }
+  }
   loader->loaderPrivate = templateList;
 
   RM_Init();
 
+  if (st_static_build_index(templateList) != 0) {
+    DEBUG(DEB_LEV_ERR, "In %s cannot allocate the index of the components\n", __func__);
+    BOSA_ST_DeInitComponentLoader(loader);
+    return OMX_ErrorInsufficientResources;
+  }
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
   return OMX_ErrorNone;
 }
@@ -168,7 +593,7 @@ OMX_ERRORTYPE BOSA_ST_InitComponentLoader(BOSA_COMPONENTLOADER *loader) {
  * This function deallocates the list of available components.
  */
 OMX_ERRORTYPE BOSA_ST_DeInitComponentLoader(BOSA_COMPONENTLOADER *loader) {
-  unsigned int i, j;
+  unsigned int i;
   int err;
   stLoaderComponentType** templateList;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
@@ -178,35 +603,7 @@ OMX_ERRORTYPE BOSA_ST_DeInitComponentLoader(BOSA_COMPONENTLOADER *loader) {
 
   i = 0;
   while(templateList[i]) {
-    if(templateList[i]->name_requested){
-      free(templateList[i]->name_requested);
-      templateList[i]->name_requested=NULL;
-    }
-
-    for(j = 0 ; j < templateList[i]->name_specific_length; j++){
-      if(templateList[i]->name_specific[j]) {
-        free(templateList[i]->name_specific[j]);
-        templateList[i]->name_specific[j]=NULL;
-      }
-      if(templateList[i]->role_specific[j]){
-        free(templateList[i]->role_specific[j]);
-        templateList[i]->role_specific[j]=NULL;
-      }
-    }
-
-    if(templateList[i]->name_specific){
-      free(templateList[i]->name_specific);
-      templateList[i]->name_specific=NULL;
-    }
-    if(templateList[i]->role_specific){
-      free(templateList[i]->role_specific);
-      templateList[i]->role_specific=NULL;
-    }
-    if(templateList[i]->name){
-      free(templateList[i]->name);
-      templateList[i]->name=NULL;
-    }
-    free(templateList[i]);
+    st_static_free_template(templateList[i]);
     templateList[i] = NULL;
     i++;
   }
@@ -216,12 +613,22 @@ OMX_ERRORTYPE BOSA_ST_DeInitComponentLoader(BOSA_COMPONENTLOADER *loader) {
   }
 
   for(i=0;i<numLib;i++) {
-    err = dlclose(handleLibList[i]);
-    if(err!=0) {
-      DEBUG(DEB_LEV_ERR, "In %s Error %d in dlclose of lib %i\n", __func__,err,i);
+    if (libraryList[i]->handle != NULL) {
+      err = dlclose(libraryList[i]->handle);
+      if(err!=0) {
+        DEBUG(DEB_LEV_ERR, "In %s Error %d in dlclose of lib %i\n", __func__,err,i);
+      }
     }
+    st_static_free_string(libraryList[i]->libname);
+    free(libraryList[i]);
   }
+  free(libraryList);
+  libraryList = NULL;
   numLib=0;
+  name_index_deinit(&componentNames);
+  name_index_deinit(&componentRoles);
+  registryCacheClose(componentsCache);
+  componentsCache = NULL;
 
   RM_Deinit();
 
@@ -232,8 +639,8 @@ OMX_ERRORTYPE BOSA_ST_DeInitComponentLoader(BOSA_COMPONENTLOADER *loader) {
 /** @brief creator of the requested OpenMAX component
  *
  * This function searches for the requested component in the internal list.
- * If the component is found, its constructor is called,
- * and the standard callbacks are assigned.
+ * If the component is found, its library is loaded if needed, its constructor
+ * is called, and the standard callbacks are assigned.
  * A pointer to a standard OpenMAX component is returned.
  */
 OMX_ERRORTYPE BOSA_ST_CreateComponent(
@@ -243,56 +650,59 @@ OMX_ERRORTYPE BOSA_ST_CreateComponent(
   OMX_PTR pAppData,
   OMX_CALLBACKTYPE* pCallBacks) {
 
-  int i;
-  unsigned int j;
-  int componentPosition = -1;
   OMX_ERRORTYPE eError = OMX_ErrorNone;
   stLoaderComponentType** templateList;
+  stLoaderComponentType* template;
+  stLoaderLibraryType* library;
   OMX_COMPONENTTYPE *openmaxStandComp;
   omx_base_component_PrivateType * priv;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   templateList = (stLoaderComponentType**)loader->loaderPrivate;
-  i = 0;
-  while(templateList[i]) {
-    if(!strcmp(templateList[i]->name, cComponentName)) {
-      //given component name matches with the general component names
-      componentPosition = i;
-      break;
-    } else {
-      for(j=0;j<templateList[i]->name_specific_length;j++) {
-        if(!strcmp(templateList[i]->name_specific[j], cComponentName)) {
-          //given component name matches with specific component names
-          componentPosition = i;
-          break;
-        }
-      }
-      if(componentPosition != -1) {
-        break;
-      }
-    }
-    i++;
-  }
-  if (componentPosition == -1) {
-    DEBUG(DEB_LEV_ERR, "Component not found with current ST static component loader.\n");
+  template = st_static_find_template(templateList, cComponentName);
+  if (template == NULL) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Component not found with current ST static component loader.\n");
     return OMX_ErrorComponentNotFound;
   }
 
   //component name matches with general component name field
   DEBUG(DEB_LEV_PARAMS, "Found base requested template %s\n", cComponentName);
+  library = template->library;
+  pthread_mutex_lock(&libraryMutex);
+  if (library->handle == NULL) {
+    eError = st_static_load_library(templateList, library);
+  }
+  if ((eError == OMX_ErrorNone) && (template->constructor == NULL)) {
+    DEBUG(DEB_LEV_ERR, "Component %s not found in library %s\n", cComponentName, library->libname);
+    if (library->refcount == 0) {
+      dlclose(library->handle);
+      library->handle = NULL;
+    }
+    eError = OMX_ErrorComponentNotFound;
+  }
+  if (eError == OMX_ErrorNone) {
+    library->refcount++;
+  }
+  pthread_mutex_unlock(&libraryMutex);
+  if (eError != OMX_ErrorNone) {
+    return eError;
+  }
+
   /* Build ST component from template and fill fields */
-  if (templateList[componentPosition]->name_requested == NULL)
+  if (template->name_requested == NULL)
   {    /* This check is to prevent memory leak in case two instances of the same component are loaded */
-      templateList[componentPosition]->name_requested = strndup (cComponentName, OMX_MAX_STRINGNAME_SIZE);
+      template->name_requested = strndup (cComponentName, OMX_MAX_STRINGNAME_SIZE);
   }
 
   openmaxStandComp = calloc(1,sizeof(OMX_COMPONENTTYPE));
   if (!openmaxStandComp) {
+    st_static_release_library(templateList, library);
     return OMX_ErrorInsufficientResources;
   }
-  eError = templateList[componentPosition]->constructor(openmaxStandComp,cComponentName);
+  eError = template->constructor(openmaxStandComp,cComponentName);
   if (eError != OMX_ErrorNone) {
     if (eError == OMX_ErrorInsufficientResources) {
+      /* the library is released when the handle is freed */
       *pHandle = openmaxStandComp;
       priv = (omx_base_component_PrivateType *) openmaxStandComp->pComponentPrivate;
       priv->loader = loader;
@@ -302,6 +712,7 @@ OMX_ERRORTYPE BOSA_ST_CreateComponent(
     openmaxStandComp->ComponentDeInit(openmaxStandComp);
     free(openmaxStandComp);
     openmaxStandComp = NULL;
+    st_static_release_library(templateList, library);
     return OMX_ErrorComponentNotFound;
   }
   priv = (omx_base_component_PrivateType *) openmaxStandComp->pComponentPrivate;
@@ -320,17 +731,29 @@ OMX_ERRORTYPE BOSA_ST_DestroyComponent(
   OMX_HANDLETYPE hComponent) {
   OMX_ERRORTYPE err = OMX_ErrorNone;
   omx_base_component_PrivateType * priv = (omx_base_component_PrivateType *) ((OMX_COMPONENTTYPE*)hComponent)->pComponentPrivate;
+  stLoaderComponentType** templateList;
+  stLoaderComponentType* template = NULL;
 
   /* check if this component was actually loaded from this loader */
   if (priv->loader != loader) {
     return OMX_ErrorComponentNotFound;
   }
 
+  /* the name is released by the component, look for its library before */
+  templateList = (stLoaderComponentType**)loader->loaderPrivate;
+  if (priv->name != NULL) {
+    template = st_static_find_template(templateList, priv->name);
+  }
+
   err = ((OMX_COMPONENTTYPE*)hComponent)->ComponentDeInit(hComponent);
 
   free((OMX_COMPONENTTYPE*)hComponent);
   hComponent = NULL;
 
+  if (template != NULL) {
+    st_static_release_library(templateList, template->library);
+  }
+
   return err;
 }
 
@@ -396,53 +819,41 @@ OMX_ERRORTYPE BOSA_ST_GetRolesOfComponent(
   OMX_U8 **roles) {
 
   stLoaderComponentType** templateList;
-  int i;
-  unsigned int j, index;
+  stLoaderComponentType* template;
+  int component, specific;
+  unsigned int index;
   unsigned int max_roles = *pNumRoles;
-  int found = 0;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   templateList = (stLoaderComponentType**)loader->loaderPrivate;
   *pNumRoles = 0;
-  i = 0;
-  while (templateList[i]) {
-    if(!strcmp(templateList[i]->name, compName)) {
-      DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested template %s IN GENERAL COMPONENT\n", compName);
-      // set the no of roles field
-      *pNumRoles = templateList[i]->name_specific_length;
-      if(roles == NULL) {
-        return OMX_ErrorNone;
-      }
-      //append the roles
-      for (index = 0; index < templateList[i]->name_specific_length; index++) {
-        if (index < max_roles) {
-          strcpy ((char*)*(roles+index), templateList[i]->role_specific[index]);
-        }
-      }
-      found = 1;
-    } else {
-      for(j=0;j<templateList[i]->name_specific_length;j++) {
-        if(!strcmp(templateList[i]-> name_specific[j], compName)) {
-          DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested component %s IN SPECIFIC COMPONENT \n", compName);
-          *pNumRoles = 1;
-          found = 1;
-          if(roles == NULL) {
-            return OMX_ErrorNone;
-          }
-          if (max_roles > 0) {
-            strcpy ((char*)*roles , templateList[i]->role_specific[j]);
-          }
-        }
+  component = st_static_find_name(compName, &specific);
+  if (component < 0) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "no component match in whole template list has been found\n");
+    return OMX_ErrorComponentNotFound;
+  }
+  template = templateList[component];
+  if (specific == NAME_INDEX_GENERAL) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested template %s IN GENERAL COMPONENT\n", compName);
+    // set the no of roles field
+    *pNumRoles = template->name_specific_length;
+    if(roles == NULL) {
+      return OMX_ErrorNone;
+    }
+    //append the roles
+    for (index = 0; index < template->name_specific_length; index++) {
+      if (index < max_roles) {
+        strcpy ((char*)*(roles+index), template->role_specific[index]);
       }
     }
-    i++;
-    if(found) {
-      break;
+  } else {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Found requested component %s IN SPECIFIC COMPONENT \n", compName);
+    *pNumRoles = 1;
+    if(roles == NULL) {
+      return OMX_ErrorNone;
+    }
+    if (max_roles > 0) {
+      strcpy ((char*)*roles , template->role_specific[specific]);
     }
-  }
-  if(!found) {
-    DEBUG(DEB_LEV_ERR, "no component match in whole template list has been found\n");
-    *pNumRoles = 0;
-    return OMX_ErrorComponentNotFound;
   }
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
   return OMX_ErrorNone;
@@ -461,26 +872,20 @@ OMX_ERRORTYPE BOSA_ST_GetComponentsOfRole (
   OMX_U8  **compNames) {
 
   stLoaderComponentType** templateList;
-  int i = 0;
-  unsigned int j = 0;
+  const name_index_entry_t* entry = NULL;
   int num_comp = 0;
   int max_entries = *pNumComps;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   templateList = (stLoaderComponentType**)loader->loaderPrivate;
-  i = 0;
-  while(templateList[i]) {
-    for (j = 0; j<templateList[i]->name_specific_length; j++) {
-      if (!strcmp(templateList[i]->role_specific[j], role)) {
-        if (compNames != NULL) {
-          if (num_comp < max_entries) {
-            strcpy((char*)(compNames[num_comp]), templateList[i]->name);
-          }
-        }
-      num_comp++;
+  /* the entries of a role are found in the order of the list */
+  while ((entry = name_index_find(&componentRoles, role, entry)) != NULL) {
+    if (compNames != NULL) {
+      if (num_comp < max_entries) {
+        strcpy((char*)(compNames[num_comp]), templateList[entry->component]->name);
       }
     }
-    i++;
+    num_comp++;
   }
 
   *pNumComps = num_comp;
@@ -29,6 +29,18 @@
 #include "omxcore.h"
 #include "extension_struct.h"
 
+/** @brief the private data structure handled by the ST static loader that describes
+ * a library of OpenMAX components listed in the registry
+ *
+ * The library is opened only when the first of its components is created,
+ * and closed when the last instance of its components is destroyed.
+ */
+typedef struct stLoaderLibraryType{
+  char* libname; /**< the absolute path of the library, as written in the registry */
+  void* handle; /**< the handle returned by dlopen, NULL while the library is not loaded */
+  OMX_U32 refcount; /**< the number of components of the library currently instantiated */
+} stLoaderLibraryType;
+
 /** @brief the private data structure handled by the ST static loader that described
  * an OpenMAX component
  *
@@ -46,6 +58,7 @@ typedef struct stLoaderComponentType{
   OMX_ERRORTYPE (*constructor)(OMX_COMPONENTTYPE*,OMX_STRING cComponentName); /**< constructor function pointer for each Linux ST OpenMAX component */
   OMX_U32 nqualitylevels;/**< number of available quality levels */
   multiResourceDescriptor** multiResourceLevel;
+  stLoaderLibraryType* library; /**< the library containing the component, owned by the loader */
 } stLoaderComponentType;
 
 /** @brief The initialization of the ST specific component loader.
@@ -56,8 +69,9 @@ void st_static_setup_component_loader(BOSA_COMPONENTLOADER * st_static_loader);
  *
  * It is the component loader developed under linux by ST, for local libraries.
  * It is based on a registry file, like in the case of GStreamer. It reads the
- * registry file, and allows the components to register themself to the
- * main list templateList.
+ * registry file, and builds the main list templateList from the names and
+ * roles stored in it. The libraries are not loaded until one of their
+ * components is requested.
  */
 OMX_ERRORTYPE BOSA_ST_InitComponentLoader(BOSA_COMPONENTLOADER *loader);
 
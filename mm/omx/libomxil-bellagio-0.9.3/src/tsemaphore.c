@@ -103,6 +103,37 @@ OSCL_EXPORT_REF void tsem_down(tsem_t* tsem) {
   pthread_mutex_unlock(&tsem->mutex);
 }
 
+/** Decreases the value of the semaphore to zero without blocking
+ *
+ * @param tsem the semaphore to decrease
+ *
+ * @return the value the semaphore had before being decreased
+ */
+OSCL_EXPORT_REF unsigned int tsem_down_all(tsem_t* tsem) {
+  unsigned int val;
+  pthread_mutex_lock(&tsem->mutex);
+  val = tsem->semval;
+  tsem->semval = 0;
+  pthread_mutex_unlock(&tsem->mutex);
+  return val;
+}
+
+/** Decreases the value of the semaphore by at most max without blocking
+ *
+ * @param tsem the semaphore to decrease
+ * @param max the maximum decrement
+ *
+ * @return the amount the semaphore has been decreased of
+ */
+OSCL_EXPORT_REF unsigned int tsem_down_max(tsem_t* tsem, unsigned int max) {
+  unsigned int val;
+  pthread_mutex_lock(&tsem->mutex);
+  val = tsem->semval < max ? tsem->semval : max;
+  tsem->semval -= val;
+  pthread_mutex_unlock(&tsem->mutex);
+  return val;
+}
+
 /** Increases the value of the semaphore
  *
  * @param tsem the semaphore to increase
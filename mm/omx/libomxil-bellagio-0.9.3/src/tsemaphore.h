@@ -71,6 +71,23 @@ OSCL_IMPORT_REF void tsem_down(tsem_t* tsem);
  */
 OSCL_IMPORT_REF int tsem_timed_down(tsem_t* tsem, unsigned int milliSecondsDelay);
 
+/** Decreases the value of the semaphore to zero without blocking
+ *
+ * @param tsem the semaphore to decrease
+ *
+ * @return the value the semaphore had before being decreased
+ */
+OSCL_IMPORT_REF unsigned int tsem_down_all(tsem_t* tsem);
+
+/** Decreases the value of the semaphore by at most max without blocking
+ *
+ * @param tsem the semaphore to decrease
+ * @param max the maximum decrement
+ *
+ * @return the amount the semaphore has been decreased of
+ */
+OSCL_IMPORT_REF unsigned int tsem_down_max(tsem_t* tsem, unsigned int max);
+
 /** Increases the value of the semaphore
  *
  * @param tsem the semaphore to increase
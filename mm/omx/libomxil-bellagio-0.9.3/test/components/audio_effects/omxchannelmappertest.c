@@ -0,0 +1,723 @@
+/**
+  test/components/audio_effects/omxchannelmappertest.c
+
+  This test application checks the downmix, the upmix and the format
+  conversions of the channel mapper component against a reference computed
+  in double precision, for each kernel, and measures its speed.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxchannelmappertest.h"
+
+appPrivateType* appPriv;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = channelmapperEventHandler,
+                               .EmptyBufferDone = channelmapperEmptyBufferDone,
+                               .FillBufferDone = channelmapperFillBufferDone,
+};
+
+/** The kernels of the channel mapper, a kernel not supported by the CPU being skipped */
+static const char* kernelNames[] = { "scalar", "sse", "avx2", "neon" };
+#define KERNELS (sizeof(kernelNames) / sizeof(kernelNames[0]))
+
+#define S16(c, i) { c, 16, OMX_FALSE, i }
+#define S24(c, i) { c, 24, OMX_FALSE, i }
+#define S32(c, i) { c, 32, OMX_FALSE, i }
+#define F32(c, i) { c, 32, OMX_TRUE, i }
+
+/** A conversion checked, with the matrix derived from the layouts or the client one */
+typedef struct mapperCaseType {
+  const char* sName;
+  mapperFormatType sIn;
+  mapperFormatType sOut;
+  OMX_BOOL bClientMatrix;
+} mapperCaseType;
+
+static const mapperCaseType checkCases[] = {
+  { "5.1 s16 to stereo s16", S16(6, OMX_TRUE), S16(2, OMX_TRUE), OMX_FALSE },
+  { "5.1 s16 planar to stereo f32", S16(6, OMX_FALSE), F32(2, OMX_TRUE), OMX_FALSE },
+  { "7.1 f32 to stereo s16", F32(8, OMX_TRUE), S16(2, OMX_TRUE), OMX_FALSE },
+  { "stereo s16 to 5.1 f32 planar", S16(2, OMX_TRUE), F32(6, OMX_FALSE), OMX_FALSE },
+  { "stereo s16 to mono s24", S16(2, OMX_TRUE), S24(1, OMX_TRUE), OMX_FALSE },
+  { "stereo s16 to planar", S16(2, OMX_TRUE), S16(2, OMX_FALSE), OMX_FALSE },
+  { "stereo s24 planar to s32", S24(2, OMX_FALSE), S32(2, OMX_TRUE), OMX_FALSE },
+  { "stereo f32 to s24", F32(2, OMX_TRUE), S24(2, OMX_TRUE), OMX_FALSE },
+  { "stereo s32 to f32", S32(2, OMX_TRUE), F32(2, OMX_TRUE), OMX_FALSE },
+  { "stereo s24 to s16", S24(2, OMX_TRUE), S16(2, OMX_TRUE), OMX_FALSE },
+  { "5.1 s16 to stereo s16 client matrix", S16(6, OMX_TRUE), S16(2, OMX_TRUE), OMX_TRUE },
+  { "5.1 s32 to stereo s32 client matrix", S32(6, OMX_TRUE), S32(2, OMX_TRUE), OMX_TRUE }
+};
+#define CHECK_CASES (sizeof(checkCases) / sizeof(checkCases[0]))
+
+/** The conversions measured */
+static const mapperCaseType benchCases[] = {
+  { "5.1 s16 to stereo s16", S16(6, OMX_TRUE), S16(2, OMX_TRUE), OMX_FALSE },
+  { "7.1 f32 to stereo s16", F32(8, OMX_TRUE), S16(2, OMX_TRUE), OMX_FALSE },
+  { "stereo s16 to 5.1 f32", S16(2, OMX_TRUE), F32(6, OMX_TRUE), OMX_FALSE }
+};
+#define BENCH_CASES (sizeof(benchCases) / sizeof(benchCases[0]))
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxchannelmappertest [-s seconds] [-k kernel]\n");
+  printf("\n");
+  printf("       -s seconds: seconds of 48 kHz audio converted by each benchmark run, default %d\n", DEFAULT_SECONDS);
+  printf("       -k kernel: benchmark only this kernel, scalar, sse, avx2 or neon\n");
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+/** Whether the component runs a kernel, when built in and supported by the CPU */
+static int kernelSupported(const char* sKernel) {
+  return kernelSelected("OMX.st.audio.channelmapper", CHANNELMAPPER_KERNEL_ENV, sKernel, &callbacks);
+}
+
+static OMX_U32 sampleSize(const mapperFormatType* pFormat) {
+  return pFormat->nBitPerSample / 8;
+}
+
+static OMX_U32 frameSize(const mapperFormatType* pFormat) {
+  return pFormat->nChannels * pFormat->nBitPerSample / 8;
+}
+
+/** The step between two integer samples, as a fraction of the full scale */
+static double sampleStep(const mapperFormatType* pFormat) {
+  return pFormat->bFloat ? 0 : ldexp(1, 1 - (int)pFormat->nBitPerSample);
+}
+
+static double readSample(const mapperFormatType* pFormat, const OMX_U8* pSample) {
+  int32_t nValue;
+  float fValue;
+
+  if (pFormat->bFloat) {
+    memcpy(&fValue, pSample, sizeof(float));
+    return fValue;
+  }
+  switch (pFormat->nBitPerSample) {
+    case 16:
+      return *(const OMX_S16*)pSample / 32768.0;
+    case 24:
+      nValue = (int32_t)(((OMX_U32)pSample[0] << 8) | ((OMX_U32)pSample[1] << 16) | ((OMX_U32)pSample[2] << 24));
+      return nValue / 2147483648.0;
+    default:
+      memcpy(&nValue, pSample, sizeof(int32_t));
+      return nValue / 2147483648.0;
+  }
+}
+
+static void writeSample(const mapperFormatType* pFormat, OMX_U8* pSample, double fValue) {
+  double fMax = 1.0 - sampleStep(pFormat);
+  float fFloat;
+  int32_t nValue;
+  OMX_S16 nShort;
+
+  if (pFormat->bFloat) {
+    fFloat = (float)fValue;
+    memcpy(pSample, &fFloat, sizeof(float));
+    return;
+  }
+  fValue = fValue < -1.0 ? -1.0 : (fValue > fMax ? fMax : fValue);
+  switch (pFormat->nBitPerSample) {
+    case 16:
+      nShort = (OMX_S16) lrint(fValue * 32768.0);
+      memcpy(pSample, &nShort, sizeof(OMX_S16));
+      break;
+    case 24:
+      nValue = (int32_t) lrint(fValue * 8388608.0);
+      pSample[0] = nValue & 0xff;
+      pSample[1] = (nValue >> 8) & 0xff;
+      pSample[2] = (nValue >> 16) & 0xff;
+      break;
+    default:
+      nValue = (int32_t) llrint(fValue * 2147483648.0);
+      memcpy(pSample, &nValue, sizeof(int32_t));
+  }
+}
+
+/** Fills interleaved frames with a sine of a different frequency on each channel */
+static OMX_U8* makeSines(const mapperFormatType* pFormat, OMX_U32 nFrames) {
+  OMX_U8* pSamples = malloc(nFrames * frameSize(pFormat));
+  OMX_U32 i, c;
+
+  for (i = 0; i < nFrames; i++) {
+    for (c = 0; c < pFormat->nChannels; c++) {
+      writeSample(pFormat, pSamples + (i * pFormat->nChannels + c) * sampleSize(pFormat),
+        SINE_AMPLITUDE * sin(2 * M_PI * (250.0 * (c + 1)) * i / 48000 + c));
+    }
+  }
+  return pSamples;
+}
+
+/** Sets the layout of the samples of a port of the component */
+static void setPortPcm(OMX_HANDLETYPE handle, OMX_U32 nPortIndex, const mapperFormatType* pFormat) {
+  OMX_AUDIO_PARAM_PCMMODETYPE sPcmMode;
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_ERRORTYPE err;
+  OMX_U32 c;
+
+  setHeader(&sPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+  sPcmMode.nPortIndex = nPortIndex;
+  err = OMX_GetParameter(handle, OMX_IndexParamAudioPcm, &sPcmMode);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the port %i PCM mode\n", (int)nPortIndex);
+    exit(1);
+  }
+  sPcmMode.nChannels = pFormat->nChannels;
+  sPcmMode.nBitPerSample = pFormat->nBitPerSample;
+  sPcmMode.eNumData = pFormat->bFloat ? OMX_NumericalDataFloat : OMX_NumericalDataSigned;
+  sPcmMode.bInterleaved = pFormat->bInterleaved;
+  sPcmMode.nSamplingRate = 48000;
+  /* the usual layout for the number of channels */
+  for (c = 0; c < OMX_AUDIO_MAXCHANNELS; c++) {
+    sPcmMode.eChannelMapping[c] = OMX_AUDIO_ChannelNone;
+  }
+  err = OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcmMode);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in setting the port %i PCM mode\n", (int)nPortIndex);
+    exit(1);
+  }
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = nPortIndex;
+  err = OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+  sPortDef.nBufferCountActual = PORT_BUFFERS;
+  err = OMX_SetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in setting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+}
+
+/** Copies the next input frames in a buffer, a plane per channel when the input
+ * port is planar, and sends it, doing nothing when all are sent. The buffer is
+ * sent under the mutex, so that the main thread and the EmptyBufferDone callback
+ * send the frames in order.
+ */
+static OMX_ERRORTYPE sendInputBuffer(OMX_HANDLETYPE handle, OMX_BUFFERHEADERTYPE* pBuffer) {
+  const mapperFormatType* pFormat = &appPriv->sIn;
+  OMX_U32 nSize = sampleSize(pFormat);
+  const OMX_U8* pFrames;
+  OMX_U32 nFrames, f, c;
+  OMX_ERRORTYPE err;
+
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->nInputSent >= appPriv->nInputFrames) {
+    pthread_mutex_unlock(&appPriv->mutex);
+    return OMX_ErrorNone;
+  }
+  nFrames = appPriv->nInputFrames - appPriv->nInputSent;
+  if (nFrames > INPUT_FRAMES) {
+    nFrames = INPUT_FRAMES;
+  }
+  pFrames = appPriv->pInput + appPriv->nInputSent * frameSize(pFormat);
+  if (pFormat->bInterleaved) {
+    memcpy(pBuffer->pBuffer, pFrames, nFrames * frameSize(pFormat));
+  } else {
+    for (c = 0; c < pFormat->nChannels; c++) {
+      for (f = 0; f < nFrames; f++) {
+        memcpy(pBuffer->pBuffer + (c * nFrames + f) * nSize, pFrames + (f * pFormat->nChannels + c) * nSize, nSize);
+      }
+    }
+  }
+  pBuffer->nFilledLen = nFrames * frameSize(pFormat);
+  pBuffer->nOffset = 0;
+  appPriv->nInputSent += nFrames;
+  pBuffer->nFlags = (appPriv->nInputSent == appPriv->nInputFrames) ? OMX_BUFFERFLAG_EOS : 0;
+  err = OMX_EmptyThisBuffer(handle, pBuffer);
+  pthread_mutex_unlock(&appPriv->mutex);
+  return err;
+}
+
+/** Converts interleaved input frames with a kernel, NULL for the default one, and the
+ * client matrix if not NULL, and returns the output frames, interleaved, or -1.
+ * The matrix used is returned in pMatrixUsed.
+ */
+static long runChannelMapper(const char* sKernel, const mapperFormatType* pIn, const mapperFormatType* pOut,
+                             const OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix,
+                             const OMX_U8* pInput, OMX_U32 nInputFrames, OMX_U8* pOutput, OMX_U32 nOutputMax,
+                             OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrixUsed, long* pElapsed) {
+  OMX_BUFFERHEADERTYPE *inBuffer[PORT_BUFFERS], *outBuffer[PORT_BUFFERS];
+  OMX_INDEXTYPE nMatrixIndex;
+  struct timeval start, end;
+  OMX_ERRORTYPE err;
+  int i;
+
+  if (sKernel) {
+    setenv(CHANNELMAPPER_KERNEL_ENV, sKernel, 1);
+  } else {
+    unsetenv(CHANNELMAPPER_KERNEL_ENV);
+  }
+  appPriv->sIn = *pIn;
+  appPriv->sOut = *pOut;
+  appPriv->pInput = pInput;
+  appPriv->nInputFrames = nInputFrames;
+  appPriv->nInputSent = 0;
+  appPriv->pOutput = pOutput;
+  appPriv->nOutputMax = nOutputMax;
+  appPriv->nOutputFrames = 0;
+  appPriv->bEOS = OMX_FALSE;
+
+  err = OMX_GetHandle(&appPriv->handle, "OMX.st.audio.channelmapper", NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    return -1;
+  }
+  setPortPcm(appPriv->handle, 0, pIn);
+  setPortPcm(appPriv->handle, 1, pOut);
+  err = OMX_GetExtensionIndex(appPriv->handle, "OMX.st.index.config.BellagioChannelMatrix", &nMatrixIndex);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "Error in getting the channel matrix index\n");
+    return -1;
+  }
+  if (pMatrix) {
+    err = OMX_SetConfig(appPriv->handle, nMatrixIndex, (OMX_PTR)pMatrix);
+    if(err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error in setting the channel matrix\n");
+      return -1;
+    }
+  }
+  setHeader(pMatrixUsed, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+  pMatrixUsed->nPortIndex = 1;
+  err = OMX_GetConfig(appPriv->handle, nMatrixIndex, pMatrixUsed);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "Error in getting the channel matrix\n");
+    return -1;
+  }
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_AllocateBuffer(appPriv->handle, &inBuffer[i], 0, NULL, PORT_BUFFER_SIZE);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer in %i %i\n", i, err);
+      return -1;
+    }
+    err = OMX_AllocateBuffer(appPriv->handle, &outBuffer[i], 1, NULL, PORT_BUFFER_SIZE);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer out %i %i\n", i, err);
+      return -1;
+    }
+  }
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    outBuffer[i]->nFilledLen = 0;
+    err = OMX_FillThisBuffer(appPriv->handle, outBuffer[i]);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on FillThisBuffer %i\n", err);
+      return -1;
+    }
+  }
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = sendInputBuffer(appPriv->handle, inBuffer[i]);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on EmptyThisBuffer %i\n", err);
+      return -1;
+    }
+  }
+  tsem_down(appPriv->doneSem);
+  gettimeofday(&end, NULL);
+  *pElapsed = elapsed_us(&start, &end);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_FreeBuffer(appPriv->handle, 0, inBuffer[i]);
+    err = OMX_FreeBuffer(appPriv->handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+
+  OMX_FreeHandle(appPriv->handle);
+  appPriv->handle = NULL;
+  return appPriv->nOutputFrames;
+}
+
+/** The client matrix of the checks, full scale sums that saturate and a negated channel */
+static void makeClientMatrix(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix, OMX_U32 nIn, OMX_U32 nOut) {
+  OMX_U32 i, o;
+
+  setHeader(pMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+  pMatrix->nPortIndex = 1;
+  pMatrix->nInputChannels = nIn;
+  pMatrix->nOutputChannels = nOut;
+  pMatrix->bDerived = OMX_FALSE;
+  for (o = 0; o < nOut; o++) {
+    for (i = 0; i < nIn; i++) {
+      pMatrix->nCoef[o * nIn + i] = 0;
+    }
+  }
+  pMatrix->nCoef[0 * nIn + 0] = 65536;
+  pMatrix->nCoef[0 * nIn + 1] = 65536;
+  pMatrix->nCoef[1 * nIn + (nIn - 1)] = -65536;
+  pMatrix->nCoef[1 * nIn + 2] = 32768;
+}
+
+/** The output samples are within a step and the float error of the input mixed by
+ * the matrix in double precision and saturated, and there are as many as input ones
+ */
+static int compareOutput(const char* sName, const mapperFormatType* pIn, const mapperFormatType* pOut,
+                         const OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix,
+                         const OMX_U8* pInput, const OMX_U8* pOutput, OMX_U32 nFrames, long nOutputFrames) {
+  double fStep = sampleStep(pOut), fExpected, fError, fMaxError = 0;
+  OMX_U32 f, i, o;
+
+  if (nOutputFrames != nFrames) {
+    DEBUG(DEB_LEV_ERR, "%s: %li frames out of %i\n", sName, nOutputFrames, (int)nFrames);
+    return 1;
+  }
+  for (f = 0; f < nFrames; f++) {
+    for (o = 0; o < pOut->nChannels; o++) {
+      fExpected = 0;
+      for (i = 0; i < pIn->nChannels; i++) {
+        fExpected += pMatrix->nCoef[o * pIn->nChannels + i] / 65536.0 *
+          readSample(pIn, pInput + (f * pIn->nChannels + i) * sampleSize(pIn));
+      }
+      if (!pOut->bFloat) {
+        fExpected = fExpected < -1.0 ? -1.0 : (fExpected > 1.0 - fStep ? 1.0 - fStep : fExpected);
+      }
+      fError = fabs(readSample(pOut, pOutput + (f * pOut->nChannels + o) * sampleSize(pOut)) - fExpected);
+      if (fError > fMaxError) {
+        fMaxError = fError;
+      }
+    }
+  }
+  DEBUG(DEFAULT_MESSAGES, "%s: %i frames, largest error %.3g steps\n", sName, (int)nFrames,
+    pOut->bFloat ? fMaxError * 16777216.0 : fMaxError / fStep);
+  if (fMaxError > fStep + ldexp(1, -20)) {
+    DEBUG(DEB_LEV_ERR, "%s is wrong\n", sName);
+    return 1;
+  }
+  return 0;
+}
+
+/** The matrix derived for 5.1 to stereo folds the centre and the surrounds in the
+ * fronts at -3 dB, drops the LFE, and is scaled to full scale
+ */
+static int checkDerivedMatrix(const OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix) {
+  static const double fLeft[6] = { 1.0, 0, 0.7071, 0, 0.7071, 0 };
+  double fSum = 1.0 + 2 * 0.7071;
+  OMX_S32 nExpected;
+  OMX_U32 i, o;
+  int result = 0;
+
+  if (pMatrix->nInputChannels != 6 || pMatrix->nOutputChannels != 2 || !pMatrix->bDerived) {
+    DEBUG(DEB_LEV_ERR, "the derived matrix is %ix%i\n", (int)pMatrix->nOutputChannels, (int)pMatrix->nInputChannels);
+    return 1;
+  }
+  for (o = 0; o < 2; o++) {
+    for (i = 0; i < 6; i++) {
+      /* the right row is the left one with the left and the right channels swapped */
+      nExpected = (OMX_S32) lrint(fLeft[(o == 0 || i == 2 || i == 3) ? i : (i ^ 1)] / fSum * 65536);
+      if (abs(pMatrix->nCoef[o * 6 + i] - nExpected) > 1) {
+        DEBUG(DEB_LEV_ERR, "derived coefficient %i,%i is %i, not %i\n", (int)o, (int)i, (int)pMatrix->nCoef[o * 6 + i], (int)nExpected);
+        result = 1;
+      }
+    }
+  }
+  return result;
+}
+
+/** Each case converted by the default kernel matches the reference */
+static int checkCasesOutput() {
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sClient, sUsed;
+  const mapperCaseType* pCase;
+  OMX_U8 *pInput, *pOutput;
+  long nFrames, elapsed;
+  int result = 0;
+  OMX_U32 k;
+
+  for (k = 0; k < CHECK_CASES; k++) {
+    pCase = &checkCases[k];
+    pInput = makeSines(&pCase->sIn, CHECK_FRAMES);
+    pOutput = malloc(CHECK_FRAMES * frameSize(&pCase->sOut));
+    if (pCase->bClientMatrix) {
+      makeClientMatrix(&sClient, pCase->sIn.nChannels, pCase->sOut.nChannels);
+    }
+    nFrames = runChannelMapper(NULL, &pCase->sIn, &pCase->sOut, pCase->bClientMatrix ? &sClient : NULL,
+      pInput, CHECK_FRAMES, pOutput, CHECK_FRAMES, &sUsed, &elapsed);
+    if (nFrames < 0) {
+      result = 1;
+    } else {
+      result |= compareOutput(pCase->sName, &pCase->sIn, &pCase->sOut, &sUsed, pInput, pOutput, CHECK_FRAMES, nFrames);
+    }
+    if (k == 0) {
+      result |= checkDerivedMatrix(&sUsed);
+    }
+    free(pOutput);
+    free(pInput);
+  }
+  return result;
+}
+
+/** A client matrix not of the channels of the ports is refused */
+static int checkBadMatrix() {
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sMatrix;
+  OMX_INDEXTYPE nMatrixIndex;
+  OMX_HANDLETYPE handle;
+  OMX_ERRORTYPE err;
+  int result = 0;
+
+  err = OMX_GetHandle(&handle, "OMX.st.audio.channelmapper", NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    return 1;
+  }
+  OMX_GetExtensionIndex(handle, "OMX.st.index.config.BellagioChannelMatrix", &nMatrixIndex);
+  makeClientMatrix(&sMatrix, 6, 2);
+  err = OMX_SetConfig(handle, nMatrixIndex, &sMatrix);
+  if (err != OMX_ErrorBadParameter) {
+    DEBUG(DEB_LEV_ERR, "a 2x6 matrix on stereo ports gives %x\n", err);
+    result = 1;
+  }
+  OMX_FreeHandle(handle);
+  return result;
+}
+
+/** The kernels give the same output as the scalar one, give or take rounding,
+ * in all the checked formats and layouts
+ */
+static int checkKernels() {
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sClient, sUsed;
+  const mapperCaseType* pCase;
+  OMX_U8 *pInput, *pReference, *pOutput;
+  long nFrames, elapsed;
+  double fError, fMaxError;
+  int result = 0;
+  OMX_U32 c, k, f;
+
+  for (c = 0; c < CHECK_CASES; c++) {
+    pCase = &checkCases[c];
+    pInput = makeSines(&pCase->sIn, CHECK_FRAMES);
+    pReference = malloc(CHECK_FRAMES * frameSize(&pCase->sOut));
+    pOutput = malloc(CHECK_FRAMES * frameSize(&pCase->sOut));
+    if (pCase->bClientMatrix) {
+      makeClientMatrix(&sClient, pCase->sIn.nChannels, pCase->sOut.nChannels);
+    }
+    runChannelMapper("scalar", &pCase->sIn, &pCase->sOut, pCase->bClientMatrix ? &sClient : NULL,
+      pInput, CHECK_FRAMES, pReference, CHECK_FRAMES, &sUsed, &elapsed);
+    for (k = 1; k < KERNELS; k++) {
+      if (!kernelSupported(kernelNames[k])) {
+        continue;
+      }
+      nFrames = runChannelMapper(kernelNames[k], &pCase->sIn, &pCase->sOut, pCase->bClientMatrix ? &sClient : NULL,
+        pInput, CHECK_FRAMES, pOutput, CHECK_FRAMES, &sUsed, &elapsed);
+      fMaxError = 0;
+      for (f = 0; nFrames > 0 && f < CHECK_FRAMES * pCase->sOut.nChannels; f++) {
+        fError = fabs(readSample(&pCase->sOut, pOutput + f * sampleSize(&pCase->sOut)) -
+                      readSample(&pCase->sOut, pReference + f * sampleSize(&pCase->sOut)));
+        if (fError > fMaxError) {
+          fMaxError = fError;
+        }
+      }
+      DEBUG(DEFAULT_MESSAGES, "%s against scalar, %s: %li frames, largest difference %g\n", kernelNames[k], pCase->sName, nFrames, fMaxError);
+      if (nFrames != CHECK_FRAMES || fMaxError > sampleStep(&pCase->sOut) + ldexp(1, -22)) {
+        DEBUG(DEB_LEV_ERR, "%s differs from the scalar kernel\n", kernelNames[k]);
+        result = 1;
+      }
+    }
+    free(pOutput);
+    free(pReference);
+    free(pInput);
+  }
+  return result;
+}
+
+/** Prints the frames and the channels*samples per second converted by a kernel */
+static void benchmark(const char* sKernel, int nSeconds) {
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sUsed;
+  const mapperCaseType* pCase;
+  OMX_U8 *pInput, *pOutput;
+  OMX_U32 nFrames = nSeconds * 48000, c;
+  long elapsed;
+
+  for (c = 0; c < BENCH_CASES; c++) {
+    pCase = &benchCases[c];
+    pInput = makeSines(&pCase->sIn, nFrames);
+    pOutput = malloc(nFrames * frameSize(&pCase->sOut));
+    if (runChannelMapper(sKernel, &pCase->sIn, &pCase->sOut, NULL, pInput, nFrames, pOutput, nFrames, &sUsed, &elapsed) >= 0) {
+      DEBUG(DEFAULT_MESSAGES, "%-6s %-22s: %i frames in %li us, %.1f M frames/s, %.1f M channels*samples/s, %.0fx real time\n",
+        sKernel, pCase->sName, (int)nFrames, elapsed,
+        (double)nFrames / (elapsed > 0 ? elapsed : 1),
+        (double)nFrames * (pCase->sIn.nChannels + pCase->sOut.nChannels) / (elapsed > 0 ? elapsed : 1),
+        nSeconds * 1000000.0 / (elapsed > 0 ? elapsed : 1));
+    }
+    free(pOutput);
+    free(pInput);
+  }
+}
+
+int main(int argc, char** argv) {
+  OMX_ERRORTYPE err;
+  const char* sKernel = NULL;
+  int nSeconds = DEFAULT_SECONDS;
+  int i, result = 0;
+  OMX_U32 k;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      nSeconds = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-k") && i + 1 < argc) {
+      sKernel = argv[++i];
+    } else {
+      display_help();
+    }
+  }
+  if (nSeconds <= 0) {
+    display_help();
+  }
+
+  /* Initialize application private data */
+  appPriv = calloc(1, sizeof(appPrivateType));
+  pthread_mutex_init(&appPriv->mutex, NULL);
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->doneSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->doneSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  if (sKernel && !kernelSupported(sKernel)) {
+    OMX_Deinit();
+    display_help();
+  }
+
+  result |= checkCasesOutput();
+  result |= checkBadMatrix();
+  result |= checkKernels();
+
+  for (k = 0; k < KERNELS; k++) {
+    if (kernelSupported(kernelNames[k]) && (!sKernel || !strcmp(sKernel, kernelNames[k]))) {
+      benchmark(kernelNames[k], nSeconds);
+    }
+  }
+
+  OMX_Deinit();
+
+  tsem_deinit(appPriv->doneSem);
+  free(appPriv->doneSem);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  pthread_mutex_destroy(&appPriv->mutex);
+  free(appPriv);
+
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result ? "FAILED" : "PASSED");
+  return result;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE channelmapperEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    if (Data1 == OMX_CommandStateSet) {
+      tsem_up(appPriv->eventSem);
+    }
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "Received error event %08x\n", (int)Data1);
+  }
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE channelmapperEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  sendInputBuffer(hComponent, pBuffer);
+  return OMX_ErrorNone;
+}
+
+/** Appends the output frames, interleaving them when the output port is planar */
+OMX_ERRORTYPE channelmapperFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  const mapperFormatType* pFormat = &appPriv->sOut;
+  OMX_U32 nSize = sampleSize(pFormat);
+  OMX_U32 nFrames = pBuffer->nFilledLen / frameSize(pFormat);
+  OMX_U32 nCopied = nFrames, f, c;
+  OMX_U8* pFrames;
+  OMX_BOOL bDone = OMX_FALSE;
+
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->bEOS) {
+    /* the buffers left after the EOS come back empty */
+    pthread_mutex_unlock(&appPriv->mutex);
+    return OMX_ErrorNone;
+  }
+  if (nCopied > appPriv->nOutputMax - appPriv->nOutputFrames) {
+    nCopied = appPriv->nOutputMax - appPriv->nOutputFrames;
+  }
+  pFrames = appPriv->pOutput + appPriv->nOutputFrames * frameSize(pFormat);
+  if (pFormat->bInterleaved) {
+    memcpy(pFrames, pBuffer->pBuffer + pBuffer->nOffset, nCopied * frameSize(pFormat));
+  } else {
+    for (c = 0; c < pFormat->nChannels; c++) {
+      for (f = 0; f < nCopied; f++) {
+        memcpy(pFrames + (f * pFormat->nChannels + c) * nSize, pBuffer->pBuffer + pBuffer->nOffset + (c * nFrames + f) * nSize, nSize);
+      }
+    }
+  }
+  appPriv->nOutputFrames += nCopied;
+  if ((pBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+    appPriv->bEOS = OMX_TRUE;
+    bDone = OMX_TRUE;
+  }
+  pthread_mutex_unlock(&appPriv->mutex);
+  if (bDone) {
+    tsem_up(appPriv->doneSem);
+  } else {
+    pBuffer->nFilledLen = 0;
+    pBuffer->nFlags = 0;
+    OMX_FillThisBuffer(hComponent, pBuffer);
+  }
+  return OMX_ErrorNone;
+}
@@ -0,0 +1,121 @@
+/**
+  test/components/audio_effects/omxchannelmappertest.h
+
+  This test application checks the downmix, the upmix and the format
+  conversions of the channel mapper component, and measures its speed.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXCHANNELMAPPERTEST_H__
+#define __OMXCHANNELMAPPERTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/extension_struct.h>
+#include <user_debug_levels.h>
+
+/** Specification version of the core */
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    0
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+#include <kernel_test.h>
+
+/** The environment variable naming the kernel of the channel mapper */
+#define CHANNELMAPPER_KERNEL_ENV "OMX_BELLAGIO_CHANNELMAPPER_KERNEL"
+
+/** Default seconds of audio converted by each benchmark run */
+#define DEFAULT_SECONDS 20
+
+/** Frames of the checks, not a multiple of the frames of a buffer */
+#define CHECK_FRAMES 48123
+
+/** Amplitude of the sines converted, a different frequency on each channel */
+#define SINE_AMPLITUDE 0.9
+
+/** Frames filled in each input buffer */
+#define INPUT_FRAMES 1024
+
+/** Size of the buffers allocated on each port, room for INPUT_FRAMES of 8 channels of 32 bits */
+#define PORT_BUFFER_SIZE (32 * 1024)
+
+/** Number of buffers allocated on each port */
+#define PORT_BUFFERS 4
+
+/** The layout of the samples on a port */
+typedef struct mapperFormatType {
+  OMX_U32 nChannels;
+  OMX_U32 nBitPerSample;
+  OMX_BOOL bFloat;
+  OMX_BOOL bInterleaved;
+} mapperFormatType;
+
+/* Application's private data */
+typedef struct appPrivateType{
+  tsem_t* eventSem;
+  tsem_t* doneSem;
+  OMX_HANDLETYPE handle;
+  mapperFormatType sIn;
+  mapperFormatType sOut;
+  const OMX_U8* pInput;
+  OMX_U32 nInputFrames;
+  OMX_U32 nInputSent;
+  OMX_U8* pOutput;
+  OMX_U32 nOutputMax;
+  OMX_U32 nOutputFrames;
+  OMX_BOOL bEOS;
+  pthread_mutex_t mutex;
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE channelmapperEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE channelmapperEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE channelmapperFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
@@ -0,0 +1,256 @@
+/**
+  test/components/audio_effects/omxlookuptest.c
+
+  This test application measures the latency of the lookups of the core,
+  OMX_GetHandle, OMX_GetRolesOfComponent and OMX_GetComponentsOfRole,
+  with a registry holding some hundreds of components besides the
+  volume control component.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxlookuptest.h"
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = lookupEventHandler,
+                               .EmptyBufferDone = lookupEmptyBufferDone,
+                               .FillBufferDone = lookupFillBufferDone,
+};
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxlookuptest [-c components] [-n iterations]\n");
+  printf("\n");
+  printf("       -c components: number of components added to the registry, default %d\n", DEFAULT_COMPONENTS);
+  printf("       -n iterations: number of calls measured for each function, default %d\n", DEFAULT_ITERATIONS);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+static void report(const char* name, struct timeval* start, struct timeval* end, int iterations) {
+  printf("%-28s %10.2f us\n", name, (double)elapsed_us(start, end) / iterations);
+}
+
+/** Writes a registry with nComponents components, in libraries that do not
+ * exist and are never loaded, followed by the content of the registry of the
+ * user, so that the real components are found after all the others
+ */
+static int writeRegistry(const char* filename, const char* userRegistry, int nComponents) {
+  FILE *out, *in;
+  char line[1024];
+  int i, j;
+
+  out = fopen(filename, "w");
+  if (out == NULL) {
+    return -1;
+  }
+  for (i = 0; i < nComponents; i++) {
+    if (i % 4 == 0) {
+      fprintf(out, "/nonexistent/libomxlookup%d.so\n", i / 4);
+    }
+    fprintf(out, " ==> OMX.lookup.component%d ==> ", i);
+    for (j = 0; j < SPECIFICS_PER_COMPONENT; j++) {
+      fprintf(out, "OMX.lookup.component%d.format%d:", i, j);
+    }
+    fprintf(out, "\n --> ");
+    for (j = 0; j < SPECIFICS_PER_COMPONENT; j++) {
+      fprintf(out, "lookup_role.role%d:", (i + j) % ROLES);
+    }
+    fprintf(out, "\n");
+  }
+  in = fopen(userRegistry, "r");
+  if (in == NULL) {
+    fclose(out);
+    return -1;
+  }
+  while (fgets(line, sizeof(line), in) != NULL) {
+    fputs(line, out);
+  }
+  fclose(in);
+  fclose(out);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  OMX_ERRORTYPE err;
+  OMX_HANDLETYPE handle, handleKept;
+  OMX_U8* names[DEFAULT_COMPONENTS];
+  OMX_U8* roles[SPECIFICS_PER_COMPONENT];
+  OMX_U32 nNumber;
+  struct timeval start, end;
+  char registry[] = "/tmp/omxlookuptest.XXXXXX";
+  char lastName[OMX_MAX_STRINGNAME_SIZE];
+  char* userRegistry;
+  int nComponents = DEFAULT_COMPONENTS;
+  int nIterations = DEFAULT_ITERATIONS;
+  int expected = 0;
+  int i, j, fd, result = 0;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+      nComponents = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      nIterations = atoi(argv[++i]);
+    } else {
+      display_help();
+    }
+  }
+  if (nComponents <= 0 || nIterations <= 0) {
+    display_help();
+  }
+
+  /* the registry of the user gives the real components */
+  userRegistry = componentsRegistryGetFilename();
+  fd = mkstemp(registry);
+  if (fd < 0) {
+    DEBUG(DEB_LEV_ERR, "Cannot create the temporary registry\n");
+    exit(1);
+  }
+  close(fd);
+  if (writeRegistry(registry, userRegistry, nComponents) != 0) {
+    DEBUG(DEB_LEV_ERR, "Cannot write the temporary registry from %s\n", userRegistry);
+    unlink(registry);
+    exit(1);
+  }
+  free(userRegistry);
+  setenv("OMX_BELLAGIO_REGISTRY", registry, 1);
+
+  gettimeofday(&start, NULL);
+  err = OMX_Init();
+  gettimeofday(&end, NULL);
+  unlink(registry);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  printf("%d components registered\n", nComponents);
+  report("OMX_Init", &start, &end, 1);
+
+  /* an instance is kept, so that the library of the volume component
+   * stays loaded and only the lookup and the construction are measured */
+  err = OMX_GetHandle(&handleKept, "OMX.st.volume.component", NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed, is the volume component registered?\n");
+    exit(1);
+  }
+  gettimeofday(&start, NULL);
+  for (i = 0; i < HANDLE_ITERATIONS; i++) {
+    err = OMX_GetHandle(&handle, "OMX.st.volume.component", NULL, &callbacks);
+    if(err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+      exit(1);
+    }
+    OMX_FreeHandle(handle);
+  }
+  gettimeofday(&end, NULL);
+  report("OMX_GetHandle+FreeHandle", &start, &end, HANDLE_ITERATIONS);
+  OMX_FreeHandle(handleKept);
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < nIterations; i++) {
+    err = OMX_GetHandle(&handle, "OMX.lookup.missing", NULL, &callbacks);
+  }
+  gettimeofday(&end, NULL);
+  if (err != OMX_ErrorComponentNotFound) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle of a missing component returns %x\n", err);
+    result = 1;
+  }
+  report("OMX_GetHandle (not found)", &start, &end, nIterations);
+
+  /* the last component added is the worst case of a linear search */
+  for (j = 0; j < SPECIFICS_PER_COMPONENT; j++) {
+    roles[j] = malloc(OMX_MAX_STRINGNAME_SIZE);
+  }
+  snprintf(lastName, sizeof(lastName), "OMX.lookup.component%d", nComponents - 1);
+  gettimeofday(&start, NULL);
+  for (i = 0; i < nIterations; i++) {
+    nNumber = SPECIFICS_PER_COMPONENT;
+    err = OMX_GetRolesOfComponent(lastName, &nNumber, roles);
+  }
+  gettimeofday(&end, NULL);
+  if (err != OMX_ErrorNone || nNumber != SPECIFICS_PER_COMPONENT) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetRolesOfComponent of %s returns %x, %i roles\n", lastName, err, (int)nNumber);
+    result = 1;
+  }
+  report("OMX_GetRolesOfComponent", &start, &end, nIterations);
+
+  /* every role is given to SPECIFICS_PER_COMPONENT components out of ROLES */
+  for (i = 0; i < nComponents; i++) {
+    for (j = 0; j < SPECIFICS_PER_COMPONENT; j++) {
+      if ((i + j) % ROLES == 0) {
+        expected++;
+      }
+    }
+  }
+  for (i = 0; i < DEFAULT_COMPONENTS; i++) {
+    names[i] = malloc(OMX_MAX_STRINGNAME_SIZE);
+  }
+  gettimeofday(&start, NULL);
+  for (i = 0; i < nIterations; i++) {
+    nNumber = DEFAULT_COMPONENTS;
+    err = OMX_GetComponentsOfRole("lookup_role.role0", &nNumber, names);
+  }
+  gettimeofday(&end, NULL);
+  if (err != OMX_ErrorNone || nNumber != expected) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetComponentsOfRole returns %x, %i components instead of %i\n", err, (int)nNumber, expected);
+    result = 1;
+  } else if (strcmp((char*)names[0], "OMX.lookup.component0")) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetComponentsOfRole returns %s first\n", names[0]);
+    result = 1;
+  }
+  report("OMX_GetComponentsOfRole", &start, &end, nIterations);
+
+  for (i = 0; i < DEFAULT_COMPONENTS; i++) {
+    free(names[i]);
+  }
+  for (j = 0; j < SPECIFICS_PER_COMPONENT; j++) {
+    free(roles[j]);
+  }
+  OMX_Deinit();
+  return result;
+}
+
+OMX_ERRORTYPE lookupEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE lookupEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE lookupFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  return OMX_ErrorNone;
+}
@@ -0,0 +1,79 @@
+/**
+  test/components/audio_effects/omxlookuptest.h
+
+  This test application measures the latency of the lookups of the core,
+  OMX_GetHandle, OMX_GetRolesOfComponent and OMX_GetComponentsOfRole,
+  with a registry holding some hundreds of components besides the
+  volume control component.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXLOOKUPTEST_H__
+#define __OMXLOOKUPTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+
+#include <bellagio/common.h>
+#include <user_debug_levels.h>
+
+/** Default number of components added to the registry */
+#define DEFAULT_COMPONENTS 400
+
+/** Default number of calls measured for each function */
+#define DEFAULT_ITERATIONS 10000
+
+/** Number of calls of OMX_GetHandle of the volume component, each one builds a component */
+#define HANDLE_ITERATIONS 200
+
+/** Number of specific names, and of roles, of each component added */
+#define SPECIFICS_PER_COMPONENT 3
+
+/** Number of different roles of the components added */
+#define ROLES 16
+
+/* Callback prototypes */
+OMX_ERRORTYPE lookupEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE lookupEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE lookupFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
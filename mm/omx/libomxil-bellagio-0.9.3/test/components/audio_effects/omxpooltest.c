@@ -0,0 +1,192 @@
+/**
+  test/components/audio_effects/omxpooltest.c
+
+  This test application measures the round trip of OMX_GetHandle and
+  OMX_FreeHandle of the volume control component, with and without a
+  pool of instances built in advance.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+
+#include "omxpooltest.h"
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = poolEventHandler,
+                               .EmptyBufferDone = poolEmptyBufferDone,
+                               .FillBufferDone = poolFillBufferDone,
+};
+
+/** Set by the event handler when the command sent is complete */
+static volatile int commandComplete;
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxpooltest [-n iterations] [-p instances] [-w pause]\n");
+  printf("\n");
+  printf("       -n iterations: number of round trips measured, default %d\n", DEFAULT_ITERATIONS);
+  printf("       -p instances: number of instances kept in the pool, default %d\n", DEFAULT_POOL_SIZE);
+  printf("       -w pause: pause between two round trips in microseconds, default %d\n", DEFAULT_PAUSE);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+/** Checks that an instance handed out by OMX_GetHandle delivers its events
+ * to the callbacks and the private data of the client
+ */
+static int checkCallbacks() {
+  OMX_HANDLETYPE handle;
+  OMX_ERRORTYPE err;
+  int i;
+
+  err = OMX_GetHandle(&handle, POOL_COMPONENT, (OMX_PTR)&commandComplete, &callbacks);
+  if (err != OMX_ErrorNone) {
+    return -1;
+  }
+  commandComplete = 0;
+  err = OMX_SendCommand(handle, OMX_CommandPortDisable, OMX_ALL, NULL);
+  for (i = 0; i < 1000 && commandComplete == 0; i++) {
+    usleep(1000);
+  }
+  OMX_FreeHandle(handle);
+  return (err == OMX_ErrorNone && commandComplete != 0) ? 0 : -1;
+}
+
+static int measure(const char* label, int nIterations, int nPause) {
+  OMX_ERRORTYPE err;
+  OMX_HANDLETYPE handle, handleKept;
+  OMX_STATETYPE state;
+  struct timeval start, middle, end;
+  long getTime = 0, freeTime = 0;
+  int i;
+
+  err = OMX_Init();
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    return -1;
+  }
+  /* an instance is kept, so that the library of the volume component
+   * stays loaded and only the construction is measured */
+  err = OMX_GetHandle(&handleKept, POOL_COMPONENT, NULL, &callbacks);
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed, is the volume component registered?\n");
+    OMX_Deinit();
+    return -1;
+  }
+  usleep(nPause);
+  for (i = 0; i < nIterations; i++) {
+    gettimeofday(&start, NULL);
+    err = OMX_GetHandle(&handle, POOL_COMPONENT, NULL, &callbacks);
+    gettimeofday(&middle, NULL);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+      break;
+    }
+    err = OMX_GetState(handle, &state);
+    if (err != OMX_ErrorNone || state != OMX_StateLoaded) {
+      DEBUG(DEB_LEV_ERR, "The component is not in the Loaded state\n");
+      break;
+    }
+    OMX_FreeHandle(handle);
+    gettimeofday(&end, NULL);
+    getTime += elapsed_us(&start, &middle);
+    freeTime += elapsed_us(&middle, &end);
+    usleep(nPause);
+  }
+  if (i == nIterations && checkCallbacks() != 0) {
+    DEBUG(DEB_LEV_ERR, "The events of the component do not reach the client\n");
+    i = 0;
+  }
+  OMX_FreeHandle(handleKept);
+  OMX_Deinit();
+  if (i < nIterations) {
+    return -1;
+  }
+  printf("%s\n", label);
+  printf("  %-26s %10.2f us\n", "OMX_GetHandle", (double)getTime / nIterations);
+  printf("  %-26s %10.2f us\n", "OMX_FreeHandle", (double)freeTime / nIterations);
+  printf("  %-26s %10.2f us\n", "round trip", (double)(getTime + freeTime) / nIterations);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  char config[OMX_MAX_STRINGNAME_SIZE + 16];
+  int nIterations = DEFAULT_ITERATIONS;
+  int nInstances = DEFAULT_POOL_SIZE;
+  int nPause = DEFAULT_PAUSE;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      nIterations = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+      nInstances = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-w") && i + 1 < argc) {
+      nPause = atoi(argv[++i]);
+    } else {
+      display_help();
+    }
+  }
+  if (nIterations <= 0 || nInstances <= 0 || nPause < 0) {
+    display_help();
+  }
+
+  unsetenv("OMX_BELLAGIO_POOL");
+  if (measure("without pool", nIterations, nPause) != 0) {
+    exit(1);
+  }
+  snprintf(config, sizeof(config), "%s=%d", POOL_COMPONENT, nInstances);
+  setenv("OMX_BELLAGIO_POOL", config, 1);
+  if (measure("with pool", nIterations, nPause) != 0) {
+    exit(1);
+  }
+  return 0;
+}
+
+OMX_ERRORTYPE poolEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+  if (eEvent == OMX_EventCmdComplete && Data1 == OMX_CommandPortDisable && pAppData == (OMX_PTR)&commandComplete) {
+    commandComplete = 1;
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE poolEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE poolFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  return OMX_ErrorNone;
+}
@@ -0,0 +1,76 @@
+/**
+  test/components/audio_effects/omxpooltest.h
+
+  This test application measures the round trip of OMX_GetHandle and
+  OMX_FreeHandle of the volume control component, with and without a
+  pool of instances built in advance.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXPOOLTEST_H__
+#define __OMXPOOLTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+
+#include <user_debug_levels.h>
+
+/** The component measured */
+#define POOL_COMPONENT "OMX.st.volume.component"
+
+/** Default number of round trips measured */
+#define DEFAULT_ITERATIONS 200
+
+/** Default number of instances kept in the pool */
+#define DEFAULT_POOL_SIZE 2
+
+/** Default pause between two round trips, in microseconds, that leaves
+ * the pool the time to build a new instance, as an IL client does between
+ * two changes of channel */
+#define DEFAULT_PAUSE 5000
+
+/* Callback prototypes */
+OMX_ERRORTYPE poolEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE poolEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE poolFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
@@ -0,0 +1,522 @@
+/**
+  test/components/audio_effects/omxresamplertest.c
+
+  This test application checks the output of the audio resampler component,
+  for each kernel and quality level, and measures its speed.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxresamplertest.h"
+
+appPrivateType* appPriv;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = resamplerEventHandler,
+                               .EmptyBufferDone = resamplerEmptyBufferDone,
+                               .FillBufferDone = resamplerFillBufferDone,
+};
+
+/** The kernels of the resampler, a kernel not supported by the CPU being skipped */
+static const char* kernelNames[] = { "scalar", "sse", "avx2", "neon" };
+#define KERNELS (sizeof(kernelNames) / sizeof(kernelNames[0]))
+
+/** Least signal to noise ratio of each quality level, in dB */
+static const double minSNR[QUALITY_LEVELS] = { 70.0, 55.0, 40.0 };
+
+/** The rates checked, input then output */
+static const OMX_U32 checkRates[][2] = {
+  { 44100, 48000 },
+  { 48000, 44100 },
+  { 22050, 44100 },
+  { 48000, 32000 },
+  { 44100, 8000 }
+};
+#define CHECK_RATES (sizeof(checkRates) / sizeof(checkRates[0]))
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxresamplertest [-s seconds] [-c channels] [-k kernel]\n");
+  printf("\n");
+  printf("       -s seconds: seconds of audio resampled by each benchmark run, default %d\n", DEFAULT_SECONDS);
+  printf("       -c channels: channels of the benchmark, default 2\n");
+  printf("       -k kernel: benchmark only this kernel, scalar, sse, avx2 or neon\n");
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+/** Whether the component runs a kernel, when built in and supported by the CPU */
+static int kernelSupported(const char* sKernel) {
+  return kernelSelected("OMX.st.audio.resampler", RESAMPLER_KERNEL_ENV, sKernel, &callbacks);
+}
+
+/** Fills the samples of a sine, a different phase on each channel */
+static OMX_S16* makeSine(OMX_U32 nFrames, OMX_U32 nChannels, OMX_U32 nRate) {
+  OMX_S16* pSamples = malloc(nFrames * nChannels * sizeof(OMX_S16));
+  OMX_U32 i, c;
+
+  for (i = 0; i < nFrames; i++) {
+    for (c = 0; c < nChannels; c++) {
+      pSamples[i * nChannels + c] = (OMX_S16) lrint(32767 * SINE_AMPLITUDE * sin(2 * M_PI * SINE_FREQUENCY * i / nRate + c));
+    }
+  }
+  return pSamples;
+}
+
+/** Returns the signal to noise ratio of the output against the sine at the output rate */
+static double measureSNR(const OMX_S16* pOutput, OMX_U32 nFrames, OMX_U32 nChannels, OMX_U32 nRate) {
+  double fSignal = 0, fNoise = 0, fExpected;
+  OMX_U32 i, c;
+
+  for (i = EDGE_FRAMES; i + EDGE_FRAMES < nFrames; i++) {
+    for (c = 0; c < nChannels; c++) {
+      fExpected = 32767 * SINE_AMPLITUDE * sin(2 * M_PI * SINE_FREQUENCY * i / nRate + c);
+      fSignal += fExpected * fExpected;
+      fNoise += (pOutput[i * nChannels + c] - fExpected) * (pOutput[i * nChannels + c] - fExpected);
+    }
+  }
+  return 10 * log10(fSignal / (fNoise > 0 ? fNoise : 1e-9));
+}
+
+/** Sets the rate and the channels of a port of the component */
+static void setPortPcm(OMX_HANDLETYPE handle, OMX_U32 nPortIndex, OMX_U32 nRate, OMX_U32 nChannels) {
+  OMX_AUDIO_PARAM_PCMMODETYPE sPcmMode;
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_ERRORTYPE err;
+
+  setHeader(&sPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+  sPcmMode.nPortIndex = nPortIndex;
+  err = OMX_GetParameter(handle, OMX_IndexParamAudioPcm, &sPcmMode);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the port %i PCM mode\n", (int)nPortIndex);
+    exit(1);
+  }
+  sPcmMode.nSamplingRate = nRate;
+  sPcmMode.nChannels = nChannels;
+  err = OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcmMode);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in setting the port %i PCM mode\n", (int)nPortIndex);
+    exit(1);
+  }
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = nPortIndex;
+  err = OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+  sPortDef.nBufferCountActual = PORT_BUFFERS;
+  err = OMX_SetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in setting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+}
+
+/** Copies the next input frames in a buffer and sends it, doing nothing when all
+ * are sent. The buffer is sent under the mutex, so that the main thread and the
+ * EmptyBufferDone callback send the frames in order.
+ */
+static OMX_ERRORTYPE sendInputBuffer(OMX_HANDLETYPE handle, OMX_BUFFERHEADERTYPE* pBuffer) {
+  OMX_U32 nFrames;
+  OMX_ERRORTYPE err;
+
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->nInputSent >= appPriv->nInputFrames) {
+    pthread_mutex_unlock(&appPriv->mutex);
+    return OMX_ErrorNone;
+  }
+  nFrames = appPriv->nInputFrames - appPriv->nInputSent;
+  if (nFrames > INPUT_FRAMES) {
+    nFrames = INPUT_FRAMES;
+  }
+  memcpy(pBuffer->pBuffer, appPriv->pInput + appPriv->nInputSent * appPriv->nChannels, nFrames * appPriv->nChannels * sizeof(OMX_S16));
+  pBuffer->nFilledLen = nFrames * appPriv->nChannels * sizeof(OMX_S16);
+  pBuffer->nOffset = 0;
+  appPriv->nInputSent += nFrames;
+  pBuffer->nFlags = (appPriv->nInputSent == appPriv->nInputFrames) ? OMX_BUFFERFLAG_EOS : 0;
+  /* the resource manager may lower the quality level while the component is executing */
+  if (appPriv->nSwitchLevel && appPriv->nInputSent >= appPriv->nSwitchFrame) {
+    setQualityLevel(handle, appPriv->nSwitchLevel);
+    appPriv->nSwitchLevel = 0;
+  }
+  err = OMX_EmptyThisBuffer(handle, pBuffer);
+  pthread_mutex_unlock(&appPriv->mutex);
+  return err;
+}
+
+/** Resamples the input with a kernel, NULL for the default one, from a quality level
+ * switched to nSwitchLevel halfway if not zero. Returns the output frames, or -1.
+ */
+static long runResampler(const char* sKernel, OMX_U32 nLevel, OMX_U32 nSwitchLevel,
+                         OMX_U32 nRateIn, OMX_U32 nRateOut, OMX_U32 nChannels,
+                         const OMX_S16* pInput, OMX_U32 nInputFrames,
+                         OMX_S16* pOutput, OMX_U32 nOutputMax, long* pElapsed) {
+  OMX_BUFFERHEADERTYPE *inBuffer[PORT_BUFFERS], *outBuffer[PORT_BUFFERS];
+  struct timeval start, end;
+  OMX_ERRORTYPE err;
+  int i;
+
+  if (sKernel) {
+    setenv(RESAMPLER_KERNEL_ENV, sKernel, 1);
+  } else {
+    unsetenv(RESAMPLER_KERNEL_ENV);
+  }
+  appPriv->nChannels = nChannels;
+  appPriv->pInput = pInput;
+  appPriv->nInputFrames = nInputFrames;
+  appPriv->nInputSent = 0;
+  appPriv->pOutput = pOutput;
+  appPriv->nOutputMax = nOutputMax;
+  appPriv->nOutputFrames = 0;
+  appPriv->nSwitchFrame = nInputFrames / 2;
+  appPriv->nSwitchLevel = nSwitchLevel;
+  appPriv->bEOS = OMX_FALSE;
+
+  err = OMX_GetHandle(&appPriv->handle, "OMX.st.audio.resampler", NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    return -1;
+  }
+  setPortPcm(appPriv->handle, 0, nRateIn, nChannels);
+  setPortPcm(appPriv->handle, 1, nRateOut, nChannels);
+  err = setQualityLevel(appPriv->handle, nLevel);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "Error in setting the quality level %i\n", (int)nLevel);
+    return -1;
+  }
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_AllocateBuffer(appPriv->handle, &inBuffer[i], 0, NULL, PORT_BUFFER_SIZE);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer in %i %i\n", i, err);
+      return -1;
+    }
+    err = OMX_AllocateBuffer(appPriv->handle, &outBuffer[i], 1, NULL, PORT_BUFFER_SIZE);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer out %i %i\n", i, err);
+      return -1;
+    }
+  }
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    outBuffer[i]->nFilledLen = 0;
+    err = OMX_FillThisBuffer(appPriv->handle, outBuffer[i]);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on FillThisBuffer %i\n", err);
+      return -1;
+    }
+  }
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = sendInputBuffer(appPriv->handle, inBuffer[i]);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on EmptyThisBuffer %i\n", err);
+      return -1;
+    }
+  }
+  tsem_down(appPriv->doneSem);
+  gettimeofday(&end, NULL);
+  *pElapsed = elapsed_us(&start, &end);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_FreeBuffer(appPriv->handle, 0, inBuffer[i]);
+    err = OMX_FreeBuffer(appPriv->handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+
+  OMX_FreeHandle(appPriv->handle);
+  appPriv->handle = NULL;
+  return appPriv->nOutputFrames;
+}
+
+/** The output has ceil(frames * out / in) frames, the sine resampled at the SNR of
+ * the quality level, at each level and for each ratio
+ */
+static int checkQuality(const char* sKernel) {
+  OMX_U32 nRateIn, nRateOut, nInputFrames, nExpected, nLevel, r;
+  OMX_S16 *pInput, *pOutput;
+  long nFrames, elapsed;
+  double fSNR;
+  int result = 0;
+
+  for (r = 0; r < CHECK_RATES; r++) {
+    nRateIn = checkRates[r][0];
+    nRateOut = checkRates[r][1];
+    nInputFrames = CHECK_SECONDS * nRateIn + 123;
+    nExpected = (OMX_U32)(((OMX_U64)nInputFrames * nRateOut + nRateIn - 1) / nRateIn);
+    pInput = makeSine(nInputFrames, 2, nRateIn);
+    pOutput = malloc((nExpected + 1024) * 2 * sizeof(OMX_S16));
+    for (nLevel = 1; nLevel <= QUALITY_LEVELS; nLevel++) {
+      nFrames = runResampler(sKernel, nLevel, 0, nRateIn, nRateOut, 2, pInput, nInputFrames, pOutput, nExpected + 1024, &elapsed);
+      fSNR = (nFrames > 0) ? measureSNR(pOutput, nFrames, 2, nRateOut) : 0;
+      DEBUG(DEFAULT_MESSAGES, "%s level %i %i->%i Hz: %li frames of %i, SNR %.1f dB\n", sKernel, (int)nLevel,
+        (int)nRateIn, (int)nRateOut, nFrames, (int)nExpected, fSNR);
+      if (nFrames != nExpected || fSNR < minSNR[nLevel - 1]) {
+        DEBUG(DEB_LEV_ERR, "%s level %i %i->%i Hz is wrong\n", sKernel, (int)nLevel, (int)nRateIn, (int)nRateOut);
+        result = 1;
+      }
+    }
+    free(pOutput);
+    free(pInput);
+  }
+  return result;
+}
+
+/** The kernels give the same output as the scalar one, give or take rounding */
+static int checkKernels() {
+  OMX_U32 nInputFrames = CHECK_SECONDS * 44100;
+  OMX_U32 nOutputMax = CHECK_SECONDS * 48000 + 1024;
+  OMX_S16 *pInput, *pReference, *pOutput;
+  long nFrames, nReference, elapsed, i;
+  int nDiff, nMaxDiff, result = 0;
+  OMX_U32 k;
+
+  pInput = makeSine(nInputFrames, 2, 44100);
+  pReference = malloc(nOutputMax * 2 * sizeof(OMX_S16));
+  pOutput = malloc(nOutputMax * 2 * sizeof(OMX_S16));
+  nReference = runResampler("scalar", 1, 0, 44100, 48000, 2, pInput, nInputFrames, pReference, nOutputMax, &elapsed);
+  for (k = 1; k < KERNELS; k++) {
+    if (!kernelSupported(kernelNames[k])) {
+      continue;
+    }
+    nFrames = runResampler(kernelNames[k], 1, 0, 44100, 48000, 2, pInput, nInputFrames, pOutput, nOutputMax, &elapsed);
+    nMaxDiff = 0;
+    for (i = 0; i < nFrames * 2 && i < nReference * 2; i++) {
+      nDiff = abs(pOutput[i] - pReference[i]);
+      if (nDiff > nMaxDiff) {
+        nMaxDiff = nDiff;
+      }
+    }
+    DEBUG(DEFAULT_MESSAGES, "%s against scalar: %li frames of %li, largest difference %i\n", kernelNames[k], nFrames, nReference, nMaxDiff);
+    if (nFrames != nReference || nMaxDiff > 2) {
+      DEBUG(DEB_LEV_ERR, "%s differs from the scalar kernel\n", kernelNames[k]);
+      result = 1;
+    }
+  }
+  free(pOutput);
+  free(pReference);
+  free(pInput);
+  return result;
+}
+
+/** A quality level changed halfway keeps the stream in step */
+static int checkLevelSwitch() {
+  static const OMX_U32 switches[][2] = { { 1, 3 }, { 3, 1 } };
+  OMX_U32 nInputFrames = CHECK_SECONDS * 44100;
+  OMX_U32 nExpected = CHECK_SECONDS * 48000;
+  OMX_S16 *pInput, *pOutput;
+  long nFrames, elapsed;
+  double fSNR;
+  int result = 0;
+  OMX_U32 s;
+
+  pInput = makeSine(nInputFrames, 2, 44100);
+  pOutput = malloc((nExpected + 1024) * 2 * sizeof(OMX_S16));
+  for (s = 0; s < sizeof(switches) / sizeof(switches[0]); s++) {
+    nFrames = runResampler(NULL, switches[s][0], switches[s][1], 44100, 48000, 2, pInput, nInputFrames, pOutput, nExpected + 1024, &elapsed);
+    fSNR = (nFrames > 0) ? measureSNR(pOutput, nFrames, 2, 48000) : 0;
+    DEBUG(DEFAULT_MESSAGES, "level %i then %i: %li frames of %i, SNR %.1f dB\n", (int)switches[s][0], (int)switches[s][1],
+      nFrames, (int)nExpected, fSNR);
+    if (nFrames != nExpected || fSNR < minSNR[QUALITY_LEVELS - 1]) {
+      DEBUG(DEB_LEV_ERR, "the switch from level %i to %i is wrong\n", (int)switches[s][0], (int)switches[s][1]);
+      result = 1;
+    }
+  }
+  free(pOutput);
+  free(pInput);
+  return result;
+}
+
+/** Prints the channels*samples per second of the input resampled by a kernel at each level */
+static void benchmark(const char* sKernel, int nSeconds, OMX_U32 nChannels) {
+  static const OMX_U32 benchRates[][2] = { { 44100, 48000 }, { 48000, 44100 } };
+  OMX_S16 *pInput, *pOutput;
+  OMX_U32 nInputFrames, nOutputMax, nLevel, r;
+  long nFrames, elapsed;
+
+  for (r = 0; r < sizeof(benchRates) / sizeof(benchRates[0]); r++) {
+    nInputFrames = nSeconds * benchRates[r][0];
+    nOutputMax = nSeconds * benchRates[r][1] + 1024;
+    pInput = makeSine(nInputFrames, nChannels, benchRates[r][0]);
+    pOutput = malloc(nOutputMax * nChannels * sizeof(OMX_S16));
+    for (nLevel = 1; nLevel <= QUALITY_LEVELS; nLevel++) {
+      nFrames = runResampler(sKernel, nLevel, 0, benchRates[r][0], benchRates[r][1], nChannels,
+        pInput, nInputFrames, pOutput, nOutputMax, &elapsed);
+      DEBUG(DEFAULT_MESSAGES, "%-6s level %i %i->%i Hz: %i channels, %i frames in %li us, %.1f M channels*samples/s, %.0fx real time\n",
+        sKernel, (int)nLevel, (int)benchRates[r][0], (int)benchRates[r][1], (int)nChannels, (int)nInputFrames, elapsed,
+        (double)nInputFrames * nChannels / (elapsed > 0 ? elapsed : 1),
+        nSeconds * 1000000.0 / (elapsed > 0 ? elapsed : 1));
+      if (nFrames < 0) {
+        break;
+      }
+    }
+    free(pOutput);
+    free(pInput);
+  }
+}
+
+int main(int argc, char** argv) {
+  OMX_ERRORTYPE err;
+  const char* sKernel = NULL;
+  int nSeconds = DEFAULT_SECONDS;
+  int nChannels = 2;
+  int i, result = 0;
+  OMX_U32 k;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      nSeconds = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+      nChannels = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-k") && i + 1 < argc) {
+      sKernel = argv[++i];
+    } else {
+      display_help();
+    }
+  }
+  if (nSeconds <= 0 || nChannels <= 0 || nChannels > 8) {
+    display_help();
+  }
+
+  /* Initialize application private data */
+  appPriv = calloc(1, sizeof(appPrivateType));
+  pthread_mutex_init(&appPriv->mutex, NULL);
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->doneSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->doneSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  if (sKernel && !kernelSupported(sKernel)) {
+    OMX_Deinit();
+    display_help();
+  }
+
+  result |= checkQuality("scalar");
+  result |= checkKernels();
+  result |= checkLevelSwitch();
+
+  for (k = 0; k < KERNELS; k++) {
+    if (kernelSupported(kernelNames[k]) && (!sKernel || !strcmp(sKernel, kernelNames[k]))) {
+      benchmark(kernelNames[k], nSeconds, nChannels);
+    }
+  }
+
+  OMX_Deinit();
+
+  tsem_deinit(appPriv->doneSem);
+  free(appPriv->doneSem);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  pthread_mutex_destroy(&appPriv->mutex);
+  free(appPriv);
+
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result ? "FAILED" : "PASSED");
+  return result;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE resamplerEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    if (Data1 == OMX_CommandStateSet) {
+      tsem_up(appPriv->eventSem);
+    }
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "Received error event %08x\n", (int)Data1);
+  }
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE resamplerEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  sendInputBuffer(hComponent, pBuffer);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE resamplerFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  OMX_U32 nFrames = pBuffer->nFilledLen / (appPriv->nChannels * sizeof(OMX_S16));
+  OMX_BOOL bDone = OMX_FALSE;
+
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->bEOS) {
+    /* the buffers left after the EOS come back empty */
+    pthread_mutex_unlock(&appPriv->mutex);
+    return OMX_ErrorNone;
+  }
+  if (nFrames > appPriv->nOutputMax - appPriv->nOutputFrames) {
+    nFrames = appPriv->nOutputMax - appPriv->nOutputFrames;
+  }
+  memcpy(appPriv->pOutput + appPriv->nOutputFrames * appPriv->nChannels, pBuffer->pBuffer + pBuffer->nOffset,
+    nFrames * appPriv->nChannels * sizeof(OMX_S16));
+  appPriv->nOutputFrames += nFrames;
+  if ((pBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+    appPriv->bEOS = OMX_TRUE;
+    bDone = OMX_TRUE;
+  }
+  pthread_mutex_unlock(&appPriv->mutex);
+  if (bDone) {
+    tsem_up(appPriv->doneSem);
+  } else {
+    pBuffer->nFilledLen = 0;
+    pBuffer->nFlags = 0;
+    OMX_FillThisBuffer(hComponent, pBuffer);
+  }
+  return OMX_ErrorNone;
+}
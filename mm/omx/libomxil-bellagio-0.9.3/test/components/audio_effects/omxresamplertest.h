@@ -0,0 +1,122 @@
+/**
+  test/components/audio_effects/omxresamplertest.h
+
+  This test application checks the output of the audio resampler component,
+  for each kernel and quality level, and measures its speed.
+
+  packing the input buffers in bigger output buffers.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXRESAMPLERTEST_H__
+#define __OMXRESAMPLERTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/OMXComponentRMExt.h>
+#include <user_debug_levels.h>
+
+/** Specification version of the core */
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    0
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+#include <kernel_test.h>
+
+/** The environment variable naming the kernel of the resampler */
+#define RESAMPLER_KERNEL_ENV "OMX_BELLAGIO_RESAMPLER_KERNEL"
+
+/** Quality levels of the resampler */
+#define QUALITY_LEVELS 3
+
+/** Default seconds of audio resampled by each benchmark run */
+#define DEFAULT_SECONDS 10
+
+/** Seconds of audio of the checks */
+#define CHECK_SECONDS 1
+
+/** Frequency and amplitude of the sine resampled */
+#define SINE_FREQUENCY 1000.0
+#define SINE_AMPLITUDE 0.5
+
+/** Output frames left out of the signal to noise ratio at each end */
+#define EDGE_FRAMES 256
+
+/** Frames filled in each input buffer */
+#define INPUT_FRAMES 1000
+
+/** Size of the buffers allocated on each port, the default of the component */
+#define PORT_BUFFER_SIZE (32 * 1024)
+
+/** Number of buffers allocated on each port */
+#define PORT_BUFFERS 4
+
+/* Application's private data */
+typedef struct appPrivateType{
+  tsem_t* eventSem;
+  tsem_t* doneSem;
+  OMX_HANDLETYPE handle;
+  OMX_U32 nChannels;
+  const OMX_S16* pInput;
+  OMX_U32 nInputFrames;
+  OMX_U32 nInputSent;
+  OMX_S16* pOutput;
+  OMX_U32 nOutputMax;
+  OMX_U32 nOutputFrames;
+  OMX_U32 nSwitchFrame;
+  OMX_U32 nSwitchLevel;
+  OMX_BOOL bEOS;
+  pthread_mutex_t mutex;
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE resamplerEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE resamplerEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE resamplerFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
@@ -0,0 +1,264 @@
+/**
+  test/components/audio_effects/omxseektest.c
+
+  This test application measures the latency of a seek, that is of the
+  flush of all the ports of the volume control component while buffers
+  are queued on them.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxseektest.h"
+
+appPrivateType* appPriv;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = seekEventHandler,
+                               .EmptyBufferDone = seekEmptyBufferDone,
+                               .FillBufferDone = seekFillBufferDone,
+};
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxseektest [-n seeks]\n");
+  printf("\n");
+  printf("       -n seeks: number of flush commands measured, default %d\n", DEFAULT_SEEKS);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+int main(int argc, char** argv) {
+  OMX_ERRORTYPE err;
+  OMX_HANDLETYPE handle;
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_BUFFERHEADERTYPE *inBuffer[MAX_PORT_BUFFERS], *outBuffer[MAX_PORT_BUFFERS];
+  OMX_U32 nInBuffers, nOutBuffers, nInSize, nOutSize;
+  struct timeval start, end;
+  long latency, minLatency = -1, maxLatency = 0, totLatency = 0;
+  int nSeeks = DEFAULT_SEEKS;
+  int i, n, result = 0;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      nSeeks = atoi(argv[++i]);
+    } else {
+      display_help();
+    }
+  }
+  if (nSeeks <= 0) {
+    display_help();
+  }
+
+  /* Initialize application private data */
+  appPriv = malloc(sizeof(appPrivateType));
+  pthread_mutex_init(&appPriv->mutex, NULL);
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->flushSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->flushSem, 0);
+  appPriv->nEmptyDone = 0;
+  appPriv->nFillDone = 0;
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  err = OMX_GetHandle(&handle, "OMX.st.volume.component", NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    exit(1);
+  }
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = 0;
+  err = OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the input port definition\n");
+    exit(1);
+  }
+  nInBuffers = sPortDef.nBufferCountActual;
+  nInSize = sPortDef.nBufferSize;
+  sPortDef.nPortIndex = 1;
+  err = OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the output port definition\n");
+    exit(1);
+  }
+  nOutBuffers = sPortDef.nBufferCountActual;
+  nOutSize = sPortDef.nBufferSize;
+  if (nInBuffers > MAX_PORT_BUFFERS || nOutBuffers > MAX_PORT_BUFFERS) {
+    DEBUG(DEB_LEV_ERR, "Too many buffers requested by the component\n");
+    exit(1);
+  }
+
+  err = OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < nInBuffers; i++) {
+    err = OMX_AllocateBuffer(handle, &inBuffer[i], 0, NULL, nInSize);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer in %i %i\n", i, err);
+      exit(1);
+    }
+  }
+  for (i = 0; i < nOutBuffers; i++) {
+    err = OMX_AllocateBuffer(handle, &outBuffer[i], 1, NULL, nOutSize);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer out %i %i\n", i, err);
+      exit(1);
+    }
+  }
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+
+  /* Every seek queues all the input buffers without output buffers, so that
+   * the component holds one input buffer and the others stay queued, then
+   * flushes all the ports and waits until both of them completed the flush.
+   */
+  for (n = 0; n < nSeeks; n++) {
+    pthread_mutex_lock(&appPriv->mutex);
+    appPriv->nEmptyDone = 0;
+    pthread_mutex_unlock(&appPriv->mutex);
+    for (i = 0; i < nInBuffers; i++) {
+      inBuffer[i]->nFilledLen = nInSize;
+      inBuffer[i]->nOffset = 0;
+      inBuffer[i]->nFlags = 0;
+      err = OMX_EmptyThisBuffer(handle, inBuffer[i]);
+      if (err != OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "Error on EmptyThisBuffer %i\n", err);
+        exit(1);
+      }
+    }
+
+    gettimeofday(&start, NULL);
+    err = OMX_SendCommand(handle, OMX_CommandFlush, OMX_ALL, NULL);
+    tsem_down(appPriv->flushSem);
+    tsem_down(appPriv->flushSem);
+    gettimeofday(&end, NULL);
+
+    latency = elapsed_us(&start, &end);
+    totLatency += latency;
+    if (minLatency < 0 || latency < minLatency) {
+      minLatency = latency;
+    }
+    if (latency > maxLatency) {
+      maxLatency = latency;
+    }
+
+    pthread_mutex_lock(&appPriv->mutex);
+    if (appPriv->nEmptyDone != nInBuffers) {
+      DEBUG(DEB_LEV_ERR, "Seek %i returned %i of %i input buffers\n", n, appPriv->nEmptyDone, (int)nInBuffers);
+      result = 1;
+    }
+    pthread_mutex_unlock(&appPriv->mutex);
+    if (result) {
+      break;
+    }
+  }
+
+  if (!result) {
+    DEBUG(DEFAULT_MESSAGES, "%i seeks: min %li us avg %li us max %li us\n",
+      nSeeks, minLatency, totLatency / nSeeks, maxLatency);
+  }
+
+  err = OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < nInBuffers; i++) {
+    err = OMX_FreeBuffer(handle, 0, inBuffer[i]);
+  }
+  for (i = 0; i < nOutBuffers; i++) {
+    err = OMX_FreeBuffer(handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+
+  OMX_FreeHandle(handle);
+  OMX_Deinit();
+
+  tsem_deinit(appPriv->flushSem);
+  free(appPriv->flushSem);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  pthread_mutex_destroy(&appPriv->mutex);
+  free(appPriv);
+
+  return result;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE seekEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    if (Data1 == OMX_CommandStateSet) {
+      tsem_up(appPriv->eventSem);
+    } else if (Data1 == OMX_CommandFlush) {
+      tsem_up(appPriv->flushSem);
+    }
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "Received error event %08x\n", (int)Data1);
+  }
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE seekEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  pthread_mutex_lock(&appPriv->mutex);
+  appPriv->nEmptyDone++;
+  pthread_mutex_unlock(&appPriv->mutex);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE seekFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  pthread_mutex_lock(&appPriv->mutex);
+  appPriv->nFillDone++;
+  pthread_mutex_unlock(&appPriv->mutex);
+  return OMX_ErrorNone;
+}
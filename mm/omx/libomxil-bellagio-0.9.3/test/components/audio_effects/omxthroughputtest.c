@@ -0,0 +1,327 @@
+/**
+  test/components/audio_effects/omxthroughputtest.c
+
+  This test application measures the buffer throughput of the volume
+  control component with small buffers, that is the cost of the buffer
+  management of the framework rather than of the processing, optionally
+  packing the input buffers in bigger output buffers.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxthroughputtest.h"
+#include <bellagio/extension_struct.h>
+
+appPrivateType* appPriv;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = throughputEventHandler,
+                               .EmptyBufferDone = throughputEmptyBufferDone,
+                               .FillBufferDone = throughputFillBufferDone,
+};
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxthroughputtest [-n buffers] [-s bytes] [-c bytes]\n");
+  printf("\n");
+  printf("       -n buffers: number of buffers sent through the component, default %d\n", DEFAULT_BUFFERS);
+  printf("       -s bytes: number of bytes filled in each buffer, default %d\n", DEFAULT_FILLED_LEN);
+  printf("       -c bytes: pack the input buffers in output buffers of this many bytes\n");
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+/** Sets the number of buffers of a port of the component and returns its buffer size */
+static OMX_U32 setPortBuffers(OMX_HANDLETYPE handle, OMX_U32 nPortIndex) {
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_ERRORTYPE err;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = nPortIndex;
+  err = OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+  sPortDef.nBufferCountActual = PORT_BUFFERS;
+  err = OMX_SetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in setting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+  return sPortDef.nBufferSize;
+}
+
+int main(int argc, char** argv) {
+  OMX_ERRORTYPE err;
+  OMX_BUFFERHEADERTYPE *inBuffer[PORT_BUFFERS], *outBuffer[PORT_BUFFERS];
+  OMX_U32 nInSize, nOutSize;
+  struct timeval start, end;
+  long elapsed;
+  OMX_INDEXTYPE coalescingIndex;
+  OMX_PARAM_BELLAGIOCOALESCINGTYPE sCoalescing;
+  int i, result = 0;
+
+  /* Initialize application private data */
+  appPriv = malloc(sizeof(appPrivateType));
+  pthread_mutex_init(&appPriv->mutex, NULL);
+  appPriv->nBuffers = DEFAULT_BUFFERS;
+  appPriv->nFilledLen = DEFAULT_FILLED_LEN;
+  appPriv->nCoalesceBytes = 0;
+  appPriv->nBytesDone = 0;
+  appPriv->nEmptySent = 0;
+  appPriv->nFillDone = 0;
+  appPriv->nBadBuffers = 0;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+      appPriv->nBuffers = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      appPriv->nFilledLen = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+      appPriv->nCoalesceBytes = atoi(argv[++i]);
+    } else {
+      display_help();
+    }
+  }
+  if (appPriv->nBuffers < PORT_BUFFERS || appPriv->nFilledLen <= 0 || appPriv->nCoalesceBytes < 0) {
+    display_help();
+  }
+
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->doneSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->doneSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  err = OMX_GetHandle(&appPriv->handle, "OMX.st.volume.component", NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    exit(1);
+  }
+
+  nInSize = setPortBuffers(appPriv->handle, 0);
+  nOutSize = setPortBuffers(appPriv->handle, 1);
+  if (appPriv->nFilledLen > nInSize || appPriv->nFilledLen > nOutSize) {
+    DEBUG(DEB_LEV_ERR, "The buffers of the component are smaller than %i bytes\n", appPriv->nFilledLen);
+    exit(1);
+  }
+
+  if (appPriv->nCoalesceBytes) {
+    err = OMX_GetExtensionIndex(appPriv->handle, "OMX.st.index.param.BellagioCoalescing", &coalescingIndex);
+    if(err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "OMX_GetExtensionIndex failed\n");
+      exit(1);
+    }
+    setHeader(&sCoalescing, sizeof(OMX_PARAM_BELLAGIOCOALESCINGTYPE));
+    sCoalescing.nPortIndex = 1;
+    sCoalescing.nMaxBytes = appPriv->nCoalesceBytes;
+    sCoalescing.nMaxDuration = 0;
+    err = OMX_SetParameter(appPriv->handle, coalescingIndex, &sCoalescing);
+    if(err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error in setting the coalescing of the output port\n");
+      exit(1);
+    }
+  }
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_AllocateBuffer(appPriv->handle, &inBuffer[i], 0, NULL, nInSize);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer in %i %i\n", i, err);
+      exit(1);
+    }
+    memset(inBuffer[i]->pBuffer, 0, nInSize);
+    err = OMX_AllocateBuffer(appPriv->handle, &outBuffer[i], 1, NULL, nOutSize);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer out %i %i\n", i, err);
+      exit(1);
+    }
+  }
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+
+  /* All the buffers are kept circulating, each one being sent again
+   * as soon as it is returned, until the data of nBuffers input buffers
+   * came out. The last input buffer carries the EOS, so that the last
+   * output buffer is returned even if it is not full
+   */
+  gettimeofday(&start, NULL);
+  pthread_mutex_lock(&appPriv->mutex);
+  appPriv->nEmptySent = PORT_BUFFERS;
+  pthread_mutex_unlock(&appPriv->mutex);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    outBuffer[i]->nFilledLen = 0;
+    err = OMX_FillThisBuffer(appPriv->handle, outBuffer[i]);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on FillThisBuffer %i\n", err);
+      exit(1);
+    }
+  }
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    inBuffer[i]->nFilledLen = appPriv->nFilledLen;
+    inBuffer[i]->nOffset = 0;
+    inBuffer[i]->nFlags = (i == appPriv->nBuffers - 1) ? OMX_BUFFERFLAG_EOS : 0;
+    err = OMX_EmptyThisBuffer(appPriv->handle, inBuffer[i]);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on EmptyThisBuffer %i\n", err);
+      exit(1);
+    }
+  }
+  tsem_down(appPriv->doneSem);
+  gettimeofday(&end, NULL);
+
+  elapsed = elapsed_us(&start, &end);
+  if (appPriv->nBadBuffers) {
+    DEBUG(DEB_LEV_ERR, "%i output buffers had a wrong length\n", appPriv->nBadBuffers);
+    result = 1;
+  }
+  DEBUG(DEFAULT_MESSAGES, "%i buffers of %i bytes in %li us: %.2f us per buffer, %.0f buffers/s, %i output buffers\n",
+    appPriv->nBuffers, appPriv->nFilledLen, elapsed,
+    (double)elapsed / appPriv->nBuffers, appPriv->nBuffers * 1000000.0 / (elapsed > 0 ? elapsed : 1), appPriv->nFillDone);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_FreeBuffer(appPriv->handle, 0, inBuffer[i]);
+    err = OMX_FreeBuffer(appPriv->handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+
+  OMX_FreeHandle(appPriv->handle);
+  OMX_Deinit();
+
+  tsem_deinit(appPriv->doneSem);
+  free(appPriv->doneSem);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  pthread_mutex_destroy(&appPriv->mutex);
+  free(appPriv);
+
+  return result;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE throughputEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    if (Data1 == OMX_CommandStateSet) {
+      tsem_up(appPriv->eventSem);
+    }
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "Received error event %08x\n", (int)Data1);
+  }
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE throughputEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  OMX_BOOL bSend = OMX_FALSE;
+
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->nEmptySent < appPriv->nBuffers) {
+    appPriv->nEmptySent++;
+    bSend = OMX_TRUE;
+  }
+  pthread_mutex_unlock(&appPriv->mutex);
+  if (bSend) {
+    pBuffer->nFilledLen = appPriv->nFilledLen;
+    pBuffer->nOffset = 0;
+    pBuffer->nFlags = (appPriv->nEmptySent == appPriv->nBuffers) ? OMX_BUFFERFLAG_EOS : 0;
+    OMX_EmptyThisBuffer(hComponent, pBuffer);
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE throughputFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  OMX_BOOL bSend = OMX_FALSE, bDone = OMX_FALSE;
+  OMX_U32 nMaxLen;
+
+  /* a packed buffer holds whole input buffers, up to the coalescing size
+   * or one input buffer more if the coalescing size is not a multiple
+   */
+  nMaxLen = appPriv->nFilledLen;
+  if (appPriv->nCoalesceBytes > appPriv->nFilledLen) {
+    nMaxLen = ((appPriv->nCoalesceBytes + appPriv->nFilledLen - 1) / appPriv->nFilledLen) * appPriv->nFilledLen;
+  }
+
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->nBytesDone >= (long)appPriv->nBuffers * appPriv->nFilledLen) {
+    /* the buffers left after the EOS come back empty */
+    pthread_mutex_unlock(&appPriv->mutex);
+    return OMX_ErrorNone;
+  }
+  if (pBuffer->nFilledLen == 0 || pBuffer->nFilledLen % appPriv->nFilledLen != 0 || pBuffer->nFilledLen > nMaxLen ||
+      (!appPriv->nCoalesceBytes && pBuffer->nFilledLen != appPriv->nFilledLen)) {
+    appPriv->nBadBuffers++;
+  }
+  appPriv->nFillDone++;
+  appPriv->nBytesDone += pBuffer->nFilledLen;
+  if (appPriv->nBytesDone >= (long)appPriv->nBuffers * appPriv->nFilledLen) {
+    bDone = OMX_TRUE;
+  } else {
+    bSend = OMX_TRUE;
+  }
+  pthread_mutex_unlock(&appPriv->mutex);
+  if (bSend) {
+    pBuffer->nFilledLen = 0;
+    pBuffer->nFlags = 0;
+    OMX_FillThisBuffer(hComponent, pBuffer);
+  }
+  if (bDone) {
+    tsem_up(appPriv->doneSem);
+  }
+  return OMX_ErrorNone;
+}
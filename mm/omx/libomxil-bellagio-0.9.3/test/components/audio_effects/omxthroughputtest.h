@@ -0,0 +1,96 @@
+/**
+  test/components/audio_effects/omxthroughputtest.h
+
+  This test application measures the buffer throughput of the volume
+  control component with small buffers, that is the cost of the buffer
+  management of the framework rather than of the processing, optionally
+  packing the input buffers in bigger output buffers.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXTHROUGHPUTTEST_H__
+#define __OMXTHROUGHPUTTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+#include <bellagio/tsemaphore.h>
+#include <user_debug_levels.h>
+
+/** Specification version of the core */
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    0
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+/** Default number of buffers sent through the component */
+#define DEFAULT_BUFFERS 50000
+
+/** Default number of bytes filled in each buffer, 256 stereo samples */
+#define DEFAULT_FILLED_LEN 1024
+
+/** Number of buffers allocated on each port */
+#define PORT_BUFFERS 8
+
+/* Application's private data */
+typedef struct appPrivateType{
+  tsem_t* eventSem;
+  tsem_t* doneSem;
+  OMX_HANDLETYPE handle;
+  int nBuffers;
+  int nFilledLen;
+  int nCoalesceBytes;
+  long nBytesDone;
+  int nEmptySent;
+  int nFillDone;
+  int nBadBuffers;
+  pthread_mutex_t mutex;
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE throughputEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE throughputEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE throughputFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
@@ -0,0 +1,743 @@
+/**
+  test/components/colorconv/omxcolorconvtest.c
+
+  This test application checks the color conversions and the scaling of the
+  color converter component against a reference computed in double precision,
+  checks that the kernels and the threads give the same frames, and measures
+  the frames per second of each kernel.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxcolorconvtest.h"
+
+appPrivateType* appPriv;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = colorconvEventHandler,
+                               .EmptyBufferDone = colorconvEmptyBufferDone,
+                               .FillBufferDone = colorconvFillBufferDone,
+};
+
+/** The kernels of the color converter, a kernel not supported by the CPU being skipped */
+static const char* kernelNames[] = { "scalar", "sse", "avx2", "neon" };
+#define KERNELS (sizeof(kernelNames) / sizeof(kernelNames[0]))
+
+#define I420(w, h) { OMX_COLOR_FormatYUV420Planar, w, h, 0 }
+#define NV12(w, h) { OMX_COLOR_FormatYUV420SemiPlanar, w, h, 0 }
+#define RGB565(w, h) { OMX_COLOR_Format16bitRGB565, w, h, 0 }
+#define ARGB(w, h) { OMX_COLOR_Format32bitARGB8888, w, h, 0 }
+
+/** A conversion checked, with the largest and the mean error allowed on the
+ * red, green and blue of the frames, in steps of 8 bits
+ */
+typedef struct colorconvCaseType {
+  const char* sName;
+  videoFormatType sIn;
+  videoFormatType sOut;
+  OMX_U32 nLevel;
+  double fMaxError;
+  double fMeanError;
+} colorconvCaseType;
+
+/** The conversions at the same size, compared with the input frame; widths not a
+ * multiple of the vectors of the kernels
+ */
+static const colorconvCaseType convertCases[] = {
+  { "I420 to ARGB", I420(346, 198), ARGB(346, 198), 1, 2, 0.5 },
+  { "NV12 to RGB565", NV12(346, 198), RGB565(346, 198), 1, 9, 4.5 },
+  { "I420 to NV12", I420(346, 198), NV12(346, 198), 1, 0, 0 },
+  { "NV12 to I420", NV12(346, 198), I420(346, 198), 1, 0, 0 },
+  { "ARGB to I420", ARGB(346, 198), I420(346, 198), 1, 5, 1.5 },
+  { "RGB565 to NV12", RGB565(346, 198), NV12(346, 198), 1, 11, 2 },
+  { "RGB565 to ARGB", RGB565(346, 198), ARGB(346, 198), 1, 1, 0.5 },
+  { "ARGB to RGB565", ARGB(346, 198), RGB565(346, 198), 1, 8.5, 4.5 },
+  { "I420 padded to ARGB padded", { OMX_COLOR_FormatYUV420Planar, 346, 198, 384 },
+    { OMX_COLOR_Format32bitARGB8888, 346, 198, 1408 }, 1, 2, 0.5 }
+};
+#define CONVERT_CASES (sizeof(convertCases) / sizeof(convertCases[0]))
+
+/** The scalings, bicubic at the quality level 1 and bilinear at the level 2,
+ * compared with the pattern at the centres of the output pixels, which a
+ * downscaling filter averages over several input pixels
+ */
+static const colorconvCaseType scaleCases[] = {
+  { "I420 640x480 to ARGB 320x240 bicubic", I420(640, 480), ARGB(320, 240), 1, 6, 1.5 },
+  { "I420 640x480 to ARGB 320x240 bilinear", I420(640, 480), ARGB(320, 240), 2, 6, 1.5 },
+  { "NV12 320x240 to I420 640x360 bicubic", NV12(320, 240), I420(640, 360), 1, 6, 1.5 },
+  { "ARGB 320x240 to RGB565 480x270 bilinear", ARGB(320, 240), RGB565(480, 270), 2, 10, 4.5 },
+  { "I420 1280x720 to ARGB 160x90 bicubic", I420(1280, 720), ARGB(160, 90), 1, 10, 3 },
+  { "RGB565 400x300 to NV12 200x150 bicubic", RGB565(400, 300), NV12(200, 150), 1, 8, 3 }
+};
+#define SCALE_CASES (sizeof(scaleCases) / sizeof(scaleCases[0]))
+
+/** The conversions measured */
+static const colorconvCaseType benchCases[] = {
+  { "1080p NV12 to ARGB", NV12(1920, 1080), ARGB(1920, 1080), 1, 0, 0 },
+  { "1080p I420 to RGB565", I420(1920, 1080), RGB565(1920, 1080), 1, 0, 0 },
+  { "720p I420 to ARGB", I420(1280, 720), ARGB(1280, 720), 1, 0, 0 },
+  { "1080p I420 to 720p ARGB bicubic", I420(1920, 1080), ARGB(1280, 720), 1, 0, 0 },
+  { "1080p I420 to 720p ARGB bilinear", I420(1920, 1080), ARGB(1280, 720), 2, 0, 0 },
+  { "720p NV12 to 1080p I420 bicubic", NV12(1280, 720), I420(1920, 1080), 1, 0, 0 }
+};
+#define BENCH_CASES (sizeof(benchCases) / sizeof(benchCases[0]))
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxcolorconvtest [-f frames] [-k kernel] [-t threads]\n");
+  printf("\n");
+  printf("       -f frames: frames converted by each benchmark run, default %d\n", DEFAULT_FRAMES);
+  printf("       -k kernel: benchmark only this kernel, scalar, sse, avx2 or neon\n");
+  printf("       -t threads: benchmark only with this number of threads, by default 1 and one per CPU\n");
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+/** Whether the component runs a kernel, when built in and supported by the CPU */
+static int kernelSupported(const char* sKernel) {
+  return kernelSelected("OMX.st.video.colorconv", COLORCONV_KERNEL_ENV, sKernel, &callbacks);
+}
+
+static int isYuv(const videoFormatType* pFormat) {
+  return pFormat->eColorFormat == OMX_COLOR_FormatYUV420Planar ||
+         pFormat->eColorFormat == OMX_COLOR_FormatYUV420SemiPlanar;
+}
+
+static OMX_U32 pixelBytes(const videoFormatType* pFormat) {
+  switch (pFormat->eColorFormat) {
+    case OMX_COLOR_Format16bitRGB565:
+      return 2;
+    case OMX_COLOR_Format32bitARGB8888:
+      return 4;
+    default:
+      return 1;
+  }
+}
+
+static OMX_U32 frameStride(const videoFormatType* pFormat) {
+  return pFormat->nStride ? pFormat->nStride : pFormat->nWidth * pixelBytes(pFormat);
+}
+
+/** The size of a frame, the chroma planes of a quarter of the luma one below it */
+static OMX_U32 frameSize(const videoFormatType* pFormat) {
+  OMX_U32 nSize = frameStride(pFormat) * pFormat->nHeight;
+  return isYuv(pFormat) ? nSize * 3 / 2 : nSize;
+}
+
+static double clampPixel(double fValue) {
+  return fValue < 0 ? 0 : (fValue > 255 ? 255 : fValue);
+}
+
+/** The red, green and blue of a smooth pattern at a point of the frame, in [0, 1) */
+static void patternRgb(double u, double v, double* pRgb) {
+  pRgb[0] = 128 + 100 * sin(2 * M_PI * (1.5 * u + 0.5 * v));
+  pRgb[1] = 128 + 100 * cos(2 * M_PI * (0.7 * u - 1.2 * v));
+  pRgb[2] = 128 + 90 * sin(2 * M_PI * 0.9 * (u + v) + 1);
+}
+
+/** The pattern at the centres of the pixels of a frame, three values per pixel */
+static double* makePattern(OMX_U32 nWidth, OMX_U32 nHeight) {
+  double* pRgb = malloc(nWidth * nHeight * 3 * sizeof(double));
+  OMX_U32 x, y;
+
+  for (y = 0; y < nHeight; y++) {
+    for (x = 0; x < nWidth; x++) {
+      patternRgb((x + 0.5) / nWidth, (y + 0.5) / nHeight, pRgb + (y * nWidth + x) * 3);
+    }
+  }
+  return pRgb;
+}
+
+/** Converts red, green and blue to BT.601 studio range YUV, the chroma of the
+ * average of a 2x2 block, with the padding of the strides left zero
+ */
+static OMX_U8* writeFrame(const videoFormatType* pFormat, const double* pRgb) {
+  OMX_U32 nWidth = pFormat->nWidth, nHeight = pFormat->nHeight, nStride = frameStride(pFormat);
+  OMX_U8* pFrame = calloc(1, frameSize(pFormat));
+  OMX_U8 *pChroma = pFrame + nStride * nHeight, *pPixel;
+  double r, g, b;
+  uint32_t nArgb;
+  uint16_t nRgb;
+  OMX_U32 x, y, i;
+
+  for (y = 0; y < nHeight; y++) {
+    for (x = 0; x < nWidth; x++) {
+      r = pRgb[(y * nWidth + x) * 3];
+      g = pRgb[(y * nWidth + x) * 3 + 1];
+      b = pRgb[(y * nWidth + x) * 3 + 2];
+      pPixel = pFrame + y * nStride + x * pixelBytes(pFormat);
+      switch (pFormat->eColorFormat) {
+        case OMX_COLOR_Format32bitARGB8888:
+          nArgb = 0xff000000 | ((uint32_t)lrint(r) << 16) | ((uint32_t)lrint(g) << 8) | (uint32_t)lrint(b);
+          memcpy(pPixel, &nArgb, sizeof(nArgb));
+          break;
+        case OMX_COLOR_Format16bitRGB565:
+          nRgb = (uint16_t)((lrint(r * 31 / 255) << 11) | (lrint(g * 63 / 255) << 5) | lrint(b * 31 / 255));
+          memcpy(pPixel, &nRgb, sizeof(nRgb));
+          break;
+        default:
+          *pPixel = (OMX_U8) lrint(16 + (65.481 * r + 128.553 * g + 24.966 * b) / 255);
+      }
+    }
+  }
+  if (!isYuv(pFormat)) {
+    return pFrame;
+  }
+  for (y = 0; y < nHeight / 2; y++) {
+    for (x = 0; x < nWidth / 2; x++) {
+      r = g = b = 0;
+      for (i = 0; i < 4; i++) {
+        r += pRgb[((2 * y + i / 2) * nWidth + 2 * x + i % 2) * 3] / 4;
+        g += pRgb[((2 * y + i / 2) * nWidth + 2 * x + i % 2) * 3 + 1] / 4;
+        b += pRgb[((2 * y + i / 2) * nWidth + 2 * x + i % 2) * 3 + 2] / 4;
+      }
+      if (pFormat->eColorFormat == OMX_COLOR_FormatYUV420Planar) {
+        pChroma[y * (nStride / 2) + x] = (OMX_U8) lrint(128 + (-37.797 * r - 74.203 * g + 112.0 * b) / 255);
+        pChroma[(nHeight / 2 + y) * (nStride / 2) + x] = (OMX_U8) lrint(128 + (112.0 * r - 93.786 * g - 18.214 * b) / 255);
+      } else {
+        pChroma[y * nStride + 2 * x] = (OMX_U8) lrint(128 + (-37.797 * r - 74.203 * g + 112.0 * b) / 255);
+        pChroma[y * nStride + 2 * x + 1] = (OMX_U8) lrint(128 + (112.0 * r - 93.786 * g - 18.214 * b) / 255);
+      }
+    }
+  }
+  return pFrame;
+}
+
+/** The red, green and blue of the pixels of a frame, three values per pixel */
+static double* readFrame(const videoFormatType* pFormat, const OMX_U8* pFrame) {
+  OMX_U32 nWidth = pFormat->nWidth, nHeight = pFormat->nHeight, nStride = frameStride(pFormat);
+  double* pRgb = malloc(nWidth * nHeight * 3 * sizeof(double));
+  const OMX_U8 *pChroma = pFrame + nStride * nHeight, *pPixel;
+  double fY, fU, fV, *pOut;
+  uint32_t nArgb;
+  uint16_t nRgb;
+  OMX_U32 x, y;
+
+  for (y = 0; y < nHeight; y++) {
+    for (x = 0; x < nWidth; x++) {
+      pPixel = pFrame + y * nStride + x * pixelBytes(pFormat);
+      pOut = pRgb + (y * nWidth + x) * 3;
+      switch (pFormat->eColorFormat) {
+        case OMX_COLOR_Format32bitARGB8888:
+          memcpy(&nArgb, pPixel, sizeof(nArgb));
+          pOut[0] = (nArgb >> 16) & 0xff;
+          pOut[1] = (nArgb >> 8) & 0xff;
+          pOut[2] = nArgb & 0xff;
+          break;
+        case OMX_COLOR_Format16bitRGB565:
+          memcpy(&nRgb, pPixel, sizeof(nRgb));
+          pOut[0] = (nRgb >> 11) * 255.0 / 31;
+          pOut[1] = ((nRgb >> 5) & 0x3f) * 255.0 / 63;
+          pOut[2] = (nRgb & 0x1f) * 255.0 / 31;
+          break;
+        default:
+          fY = *pPixel - 16;
+          if (pFormat->eColorFormat == OMX_COLOR_FormatYUV420Planar) {
+            fU = pChroma[(y / 2) * (nStride / 2) + x / 2] - 128;
+            fV = pChroma[(nHeight / 2 + y / 2) * (nStride / 2) + x / 2] - 128;
+          } else {
+            fU = pChroma[(y / 2) * nStride + (x & ~1)] - 128;
+            fV = pChroma[(y / 2) * nStride + (x & ~1) + 1] - 128;
+          }
+          pOut[0] = clampPixel(1.164383 * fY + 1.596027 * fV);
+          pOut[1] = clampPixel(1.164383 * fY - 0.391762 * fU - 0.812968 * fV);
+          pOut[2] = clampPixel(1.164383 * fY + 2.017232 * fU);
+      }
+    }
+  }
+  return pRgb;
+}
+
+/** Sets the frames of a port of the component and returns the size of its buffers */
+static OMX_U32 setPortVideo(OMX_HANDLETYPE handle, OMX_U32 nPortIndex, const videoFormatType* pFormat) {
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_ERRORTYPE err;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = nPortIndex;
+  err = OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+  sPortDef.nBufferCountActual = PORT_BUFFERS;
+  sPortDef.format.video.eColorFormat = pFormat->eColorFormat;
+  sPortDef.format.video.nFrameWidth = pFormat->nWidth;
+  sPortDef.format.video.nFrameHeight = pFormat->nHeight;
+  sPortDef.format.video.nStride = pFormat->nStride;
+  sPortDef.format.video.nSliceHeight = 0;
+  err = OMX_SetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in setting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+  err = OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone || sPortDef.nBufferSize < frameSize(pFormat)){
+    DEBUG(DEB_LEV_ERR, "The port %i buffers of %i bytes do not hold a frame\n", (int)nPortIndex, (int)sPortDef.nBufferSize);
+    exit(1);
+  }
+  return sPortDef.nBufferSize;
+}
+
+/** Sends the input frame again in a buffer, and returns OMX_FALSE when all are sent */
+static OMX_BOOL fillInputBuffer(OMX_BUFFERHEADERTYPE* pBuffer) {
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->nFramesSent >= appPriv->nFrames) {
+    pthread_mutex_unlock(&appPriv->mutex);
+    return OMX_FALSE;
+  }
+  pBuffer->nFilledLen = appPriv->nInputSize;
+  pBuffer->nOffset = 0;
+  appPriv->nFramesSent++;
+  pBuffer->nFlags = (appPriv->nFramesSent == appPriv->nFrames) ? OMX_BUFFERFLAG_EOS : 0;
+  pthread_mutex_unlock(&appPriv->mutex);
+  return OMX_TRUE;
+}
+
+/** Converts a frame nFrames times with a kernel and a number of threads, NULL and 0
+ * for the default ones, keeps the last output frame in pOutput, and returns the
+ * output frames or -1
+ */
+static long runColorConv(const char* sKernel, OMX_U32 nThreads, const colorconvCaseType* pCase,
+                         const OMX_U8* pInput, OMX_U32 nFrames, OMX_U8* pOutput, long* pElapsed) {
+  OMX_BUFFERHEADERTYPE *inBuffer[PORT_BUFFERS], *outBuffer[PORT_BUFFERS];
+  OMX_U32 nInSize, nOutSize;
+  struct timeval start, end;
+  char sThreads[16];
+  OMX_ERRORTYPE err;
+  int i;
+
+  if (sKernel) {
+    setenv(COLORCONV_KERNEL_ENV, sKernel, 1);
+  } else {
+    unsetenv(COLORCONV_KERNEL_ENV);
+  }
+  if (nThreads) {
+    snprintf(sThreads, sizeof(sThreads), "%i", (int)nThreads);
+    setenv(COLORCONV_THREADS_ENV, sThreads, 1);
+  } else {
+    unsetenv(COLORCONV_THREADS_ENV);
+  }
+  appPriv->nInputSize = frameSize(&pCase->sIn);
+  appPriv->nFrames = nFrames;
+  appPriv->nFramesSent = 0;
+  appPriv->nFramesOut = 0;
+  appPriv->pOutput = pOutput;
+  appPriv->nOutputSize = frameSize(&pCase->sOut);
+  appPriv->bEOS = OMX_FALSE;
+
+  err = OMX_GetHandle(&appPriv->handle, "OMX.st.video.colorconv", NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    return -1;
+  }
+  nInSize = setPortVideo(appPriv->handle, 0, &pCase->sIn);
+  nOutSize = setPortVideo(appPriv->handle, 1, &pCase->sOut);
+  err = setQualityLevel(appPriv->handle, pCase->nLevel);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "Error in setting the quality level %i\n", (int)pCase->nLevel);
+    return -1;
+  }
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_AllocateBuffer(appPriv->handle, &inBuffer[i], 0, NULL, nInSize);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer in %i %i\n", i, err);
+      return -1;
+    }
+    /* the component leaves the input frames as they are, sent again as they are */
+    memcpy(inBuffer[i]->pBuffer, pInput, appPriv->nInputSize);
+    err = OMX_AllocateBuffer(appPriv->handle, &outBuffer[i], 1, NULL, nOutSize);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer out %i %i\n", i, err);
+      return -1;
+    }
+  }
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    outBuffer[i]->nFilledLen = 0;
+    err = OMX_FillThisBuffer(appPriv->handle, outBuffer[i]);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on FillThisBuffer %i\n", err);
+      return -1;
+    }
+  }
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    if (fillInputBuffer(inBuffer[i])) {
+      err = OMX_EmptyThisBuffer(appPriv->handle, inBuffer[i]);
+      if (err != OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "Error on EmptyThisBuffer %i\n", err);
+        return -1;
+      }
+    }
+  }
+  tsem_down(appPriv->doneSem);
+  gettimeofday(&end, NULL);
+  *pElapsed = elapsed_us(&start, &end);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_FreeBuffer(appPriv->handle, 0, inBuffer[i]);
+    err = OMX_FreeBuffer(appPriv->handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+
+  OMX_FreeHandle(appPriv->handle);
+  appPriv->handle = NULL;
+  return appPriv->nFramesOut;
+}
+
+/** The largest and the mean difference between the red, green and blue of two images */
+static void compareRgb(const double* pExpected, const double* pActual, OMX_U32 nPixels,
+                       double* pMaxError, double* pMeanError) {
+  double fError, fSum = 0;
+  OMX_U32 i;
+
+  *pMaxError = 0;
+  for (i = 0; i < nPixels * 3; i++) {
+    fError = fabs(pExpected[i] - pActual[i]);
+    fSum += fError;
+    if (fError > *pMaxError) {
+      *pMaxError = fError;
+    }
+  }
+  *pMeanError = fSum / (nPixels * 3);
+}
+
+/** Converts the pattern with the default kernel and compares the output frame with
+ * the input one when the sizes are the same, with the pattern otherwise
+ */
+static int checkCase(const colorconvCaseType* pCase) {
+  double *pPattern, *pExpected, *pActual, fMaxError, fMeanError;
+  OMX_U32 nPixels = pCase->sOut.nWidth * pCase->sOut.nHeight;
+  OMX_U8 *pInput, *pOutput;
+  long nFrames, elapsed;
+  int result = 0;
+
+  pPattern = makePattern(pCase->sIn.nWidth, pCase->sIn.nHeight);
+  pInput = writeFrame(&pCase->sIn, pPattern);
+  pOutput = calloc(1, frameSize(&pCase->sOut));
+  if (pCase->sIn.nWidth == pCase->sOut.nWidth && pCase->sIn.nHeight == pCase->sOut.nHeight) {
+    pExpected = readFrame(&pCase->sIn, pInput);
+  } else {
+    pExpected = makePattern(pCase->sOut.nWidth, pCase->sOut.nHeight);
+  }
+  nFrames = runColorConv(NULL, 0, pCase, pInput, CHECK_FRAMES, pOutput, &elapsed);
+  if (nFrames != CHECK_FRAMES) {
+    DEBUG(DEB_LEV_ERR, "%s: %li frames out of %i\n", pCase->sName, nFrames, CHECK_FRAMES);
+    result = 1;
+  } else {
+    pActual = readFrame(&pCase->sOut, pOutput);
+    compareRgb(pExpected, pActual, nPixels, &fMaxError, &fMeanError);
+    DEBUG(DEFAULT_MESSAGES, "%s: largest error %.2f, mean error %.2f\n", pCase->sName, fMaxError, fMeanError);
+    if (fMaxError > pCase->fMaxError + 1e-6 || fMeanError > pCase->fMeanError) {
+      DEBUG(DEB_LEV_ERR, "%s is wrong\n", pCase->sName);
+      result = 1;
+    }
+    free(pActual);
+  }
+  free(pExpected);
+  free(pOutput);
+  free(pInput);
+  free(pPattern);
+  return result;
+}
+
+/** Each conversion and scaling by the default kernel matches the reference */
+static int checkCasesOutput() {
+  int result = 0;
+  OMX_U32 k;
+
+  for (k = 0; k < CONVERT_CASES; k++) {
+    result |= checkCase(&convertCases[k]);
+  }
+  for (k = 0; k < SCALE_CASES; k++) {
+    result |= checkCase(&scaleCases[k]);
+  }
+  return result;
+}
+
+/** Converts the pattern with the kernels and the threads and compares the output frames
+ * with the one of the scalar kernel on one thread, which must be the same to the byte
+ */
+static int checkSameFrames(const colorconvCaseType* pCase) {
+  OMX_U32 nSize = frameSize(&pCase->sOut), k;
+  OMX_U8 *pInput, *pReference, *pOutput;
+  double* pPattern;
+  long nFrames, elapsed;
+  int result = 0;
+
+  pPattern = makePattern(pCase->sIn.nWidth, pCase->sIn.nHeight);
+  pInput = writeFrame(&pCase->sIn, pPattern);
+  pReference = calloc(1, nSize);
+  pOutput = malloc(nSize);
+  runColorConv("scalar", 1, pCase, pInput, CHECK_FRAMES, pReference, &elapsed);
+  for (k = 0; k < KERNELS; k++) {
+    if (!kernelSupported(kernelNames[k])) {
+      continue;
+    }
+    memset(pOutput, 0, nSize);
+    nFrames = runColorConv(kernelNames[k], CHECK_THREADS, pCase, pInput, CHECK_FRAMES, pOutput, &elapsed);
+    if (nFrames != CHECK_FRAMES || memcmp(pOutput, pReference, nSize)) {
+      DEBUG(DEB_LEV_ERR, "%s on %i threads differs from the scalar kernel on one, %s\n", kernelNames[k], CHECK_THREADS, pCase->sName);
+      result = 1;
+    }
+  }
+  free(pOutput);
+  free(pReference);
+  free(pInput);
+  free(pPattern);
+  return result;
+}
+
+/** The kernels give the same frames as the scalar one, and the threads as one thread */
+static int checkKernels() {
+  int result = 0;
+  OMX_U32 k;
+
+  for (k = 0; k < CONVERT_CASES; k++) {
+    result |= checkSameFrames(&convertCases[k]);
+  }
+  for (k = 0; k < SCALE_CASES; k++) {
+    result |= checkSameFrames(&scaleCases[k]);
+  }
+  DEBUG(DEFAULT_MESSAGES, "%s the frames of the scalar kernel on one thread\n", result ? "Not all kernels give" : "All kernels give");
+  return result;
+}
+
+/** Odd sizes, short strides and formats not converted are refused */
+static int checkBadPorts() {
+  static const videoFormatType badFormats[] = {
+    I420(321, 240),
+    ARGB(320, 241),
+    { OMX_COLOR_Format32bitARGB8888, 320, 240, 640 },
+    { OMX_COLOR_FormatYUV420Planar, 320, 240, 321 },
+    { OMX_COLOR_FormatYCbYCr, 320, 240, 0 }
+  };
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_HANDLETYPE handle;
+  OMX_ERRORTYPE err;
+  int result = 0;
+  OMX_U32 k;
+
+  err = OMX_GetHandle(&handle, "OMX.st.video.colorconv", NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    return 1;
+  }
+  for (k = 0; k < sizeof(badFormats) / sizeof(badFormats[0]); k++) {
+    setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+    sPortDef.nPortIndex = k % 2;
+    OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+    sPortDef.format.video.eColorFormat = badFormats[k].eColorFormat;
+    sPortDef.format.video.nFrameWidth = badFormats[k].nWidth;
+    sPortDef.format.video.nFrameHeight = badFormats[k].nHeight;
+    sPortDef.format.video.nStride = badFormats[k].nStride;
+    err = OMX_SetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+    if (err == OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "the bad port definition %i is accepted\n", (int)k);
+      result = 1;
+    }
+  }
+  OMX_FreeHandle(handle);
+  return result;
+}
+
+/** Prints the frames per second converted by a kernel on a number of threads */
+static void benchmark(const char* sKernel, OMX_U32 nThreads, int nFrames) {
+  const colorconvCaseType* pCase;
+  OMX_U8 *pInput, *pOutput;
+  double* pPattern;
+  long elapsed;
+  OMX_U32 c;
+
+  for (c = 0; c < BENCH_CASES; c++) {
+    pCase = &benchCases[c];
+    pPattern = makePattern(pCase->sIn.nWidth, pCase->sIn.nHeight);
+    pInput = writeFrame(&pCase->sIn, pPattern);
+    pOutput = malloc(frameSize(&pCase->sOut));
+    if (runColorConv(sKernel, nThreads, pCase, pInput, nFrames, pOutput, &elapsed) >= 0) {
+      DEBUG(DEFAULT_MESSAGES, "%-6s %2i threads %-34s: %i frames in %li us, %.1f frames/s\n",
+        sKernel, (int)nThreads, pCase->sName, nFrames, elapsed,
+        nFrames * 1000000.0 / (elapsed > 0 ? elapsed : 1));
+    }
+    free(pOutput);
+    free(pInput);
+    free(pPattern);
+  }
+}
+
+int main(int argc, char** argv) {
+  OMX_ERRORTYPE err;
+  const char* sKernel = NULL;
+  int nFrames = DEFAULT_FRAMES, nThreads = 0;
+  long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+  int i, result = 0;
+  OMX_U32 k;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      nFrames = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-k") && i + 1 < argc) {
+      sKernel = argv[++i];
+    } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+      nThreads = atoi(argv[++i]);
+      if (nThreads <= 0) {
+        display_help();
+      }
+    } else {
+      display_help();
+    }
+  }
+  if (nFrames <= 0) {
+    display_help();
+  }
+
+  /* Initialize application private data */
+  appPriv = calloc(1, sizeof(appPrivateType));
+  pthread_mutex_init(&appPriv->mutex, NULL);
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->doneSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->doneSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  if (sKernel && !kernelSupported(sKernel)) {
+    OMX_Deinit();
+    display_help();
+  }
+
+  result |= checkCasesOutput();
+  result |= checkBadPorts();
+  result |= checkKernels();
+
+  for (k = 0; k < KERNELS; k++) {
+    if (kernelSupported(kernelNames[k]) && (!sKernel || !strcmp(sKernel, kernelNames[k]))) {
+      if (nThreads) {
+        benchmark(kernelNames[k], nThreads, nFrames);
+      } else {
+        benchmark(kernelNames[k], 1, nFrames);
+        if (nCpus > 1) {
+          benchmark(kernelNames[k], nCpus, nFrames);
+        }
+      }
+    }
+  }
+
+  OMX_Deinit();
+
+  tsem_deinit(appPriv->doneSem);
+  free(appPriv->doneSem);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  pthread_mutex_destroy(&appPriv->mutex);
+  free(appPriv);
+
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result ? "FAILED" : "PASSED");
+  return result;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE colorconvEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    if (Data1 == OMX_CommandStateSet) {
+      tsem_up(appPriv->eventSem);
+    }
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "Received error event %08x\n", (int)Data1);
+  }
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE colorconvEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  if (fillInputBuffer(pBuffer)) {
+    OMX_EmptyThisBuffer(hComponent, pBuffer);
+  }
+  return OMX_ErrorNone;
+}
+
+/** Counts the output frames and keeps the last one */
+OMX_ERRORTYPE colorconvFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  OMX_BOOL bDone = OMX_FALSE;
+
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->bEOS) {
+    /* the buffers left after the EOS come back empty */
+    pthread_mutex_unlock(&appPriv->mutex);
+    return OMX_ErrorNone;
+  }
+  if (pBuffer->nFilledLen > 0) {
+    appPriv->nFramesOut++;
+  }
+  if ((pBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+    memcpy(appPriv->pOutput, pBuffer->pBuffer + pBuffer->nOffset,
+      pBuffer->nFilledLen < appPriv->nOutputSize ? pBuffer->nFilledLen : appPriv->nOutputSize);
+    appPriv->bEOS = OMX_TRUE;
+    bDone = OMX_TRUE;
+  }
+  pthread_mutex_unlock(&appPriv->mutex);
+  if (bDone) {
+    tsem_up(appPriv->doneSem);
+  } else {
+    pBuffer->nFilledLen = 0;
+    pBuffer->nFlags = 0;
+    OMX_FillThisBuffer(hComponent, pBuffer);
+  }
+  return OMX_ErrorNone;
+}
@@ -0,0 +1,114 @@
+/**
+  test/components/colorconv/omxcolorconvtest.h
+
+  This test application checks the color conversions and the scaling of the
+  color converter component, and measures its frames per second.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXCOLORCONVTEST_H__
+#define __OMXCOLORCONVTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Video.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/OMXComponentRMExt.h>
+#include <user_debug_levels.h>
+
+/** Specification version of the core */
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    0
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+#include <kernel_test.h>
+
+/** The environment variables naming the kernel of the color converter and its threads */
+#define COLORCONV_KERNEL_ENV "OMX_BELLAGIO_COLORCONV_KERNEL"
+#define COLORCONV_THREADS_ENV "OMX_BELLAGIO_COLORCONV_THREADS"
+
+/** Default frames converted by each benchmark run */
+#define DEFAULT_FRAMES 100
+
+/** Frames converted by each check */
+#define CHECK_FRAMES 3
+
+/** Threads compared with a single one, not dividing the slices evenly */
+#define CHECK_THREADS 5
+
+/** Number of buffers allocated on each port */
+#define PORT_BUFFERS 4
+
+/** The frames of a port, the stride derived from the width when 0 */
+typedef struct videoFormatType {
+  OMX_COLOR_FORMATTYPE eColorFormat;
+  OMX_U32 nWidth;
+  OMX_U32 nHeight;
+  OMX_U32 nStride;
+} videoFormatType;
+
+/* Application's private data */
+typedef struct appPrivateType{
+  tsem_t* eventSem;
+  tsem_t* doneSem;
+  OMX_HANDLETYPE handle;
+  OMX_U32 nInputSize;
+  OMX_U32 nFrames;
+  OMX_U32 nFramesSent;
+  OMX_U32 nFramesOut;
+  OMX_U8* pOutput;
+  OMX_U32 nOutputSize;
+  OMX_BOOL bEOS;
+  pthread_mutex_t mutex;
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE colorconvEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE colorconvEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE colorconvFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
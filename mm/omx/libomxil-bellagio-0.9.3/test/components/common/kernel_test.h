@@ -0,0 +1,75 @@
+/**
+  test/components/common/kernel_test.h
+
+  Helpers of the tests of the components running a kernel among several
+  built for different instruction sets. The test includes it after defining
+  VERSIONMAJOR and VERSIONMINOR.
+
+  Copyright (C) 2007-2010  STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __KERNEL_TEST_H__
+#define __KERNEL_TEST_H__
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <bellagio/extension_struct.h>
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+/** Whether a component runs a kernel when the environment variable sEnv names it,
+ * that is whether the kernel is built in and the CPU supports it. The component
+ * is asked for the kernel it selected through OMX.st.index.param.BellagioKernel.
+ */
+static int kernelSelected(OMX_STRING sComponent, const char* sEnv, const char* sKernel, OMX_CALLBACKTYPE* pCallbacks) {
+  OMX_HANDLETYPE handle;
+  OMX_INDEXTYPE nIndex;
+  OMX_PARAM_BELLAGIOKERNELTYPE sParam;
+  OMX_ERRORTYPE err;
+  int bSelected = 0;
+
+  setenv(sEnv, sKernel, 1);
+  err = OMX_GetHandle(&handle, sComponent, NULL, pCallbacks);
+  unsetenv(sEnv);
+  if (err != OMX_ErrorNone) {
+    return 0;
+  }
+  err = OMX_GetExtensionIndex(handle, "OMX.st.index.param.BellagioKernel", &nIndex);
+  if (err == OMX_ErrorNone) {
+    memset(&sParam, 0, sizeof(sParam));
+    sParam.nSize = sizeof(sParam);
+    sParam.nVersion.s.nVersionMajor = VERSIONMAJOR;
+    sParam.nVersion.s.nVersionMinor = VERSIONMINOR;
+    err = OMX_GetParameter(handle, nIndex, &sParam);
+  }
+  if (err == OMX_ErrorNone) {
+    bSelected = !strcmp((char*) sParam.cName, sKernel);
+  }
+  OMX_FreeHandle(handle);
+  return bSelected;
+}
+
+#endif
@@ -0,0 +1,463 @@
+/**
+  test/components/content_pipes/omxfilepipetest.c
+
+  This test application checks the file content pipe: the positioning
+  functions, the buffers returned by ReadBuffer with and without copies
+  allowed, and the buffers kept while the pipe reads further. It then
+  compares the throughput of ReadBuffer, that points into the file mapped
+  in memory, with the one of Read, that copies into the buffers of the client.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "omxfilepipetest.h"
+
+static char* fileName = DEFAULT_FILE;
+static char uri[512];
+static size_t nFileSize;
+static size_t nChunk;
+static int result = 0;
+static tsem_t eventSem;
+static CP_EVENTTYPE lastEvent;
+static CPuint lastParam;
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxfilepipetest [-s size] [-c chunk] [-r blocks] [file]\n");
+  printf("\n");
+  printf("       -s size: size of the file read, in MiB, default %d\n", DEFAULT_SIZE_MB);
+  printf("       -c chunk: size of the blocks read at each call, in KiB, default %d\n", DEFAULT_CHUNK_KB);
+  printf("       -r blocks: number of blocks of %d KiB read ahead, default %d\n", READAHEAD_BLOCK_KB, DEFAULT_READAHEAD_BLOCKS);
+  printf("       file: the file written and read back, default %s\n", DEFAULT_FILE);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+/** The content of the file at a given offset */
+static CPbyte pattern(size_t nOffset) {
+  return (CPbyte) ((nOffset ^ (nOffset >> 8) ^ (nOffset >> 16)) & 0xff);
+}
+
+/** A checksum that depends on the order of the bytes, carried across the calls */
+static OMX_U32 checksum(OMX_U32 sum, const CPbyte* pData, size_t nSize) {
+  size_t i;
+
+  for (i = 0; i < nSize; i++) {
+    sum = sum * 31 + (unsigned char) pData[i];
+  }
+  return sum;
+}
+
+/** A sum of the words of the data, cheap enough not to hide the cost of the
+ * reads in the benchmark. The blocks read are a multiple of the word long.
+ */
+static OMX_U64 fold(OMX_U64 sum, const CPbyte* pData, size_t nSize) {
+  const OMX_U64* pWord = (const OMX_U64*) pData;
+  size_t i;
+
+  for (i = 0; i < nSize / sizeof(OMX_U64); i++) {
+    sum += pWord[i];
+  }
+  return sum;
+}
+
+static void check(const char* step, int ok) {
+  DEBUG(DEFAULT_MESSAGES, "%-56s %s\n", step, ok ? "ok" : "FAILED");
+  if (!ok) {
+    result = -1;
+  }
+}
+
+/** Waits as the client would between two blocks */
+static void pace() {
+  usleep(PACE_US);
+}
+
+/** Drops the file from the page cache, so that it is read from the disk */
+static void dropCache() {
+  int fd = open(fileName, O_RDONLY);
+
+  if (fd != -1) {
+    /* the pages still dirty since writeFile are not dropped */
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+}
+
+static CPresult pipeCallback(CP_EVENTTYPE eEvent, CPuint iParam) {
+  lastEvent = eEvent;
+  lastParam = iParam;
+  tsem_up(&eventSem);
+  return 0;
+}
+
+/** Writes the file read by the test, and returns its checksum */
+static OMX_U32 writeFile() {
+  CPbyte* pData = malloc(nChunk);
+  OMX_U32 sum = 0;
+  size_t nOffset, nSize, i;
+  FILE* fd;
+
+  fd = fopen(fileName, "wb");
+  if (fd == NULL || pData == NULL) {
+    DEBUG(DEB_LEV_ERR, "Could not write %s\n", fileName);
+    exit(1);
+  }
+  for (nOffset = 0; nOffset < nFileSize; nOffset += nSize) {
+    nSize = nFileSize - nOffset < nChunk ? nFileSize - nOffset : nChunk;
+    for (i = 0; i < nSize; i++) {
+      pData[i] = pattern(nOffset + i);
+    }
+    sum = checksum(sum, pData, nSize);
+    fwrite(pData, 1, nSize, fd);
+  }
+  fclose(fd);
+  free(pData);
+  return sum;
+}
+
+static CP_PIPETYPE* openPipe() {
+  CP_PIPETYPE* pipe = NULL;
+
+  if (OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, uri) != OMX_ErrorNone || pipe == NULL) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetContentPipe() of %s failed\n", uri);
+    exit(1);
+  }
+  if (pipe->Open((CPhandle*) pipe, uri, CP_AccessRead) != 0) {
+    DEBUG(DEB_LEV_ERR, "Could not open %s\n", uri);
+    exit(1);
+  }
+  return pipe;
+}
+
+static void closePipe(CP_PIPETYPE* pipe) {
+  pipe->Close((CPhandle) pipe);
+  free(pipe);
+}
+
+/** Reads the whole file with Read, into a buffer of the client */
+static OMX_U64 readAll(CP_PIPETYPE* pipe) {
+  CPbyte* pData = malloc(nChunk);
+  OMX_U64 sum = 0;
+  size_t nOffset, nSize;
+
+  pipe->SetPosition((CPhandle) pipe, 0, CP_OriginBegin);
+  for (nOffset = 0; nOffset < nFileSize; nOffset += nSize) {
+    nSize = nFileSize - nOffset < nChunk ? nFileSize - nOffset : nChunk;
+    if (pipe->Read((CPhandle) pipe, pData, nSize) != 0) {
+      DEBUG(DEB_LEV_ERR, "Read failed at %i\n", (int) nOffset);
+      break;
+    }
+    sum = fold(sum, pData, nSize);
+  }
+  free(pData);
+  return sum;
+}
+
+/** Reads the whole file with Read, waiting after each block as a source
+ * would, and returns the time spent waiting in Read
+ */
+static long readPaced(CP_PIPETYPE* pipe, OMX_U64* pSum) {
+  struct timeval start, end;
+  CPbyte* pData = malloc(nChunk);
+  size_t nOffset, nSize;
+  long tStall = 0;
+
+  *pSum = 0;
+  pipe->SetPosition((CPhandle) pipe, 0, CP_OriginBegin);
+  for (nOffset = 0; nOffset < nFileSize; nOffset += nSize) {
+    nSize = nFileSize - nOffset < nChunk ? nFileSize - nOffset : nChunk;
+    gettimeofday(&start, NULL);
+    if (pipe->Read((CPhandle) pipe, pData, nSize) != 0) {
+      DEBUG(DEB_LEV_ERR, "Read failed at %i\n", (int) nOffset);
+      break;
+    }
+    gettimeofday(&end, NULL);
+    tStall += elapsed_us(&start, &end);
+    *pSum = fold(*pSum, pData, nSize);
+    pace();
+  }
+  free(pData);
+  return tStall;
+}
+
+/** Reads the whole file with ReadBuffer, as readAll does */
+static OMX_U64 readBufferFold(CP_PIPETYPE* pipe) {
+  CPbyte* pBuffer;
+  CPuint nSize;
+  OMX_U64 sum = 0;
+  size_t nOffset;
+
+  pipe->SetPosition((CPhandle) pipe, 0, CP_OriginBegin);
+  for (nOffset = 0; nOffset < nFileSize; nOffset += nSize) {
+    nSize = nChunk;
+    if (pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, OMX_FALSE) != 0 || nSize == 0) {
+      DEBUG(DEB_LEV_ERR, "ReadBuffer failed at %i\n", (int) nOffset);
+      break;
+    }
+    sum = fold(sum, pBuffer, nSize);
+    pipe->ReleaseReadBuffer((CPhandle) pipe, pBuffer);
+  }
+  return sum;
+}
+
+/** Reads the whole file with ReadBuffer, in blocks of nRequest bytes,
+ * and counts the blocks returned shorter than requested
+ */
+static OMX_U32 readBufferAll(CP_PIPETYPE* pipe, size_t nRequest, CPbool bForbidCopy, int* pShort) {
+  CPbyte* pBuffer;
+  CPuint nSize;
+  OMX_U32 sum = 0;
+  size_t nOffset;
+
+  *pShort = 0;
+  pipe->SetPosition((CPhandle) pipe, 0, CP_OriginBegin);
+  for (nOffset = 0; nOffset < nFileSize; nOffset += nSize) {
+    nSize = nRequest;
+    if (pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, bForbidCopy) != 0 || nSize == 0) {
+      DEBUG(DEB_LEV_ERR, "ReadBuffer failed at %i\n", (int) nOffset);
+      break;
+    }
+    if (nSize < nRequest && nOffset + nSize < nFileSize) {
+      (*pShort)++;
+    }
+    sum = checksum(sum, pBuffer, nSize);
+    pipe->ReleaseReadBuffer((CPhandle) pipe, pBuffer);
+  }
+  return sum;
+}
+
+/** Checks the positioning functions and the available bytes */
+static void checkPosition(CP_PIPETYPE* pipe) {
+  CP_CHECKBYTESRESULTTYPE eResult;
+  CPbyte* pBuffer;
+  CPuint nPosition, nSize;
+  CPbyte data[100];
+
+  pipe->SetPosition((CPhandle) pipe, 12345, CP_OriginBegin);
+  pipe->GetPosition((CPhandle) pipe, &nPosition);
+  check("SetPosition from the beginning", nPosition == 12345);
+
+  pipe->SetPosition((CPhandle) pipe, -345, CP_OriginCur);
+  pipe->GetPosition((CPhandle) pipe, &nPosition);
+  nSize = 1;
+  pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, OMX_FALSE);
+  check("SetPosition from the current position", nPosition == 12000 && nSize == 1 && pBuffer[0] == pattern(12000));
+  pipe->ReleaseReadBuffer((CPhandle) pipe, pBuffer);
+
+  pipe->SetPosition((CPhandle) pipe, -100, CP_OriginEnd);
+  pipe->GetPosition((CPhandle) pipe, &nPosition);
+  check("SetPosition from the end", nPosition == nFileSize - 100);
+
+  pipe->CheckAvailableBytes((CPhandle) pipe, 100, &eResult);
+  check("CheckAvailableBytes of the bytes left", eResult == CP_CheckBytesOk);
+  pipe->CheckAvailableBytes((CPhandle) pipe, 101, &eResult);
+  check("CheckAvailableBytes past the end", eResult == CP_CheckBytesInsufficientBytes);
+
+  pipe->Read((CPhandle) pipe, data, sizeof(data));
+  check("Read of the last bytes", data[99] == pattern(nFileSize - 1));
+  pipe->CheckAvailableBytes((CPhandle) pipe, 1, &eResult);
+  check("CheckAvailableBytes at the end", eResult == CP_CheckBytesAtEndOfStream);
+  nSize = 1;
+  check("ReadBuffer at the end", pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, OMX_FALSE) != 0 && nSize == 0);
+
+  pipe->SetPosition((CPhandle) pipe, -10, CP_OriginEnd);
+  nSize = 100;
+  pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, OMX_FALSE);
+  check("ReadBuffer shortened at the end", nSize == 10 && pBuffer[9] == pattern(nFileSize - 1));
+  pipe->ReleaseReadBuffer((CPhandle) pipe, pBuffer);
+}
+
+/** Checks the events and the reads of the read-ahead, around the end of the
+ * file and over seeks that move it
+ */
+static void checkReadAhead(CP_PIPETYPE* pipe, int nBlocks) {
+  CP_CHECKBYTESRESULTTYPE eResult;
+  CPbyte data[1000];
+  size_t nOffset;
+  int i, ok;
+
+  pipe->RegisterCallback((CPhandle) pipe, pipeCallback);
+
+  pipe->SetPosition((CPhandle) pipe, -100, CP_OriginEnd);
+  pipe->CheckAvailableBytes((CPhandle) pipe, 100, &eResult);
+  if (eResult == CP_CheckBytesNotReady) {
+    ok = tsem_timed_down(&eventSem, TIMEOUT) == 0 && lastEvent == CP_BytesAvailable && lastParam == 100;
+    check("CP_BytesAvailable sent for the bytes not ready", ok);
+    pipe->CheckAvailableBytes((CPhandle) pipe, 100, &eResult);
+  }
+  check("CheckAvailableBytes of the bytes left", eResult == CP_CheckBytesOk);
+  pipe->CheckAvailableBytes((CPhandle) pipe, 101, &eResult);
+  check("CheckAvailableBytes past the end", eResult == CP_CheckBytesInsufficientBytes);
+  pipe->Read((CPhandle) pipe, data, 100);
+  check("Read of the last bytes", data[99] == pattern(nFileSize - 1));
+  pipe->CheckAvailableBytes((CPhandle) pipe, 1, &eResult);
+  check("CheckAvailableBytes at the end", eResult == CP_CheckBytesAtEndOfStream);
+  check("Read past the end", pipe->Read((CPhandle) pipe, data, 1) != 0);
+
+  if ((size_t) nBlocks * READAHEAD_BLOCK_KB * 1024 < nFileSize) {
+    pipe->SetPosition((CPhandle) pipe, 0, CP_OriginBegin);
+    pipe->CheckAvailableBytes((CPhandle) pipe, nFileSize, &eResult);
+    ok = eResult == CP_CheckBytesOutOfBuffers && tsem_timed_down(&eventSem, TIMEOUT) == 0 && lastEvent == CP_Overflow;
+    check("CP_Overflow sent for more bytes than read ahead", ok);
+  }
+
+  /* the seeks drop the blocks read ahead, and the reads in flight */
+  srand(1);
+  ok = 1;
+  for (i = 0; i < SEEKS && ok; i++) {
+    nOffset = (size_t) rand() % (nFileSize - sizeof(data));
+    pipe->SetPosition((CPhandle) pipe, nOffset, CP_OriginBegin);
+    ok = pipe->Read((CPhandle) pipe, data, sizeof(data)) == 0 &&
+         data[0] == pattern(nOffset) && data[sizeof(data) - 1] == pattern(nOffset + sizeof(data) - 1);
+  }
+  check("Read after random seeks", ok);
+
+  pipe->RegisterCallback((CPhandle) pipe, NULL);
+}
+
+/** Keeps the first block while the rest of the file is read, so that the pipe
+ * has to keep its memory valid after moving on
+ */
+static void checkKeptBuffer(CP_PIPETYPE* pipe, OMX_U32 expected) {
+  CPbyte* pFirst;
+  CPuint nFirst = nChunk;
+  OMX_U32 sum;
+  int nShort;
+
+  pipe->SetPosition((CPhandle) pipe, 0, CP_OriginBegin);
+  pipe->ReadBuffer((CPhandle) pipe, &pFirst, &nFirst, OMX_FALSE);
+  sum = readBufferAll(pipe, nChunk, OMX_FALSE, &nShort);
+  check("file read while a buffer is kept", sum == expected);
+  check("kept buffer still valid", nFirst > 0 && pFirst[nFirst - 1] == pattern(nFirst - 1));
+  check("kept buffer released", pipe->ReleaseReadBuffer((CPhandle) pipe, pFirst) == 0);
+  check("unknown buffer refused", pipe->ReleaseReadBuffer((CPhandle) pipe, (CPbyte*) &sum) != 0);
+}
+
+int main(int argc, char** argv) {
+  struct timeval start, end;
+  CP_PIPETYPE* pipe;
+  OMX_U32 expected, sum;
+  OMX_U64 sumRead, sumReadBuffer;
+  long tRead = 0, tReadBuffer = 0, t;
+  int i, nShort, nSizeMB = DEFAULT_SIZE_MB, nChunkKB = DEFAULT_CHUNK_KB;
+  int nBlocks = DEFAULT_READAHEAD_BLOCKS;
+  long tStall, tStallReadAhead;
+  char config[32];
+
+  for (i = 1; i < argc; i++) {
+    if (argv[i][0] == '-') {
+      if (i + 1 >= argc || argv[i][1] == 'h') {
+        display_help();
+      }
+      switch (argv[i][1]) {
+      case 's':
+        nSizeMB = atoi(argv[++i]);
+        break;
+      case 'c':
+        nChunkKB = atoi(argv[++i]);
+        break;
+      case 'r':
+        nBlocks = atoi(argv[++i]);
+        break;
+      default:
+        display_help();
+      }
+    } else {
+      fileName = argv[i];
+    }
+  }
+  if (nSizeMB <= 0 || nChunkKB <= 0 || nBlocks <= 0) {
+    display_help();
+  }
+  nFileSize = (size_t) nSizeMB * 1024 * 1024;
+  nChunk = (size_t) nChunkKB * 1024;
+  snprintf(uri, sizeof(uri), "file://%s", fileName);
+
+  expected = writeFile();
+  tsem_init(&eventSem, 0);
+  unsetenv(READAHEAD_ENV);
+  pipe = openPipe();
+
+  checkPosition(pipe);
+
+  sum = readBufferAll(pipe, nChunk, OMX_FALSE, &nShort);
+  check("ReadBuffer of the whole file", sum == expected && nShort == 0);
+  /* blocks of an odd size straddle the boundaries of the mapped window */
+  sum = readBufferAll(pipe, nChunk + 12345, OMX_TRUE, &nShort);
+  check("ReadBuffer without copies, in segments", sum == expected);
+  DEBUG(DEFAULT_MESSAGES, "  %i blocks returned in segments\n", nShort);
+  sum = readBufferAll(pipe, nFileSize, OMX_FALSE, &nShort);
+  check("ReadBuffer of the whole file at once", sum == expected && nShort == 0);
+
+  checkKeptBuffer(pipe, expected);
+
+  /* the reads above brought the file in the page cache */
+  for (i = 0; i < BENCH_PASSES; i++) {
+    gettimeofday(&start, NULL);
+    sumRead = readAll(pipe);
+    gettimeofday(&end, NULL);
+    t = elapsed_us(&start, &end);
+    tRead = (i == 0 || t < tRead) ? t : tRead;
+
+    gettimeofday(&start, NULL);
+    sumReadBuffer = readBufferFold(pipe);
+    gettimeofday(&end, NULL);
+    t = elapsed_us(&start, &end);
+    tReadBuffer = (i == 0 || t < tReadBuffer) ? t : tReadBuffer;
+    check("Read and ReadBuffer of the whole file alike", sumRead == sumReadBuffer);
+  }
+  DEBUG(DEFAULT_MESSAGES, "%i MiB in blocks of %i KiB: Read %.1f MiB/s, ReadBuffer %.1f MiB/s\n",
+        nSizeMB, nChunkKB,
+        nSizeMB * 1000000.0 / (tRead > 0 ? tRead : 1),
+        nSizeMB * 1000000.0 / (tReadBuffer > 0 ? tReadBuffer : 1));
+
+  /* a client paced by the next component, reading from the disk */
+  dropCache();
+  tStall = readPaced(pipe, &sumRead);
+  closePipe(pipe);
+
+  snprintf(config, sizeof(config), "%i,%i", nBlocks, READAHEAD_BLOCK_KB);
+  setenv(READAHEAD_ENV, config, 1);
+  dropCache();
+  pipe = openPipe();
+  tStallReadAhead = readPaced(pipe, &sumReadBuffer);
+  check("Read with the read-ahead of the whole file", sumRead == sumReadBuffer);
+  DEBUG(DEFAULT_MESSAGES, "%i MiB from the disk, %i us between the blocks: Read waited %li us, %li us with %i blocks read ahead\n",
+        nSizeMB, PACE_US, tStall, tStallReadAhead, nBlocks);
+
+  checkReadAhead(pipe, nBlocks);
+  closePipe(pipe);
+
+  tsem_deinit(&eventSem);
+  unlink(fileName);
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result == 0 ? "PASSED" : "FAILED");
+  return result == 0 ? 0 : 1;
+}
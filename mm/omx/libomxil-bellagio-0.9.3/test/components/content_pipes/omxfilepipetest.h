@@ -0,0 +1,69 @@
+/**
+  test/components/content_pipes/omxfilepipetest.h
+
+  This test application checks the file content pipe, and compares the
+  throughput of its ReadBuffer function with the one of its Read function.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXFILEPIPETEST_H__
+#define __OMXFILEPIPETEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
+
+#include <bellagio/tsemaphore.h>
+#include <user_debug_levels.h>
+
+/** The file written and read back by the test, and its size in MiB */
+#define DEFAULT_FILE "/tmp/omxfilepipetest.dat"
+#define DEFAULT_SIZE_MB 64
+
+/** Size of the blocks read at each call, in KiB */
+#define DEFAULT_CHUNK_KB 64
+
+/** Times each path reads the whole file, the best time is reported */
+#define BENCH_PASSES 3
+
+/** The environment variable read by the file pipe for its read-ahead, the
+ * default number of blocks read ahead in the test, and their size
+ */
+#define READAHEAD_ENV "OMX_BELLAGIO_PIPE_READAHEAD"
+#define DEFAULT_READAHEAD_BLOCKS 8
+#define READAHEAD_BLOCK_KB 256
+
+/** Time the client waits after each block it reads, as a source waiting for
+ * its buffers to come back from the next component would, in microseconds
+ */
+#define PACE_US 100
+
+/** Random seeks checked with the read-ahead on */
+#define SEEKS 200
+
+/** Time allowed to the pipe to notify an event, in milliseconds */
+#define TIMEOUT 1000
+
+#endif
@@ -0,0 +1,220 @@
+/**
+  test/components/content_pipes/omxfilewritetest.c
+
+  This test application records many streams at once through the file
+  content pipe, each one in its own thread and file, with small writes
+  given alternately to Write and to GetWriteBuffer and WriteBuffer. At the
+  end each stream rewrites its header, as a recorder does. The files are
+  read back and checked, and the time taken is printed for the writes made
+  at once and for the write-behind, with and without O_DIRECT and fdatasync.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <string.h>
+#include <unistd.h>
+
+#include "omxfilewritetest.h"
+
+static int nStreams = DEFAULT_STREAMS;
+static size_t nFileSize;
+static size_t nWriteSize = DEFAULT_WRITE_SIZE;
+static int result = 0;
+
+/** The ways the streams are written, the first one with the write-behind off */
+static const char* modes[] = {
+  NULL,
+  "blocks=8",
+  "blocks=8,direct",
+  "blocks=8,sync=4",
+};
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxfilewritetest [-t streams] [-s size] [-w write]\n");
+  printf("\n");
+  printf("       -t streams: number of streams recorded at once, default %d\n", DEFAULT_STREAMS);
+  printf("       -s size: size of each stream, in MiB, default %d\n", DEFAULT_SIZE_MB);
+  printf("       -w write: size of each write, in bytes, default %d\n", DEFAULT_WRITE_SIZE);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+/** The content of the file of a stream at a given offset */
+static CPbyte pattern(int nStream, size_t nOffset) {
+  return (CPbyte) ((nOffset * 7 + (nOffset >> 12) + nStream * 13) & 0xff);
+}
+
+static void fill(CPbyte* pData, int nStream, size_t nOffset, size_t nSize) {
+  size_t i;
+
+  for (i = 0; i < nSize; i++) {
+    pData[i] = pattern(nStream, nOffset + i);
+  }
+}
+
+static void* streamThread(void* param) {
+  writeStreamType* stream = (writeStreamType*) param;
+  CPbyte* pData = malloc(nWriteSize > HEADER_SIZE ? nWriteSize : HEADER_SIZE);
+  CP_PIPETYPE* pipe = NULL;
+  CPbyte* pBuffer;
+  size_t nOffset, nSize;
+  int n;
+
+  if (OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, stream->uri) != OMX_ErrorNone || pipe == NULL ||
+      pipe->Create((CPhandle*) pipe, stream->uri) != 0) {
+    DEBUG(DEB_LEV_ERR, "Could not create %s\n", stream->uri);
+    stream->result = -1;
+    free(pData);
+    free(pipe);
+    return NULL;
+  }
+
+  for (nOffset = 0, n = 0; nOffset < nFileSize && stream->result == 0; nOffset += nSize, n++) {
+    nSize = nFileSize - nOffset < nWriteSize ? nFileSize - nOffset : nWriteSize;
+    if (n % 2 == 0) {
+      fill(pData, stream->nStream, nOffset, nSize);
+      stream->result = pipe->Write((CPhandle) pipe, pData, nSize) == 0 ? 0 : -1;
+    } else if (pipe->GetWriteBuffer((CPhandle) pipe, &pBuffer, nSize) == 0) {
+      fill(pBuffer, stream->nStream, nOffset, nSize);
+      stream->result = pipe->WriteBuffer((CPhandle) pipe, pBuffer, nSize) == 0 ? 0 : -1;
+    } else {
+      stream->result = -1;
+    }
+  }
+
+  /* the header is written last, once the size of the stream is known */
+  memset(pData, 'H', HEADER_SIZE);
+  pData[0] = (CPbyte) stream->nStream;
+  if (pipe->SetPosition((CPhandle) pipe, 0, CP_OriginBegin) != 0 ||
+      pipe->Write((CPhandle) pipe, pData, HEADER_SIZE) != 0 ||
+      pipe->SetPosition((CPhandle) pipe, 0, CP_OriginEnd) != 0) {
+    stream->result = -1;
+  }
+  if (pipe->Close((CPhandle) pipe) != 0) {
+    stream->result = -1;
+  }
+  if (stream->result != 0) {
+    DEBUG(DEB_LEV_ERR, "Stream %i failed at %i\n", stream->nStream, (int) nOffset);
+  }
+  free(pipe);
+  free(pData);
+  return NULL;
+}
+
+/** Reads back the file of a stream and checks it */
+static int checkFile(writeStreamType* stream) {
+  CPbyte* pData = malloc(65536);
+  size_t nOffset = 0, nSize, i;
+  int ok = 1;
+  FILE* fd;
+
+  fd = fopen(stream->uri + 7, "rb");
+  if (fd == NULL || pData == NULL) {
+    free(pData);
+    return 0;
+  }
+  while (ok && (nSize = fread(pData, 1, 65536, fd)) > 0) {
+    for (i = 0; i < nSize && ok; i++, nOffset++) {
+      if (nOffset < HEADER_SIZE) {
+        ok = pData[i] == (nOffset == 0 ? (CPbyte) stream->nStream : 'H');
+      } else {
+        ok = pData[i] == pattern(stream->nStream, nOffset);
+      }
+    }
+  }
+  fclose(fd);
+  free(pData);
+  return ok && nOffset == nFileSize;
+}
+
+int main(int argc, char** argv) {
+  struct timeval start, end;
+  writeStreamType* streams;
+  int i, m, ok, nSizeMB = DEFAULT_SIZE_MB;
+
+  for (i = 1; i < argc; i++) {
+    if (argv[i][0] == '-') {
+      if (i + 1 >= argc || argv[i][1] == 'h') {
+        display_help();
+      }
+      switch (argv[i][1]) {
+      case 't':
+        nStreams = atoi(argv[++i]);
+        break;
+      case 's':
+        nSizeMB = atoi(argv[++i]);
+        break;
+      case 'w':
+        nWriteSize = atoi(argv[++i]);
+        break;
+      default:
+        display_help();
+      }
+    } else {
+      display_help();
+    }
+  }
+  if (nStreams <= 0 || nSizeMB <= 0 || (int) nWriteSize <= 0) {
+    display_help();
+  }
+  nFileSize = (size_t) nSizeMB * 1024 * 1024;
+  streams = calloc(nStreams, sizeof(writeStreamType));
+
+  for (m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+    if (modes[m] == NULL) {
+      unsetenv(WRITEBEHIND_ENV);
+    } else {
+      setenv(WRITEBEHIND_ENV, modes[m], 1);
+    }
+    gettimeofday(&start, NULL);
+    for (i = 0; i < nStreams; i++) {
+      streams[i].nStream = i;
+      streams[i].result = 0;
+      snprintf(streams[i].uri, sizeof(streams[i].uri), "file://" FILE_PATTERN, i);
+      pthread_create(&streams[i].thread, NULL, streamThread, &streams[i]);
+    }
+    for (i = 0; i < nStreams; i++) {
+      pthread_join(streams[i].thread, NULL);
+    }
+    gettimeofday(&end, NULL);
+
+    ok = 1;
+    for (i = 0; i < nStreams; i++) {
+      ok = ok && streams[i].result == 0 && checkFile(&streams[i]);
+      unlink(streams[i].uri + 7);
+    }
+    DEBUG(DEFAULT_MESSAGES, "%-24s %i streams of %i MiB in writes of %i bytes: %8li us %s\n",
+          modes[m] == NULL ? "written at once" : modes[m], nStreams, nSizeMB, (int) nWriteSize,
+          elapsed_us(&start, &end), ok ? "ok" : "FAILED");
+    if (!ok) {
+      result = -1;
+    }
+  }
+
+  free(streams);
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result == 0 ? "PASSED" : "FAILED");
+  return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+/**
+  test/components/content_pipes/omxfilewritetest.h
+
+  This test application records many streams at once through the file
+  content pipe, and compares the time taken with and without its write-behind.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXFILEWRITETEST_H__
+#define __OMXFILEWRITETEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
+
+#include <user_debug_levels.h>
+
+/** The files written by the streams, numbered after them */
+#define FILE_PATTERN "/tmp/omxfilewritetest.%i.dat"
+
+#define DEFAULT_STREAMS 4
+#define DEFAULT_SIZE_MB 16
+#define DEFAULT_WRITE_SIZE 1024
+
+/** The header rewritten by each stream at the beginning of its file when done */
+#define HEADER_SIZE 16
+
+/** The environment variable read by the file pipe for its write-behind */
+#define WRITEBEHIND_ENV "OMX_BELLAGIO_PIPE_WRITEBEHIND"
+
+/** A recording stream, with its own pipe and file */
+typedef struct writeStreamType {
+  int nStream;
+  pthread_t thread;
+  char uri[256];
+  int result;
+} writeStreamType;
+
+#endif
@@ -0,0 +1,310 @@
+/**
+  test/components/content_pipes/omxinetingesttest.c
+
+  This test application ingests many live streams at once over the loopback.
+  The receiving pipes are created on one port with a stream identifier each,
+  so that they share the receive loops of one server. Some threads send the
+  streams in small packets, while a single thread reads all of them without
+  blocking, as an ingest component would, waiting for the CP_BytesAvailable
+  events when none has data. The test is run with one receive loop and with
+  several loops sharing the port, and for comparison with a port and a loop
+  per stream. It prints the throughput and the CPU time of each run.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <string.h>
+#include <unistd.h>
+
+#include "omxinetingesttest.h"
+
+static int nPort = DEFAULT_PORT;
+static int nStreams = DEFAULT_STREAMS;
+static int bPortPerStream;
+static size_t nStreamSize;
+static ingestStreamType* streams;
+static int result = 0;
+
+/* the events of all the receiving pipes wake the reader up */
+static pthread_mutex_t eventMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t eventCond = PTHREAD_COND_INITIALIZER;
+static int bEventPending = 0;
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxinetingesttest [-p port] [-n streams] [-s size] [-l loops] [-r ring]\n");
+  printf("\n");
+  printf("       -p port: loopback port shared by the streams, default %d\n", DEFAULT_PORT);
+  printf("       -n streams: number of streams ingested at once, default %d\n", DEFAULT_STREAMS);
+  printf("       -s size: size of each stream, in KiB, default %d\n", DEFAULT_SIZE_KB);
+  printf("       -l loops: receive loops sharing the port in the second run, default %d\n", DEFAULT_LOOPS);
+  printf("       -r ring: size of the ring of each pipe, in KiB, default %d\n", DEFAULT_RING_KB);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+static long cpu_us(void) {
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec * 1000000 + usage.ru_utime.tv_usec +
+         usage.ru_stime.tv_sec * 1000000 + usage.ru_stime.tv_usec;
+}
+
+/** The content of a stream at a given offset */
+static CPbyte pattern(int nStream, size_t nOffset) {
+  return (CPbyte) ((nOffset * 7 + (nOffset >> 12) + nStream * 13) & 0xff);
+}
+
+static CPresult ingestCallback(CP_EVENTTYPE eEvent, CPuint iParam) {
+  pthread_mutex_lock(&eventMutex);
+  bEventPending = 1;
+  pthread_cond_signal(&eventCond);
+  pthread_mutex_unlock(&eventMutex);
+  return 0;
+}
+
+/** Opens the streams of a writer, and sends them a packet each in turn */
+static void* writerThread(void* param) {
+  int nWriter = (int) (long) param;
+  CPbyte* pData = malloc(PACKET_SIZE);
+  size_t nOffset, nSize, i;
+  char uri[64];
+  int s;
+
+  for (s = nWriter; s < nStreams; s += WRITER_THREADS) {
+    if (bPortPerStream) {
+      snprintf(uri, sizeof(uri), "inet://127.0.0.1:%i", nPort + 1 + s);
+    } else {
+      snprintf(uri, sizeof(uri), "inet://127.0.0.1:%i/stream%i", nPort, s);
+    }
+    if (OMX_GetContentPipe((OMX_HANDLETYPE*) &streams[s].pSender, uri) != OMX_ErrorNone ||
+        streams[s].pSender == NULL ||
+        streams[s].pSender->Open((CPhandle*) streams[s].pSender, uri, CP_AccessWrite) != 0) {
+      DEBUG(DEB_LEV_ERR, "Could not open %s\n", uri);
+      free(streams[s].pSender);
+      streams[s].pSender = NULL;
+      streams[s].bFailed = 1;
+    }
+  }
+
+  for (nOffset = 0; nOffset < nStreamSize; nOffset += nSize) {
+    nSize = nStreamSize - nOffset < PACKET_SIZE ? nStreamSize - nOffset : PACKET_SIZE;
+    for (s = nWriter; s < nStreams; s += WRITER_THREADS) {
+      if (streams[s].pSender == NULL) {
+        continue;
+      }
+      for (i = 0; i < nSize; i++) {
+        pData[i] = pattern(s, nOffset + i);
+      }
+      if (streams[s].pSender->Write((CPhandle) streams[s].pSender, pData, nSize) != 0) {
+        streams[s].bFailed = 1;
+      }
+    }
+  }
+
+  for (s = nWriter; s < nStreams; s += WRITER_THREADS) {
+    if (streams[s].pSender != NULL) {
+      streams[s].pSender->Close((CPhandle) streams[s].pSender);
+      free(streams[s].pSender);
+      streams[s].pSender = NULL;
+    }
+  }
+  free(pData);
+  return NULL;
+}
+
+/** Reads what a stream received, without waiting, and returns whether it had some */
+static int readStream(int s) {
+  CP_PIPETYPE* pipe = streams[s].pReceiver;
+  CP_CHECKBYTESRESULTTYPE eResult;
+  CPbyte* pBuffer;
+  CPuint nSize, i;
+
+  if (pipe->CheckAvailableBytes((CPhandle) pipe, 1, &eResult) != 0) {
+    streams[s].bFailed = 1;
+    streams[s].bDone = 1;
+    return 0;
+  }
+  if (eResult == CP_CheckBytesAtEndOfStream) {
+    streams[s].bDone = 1;
+    return 1;
+  }
+  if (eResult != CP_CheckBytesOk) {
+    return 0;
+  }
+
+  nSize = READ_SIZE;
+  if (pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, OMX_TRUE) != 0) {
+    streams[s].bFailed = 1;
+    streams[s].bDone = 1;
+    return 0;
+  }
+  for (i = 0; i < nSize; i++) {
+    if (pBuffer[i] != pattern(s, streams[s].nReceived + i)) {
+      streams[s].bFailed = 1;
+      break;
+    }
+  }
+  streams[s].nReceived += nSize;
+  pipe->ReleaseReadBuffer((CPhandle) pipe, pBuffer);
+  return 1;
+}
+
+/** Ingests all the streams with the receive loops given, or with a port and
+ * a loop per stream when nLoops is 0, and returns whether they were all right
+ */
+static int ingest(int nLoops, int nRingKB) {
+  struct timeval start, end;
+  pthread_t writers[WRITER_THREADS];
+  char config[64], uri[64];
+  long nCpu, nElapsed;
+  int s, w, nDone, bProgress, ok = 1;
+
+  bPortPerStream = nLoops == 0;
+  snprintf(config, sizeof(config), "loops=%i,ring=%i", bPortPerStream ? 1 : nLoops, nRingKB);
+  setenv(INET_ENV, config, 1);
+  memset(streams, 0, nStreams * sizeof(ingestStreamType));
+
+  for (s = 0; s < nStreams; s++) {
+    if (bPortPerStream) {
+      snprintf(uri, sizeof(uri), "inet://%i", nPort + 1 + s);
+    } else {
+      snprintf(uri, sizeof(uri), "inet://%i/stream%i", nPort, s);
+    }
+    if (OMX_GetContentPipe((OMX_HANDLETYPE*) &streams[s].pReceiver, uri) != OMX_ErrorNone ||
+        streams[s].pReceiver == NULL ||
+        streams[s].pReceiver->Create((CPhandle*) streams[s].pReceiver, uri) != 0) {
+      DEBUG(DEB_LEV_ERR, "Could not create %s\n", uri);
+      free(streams[s].pReceiver);
+      for (s = s - 1; s >= 0; s--) {
+        streams[s].pReceiver->Close((CPhandle) streams[s].pReceiver);
+        free(streams[s].pReceiver);
+      }
+      return 0;
+    }
+    streams[s].pReceiver->RegisterCallback((CPhandle) streams[s].pReceiver, ingestCallback);
+  }
+
+  gettimeofday(&start, NULL);
+  nCpu = cpu_us();
+  for (w = 0; w < WRITER_THREADS; w++) {
+    pthread_create(&writers[w], NULL, writerThread, (void*) (long) w);
+  }
+
+  /* the pipes that have nothing to read ask for an event when they have */
+  for (nDone = 0; nDone < nStreams; ) {
+    pthread_mutex_lock(&eventMutex);
+    bEventPending = 0;
+    pthread_mutex_unlock(&eventMutex);
+    bProgress = 0;
+    for (s = 0; s < nStreams; s++) {
+      if (!streams[s].bDone) {
+        bProgress |= readStream(s);
+        nDone += streams[s].bDone;
+      }
+    }
+    if (!bProgress) {
+      pthread_mutex_lock(&eventMutex);
+      while (!bEventPending) {
+        pthread_cond_wait(&eventCond, &eventMutex);
+      }
+      pthread_mutex_unlock(&eventMutex);
+    }
+  }
+
+  for (w = 0; w < WRITER_THREADS; w++) {
+    pthread_join(writers[w], NULL);
+  }
+  nCpu = cpu_us() - nCpu;
+  gettimeofday(&end, NULL);
+  nElapsed = elapsed_us(&start, &end);
+
+  for (s = 0; s < nStreams; s++) {
+    if (streams[s].bFailed || streams[s].nReceived != nStreamSize) {
+      DEBUG(DEB_LEV_ERR, "Stream %i failed, %i bytes received\n", s, (int) streams[s].nReceived);
+      ok = 0;
+    }
+    streams[s].pReceiver->Close((CPhandle) streams[s].pReceiver);
+    free(streams[s].pReceiver);
+  }
+
+  if (bPortPerStream) {
+    DEBUG(DEFAULT_MESSAGES, "a port per stream: ");
+  } else {
+    DEBUG(DEFAULT_MESSAGES, "%2i shared loops:   ", nLoops);
+  }
+  DEBUG(DEFAULT_MESSAGES, "%i streams of %i KiB in %8li us, %5li MiB/s, CPU %8li us (%3li%%) %s\n",
+        nStreams, (int) (nStreamSize / 1024), nElapsed,
+        (long) ((double) nStreams * nStreamSize / (1024 * 1024) * 1000000 / (nElapsed + 1)),
+        nCpu, nCpu * 100 / (nElapsed + 1), ok ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  int i, nSizeKB = DEFAULT_SIZE_KB, nLoops = DEFAULT_LOOPS, nRingKB = DEFAULT_RING_KB;
+
+  for (i = 1; i < argc; i++) {
+    if (argv[i][0] == '-') {
+      if (i + 1 >= argc || argv[i][1] == 'h') {
+        display_help();
+      }
+      switch (argv[i][1]) {
+      case 'p':
+        nPort = atoi(argv[++i]);
+        break;
+      case 'n':
+        nStreams = atoi(argv[++i]);
+        break;
+      case 's':
+        nSizeKB = atoi(argv[++i]);
+        break;
+      case 'l':
+        nLoops = atoi(argv[++i]);
+        break;
+      case 'r':
+        nRingKB = atoi(argv[++i]);
+        break;
+      default:
+        display_help();
+      }
+    } else {
+      display_help();
+    }
+  }
+  if (nPort <= 0 || nStreams <= 0 || nSizeKB <= 0 || nLoops <= 0 || nRingKB <= 0) {
+    display_help();
+  }
+  nStreamSize = (size_t) nSizeKB * 1024;
+  streams = calloc(nStreams, sizeof(ingestStreamType));
+
+  if (!ingest(0, nRingKB) || !ingest(1, nRingKB) || !ingest(nLoops, nRingKB)) {
+    result = -1;
+  }
+
+  free(streams);
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result == 0 ? "PASSED" : "FAILED");
+  return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+/**
+  test/components/content_pipes/omxinetingesttest.h
+
+  This test application ingests many live streams at once over the loopback,
+  through inet content pipes sharing one port, and measures the throughput
+  and the CPU time taken.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXINETINGESTTEST_H__
+#define __OMXINETINGESTTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
+
+#include <user_debug_levels.h>
+
+/** The streams with a port each take the ports following this one, kept
+ * below the ephemeral ports given to the peers
+ */
+#define DEFAULT_PORT 20124
+#define DEFAULT_STREAMS 256
+#define DEFAULT_SIZE_KB 1024
+#define DEFAULT_LOOPS 4
+#define DEFAULT_RING_KB 64
+
+/** The environment variable configuring the loops of the inet pipes */
+#define INET_ENV "OMX_BELLAGIO_PIPE_INET"
+
+/** Threads sending the streams, each one sending its share of them */
+#define WRITER_THREADS 8
+
+/** Size of the packets sent, and largest buffer read at once */
+#define PACKET_SIZE 1316
+#define READ_SIZE 65536
+
+/** A stream, with the pipe sending it and the pipe receiving it */
+typedef struct ingestStreamType {
+  CP_PIPETYPE* pSender;
+  CP_PIPETYPE* pReceiver;
+  size_t nReceived;
+  int bDone;
+  int bFailed;
+} ingestStreamType;
+
+#endif
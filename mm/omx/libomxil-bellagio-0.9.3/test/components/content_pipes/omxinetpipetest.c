@@ -0,0 +1,270 @@
+/**
+  test/components/content_pipes/omxinetpipetest.c
+
+  This test application streams data over the loopback through the inet
+  content pipe. A client thread writes a pattern in blocks of varied sizes,
+  while the server reads it with Read and with ReadBuffer, with and without
+  copies allowed, keeping some buffers out. The test checks that Create does
+  not wait for the peer, the results of CheckAvailableBytes, the events sent
+  to the callback, and the data read, and prints the throughput.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <string.h>
+#include <unistd.h>
+
+#include "omxinetpipetest.h"
+
+static int nPort = DEFAULT_PORT;
+static size_t nStreamSize;
+static int result = 0;
+
+static volatile int nBytesAvailableEvents = 0;
+static volatile int nDisconnectedEvents = 0;
+static volatile int nOverflowEvents = 0;
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxinetpipetest [-p port] [-s size]\n");
+  printf("\n");
+  printf("       -p port: loopback port used, default %d\n", DEFAULT_PORT);
+  printf("       -s size: size of the stream, in MiB, default %d\n", DEFAULT_SIZE_MB);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+static void check(const char* step, int ok) {
+  DEBUG(DEFAULT_MESSAGES, "%-56s %s\n", step, ok ? "ok" : "FAILED");
+  if (!ok) {
+    result = -1;
+  }
+}
+
+/** The content of the stream at a given offset */
+static CPbyte pattern(size_t nOffset) {
+  return (CPbyte) ((nOffset * 7 + (nOffset >> 12)) & 0xff);
+}
+
+static int verify(CPbyte* pData, size_t nOffset, size_t nSize) {
+  size_t i;
+
+  for (i = 0; i < nSize; i++) {
+    if (pData[i] != pattern(nOffset + i)) {
+      DEBUG(DEB_LEV_ERR, "Wrong byte at %i\n", (int) (nOffset + i));
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/** Sizes of the blocks, varied so that they straddle the end of the ring */
+static size_t blockSize(int n) {
+  return 1 + (size_t) (n * 7919) % MAX_BLOCK_SIZE;
+}
+
+static CPresult serverCallback(CP_EVENTTYPE eEvent, CPuint iParam) {
+  switch (eEvent) {
+  case CP_BytesAvailable:
+    nBytesAvailableEvents++;
+    break;
+  case CP_PipeDisconnected:
+    nDisconnectedEvents++;
+    break;
+  case CP_Overflow:
+    nOverflowEvents++;
+    break;
+  default:
+    break;
+  }
+  return 0;
+}
+
+/** Connects to the server and writes the stream */
+static void* clientThread(void* param) {
+  CPbyte* pData = malloc(MAX_BLOCK_SIZE);
+  CP_PIPETYPE* pipe = NULL;
+  size_t nOffset, nSize, i;
+  char uri[64];
+  int n, ok = 1;
+
+  snprintf(uri, sizeof(uri), "inet://127.0.0.1:%i", nPort);
+  if (OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, uri) != OMX_ErrorNone || pipe == NULL ||
+      pipe->Open((CPhandle*) pipe, uri, CP_AccessWrite) != 0) {
+    DEBUG(DEB_LEV_ERR, "Could not open %s\n", uri);
+    free(pipe);
+    free(pData);
+    *((int*) param) = 0;
+    return NULL;
+  }
+
+  for (nOffset = 0, n = 0; nOffset < nStreamSize && ok; nOffset += nSize, n++) {
+    nSize = blockSize(n);
+    if (nSize > nStreamSize - nOffset) {
+      nSize = nStreamSize - nOffset;
+    }
+    for (i = 0; i < nSize; i++) {
+      pData[i] = pattern(nOffset + i);
+    }
+    ok = pipe->Write((CPhandle) pipe, pData, nSize) == 0;
+  }
+
+  if (pipe->Close((CPhandle) pipe) != 0) {
+    ok = 0;
+  }
+  free(pipe);
+  free(pData);
+  *((int*) param) = ok;
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  CPbyte* pKept[KEPT_BUFFERS];
+  CPbyte* pData;
+  CPbyte* pBuffer;
+  CP_PIPETYPE* pipe = NULL;
+  CP_CHECKBYTESRESULTTYPE eResult;
+  struct timeval start, end;
+  pthread_t client;
+  size_t nOffset = 0;
+  CPuint nSize, nPosition;
+  CPresult err;
+  char uri[64];
+  int i, n, ok, nKept = 0, nTruncated = 0, bClientOk = 0, nSizeMB = DEFAULT_SIZE_MB;
+
+  for (i = 1; i < argc; i++) {
+    if (argv[i][0] == '-') {
+      if (i + 1 >= argc || argv[i][1] == 'h') {
+        display_help();
+      }
+      switch (argv[i][1]) {
+      case 'p':
+        nPort = atoi(argv[++i]);
+        break;
+      case 's':
+        nSizeMB = atoi(argv[++i]);
+        break;
+      default:
+        display_help();
+      }
+    } else {
+      display_help();
+    }
+  }
+  if (nPort <= 0 || nSizeMB <= 0) {
+    display_help();
+  }
+  nStreamSize = (size_t) nSizeMB * 1024 * 1024;
+  pData = malloc(MAX_BLOCK_SIZE);
+  unsetenv(INET_ENV);
+
+  /* the server does not wait for its peer */
+  snprintf(uri, sizeof(uri), "inet://%i", nPort);
+  gettimeofday(&start, NULL);
+  if (OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, uri) != OMX_ErrorNone || pipe == NULL ||
+      pipe->Create((CPhandle*) pipe, uri) != 0) {
+    DEBUG(DEB_LEV_ERR, "Could not create %s\n", uri);
+    free(pipe);
+    free(pData);
+    exit(1);
+  }
+  gettimeofday(&end, NULL);
+  check("Create returns before the peer connects", elapsed_us(&start, &end) < CREATE_TIMEOUT_US);
+  pipe->RegisterCallback((CPhandle) pipe, serverCallback);
+
+  err = pipe->CheckAvailableBytes((CPhandle) pipe, 1, &eResult);
+  check("no data before the peer connects", err == 0 && eResult == CP_CheckBytesNotReady);
+
+  pthread_create(&client, NULL, clientThread, &bClientOk);
+
+  /* the ring fills while the server does not read */
+  usleep(FILL_DELAY_US);
+  check("CP_BytesAvailable sent for the bytes waited", nBytesAvailableEvents == 1);
+  err = pipe->CheckAvailableBytes((CPhandle) pipe, INET_RING_SIZE, &eResult);
+  check("the ring is full", err == 0 && eResult == CP_CheckBytesOk);
+  err = pipe->CheckAvailableBytes((CPhandle) pipe, INET_RING_SIZE + 1, &eResult);
+  check("more than the ring is out of buffers",
+        err == 0 && eResult == CP_CheckBytesOutOfBuffers && nOverflowEvents == 1);
+
+  gettimeofday(&start, NULL);
+  ok = 1;
+  for (n = 0; ok; n++) {
+    nSize = blockSize(n);
+    if (n % 3 == 0) {
+      /* Read waits for the whole block, and copies less only at the end */
+      err = pipe->Read((CPhandle) pipe, pData, nSize);
+      pipe->GetPosition((CPhandle) pipe, &nPosition);
+      ok = verify(pData, nOffset, nPosition - nOffset);
+      if (err != 0) {
+        ok = ok && nPosition == nStreamSize;
+        nOffset = nPosition;
+        break;
+      }
+      ok = ok && nPosition == nOffset + nSize;
+      nOffset = nPosition;
+    } else {
+      err = pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, n % 3 == 1);
+      if (err != 0) {
+        ok = nOffset == nStreamSize && nSize == 0;
+        break;
+      }
+      if (n % 3 == 1 && nSize < blockSize(n) && (nOffset + nSize) % INET_RING_SIZE == 0) {
+        nTruncated++;
+      }
+      ok = verify(pBuffer, nOffset, nSize);
+      nOffset += nSize;
+      /* the buffers are released later, and in order */
+      if (nKept == KEPT_BUFFERS) {
+        pipe->ReleaseReadBuffer((CPhandle) pipe, pKept[0]);
+        memmove(pKept, pKept + 1, (KEPT_BUFFERS - 1) * sizeof(CPbyte*));
+        nKept--;
+      }
+      pKept[nKept++] = pBuffer;
+    }
+  }
+  gettimeofday(&end, NULL);
+  for (i = 0; i < nKept; i++) {
+    pipe->ReleaseReadBuffer((CPhandle) pipe, pKept[i]);
+  }
+  pthread_join(client, NULL);
+
+  check("the client wrote the stream", bClientOk);
+  check("the stream read back with Read and ReadBuffer", ok && nOffset == nStreamSize);
+  check("ReadBuffer stopped at the end of the ring without copy",
+        nStreamSize <= 2 * INET_RING_SIZE || nTruncated > 0);
+  err = pipe->CheckAvailableBytes((CPhandle) pipe, 1, &eResult);
+  check("the stream is at its end", err == 0 && eResult == CP_CheckBytesAtEndOfStream);
+  check("CP_PipeDisconnected sent", nDisconnectedEvents == 1);
+  DEBUG(DEFAULT_MESSAGES, "%i MiB received in %li us, %li MiB/s\n", nSizeMB, elapsed_us(&start, &end),
+        (long) nSizeMB * 1000000 / (elapsed_us(&start, &end) + 1));
+
+  if (pipe->Close((CPhandle) pipe) != 0) {
+    result = -1;
+  }
+  free(pipe);
+  free(pData);
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result == 0 ? "PASSED" : "FAILED");
+  return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+/**
+  test/components/content_pipes/omxinetpipetest.h
+
+  This test application streams data over the loopback through the inet
+  content pipe, and checks what the receiving side reads from its ring.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXINETPIPETEST_H__
+#define __OMXINETPIPETEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
+
+#include <user_debug_levels.h>
+
+#define DEFAULT_PORT 40123
+#define DEFAULT_SIZE_MB 16
+
+/** The environment variable configuring the inet pipe, unset so that its
+ * ring has the default size
+ */
+#define INET_ENV "OMX_BELLAGIO_PIPE_INET"
+
+/** Size of the ring of the inet pipe, so that the test can ask for more */
+#define INET_RING_SIZE (1024 * 1024)
+
+/** Largest block read or written at once by the test */
+#define MAX_BLOCK_SIZE 65536
+
+/** Buffers the test keeps out of ReadBuffer before releasing the first one */
+#define KEPT_BUFFERS 4
+
+/** Time the reader sleeps before reading, so that the ring fills, in microseconds */
+#define FILL_DELAY_US 200000
+
+/** Time allowed to Create to return, in microseconds */
+#define CREATE_TIMEOUT_US 100000
+
+#endif
@@ -0,0 +1,452 @@
+/**
+  test/components/content_pipes/omxmempipetest.c
+
+  This test application streams data through the mem and shm content pipes.
+  A thread writes a pattern in a named mem arena while the main thread reads
+  it back, waiting for the CP_BytesAvailable events. A buffer of the client is
+  written and read in place. Then a child process reads what its parent writes
+  in a shm pipe. The test checks the data, the buffers returned without copy,
+  and the schemes added to the core, and prints the throughput.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "omxmempipetest.h"
+
+static size_t nStreamSize;
+static int result = 0;
+
+static pthread_mutex_t availableMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t availableCond = PTHREAD_COND_INITIALIZER;
+static int bAvailable = 0;
+static int nBytesAvailableEvents = 0;
+
+static int nTestPipes = 0;
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxmempipetest [-s size]\n");
+  printf("\n");
+  printf("       -s size: size of the streams, in MiB, default %d\n", DEFAULT_SIZE_MB);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+static void check(const char* step, int ok) {
+  DEBUG(DEFAULT_MESSAGES, "%-56s %s\n", step, ok ? "ok" : "FAILED");
+  if (!ok) {
+    result = -1;
+  }
+}
+
+/** The content of the stream at a given offset */
+static CPbyte pattern(size_t nOffset) {
+  return (CPbyte) ((nOffset * 7 + (nOffset >> 12)) & 0xff);
+}
+
+static int verify(CPbyte* pData, size_t nOffset, size_t nSize) {
+  size_t i;
+
+  for (i = 0; i < nSize; i++) {
+    if (pData[i] != pattern(nOffset + i)) {
+      DEBUG(DEB_LEV_ERR, "Wrong byte at %i\n", (int) (nOffset + i));
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void fill(CPbyte* pData, size_t nOffset, size_t nSize) {
+  size_t i;
+
+  for (i = 0; i < nSize; i++) {
+    pData[i] = pattern(nOffset + i);
+  }
+}
+
+/** Sizes of the blocks, varied so that they straddle the ends of the chunks and rings */
+static size_t blockSize(int n) {
+  return 1 + (size_t) (n * 7919) % MAX_BLOCK_SIZE;
+}
+
+/** Whether an offset of a mem arena is the end of one of its chunks */
+static int isChunkEnd(size_t nOffset) {
+  size_t nChunks;
+
+  if (nOffset % MEM_CHUNK_SIZE != 0) {
+    return 0;
+  }
+  nChunks = nOffset / MEM_CHUNK_SIZE + 1;
+  return (nChunks & (nChunks - 1)) == 0;
+}
+
+static CPresult readerCallback(CP_EVENTTYPE eEvent, CPuint iParam) {
+  if (eEvent == CP_BytesAvailable) {
+    pthread_mutex_lock(&availableMutex);
+    bAvailable = 1;
+    nBytesAvailableEvents++;
+    pthread_cond_signal(&availableCond);
+    pthread_mutex_unlock(&availableMutex);
+  }
+  return 0;
+}
+
+/** Writes the stream, in blocks given alternately to Write and GetWriteBuffer */
+static int writeStream(CP_PIPETYPE* pipe, CPbyte* pData) {
+  size_t nOffset, nSize;
+  CPbyte* pBuffer;
+  int n, ok = 1;
+
+  for (nOffset = 0, n = 0; nOffset < nStreamSize && ok; nOffset += nSize, n++) {
+    nSize = blockSize(n);
+    if (nSize > nStreamSize - nOffset) {
+      nSize = nStreamSize - nOffset;
+    }
+    if (n % 2 == 0) {
+      fill(pData, nOffset, nSize);
+      ok = pipe->Write((CPhandle) pipe, pData, nSize) == 0;
+    } else {
+      ok = pipe->GetWriteBuffer((CPhandle) pipe, &pBuffer, nSize) == 0;
+      if (ok) {
+        fill(pBuffer, nOffset, nSize);
+        ok = pipe->WriteBuffer((CPhandle) pipe, pBuffer, nSize) == 0;
+      }
+    }
+  }
+  return ok;
+}
+
+/** Writes the stream in the mem arena, and closes its pipe */
+static void* writerThread(void* param) {
+  CP_PIPETYPE* pipe = (CP_PIPETYPE*) param;
+  CPbyte* pData = malloc(MAX_BLOCK_SIZE);
+  int ok;
+
+  ok = writeStream(pipe, pData);
+  if (pipe->Close((CPhandle) pipe) != 0) {
+    ok = 0;
+  }
+  free(pData);
+  return ok ? param : NULL;
+}
+
+/** Reads a stream with ReadBuffer, waiting for the bytes with the callback,
+ * and keeping some buffers out. Returns the bytes read, or 0 on errors.
+ */
+static size_t readStream(CP_PIPETYPE* pipe, int bChunks, int* pnTruncated, int* pnStraddling, size_t nRingSize) {
+  CPbyte* pKept[KEPT_BUFFERS];
+  CPbyte* pBuffer;
+  CP_CHECKBYTESRESULTTYPE eResult;
+  size_t nOffset = 0;
+  CPuint nSize;
+  int i, n, nKept = 0, ok = 1;
+
+  for (n = 0; ok; n++) {
+    nSize = blockSize(n);
+    pthread_mutex_lock(&availableMutex);
+    bAvailable = 0;
+    pthread_mutex_unlock(&availableMutex);
+    ok = pipe->CheckAvailableBytes((CPhandle) pipe, nSize, &eResult) == 0;
+    if (!ok || eResult == CP_CheckBytesAtEndOfStream) {
+      break;
+    }
+    if (eResult == CP_CheckBytesNotReady) {
+      pthread_mutex_lock(&availableMutex);
+      while (!bAvailable) {
+        pthread_cond_wait(&availableCond, &availableMutex);
+      }
+      pthread_mutex_unlock(&availableMutex);
+      n--;
+      continue;
+    }
+    if (eResult != CP_CheckBytesOk && eResult != CP_CheckBytesInsufficientBytes) {
+      ok = 0;
+      break;
+    }
+
+    ok = pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, n % 2 == 1) == 0;
+    if (!ok) {
+      break;
+    }
+    if (bChunks && nSize < blockSize(n) && isChunkEnd(nOffset + nSize)) {
+      (*pnTruncated)++;
+    }
+    if (nRingSize && (nOffset % nRingSize) + nSize > nRingSize) {
+      (*pnStraddling)++;
+    }
+    ok = verify(pBuffer, nOffset, nSize);
+    nOffset += nSize;
+    if (nKept == KEPT_BUFFERS) {
+      pipe->ReleaseReadBuffer((CPhandle) pipe, pKept[0]);
+      memmove(pKept, pKept + 1, (KEPT_BUFFERS - 1) * sizeof(CPbyte*));
+      nKept--;
+    }
+    pKept[nKept++] = pBuffer;
+  }
+  for (i = 0; i < nKept; i++) {
+    pipe->ReleaseReadBuffer((CPhandle) pipe, pKept[i]);
+  }
+
+  return ok ? nOffset : 0;
+}
+
+static void testMemArena(void) {
+  CP_PIPETYPE* writer = NULL;
+  CP_PIPETYPE* reader = NULL;
+  struct timeval start, end;
+  pthread_t thread;
+  void* bWriterOk;
+  size_t nRead;
+  int nTruncated = 0, nStraddling = 0;
+
+  if (OMX_GetContentPipe((OMX_HANDLETYPE*) &reader, "mem://omxmempipetest") != OMX_ErrorNone ||
+      OMX_GetContentPipe((OMX_HANDLETYPE*) &writer, "mem://omxmempipetest") != OMX_ErrorNone) {
+    check("mem pipes built", 0);
+    free(reader);
+    return;
+  }
+  check("an arena that does not exist is not opened",
+        reader->Open((CPhandle*) reader, "mem://omxmempipetest", CP_AccessRead) != 0);
+
+  gettimeofday(&start, NULL);
+  check("arena created",
+        writer->Create((CPhandle*) writer, "mem://omxmempipetest") == 0 &&
+        reader->Open((CPhandle*) reader, "mem://omxmempipetest", CP_AccessRead) == 0);
+  reader->RegisterCallback((CPhandle) reader, readerCallback);
+  pthread_create(&thread, NULL, writerThread, writer);
+
+  nRead = readStream(reader, 1, &nTruncated, &nStraddling, 0);
+  gettimeofday(&end, NULL);
+  pthread_join(thread, &bWriterOk);
+
+  check("the writer wrote the arena", bWriterOk != NULL);
+  check("the arena read back with ReadBuffer", nRead == nStreamSize);
+  check("ReadBuffer stopped at the end of a chunk without copy",
+        nStreamSize <= 4 * MEM_CHUNK_SIZE || nTruncated > 0);
+  check("CP_BytesAvailable sent", nBytesAvailableEvents > 0);
+  DEBUG(DEFAULT_MESSAGES, "mem: %i MiB in %li us, %li MiB/s\n", (int) (nStreamSize >> 20), elapsed_us(&start, &end),
+        (long) (nStreamSize >> 20) * 1000000 / (elapsed_us(&start, &end) + 1));
+
+  check("the arena closed", reader->Close((CPhandle) reader) == 0);
+  check("the arena freed with its last pipe",
+        reader->Open((CPhandle*) reader, "mem://omxmempipetest", CP_AccessRead) != 0);
+  free(reader);
+  free(writer);
+}
+
+static void testMemClientBuffer(void) {
+  CPbyte* pClient = malloc(CLIENT_BUFFER_SIZE);
+  CPbyte* pData = malloc(CLIENT_BUFFER_SIZE);
+  CP_PIPETYPE* pipe = NULL;
+  CPbyte* pBuffer;
+  CPuint nSize = CLIENT_BUFFER_SIZE;
+  char uri[64];
+
+  snprintf(uri, sizeof(uri), "mem://%p:%u", (void*) pClient, CLIENT_BUFFER_SIZE);
+  if (OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, uri) != OMX_ErrorNone ||
+      pipe->Create((CPhandle*) pipe, uri) != 0) {
+    check("buffer of the client opened", 0);
+    free(pipe);
+    free(pClient);
+    free(pData);
+    return;
+  }
+  fill(pData, 0, CLIENT_BUFFER_SIZE);
+  check("the buffer of the client written",
+        pipe->Write((CPhandle) pipe, pData, CLIENT_BUFFER_SIZE) == 0 && verify(pClient, 0, CLIENT_BUFFER_SIZE));
+  check("no write past the buffer of the client", pipe->Write((CPhandle) pipe, pData, 1) != 0);
+  pipe->Close((CPhandle) pipe);
+
+  check("the buffer of the client read in place",
+        pipe->Open((CPhandle*) pipe, uri, CP_AccessRead) == 0 &&
+        pipe->ReadBuffer((CPhandle) pipe, &pBuffer, &nSize, OMX_FALSE) == 0 &&
+        pBuffer == pClient && nSize == CLIENT_BUFFER_SIZE);
+  pipe->ReleaseReadBuffer((CPhandle) pipe, pBuffer);
+  pipe->Close((CPhandle) pipe);
+  free(pipe);
+  free(pClient);
+  free(pData);
+}
+
+/** Reads the shm pipe in the child process, and returns its exit status */
+static int shmConsumer(const char* uri) {
+  CP_PIPETYPE* pipe = NULL;
+  size_t nRead;
+  int nTruncated = 0, nStraddling = 0;
+
+  if (OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, (OMX_STRING) uri) != OMX_ErrorNone ||
+      pipe->Open((CPhandle*) pipe, (CPstring) uri, CP_AccessRead) != 0) {
+    DEBUG(DEB_LEV_ERR, "Could not open %s\n", uri);
+    return 1;
+  }
+  pipe->RegisterCallback((CPhandle) pipe, readerCallback);
+  nRead = readStream(pipe, 0, &nTruncated, &nStraddling, SHM_RING_KB * 1024);
+  pipe->Close((CPhandle) pipe);
+  free(pipe);
+
+  if (nRead != nStreamSize) {
+    DEBUG(DEB_LEV_ERR, "The child read %i bytes\n", (int) nRead);
+    return 1;
+  }
+  if (nStraddling == 0 || nBytesAvailableEvents == 0) {
+    DEBUG(DEB_LEV_ERR, "No buffer across the end of the ring, or no event\n");
+    return 2;
+  }
+  return 0;
+}
+
+static void testShm(void) {
+  CP_PIPETYPE* producer = NULL;
+  CP_PIPETYPE* consumer = NULL;
+  CP_PIPETYPE* other = NULL;
+  CPbyte* pData = malloc(MAX_BLOCK_SIZE);
+  struct timeval start, end;
+  char uri[64], config[32];
+  pid_t child;
+  int status = -1, ok;
+
+  snprintf(config, sizeof(config), "ring=%i", SHM_RING_KB);
+  setenv(SHM_ENV, config, 1);
+  snprintf(uri, sizeof(uri), "shm://omxmempipetest-%i", (int) getpid());
+
+  if (OMX_GetContentPipe((OMX_HANDLETYPE*) &producer, uri) != OMX_ErrorNone ||
+      OMX_GetContentPipe((OMX_HANDLETYPE*) &consumer, uri) != OMX_ErrorNone ||
+      producer->Create((CPhandle*) producer, uri) != 0) {
+    check("shm pipe created", 0);
+    free(producer);
+    free(consumer);
+    free(pData);
+    return;
+  }
+  check("the consumer only reads", consumer->Open((CPhandle*) consumer, uri, CP_AccessWrite) != 0);
+
+  gettimeofday(&start, NULL);
+  child = fork();
+  if (child == 0) {
+    exit(shmConsumer(uri));
+  }
+  ok = child > 0 && writeStream(producer, pData);
+  producer->Close((CPhandle) producer);
+  if (child > 0) {
+    waitpid(child, &status, 0);
+  }
+  gettimeofday(&end, NULL);
+
+  check("the parent wrote the shm pipe", ok);
+  check("the child read it back, across the end of the ring",
+        WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  check("the name removed once opened", consumer->Open((CPhandle*) consumer, uri, CP_AccessRead) != 0);
+  DEBUG(DEFAULT_MESSAGES, "shm: %i MiB in %li us, %li MiB/s\n", (int) (nStreamSize >> 20), elapsed_us(&start, &end),
+        (long) (nStreamSize >> 20) * 1000000 / (elapsed_us(&start, &end) + 1));
+
+  /* a second producer does not take over the name of a live ring */
+  ok = producer->Create((CPhandle*) producer, uri) == 0;
+  check("a name in use not created again", ok &&
+        OMX_GetContentPipe((OMX_HANDLETYPE*) &other, uri) == OMX_ErrorNone &&
+        other->Create((CPhandle*) other, uri) == KD_EEXIST);
+
+  /* the producer learns that the consumer is gone */
+  ok = ok && consumer->Open((CPhandle*) consumer, uri, CP_AccessRead) == 0 &&
+       consumer->Close((CPhandle) consumer) == 0;
+  check("no write once the consumer closed", ok && producer->Write((CPhandle) producer, pData, 1) != 0);
+  producer->Close((CPhandle) producer);
+
+  free(producer);
+  free(consumer);
+  free(other);
+  free(pData);
+  unsetenv(SHM_ENV);
+}
+
+static CPresult testConstructor(CP_PIPETYPE** ppPipe, CPstring szURI) {
+  *ppPipe = (CP_PIPETYPE*) calloc(1, sizeof(CP_PIPETYPE));
+  nTestPipes++;
+  return *ppPipe ? 0 : KD_ENOMEM;
+}
+
+static CPresult failingConstructor(CP_PIPETYPE** ppPipe, CPstring szURI) {
+  return KD_EINVAL;
+}
+
+static void testSchemes(void) {
+  CP_PIPETYPE* pipe = NULL;
+
+  check("no pipe for an unknown scheme",
+        OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, "test://pipe") != OMX_ErrorNone);
+  check("no pipe for a prefix of a scheme",
+        OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, "filex://pipe") != OMX_ErrorNone);
+  check("a scheme with a colon refused",
+        BOSA_AddContentPipeScheme("te:st", testConstructor) == OMX_ErrorBadParameter);
+
+  check("a scheme added", BOSA_AddContentPipeScheme("test", testConstructor) == OMX_ErrorNone &&
+        OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, "test://pipe") == OMX_ErrorNone &&
+        pipe != NULL && nTestPipes == 1);
+  free(pipe);
+  pipe = NULL;
+
+  check("a scheme replaced", BOSA_AddContentPipeScheme("test", failingConstructor) == OMX_ErrorNone &&
+        OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, "test://pipe") != OMX_ErrorNone && nTestPipes == 1);
+
+  check("the schemes of the core kept",
+        OMX_GetContentPipe((OMX_HANDLETYPE*) &pipe, "file:///dev/null") == OMX_ErrorNone && pipe != NULL);
+  free(pipe);
+}
+
+int main(int argc, char** argv) {
+  int i, nSizeMB = DEFAULT_SIZE_MB;
+
+  for (i = 1; i < argc; i++) {
+    if (argv[i][0] == '-') {
+      if (i + 1 >= argc || argv[i][1] == 'h') {
+        display_help();
+      }
+      switch (argv[i][1]) {
+      case 's':
+        nSizeMB = atoi(argv[++i]);
+        break;
+      default:
+        display_help();
+      }
+    } else {
+      display_help();
+    }
+  }
+  if (nSizeMB <= 0) {
+    display_help();
+  }
+  nStreamSize = (size_t) nSizeMB * 1024 * 1024;
+
+  testSchemes();
+  testMemClientBuffer();
+  testMemArena();
+  testShm();
+
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result == 0 ? "PASSED" : "FAILED");
+  return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+/**
+  test/components/content_pipes/omxmempipetest.h
+
+  This test application streams data through the mem and shm content pipes,
+  and checks the schemes added to the core.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXMEMPIPETEST_H__
+#define __OMXMEMPIPETEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Types.h>
+#include <OMX_ContentPipe.h>
+#include <bellagio/content_pipe_scheme.h>
+
+#include <user_debug_levels.h>
+
+#define DEFAULT_SIZE_MB 16
+
+/** The environment variable configuring the shm pipe, as "ring=64" */
+#define SHM_ENV "OMX_BELLAGIO_PIPE_SHM"
+
+/** Size of the ring of the shm pipe in the test, in KiB, room for the buffers kept
+ * and small enough that blocks straddle its end
+ */
+#define SHM_RING_KB 512
+
+/** Size of the first chunk of a mem arena, the next ones doubling */
+#define MEM_CHUNK_SIZE (64 * 1024)
+
+/** Largest block read or written at once by the test */
+#define MAX_BLOCK_SIZE 65536
+
+/** Buffers the test keeps out of ReadBuffer before releasing the first one */
+#define KEPT_BUFFERS 4
+
+/** Size of the buffer of the client given to the mem pipe */
+#define CLIENT_BUFFER_SIZE 4096
+
+#endif
@@ -0,0 +1,439 @@
+/**
+  test/components/file_io/omxfileiotest.c
+
+  This test application copies a file through the file reader and file writer
+  components tunneled together, and reads a file from the file reader with
+  buffers allocated by the component and by the IL client.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxfileiotest.h"
+#include <sys/stat.h>
+
+appPrivateType* appPriv;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = fileioEventHandler,
+                               .EmptyBufferDone = fileioEmptyBufferDone,
+                               .FillBufferDone = fileioFillBufferDone,
+};
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxfileiotest [-s size] [file]\n");
+  printf("\n");
+  printf("       -s size: size of the file copied in MiB, default %d\n", DEFAULT_SIZE_MB);
+  printf("       file: path of the file copied, default /tmp/omxfileiotest.in,\n");
+  printf("             the copy being written in the same path ended with .out\n");
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+/** Sets the URI of the content of a component */
+static void setContentURI(OMX_HANDLETYPE handle, char* pathname) {
+  OMX_PARAM_CONTENTURITYPE* pContentURI;
+  OMX_ERRORTYPE err;
+  OMX_U32 nSize = offsetof(OMX_PARAM_CONTENTURITYPE, contentURI) + strlen(pathname) + 8;
+
+  pContentURI = calloc(1, nSize);
+  setHeader(pContentURI, nSize);
+  sprintf((char*) pContentURI->contentURI, "file://%s", pathname);
+  err = OMX_SetParameter(handle, OMX_IndexParamContentURI, pContentURI);
+  free(pContentURI);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "Error in setting the URI %s\n", pathname);
+    exit(1);
+  }
+}
+
+/** Sets the number of buffers of a port of a component and returns its buffer size */
+static OMX_U32 setPortBuffers(OMX_HANDLETYPE handle, OMX_U32 nPortIndex) {
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_ERRORTYPE err;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = nPortIndex;
+  err = OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in getting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+  sPortDef.nBufferCountActual = PORT_BUFFERS;
+  err = OMX_SetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if(err != OMX_ErrorNone){
+    DEBUG(DEB_LEV_ERR, "Error in setting the port %i definition\n", (int)nPortIndex);
+    exit(1);
+  }
+  return sPortDef.nBufferSize;
+}
+
+/** Declares that the receiver of the buffers of the reader does not write them */
+static void setReadOnlyBuffers(OMX_HANDLETYPE handle) {
+  OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE sReadOnly;
+  OMX_INDEXTYPE nIndex;
+  OMX_ERRORTYPE err;
+
+  err = OMX_GetExtensionIndex(handle, "OMX.st.index.param.BellagioReadOnlyBuffers", &nIndex);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "The read-only buffers extension is not supported\n");
+    exit(1);
+  }
+  setHeader(&sReadOnly, sizeof(OMX_PARAM_BELLAGIOREADONLYBUFFERSTYPE));
+  sReadOnly.nPortIndex = 0;
+  sReadOnly.bReadOnly = OMX_TRUE;
+  err = OMX_SetParameter(handle, nIndex, &sReadOnly);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "Error in setting the read-only buffers %x\n", err);
+    exit(1);
+  }
+}
+
+/** Compares a file with the data of the test */
+static int checkFile(char* pathname) {
+  FILE* fd;
+  OMX_U8* pRead;
+  long nRead;
+  int result = 0;
+
+  pRead = malloc(appPriv->nSize + 1);
+  fd = fopen(pathname, "rb");
+  if (!fd) {
+    DEBUG(DEB_LEV_ERR, "Can't open %s\n", pathname);
+    free(pRead);
+    return 1;
+  }
+  nRead = fread(pRead, 1, appPriv->nSize + 1, fd);
+  fclose(fd);
+  if (nRead != appPriv->nSize || memcmp(pRead, appPriv->pData, appPriv->nSize)) {
+    DEBUG(DEB_LEV_ERR, "%s differs from the file read, %li bytes\n", pathname, nRead);
+    result = 1;
+  }
+  free(pRead);
+  return result;
+}
+
+/** Copies the file from the reader to the writer tunneled together */
+static int copyTunneled(char* inPath, char* outPath) {
+  OMX_ERRORTYPE err;
+  struct timeval start, end;
+  long elapsed;
+
+  err = OMX_GetHandle(&appPriv->readerHandle, READER_COMP_NAME, NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle %s failed\n", READER_COMP_NAME);
+    exit(1);
+  }
+  err = OMX_GetHandle(&appPriv->writerHandle, WRITER_COMP_NAME, NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle %s failed\n", WRITER_COMP_NAME);
+    exit(1);
+  }
+  setContentURI(appPriv->readerHandle, inPath);
+  setContentURI(appPriv->writerHandle, outPath);
+  setPortBuffers(appPriv->readerHandle, 0);
+  setPortBuffers(appPriv->writerHandle, 0);
+  /* the writer only reads the buffers */
+  setReadOnlyBuffers(appPriv->readerHandle);
+  err = OMX_SetupTunnel(appPriv->readerHandle, 0, appPriv->writerHandle, 0);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_SetupTunnel failed %x\n", err);
+    exit(1);
+  }
+
+  err = OMX_SendCommand(appPriv->writerHandle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  err = OMX_SendCommand(appPriv->readerHandle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+  tsem_down(appPriv->eventSem);
+
+  gettimeofday(&start, NULL);
+  err = OMX_SendCommand(appPriv->writerHandle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+  err = OMX_SendCommand(appPriv->readerHandle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+  /* the writer signals the EOS before writing the last buffer, which is
+   * written before it returns the buffers going back to Idle
+   */
+  tsem_down(appPriv->eosSem);
+
+  err = OMX_SendCommand(appPriv->readerHandle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  err = OMX_SendCommand(appPriv->writerHandle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+  tsem_down(appPriv->eventSem);
+  gettimeofday(&end, NULL);
+
+  err = OMX_SendCommand(appPriv->readerHandle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  err = OMX_SendCommand(appPriv->writerHandle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  tsem_down(appPriv->eventSem);
+  tsem_down(appPriv->eventSem);
+
+  OMX_FreeHandle(appPriv->readerHandle);
+  OMX_FreeHandle(appPriv->writerHandle);
+  appPriv->writerHandle = NULL;
+
+  elapsed = elapsed_us(&start, &end);
+  DEBUG(DEFAULT_MESSAGES, "Copied %li bytes from %s to %s in %li us: %.1f MiB/s\n",
+    appPriv->nSize, READER_COMP_NAME, WRITER_COMP_NAME, elapsed,
+    appPriv->nSize / 1048576.0 * 1000000.0 / (elapsed > 0 ? elapsed : 1));
+
+  return checkFile(outPath);
+}
+
+/** Reads the file from the reader, with buffers allocated by the component or
+ * given by the IL client, and checks the data of each buffer. With
+ * bReadOnly, the client declares that it does not write the buffers.
+ */
+static int readBuffers(char* inPath, OMX_BOOL bAllocate, OMX_BOOL bReadOnly) {
+  OMX_ERRORTYPE err;
+  OMX_U32 nBufferSize;
+  struct timeval start, end;
+  long elapsed;
+  int i, result = 0;
+
+  appPriv->nBytesDone = 0;
+  appPriv->nLent = 0;
+  appPriv->bEOS = OMX_FALSE;
+  appPriv->nBadBuffers = 0;
+
+  err = OMX_GetHandle(&appPriv->readerHandle, READER_COMP_NAME, NULL, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle %s failed\n", READER_COMP_NAME);
+    exit(1);
+  }
+  setContentURI(appPriv->readerHandle, inPath);
+  nBufferSize = setPortBuffers(appPriv->readerHandle, 0);
+  if (bReadOnly) {
+    setReadOnlyBuffers(appPriv->readerHandle);
+  }
+
+  err = OMX_SendCommand(appPriv->readerHandle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    if (bAllocate) {
+      err = OMX_AllocateBuffer(appPriv->readerHandle, &appPriv->outBuffer[i], 0, NULL, nBufferSize);
+      appPriv->pPayload[i] = appPriv->outBuffer[i] ? appPriv->outBuffer[i]->pBuffer : NULL;
+    } else {
+      appPriv->pPayload[i] = malloc(nBufferSize);
+      err = OMX_UseBuffer(appPriv->readerHandle, &appPriv->outBuffer[i], 0, NULL, nBufferSize, appPriv->pPayload[i]);
+    }
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on buffer %i of the reader %i\n", i, err);
+      exit(1);
+    }
+  }
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->readerHandle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_FillThisBuffer(appPriv->readerHandle, appPriv->outBuffer[i]);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on FillThisBuffer %i\n", err);
+      exit(1);
+    }
+  }
+  tsem_down(appPriv->eosSem);
+  gettimeofday(&end, NULL);
+
+  err = OMX_SendCommand(appPriv->readerHandle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+
+  err = OMX_SendCommand(appPriv->readerHandle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    err = OMX_FreeBuffer(appPriv->readerHandle, 0, appPriv->outBuffer[i]);
+    if (!bAllocate) {
+      free(appPriv->pPayload[i]);
+    }
+  }
+  tsem_down(appPriv->eventSem);
+
+  OMX_FreeHandle(appPriv->readerHandle);
+
+  elapsed = elapsed_us(&start, &end);
+  DEBUG(DEFAULT_MESSAGES, "Read %li bytes with buffers %s in %li us: %.1f MiB/s, %i buffers of the pipe sent\n",
+    appPriv->nBytesDone, bAllocate ? "allocated by the component" : "of the client", elapsed,
+    appPriv->nBytesDone / 1048576.0 * 1000000.0 / (elapsed > 0 ? elapsed : 1), appPriv->nLent);
+
+  if (appPriv->nBadBuffers || appPriv->nBytesDone != appPriv->nSize) {
+    DEBUG(DEB_LEV_ERR, "%i buffers differ from the file, %li bytes read\n", appPriv->nBadBuffers, appPriv->nBytesDone);
+    result = 1;
+  }
+  /* only the payloads allocated by the component, and not written, can be replaced */
+  if ((bAllocate && bReadOnly && appPriv->nLent == 0) || (!(bAllocate && bReadOnly) && appPriv->nLent != 0)) {
+    DEBUG(DEB_LEV_ERR, "%i buffers of the pipe sent in buffers %s%s\n", appPriv->nLent,
+      bAllocate ? "allocated by the component" : "of the client", bReadOnly ? " read only" : "");
+    result = 1;
+  }
+  return result;
+}
+
+int main(int argc, char** argv) {
+  OMX_ERRORTYPE err;
+  char* inPath = "/tmp/omxfileiotest.in";
+  char* outPath;
+  FILE* fd;
+  long i;
+  int sizeMB = DEFAULT_SIZE_MB, result = 0;
+
+  for (i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      sizeMB = atoi(argv[++i]);
+    } else if (argv[i][0] != '-') {
+      inPath = argv[i];
+    } else {
+      display_help();
+    }
+  }
+  if (sizeMB <= 0) {
+    display_help();
+  }
+
+  /* Initialize application private data */
+  appPriv = calloc(1, sizeof(appPrivateType));
+  appPriv->nSize = (long) sizeMB * 1048576 + 12345;
+  appPriv->pData = malloc(appPriv->nSize);
+  for (i = 0; i < appPriv->nSize; i++) {
+    appPriv->pData[i] = (OMX_U8) ((i * 7) ^ (i >> 11));
+  }
+  fd = fopen(inPath, "wb");
+  if (!fd || fwrite(appPriv->pData, 1, appPriv->nSize, fd) != (size_t) appPriv->nSize) {
+    DEBUG(DEB_LEV_ERR, "Can't write %s\n", inPath);
+    exit(1);
+  }
+  fclose(fd);
+  outPath = malloc(strlen(inPath) + 5);
+  sprintf(outPath, "%s.out", inPath);
+  unlink(outPath);
+
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->eosSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eosSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+
+  result |= copyTunneled(inPath, outPath);
+  result |= readBuffers(inPath, OMX_TRUE, OMX_TRUE);
+  result |= readBuffers(inPath, OMX_TRUE, OMX_FALSE);
+  result |= readBuffers(inPath, OMX_FALSE, OMX_TRUE);
+  if (appPriv->nErrors) {
+    DEBUG(DEB_LEV_ERR, "%i error events received\n", appPriv->nErrors);
+    result = 1;
+  }
+
+  OMX_Deinit();
+
+  unlink(outPath);
+  unlink(inPath);
+  free(outPath);
+  tsem_deinit(appPriv->eosSem);
+  free(appPriv->eosSem);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  free(appPriv->pData);
+  free(appPriv);
+
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result ? "FAILED" : "PASSED");
+  return result;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE fileioEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    if (Data1 == OMX_CommandStateSet) {
+      tsem_up(appPriv->eventSem);
+    }
+  } else if(eEvent == OMX_EventBufferFlag) {
+    if (hComponent == appPriv->writerHandle && (Data2 & OMX_BUFFERFLAG_EOS)) {
+      tsem_up(appPriv->eosSem);
+    }
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "Received error event %08x\n", (int)Data1);
+    appPriv->nErrors++;
+  }
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE fileioEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE fileioFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+  int i;
+
+  /* the buffers left after the EOS come back empty */
+  if (appPriv->bEOS) {
+    return OMX_ErrorNone;
+  }
+  if (appPriv->nBytesDone + (long) pBuffer->nFilledLen > appPriv->nSize ||
+      memcmp(pBuffer->pBuffer + pBuffer->nOffset, appPriv->pData + appPriv->nBytesDone, pBuffer->nFilledLen)) {
+    appPriv->nBadBuffers++;
+  } else {
+    appPriv->nBytesDone += pBuffer->nFilledLen;
+  }
+  for (i = 0; i < PORT_BUFFERS; i++) {
+    if (pBuffer == appPriv->outBuffer[i] && pBuffer->pBuffer != appPriv->pPayload[i]) {
+      appPriv->nLent++;
+    }
+  }
+  if (pBuffer->nFlags & OMX_BUFFERFLAG_EOS) {
+    appPriv->bEOS = OMX_TRUE;
+    tsem_up(appPriv->eosSem);
+  } else {
+    pBuffer->nFilledLen = 0;
+    OMX_FillThisBuffer(hComponent, pBuffer);
+  }
+  return OMX_ErrorNone;
+}
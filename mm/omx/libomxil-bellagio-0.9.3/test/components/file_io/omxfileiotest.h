@@ -0,0 +1,99 @@
+/**
+  test/components/file_io/omxfileiotest.h
+
+  This test application copies a file through the file reader and file writer
+  components tunneled together, and reads a file from the file reader with
+  buffers allocated by the component and by the IL client.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXFILEIOTEST_H__
+#define __OMXFILEIOTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/extension_struct.h>
+#include <user_debug_levels.h>
+
+/** Specification version of the core */
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    0
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+#define READER_COMP_NAME "OMX.st.audio.filereader"
+#define WRITER_COMP_NAME "OMX.st.audio.filewriter"
+
+/** Default size of the file copied, in MiB */
+#define DEFAULT_SIZE_MB 16
+
+/** Number of buffers allocated on each port */
+#define PORT_BUFFERS 4
+
+/* Application's private data */
+typedef struct appPrivateType{
+  tsem_t* eventSem;
+  tsem_t* eosSem;
+  OMX_HANDLETYPE readerHandle;
+  OMX_HANDLETYPE writerHandle;
+  OMX_U8* pData;
+  long nSize;
+  long nBytesDone;
+  int nLent;
+  OMX_BOOL bEOS;
+  int nBadBuffers;
+  int nErrors;
+  OMX_BUFFERHEADERTYPE* outBuffer[PORT_BUFFERS];
+  OMX_U8* pPayload[PORT_BUFFERS];
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE fileioEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE fileioEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE fileioFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
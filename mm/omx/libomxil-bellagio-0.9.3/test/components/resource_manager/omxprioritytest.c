@@ -28,13 +28,24 @@
 #include <string.h>
 #include <bellagio/extension_struct.h>
 
-#define MAX_COMPONENTS 5
+/* The instances are created one by one until the resource manager refuses
+ * one, so that the limit of the component is found: this bounds the search */
+#define MAX_COMPONENTS 64
 #define TIMEOUT 500
 /* Application private date: should go in the component field (segs...) */
 
 
 OMX_HANDLETYPE *handle;
 
+/* Resource handover measurement */
+OMX_HANDLETYPE requestHandle = NULL;
+OMX_HANDLETYPE preemptedHandle = NULL;
+struct timeval tRequest, tGranted, tPreempted, tReleased;
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+	return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
 OMX_CALLBACKTYPE callbacks = { .EventHandler = rmEventHandler,
                                .EmptyBufferDone = rmEmptyBufferDone,
                                .FillBufferDone = rmFillBufferDone,
@@ -68,6 +79,8 @@ void display_help() {
   printf("\n");
   printf("Usage: omxprioritytest OMX_name [-i max_comp]\n");
   printf("\n");
+  printf("       -i max_comp: most instances created to reach the limit of the resource manager, default %d\n", MAX_COMPONENTS);
+  printf("\n");
   exit(1);
 }
 
@@ -78,6 +91,8 @@ int main(int argc, char** argv) {
 	int argn_dec = 1;
 	int i, j;
 	int num_of_components;
+	int num_of_handles;
+	int result = 0;
 	OMX_STATETYPE state;
 	char* componentName;
 	int global_err = 0;
@@ -130,7 +145,7 @@ int main(int argc, char** argv) {
 	if (max_value == 0) {
 		max_value = MAX_COMPONENTS;
 	}
-	handle = malloc(sizeof(OMX_HANDLETYPE*) * max_value);
+	handle = malloc(sizeof(OMX_HANDLETYPE) * max_value);
 	/* Obtain file descriptor */
 	eventSem = malloc(sizeof(tsem_t));
 	tsem_init(eventSem, 0);
@@ -142,16 +157,12 @@ int main(int argc, char** argv) {
 	}
 	DEBUG(DEB_LEV_SIMPLE_SEQ, "OMX_Init()\n");
 
-	for (i = 0; i<max_value; i++) {
-		err = OMX_GetHandle(&handle[i], componentName, NULL, &callbacks);
-		if(err != OMX_ErrorNone) {
-			DEBUG(DEFAULT_MESSAGES, "#########################################################################\n");
-			DEBUG(DEFAULT_MESSAGES, "The OLD STYLE resource manager on %s\n", componentName);
-			DEBUG(DEFAULT_MESSAGES, "#########################################################################\n");
-			exit(1);
-		}
-		DEBUG(DEB_LEV_SIMPLE_SEQ, "OMX_GetHandle() %i\n", i);
+	err = OMX_GetHandle(&handle[0], componentName, NULL, &callbacks);
+	if(err != OMX_ErrorNone) {
+		DEBUG(DEB_LEV_ERR, "No component %s\n", componentName);
+		exit(1);
 	}
+	num_of_handles = 1;
 	setHeader(&sParam, sizeof(OMX_PORT_PARAM_TYPE));
 	err = OMX_GetParameter(handle[0], OMX_IndexParamAudioInit, &sParam);
 	if (sParam.nPorts > 0) {
@@ -175,6 +186,17 @@ int main(int argc, char** argv) {
 	}
 
 	for (i = 0; i<max_value; i++) {
+		if (i > 0) {
+			err = OMX_GetHandle(&handle[i], componentName, NULL, &callbacks);
+			if(err != OMX_ErrorNone) {
+				DEBUG(DEFAULT_MESSAGES, "#########################################################################\n");
+				DEBUG(DEFAULT_MESSAGES, "The OLD STYLE resource manager on %s\n", componentName);
+				DEBUG(DEFAULT_MESSAGES, "#########################################################################\n");
+				break;
+			}
+			num_of_handles = i + 1;
+			DEBUG(DEB_LEV_SIMPLE_SEQ, "OMX_GetHandle() %i\n", i);
+		}
 		// todo this test is valid only for 2 ports components, not like mixer, sinks, sources
 		if (indexaudiostart >= 0) {
 			for (j = 0; j< audioports; j++) {
@@ -214,24 +236,52 @@ int main(int argc, char** argv) {
 			/** the priority of the component which fails to go to idle is raised
 					so that another component is preempted to leave room to this component */
 				DEBUG(DEB_LEV_SIMPLE_SEQ, "The resources are exhausted\n");
+				/* the holders are running, so that the one preempted has to stop
+				   and return its buffers before leaving the resource */
+				for (j = 0; j < i; j++) {
+					err = OMX_SendCommand(handle[j], OMX_CommandStateSet, OMX_StateExecuting, NULL);
+					tsem_down(eventSem);
+				}
 				DEBUG(DEB_LEV_SIMPLE_SEQ, "Raising the priority of component %i\n", i);
 				setHeader(&oPriority, sizeof(OMX_PRIORITYMGMTTYPE));
 				oPriority.nGroupPriority = 1;
 				err = OMX_SetParameter(handle[i], OMX_IndexParamPriorityMgmt, &oPriority);
+				requestHandle = handle[i];
+				gettimeofday(&tRequest, NULL);
 				err = OMX_SendCommand(handle[i], OMX_CommandStateSet, OMX_StateIdle, NULL);
+				/* the requester reaches Idle, and the preempted component Loaded */
+				tsem_down(eventSem);
 				tsem_down(eventSem);
 				DEBUG(DEFAULT_MESSAGES, "#########################################################################\n");
 				DEBUG(DEFAULT_MESSAGES, "The resource manager has operated on %s\n", componentName);
+				if (preemptedHandle) {
+					DEBUG(DEFAULT_MESSAGES, "Resource granted after %li us, the preempted component stopped after %li us\n",
+						elapsed_us(&tRequest, &tGranted), elapsed_us(&tRequest, &tPreempted));
+					DEBUG(DEFAULT_MESSAGES, "and reached Loaded after %li us\n", elapsed_us(&tRequest, &tReleased));
+				}
 				DEBUG(DEFAULT_MESSAGES, "#########################################################################\n");
+				i++;
 				break;
 			}
 		}
 	}
 	num_of_components = i;
+	if (!preemptedHandle) {
+		DEBUG(DEFAULT_MESSAGES, "#########################################################################\n");
+		DEBUG(DEFAULT_MESSAGES, "No component has been preempted with %i instances of %s,\n", num_of_components, componentName);
+		DEBUG(DEFAULT_MESSAGES, "the handover has not been measured\n");
+		DEBUG(DEFAULT_MESSAGES, "#########################################################################\n");
+		result = 1;
+	}
 
 	DEBUG(DEB_LEV_SIMPLE_SEQ, "Dispose the system\n");
 	for (i = 0; i<num_of_components; i++) {
 		err = OMX_GetState(handle[i], &state);
+		if (state == OMX_StateExecuting) {
+			err = OMX_SendCommand(handle[i], OMX_CommandStateSet, OMX_StateIdle, NULL);
+			tsem_down(eventSem);
+			state = OMX_StateIdle;
+		}
 		if (state == OMX_StateIdle) {
 			err = OMX_SendCommand(handle[i], OMX_CommandStateSet, OMX_StateLoaded, NULL);
 	        tsem_down(eventSem);
@@ -244,7 +294,7 @@ int main(int argc, char** argv) {
 	}
 	DEBUG(DEB_LEV_SIMPLE_SEQ, "All %i to loaded\n", num_of_components);
 
-	for (i = 0; i<max_value; i++) {
+	for (i = 0; i<num_of_handles; i++) {
 		err = OMX_FreeHandle(handle[i]);
 		if(err != OMX_ErrorNone) {
 			DEBUG(DEB_LEV_ERR, "OMX_FreeHandle [%i] failed\n", i);
@@ -258,8 +308,9 @@ int main(int argc, char** argv) {
 		exit(1);
 	}
 	free(eventSem);
+	free(handle);
 	DEBUG(DEB_LEV_SIMPLE_SEQ, "OMX_Deinit()\n");
-	return 0;
+	return result;
 }
 
 /* Callbacks implementation */
@@ -280,9 +331,15 @@ OMX_ERRORTYPE rmEventHandler(
         break;
       case OMX_StateLoaded:
         DEBUG(DEB_LEV_SIMPLE_SEQ, "OMX_StateLoaded\n");
+        if (hComponent == preemptedHandle) {
+          gettimeofday(&tReleased, NULL);
+        }
         break;
       case OMX_StateIdle:
         DEBUG(DEB_LEV_SIMPLE_SEQ, "OMX_StateIdle\n");
+        if (hComponent == requestHandle) {
+          gettimeofday(&tGranted, NULL);
+        }
         break;
       case OMX_StateExecuting:
         DEBUG(DEB_LEV_SIMPLE_SEQ, "OMX_StateExecuting\n");
@@ -307,6 +364,8 @@ OMX_ERRORTYPE rmEventHandler(
   	  	DEBUG(DEFAULT_MESSAGES, "Received error OMX_ErrorResourcesLost\n");
   	} else if (Data1 == OMX_ErrorResourcesPreempted) {
   	  	DEBUG(DEFAULT_MESSAGES, "Received error OMX_ErrorResourcesPreempted\n");
+  	  	gettimeofday(&tPreempted, NULL);
+  	  	preemptedHandle = hComponent;
   	} else {
   	  	DEBUG(DEFAULT_MESSAGES, "Received error %i\n", (int)Data1);
   	}
@@ -30,6 +30,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/time.h>
 
 #include <OMX_Core.h>
 #include <OMX_Component.h>
@@ -41,7 +42,7 @@
 
 /** Specification version*/
 #define VERSIONMAJOR    1
-#define VERSIONMINOR    1
+#define VERSIONMINOR    0
 #define VERSIONREVISION 0
 #define VERSIONSTEP     0
 
@@ -0,0 +1,225 @@
+/**
+  test/components/resource_manager/omxrmbudgettest.c
+
+  This test application checks the admission of the components in the CPU
+  and memory budgets of the reference resource manager, at the quality
+  levels they describe: the components of lower priority are stepped down
+  to make room, and stepped up again when the budget is released.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <string.h>
+
+#include "omxrmbudgettest.h"
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = budgetEventHandler,
+                               .EmptyBufferDone = budgetEmptyBufferDone,
+                               .FillBufferDone = budgetFillBufferDone,
+};
+
+OMX_HANDLETYPE handle[BUDGET_INSTANCES];
+tsem_t eventSem;
+int result = 0;
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+static void setPriority(int i, OMX_U32 nPriority) {
+  OMX_PRIORITYMGMTTYPE oPriority;
+
+  setHeader(&oPriority, sizeof(OMX_PRIORITYMGMTTYPE));
+  oPriority.nGroupPriority = nPriority;
+  oPriority.nGroupID = 0;
+  OMX_SetParameter(handle[i], OMX_IndexParamPriorityMgmt, &oPriority);
+}
+
+/** Sends a command and waits for its completion, or for its error
+ */
+static void sendCommand(int i, OMX_COMMANDTYPE cmd, OMX_U32 nParam) {
+  if (OMX_SendCommand(handle[i], cmd, nParam, NULL) != OMX_ErrorNone ||
+      tsem_timed_down(&eventSem, TIMEOUT) != 0) {
+    DEBUG(DEB_LEV_ERR, "The command %i to component %i did not complete\n", (int)cmd, i);
+    result = -1;
+  }
+}
+
+/** Requests the Idle state and checks whether the component is admitted
+ */
+static void expectIdle(int i, OMX_STATETYPE expected) {
+  OMX_STATETYPE state;
+
+  sendCommand(i, OMX_CommandStateSet, OMX_StateIdle);
+  OMX_GetState(handle[i], &state);
+  if (state != expected) {
+    DEBUG(DEFAULT_MESSAGES, "Component %i is in state %i instead of %i\n", i, (int)state, (int)expected);
+    result = -1;
+  }
+}
+
+/** Checks the quality levels of the components, 0 for the ones not checked
+ */
+static void expectLevels(const char* step, int a, int b, int c, int d) {
+  int expected[BUDGET_INSTANCES] = { a, b, c, d };
+  OMX_U32 level;
+  int i, ok = 1;
+
+  DEBUG(DEFAULT_MESSAGES, "%-48s levels", step);
+  for (i = 0; i < BUDGET_INSTANCES; i++) {
+    if (expected[i] == 0) {
+      DEBUG(DEFAULT_MESSAGES, " -");
+      continue;
+    }
+    getQualityLevel(handle[i], &level);
+    DEBUG(DEFAULT_MESSAGES, " %i", (int)level);
+    if (level != expected[i]) {
+      ok = 0;
+    }
+  }
+  DEBUG(DEFAULT_MESSAGES, " %s\n", ok ? "ok" : "FAILED");
+  if (!ok) {
+    result = -1;
+  }
+}
+
+/** Disables all the ports of a component, so that it reaches Idle without buffers
+ */
+static void disablePorts(int i) {
+  OMX_INDEXTYPE domains[] = { OMX_IndexParamAudioInit, OMX_IndexParamVideoInit,
+                              OMX_IndexParamImageInit, OMX_IndexParamOtherInit };
+  OMX_PORT_PARAM_TYPE sParam;
+  OMX_U32 j;
+  int k;
+
+  for (k = 0; k < sizeof(domains) / sizeof(domains[0]); k++) {
+    setHeader(&sParam, sizeof(OMX_PORT_PARAM_TYPE));
+    if (OMX_GetParameter(handle[i], domains[k], &sParam) != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error in getting OMX_PORT_PARAM_TYPE parameter\n");
+      result = -1;
+      return;
+    }
+    for (j = 0; j < sParam.nPorts; j++) {
+      sendCommand(i, OMX_CommandPortDisable, sParam.nStartPortNumber + j);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  OMX_STATETYPE state;
+  OMX_ERRORTYPE err;
+  int i;
+
+  /* the budgets are read by the resource manager in OMX_Init */
+  setenv(BUDGET_ENV, BUDGET_CONFIG, 1);
+  tsem_init(&eventSem, 0);
+  err = OMX_Init();
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  for (i = 0; i < BUDGET_INSTANCES; i++) {
+    err = OMX_GetHandle(&handle[i], BUDGET_COMPONENT, NULL, &callbacks);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "OMX_GetHandle() of %s failed\n", BUDGET_COMPONENT);
+      exit(1);
+    }
+    disablePorts(i);
+  }
+  DEBUG(DEFAULT_MESSAGES, "Budget %s on %s\n", BUDGET_CONFIG, BUDGET_COMPONENT);
+
+  /* two components at the best level fill the budget */
+  expectIdle(0, OMX_StateIdle);
+  expectIdle(1, OMX_StateIdle);
+  expectLevels("two components at the best level", 1, 1, 0, 0);
+
+  /* a third one of the same priority does not fit */
+  expectIdle(2, OMX_StateLoaded);
+
+  /* with a higher priority it steps the others down */
+  setPriority(2, 50);
+  expectIdle(2, OMX_StateIdle);
+  expectLevels("higher priority, the others stepped down", 2, 2, 1, 0);
+
+  /* a fourth one of the same priority does not fit even at the lowest level */
+  setPriority(3, 50);
+  expectIdle(3, OMX_StateLoaded);
+
+  /* with a higher priority it steps the third one down, and gets the lowest level */
+  setPriority(3, 10);
+  expectIdle(3, OMX_StateIdle);
+  expectLevels("highest priority, admitted at the lowest level", 2, 2, 2, 2);
+
+  /* the budget released goes back to the highest priority */
+  sendCommand(0, OMX_CommandStateSet, OMX_StateLoaded);
+  expectLevels("budget released, highest priority stepped up", 0, 2, 2, 1);
+
+  for (i = 0; i < BUDGET_INSTANCES; i++) {
+    OMX_GetState(handle[i], &state);
+    if (state == OMX_StateIdle) {
+      sendCommand(i, OMX_CommandStateSet, OMX_StateLoaded);
+    }
+    OMX_FreeHandle(handle[i]);
+  }
+  OMX_Deinit();
+  tsem_deinit(&eventSem);
+  DEBUG(DEFAULT_MESSAGES, "%s\n", result == 0 ? "PASSED" : "FAILED");
+  return result == 0 ? 0 : 1;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE budgetEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  if (eEvent == OMX_EventCmdComplete) {
+    tsem_up(&eventSem);
+  } else if (eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Received error %x\n", (int)Data1);
+    tsem_up(&eventSem);
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE budgetEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE budgetFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  return OMX_ErrorNone;
+}
@@ -0,0 +1,80 @@
+/**
+  test/components/resource_manager/omxrmbudgettest.h
+
+  This test application checks the admission of the components in the CPU
+  and memory budgets of the reference resource manager, at the quality
+  levels they describe.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXRMBUDGETTEST_H__
+#define __OMXRMBUDGETTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/OMXComponentRMExt.h>
+#include <user_debug_levels.h>
+
+/** Specification version, the one checked by the components of this tree */
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    0
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+/** The environment variable read by the resource manager for its budgets */
+#define BUDGET_ENV "OMX_BELLAGIO_RM_BUDGET"
+
+/** The volume component needs 64 KiB at quality level 1 and 32 KiB at level 2,
+ * so the budget holds two instances at the best level, or four at the lowest
+ */
+#define BUDGET_COMPONENT "OMX.st.volume.component"
+#define BUDGET_CONFIG "memory=131072"
+#define BUDGET_INSTANCES 4
+
+/** Time allowed to a command to complete, in milliseconds */
+#define TIMEOUT 1000
+
+/* Callback prototypes */
+OMX_ERRORTYPE budgetEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE budgetEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE budgetFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
@@ -0,0 +1,416 @@
+/**
+  test/components/resource_manager/omxrmstresstest.c
+
+  This test application stresses the reference resource manager with many
+  threads acquiring and releasing instances of the same component at once,
+  with random priorities, and then checks that no instance has been lost.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <errno.h>
+
+#include "omxrmstresstest.h"
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = stressEventHandler,
+                               .EmptyBufferDone = stressEmptyBufferDone,
+                               .FillBufferDone = stressFillBufferDone,
+};
+
+static char* componentName = DEFAULT_COMPONENT;
+static int nCycles = DEFAULT_CYCLES;
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxrmstresstest [-t threads] [-n cycles] [-m max_comp] [OMX_name]\n");
+  printf("\n");
+  printf("       -t threads: number of threads, each one with an instance, default %d\n", DEFAULT_THREADS);
+  printf("       -n cycles: acquire and release cycles of each thread, default %d\n", DEFAULT_CYCLES);
+  printf("       -m max_comp: maximum of instances the component registers to the resource manager, default %d\n", DEFAULT_MAX_INSTANCES);
+  printf("       OMX_name: the component stressed, default %s\n", DEFAULT_COMPONENT);
+  printf("       -h: Displays this help\n");
+  printf("\n");
+  exit(1);
+}
+
+static long elapsed_us(struct timeval* start, struct timeval* end) {
+  return (end->tv_sec - start->tv_sec) * 1000000 + (end->tv_usec - start->tv_usec);
+}
+
+/** Sends a command to the instance of the client, counting it
+ */
+static OMX_ERRORTYPE sendCommand(stressClientType* client, OMX_COMMANDTYPE cmd, OMX_U32 nParam) {
+  OMX_ERRORTYPE err;
+
+  pthread_mutex_lock(&client->mutex);
+  client->nCommands++;
+  pthread_mutex_unlock(&client->mutex);
+  err = OMX_SendCommand(client->handle, cmd, nParam, NULL);
+  if (err != OMX_ErrorNone) {
+    pthread_mutex_lock(&client->mutex);
+    client->nCommands--;
+    pthread_mutex_unlock(&client->mutex);
+  }
+  return err;
+}
+
+/** Waits until all the commands sent to the instance completed
+ *
+ * @return -1 if they did not complete in time
+ */
+static int settle(stressClientType* client) {
+  struct timespec deadline;
+  struct timeval now;
+  int err = 0;
+
+  gettimeofday(&now, NULL);
+  deadline.tv_sec = now.tv_sec + COMMAND_TIMEOUT / 1000;
+  deadline.tv_nsec = now.tv_usec * 1000 + (COMMAND_TIMEOUT % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+  pthread_mutex_lock(&client->mutex);
+  while (client->nCompleted < client->nCommands && err != ETIMEDOUT) {
+    err = pthread_cond_timedwait(&client->cond, &client->mutex, &deadline);
+  }
+  if (client->nCompleted < client->nCommands) {
+    client->nFailed++;
+    err = -1;
+  } else {
+    err = 0;
+  }
+  pthread_mutex_unlock(&client->mutex);
+  return err;
+}
+
+/** Sends a state change and waits until the instance settles
+ *
+ * @return the state reached, or OMX_StateInvalid if the command did not complete
+ */
+static OMX_STATETYPE changeState(stressClientType* client, OMX_STATETYPE destination) {
+  OMX_STATETYPE state;
+
+  if (sendCommand(client, OMX_CommandStateSet, destination) != OMX_ErrorNone || settle(client) != 0) {
+    return OMX_StateInvalid;
+  }
+  OMX_GetState(client->handle, &state);
+  return state;
+}
+
+static OMX_ERRORTYPE setPriority(stressClientType* client, OMX_U32 nPriority) {
+  OMX_PRIORITYMGMTTYPE oPriority;
+
+  setHeader(&oPriority, sizeof(OMX_PRIORITYMGMTTYPE));
+  oPriority.nGroupPriority = nPriority;
+  oPriority.nGroupID = 0;
+  return OMX_SetParameter(client->handle, OMX_IndexParamPriorityMgmt, &oPriority);
+}
+
+/** Disables all the ports of the instance, so that it reaches Idle
+ * without buffers
+ */
+static int disablePorts(stressClientType* client) {
+  OMX_INDEXTYPE domains[] = { OMX_IndexParamAudioInit, OMX_IndexParamVideoInit,
+                              OMX_IndexParamImageInit, OMX_IndexParamOtherInit };
+  OMX_PORT_PARAM_TYPE sParam;
+  OMX_U32 j;
+  int i;
+
+  for (i = 0; i < sizeof(domains) / sizeof(domains[0]); i++) {
+    setHeader(&sParam, sizeof(OMX_PORT_PARAM_TYPE));
+    if (OMX_GetParameter(client->handle, domains[i], &sParam) != OMX_ErrorNone) {
+      return -1;
+    }
+    for (j = 0; j < sParam.nPorts; j++) {
+      sendCommand(client, OMX_CommandPortDisable, sParam.nStartPortNumber + j);
+    }
+  }
+  return settle(client);
+}
+
+/** Acquires and releases the instance of the client with random priorities
+ */
+static void* clientThread(void* param) {
+  stressClientType* client = param;
+  OMX_STATETYPE state;
+  int i;
+
+  for (i = 0; i < nCycles; i++) {
+    if (setPriority(client, rand_r(&client->seed) % (MAX_PRIORITY + 1)) != OMX_ErrorNone) {
+      client->nFailed++;
+      break;
+    }
+    state = changeState(client, OMX_StateIdle);
+    if (state == OMX_StateInvalid) {
+      break;
+    }
+    if (state != OMX_StateIdle) {
+      client->nRefused++;
+      continue;
+    }
+    client->nGranted++;
+    usleep(rand_r(&client->seed) % 200);
+    OMX_GetState(client->handle, &state);
+    if (state == OMX_StateIdle && changeState(client, OMX_StateLoaded) == OMX_StateInvalid) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+/** Brings the instance back to Loaded, once all the preemptions have been sent
+ */
+static int unload(stressClientType* client) {
+  OMX_STATETYPE state;
+
+  if (settle(client) != 0) {
+    return -1;
+  }
+  OMX_GetState(client->handle, &state);
+  if (state != OMX_StateLoaded) {
+    state = changeState(client, OMX_StateLoaded);
+  }
+  if (state != OMX_StateLoaded) {
+    DEBUG(DEFAULT_MESSAGES, "Instance %i left in state %i\n", client->id, state);
+    return -1;
+  }
+  return 0;
+}
+
+/** Checks that every instance has been given back to the resource manager,
+ * and that the waiting queue serves the highest priority first
+ */
+static int checkResources(stressClientType* clients, int nMax) {
+  stressClientType* low = &clients[nMax];
+  stressClientType* high = &clients[nMax + 1];
+  int i, result = 0;
+
+  for (i = 0; i < nMax; i++) {
+    setPriority(&clients[i], 2);
+    if (changeState(&clients[i], OMX_StateIdle) != OMX_StateIdle) {
+      DEBUG(DEFAULT_MESSAGES, "Instance %i refused, an instance has been lost\n", i);
+      result = -1;
+    }
+  }
+  /* an instance of the same priority is refused */
+  setPriority(low, 2);
+  if (result == 0 && changeState(low, OMX_StateIdle) != OMX_StateLoaded) {
+    DEBUG(DEFAULT_MESSAGES, "Instance %i granted beyond the maximum\n", nMax);
+    result = -1;
+  }
+  /* the waiter of higher priority is served first, even if it came later */
+  setPriority(low, 3);
+  setPriority(high, 1);
+  if (changeState(low, OMX_StateWaitForResources) != OMX_StateWaitForResources ||
+      changeState(high, OMX_StateWaitForResources) != OMX_StateWaitForResources) {
+    DEBUG(DEFAULT_MESSAGES, "The instances cannot wait for resources\n");
+    result = -1;
+  }
+  /* a waiter asking for Idle while nothing can be preempted is refused,
+   * and keeps its place in the queue */
+  if (result == 0 && changeState(low, OMX_StateIdle) != OMX_StateWaitForResources) {
+    DEBUG(DEFAULT_MESSAGES, "The waiting instance left the queue when refused\n");
+    result = -1;
+  }
+  pthread_mutex_lock(&high->mutex);
+  high->nCommands++; /* the Idle command sent by the resource manager */
+  pthread_mutex_unlock(&high->mutex);
+  changeState(&clients[0], OMX_StateLoaded);
+  if (result == 0 && settle(high) != 0) {
+    DEBUG(DEFAULT_MESSAGES, "The waiting instance did not receive the resource released\n");
+    result = -1;
+  }
+  /* the refused waiter still gets the next instance released */
+  pthread_mutex_lock(&low->mutex);
+  low->nCommands++;
+  pthread_mutex_unlock(&low->mutex);
+  changeState(&clients[1], OMX_StateLoaded);
+  if (result == 0 && settle(low) != 0) {
+    DEBUG(DEFAULT_MESSAGES, "The refused waiting instance did not receive the resource released\n");
+    result = -1;
+  }
+  if (unload(low) != 0) {
+    result = -1;
+  }
+  for (i = 0; i < nMax + 2; i++) {
+    if (i != nMax && unload(&clients[i]) != 0) {
+      result = -1;
+    }
+  }
+  return result;
+}
+
+int main(int argc, char** argv) {
+  stressClientType* clients;
+  OMX_ERRORTYPE err;
+  struct timeval start, end;
+  int nThreads = DEFAULT_THREADS;
+  int nMax = DEFAULT_MAX_INSTANCES;
+  int nGranted = 0, nRefused = 0, nLost = 0, nFailed = 0;
+  int i, result = 0;
+
+  for (i = 1; i < argc; i++) {
+    if (argv[i][0] == '-') {
+      if (i + 1 >= argc || argv[i][1] == 'h') {
+        display_help();
+      }
+      switch (argv[i][1]) {
+      case 't':
+        nThreads = atoi(argv[++i]);
+        break;
+      case 'n':
+        nCycles = atoi(argv[++i]);
+        break;
+      case 'm':
+        nMax = atoi(argv[++i]);
+        break;
+      default:
+        display_help();
+      }
+    } else {
+      componentName = argv[i];
+    }
+  }
+  if (nThreads <= 0 || nCycles <= 0 || nMax <= 0) {
+    display_help();
+  }
+
+  clients = calloc(nThreads, sizeof(stressClientType));
+  if (clients == NULL) {
+    return 1;
+  }
+  err = OMX_Init();
+  if (err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    return 1;
+  }
+  for (i = 0; i < nThreads; i++) {
+    clients[i].id = i;
+    clients[i].seed = i + 1;
+    pthread_mutex_init(&clients[i].mutex, NULL);
+    pthread_cond_init(&clients[i].cond, NULL);
+    err = OMX_GetHandle(&clients[i].handle, componentName, &clients[i], &callbacks);
+    if (err != OMX_ErrorNone || disablePorts(&clients[i]) != 0) {
+      DEBUG(DEB_LEV_ERR, "Cannot get an instance of %s\n", componentName);
+      return 1;
+    }
+  }
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < nThreads; i++) {
+    pthread_create(&clients[i].thread, NULL, clientThread, &clients[i]);
+  }
+  for (i = 0; i < nThreads; i++) {
+    pthread_join(clients[i].thread, NULL);
+  }
+  gettimeofday(&end, NULL);
+
+  for (i = 0; i < nThreads; i++) {
+    if (unload(&clients[i]) != 0) {
+      result = -1;
+    }
+    nGranted += clients[i].nGranted;
+    nRefused += clients[i].nRefused;
+    nLost += clients[i].nLost;
+    nFailed += clients[i].nFailed;
+  }
+  printf("%d threads, %d cycles each, on %d instances of %s\n", nThreads, nCycles, nMax, componentName);
+  printf("  %-26s %10d\n", "granted", nGranted);
+  printf("  %-26s %10d\n", "refused", nRefused);
+  printf("  %-26s %10d\n", "preempted", nLost);
+  printf("  %-26s %10d\n", "timed out", nFailed);
+  printf("  %-26s %10.2f us\n", "per cycle", (double)elapsed_us(&start, &end) / (nThreads * nCycles));
+  if (nFailed > 0 || nGranted + nRefused != nThreads * nCycles) {
+    result = -1;
+  }
+
+  if (nThreads >= nMax + 2) {
+    if (checkResources(clients, nMax) != 0) {
+      result = -1;
+    }
+  } else {
+    printf("At least %d threads are needed to check the resources left\n", nMax + 2);
+  }
+
+  for (i = 0; i < nThreads; i++) {
+    OMX_FreeHandle(clients[i].handle);
+    pthread_cond_destroy(&clients[i].cond);
+    pthread_mutex_destroy(&clients[i].mutex);
+  }
+  OMX_Deinit();
+  free(clients);
+  printf("%s\n", result == 0 ? "PASSED" : "FAILED");
+  return result == 0 ? 0 : 1;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE stressEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+  stressClientType* client = pAppData;
+
+  pthread_mutex_lock(&client->mutex);
+  if (eEvent == OMX_EventCmdComplete) {
+    client->nCompleted++;
+  } else if (eEvent == OMX_EventError) {
+    if (Data1 == OMX_ErrorResourcesLost) {
+      /* the resource manager sends the instance to Loaded */
+      client->nLost++;
+      client->nCommands++;
+    } else {
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "Client %i received error %x\n", client->id, (int)Data1);
+      client->nCompleted++;
+    }
+  }
+  pthread_cond_signal(&client->cond);
+  pthread_mutex_unlock(&client->mutex);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE stressEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE stressFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  return OMX_ErrorNone;
+}
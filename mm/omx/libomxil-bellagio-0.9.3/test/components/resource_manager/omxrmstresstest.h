@@ -0,0 +1,106 @@
+/**
+  test/components/resource_manager/omxrmstresstest.h
+
+  This test application stresses the reference resource manager with many
+  threads acquiring and releasing instances of the same component at once,
+  with random priorities, and then checks that no instance has been lost.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXRMSTRESSTEST_H__
+#define __OMXRMSTRESSTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+
+#include <user_debug_levels.h>
+
+/** Specification version, the one checked by the components of this tree */
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    0
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+/** The component stressed, and the number of its instances handled by the resource manager */
+#define DEFAULT_COMPONENT "OMX.st.volume.component"
+#define DEFAULT_MAX_INSTANCES 10
+
+/** Default number of threads, each one with its own instance */
+#define DEFAULT_THREADS 16
+
+/** Default number of acquire and release cycles of each thread */
+#define DEFAULT_CYCLES 100
+
+/** The priorities are drawn between 0 and this value */
+#define MAX_PRIORITY 3
+
+/** Time allowed to a command to complete, in milliseconds */
+#define COMMAND_TIMEOUT 5000
+
+/** @brief a thread of the test and its instance of the component
+ *
+ * Every state change sent by the thread, or by the resource manager when
+ * it preempts the instance, completes with exactly one event. The thread
+ * waits until the events balance the commands before reading the state.
+ */
+typedef struct stressClientType {
+  pthread_t thread;
+  int id;
+  OMX_HANDLETYPE handle;
+  unsigned int seed;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  int nCommands; /**< commands sent to the instance */
+  int nCompleted; /**< commands completed, successfully or not */
+  int nLost; /**< resources lost, each one followed by a command of the resource manager */
+  int nGranted; /**< cycles that reached Idle */
+  int nRefused; /**< cycles refused for insufficient resources */
+  int nFailed; /**< commands that did not complete in time */
+} stressClientType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE stressEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE stressEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE stressFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
@@ -165,7 +165,7 @@ OMX_ERRORTYPE hantro_OMX_GetHandle( OMX_HANDLETYPE* pHandle, OMX_STRING cCompone
     }
 
     int refIndex = 0;
-    for (refIndex=0; refIndex < MAX_TABLE_SIZE; refIndex++) {
+    for (refIndex=0; refIndex < tableCount; refIndex++) {
         //get the index for the component in the table
         if (strcmp(componentTable[refIndex].name, cComponentName) == 0) {
             LOGD("Found component %s with refCount %d\n",
@@ -320,7 +320,7 @@ OMX_ERRORTYPE hantro_OMX_FreeHandle (OMX_HANDLETYPE hComponent)
     }
 
     int refIndex = 0, handleIndex = 0;
-    for (refIndex=0; refIndex < MAX_TABLE_SIZE; refIndex++) {
+    for (refIndex=0; refIndex < tableCount; refIndex++) {
         for (handleIndex=0; handleIndex < componentTable[refIndex].refCount; handleIndex++){
             /* get the position for the component in the table */
             if (componentTable[refIndex].pHandle[handleIndex] == hComponent){